@@ -14,6 +14,10 @@ extern "C" {
 #include "EbSvtAv1.h"
 #include "EbSvtAv1ExtFrameBuf.h"
 
+/* Maximum number of pictures returned by reference the application may hold
+ * at once. See eb_dec_set_frame_buffer_callbacks() */
+#define EB_DEC_MAX_OUT_BUFFERS      4
+
 typedef struct EbAV1StreamInfo
 {
     /*seq_profile*/
@@ -69,7 +73,9 @@ typedef struct EbSvtAv1DecConfiguration
      * Default is 0 */
     EbBool                  skip_film_grain;
 
-    /* Skip N output frames in the display order.
+    /* Skip N output frames in the display order. Of the frames before, only
+     * the ones referenced by other frames are decoded : the others are
+     * dropped once their frame header is read. For seeking.
      *
      * 0 = decodes from the start of the bitstream.
      *
@@ -83,6 +89,34 @@ typedef struct EbSvtAv1DecConfiguration
      * Default is 0. */
     uint64_t                 frames_to_be_decoded;
 
+    /* Drop the frames no other frame references (refresh_frame_flags of 0)
+     * once their frame header is read. They are neither decoded nor output,
+     * the other frames are unchanged. For seek previews and thumbnails.
+     *
+     * Default is 0. */
+    EbBool                   skip_non_ref_frames;
+
+    /* Skip CDEF and loop restoration on the frames no other frame
+     * references. Their output is at a lower fidelity, the other frames are
+     * unchanged.
+     *
+     * Default is 0. */
+    EbBool                   skip_non_ref_filters;
+
+    /* Region of interest, in luma samples of the frame. The output pictures
+     * are cropped to the region. On the frames no other frame references,
+     * only the tiles of the region and of the superblocks around it are
+     * reconstructed and post filtered, and the tiles away from it are not
+     * entropy decoded. Reference frames are decoded in full, as the motion
+     * vectors of later frames may reach anywhere in them, so the output is
+     * exact. region_width or region_height of 0 decodes the full frame.
+     *
+     * Default is 0. */
+    uint32_t                 region_left;
+    uint32_t                 region_top;
+    uint32_t                 region_width;
+    uint32_t                 region_height;
+
     /* Offline packing of the 2bits: requires two bits packed input.
      *
      * Default is 0. */
@@ -119,6 +153,34 @@ typedef struct EbSvtAv1DecConfiguration
     *
     * Default is 0. */
     uint32_t                 threads;
+
+    /* Number of frames decoded in parallel, each with its own threads. A
+    * frame waits only for the reference rows its motion compensation reads.
+    * Pictures are output up to frame_threads - 1 frames late : call
+    * eb_svt_decode_frame() without data at the end of the stream to get
+    * the remaining ones.
+    *
+    * 1 = Frames are decoded one after the other.
+    *
+    * Default is 1. */
+    uint32_t                 frame_threads;
+
+    /* Entropy decoding and reconstruction run as two pipelined stages, with
+    * threads > 1 : the calling thread parses the tiles of a frame into frame
+    * level mode info and coefficient buffers, while the other threads
+    * reconstruct the parsed superblocks row by row in wavefront order. Gives
+    * parallelism within frames that have few tiles, for the memory of a
+    * frame of coefficients.
+    *
+    * Default is 0, each thread parses and reconstructs whole tiles. */
+    EbBool                   pipeline_recon;
+
+    /* The input is in the length delimited format of Annex B : temporal
+    * units starting with their temporal_unit_size. eb_peek_sequence_header()
+    * tells which format a stream is in.
+    *
+    * Default is 0, low overhead OBUs with their obu_size. */
+    EbBool                   is_annex_b;
     // Application Specific parameters
 
     /* ID assigned to each channel when multiple instances are running within the
@@ -151,6 +213,8 @@ typedef struct EbSvtAv1DecConfiguration
      * the EB_ErrorNone, which means the the sequence header is found.
      * When the OBU is not a valid sequence header, EB_DecUnsupportedBitstream
      * is returned.
+     * Both low overhead OBUs and Annex B are recognized : is_annex_b of
+     * header tells which format the stream is in.
      *
      * Parameter:
      * @ *header            Sequence header info.
@@ -177,13 +241,18 @@ typedef struct EbSvtAv1DecConfiguration
     EB_API EbErrorType eb_init_decoder(
         EbComponentType         *svt_dec_component);
 
-    /*!\brief STEP 5: Decodes one OBU.
+    /*!\brief STEP 5: Decodes the OBUs received so far. The data can be
+     * cut anywhere, as received from the network : the OBUs it completes
+     * are decoded and the rest is kept until the next call. When the output
+     * pictures have not been fetched, decoding waits for
+     * eb_svt_dec_get_picture(), which resumes it.
+     *
+     * Calling it with no data signals the end of the stream.
      *
      * Parameter:
      * @ *svt_dec_component     Decoder handle
      * @ *data                  Buffer with data
      * @ data_size              Data size in bytes
-     * @ *user_priv             pointer to the private user data
      *
      *  Returns EB_ErrorNone if the coded data has been processed successfully. */
     EB_API EbErrorType eb_svt_decode_obu(
@@ -199,6 +268,9 @@ typedef struct EbSvtAv1DecConfiguration
      * @ *data                  Buffer with data
      * @ data_size              Data size in bytes
      *
+     * Calling it with no data signals the end of the stream : the pictures
+     * still in flight are then returned by eb_svt_dec_get_picture().
+     *
      *  Returns EB_ErrorNone if the coded data has been processed successfully. */
     EB_API EbErrorType eb_svt_decode_frame(
         EbComponentType     *svt_dec_component,
@@ -211,6 +283,7 @@ typedef struct EbSvtAv1DecConfiguration
      * In this case, calling eb_svt_dec_get_picture() multiple times
      * would output pictures that belong to the corresponding quality layers
      * in the increasing order.
+     * The TU must be received in full. Each frame shown in it is output.
      *
      * Parameter:
      * @ *svt_dec_component     Decoder handle
@@ -227,7 +300,8 @@ typedef struct EbSvtAv1DecConfiguration
      * have been generated, calling this function multiple times will
      * iterate over the decoded pictures. The previous output picture becomes
      * unavailable after the eb_svt_dec_get_picture() or one of the decoding
-     * functions is called. The pictures are returned in their display order.
+     * functions is called, unless it was returned by reference. The pictures
+     * are returned in their display order.
      *
      * Parameter:
      * @ *svt_dec_component     Decoder handle.
@@ -237,13 +311,25 @@ typedef struct EbSvtAv1DecConfiguration
      *
      *  Returns EB_ErrorNone if the picture has been returned successfully.
      *  Returns EB_DecNoOutputPicture if the next output picture has not
-     *  been generated yet. Calling a decoding function is needed to generate more pictures. */
+     *  been generated yet. Calling a decoding function is needed to generate more pictures.
+     *  Returns EB_DecNoOutputPicture as well while EB_DEC_MAX_OUT_BUFFERS
+     *  pictures returned by reference are held. */
     EB_API EbErrorType eb_svt_dec_get_picture(
         EbComponentType      *svt_dec_component,
         EbBufferHeaderType   *p_buffer,
         EbAV1StreamInfo      *stream_info,
         EbAV1FrameInfo       *frame_info);
 
+    /* STEP 6-1: Give back a picture returned by reference. Its buffer may
+     * then be decoded into again. Does nothing for a picture that was
+     * copied. Not to be called concurrently with the other functions of
+     * the decoder handle.
+     *
+     * Parameter:
+     * @ *p_buffer              Header the picture was returned in. */
+    EB_API void eb_svt_dec_release_out_buffer(
+        EbBufferHeaderType   *p_buffer);
+
     /* STEP 7: Deinitialize decoder library.
      *
      * Parameter:
@@ -272,6 +358,20 @@ typedef struct EbSvtAv1DecConfiguration
         EbComponentType     *svt_dec_component);
 
     /* Initialize callback functions.
+     *
+     * The decoder then allocates the planes of its pictures, references
+     * included, in buffers of at least min_size bytes from allocate_buffer.
+     * They are given back to release_buffer by eb_deinit_decoder().
+     * eb_svt_dec_get_picture() returns the pictures by reference : the plane
+     * pointers and strides of the EbSvtIOFormat point into the application
+     * buffer, and p_app_private is set to its private_data. The picture stays
+     * valid until it is given back with eb_svt_dec_release_out_buffer(), which
+     * the application does for every picture it gets. Up to
+     * EB_DEC_MAX_OUT_BUFFERS pictures may be held at once, the ones still
+     * held are released by eb_deinit_decoder().
+     *
+     * Must be called before the first sequence header is decoded. Both
+     * callbacks are set, or none.
      *
      * Parameter:
      * @ *svt_dec_component     Decoder handle
@@ -338,7 +338,10 @@ typedef struct EbSvtAv1EncConfiguration
     // Application Specific parameters
 
     /* ID assigned to each channel when multiple instances are running within the
-     * same application. */
+     * same application. With share_task_scheduler, each channel of a group of
+     * active_channel_count channels gets 1 / active_channel_count of the task
+     * scheduler when all of them have work ready, and channel_id orders the
+     * channels otherwise tied. */
     uint32_t                 channel_id;
     uint32_t                 active_channel_count;
 
@@ -372,6 +375,81 @@ typedef struct EbSvtAv1EncConfiguration
      * Default is -1. */
     int32_t                 target_socket;
 
+    /* NUMA memory placement, effective on Linux only.
+     *
+     * 0 = OFF, pages are placed on the node of the thread that first
+     *     touches them.
+     * 1 = Allocate the encoder buffers on the node the encoder threads are
+     *     pinned to, requires TargetSocket or LogicalProcessorNumber to keep
+     *     the threads on one node.
+     *
+     * The encoder instance is placed on one node as a whole: the buffer
+     * pools are not placed per consuming stage, and the stages of one
+     * encoder are not split across nodes. On a multi-node system, run one
+     * encoder per node, each with its own TargetSocket.
+     *
+     * The resident memory of each node is reported after initialization.
+     *
+     * Default is 0. */
+    uint32_t                numa_mode;
+
+    /* Run the picture analysis, motion estimation, source based operations,
+     * mode decision configuration, EncDec, in-loop filter and entropy coding
+     * stages as tasks on one pool of worker threads, one per logical
+     * processor, instead of a dedicated thread array per stage.
+     *
+     * Default is 0. */
+    EbBool                  enable_task_scheduler;
+
+    /* Attach the encoder to one task scheduler shared by every handle of the
+     * process that sets this flag, implies enable_task_scheduler. The pool is
+     * sized by the first handle initialized. A handle must be drained (EOS
+     * packet received) before eb_deinit_encoder is called.
+     *
+     * Default is 0. */
+    EbBool                  share_task_scheduler;
+
+    /* Start the input, picture control set and reference picture pools at one
+     * mini-GOP and construct pictures on demand as the pipeline fills, instead
+     * of allocating the full look-ahead up front. Pictures above the initial
+     * count are freed again once the pools have not run out for 2 seconds.
+     *
+     * Default is 0. */
+    EbBool                  elastic_pools;
+
+    /* Memory budget of the encoder in MB. The input, picture control set and
+     * reference picture pools are sized to fit it, down to the minimum the
+     * pipeline needs to run; a warning is printed when the budget is below
+     * that minimum. 0 = no budget.
+     *
+     * Default is 0. */
+    uint32_t                max_memory_mb;
+
+    /* Allocate the picture planes of each picture pool from an arena of 2 MB
+     * aligned regions instead of one heap allocation per plane, with a
+     * memory report per pool after initialization and at deinit.
+     *
+     * 0 = OFF, planes allocated from the heap.
+     * 1 = ON, regions advised for transparent huge pages.
+     * 2 = ON, regions mapped from the huge page pool (MAP_HUGETLB), mode 1
+     *     when the pool has no free huge pages.
+     *
+     * Huge pages are used on Linux only.
+     *
+     * Default is 0. */
+    uint32_t                picture_arena;
+
+    /* Reference the planes passed to eb_svt_enc_send_picture instead of
+     * copying them. The planes must follow the layout returned by
+     * eb_svt_enc_get_input_layout, the library writes to them (padding,
+     * temporal filtering) and gives each picture back through the callback
+     * set with eb_svt_enc_set_input_release_callback.
+     *
+     * Only 8 bit 4:2:0 input is supported.
+     *
+     * Default is 0. */
+    EbBool                  zero_copy_input;
+
     // Debug tools
 
     /* Output reconstructed yuv used for debug purposes. The value is set through
@@ -379,6 +457,22 @@ typedef struct EbSvtAv1EncConfiguration
      *
      * Default is 0. */
     uint32_t                 recon_enabled;
+
+    /* Path of a trace file recording a span for every object processed by
+     * each pipeline stage and for every EncDec segment, tagged with the
+     * picture number and segment index. The file is written at
+     * eb_deinit_encoder in the Chrome trace event JSON format, viewable in
+     * chrome://tracing or the Perfetto UI.
+     *
+     * Default is NULL (no trace). */
+    const char              *trace_file_name;
+
+    /* Time the stages and count their objects for eb_svt_get_pipeline_stats.
+     * Without it only the queue depths are reported, and the pipeline does
+     * not read the clock.
+     *
+     * Default is 0. */
+    EbBool                   enable_pipeline_stats;
     /* Log 2 Tile Rows and colums . 0 means no tiling,1 means that we split the dimension
         * into 2
         * Default is 0. */
@@ -428,6 +522,77 @@ typedef struct EbSvtAv1EncConfiguration
     EbBool                   enable_overlays;
 } EbSvtAv1EncConfiguration;
 
+#define EB_PIPELINE_STAGE_MAX_COUNT     16
+
+/* Statistics of one pipeline stage. Times are in microseconds and, like the
+ * processed object count, accumulate over all the threads of the stage since
+ * eb_init_encoder. */
+typedef struct EbSvtStageStats
+{
+    // Kernel name of the stage, e.g. "enc_dec"
+    const char              *name;
+    // Number of threads (or scheduler contexts) serving the stage
+    uint32_t                 thread_count;
+    // Time spent processing input objects
+    uint64_t                 busy_time;
+    // Time blocked waiting for an input object, the stage is starving
+    uint64_t                 input_wait_time;
+    // Time blocked waiting for an empty output object, the next stage
+    // or a buffer pool is the bottleneck
+    uint64_t                 output_wait_time;
+    uint64_t                 processed_object_count;
+    // Objects currently queued at the input of the stage
+    uint32_t                 input_queue_depth;
+} EbSvtStageStats;
+
+typedef struct EbSvtPipelineStats
+{
+    // Wall clock time since eb_init_encoder, in microseconds
+    uint64_t                 elapsed_time;
+    uint32_t                 stage_count;
+    // Stages in pipeline order
+    EbSvtStageStats          stage_array[EB_PIPELINE_STAGE_MAX_COUNT];
+} EbSvtPipelineStats;
+
+/* Plane layout of an input picture with zero_copy_input. The plane pointers
+ * passed to eb_svt_enc_send_picture point to the first pixel of the picture,
+ * and the planes are allocated with the padding around it, i.e. a luma plane
+ * of y_stride * (top_padding + height + bottom_padding) bytes with luma at
+ * y_stride * top_padding + left_padding. Chroma planes use half the padding,
+ * width and height. */
+typedef struct EbSvtInputLayout
+{
+    // Luma picture size, the source size rounded up to a multiple of 8
+    uint32_t                 width;
+    uint32_t                 height;
+    uint32_t                 left_padding;
+    uint32_t                 right_padding;
+    uint32_t                 top_padding;
+    uint32_t                 bottom_padding;
+    uint32_t                 y_stride;
+    uint32_t                 cb_stride;
+    uint32_t                 cr_stride;
+    // Pictures the library holds at most, one more lets the application
+    // fill a picture while the library holds the others
+    uint32_t                 buffer_count;
+} EbSvtInputLayout;
+
+/* Called from a library thread when a picture sent with zero_copy_input is
+ * no longer read by the library. p_buffer carries the pts, flags and
+ * p_app_private the picture was sent with, and is only valid during the call. */
+typedef void (*EbSvtInputReleaseCallback)(
+    void                    *context,
+    EbBufferHeaderType      *p_buffer);
+
+/* Called from the packetization thread with each packet as soon as it is
+ * ready, in the order eb_svt_get_packet would return them. The application
+ * owns the packet until it gives it back with eb_svt_release_out_buffer,
+ * from any thread. An encode error is signaled by flags & 0xfffffff0. The
+ * callback should return quickly, it holds up the packetization thread. */
+typedef void (*EbSvtPacketCallback)(
+    void                    *context,
+    EbBufferHeaderType      *p_buffer);
+
     /* STEP 1: Call the library to construct a Component Handle.
      *
      * Parameter:
@@ -450,6 +615,40 @@ typedef struct EbSvtAv1EncConfiguration
         EbComponentType           *svt_enc_component,
         EbSvtAv1EncConfiguration   *pComponentParameterStructure); // pComponentParameterStructure contents will be copied to the library
 
+    /* OPTIONAL: Get the plane layout of the input pictures, for
+     * zero_copy_input. Call after eb_svt_enc_set_parameter.
+     *
+     * Parameter:
+     * @ *svt_enc_component  Encoder handler.
+     * @ *layout             Layout filled by the library. */
+    EB_API EbErrorType eb_svt_enc_get_input_layout(
+        EbComponentType      *svt_enc_component,
+        EbSvtInputLayout     *layout);
+
+    /* OPTIONAL: Set the callback giving the input pictures back to the
+     * application, for zero_copy_input. Call before eb_init_encoder.
+     *
+     * Parameter:
+     * @ *svt_enc_component  Encoder handler.
+     * @ release_callback    Callback, NULL for none.
+     * @ *context            Passed to the callback. */
+    EB_API EbErrorType eb_svt_enc_set_input_release_callback(
+        EbComponentType          *svt_enc_component,
+        EbSvtInputReleaseCallback release_callback,
+        void                     *context);
+
+    /* OPTIONAL: Set the callback receiving the output packets, instead of
+     * eb_svt_get_packet. Call before eb_init_encoder.
+     *
+     * Parameter:
+     * @ *svt_enc_component  Encoder handler.
+     * @ packet_callback     Callback, NULL for none.
+     * @ *context            Passed to the callback. */
+    EB_API EbErrorType eb_svt_enc_set_packet_callback(
+        EbComponentType          *svt_enc_component,
+        EbSvtPacketCallback       packet_callback,
+        void                     *context);
+
     /* STEP 3: Initialize encoder and allocates memory to necessary buffers.
      *
      * Parameter:
@@ -502,6 +701,17 @@ typedef struct EbSvtAv1EncConfiguration
         EbBufferHeaderType  **p_buffer,
         uint8_t                pic_send_done);
 
+    /* OPTIONAL: Receive packet, blocking for at most timeout_ms.
+     * Parameter:
+     * @ *svt_enc_component  Encoder handler.
+     * @ **p_buffer          Header pointer to return packet with.
+     * @ timeout_ms          Longest wait in milliseconds.
+     * Returns EB_ErrorMax for an encode error, EB_NoErrorEmptyQueue when no packet became available in time.*/
+    EB_API EbErrorType eb_svt_get_packet_timeout(
+        EbComponentType      *svt_enc_component,
+        EbBufferHeaderType  **p_buffer,
+        uint32_t               timeout_ms);
+
     /* STEP 5-1: Release output buffer back into the pool.
      *
      * Parameter:
@@ -518,6 +728,17 @@ typedef struct EbSvtAv1EncConfiguration
         EbComponentType      *svt_enc_component,
         EbBufferHeaderType   *p_buffer);
 
+    /* OPTIONAL: Get the pipeline statistics of each stage. Can be called at
+     * any time between eb_init_encoder and eb_deinit_encoder, from any thread.
+     * The times and object counts stay 0 unless enable_pipeline_stats is set.
+     *
+     * Parameter:
+     * @ *svt_enc_component  Encoder handler.
+     * @ *stats              Statistics filled by the library. */
+    EB_API EbErrorType eb_svt_get_pipeline_stats(
+        EbComponentType      *svt_enc_component,
+        EbSvtPipelineStats   *stats);
+
     /* STEP 6: Deinitialize encoder library.
      *
      * Parameter:
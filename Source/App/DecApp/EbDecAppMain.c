@@ -50,6 +50,9 @@ int read_input_frame(CLInput *cli, uint8_t **buffer, size_t *bytes_read,
     case FILE_TYPE_IVF:
         return read_ivf_frame(cli->inFile, buffer, bytes_read, buffer_size, pts);
         break;
+    case FILE_TYPE_OBU:
+        return read_obu_chunk(cli->inFile, buffer, bytes_read, buffer_size);
+        break;
     default:
         printf("Unsupported bitstream type. \n");
         return 0;
@@ -95,6 +98,28 @@ void write_frame(EbBufferHeaderType *recon_buffer, CLInput *cli) {
     fflush(cli->outFile);
 }
 
+/* Allocator of -ext-fb : the decoder decodes into these buffers and
+   returns its pictures by reference */
+static int alloc_ext_frame_buf(EbExtFrameBuf *frame_buf, uint32_t min_size,
+                               void *private_data)
+{
+    (void)private_data;
+    frame_buf->buffer = (uint8_t*)malloc(min_size);
+    if (frame_buf->buffer == NULL)
+        return -1;
+    frame_buf->buffer_size = min_size;
+    frame_buf->private_data = NULL;
+    return 0;
+}
+
+static int release_ext_frame_buf(EbExtFrameBuf *frame_buf, void *private_data)
+{
+    (void)private_data;
+    free(frame_buf->buffer);
+    frame_buf->buffer = NULL;
+    return 0;
+}
+
 static void show_progress(int in_frame, uint64_t dx_time) {
     printf("\n%d frames decoded in %" PRId64 " us (%.2f fps)\r",
         in_frame, dx_time,
@@ -120,6 +145,7 @@ int32_t main(int32_t argc, char* argv[])
     cli.enable_md5 = 0;
     cli.fps_frm = 0;
     cli.fps_summary = 0;
+    cli.ext_frame_buf = 0;
 
     uint64_t stop_after = 0;
     uint32_t in_frame = 0;
@@ -138,7 +164,7 @@ int32_t main(int32_t argc, char* argv[])
     // Print Decoder Info
     printf("\n**WARNING** decoder is not feature complete\n");
     printf("Current support: intra & inter(no Compund, no Wedge tools), ");
-    printf("no super-resolution, no Film Grain\n\n");
+    printf("no super-resolution\n\n");
 
     printf("-------------------------------------\n");
     printf("SVT-AV1 Decoder Sample Application v1.2.0\n");
@@ -169,6 +195,9 @@ int32_t main(int32_t argc, char* argv[])
     if (read_command_line(argc, argv, config_ptr, &cli) == 0 &&
         !eb_svt_dec_set_parameter(p_handle, config_ptr)) {
         return_error = eb_init_decoder(p_handle);
+        if (return_error == EB_ErrorNone && cli.ext_frame_buf)
+            return_error = eb_dec_set_frame_buffer_callbacks(p_handle,
+                alloc_ext_frame_buf, release_ext_frame_buf, NULL);
         if (return_error != EB_ErrorNone) {
             return_error |= eb_dec_deinit_handle(p_handle);
             goto fail;
@@ -190,22 +219,24 @@ int32_t main(int32_t argc, char* argv[])
                                 sizeof(uint8_t) : sizeof(uint16_t);
         size = size * cli.height * cli.width;
 
-        ((EbSvtIOFormat *)recon_buffer->p_buffer)->luma = (uint8_t*)malloc(size);
-        ((EbSvtIOFormat *)recon_buffer->p_buffer)->cb = (uint8_t*)malloc(size >> 2);
-        ((EbSvtIOFormat *)recon_buffer->p_buffer)->cr = (uint8_t*)malloc(size >> 2);
+        /* With -ext-fb the planes are returned by the decoder */
+        if (!cli.ext_frame_buf) {
+            ((EbSvtIOFormat *)recon_buffer->p_buffer)->luma = (uint8_t*)malloc(size);
+            ((EbSvtIOFormat *)recon_buffer->p_buffer)->cb = (uint8_t*)malloc(size >> 2);
+            ((EbSvtIOFormat *)recon_buffer->p_buffer)->cr = (uint8_t*)malloc(size >> 2);
+        }
         if (!init_pic_buffer((EbSvtIOFormat*)recon_buffer->p_buffer, &cli)) {
             printf("Decoding \n");
             EbAV1StreamInfo *stream_info = (EbAV1StreamInfo*)malloc(sizeof(EbAV1StreamInfo));
             EbAV1FrameInfo *frame_info = (EbAV1FrameInfo*)malloc(sizeof(EbAV1FrameInfo));
 
+            /* The decoder skips the frames, decoding the references of the
+               later ones. IVF frames are counted as they are read */
             if (config_ptr->skip_frames)
                 fprintf(stderr, "Skipping first %" PRIu64 " frames.\n", config_ptr->skip_frames);
-            uint64_t skip_frame = config_ptr->skip_frames;
-            while (skip_frame) {
-                if (!read_input_frame(&cli, &buf, &bytes_in_buffer, &buffer_size, NULL)) break;
-                skip_frame--;
-            }
             stop_after = config_ptr->frames_to_be_decoded;
+            if (stop_after && cli.inFileType == FILE_TYPE_IVF)
+                stop_after += config_ptr->skip_frames;
             if (enable_md5)
                 md5_init(&md5_ctx);
             // Input Loop Thread
@@ -214,14 +245,21 @@ int32_t main(int32_t argc, char* argv[])
 
                     dec_timer_start(&timer);
 
-                    return_error |= eb_svt_decode_frame(p_handle, buf, bytes_in_buffer);
+                    /* Raw OBUs are streamed in chunks that do not follow
+                       the frames, which are counted as they are output */
+                    if (cli.inFileType == FILE_TYPE_OBU)
+                        return_error |= eb_svt_decode_obu(p_handle, buf, (uint32_t)bytes_in_buffer);
+                    else {
+                        return_error |= eb_svt_decode_frame(p_handle, buf, bytes_in_buffer);
+                        in_frame++;
+                    }
 
                     dec_timer_mark(&timer);
                     dx_time += dec_timer_elapsed(&timer);
 
-                    in_frame++;
-
-                    if (eb_svt_dec_get_picture(p_handle, recon_buffer, stream_info, frame_info) != EB_DecNoOutputPicture) {
+                    while (eb_svt_dec_get_picture(p_handle, recon_buffer, stream_info, frame_info) != EB_DecNoOutputPicture) {
+                        if (cli.inFileType == FILE_TYPE_OBU)
+                            in_frame++;
                         if (fps_frm)
                             show_progress(in_frame , dx_time);
 
@@ -229,10 +267,23 @@ int32_t main(int32_t argc, char* argv[])
                             write_md5(recon_buffer, &cli, &md5_ctx);
                         if(cli.outFile != NULL)
                             write_frame(recon_buffer, &cli);
+                        eb_svt_dec_release_out_buffer(recon_buffer);
                     }
                 }
                 else break;
             }
+            // Drain the pictures still being decoded by the frame threads
+            if (cli.inFileType == FILE_TYPE_OBU)
+                return_error |= eb_svt_decode_obu(p_handle, NULL, 0);
+            else
+                return_error |= eb_svt_decode_frame(p_handle, NULL, 0);
+            while (eb_svt_dec_get_picture(p_handle, recon_buffer, stream_info, frame_info) != EB_DecNoOutputPicture) {
+                if (enable_md5)
+                    write_md5(recon_buffer, &cli, &md5_ctx);
+                if (cli.outFile != NULL)
+                    write_frame(recon_buffer, &cli);
+                eb_svt_dec_release_out_buffer(recon_buffer);
+            }
             if (fps_summary || fps_frm) {
                 show_progress(in_frame, dx_time);
                 printf("\n");
@@ -248,9 +299,11 @@ int32_t main(int32_t argc, char* argv[])
             free(frame_info);
             free(stream_info);
         }
-        free(((EbSvtIOFormat *)recon_buffer->p_buffer)->cr);
-        free(((EbSvtIOFormat *)recon_buffer->p_buffer)->cb);
-        free(((EbSvtIOFormat *)recon_buffer->p_buffer)->luma);
+        if (!cli.ext_frame_buf) {
+            free(((EbSvtIOFormat *)recon_buffer->p_buffer)->cr);
+            free(((EbSvtIOFormat *)recon_buffer->p_buffer)->cb);
+            free(((EbSvtIOFormat *)recon_buffer->p_buffer)->luma);
+        }
         free(recon_buffer->p_buffer);
         free(recon_buffer);
         free(buf);
@@ -26,7 +26,14 @@ static void set_limit_frame(const char *value, EbSvtAv1DecConfiguration *cfg) {
 static void set_bit_depth(const char *value, EbSvtAv1DecConfiguration *cfg) { cfg->max_bit_depth = strtoul(value, NULL, 0); };
 static void set_pic_width(const char *value, EbSvtAv1DecConfiguration *cfg) { cfg->max_picture_width = strtoul(value, NULL, 0); };
 static void set_pic_height(const char *value, EbSvtAv1DecConfiguration *cfg) { cfg->max_picture_height = strtoul(value, NULL, 0); };
+static void set_threads(const char *value, EbSvtAv1DecConfiguration *cfg) { cfg->threads = strtoul(value, NULL, 0); };
+static void set_frame_threads(const char *value, EbSvtAv1DecConfiguration *cfg) { cfg->frame_threads = strtoul(value, NULL, 0); };
 static void set_colour_space(const char *value, EbSvtAv1DecConfiguration *cfg) { cfg->max_color_format = parse_name(value, csp_names); };
+static void set_region(const char *value, EbSvtAv1DecConfiguration *cfg) {
+    if (sscanf(value, "%u,%u,%u,%u", &cfg->region_left, &cfg->region_top,
+        &cfg->region_width, &cfg->region_height) != 4)
+        cfg->region_width = cfg->region_height = 0;
+};
 
  /**********************************
   * Config Entry Array
@@ -35,6 +42,9 @@ ConfigEntry config_entry[] = {
     // Decoder settings
     { SKIP_FRAME_TOKEN, "SkipFrame", 1, set_skip_frame },
     { LIMIT_FRAME_TOKEN, "LimitFrame", 1, set_limit_frame },
+    { THREADS_TOKEN, "Threads", 1, set_threads },
+    { FRAME_THREADS_TOKEN, "FrameThreads", 1, set_frame_threads },
+    { REGION_TOKEN, "Region", 1, set_region },
     // Picture properties
     { BIT_DEPTH_TOKEN,"InputBitDepth", 1, set_bit_depth },
     { PIC_WIDTH_TOKEN, "PictureWidth", 1, set_pic_width},
@@ -49,10 +59,13 @@ static void showHelp()
 #define H0 printf
     H0(" Options : \n");
     H0( " -help                     Show usage options and exit \n");
-    H0( " -i <arg>                  Input file name \n");
+    H0( " -i <arg>                  Input file name, IVF or raw OBUs (low overhead or Annex B) \n");
     H0( " -o <arg>                  Output file name \n");
-    H0( " -skip <arg>               Skip the first n input frames \n");
+    H0( " -skip <arg>               Skip the first n output frames, decoding only the ones referenced \n");
     H0( " -limit <arg>              Stop decoding after n frames \n");
+    H0( " -threads <arg>            Number of threads decoding tiles and running the loop filters, 0 for one per logical processor [default: 1] \n");
+    H0( " -frame-threads <arg>      Number of frames decoded in parallel [1-8, default: 1] \n");
+    H0( " -pipeline-recon           Reconstruct superblock rows on the other threads while one thread parses the tiles \n");
     H0( " -bit-depth <arg>          Input bitdepth. [8, 10] \n");
     H0( " -w <arg>                  Input picture width \n");
     H0( " -h <arg>                  Input picture height \n");
@@ -60,6 +73,11 @@ static void showHelp()
     H0( " -md5                      MD5 support flag \n");
     H0( " -fps-frm                  Show fps after each frame decoded");
     H0( " -fps-summary              Show fps summary");
+    H0( " -ext-fb                   Decode into application allocated frame buffers, output by reference \n");
+    H0( " -skip-film-grain          Output the pictures without film grain \n");
+    H0( " -skip-non-ref             Drop the frames no other frame references \n");
+    H0( " -skip-non-ref-filters     Skip CDEF and loop restoration on the frames no other frame references \n");
+    H0( " -region <x,y,w,h>         Output only this region of the frames, the frames no other frame references being decoded only around it \n");
 
 
     exit(1);
@@ -102,6 +120,8 @@ EbErrorType read_command_line(int32_t argc, char *const argv[],
                     cli->inFilename = config_strings[token_index];
                     if (file_is_ivf(cli))
                         cli->inFileType = FILE_TYPE_IVF;
+                    else if (file_is_obu(cli, &configs->is_annex_b))
+                        cli->inFileType = FILE_TYPE_OBU;
                     else {
                         printf("Unsupported input file format. \n");
                         return EB_ErrorBadParameter;
@@ -126,6 +146,16 @@ EbErrorType read_command_line(int32_t argc, char *const argv[],
                 cli->fps_frm = 1;
             else if (EB_STRCMP(cmd_copy[token_index], FPS_SUMMARY_TOKEN) == 0)
                 cli->fps_summary = 1;
+            else if (EB_STRCMP(cmd_copy[token_index], EXT_FRAME_BUF_TOKEN) == 0)
+                cli->ext_frame_buf = 1;
+            else if (EB_STRCMP(cmd_copy[token_index], SKIP_FILM_GRAIN_TOKEN) == 0)
+                configs->skip_film_grain = EB_TRUE;
+            else if (EB_STRCMP(cmd_copy[token_index], SKIP_NON_REF_FRAMES_TOKEN) == 0)
+                configs->skip_non_ref_frames = EB_TRUE;
+            else if (EB_STRCMP(cmd_copy[token_index], SKIP_NON_REF_FILTERS_TOKEN) == 0)
+                configs->skip_non_ref_filters = EB_TRUE;
+            else if (EB_STRCMP(cmd_copy[token_index], PIPELINE_RECON_TOKEN) == 0)
+                configs->pipeline_recon = EB_TRUE;
             else if (EB_STRCMP(cmd_copy[token_index], HELP_TOKEN) == 0)
                 showHelp();
             else {
@@ -172,5 +202,22 @@ EbErrorType read_command_line(int32_t argc, char *const argv[],
     if (cli->width != configs->max_picture_width)
         configs->max_picture_width = cli->width;
 
+    /* The output pictures are cropped to the region, as by the decoder */
+    if (configs->region_width && configs->region_height &&
+        cli->width && cli->height) {
+        uint32_t x = configs->region_left < cli->width ?
+            configs->region_left & ~1 : (cli->width - 1) & ~1;
+        uint32_t y = configs->region_top < cli->height ?
+            configs->region_top & ~1 : (cli->height - 1) & ~1;
+        if (configs->region_width < cli->width - x)
+            cli->width = configs->region_width;
+        else
+            cli->width -= x;
+        if (configs->region_height < cli->height - y)
+            cli->height = configs->region_height;
+        else
+            cli->height -= y;
+    }
+
     return EB_ErrorNone;
 }
@@ -34,9 +34,17 @@
 #define PIC_WIDTH_TOKEN                 "-w"
 #define PIC_HEIGHT_TOKEN                "-h"
 #define COLOUR_SPACE_TOKEN              "-colour-space"
+#define THREADS_TOKEN                   "-threads"
+#define FRAME_THREADS_TOKEN             "-frame-threads"
 #define MD5_SUPPORT_TOKEN               "-md5"
 #define FPS_FRM_TOKEN                   "-fps-frm"
 #define FPS_SUMMARY_TOKEN               "-fps-summary"
+#define EXT_FRAME_BUF_TOKEN             "-ext-fb"
+#define SKIP_FILM_GRAIN_TOKEN           "-skip-film-grain"
+#define SKIP_NON_REF_FRAMES_TOKEN       "-skip-non-ref"
+#define SKIP_NON_REF_FILTERS_TOKEN      "-skip-non-ref-filters"
+#define REGION_TOKEN                    "-region"
+#define PIPELINE_RECON_TOKEN            "-pipeline-recon"
 #define MAX_NUM_TOKENS 200
 
 #define EB_STRCMP(target,token) \
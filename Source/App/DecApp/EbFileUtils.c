@@ -118,3 +118,41 @@ int read_ivf_frame(FILE *infile, uint8_t **buffer, size_t *bytes_read,
     }
     return 0;
 }
+
+/* Raw OBUs, low overhead or Annex B : recognized by their sequence header */
+int file_is_obu(CLInput *cli, EbBool *is_annex_b) {
+    uint8_t raw_data[OBU_CHUNK_SIZE];
+    EbAV1StreamInfo stream_info;
+    int is_obu = 0;
+
+    size_t size = fread(raw_data, 1, OBU_CHUNK_SIZE, cli->inFile);
+    if (size > 0 && eb_peek_sequence_header(&stream_info, raw_data,
+        (uint32_t)size) == EB_ErrorNone)
+    {
+        is_obu = 1;
+        cli->width = stream_info.max_picture_width;
+        cli->height = stream_info.max_picture_height;
+        *is_annex_b = stream_info.is_annex_b;
+    }
+
+    rewind(cli->inFile);
+    return is_obu;
+}
+
+/* The next bytes of the stream, as if received from the network */
+int read_obu_chunk(FILE *infile, uint8_t **buffer, size_t *bytes_read,
+    size_t *buffer_size)
+{
+    if (*buffer_size < OBU_CHUNK_SIZE) {
+        uint8_t *new_buffer = (uint8_t *)realloc(*buffer, OBU_CHUNK_SIZE);
+        if (!new_buffer) {
+            printf("Failed to allocate compressed data buffer. \n");
+            return 0;
+        }
+        *buffer = new_buffer;
+        *buffer_size = OBU_CHUNK_SIZE;
+    }
+
+    *bytes_read = fread(*buffer, 1, OBU_CHUNK_SIZE, infile);
+    return *bytes_read > 0;
+}
@@ -51,8 +51,15 @@ typedef struct CLInput{
     uint32_t   enable_md5;
     uint32_t  fps_frm;
     uint32_t  fps_summary;
+    uint32_t  ext_frame_buf;
 }CLInput;
 
+/* Bytes of a raw OBU stream given to the decoder at a time */
+#define OBU_CHUNK_SIZE 4096
+
 int file_is_ivf(CLInput *cli);
 int read_ivf_frame(FILE *infile, uint8_t **buffer, size_t *bytes_read,
     size_t *buffer_size, int64_t *pts);
+int file_is_obu(CLInput *cli, EbBool *is_annex_b);
+int read_obu_chunk(FILE *infile, uint8_t **buffer, size_t *bytes_read,
+    size_t *buffer_size);
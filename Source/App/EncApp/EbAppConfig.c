@@ -29,6 +29,7 @@
 #define ERROR_FILE_TOKEN                "-errlog"
 #define QP_FILE_TOKEN                   "-qp-file"
 #define STAT_FILE_TOKEN                 "-stat-file"
+#define TRACE_FILE_TOKEN                "-trace-file"
 #define WIDTH_TOKEN                     "-w"
 #define HEIGHT_TOKEN                    "-h"
 #define NUMBER_OF_PICTURES_TOKEN        "-n"
@@ -37,6 +38,7 @@
 #define QP_TOKEN                        "-q"
 #define USE_QP_FILE_TOKEN               "-use-q-file"
 #define STAT_REPORT_TOKEN               "-stat-report"
+#define PIPELINE_STATS_TOKEN            "-pipeline-stats"
 #define FRAME_RATE_TOKEN                "-fps"
 #define FRAME_RATE_NUMERATOR_TOKEN      "-fps-num"
 #define FRAME_RATE_DENOMINATOR_TOKEN    "-fps-denom"
@@ -104,6 +106,13 @@
 #define ASM_TYPE_TOKEN                  "-asm"
 #define THREAD_MGMNT                    "-lp"
 #define TARGET_SOCKET                   "-ss"
+#define NUMA_MODE_TOKEN                 "-numa"
+#define TASK_SCHEDULER_TOKEN            "-task-sched"
+#define SHARED_TASK_SCHEDULER_TOKEN     "-shared-sched"
+#define ELASTIC_POOLS_TOKEN             "-elastic-pools"
+#define MAX_MEMORY_TOKEN                "-max-mem"
+#define PICTURE_ARENA_TOKEN             "-arena"
+#define ZERO_COPY_INPUT_TOKEN           "-zero-copy"
 #define CONFIG_FILE_COMMENT_CHAR    '#'
 #define CONFIG_FILE_NEWLINE_CHAR    '\n'
 #define CONFIG_FILE_RETURN_CHAR     '\r'
@@ -165,7 +174,15 @@ static void SetCfgStatFile(const char *value, EbConfig *cfg)
     if (cfg->stat_file) { fclose(cfg->stat_file); }
     FOPEN(cfg->stat_file, value, "wb");
 };
+static void SetCfgTraceFile                     (const char *value, EbConfig *cfg)
+{
+    free(cfg->trace_file_name);
+    cfg->trace_file_name = (char*)malloc(strlen(value) + 1);
+    if (cfg->trace_file_name)
+        strcpy(cfg->trace_file_name, value);
+};
 static void SetStatReport                       (const char *value, EbConfig *cfg) {cfg->stat_report = (uint8_t) strtoul(value, NULL, 0);};
+static void SetPipelineStats                    (const char *value, EbConfig *cfg) {cfg->pipeline_stats = (EbBool) strtoul(value, NULL, 0);};
 static void SetCfgSourceWidth                   (const char *value, EbConfig *cfg) {cfg->source_width = strtoul(value, NULL, 0);};
 static void SetInterlacedVideo                  (const char *value, EbConfig *cfg) {cfg->interlaced_video  = (EbBool) strtoul(value, NULL, 0);};
 static void SetSeperateFields                   (const char *value, EbConfig *cfg) {cfg->separate_fields = (EbBool) strtoul(value, NULL, 0);};
@@ -258,6 +275,13 @@ static void SetLatencyMode                      (const char *value, EbConfig *cf
 static void SetAsmType                          (const char *value, EbConfig *cfg)  {cfg->asm_type                   = (uint32_t)strtoul(value, NULL, 0);};
 static void SetLogicalProcessors                (const char *value, EbConfig *cfg)  {cfg->logical_processors         = (uint32_t)strtoul(value, NULL, 0);};
 static void SetTargetSocket                     (const char *value, EbConfig *cfg)  {cfg->target_socket              = (int32_t)strtol(value, NULL, 0);};
+static void SetNumaMode                         (const char *value, EbConfig *cfg)  {cfg->numa_mode                  = strtoul(value, NULL, 0);};
+static void SetEnableTaskScheduler              (const char *value, EbConfig *cfg)  {cfg->enable_task_scheduler      = (EbBool)strtoul(value, NULL, 0);};
+static void SetShareTaskScheduler               (const char *value, EbConfig *cfg)  {cfg->share_task_scheduler       = (EbBool)strtoul(value, NULL, 0);};
+static void SetElasticPools                     (const char *value, EbConfig *cfg)  {cfg->elastic_pools              = (EbBool)strtoul(value, NULL, 0);};
+static void SetMaxMemory                        (const char *value, EbConfig *cfg)  {cfg->max_memory_mb              = strtoul(value, NULL, 0);};
+static void SetPictureArena                     (const char *value, EbConfig *cfg)  {cfg->picture_arena              = strtoul(value, NULL, 0);};
+static void SetZeroCopyInput                    (const char *value, EbConfig *cfg)  {cfg->zero_copy_input            = (EbBool)strtoul(value, NULL, 0);};
 
 enum cfg_type{
     SINGLE_INPUT,   // Configuration parameters that have only 1 value input
@@ -285,6 +309,7 @@ config_entry_t config_entry[] = {
     { SINGLE_INPUT, OUTPUT_RECON_TOKEN, "ReconFile", SetCfgReconFile },
     { SINGLE_INPUT, QP_FILE_TOKEN, "QpFile", SetCfgQpFile },
     { SINGLE_INPUT, STAT_FILE_TOKEN, "StatFile", SetCfgStatFile },
+    { SINGLE_INPUT, TRACE_FILE_TOKEN, "TraceFile", SetCfgTraceFile },
 
     // Interlaced Video
     { SINGLE_INPUT, INTERLACED_VIDEO_TOKEN , "InterlacedVideo" , SetInterlacedVideo },
@@ -314,6 +339,7 @@ config_entry_t config_entry[] = {
     { SINGLE_INPUT, QP_TOKEN, "QP", SetCfgQp },
     { SINGLE_INPUT, USE_QP_FILE_TOKEN, "UseQpFile", SetCfgUseQpFile },
     { SINGLE_INPUT, STAT_REPORT_TOKEN, "StatReport", SetStatReport },
+    { SINGLE_INPUT, PIPELINE_STATS_TOKEN, "PipelineStats", SetPipelineStats },
     { SINGLE_INPUT, RATE_CONTROL_ENABLE_TOKEN, "RateControlMode", SetRateControlMode },
     { SINGLE_INPUT, LOOK_AHEAD_DIST_TOKEN, "LookAheadDistance",                             SetLookAheadDistance},
     { SINGLE_INPUT, TARGET_BIT_RATE_TOKEN, "TargetBitRate", SetTargetBitRate },
@@ -348,6 +374,13 @@ config_entry_t config_entry[] = {
     // Thread Management
     { SINGLE_INPUT, THREAD_MGMNT, "logicalProcessors", SetLogicalProcessors },
     { SINGLE_INPUT, TARGET_SOCKET, "TargetSocket", SetTargetSocket },
+    { SINGLE_INPUT, NUMA_MODE_TOKEN, "NumaMode", SetNumaMode },
+    { SINGLE_INPUT, TASK_SCHEDULER_TOKEN, "TaskScheduler", SetEnableTaskScheduler },
+    { SINGLE_INPUT, SHARED_TASK_SCHEDULER_TOKEN, "SharedTaskScheduler", SetShareTaskScheduler },
+    { SINGLE_INPUT, ELASTIC_POOLS_TOKEN, "ElasticPools", SetElasticPools },
+    { SINGLE_INPUT, MAX_MEMORY_TOKEN, "MaxMemory", SetMaxMemory },
+    { SINGLE_INPUT, PICTURE_ARENA_TOKEN, "PictureArena", SetPictureArena },
+    { SINGLE_INPUT, ZERO_COPY_INPUT_TOKEN, "ZeroCopyInput", SetZeroCopyInput },
     // Optional Features
 
 //    { SINGLE_INPUT, BITRATE_REDUCTION_TOKEN, "bit_rate_reduction", SetBitRateReduction },
@@ -417,6 +450,8 @@ void eb_config_ctor(EbConfig *config_ptr)
     config_ptr->qp                                   = 50;
     config_ptr->use_qp_file                          = EB_FALSE;
     config_ptr->stat_report                          = 0;
+    config_ptr->pipeline_stats                       = EB_FALSE;
+    config_ptr->trace_file_name                      = NULL;
 
     config_ptr->scene_change_detection               = 0;
     config_ptr->rate_control_mode                      = 0;
@@ -519,6 +554,13 @@ void eb_config_ctor(EbConfig *config_ptr)
     config_ptr->stop_encoder                          = 0;
     config_ptr->logical_processors                    = 0;
     config_ptr->target_socket                         = -1;
+    config_ptr->numa_mode                             = 0;
+    config_ptr->enable_task_scheduler                 = EB_FALSE;
+    config_ptr->share_task_scheduler                  = EB_FALSE;
+    config_ptr->elastic_pools                         = EB_FALSE;
+    config_ptr->max_memory_mb                         = 0;
+    config_ptr->picture_arena                         = 0;
+    config_ptr->zero_copy_input                       = EB_FALSE;
     config_ptr->processed_frame_count                  = 0;
     config_ptr->processed_byte_count                   = 0;
     config_ptr->tile_rows                            = 0;
@@ -577,6 +619,9 @@ void eb_config_dtor(EbConfig *config_ptr)
         fclose(config_ptr->stat_file);
         config_ptr->stat_file = (FILE *) NULL;
     }
+
+    free(config_ptr->trace_file_name);
+    config_ptr->trace_file_name = NULL;
     return;
 }
 
@@ -849,6 +894,39 @@ static EbErrorType VerifySettings(EbConfig *config, uint32_t channelNumber)
         return_error = EB_ErrorBadParameter;
     }
 
+    // NUMA mode
+    if (config->numa_mode > 1) {
+        fprintf(config->error_log_file, "Error instance %u: Invalid NUMA mode [0 - 1], your input: %u\n", channelNumber + 1, config->numa_mode);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    // Picture arena
+    if (config->picture_arena > 2) {
+        fprintf(config->error_log_file, "Error instance %u: Invalid picture arena mode [0 - 2], your input: %u\n", channelNumber + 1, config->picture_arena);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    // Zero copy input, frames are read straight into the padded pictures
+    if (config->zero_copy_input != 0 && config->zero_copy_input != 1) {
+        fprintf(config->error_log_file, "Error instance %u: Invalid zero copy input flag [0 - 1], your input: %d\n", channelNumber + 1, config->zero_copy_input);
+        return_error = EB_ErrorBadParameter;
+    }
+    if (config->zero_copy_input && (config->buffered_input != -1 || config->separate_fields || config->input_file == stdin)) {
+        fprintf(config->error_log_file, "Error instance %u: Zero copy input needs a file input without buffered input or separate fields\n", channelNumber + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    // Task scheduler
+    if (config->enable_task_scheduler != 0 && config->enable_task_scheduler != 1) {
+        fprintf(config->error_log_file, "Error instance %u: Invalid task scheduler flag [0 - 1], your input: %d\n", channelNumber + 1, config->enable_task_scheduler);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->share_task_scheduler != 0 && config->share_task_scheduler != 1) {
+        fprintf(config->error_log_file, "Error instance %u: Invalid shared task scheduler flag [0 - 1], your input: %d\n", channelNumber + 1, config->share_task_scheduler);
+        return_error = EB_ErrorBadParameter;
+    }
+
     // Local Warped Motion
     if (config->enable_warped_motion != 0 && config->enable_warped_motion != 1) {
         fprintf(config->error_log_file, "Error instance %u: Invalid warped motion flag [0 - 1], your input: %d\n", channelNumber + 1, config->target_socket);
@@ -179,12 +179,14 @@ typedef struct EbConfig
     FILE                    *buffer_file;
 
     FILE                    *qp_file;
+    char                    *trace_file_name;
 
     EbBool                  y4m_input;
     unsigned char           y4m_buf[9];
 
     EbBool                  use_qp_file;
     uint8_t                  stat_report;
+    EbBool                   pipeline_stats;
 
     uint32_t                 frame_rate;
     uint32_t                 frame_rate_numerator;
@@ -338,6 +340,13 @@ typedef struct EbConfig
     uint32_t                active_channel_count;
     uint32_t                logical_processors;
     int32_t                 target_socket;
+    uint32_t                numa_mode;
+    EbBool                  enable_task_scheduler;
+    EbBool                  share_task_scheduler;
+    EbBool                  elastic_pools;
+    uint32_t                max_memory_mb;
+    uint32_t                picture_arena;
+    EbBool                  zero_copy_input;
     EbBool                  stop_encoder;         // to signal CTRL+C Event, need to stop encoding.
 
     uint64_t                processed_frame_count;
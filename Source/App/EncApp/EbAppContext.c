@@ -8,6 +8,7 @@
  ***************************************/
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "EbAppContext.h"
 #include "EbAppConfig.h"
@@ -209,7 +210,16 @@ EbErrorType CopyConfigurationParameters(
     callback_data->eb_enc_parameters.asm_type = config->asm_type;
     callback_data->eb_enc_parameters.logical_processors = config->logical_processors;
     callback_data->eb_enc_parameters.target_socket = config->target_socket;
+    callback_data->eb_enc_parameters.numa_mode = config->numa_mode;
+    callback_data->eb_enc_parameters.enable_task_scheduler = config->enable_task_scheduler;
+    callback_data->eb_enc_parameters.share_task_scheduler = config->share_task_scheduler;
+    callback_data->eb_enc_parameters.elastic_pools = config->elastic_pools;
+    callback_data->eb_enc_parameters.max_memory_mb = config->max_memory_mb;
+    callback_data->eb_enc_parameters.picture_arena = config->picture_arena;
+    callback_data->eb_enc_parameters.zero_copy_input = config->zero_copy_input;
     callback_data->eb_enc_parameters.recon_enabled = config->recon_file ? EB_TRUE : EB_FALSE;
+    callback_data->eb_enc_parameters.trace_file_name = config->trace_file_name;
+    callback_data->eb_enc_parameters.enable_pipeline_stats = config->pipeline_stats;
     // --- start: ALTREF_FILTERING_SUPPORT
     callback_data->eb_enc_parameters.enable_altrefs  = (EbBool)config->enable_altrefs;
     callback_data->eb_enc_parameters.altref_strength = config->altref_strength;
@@ -291,11 +301,82 @@ static EbErrorType AllocateFrameBuffer(
     return return_error;
 }
 
+/***********************************
+ * Zero copy input
+ *   The frames are read into pictures laid out as the library asks for,
+ *   each one is busy from eb_svt_enc_send_picture until the library
+ *   gives it back.
+ ***********************************/
+static void AppInputReleaseCallback(
+    void                *context,
+    EbBufferHeaderType  *p_buffer)
+{
+    EbAppContext *callback_data = (EbAppContext*)context;
+    uint32_t      bufferIndex = (uint32_t)((EbBufferHeaderType*)p_buffer->p_app_private - callback_data->zero_copy_buffer_pool);
+
+    callback_data->zero_copy_buffer_busy[bufferIndex] = 0;
+}
+
+static EbErrorType AllocateZeroCopyInputBuffers(
+    EbAppContext            *callback_data)
+{
+    EbErrorType        return_error;
+    EbSvtInputLayout   layout;
+    uint32_t           bufferIndex;
+    uint8_t           *busyPtr;
+
+    return_error = eb_svt_enc_get_input_layout(callback_data->svt_encoder_handle, &layout);
+    if (return_error != EB_ErrorNone)
+        return return_error;
+
+    // One more than the library holds, so that a picture is always free
+    callback_data->zero_copy_buffer_count = layout.buffer_count + 1;
+    EB_APP_MALLOC(EbBufferHeaderType*, callback_data->zero_copy_buffer_pool, sizeof(EbBufferHeaderType) * callback_data->zero_copy_buffer_count, EB_N_PTR, EB_ErrorInsufficientResources);
+    EB_APP_MALLOC(uint8_t*, busyPtr, callback_data->zero_copy_buffer_count, EB_N_PTR, EB_ErrorInsufficientResources);
+    callback_data->zero_copy_buffer_busy = busyPtr;
+
+    for (bufferIndex = 0; bufferIndex < callback_data->zero_copy_buffer_count; ++bufferIndex) {
+        EbBufferHeaderType *headerPtr = &callback_data->zero_copy_buffer_pool[bufferIndex];
+        EbSvtIOFormat      *inputPtr;
+        const size_t        lumaSize = (size_t)layout.y_stride * (layout.top_padding + layout.height + layout.bottom_padding);
+        const size_t        chromaSize = (size_t)layout.cb_stride * ((layout.top_padding + layout.height + layout.bottom_padding) >> 1);
+        uint8_t            *lumaPtr;
+        uint8_t            *cbPtr;
+        uint8_t            *crPtr;
+
+        memset(headerPtr, 0, sizeof(EbBufferHeaderType));
+        headerPtr->size = sizeof(EbBufferHeaderType);
+        headerPtr->p_app_private = headerPtr;
+        headerPtr->pic_type = EB_AV1_INVALID_PICTURE;
+        EB_APP_MALLOC(uint8_t*, headerPtr->p_buffer, sizeof(EbSvtIOFormat), EB_N_PTR, EB_ErrorInsufficientResources);
+        EB_APP_MALLOC(uint8_t*, lumaPtr, lumaSize, EB_N_PTR, EB_ErrorInsufficientResources);
+        EB_APP_MALLOC(uint8_t*, cbPtr, chromaSize, EB_N_PTR, EB_ErrorInsufficientResources);
+        EB_APP_MALLOC(uint8_t*, crPtr, chromaSize, EB_N_PTR, EB_ErrorInsufficientResources);
+
+        inputPtr = (EbSvtIOFormat*)headerPtr->p_buffer;
+        memset(inputPtr, 0, sizeof(EbSvtIOFormat));
+        inputPtr->y_stride = layout.y_stride;
+        inputPtr->cb_stride = layout.cb_stride;
+        inputPtr->cr_stride = layout.cr_stride;
+        inputPtr->luma = lumaPtr + layout.y_stride * layout.top_padding + layout.left_padding;
+        inputPtr->cb = cbPtr + layout.cb_stride * (layout.top_padding >> 1) + (layout.left_padding >> 1);
+        inputPtr->cr = crPtr + layout.cr_stride * (layout.top_padding >> 1) + (layout.left_padding >> 1);
+        callback_data->zero_copy_buffer_busy[bufferIndex] = 0;
+    }
+
+    return EB_ErrorNone;
+}
+
 EbErrorType AllocateInputBuffers(
     EbConfig                *config,
     EbAppContext            *callback_data)
 {
     EbErrorType   return_error = EB_ErrorNone;
+    if (config->zero_copy_input) {
+        return_error = AllocateZeroCopyInputBuffers(callback_data);
+        if (return_error != EB_ErrorNone)
+            return return_error;
+    }
     {
         EB_APP_MALLOC(EbBufferHeaderType*, callback_data->input_buffer_pool, sizeof(EbBufferHeaderType), EB_N_PTR, EB_ErrorInsufficientResources);
 
@@ -304,7 +385,7 @@ EbErrorType AllocateInputBuffers(
 
         EB_APP_MALLOC(uint8_t*, callback_data->input_buffer_pool->p_buffer, sizeof(EbSvtIOFormat), EB_N_PTR, EB_ErrorInsufficientResources);
 
-        if (config->buffered_input == -1) {
+        if (config->buffered_input == -1 && !config->zero_copy_input) {
             // Allocate frame buffer for the p_buffer
             AllocateFrameBuffer(
                     config,
@@ -563,6 +644,14 @@ EbErrorType init_encoder(
 
     if (return_error != EB_ErrorNone)
         return return_error;
+    if (config->zero_copy_input) {
+        return_error = eb_svt_enc_set_input_release_callback(
+                           callback_data->svt_encoder_handle,
+                           AppInputReleaseCallback,
+                           callback_data);
+        if (return_error != EB_ErrorNone)
+            return return_error;
+    }
     // STEP 5: Init Encoder
     return_error = eb_init_encoder(callback_data->svt_encoder_handle);
     if (return_error != EB_ErrorNone) { return return_error; }
@@ -27,6 +27,11 @@ typedef struct EbAppContext {
     EbBufferHeaderType                *stream_buffer_pool;
     EbBufferHeaderType                *recon_buffer;
 
+    // Zero copy input, pictures lent to the library until it releases them
+    EbBufferHeaderType                *zero_copy_buffer_pool;
+    volatile uint8_t                  *zero_copy_buffer_busy;
+    uint32_t                           zero_copy_buffer_count;
+
     // Instance Index
     uint8_t                            instance_idx;
 } EbAppContext;
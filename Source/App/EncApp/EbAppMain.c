@@ -78,6 +78,33 @@ void AssignAppThreadGroup(uint8_t target_socket) {
 
 double get_psnr(double sse, double max);
 
+/***************************************
+ * Pipeline statistics of one channel
+ *   Times are summed over the threads of
+ *   each stage and printed in ms.
+ ***************************************/
+static void PrintPipelineStats(EbComponentType *svt_encoder_handle) {
+    EbSvtPipelineStats stats;
+    uint32_t           stageIndex;
+
+    if (eb_svt_get_pipeline_stats(svt_encoder_handle, &stats) != EB_ErrorNone)
+        return;
+    printf("\nPIPELINE STATS (elapsed %.0f ms)\n", stats.elapsed_time / 1000.0);
+    printf("%-28s %8s %10s %12s %12s %12s %6s\n",
+        "Stage", "Threads", "Objects", "Busy ms", "In Wait ms", "Out Wait ms", "Depth");
+    for (stageIndex = 0; stageIndex < stats.stage_count; ++stageIndex) {
+        const EbSvtStageStats *stage_ptr = &stats.stage_array[stageIndex];
+        printf("%-28s %8u %10llu %12.1f %12.1f %12.1f %6u\n",
+            stage_ptr->name,
+            stage_ptr->thread_count,
+            (unsigned long long)stage_ptr->processed_object_count,
+            stage_ptr->busy_time / 1000.0,
+            stage_ptr->input_wait_time / 1000.0,
+            stage_ptr->output_wait_time / 1000.0,
+            stage_ptr->input_queue_depth);
+    }
+}
+
 /***************************************
  * Encoder App Main
  ***************************************/
@@ -291,6 +318,9 @@ int32_t main(int32_t argc, char* argv[])
                                     (float)(get_psnr((configs[instanceCount]->performance_context.sum_cr_sse / frame_count), max_chroma_sse)));
                             }
 
+                            if (configs[instanceCount]->pipeline_stats)
+                                PrintPipelineStats(appCallbacks[instanceCount]->svt_encoder_handle);
+
                             fflush(stdout);
                         }
                     }
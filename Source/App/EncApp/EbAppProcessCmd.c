@@ -743,6 +743,47 @@ int32_t GetNextQpFromQpFile(
     return qp;
 }
 
+/*
+ * Zero copy input: reads an 8 bit 4:2:0 frame row by row into the padded
+ * picture lent to the library, rewinding the file at its end.
+ */
+static uint32_t ReadInputPlaneRows(
+    FILE                       *input_file,
+    uint8_t                    *plane,
+    uint32_t                    stride,
+    uint32_t                    width,
+    uint32_t                    height)
+{
+    uint32_t readSize = 0;
+    uint32_t rowIndex;
+
+    for (rowIndex = 0; rowIndex < height; ++rowIndex)
+        readSize += (uint32_t)fread(plane + (size_t)stride * rowIndex, 1, width, input_file);
+    return readSize;
+}
+
+static void ReadZeroCopyInputFrame(
+    EbConfig                  *config,
+    EbBufferHeaderType         *headerPtr)
+{
+    const uint32_t  input_padded_width = config->input_padded_width;
+    const uint32_t  input_padded_height = config->input_padded_height;
+    const uint64_t  readSize = (uint64_t)SIZE_OF_ONE_FRAME_IN_BYTES(input_padded_width, input_padded_height, EB_YUV420, 0);
+    EbSvtIOFormat  *inputPtr = (EbSvtIOFormat*)headerPtr->p_buffer;
+    uint32_t        pass;
+
+    if (config->y4m_input == EB_TRUE)
+        read_y4m_frame_delimiter(config);
+    for (pass = 0; pass < 2; ++pass) {
+        headerPtr->n_filled_len = ReadInputPlaneRows(config->input_file, inputPtr->luma, inputPtr->y_stride, input_padded_width, input_padded_height);
+        headerPtr->n_filled_len += ReadInputPlaneRows(config->input_file, inputPtr->cb, inputPtr->cb_stride, input_padded_width >> 1, input_padded_height >> 1);
+        headerPtr->n_filled_len += ReadInputPlaneRows(config->input_file, inputPtr->cr, inputPtr->cr_stride, input_padded_width >> 1, input_padded_height >> 1);
+        if (readSize == headerPtr->n_filled_len)
+            break;
+        fseek(config->input_file, 0, SEEK_SET);
+    }
+}
+
 void ReadInputFrames(
     EbConfig                  *config,
     uint8_t                      is16bit,
@@ -983,14 +1024,28 @@ AppExitConditionType ProcessInputBuffer(
 
     // If there are bytes left to encode, configure the header
     if (remainingByteCount != 0 && config->stop_encoder == EB_FALSE) {
-        ReadInputFrames(
-            config,
-            is16bit,
-            headerPtr);
+        uint32_t bufferIndex = 0;
+
+        if (config->zero_copy_input) {
+            // Wait for the library to give a picture back
+            while (bufferIndex < appCallBack->zero_copy_buffer_count && appCallBack->zero_copy_buffer_busy[bufferIndex])
+                ++bufferIndex;
+            if (bufferIndex == appCallBack->zero_copy_buffer_count)
+                return return_value;
+            headerPtr = &appCallBack->zero_copy_buffer_pool[bufferIndex];
+            ReadZeroCopyInputFrame(
+                config,
+                headerPtr);
+        }
+        else
+            ReadInputFrames(
+                config,
+                is16bit,
+                headerPtr);
         if (headerPtr->n_filled_len) {
             // Update the context parameters
             config->processed_byte_count += headerPtr->n_filled_len;
-            headerPtr->p_app_private          = (EbPtr)EB_NULL;
+            headerPtr->p_app_private          = config->zero_copy_input ? (EbPtr)headerPtr : (EbPtr)EB_NULL;
             config->frames_encoded           = (int32_t)(++config->processed_frame_count);
 
             // Configuration parameters changed on the fly
@@ -1008,10 +1063,13 @@ AppExitConditionType ProcessInputBuffer(
             headerPtr->flags = 0;
 
             // Send the picture
+            if (config->zero_copy_input)
+                appCallBack->zero_copy_buffer_busy[bufferIndex] = 1;
             eb_svt_enc_send_picture(componentHandle, headerPtr);
         }
 
         if ((config->processed_frame_count == (uint64_t)config->frames_to_be_encoded) || config->stop_encoder) {
+            headerPtr = appCallBack->input_buffer_pool;
             headerPtr->n_alloc_len    = 0;
             headerPtr->n_filled_len   = 0;
             headerPtr->n_tick_count   = 0;
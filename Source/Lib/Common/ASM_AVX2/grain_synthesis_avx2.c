@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include "EbDefinitions.h"
+#include <immintrin.h>
+#include "aom_dsp_rtcd.h"
+
+// Scaling of 8 samples : lut[x] for 8 bit, interpolated between lut[x] and
+// lut[x + 1] for high bit depth. The LUT has an entry 256 equal to entry 255
+static INLINE __m256i scale_lut_avx2(const int32_t *scaling_lut, __m256i index,
+    int32_t bit_depth) {
+    if (bit_depth == 8)
+        return _mm256_i32gather_epi32(scaling_lut, index, 4);
+
+    const __m128i shift = _mm_cvtsi32_si128(bit_depth - 8);
+    const __m256i x = _mm256_srl_epi32(index, shift);
+    const __m256i frac = _mm256_and_si256(index,
+        _mm256_set1_epi32((1 << (bit_depth - 8)) - 1));
+    const __m256i l0 = _mm256_i32gather_epi32(scaling_lut, x, 4);
+    const __m256i l1 = _mm256_i32gather_epi32(scaling_lut + 1, x, 4);
+    __m256i delta = _mm256_mullo_epi32(_mm256_sub_epi32(l1, l0), frac);
+
+    delta = _mm256_add_epi32(delta, _mm256_set1_epi32(1 << (bit_depth - 9)));
+    return _mm256_add_epi32(l0, _mm256_sra_epi32(delta, shift));
+}
+
+// clamp(src + ((scale * grain + round) >> shift), min, max) of 8 samples
+static INLINE __m256i add_noise_avx2(__m256i src, __m256i scale,
+    const int32_t *grain, __m256i round, __m128i shift, __m256i min_val,
+    __m256i max_val) {
+    __m256i noise = _mm256_mullo_epi32(scale,
+        _mm256_loadu_si256((const __m256i *)grain));
+
+    noise = _mm256_sra_epi32(_mm256_add_epi32(noise, round), shift);
+    return _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(src, noise),
+        min_val), max_val);
+}
+
+static INLINE void store_8_lbd(uint8_t *dst, __m256i v) {
+    const __m128i w = _mm_packs_epi32(_mm256_castsi256_si128(v),
+        _mm256_extracti128_si256(v, 1));
+    _mm_storel_epi64((__m128i *)dst, _mm_packus_epi16(w, w));
+}
+
+static INLINE void store_8_hbd(uint16_t *dst, __m256i v) {
+    _mm_storeu_si128((__m128i *)dst, _mm_packus_epi32(
+        _mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+}
+
+// Luma scaling index of 8 chroma samples, from the luma average of 2 samples
+// when subsampled horizontally
+static INLINE __m256i chroma_index_avx2(__m256i src, __m256i average_luma,
+    int32_t mult, int32_t luma_mult, int32_t offset, int32_t max_index) {
+    __m256i index = _mm256_add_epi32(
+        _mm256_mullo_epi32(average_luma, _mm256_set1_epi32(luma_mult)),
+        _mm256_mullo_epi32(src, _mm256_set1_epi32(mult)));
+
+    index = _mm256_add_epi32(_mm256_srai_epi32(index, 6),
+        _mm256_set1_epi32(offset));
+    return _mm256_min_epi32(_mm256_max_epi32(index, _mm256_setzero_si256()),
+        _mm256_set1_epi32(max_index));
+}
+
+void eb_av1_grain_ar_sum_avx2(const int32_t *grain, int32_t grain_stride,
+    const int32_t *ar_coeffs, int32_t ar_coeff_lag, int32_t width,
+    int32_t *wsum) {
+    int32_t j = 0;
+
+    for (; j + 8 <= width; j += 8) {
+        __m256i sum = _mm256_setzero_si256();
+        int32_t pos = 0;
+        for (int32_t row = -ar_coeff_lag; row < 0; row++) {
+            const int32_t *g = grain + row * grain_stride + j;
+            for (int32_t col = -ar_coeff_lag; col <= ar_coeff_lag; col++) {
+                const __m256i v = _mm256_loadu_si256((const __m256i *)(g + col));
+                sum = _mm256_add_epi32(sum, _mm256_mullo_epi32(v,
+                    _mm256_set1_epi32(ar_coeffs[pos++])));
+            }
+        }
+        _mm256_storeu_si256((__m256i *)(wsum + j), sum);
+    }
+    if (j < width)
+        eb_av1_grain_ar_sum_c(grain + j, grain_stride, ar_coeffs, ar_coeff_lag,
+            width - j, wsum + j);
+}
+
+void eb_av1_add_noise_luma_row_avx2(const uint8_t *src, uint8_t *dst,
+    const int32_t *grain, const int32_t *scaling_lut, int32_t width,
+    int32_t scaling_shift, int32_t min_val, int32_t max_val) {
+    const __m256i round = _mm256_set1_epi32(1 << (scaling_shift - 1));
+    const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+    const __m256i min_v = _mm256_set1_epi32(min_val);
+    const __m256i max_v = _mm256_set1_epi32(max_val);
+    int32_t j = 0;
+
+    for (; j + 8 <= width; j += 8) {
+        const __m256i s = _mm256_cvtepu8_epi32(
+            _mm_loadl_epi64((const __m128i *)(src + j)));
+        const __m256i scale = _mm256_i32gather_epi32(scaling_lut, s, 4);
+        store_8_lbd(dst + j, add_noise_avx2(s, scale, grain + j, round, shift,
+            min_v, max_v));
+    }
+    if (j < width)
+        eb_av1_add_noise_luma_row_c(src + j, dst + j, grain + j, scaling_lut,
+            width - j, scaling_shift, min_val, max_val);
+}
+
+void eb_av1_add_noise_chroma_row_avx2(const uint8_t *src, uint8_t *dst,
+    const uint8_t *luma, const int32_t *grain, const int32_t *scaling_lut,
+    int32_t width, int32_t subsamp_x, int32_t mult, int32_t luma_mult,
+    int32_t offset, int32_t scaling_shift, int32_t min_val, int32_t max_val) {
+    const __m256i round = _mm256_set1_epi32(1 << (scaling_shift - 1));
+    const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+    const __m256i min_v = _mm256_set1_epi32(min_val);
+    const __m256i max_v = _mm256_set1_epi32(max_val);
+    int32_t j = 0;
+
+    for (; j + 8 <= width; j += 8) {
+        const __m256i s = _mm256_cvtepu8_epi32(
+            _mm_loadl_epi64((const __m128i *)(src + j)));
+        __m256i average_luma;
+        if (subsamp_x) {
+            const __m128i l = _mm_loadu_si128((const __m128i *)(luma + (j << 1)));
+            __m128i pair_sum = _mm_maddubs_epi16(l, _mm_set1_epi8(1));
+            pair_sum = _mm_srli_epi16(_mm_add_epi16(pair_sum, _mm_set1_epi16(1)), 1);
+            average_luma = _mm256_cvtepu16_epi32(pair_sum);
+        }
+        else
+            average_luma = _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64((const __m128i *)(luma + j)));
+        const __m256i index = chroma_index_avx2(s, average_luma, mult,
+            luma_mult, offset, 255);
+        const __m256i scale = _mm256_i32gather_epi32(scaling_lut, index, 4);
+        store_8_lbd(dst + j, add_noise_avx2(s, scale, grain + j, round, shift,
+            min_v, max_v));
+    }
+    if (j < width)
+        eb_av1_add_noise_chroma_row_c(src + j, dst + j, luma + (j << subsamp_x),
+            grain + j, scaling_lut, width - j, subsamp_x, mult, luma_mult,
+            offset, scaling_shift, min_val, max_val);
+}
+
+void eb_av1_highbd_add_noise_luma_row_avx2(const uint16_t *src, uint16_t *dst,
+    const int32_t *grain, const int32_t *scaling_lut, int32_t width,
+    int32_t scaling_shift, int32_t min_val, int32_t max_val,
+    int32_t bit_depth) {
+    const __m256i round = _mm256_set1_epi32(1 << (scaling_shift - 1));
+    const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+    const __m256i min_v = _mm256_set1_epi32(min_val);
+    const __m256i max_v = _mm256_set1_epi32(max_val);
+    int32_t j = 0;
+
+    for (; j + 8 <= width; j += 8) {
+        const __m256i s = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128((const __m128i *)(src + j)));
+        const __m256i scale = scale_lut_avx2(scaling_lut, s, bit_depth);
+        store_8_hbd(dst + j, add_noise_avx2(s, scale, grain + j, round, shift,
+            min_v, max_v));
+    }
+    if (j < width)
+        eb_av1_highbd_add_noise_luma_row_c(src + j, dst + j, grain + j,
+            scaling_lut, width - j, scaling_shift, min_val, max_val, bit_depth);
+}
+
+void eb_av1_highbd_add_noise_chroma_row_avx2(const uint16_t *src, uint16_t *dst,
+    const uint16_t *luma, const int32_t *grain, const int32_t *scaling_lut,
+    int32_t width, int32_t subsamp_x, int32_t mult, int32_t luma_mult,
+    int32_t offset, int32_t scaling_shift, int32_t min_val, int32_t max_val,
+    int32_t bit_depth) {
+    const __m256i round = _mm256_set1_epi32(1 << (scaling_shift - 1));
+    const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+    const __m256i min_v = _mm256_set1_epi32(min_val);
+    const __m256i max_v = _mm256_set1_epi32(max_val);
+    const int32_t max_index = (256 << (bit_depth - 8)) - 1;
+    int32_t j = 0;
+
+    for (; j + 8 <= width; j += 8) {
+        const __m256i s = _mm256_cvtepu16_epi32(
+            _mm_loadu_si128((const __m128i *)(src + j)));
+        __m256i average_luma;
+        if (subsamp_x) {
+            const __m256i l = _mm256_loadu_si256((const __m256i *)(luma + (j << 1)));
+            average_luma = _mm256_madd_epi16(l, _mm256_set1_epi16(1));
+            average_luma = _mm256_srai_epi32(_mm256_add_epi32(average_luma,
+                _mm256_set1_epi32(1)), 1);
+        }
+        else
+            average_luma = _mm256_cvtepu16_epi32(
+                _mm_loadu_si128((const __m128i *)(luma + j)));
+        const __m256i index = chroma_index_avx2(s, average_luma, mult,
+            luma_mult, offset, max_index);
+        const __m256i scale = scale_lut_avx2(scaling_lut, index, bit_depth);
+        store_8_hbd(dst + j, add_noise_avx2(s, scale, grain + j, round, shift,
+            min_v, max_v));
+    }
+    if (j < width)
+        eb_av1_highbd_add_noise_chroma_row_c(src + j, dst + j,
+            luma + (j << subsamp_x), grain + j, scaling_lut, width - j,
+            subsamp_x, mult, luma_mult, offset, scaling_shift, min_val,
+            max_val, bit_depth);
+}
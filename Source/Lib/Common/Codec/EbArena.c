@@ -0,0 +1,263 @@
+/*
+* Copyright(c) 2019 Intel Corporation
+* SPDX - License - Identifier: BSD - 2 - Clause - Patent
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "EbArena.h"
+#include "EbMalloc.h"
+#include "EbNuma.h"
+#include "EbThreads.h"
+#include "EbUtility.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#define ARENA_MMAP                      1
+#else
+#define ARENA_MMAP                      0
+#endif
+
+static EB_THREAD_LOCAL EbArena *current_arena_ptr = NULL;
+static EB_THREAD_LOCAL uint32_t pool_arena_mode = EB_ARENA_OFF;
+
+/**************************************
+ * Region mapping
+ *   The regions are EB_ARENA_REGION_ALIGN aligned so that the kernel can
+ *   back them with huge pages. hugetlb_ptr reports whether the region
+ *   came from the huge page pool.
+ **************************************/
+static uint8_t *eb_arena_map_region(
+    size_t  size,
+    EbBool  hugetlb,
+    EbBool *hugetlb_ptr)
+{
+    *hugetlb_ptr = EB_FALSE;
+#if ARENA_MMAP
+    uint8_t  *map_ptr;
+    uintptr_t start;
+    size_t    head;
+
+#ifdef MAP_HUGETLB
+    if (hugetlb) {
+        map_ptr = (uint8_t*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (map_ptr != (uint8_t*)MAP_FAILED) {
+            *hugetlb_ptr = EB_TRUE;
+            return map_ptr;
+        }
+    }
+#else
+    (void)hugetlb;
+#endif
+    // Over map by one alignment and trim both ends
+    map_ptr = (uint8_t*)mmap(NULL, size + EB_ARENA_REGION_ALIGN, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map_ptr == (uint8_t*)MAP_FAILED)
+        return NULL;
+    start = ((uintptr_t)map_ptr + EB_ARENA_REGION_ALIGN - 1) & ~(uintptr_t)(EB_ARENA_REGION_ALIGN - 1);
+    head = (size_t)(start - (uintptr_t)map_ptr);
+    if (head)
+        munmap(map_ptr, head);
+    if (EB_ARENA_REGION_ALIGN - head)
+        munmap((uint8_t*)start + size, EB_ARENA_REGION_ALIGN - head);
+#ifdef MADV_HUGEPAGE
+    madvise((void*)start, size, MADV_HUGEPAGE);
+#endif
+    return (uint8_t*)start;
+#elif defined(_WIN32)
+    (void)hugetlb;
+    return (uint8_t*)_aligned_malloc(size, EB_ARENA_REGION_ALIGN);
+#else
+    void *region_ptr = NULL;
+    (void)hugetlb;
+    if (posix_memalign(&region_ptr, EB_ARENA_REGION_ALIGN, size) != 0)
+        return NULL;
+    return (uint8_t*)region_ptr;
+#endif
+}
+
+static void eb_arena_unmap_region(
+    uint8_t *base_ptr,
+    size_t   size)
+{
+#if ARENA_MMAP
+    munmap(base_ptr, size);
+#elif defined(_WIN32)
+    (void)size;
+    _aligned_free(base_ptr);
+#else
+    (void)size;
+    free(base_ptr);
+#endif
+}
+
+static void eb_arena_dctor(EbPtr p)
+{
+    EbArena       *obj = (EbArena*)p;
+    EbArenaRegion *region_ptr = obj->region_list;
+
+    while (region_ptr) {
+        EbArenaRegion *next_ptr = region_ptr->next_ptr;
+        eb_arena_unmap_region(region_ptr->base_ptr, region_ptr->size);
+        EB_FREE(region_ptr);
+        region_ptr = next_ptr;
+    }
+    EB_DESTROY_MUTEX(obj->arena_mutex);
+}
+
+/**************************************
+ * eb_arena_ctor
+ *   No region is mapped until the first block is allocated.
+ **************************************/
+EbErrorType eb_arena_ctor(
+    EbArena  *arena_ptr,
+    uint32_t  mode)
+{
+    arena_ptr->dctor = eb_arena_dctor;
+    arena_ptr->mode = mode;
+    arena_ptr->next_region_size = EB_ARENA_REGION_ALIGN;
+    EB_CREATE_MUTEX(arena_ptr->arena_mutex);
+
+    return EB_ErrorNone;
+}
+
+/**************************************
+ * eb_arena_add_region
+ *   The arena_mutex is held.
+ **************************************/
+static EbArenaRegion *eb_arena_add_region(
+    EbArena *arena_ptr,
+    size_t   min_size)
+{
+    EbArenaRegion *region_ptr;
+    size_t         size = MAX(arena_ptr->next_region_size, min_size);
+
+    size = (size + EB_ARENA_REGION_ALIGN - 1) & ~(size_t)(EB_ARENA_REGION_ALIGN - 1);
+
+    EB_NO_THROW_CALLOC(region_ptr, 1, sizeof(EbArenaRegion));
+    if (region_ptr == NULL)
+        return NULL;
+    region_ptr->base_ptr = eb_arena_map_region(size, arena_ptr->mode == EB_ARENA_HUGETLB, &region_ptr->hugetlb);
+    if (region_ptr->base_ptr == NULL) {
+        EB_FREE(region_ptr);
+        return NULL;
+    }
+    region_ptr->size = size;
+    eb_numa_bind_memory(region_ptr->base_ptr, size);
+
+    // Newest first, blocks are only carved from the head region
+    region_ptr->next_ptr = arena_ptr->region_list;
+    arena_ptr->region_list = region_ptr;
+    arena_ptr->next_region_size = MIN(2 * size, (size_t)EB_ARENA_REGION_MAX_SIZE);
+
+    arena_ptr->stats.region_count++;
+    arena_ptr->stats.reserved_size += size;
+    if (region_ptr->hugetlb)
+        arena_ptr->stats.hugetlb_size += size;
+
+    return region_ptr;
+}
+
+/**************************************
+ * eb_arena_alloc
+ **************************************/
+void *eb_arena_alloc(
+    EbArena *arena_ptr,
+    size_t   size)
+{
+    const size_t   dataSize = (size + ALVALUE - 1) & ~(size_t)(ALVALUE - 1);
+    const size_t   blockSize = EB_ARENA_BLOCK_HEADER_SIZE + dataSize;
+    EbArenaBlock **prev_ptr;
+    EbArenaBlock  *block_ptr;
+    EbArenaRegion *region_ptr;
+
+    eb_block_on_mutex(arena_ptr->arena_mutex);
+
+    // A freed block of the same size first
+    for (prev_ptr = &arena_ptr->free_list; *prev_ptr; prev_ptr = &(*prev_ptr)->next_ptr) {
+        if ((*prev_ptr)->size == dataSize)
+            break;
+    }
+    block_ptr = *prev_ptr;
+    if (block_ptr)
+        *prev_ptr = block_ptr->next_ptr;
+    else {
+        region_ptr = arena_ptr->region_list;
+        if (region_ptr == NULL || region_ptr->size - region_ptr->used_size < blockSize)
+            region_ptr = eb_arena_add_region(arena_ptr, blockSize);
+        if (region_ptr) {
+            block_ptr = (EbArenaBlock*)(region_ptr->base_ptr + region_ptr->used_size);
+            block_ptr->size = dataSize;
+            region_ptr->used_size += blockSize;
+        }
+    }
+    if (block_ptr) {
+        block_ptr->next_ptr = NULL;
+        arena_ptr->stats.block_count++;
+        arena_ptr->stats.used_size += dataSize;
+        arena_ptr->stats.peak_size = MAX(arena_ptr->stats.peak_size, arena_ptr->stats.used_size);
+    }
+
+    eb_release_mutex(arena_ptr->arena_mutex);
+
+    if (block_ptr == NULL)
+        return NULL;
+    eb_add_thread_memory(block_ptr, dataSize);
+    return (uint8_t*)block_ptr + EB_ARENA_BLOCK_HEADER_SIZE;
+}
+
+/**************************************
+ * eb_arena_free
+ **************************************/
+void eb_arena_free(
+    EbArena *arena_ptr,
+    void    *ptr)
+{
+    EbArenaBlock *block_ptr;
+
+    if (ptr == NULL)
+        return;
+    block_ptr = (EbArenaBlock*)((uint8_t*)ptr - EB_ARENA_BLOCK_HEADER_SIZE);
+
+    eb_block_on_mutex(arena_ptr->arena_mutex);
+    block_ptr->next_ptr = arena_ptr->free_list;
+    arena_ptr->free_list = block_ptr;
+    arena_ptr->stats.block_count--;
+    arena_ptr->stats.used_size -= block_ptr->size;
+    eb_release_mutex(arena_ptr->arena_mutex);
+}
+
+/**************************************
+ * eb_arena_get_stats
+ **************************************/
+void eb_arena_get_stats(
+    EbArena      *arena_ptr,
+    EbArenaStats *stats_ptr)
+{
+    eb_block_on_mutex(arena_ptr->arena_mutex);
+    *stats_ptr = arena_ptr->stats;
+    eb_release_mutex(arena_ptr->arena_mutex);
+}
+
+/**************************************
+ * Current arena
+ **************************************/
+void eb_arena_set_current(EbArena *arena_ptr)
+{
+    current_arena_ptr = arena_ptr;
+}
+
+EbArena *eb_arena_get_current(void)
+{
+    return current_arena_ptr;
+}
+
+void eb_arena_set_pool_mode(uint32_t mode)
+{
+    pool_arena_mode = mode;
+}
+
+uint32_t eb_arena_get_pool_mode(void)
+{
+    return pool_arena_mode;
+}
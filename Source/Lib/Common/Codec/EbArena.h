@@ -0,0 +1,116 @@
+/*
+* Copyright(c) 2019 Intel Corporation
+* SPDX - License - Identifier: BSD - 2 - Clause - Patent
+*/
+
+#ifndef EbArena_h
+#define EbArena_h
+
+#include "EbDefinitions.h"
+#include "EbObject.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+    /*********************************
+     * Defines
+     *********************************/
+#define EB_ARENA_OFF                    0
+#define EB_ARENA_ON                     1   // regions advised for transparent huge pages
+#define EB_ARENA_HUGETLB                2   // regions mapped from the huge page pool, EB_ARENA_ON if it is empty
+
+    // Regions are aligned on and sized in huge pages
+#define EB_ARENA_REGION_ALIGN           (2 * 1024 * 1024)
+    // Each region is twice the previous one, up to this size
+#define EB_ARENA_REGION_MAX_SIZE        (64 * 1024 * 1024)
+
+    /*********************************************************************
+     * Arena Block
+     *   Header in front of every block, the data that follows is ALVALUE
+     *   aligned.
+     *********************************************************************/
+    typedef struct EbArenaBlock
+    {
+        struct EbArenaBlock    *next_ptr;   // next free block, while on the free list
+        size_t                  size;       // data bytes
+    } EbArenaBlock;
+
+#define EB_ARENA_BLOCK_HEADER_SIZE      ((sizeof(EbArenaBlock) + ALVALUE - 1) & ~(size_t)(ALVALUE - 1))
+
+    typedef struct EbArenaRegion
+    {
+        struct EbArenaRegion   *next_ptr;
+        uint8_t                *base_ptr;
+        size_t                  size;
+        size_t                  used_size;
+        EbBool                  hugetlb;
+    } EbArenaRegion;
+
+    typedef struct EbArenaStats
+    {
+        uint32_t                region_count;
+        uint64_t                reserved_size;  // bytes mapped by the regions
+        uint64_t                hugetlb_size;   // part of reserved_size from the huge page pool
+        uint64_t                used_size;      // bytes held by live blocks
+        uint64_t                peak_size;      // highest used_size
+        uint32_t                block_count;    // live blocks
+    } EbArenaStats;
+
+    /*********************************************************************
+     * Arena
+     *   Carves the picture planes of one pool out of large regions instead
+     *   of one heap allocation per plane. Freed blocks go to a free list
+     *   and are reused by blocks of the same size, which is what a pool of
+     *   identical pictures asks for; regions are only returned to the
+     *   system with the arena.
+     *********************************************************************/
+    typedef struct EbArena
+    {
+        EbDctor                 dctor;
+        uint32_t                mode;
+        EbHandle                arena_mutex;
+        EbArenaRegion          *region_list;
+        EbArenaBlock           *free_list;
+        size_t                  next_region_size;
+        EbArenaStats            stats;
+    } EbArena;
+
+    extern EbErrorType eb_arena_ctor(
+        EbArena          *arena_ptr,
+        uint32_t          mode);
+
+    // Returns ALVALUE aligned memory, NULL when out of memory
+    extern void *eb_arena_alloc(
+        EbArena          *arena_ptr,
+        size_t            size);
+
+    extern void eb_arena_free(
+        EbArena          *arena_ptr,
+        void             *ptr);
+
+    extern void eb_arena_get_stats(
+        EbArena          *arena_ptr,
+        EbArenaStats     *stats_ptr);
+
+    /*********************************************************************
+     * Current arena
+     *   Picture buffers constructed by the calling thread take their planes
+     *   from the current arena, NULL allocates them from the heap.
+     *********************************************************************/
+    extern void eb_arena_set_current(EbArena *arena_ptr);
+
+    extern EbArena *eb_arena_get_current(void);
+
+    /*********************************************************************
+     * eb_arena_set_pool_mode
+     *   System resources constructed by the calling thread while the mode
+     *   is not EB_ARENA_OFF get an arena of their own, made current while
+     *   their objects are constructed.
+     *********************************************************************/
+    extern void eb_arena_set_pool_mode(uint32_t mode);
+
+    extern uint32_t eb_arena_get_pool_mode(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbArena_h
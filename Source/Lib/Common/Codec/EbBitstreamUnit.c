@@ -65,6 +65,32 @@ EbErrorType output_bitstream_reset(
     return return_error;
 }
 
+/**********************************
+ * Grow Bitstream
+ **********************************/
+EbErrorType output_bitstream_unit_grow(
+    OutputBitstreamUnit *bitstream_ptr,
+    uint32_t             buffer_size)
+{
+    const uint32_t written_bytes_count = (uint32_t)(bitstream_ptr->buffer_av1 - bitstream_ptr->buffer_begin_av1);
+    uint8_t *buffer;
+
+    if (buffer_size <= bitstream_ptr->size)
+        return EB_ErrorNone;
+    // Grow geometrically so that a stream coding past its estimate does not
+    // reallocate at every picture
+    buffer_size = MAX(buffer_size, bitstream_ptr->size + (bitstream_ptr->size >> 1));
+    EB_MALLOC_ARRAY(buffer, buffer_size);
+    if (written_bytes_count)
+        memcpy(buffer, bitstream_ptr->buffer_begin_av1, written_bytes_count);
+    EB_FREE_ARRAY(bitstream_ptr->buffer_begin_av1);
+    bitstream_ptr->buffer_begin_av1 = buffer;
+    bitstream_ptr->buffer_av1 = buffer + written_bytes_count;
+    bitstream_ptr->size = buffer_size;
+
+    return EB_ErrorNone;
+}
+
 /**********************************
  * Output RBSP to payload
  *   Intended to be used in CABAC
@@ -114,18 +140,41 @@ EbErrorType output_bitstream_rbsp_to_payload(
 /********************************************************************************************************************************/
 /********************************************************************************************************************************/
 // daalaboolwriter.c
-void eb_aom_daala_start_encode(DaalaWriter *br, uint8_t *source) {
+void eb_aom_daala_start_encode(DaalaWriter *br, uint8_t *source, uint32_t source_size) {
     br->buffer = source;
+    br->buffer_size = source_size;
+    br->bitstream_ptr = NULL;
     br->pos = 0;
     eb_od_ec_enc_init(&br->ec, 62025);
 }
 
+void eb_aom_daala_start_encode_bitstream(DaalaWriter *br, OutputBitstreamUnit *bitstream_ptr) {
+    eb_aom_daala_start_encode(br, bitstream_ptr->buffer_av1,
+        bitstream_ptr->size - (uint32_t)(bitstream_ptr->buffer_av1 - bitstream_ptr->buffer_begin_av1));
+    br->bitstream_ptr = bitstream_ptr;
+}
+
 int32_t eb_aom_daala_stop_encode(DaalaWriter *br) {
     int32_t nb_bits;
     uint32_t daala_bytes;
     uint8_t *daala_data;
     daala_data = eb_od_ec_enc_done(&br->ec, &daala_bytes);
     nb_bits = eb_od_ec_enc_tell(&br->ec);
+    // The tiles of a picture are sized from their share of the picture, a
+    // tile coding more than that grows its buffer
+    if (daala_data != NULL && daala_bytes > br->buffer_size && br->bitstream_ptr != NULL) {
+        OutputBitstreamUnit *bitstream_ptr = br->bitstream_ptr;
+        const uint32_t offset = (uint32_t)(br->buffer - bitstream_ptr->buffer_begin_av1);
+        if (output_bitstream_unit_grow(bitstream_ptr, offset + daala_bytes) == EB_ErrorNone) {
+            br->buffer = bitstream_ptr->buffer_begin_av1 + offset;
+            br->buffer_size = bitstream_ptr->size - offset;
+        }
+    }
+    if (daala_data == NULL || daala_bytes > br->buffer_size) {
+        br->pos = 0;
+        eb_od_ec_enc_clear(&br->ec);
+        return -1;
+    }
     memcpy(br->buffer, daala_data, daala_bytes);
     br->pos = daala_bytes;
     eb_od_ec_enc_clear(&br->ec);
@@ -46,6 +46,11 @@ extern "C" {
 
     extern EbErrorType output_bitstream_reset(OutputBitstreamUnit *bitstream_ptr);
 
+    // Grows the buffer to at least buffer_size bytes, keeping the written bytes
+    extern EbErrorType output_bitstream_unit_grow(
+        OutputBitstreamUnit *bitstream_ptr,
+        uint32_t             buffer_size);
+
     extern EbErrorType output_bitstream_rbsp_to_payload(
         OutputBitstreamUnit *bitstream_ptr,
         EbByte                output_buffer,
@@ -253,13 +258,17 @@ on a larger type, you can speed up the decoder by using it here.*/
     struct DaalaWriter {
         uint32_t pos;
         uint8_t *buffer;
+        uint32_t buffer_size;               // bytes available at buffer
+        OutputBitstreamUnit *bitstream_ptr; // owner of buffer, grown when the coded bytes do not fit, NULL if none
         OdEcEnc ec;
         uint8_t allow_update_cdf;
     };
 
     typedef struct DaalaWriter DaalaWriter;
 
-    void eb_aom_daala_start_encode(DaalaWriter *w, uint8_t *buffer);
+    void eb_aom_daala_start_encode(DaalaWriter *w, uint8_t *buffer, uint32_t buffer_size);
+    void eb_aom_daala_start_encode_bitstream(DaalaWriter *w, OutputBitstreamUnit *bitstream_ptr);
+    // Returns -1, with nothing written, when the coded bytes do not fit
     int32_t eb_aom_daala_stop_encode(DaalaWriter *w);
 
     static INLINE void aom_daala_write(DaalaWriter *w, int32_t bit, int32_t prob) {
@@ -302,8 +311,12 @@ on a larger type, you can speed up the decoder by using it here.*/
         token_stats->cost = 0;
     }
 
-    static INLINE void aom_start_encode(AomWriter *bc, uint8_t *buffer) {
-        eb_aom_daala_start_encode(bc, buffer);
+    static INLINE void aom_start_encode(AomWriter *bc, uint8_t *buffer, uint32_t buffer_size) {
+        eb_aom_daala_start_encode(bc, buffer, buffer_size);
+    }
+
+    static INLINE void aom_start_encode_bitstream(AomWriter *bc, OutputBitstreamUnit *bitstream_ptr) {
+        eb_aom_daala_start_encode_bitstream(bc, bitstream_ptr);
     }
 
     static INLINE int32_t aom_stop_encode(AomWriter *bc) {
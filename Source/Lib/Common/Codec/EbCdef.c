@@ -459,33 +459,75 @@ void copy_rect(uint16_t *dst, int32_t dstride, const uint16_t *src,
     }
 }
 
-void eb_av1_cdef_frame(
-    EncDecContext                *context_ptr,
-    SequenceControlSet           *sequence_control_set_ptr,
-    PictureControlSet            *pCs){
-    (void)context_ptr;
-
-    struct PictureParentControlSet     *pPcs = pCs->parent_pcs_ptr;
-    Av1Common*   cm = pPcs->av1_cm;
-    FrameHeader *frm_hdr = &pPcs->frm_hdr;
+/**************************************
+ * Cdef Frame Pass
+ *   The filter blocks are filtered in place, so each row of 64x64 filter
+ *   blocks reads the unfiltered lines of its neighbor rows from a copy of
+ *   the lines around every row boundary, taken before any row is filtered.
+ *   Rows are then independent and shared by the CDEF threads.
+ **************************************/
+typedef struct CdefFramePass {
+    PictureControlSet   *pcs_ptr;
+    EbBool               is16bit;
+    uint8_t             *recon_buffer[3];
+    int32_t              recon_stride[3];
+    // 2 * CDEF_VBORDER unfiltered lines per row boundary, CDEF_HBORDER columns
+    // of margin on each side
+    uint16_t            *boundary[3];
+    int32_t              boundary_stride;
+    int32_t              nvfb;
+    int32_t              nhfb;
+    int32_t              coeff_shift;
+} CdefFramePass;
+
+static void copy_recon_to_16bit(
+    const CdefFramePass *pass, int32_t pli, uint16_t *dst, int32_t dstride,
+    int32_t src_voffset, int32_t src_hoffset, int32_t vsize, int32_t hsize)
+{
+    if (pass->is16bit)
+        copy_sb16_16(dst, dstride, (const uint16_t*)pass->recon_buffer[pli],
+            src_voffset, src_hoffset, pass->recon_stride[pli], vsize, hsize);
+    else
+        copy_sb8_16(dst, dstride, pass->recon_buffer[pli],
+            src_voffset, src_hoffset, pass->recon_stride[pli], vsize, hsize);
+}
 
-    EbPictureBufferDesc  * recon_picture_ptr;
+static uint16_t *cdef_boundary_line(const CdefFramePass *pass, int32_t pli, int32_t boundary_index, int32_t line) {
+    return pass->boundary[pli] + (boundary_index * 2 * CDEF_VBORDER + line) * pass->boundary_stride + CDEF_HBORDER;
+}
 
-    if (pPcs->is_used_as_reference_flag == EB_TRUE)
-        recon_picture_ptr = ((EbReferenceObject*)pCs->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->reference_picture;
-    else
-        recon_picture_ptr = pCs->recon_picture_ptr;
+// Saves the unfiltered lines on both sides of the boundary below row fbr
+static void save_cdef_boundary_row(void *pass_ptr, uint32_t worker_index, uint32_t fbr) {
+    CdefFramePass *pass = (CdefFramePass*)pass_ptr;
+    Av1Common *cm = pass->pcs_ptr->parent_pcs_ptr->av1_cm;
+    (void)worker_index;
+
+    for (int32_t pli = 0; pli < 3; pli++) {
+        const int32_t mi_high_l2 = MI_SIZE_LOG2 - (pli ? 1 : 0);
+        const int32_t mi_wide_l2 = MI_SIZE_LOG2 - (pli ? 1 : 0);
+        const int32_t width = cm->mi_cols << mi_wide_l2;
+        uint16_t *line = cdef_boundary_line(pass, pli, fbr, 0);
+
+        fill_rect(line - CDEF_HBORDER, pass->boundary_stride, 2 * CDEF_VBORDER, pass->boundary_stride,
+            CDEF_VERY_LARGE);
+        copy_recon_to_16bit(pass, pli, line, pass->boundary_stride,
+            (MI_SIZE_64X64 << mi_high_l2) * (fbr + 1) - CDEF_VBORDER, 0, 2 * CDEF_VBORDER, width);
+    }
+}
 
-    EbByte  reconBufferY = &((recon_picture_ptr->buffer_y)[recon_picture_ptr->origin_x + recon_picture_ptr->origin_y * recon_picture_ptr->stride_y]);
-    EbByte  reconBufferCb = &((recon_picture_ptr->buffer_cb)[recon_picture_ptr->origin_x / 2 + recon_picture_ptr->origin_y / 2 * recon_picture_ptr->stride_cb]);
-    EbByte  reconBufferCr = &((recon_picture_ptr->buffer_cr)[recon_picture_ptr->origin_x / 2 + recon_picture_ptr->origin_y / 2 * recon_picture_ptr->stride_cr]);
+static void cdef_fb_row(void *pass_ptr, uint32_t worker_index, uint32_t row_index) {
+    CdefFramePass *pass = (CdefFramePass*)pass_ptr;
+    PictureControlSet *pCs = pass->pcs_ptr;
+    Av1Common *cm = pCs->parent_pcs_ptr->av1_cm;
+    FrameHeader *frm_hdr = &pCs->parent_pcs_ptr->frm_hdr;
+    const int32_t fbr = (int32_t)row_index;
+    const int32_t nvfb = pass->nvfb;
+    const int32_t nhfb = pass->nhfb;
 
     const int32_t num_planes = 3;// av1_num_planes(cm);
     DECLARE_ALIGNED(16, uint16_t, src[CDEF_INBUF_SIZE]);
-    uint16_t *linebuf[3];
-    uint16_t *colbuf[3];
+    uint16_t colbuf[3][((CDEF_BLOCKSIZE << MI_SIZE_LOG2) + 2 * CDEF_VBORDER) * CDEF_HBORDER];
     cdef_list dlist[MI_SIZE_64X64 * MI_SIZE_64X64];
-    uint8_t *row_cdef, *prev_row_cdef, *curr_row_cdef;
     int32_t cdef_count;
     int32_t dir[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
     int32_t var[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
@@ -493,604 +535,274 @@ void eb_av1_cdef_frame(
     int32_t mi_high_l2[3];
     int32_t xdec[3];
     int32_t ydec[3];
-    int32_t coeff_shift = AOMMAX(sequence_control_set_ptr->static_config.encoder_bit_depth/*cm->bit_depth*/ - 8, 0);
-    const int32_t nvfb = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
-    const int32_t nhfb = (cm->mi_cols + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
-    //eb_av1_setup_dst_planes(xd->plane, cm->seq_params.sb_size, frame, 0, 0, 0, num_planes);
-    row_cdef = (uint8_t *)eb_aom_malloc(sizeof(*row_cdef) * (nhfb + 2) * 2);
-    assert(row_cdef != NULL);
-    memset(row_cdef, 1, sizeof(*row_cdef) * (nhfb + 2) * 2);
-    prev_row_cdef = row_cdef + 1;
-    curr_row_cdef = prev_row_cdef + nhfb + 2;
+    (void)worker_index;
+
     for (int32_t pli = 0; pli < num_planes; pli++) {
         int32_t subsampling_x = (pli == 0) ? 0 : 1;
         int32_t subsampling_y = (pli == 0) ? 0 : 1;
 
-        xdec[pli] = subsampling_x; //CHKN xd->plane[pli].subsampling_x;
-        ydec[pli] = subsampling_y; //CHKN  xd->plane[pli].subsampling_y;
-        mi_wide_l2[pli] = MI_SIZE_LOG2 - subsampling_x; //CHKN xd->plane[pli].subsampling_x;
-        mi_high_l2[pli] = MI_SIZE_LOG2 - subsampling_y; //CHKN xd->plane[pli].subsampling_y;
-    }
+        xdec[pli] = subsampling_x;
+        ydec[pli] = subsampling_y;
+        mi_wide_l2[pli] = MI_SIZE_LOG2 - subsampling_x;
+        mi_high_l2[pli] = MI_SIZE_LOG2 - subsampling_y;
 
-    const int32_t stride = (cm->mi_cols << MI_SIZE_LOG2) + 2 * CDEF_HBORDER;
-    for (int32_t pli = 0; pli < num_planes; pli++) {
-        linebuf[pli] = (uint16_t *)eb_aom_malloc(sizeof(*linebuf) * CDEF_VBORDER * stride);
-        colbuf[pli] = (uint16_t *)eb_aom_malloc(sizeof(*colbuf)  * ((CDEF_BLOCKSIZE << mi_high_l2[pli]) + 2 * CDEF_VBORDER) * CDEF_HBORDER);
+        const int32_t block_height =
+            (MI_SIZE_64X64 << mi_high_l2[pli]) + 2 * CDEF_VBORDER;
+        fill_rect(colbuf[pli], CDEF_HBORDER, block_height, CDEF_HBORDER,
+            CDEF_VERY_LARGE);
     }
 
-    for (int32_t fbr = 0; fbr < nvfb; fbr++) {
-        for (int32_t pli = 0; pli < num_planes; pli++) {
-            const int32_t block_height =
-                (MI_SIZE_64X64 << mi_high_l2[pli]) + 2 * CDEF_VBORDER;
-            fill_rect(colbuf[pli], CDEF_HBORDER, block_height, CDEF_HBORDER,
-                CDEF_VERY_LARGE);
+    int32_t cdef_left = 1;
+    for (int32_t fbc = 0; fbc < nhfb; fbc++) {
+        int32_t level, sec_strength;
+        int32_t uv_level, uv_sec_strength;
+        int32_t nhb, nvb;
+        int32_t cstart = 0;
+
+        if (pCs->mi_grid_base[MI_SIZE_64X64 * fbr * cm->mi_stride + MI_SIZE_64X64 * fbc] == NULL ||
+            pCs->mi_grid_base[MI_SIZE_64X64 * fbr * cm->mi_stride + MI_SIZE_64X64 * fbc]->mbmi.cdef_strength == -1) {
+            cdef_left = 0;
+            printf("\n\n\nCDEF ERROR: Skipping Current FB\n\n\n");
+            continue;
         }
 
-        int32_t cdef_left = 1;
-        for (int32_t fbc = 0; fbc < nhfb; fbc++) {
-            int32_t level, sec_strength;
-            int32_t uv_level, uv_sec_strength;
-            int32_t nhb, nvb;
-            int32_t cstart = 0;
-            curr_row_cdef[fbc] = 0;
-
-            //WAHT IS THIS  ?? CHKN -->for
-            if (pCs->mi_grid_base[MI_SIZE_64X64 * fbr * cm->mi_stride + MI_SIZE_64X64 * fbc] == NULL ||
-                pCs->mi_grid_base[MI_SIZE_64X64 * fbr * cm->mi_stride + MI_SIZE_64X64 * fbc]->mbmi.cdef_strength == -1) {
-                cdef_left = 0;
-                printf("\n\n\nCDEF ERROR: Skipping Current FB\n\n\n");
-                continue;
-            }
+        if (!cdef_left) cstart = -CDEF_HBORDER;  //CHKN if the left block has not been filtered, then we can use samples on the left as input.
+
+        nhb = AOMMIN(MI_SIZE_64X64, cm->mi_cols - MI_SIZE_64X64 * fbc);
+        nvb = AOMMIN(MI_SIZE_64X64, cm->mi_rows - MI_SIZE_64X64 * fbr);
+        int32_t frame_top, frame_left, frame_bottom, frame_right;
+
+        int32_t mi_row = MI_SIZE_64X64 * fbr;
+        int32_t mi_col = MI_SIZE_64X64 * fbc;
+        // for the current filter block, it's top left corner mi structure (mi_tl)
+        // is first accessed to check whether the top and left boundaries are
+        // frame boundaries. Then bottom-left and top-right mi structures are
+        // accessed to check whether the bottom and right boundaries
+        // (respectively) are frame boundaries.
+        //
+        // Note that we can't just check the bottom-right mi structure - eg. if
+        // we're at the right-hand edge of the frame but not the bottom, then
+        // the bottom-right mi is NULL but the bottom-left is not.
+        frame_top = (mi_row == 0) ? 1 : 0;
+        frame_left = (mi_col == 0) ? 1 : 0;
+
+        if (fbr != nvfb - 1)
+            frame_bottom = (mi_row + MI_SIZE_64X64 == cm->mi_rows) ? 1 : 0;
+        else
+            frame_bottom = 1;
 
-            if (!cdef_left) cstart = -CDEF_HBORDER;  //CHKN if the left block has not been filtered, then we can use samples on the left as input.
+        if (fbc != nhfb - 1)
+            frame_right = (mi_col + MI_SIZE_64X64 == cm->mi_cols) ? 1 : 0;
+        else
+            frame_right = 1;
+
+        const int32_t mbmi_cdef_strength = pCs->mi_grid_base[MI_SIZE_64X64 * fbr * cm->mi_stride + MI_SIZE_64X64 * fbc]->mbmi.cdef_strength;
+        level = frm_hdr->CDEF_params.cdef_y_strength[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
+        sec_strength = frm_hdr->CDEF_params.cdef_y_strength[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
+        sec_strength += sec_strength == 3;
+        uv_level = frm_hdr->CDEF_params.cdef_uv_strength[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
+        uv_sec_strength = frm_hdr->CDEF_params.cdef_uv_strength[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
+        uv_sec_strength += uv_sec_strength == 3;
+        if ((level == 0 && sec_strength == 0 && uv_level == 0 && uv_sec_strength == 0) ||
+            (cdef_count = eb_sb_compute_cdef_list(pCs, cm, fbr * MI_SIZE_64X64, fbc * MI_SIZE_64X64, dlist, BLOCK_64X64)) == 0) {
+            cdef_left = 0;
+            continue;
+        }
 
-            nhb = AOMMIN(MI_SIZE_64X64, cm->mi_cols - MI_SIZE_64X64 * fbc);
-            nvb = AOMMIN(MI_SIZE_64X64, cm->mi_rows - MI_SIZE_64X64 * fbr);
-            int32_t frame_top, frame_left, frame_bottom, frame_right;
-
-            int32_t mi_row = MI_SIZE_64X64 * fbr;
-            int32_t mi_col = MI_SIZE_64X64 * fbc;
-            // for the current filter block, it's top left corner mi structure (mi_tl)
-            // is first accessed to check whether the top and left boundaries are
-            // frame boundaries. Then bottom-left and top-right mi structures are
-            // accessed to check whether the bottom and right boundaries
-            // (respectively) are frame boundaries.
-            //
-            // Note that we can't just check the bottom-right mi structure - eg. if
-            // we're at the right-hand edge of the frame but not the bottom, then
-            // the bottom-right mi is NULL but the bottom-left is not.
-            frame_top = (mi_row == 0) ? 1 : 0;
-            frame_left = (mi_col == 0) ? 1 : 0;
-
-            if (fbr != nvfb - 1)
-                frame_bottom = (mi_row + MI_SIZE_64X64 == cm->mi_rows) ? 1 : 0;
+        for (int32_t pli = 0; pli < num_planes; pli++) {
+            int32_t coffset;
+            int32_t rend, cend;
+            int32_t pri_damping = frm_hdr->CDEF_params.cdef_damping;
+            int32_t sec_damping = frm_hdr->CDEF_params.cdef_damping;
+            int32_t hsize = nhb << mi_wide_l2[pli];
+            int32_t vsize = nvb << mi_high_l2[pli];
+
+            if (pli) {
+                level = uv_level;
+                sec_strength = uv_sec_strength;
+            }
+
+            if (fbc == nhfb - 1)
+                cend = hsize;
             else
-                frame_bottom = 1;
+                cend = hsize + CDEF_HBORDER;
 
-            if (fbc != nhfb - 1)
-                frame_right = (mi_col + MI_SIZE_64X64 == cm->mi_cols) ? 1 : 0;
+            if (fbr == nvfb - 1)
+                rend = vsize;
             else
-                frame_right = 1;
-
-            const int32_t mbmi_cdef_strength = pCs->mi_grid_base[MI_SIZE_64X64 * fbr * cm->mi_stride + MI_SIZE_64X64 * fbc]->mbmi.cdef_strength;
-            level = frm_hdr->CDEF_params.cdef_y_strength[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
-            sec_strength = frm_hdr->CDEF_params.cdef_y_strength[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
-            sec_strength += sec_strength == 3;
-            uv_level = frm_hdr->CDEF_params.cdef_uv_strength[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
-            uv_sec_strength = frm_hdr->CDEF_params.cdef_uv_strength[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
-            uv_sec_strength += uv_sec_strength == 3;
-            if ((level == 0 && sec_strength == 0 && uv_level == 0 && uv_sec_strength == 0) ||
-                (cdef_count = eb_sb_compute_cdef_list(pCs, cm, fbr * MI_SIZE_64X64, fbc * MI_SIZE_64X64, dlist, BLOCK_64X64)) == 0) {
-                cdef_left = 0;
-                continue;
+                rend = vsize + CDEF_VBORDER;
+
+            coffset = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
+            if (fbc == nhfb - 1) {
+                /* On the last superblock column, fill in the right border with
+                   CDEF_VERY_LARGE to avoid filtering with the outside. */
+                fill_rect(&src[cend + CDEF_HBORDER], CDEF_BSTRIDE,
+                    rend + CDEF_VBORDER, hsize + CDEF_HBORDER - cend,
+                    CDEF_VERY_LARGE);
+            }
+            if (fbr == nvfb - 1) {
+                /* On the last superblock row, fill in the bottom border with
+                   CDEF_VERY_LARGE to avoid filtering with the outside. */
+                fill_rect(&src[(rend + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
+                    CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
             }
 
-            curr_row_cdef[fbc] = 1;
-            for (int32_t pli = 0; pli < num_planes; pli++) {
-                int32_t coffset;
-                int32_t rend, cend;
-                int32_t pri_damping = frm_hdr->CDEF_params.cdef_damping;
-                int32_t sec_damping = frm_hdr->CDEF_params.cdef_damping;
-                int32_t hsize = nhb << mi_wide_l2[pli];
-                int32_t vsize = nvb << mi_high_l2[pli];
-
-                if (pli) {
-                    level = uv_level;
-                    sec_strength = uv_sec_strength;
-                }
-
-                if (fbc == nhfb - 1)
-                    cend = hsize;
-                else
-                    cend = hsize + CDEF_HBORDER;
-
-                if (fbr == nvfb - 1)
-                    rend = vsize;
-                else
-                    rend = vsize + CDEF_VBORDER;
-
-                coffset = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
-                if (fbc == nhfb - 1) {
-                    /* On the last superblock column, fill in the right border with
-                       CDEF_VERY_LARGE to avoid filtering with the outside. */
-                    fill_rect(&src[cend + CDEF_HBORDER], CDEF_BSTRIDE,
-                        rend + CDEF_VBORDER, hsize + CDEF_HBORDER - cend,
-                        CDEF_VERY_LARGE);
-                }
-                if (fbr == nvfb - 1) {
-                    /* On the last superblock row, fill in the bottom border with
-                       CDEF_VERY_LARGE to avoid filtering with the outside. */
-                    fill_rect(&src[(rend + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
-                        CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
-
-                uint8_t* recBuff = 0;
-                uint32_t recStride = 0;
-
-                switch (pli) {
-                case 0:
-                    recBuff = reconBufferY;
-                    recStride = recon_picture_ptr->stride_y;
-                    break;
-                case 1:
-                    recBuff = reconBufferCb;
-                    recStride = recon_picture_ptr->stride_cb;
-
-                    break;
-                case 2:
-                    recBuff = reconBufferCr;
-                    recStride = recon_picture_ptr->stride_cr;
-                    break;
-                }
+            /* Copy in the pixels we need from the current superblock for
+               deringing.*/
+            copy_recon_to_16bit(pass, pli,
+                &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER + cstart], CDEF_BSTRIDE,
+                (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr, coffset + cstart,
+                vsize, cend - cstart);
+            // The lines below come from the row below, before it is filtered
+            if (fbr < nvfb - 1) {
+                copy_rect(&src[(CDEF_VBORDER + vsize) * CDEF_BSTRIDE + CDEF_HBORDER + cstart], CDEF_BSTRIDE,
+                    cdef_boundary_line(pass, pli, fbr, CDEF_VBORDER) + coffset + cstart,
+                    pass->boundary_stride, CDEF_VBORDER, cend - cstart);
+            }
 
-                /* Copy in the pixels we need from the current superblock for
-                   deringing.*/
-                copy_sb8_16(//cm,
-                    &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER + cstart],
-                    CDEF_BSTRIDE, recBuff/*xd->plane[pli].dst.buf*/,
-                    (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr, coffset + cstart,
-                    recStride/*xd->plane[pli].dst.stride*/, rend, cend - cstart);
-                if (!prev_row_cdef[fbc]) {
-                    copy_sb8_16(//cm,
-                        &src[CDEF_HBORDER], CDEF_BSTRIDE,
-                        recBuff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                        coffset, recStride/*xd->plane[pli].dst.stride*/, CDEF_VBORDER, hsize);
-                }
-                else if (fbr > 0) {
-                    copy_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, &linebuf[pli][coffset],
-                        stride, CDEF_VBORDER, hsize);
-                }
-                else {
-                    fill_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER, hsize,
-                        CDEF_VERY_LARGE);
-                }
+            // The lines above come from the row above, before it is filtered
+            if (fbr > 0) {
+                copy_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE,
+                    cdef_boundary_line(pass, pli, fbr - 1, 0) + coffset,
+                    pass->boundary_stride, CDEF_VBORDER, hsize);
+            }
+            else {
+                fill_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER, hsize,
+                    CDEF_VERY_LARGE);
+            }
 
-                if (!prev_row_cdef[fbc - 1]) {
-                    copy_sb8_16(//cm,
-                        src, CDEF_BSTRIDE, recBuff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                        coffset - CDEF_HBORDER, recStride/*xd->plane[pli].dst.stride*/,
-                        CDEF_VBORDER, CDEF_HBORDER);
-                }
-                else if (fbr > 0 && fbc > 0) {
-                    copy_rect(src, CDEF_BSTRIDE, &linebuf[pli][coffset - CDEF_HBORDER],
-                        stride, CDEF_VBORDER, CDEF_HBORDER);
-                }
-                else {
-                    fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, CDEF_HBORDER,
-                        CDEF_VERY_LARGE);
-                }
+            if (fbr > 0 && fbc > 0) {
+                copy_rect(src, CDEF_BSTRIDE,
+                    cdef_boundary_line(pass, pli, fbr - 1, 0) + coffset - CDEF_HBORDER,
+                    pass->boundary_stride, CDEF_VBORDER, CDEF_HBORDER);
+            }
+            else {
+                fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, CDEF_HBORDER,
+                    CDEF_VERY_LARGE);
+            }
 
-                if (!prev_row_cdef[fbc + 1]) {
-                    copy_sb8_16(//cm,
-                        &src[CDEF_HBORDER + (nhb << mi_wide_l2[pli])],
-                        CDEF_BSTRIDE, recBuff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                        coffset + hsize, recStride/*xd->plane[pli].dst.stride*/, CDEF_VBORDER,
-                        CDEF_HBORDER);
-                }
-                else if (fbr > 0 && fbc < nhfb - 1) {
-                    copy_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                        &linebuf[pli][coffset + hsize], stride, CDEF_VBORDER,
-                        CDEF_HBORDER);
-                }
-                else {
-                    fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER,
-                        CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
+            if (fbr > 0 && fbc < nhfb - 1) {
+                copy_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
+                    cdef_boundary_line(pass, pli, fbr - 1, 0) + coffset + hsize,
+                    pass->boundary_stride, CDEF_VBORDER, CDEF_HBORDER);
+            }
+            else {
+                fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER,
+                    CDEF_HBORDER, CDEF_VERY_LARGE);
+            }
 
-                if (cdef_left) {
-                    /* If we deringed the superblock on the left then we need to copy in
-                       saved pixels. */
-                    copy_rect(src, CDEF_BSTRIDE, colbuf[pli], CDEF_HBORDER,
-                        rend + CDEF_VBORDER, CDEF_HBORDER);
-                }
+            if (cdef_left) {
+                /* If we deringed the superblock on the left then we need to copy in
+                   saved pixels. */
+                copy_rect(src, CDEF_BSTRIDE, colbuf[pli], CDEF_HBORDER,
+                    rend + CDEF_VBORDER, CDEF_HBORDER);
+            }
 
-                /* Saving pixels in case we need to dering the superblock on the
-                    right. */
-                if (fbc < nhfb - 1)
-                    copy_rect(colbuf[pli], CDEF_HBORDER, src + hsize, CDEF_BSTRIDE,
-                        rend + CDEF_VBORDER, CDEF_HBORDER);
-
-                if (fbr < nvfb - 1)
-                    copy_sb8_16(
-                        //cm,
-                        &linebuf[pli][coffset], stride, recBuff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli]) * (fbr + 1) - CDEF_VBORDER,
-                        coffset, recStride/*xd->plane[pli].dst.stride*/, CDEF_VBORDER, hsize);
-
-                if (frame_top) {
-                    fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
-                        CDEF_VERY_LARGE);
-                }
-                if (frame_left) {
-                    fill_rect(src, CDEF_BSTRIDE, vsize + 2 * CDEF_VBORDER, CDEF_HBORDER,
-                        CDEF_VERY_LARGE);
-                }
-                if (frame_bottom) {
-                    fill_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
-                        CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
-                if (frame_right) {
-                    fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                        vsize + 2 * CDEF_VBORDER, CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
+            /* Saving pixels in case we need to dering the superblock on the
+                right. */
+            if (fbc < nhfb - 1)
+                copy_rect(colbuf[pli], CDEF_HBORDER, src + hsize, CDEF_BSTRIDE,
+                    rend + CDEF_VBORDER, CDEF_HBORDER);
 
-                //if (cm->use_highbitdepth) {
-                //  eb_cdef_filter_fb(
-                //      NULL,
-                //      &CONVERT_TO_SHORTPTR(
-                //          xd->plane[pli]
-                //              .dst.buf)[xd->plane[pli].dst.stride *
-                //                            (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +
-                //                        (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
-                //      xd->plane[pli].dst.stride,
-                //      &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
-                //      ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
-                //      sec_strength, pri_damping, sec_damping, coeff_shift);
-                //} else
-                {
-                    eb_cdef_filter_fb(
-                        &recBuff[recStride *(MI_SIZE_64X64 * fbr << mi_high_l2[pli]) + (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
-                        //&xd->plane[pli].dst.buf[xd->plane[pli].dst.stride *(MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +(fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
-                        NULL, recStride/*xd->plane[pli].dst.stride*/,
-                        &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
-                        ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
-                        sec_strength, pri_damping, sec_damping, coeff_shift);
-                }
+            if (frame_top) {
+                fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
+                    CDEF_VERY_LARGE);
             }
-            cdef_left = 1;  //CHKN filtered data is written back directy to recFrame.
-        }
-        {
-            uint8_t *tmp = prev_row_cdef;
-            prev_row_cdef = curr_row_cdef;
-            curr_row_cdef = tmp;
+            if (frame_left) {
+                fill_rect(src, CDEF_BSTRIDE, vsize + 2 * CDEF_VBORDER, CDEF_HBORDER,
+                    CDEF_VERY_LARGE);
+            }
+            if (frame_bottom) {
+                fill_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
+                    CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
+            }
+            if (frame_right) {
+                fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
+                    vsize + 2 * CDEF_VBORDER, CDEF_HBORDER, CDEF_VERY_LARGE);
+            }
+
+            const int32_t dst_offset = pass->recon_stride[pli] * (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) + (fbc * MI_SIZE_64X64 << mi_wide_l2[pli]);
+            eb_cdef_filter_fb(
+                pass->is16bit ? NULL : &pass->recon_buffer[pli][dst_offset],
+                pass->is16bit ? &((uint16_t*)pass->recon_buffer[pli])[dst_offset] : NULL,
+                pass->recon_stride[pli],
+                &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
+                ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
+                sec_strength, pri_damping, sec_damping, pass->coeff_shift);
         }
-    }
-    eb_aom_free(row_cdef);
-    for (int32_t pli = 0; pli < num_planes; pli++) {
-        eb_aom_free(linebuf[pli]);
-        eb_aom_free(colbuf[pli]);
+        cdef_left = 1;  //CHKN filtered data is written back directy to recFrame.
     }
 }
 
-void av1_cdef_frame16bit(
-    EncDecContext                *context_ptr,
+/**************************************
+ * Cdef Frame Rows
+ *   Applies the selected strengths to the recon picture, in rows of 64x64
+ *   filter blocks shared by the CDEF threads of the picture session
+ **************************************/
+static void cdef_frame_rows(
     SequenceControlSet           *sequence_control_set_ptr,
-    PictureControlSet            *pCs){
-    (void)context_ptr;
+    PictureControlSet            *pCs,
+    EbBool                        is16bit)
+{
     struct PictureParentControlSet     *pPcs = pCs->parent_pcs_ptr;
     Av1Common*   cm = pPcs->av1_cm;
-    FrameHeader *frm_hdr = &pPcs->frm_hdr;
-
     EbPictureBufferDesc  * recon_picture_ptr;
+    CdefFramePass pass;
+    const int32_t bytes_per_sample = is16bit ? 2 : 1;
 
     if (pPcs->is_used_as_reference_flag == EB_TRUE)
-        recon_picture_ptr = ((EbReferenceObject*)pCs->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->reference_picture16bit;
-
+        recon_picture_ptr = is16bit ?
+            ((EbReferenceObject*)pPcs->reference_picture_wrapper_ptr->object_ptr)->reference_picture16bit :
+            ((EbReferenceObject*)pPcs->reference_picture_wrapper_ptr->object_ptr)->reference_picture;
     else
-        recon_picture_ptr = pCs->recon_picture16bit_ptr;
-
-    uint16_t*  reconBufferY = (uint16_t*)recon_picture_ptr->buffer_y + (recon_picture_ptr->origin_x + recon_picture_ptr->origin_y     * recon_picture_ptr->stride_y);
-    uint16_t*  reconBufferCb = (uint16_t*)recon_picture_ptr->buffer_cb + (recon_picture_ptr->origin_x / 2 + recon_picture_ptr->origin_y / 2 * recon_picture_ptr->stride_cb);
-    uint16_t*  reconBufferCr = (uint16_t*)recon_picture_ptr->buffer_cr + (recon_picture_ptr->origin_x / 2 + recon_picture_ptr->origin_y / 2 * recon_picture_ptr->stride_cr);
-
-    const int32_t num_planes = 3;// av1_num_planes(cm);
-    DECLARE_ALIGNED(16, uint16_t, src[CDEF_INBUF_SIZE]);
-    uint16_t *linebuf[3];
-    uint16_t *colbuf[3];
-    cdef_list dlist[MI_SIZE_64X64 * MI_SIZE_64X64];
-    uint8_t *row_cdef, *prev_row_cdef, *curr_row_cdef;
-    int32_t cdef_count;
-    int32_t dir[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
-    int32_t var[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
-    int32_t mi_wide_l2[3];
-    int32_t mi_high_l2[3];
-    int32_t xdec[3];
-    int32_t ydec[3];
-    int32_t coeff_shift = AOMMAX(sequence_control_set_ptr->static_config.encoder_bit_depth/*cm->bit_depth*/ - 8, 0);
-    const int32_t nvfb = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
-    const int32_t nhfb = (cm->mi_cols + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
-    //eb_av1_setup_dst_planes(xd->plane, cm->seq_params.sb_size, frame, 0, 0, 0, num_planes);
-    row_cdef = (uint8_t *)eb_aom_malloc(sizeof(*row_cdef) * (nhfb + 2) * 2);
-    assert(row_cdef);
-    memset(row_cdef, 1, sizeof(*row_cdef) * (nhfb + 2) * 2);
-    prev_row_cdef = row_cdef + 1;
-    curr_row_cdef = prev_row_cdef + nhfb + 2;
-    for (int32_t pli = 0; pli < num_planes; pli++) {
-        int32_t subsampling_x = (pli == 0) ? 0 : 1;
-        int32_t subsampling_y = (pli == 0) ? 0 : 1;
-
-        xdec[pli] = subsampling_x; //CHKN xd->plane[pli].subsampling_x;
-        ydec[pli] = subsampling_y; //CHKN  xd->plane[pli].subsampling_y;
-        mi_wide_l2[pli] = MI_SIZE_LOG2 - subsampling_x; //CHKN xd->plane[pli].subsampling_x;
-        mi_high_l2[pli] = MI_SIZE_LOG2 - subsampling_y; //CHKN xd->plane[pli].subsampling_y;
-    }
-
-    const int32_t stride = (cm->mi_cols << MI_SIZE_LOG2) + 2 * CDEF_HBORDER;
-    for (int32_t pli = 0; pli < num_planes; pli++) {
-        linebuf[pli] = (uint16_t *)eb_aom_malloc(sizeof(*linebuf) * CDEF_VBORDER * stride);
-        colbuf[pli] = (uint16_t *)eb_aom_malloc(sizeof(*colbuf)  * ((CDEF_BLOCKSIZE << mi_high_l2[pli]) + 2 * CDEF_VBORDER) * CDEF_HBORDER);
+        recon_picture_ptr = is16bit ? pCs->recon_picture16bit_ptr : pCs->recon_picture_ptr;
+
+    pass.pcs_ptr = pCs;
+    pass.is16bit = is16bit;
+    pass.recon_buffer[0] = recon_picture_ptr->buffer_y + (recon_picture_ptr->origin_x + recon_picture_ptr->origin_y * recon_picture_ptr->stride_y) * bytes_per_sample;
+    pass.recon_buffer[1] = recon_picture_ptr->buffer_cb + (recon_picture_ptr->origin_x / 2 + recon_picture_ptr->origin_y / 2 * recon_picture_ptr->stride_cb) * bytes_per_sample;
+    pass.recon_buffer[2] = recon_picture_ptr->buffer_cr + (recon_picture_ptr->origin_x / 2 + recon_picture_ptr->origin_y / 2 * recon_picture_ptr->stride_cr) * bytes_per_sample;
+    pass.recon_stride[0] = recon_picture_ptr->stride_y;
+    pass.recon_stride[1] = recon_picture_ptr->stride_cb;
+    pass.recon_stride[2] = recon_picture_ptr->stride_cr;
+    pass.coeff_shift = AOMMAX(sequence_control_set_ptr->static_config.encoder_bit_depth/*cm->bit_depth*/ - 8, 0);
+    pass.nvfb = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+    pass.nhfb = (cm->mi_cols + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+    pass.boundary_stride = (cm->mi_cols << MI_SIZE_LOG2) + 2 * CDEF_HBORDER;
+    for (int32_t pli = 0; pli < 3; pli++) {
+        pass.boundary[pli] = (uint16_t *)eb_aom_malloc(sizeof(*pass.boundary[pli]) * 2 * CDEF_VBORDER * pass.boundary_stride * AOMMAX(pass.nvfb - 1, 1));
+        assert(pass.boundary[pli] != NULL);
     }
 
-    for (int32_t fbr = 0; fbr < nvfb; fbr++) {
-        for (int32_t pli = 0; pli < num_planes; pli++) {
-            const int32_t block_height =
-                (MI_SIZE_64X64 << mi_high_l2[pli]) + 2 * CDEF_VBORDER;
-            fill_rect(colbuf[pli], CDEF_HBORDER, block_height, CDEF_HBORDER,
-                CDEF_VERY_LARGE);
-        }
-
-        int32_t cdef_left = 1;
-        for (int32_t fbc = 0; fbc < nhfb; fbc++) {
-            int32_t level, sec_strength;
-            int32_t uv_level, uv_sec_strength;
-            int32_t nhb, nvb;
-            int32_t cstart = 0;
-            curr_row_cdef[fbc] = 0;
-
-            //WAHT IS THIS  ?? CHKN -->for
-            if (pCs->mi_grid_base[MI_SIZE_64X64 * fbr * cm->mi_stride + MI_SIZE_64X64 * fbc] == NULL ||
-                pCs->mi_grid_base[MI_SIZE_64X64 * fbr * cm->mi_stride + MI_SIZE_64X64 * fbc]->mbmi.cdef_strength == -1) {
-                cdef_left = 0;
-                printf("\n\n\nCDEF ERROR: Skipping Current FB\n\n\n");
-                continue;
-            }
-
-            if (!cdef_left) cstart = -CDEF_HBORDER;  //CHKN if the left block has not been filtered, then we can use samples on the left as input.
-
-            nhb = AOMMIN(MI_SIZE_64X64, cm->mi_cols - MI_SIZE_64X64 * fbc);
-            nvb = AOMMIN(MI_SIZE_64X64, cm->mi_rows - MI_SIZE_64X64 * fbr);
-            int32_t frame_top, frame_left, frame_bottom, frame_right;
-
-            int32_t mi_row = MI_SIZE_64X64 * fbr;
-            int32_t mi_col = MI_SIZE_64X64 * fbc;
-            // for the current filter block, it's top left corner mi structure (mi_tl)
-            // is first accessed to check whether the top and left boundaries are
-            // frame boundaries. Then bottom-left and top-right mi structures are
-            // accessed to check whether the bottom and right boundaries
-            // (respectively) are frame boundaries.
-            //
-            // Note that we can't just check the bottom-right mi structure - eg. if
-            // we're at the right-hand edge of the frame but not the bottom, then
-            // the bottom-right mi is NULL but the bottom-left is not.
-            frame_top = (mi_row == 0) ? 1 : 0;
-            frame_left = (mi_col == 0) ? 1 : 0;
-
-            if (fbr != nvfb - 1)
-                frame_bottom = (mi_row + MI_SIZE_64X64 == cm->mi_rows) ? 1 : 0;
-            else
-                frame_bottom = 1;
-
-            if (fbc != nhfb - 1)
-                frame_right = (mi_col + MI_SIZE_64X64 == cm->mi_cols) ? 1 : 0;
-            else
-                frame_right = 1;
-
-            const int32_t mbmi_cdef_strength = pCs->mi_grid_base[MI_SIZE_64X64 * fbr * cm->mi_stride + MI_SIZE_64X64 * fbc]->mbmi.cdef_strength;
-            level = frm_hdr->CDEF_params.cdef_y_strength[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
-            sec_strength = frm_hdr->CDEF_params.cdef_y_strength[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
-            sec_strength += sec_strength == 3;
-            uv_level = frm_hdr->CDEF_params.cdef_uv_strength[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
-            uv_sec_strength = frm_hdr->CDEF_params.cdef_uv_strength[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
-            uv_sec_strength += uv_sec_strength == 3;
-            if ((level == 0 && sec_strength == 0 && uv_level == 0 && uv_sec_strength == 0) ||
-                (cdef_count = eb_sb_compute_cdef_list(pCs, cm, fbr * MI_SIZE_64X64, fbc * MI_SIZE_64X64, dlist, BLOCK_64X64)) == 0) {
-                cdef_left = 0;
-                continue;
-            }
-
-            curr_row_cdef[fbc] = 1;
-            for (int32_t pli = 0; pli < num_planes; pli++) {
-                int32_t coffset;
-                int32_t rend, cend;
-                int32_t pri_damping = frm_hdr->CDEF_params.cdef_damping;
-                int32_t sec_damping = frm_hdr->CDEF_params.cdef_damping;
-                int32_t hsize = nhb << mi_wide_l2[pli];
-                int32_t vsize = nvb << mi_high_l2[pli];
-
-                if (pli) {
-                    level = uv_level;
-                    sec_strength = uv_sec_strength;
-                }
-
-                if (fbc == nhfb - 1)
-                    cend = hsize;
-                else
-                    cend = hsize + CDEF_HBORDER;
-
-                if (fbr == nvfb - 1)
-                    rend = vsize;
-                else
-                    rend = vsize + CDEF_VBORDER;
-
-                coffset = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
-                if (fbc == nhfb - 1) {
-                    /* On the last superblock column, fill in the right border with
-                    CDEF_VERY_LARGE to avoid filtering with the outside. */
-                    fill_rect(&src[cend + CDEF_HBORDER], CDEF_BSTRIDE,
-                        rend + CDEF_VBORDER, hsize + CDEF_HBORDER - cend,
-                        CDEF_VERY_LARGE);
-                }
-                if (fbr == nvfb - 1) {
-                    /* On the last superblock row, fill in the bottom border with
-                    CDEF_VERY_LARGE to avoid filtering with the outside. */
-                    fill_rect(&src[(rend + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
-                        CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
-
-                uint16_t* recBuff = 0;
-                uint32_t recStride = 0;
-
-                switch (pli) {
-                case 0:
-                    recBuff = reconBufferY;
-                    recStride = recon_picture_ptr->stride_y;
-                    break;
-                case 1:
-                    recBuff = reconBufferCb;
-                    recStride = recon_picture_ptr->stride_cb;
-
-                    break;
-                case 2:
-                    recBuff = reconBufferCr;
-                    recStride = recon_picture_ptr->stride_cr;
-                    break;
-                }
-
-                //--ok
-                                /* Copy in the pixels we need from the current superblock for
-                                deringing.*/
-
-                copy_sb16_16(//cm,
-                    &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER + cstart],
-                    CDEF_BSTRIDE, recBuff/*xd->plane[pli].dst.buf*/,
-                    (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr, coffset + cstart,
-                    recStride/*xd->plane[pli].dst.stride*/, rend, cend - cstart);
-
-                if (!prev_row_cdef[fbc]) {
-                    copy_sb16_16(//cm,
-                        &src[CDEF_HBORDER], CDEF_BSTRIDE,
-                        recBuff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                        coffset, recStride/*xd->plane[pli].dst.stride*/, CDEF_VBORDER, hsize);
-                }
-                else if (fbr > 0) {
-                    copy_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, &linebuf[pli][coffset],
-                        stride, CDEF_VBORDER, hsize);
-                }
-                else {
-                    fill_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER, hsize,
-                        CDEF_VERY_LARGE);
-                }
-
-                if (!prev_row_cdef[fbc - 1]) {
-                    copy_sb16_16(//cm,
-                        src, CDEF_BSTRIDE, recBuff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                        coffset - CDEF_HBORDER, recStride/*xd->plane[pli].dst.stride*/,
-                        CDEF_VBORDER, CDEF_HBORDER);
-                }
-                else if (fbr > 0 && fbc > 0) {
-                    copy_rect(src, CDEF_BSTRIDE, &linebuf[pli][coffset - CDEF_HBORDER],
-                        stride, CDEF_VBORDER, CDEF_HBORDER);
-                }
-                else {
-                    fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, CDEF_HBORDER,
-                        CDEF_VERY_LARGE);
-                }
-
-                if (!prev_row_cdef[fbc + 1]) {
-                    copy_sb16_16(//cm,
-                        &src[CDEF_HBORDER + (nhb << mi_wide_l2[pli])],
-                        CDEF_BSTRIDE, recBuff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                        coffset + hsize, recStride/*xd->plane[pli].dst.stride*/, CDEF_VBORDER,
-                        CDEF_HBORDER);
-                }
-                else if (fbr > 0 && fbc < nhfb - 1) {
-                    copy_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                        &linebuf[pli][coffset + hsize], stride, CDEF_VBORDER,
-                        CDEF_HBORDER);
-                }
-                else {
-                    fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER,
-                        CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
-
-                if (cdef_left) {
-                    /* If we deringed the superblock on the left then we need to copy in
-                    saved pixels. */
-                    copy_rect(src, CDEF_BSTRIDE, colbuf[pli], CDEF_HBORDER,
-                        rend + CDEF_VBORDER, CDEF_HBORDER);
-                }
+    row_segments_run(
+        pCs->cdef_row_segments,
+        save_cdef_boundary_row,
+        &pass,
+        pass.nvfb - 1);
+    row_segments_run(
+        pCs->cdef_row_segments,
+        cdef_fb_row,
+        &pass,
+        pass.nvfb);
+
+    for (int32_t pli = 0; pli < 3; pli++)
+        eb_aom_free(pass.boundary[pli]);
+}
 
-                /* Saving pixels in case we need to dering the superblock on the
-                right. */
-                if (fbc < nhfb - 1)
-                    copy_rect(colbuf[pli], CDEF_HBORDER, src + hsize, CDEF_BSTRIDE,
-                        rend + CDEF_VBORDER, CDEF_HBORDER);
-                if (fbr < nvfb - 1)
-                    copy_sb16_16(
-                        //cm,
-                        &linebuf[pli][coffset], stride, recBuff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli]) * (fbr + 1) - CDEF_VBORDER,
-                        coffset, recStride/*xd->plane[pli].dst.stride*/, CDEF_VBORDER, hsize);
-                if (frame_top) {
-                    fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
-                        CDEF_VERY_LARGE);
-                }
-                if (frame_left) {
-                    fill_rect(src, CDEF_BSTRIDE, vsize + 2 * CDEF_VBORDER, CDEF_HBORDER,
-                        CDEF_VERY_LARGE);
-                }
-                if (frame_bottom) {
-                    fill_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
-                        CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
-                if (frame_right) {
-                    fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                        vsize + 2 * CDEF_VBORDER, CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
+void eb_av1_cdef_frame(
+    EncDecContext                *context_ptr,
+    SequenceControlSet           *sequence_control_set_ptr,
+    PictureControlSet            *pCs){
+    (void)context_ptr;
+    cdef_frame_rows(sequence_control_set_ptr, pCs, EB_FALSE);
+}
 
-                //if (cm->use_highbitdepth) {
-                //  eb_cdef_filter_fb(
-                //      NULL,
-                //      &CONVERT_TO_SHORTPTR(
-                //          xd->plane[pli]
-                //              .dst.buf)[xd->plane[pli].dst.stride *
-                //                            (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +
-                //                        (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
-                //      xd->plane[pli].dst.stride,
-                //      &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
-                //      ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
-                //      sec_strength, pri_damping, sec_damping, coeff_shift);
-                //} else
-                {
-                    eb_cdef_filter_fb(
-                        NULL,
-                        &recBuff[recStride *(MI_SIZE_64X64 * fbr << mi_high_l2[pli]) + (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
-                        //&xd->plane[pli].dst.buf[xd->plane[pli].dst.stride *(MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +(fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
-                        recStride/*xd->plane[pli].dst.stride*/,
-                        &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
-                        ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
-                        sec_strength, pri_damping, sec_damping, coeff_shift);
-                }
-            }
-            cdef_left = 1;  //CHKN filtered data is written back directy to recFrame.
-        }
-        {
-            uint8_t *tmp = prev_row_cdef;
-            prev_row_cdef = curr_row_cdef;
-            curr_row_cdef = tmp;
-        }
-    }
-    eb_aom_free(row_cdef);
-    for (int32_t pli = 0; pli < num_planes; pli++) {
-        eb_aom_free(linebuf[pli]);
-        eb_aom_free(colbuf[pli]);
-    }
+void av1_cdef_frame16bit(
+    EncDecContext                *context_ptr,
+    SequenceControlSet           *sequence_control_set_ptr,
+    PictureControlSet            *pCs){
+    (void)context_ptr;
+    cdef_frame_rows(sequence_control_set_ptr, pCs, EB_TRUE);
 }
 
 ///-------search
@@ -24,6 +24,8 @@
 
 #include "EbCdef.h"
 #include "EbEncDecProcess.h"
+#include "EbRestProcess.h"
+#include "EbTrace.h"
 
 static int32_t priconv[REDUCED_PRI_STRENGTHS] = { 0, 1, 2, 3, 5, 7, 10, 13 };
 
@@ -59,6 +61,7 @@ void eb_av1_loop_restoration_save_boundary_lines(const Yv12BufferConfig *frame,
 EbErrorType cdef_context_ctor(
     CdefContext_t           *context_ptr,
     EbFifo                *cdef_input_fifo_ptr,
+    EbFifo                *cdef_help_fifo_ptr,
     EbFifo                *cdef_output_fifo_ptr ,
     EbBool                  is16bit,
     uint32_t                max_input_luma_width,
@@ -69,6 +72,7 @@ EbErrorType cdef_context_ctor(
 
     // Input/Output System Resource Manager FIFOs
     context_ptr->cdef_input_fifo_ptr = cdef_input_fifo_ptr;
+    context_ptr->cdef_help_fifo_ptr = cdef_help_fifo_ptr;
     context_ptr->cdef_output_fifo_ptr = cdef_output_fifo_ptr;
 
     return EB_ErrorNone;
@@ -412,9 +416,40 @@ void cdef_seg_search16bit(
 }
 
 /******************************************************
- * CDEF Kernel
+ * Post Cdef Help Tasks
+ *   Asks the other CDEF threads to join the filter block
+ *   rows of the picture. Each task holds the picture until
+ *   the thread taking it is done with it.
  ******************************************************/
-void* cdef_kernel(void *input_ptr)
+static void post_cdef_help_tasks(
+    CdefContext_t      *context_ptr,
+    SequenceControlSet *sequence_control_set_ptr,
+    EbObjectWrapper    *picture_control_set_wrapper_ptr)
+{
+    EbObjectWrapper *help_wrapper_ptr;
+    DlfResults      *help_ptr;
+    uint32_t picture_height_in_sb = (sequence_control_set_ptr->seq_header.max_frame_height + sequence_control_set_ptr->sb_size_pix - 1) / sequence_control_set_ptr->sb_size_pix;
+    uint32_t help_count = MIN(sequence_control_set_ptr->cdef_process_init_count, picture_height_in_sb) - 1;
+    uint32_t help_index;
+
+    if (help_count == 0)
+        return;
+    eb_object_inc_live_count(picture_control_set_wrapper_ptr, help_count);
+    for (help_index = 0; help_index < help_count; ++help_index) {
+        eb_get_empty_object(
+            context_ptr->cdef_help_fifo_ptr,
+            &help_wrapper_ptr);
+        help_ptr = (DlfResults*)help_wrapper_ptr->object_ptr;
+        help_ptr->picture_control_set_wrapper_ptr = picture_control_set_wrapper_ptr;
+        help_ptr->task_type = FILTER_TASK_HELP;
+        eb_post_full_object(help_wrapper_ptr);
+    }
+}
+
+/******************************************************
+ * CDEF Task
+ ******************************************************/
+void cdef_task(void *input_ptr, EbObjectWrapper *dlf_results_wrapper_ptr)
 {
     // Context & SCS & PCS
     CdefContext_t                            *context_ptr = (CdefContext_t*)input_ptr;
@@ -424,7 +459,6 @@ void* cdef_kernel(void *input_ptr)
     FrameHeader                           *frm_hdr;
 
     //// Input
-    EbObjectWrapper                       *dlf_results_wrapper_ptr;
     DlfResults                            *dlf_results_ptr;
 
     //// Output
@@ -433,110 +467,154 @@ void* cdef_kernel(void *input_ptr)
 
     // SB Loop variables
 
-    for (;;) {
-        // Get DLF Results
-        eb_get_full_object(
-            context_ptr->cdef_input_fifo_ptr,
-            &dlf_results_wrapper_ptr);
+    dlf_results_ptr = (DlfResults*)dlf_results_wrapper_ptr->object_ptr;
+    picture_control_set_ptr = (PictureControlSet*)dlf_results_ptr->picture_control_set_wrapper_ptr->object_ptr;
+    eb_trace_set_object(picture_control_set_ptr->picture_number, (int32_t)dlf_results_ptr->segment_index);
+    sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
 
-        dlf_results_ptr = (DlfResults*)dlf_results_wrapper_ptr->object_ptr;
-        picture_control_set_ptr = (PictureControlSet*)dlf_results_ptr->picture_control_set_wrapper_ptr->object_ptr;
-        sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
+    if (dlf_results_ptr->task_type == FILTER_TASK_HELP) {
+        row_segments_help(picture_control_set_ptr->cdef_row_segments);
+        eb_release_object(dlf_results_ptr->picture_control_set_wrapper_ptr);
+        eb_release_object(dlf_results_wrapper_ptr);
+        return;
+    }
 
-        EbBool  is16bit = (EbBool)(sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
-        Av1Common* cm = picture_control_set_ptr->parent_pcs_ptr->av1_cm;
-        frm_hdr = &picture_control_set_ptr->parent_pcs_ptr->frm_hdr;
-        int32_t selected_strength_cnt[64] = { 0 };
+    EbBool  is16bit = (EbBool)(sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
+    Av1Common* cm = picture_control_set_ptr->parent_pcs_ptr->av1_cm;
+    frm_hdr = &picture_control_set_ptr->parent_pcs_ptr->frm_hdr;
+    int32_t selected_strength_cnt[64] = { 0 };
+
+    // The segment reads its filter blocks and the rows below down to the
+    // bottom border, all final once EncDec is done with the next SB row
+    if (enc_dec_streams_rows(picture_control_set_ptr)) {
+        uint32_t picture_height_in_b64 = (sequence_control_set_ptr->seq_header.max_frame_height + 64 - 1) / 64;
+        uint32_t picture_height_in_sb = (sequence_control_set_ptr->seq_header.max_frame_height + sequence_control_set_ptr->sb_size_pix - 1) / sequence_control_set_ptr->sb_size_pix;
+        uint32_t y_seg_idx = dlf_results_ptr->segment_index / picture_control_set_ptr->cdef_segments_column_count;
+        uint32_t y_b64_end_idx = SEGMENT_END_IDX(y_seg_idx, picture_height_in_b64, picture_control_set_ptr->cdef_segments_row_count);
+        uint32_t row_count = ((y_b64_end_idx + 1) * 64 + sequence_control_set_ptr->sb_size_pix - 1) / sequence_control_set_ptr->sb_size_pix;
+        enc_dec_wait_rows(
+            picture_control_set_ptr,
+            MIN(row_count, picture_height_in_sb));
+    }
 
-        if (sequence_control_set_ptr->seq_header.enable_cdef && picture_control_set_ptr->parent_pcs_ptr->cdef_filter_mode)
-        {
-            if (is16bit)
-                cdef_seg_search16bit(
-                    picture_control_set_ptr,
-                    sequence_control_set_ptr,
-                    dlf_results_ptr->segment_index);
-            else
-                cdef_seg_search(
-                    picture_control_set_ptr,
-                    sequence_control_set_ptr,
-                    dlf_results_ptr->segment_index);
-        }
+    if (sequence_control_set_ptr->seq_header.enable_cdef && picture_control_set_ptr->parent_pcs_ptr->cdef_filter_mode)
+    {
+        if (is16bit)
+            cdef_seg_search16bit(
+                picture_control_set_ptr,
+                sequence_control_set_ptr,
+                dlf_results_ptr->segment_index);
+        else
+            cdef_seg_search(
+                picture_control_set_ptr,
+                sequence_control_set_ptr,
+                dlf_results_ptr->segment_index);
+    }
 
-        //all seg based search is done. update total processed segments. if all done, finish the search and perfrom application.
-        eb_block_on_mutex(picture_control_set_ptr->cdef_search_mutex);
+    //all seg based search is done. update total processed segments. if all done, finish the search and perfrom application.
+    eb_block_on_mutex(picture_control_set_ptr->cdef_search_mutex);
 
-        picture_control_set_ptr->tot_seg_searched_cdef++;
-        if (picture_control_set_ptr->tot_seg_searched_cdef == picture_control_set_ptr->cdef_segments_total_count)
-        {
-           // printf("    CDEF all seg here  %i\n", picture_control_set_ptr->picture_number);
-        if (sequence_control_set_ptr->seq_header.enable_cdef && picture_control_set_ptr->parent_pcs_ptr->cdef_filter_mode) {
-                finish_cdef_search(
-                    0,
+    picture_control_set_ptr->tot_seg_searched_cdef++;
+    if (picture_control_set_ptr->tot_seg_searched_cdef == picture_control_set_ptr->cdef_segments_total_count)
+    {
+        // The deblocked frame is complete, keep the lines restoration needs before CDEF
+        if (sequence_control_set_ptr->seq_header.enable_restoration)
+            eb_av1_loop_restoration_save_boundary_lines(cm->frame_to_show, cm, 0);
+
+       // printf("    CDEF all seg here  %i\n", picture_control_set_ptr->picture_number);
+    if (sequence_control_set_ptr->seq_header.enable_cdef && picture_control_set_ptr->parent_pcs_ptr->cdef_filter_mode) {
+            finish_cdef_search(
+                0,
+                sequence_control_set_ptr,
+                picture_control_set_ptr,
+                selected_strength_cnt);
+
+            // The restoration search reads the CDEF output
+            if (sequence_control_set_ptr->seq_header.enable_restoration != 0 || filtered_recon_needed(sequence_control_set_ptr, picture_control_set_ptr)){
+                // The filter block rows are shared with the other CDEF threads
+                row_segments_open(picture_control_set_ptr->cdef_row_segments);
+                post_cdef_help_tasks(
+                    context_ptr,
                     sequence_control_set_ptr,
-                    picture_control_set_ptr,
-                    selected_strength_cnt);
-
-                if (sequence_control_set_ptr->seq_header.enable_restoration != 0 || picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag || sequence_control_set_ptr->static_config.recon_enabled){
-                    if (is16bit)
-                        av1_cdef_frame16bit(
-                            0,
-                            sequence_control_set_ptr,
-                            picture_control_set_ptr);
-                    else
-                        eb_av1_cdef_frame(
-                            0,
-                            sequence_control_set_ptr,
-                            picture_control_set_ptr);
-                }
-        }
-        else {
-            frm_hdr->CDEF_params.cdef_bits = 0;
-            frm_hdr->CDEF_params.cdef_y_strength[0] = 0;
-            picture_control_set_ptr->parent_pcs_ptr->nb_cdef_strengths = 1;
-            frm_hdr->CDEF_params.cdef_uv_strength[0] = 0;
-        }
+                    dlf_results_ptr->picture_control_set_wrapper_ptr);
+                if (is16bit)
+                    av1_cdef_frame16bit(
+                        0,
+                        sequence_control_set_ptr,
+                        picture_control_set_ptr);
+                else
+                    eb_av1_cdef_frame(
+                        0,
+                        sequence_control_set_ptr,
+                        picture_control_set_ptr);
+                row_segments_close(picture_control_set_ptr->cdef_row_segments);
+            }
+    }
+    else {
+        frm_hdr->CDEF_params.cdef_bits = 0;
+        frm_hdr->CDEF_params.cdef_y_strength[0] = 0;
+        picture_control_set_ptr->parent_pcs_ptr->nb_cdef_strengths = 1;
+        frm_hdr->CDEF_params.cdef_uv_strength[0] = 0;
+    }
 
-        //restoration prep
+    //restoration prep
+
+    if (sequence_control_set_ptr->seq_header.enable_restoration)
+    {
+        eb_av1_loop_restoration_save_boundary_lines(
+            cm->frame_to_show,
+            cm,
+            1);
+
+        //are these still needed here?/!!!
+        eb_extend_frame(cm->frame_to_show->buffers[0], cm->frame_to_show->crop_widths[0], cm->frame_to_show->crop_heights[0],
+            cm->frame_to_show->strides[0], RESTORATION_BORDER, RESTORATION_BORDER, is16bit);
+        eb_extend_frame(cm->frame_to_show->buffers[1], cm->frame_to_show->crop_widths[1], cm->frame_to_show->crop_heights[1],
+            cm->frame_to_show->strides[1], RESTORATION_BORDER, RESTORATION_BORDER, is16bit);
+        eb_extend_frame(cm->frame_to_show->buffers[2], cm->frame_to_show->crop_widths[1], cm->frame_to_show->crop_heights[1],
+            cm->frame_to_show->strides[1], RESTORATION_BORDER, RESTORATION_BORDER, is16bit);
+    }
 
-        if (sequence_control_set_ptr->seq_header.enable_restoration)
-        {
-            eb_av1_loop_restoration_save_boundary_lines(
-                cm->frame_to_show,
-                cm,
-                1);
-
-            //are these still needed here?/!!!
-            eb_extend_frame(cm->frame_to_show->buffers[0], cm->frame_to_show->crop_widths[0], cm->frame_to_show->crop_heights[0],
-                cm->frame_to_show->strides[0], RESTORATION_BORDER, RESTORATION_BORDER, is16bit);
-            eb_extend_frame(cm->frame_to_show->buffers[1], cm->frame_to_show->crop_widths[1], cm->frame_to_show->crop_heights[1],
-                cm->frame_to_show->strides[1], RESTORATION_BORDER, RESTORATION_BORDER, is16bit);
-            eb_extend_frame(cm->frame_to_show->buffers[2], cm->frame_to_show->crop_widths[1], cm->frame_to_show->crop_heights[1],
-                cm->frame_to_show->strides[1], RESTORATION_BORDER, RESTORATION_BORDER, is16bit);
-        }
+    picture_control_set_ptr->rest_segments_column_count = sequence_control_set_ptr->rest_segment_column_count;
+    picture_control_set_ptr->rest_segments_row_count =   sequence_control_set_ptr->rest_segment_row_count;
+    picture_control_set_ptr->rest_segments_total_count = (uint16_t)(picture_control_set_ptr->rest_segments_column_count  * picture_control_set_ptr->rest_segments_row_count);
+    picture_control_set_ptr->tot_seg_searched_rest = 0;
+    uint32_t segment_index;
+    for (segment_index = 0; segment_index < picture_control_set_ptr->rest_segments_total_count; ++segment_index)
+    {
+        // Get Empty Cdef Results to Rest
+        eb_get_empty_object(
+            context_ptr->cdef_output_fifo_ptr,
+            &cdef_results_wrapper_ptr);
+        cdef_results_ptr = (struct CdefResults*)cdef_results_wrapper_ptr->object_ptr;
+        cdef_results_ptr->picture_control_set_wrapper_ptr = dlf_results_ptr->picture_control_set_wrapper_ptr;
+        cdef_results_ptr->segment_index = segment_index;
+        cdef_results_ptr->task_type = FILTER_TASK_PROCESS;
+        // Post Cdef Results
+        eb_post_full_object(cdef_results_wrapper_ptr);
+    }
+    }
+    eb_release_mutex(picture_control_set_ptr->cdef_search_mutex);
 
-        picture_control_set_ptr->rest_segments_column_count = sequence_control_set_ptr->rest_segment_column_count;
-        picture_control_set_ptr->rest_segments_row_count =   sequence_control_set_ptr->rest_segment_row_count;
-        picture_control_set_ptr->rest_segments_total_count = (uint16_t)(picture_control_set_ptr->rest_segments_column_count  * picture_control_set_ptr->rest_segments_row_count);
-        picture_control_set_ptr->tot_seg_searched_rest = 0;
-        uint32_t segment_index;
-        for (segment_index = 0; segment_index < picture_control_set_ptr->rest_segments_total_count; ++segment_index)
-        {
-            // Get Empty Cdef Results to Rest
-            eb_get_empty_object(
-                context_ptr->cdef_output_fifo_ptr,
-                &cdef_results_wrapper_ptr);
-            cdef_results_ptr = (struct CdefResults*)cdef_results_wrapper_ptr->object_ptr;
-            cdef_results_ptr->picture_control_set_wrapper_ptr = dlf_results_ptr->picture_control_set_wrapper_ptr;
-            cdef_results_ptr->segment_index = segment_index;
-            // Post Cdef Results
-            eb_post_full_object(cdef_results_wrapper_ptr);
-        }
-        }
-        eb_release_mutex(picture_control_set_ptr->cdef_search_mutex);
+    // Release Dlf Results
+    eb_release_object(dlf_results_wrapper_ptr);
+}
 
-        // Release Dlf Results
-        eb_release_object(dlf_results_wrapper_ptr);
-    }
+/******************************************************
+ * Cdef Kernel
+ ******************************************************/
+void* cdef_kernel(void *input_ptr)
+{
+    CdefContext_t                            *context_ptr = (CdefContext_t*)input_ptr;
+    EbObjectWrapper                       *dlf_results_wrapper_ptr;
 
+    for (;;) {
+        // Get DLF Results
+        eb_get_full_object(
+            context_ptr->cdef_input_fifo_ptr,
+            &dlf_results_wrapper_ptr);
+
+        cdef_task(input_ptr, dlf_results_wrapper_ptr);
+    }
     return EB_NULL;
 }
@@ -22,6 +22,7 @@ typedef struct CdefContext_s
 {
     EbDctor                       dctor;
     EbFifo                       *cdef_input_fifo_ptr;
+    EbFifo                       *cdef_help_fifo_ptr;
     EbFifo                       *cdef_output_fifo_ptr;
 } CdefContext_t;
 
@@ -31,6 +32,7 @@ typedef struct CdefContext_s
 extern EbErrorType cdef_context_ctor(
     CdefContext_t           *context_ptr,
     EbFifo                       *cdef_input_fifo_ptr,
+    EbFifo                       *cdef_help_fifo_ptr,
     EbFifo                       *cdef_output_fifo_ptr,
     EbBool                  is16bit,
     uint32_t                max_input_luma_width,
@@ -38,5 +40,6 @@ extern EbErrorType cdef_context_ctor(
    );
 
 extern void* cdef_kernel(void *input_ptr);
+extern void cdef_task(void *input_ptr, EbObjectWrapper *input_wrapper_ptr);
 
 #endif
@@ -1359,12 +1359,45 @@ void eb_av1_loop_filter_frame(
 }
 extern int16_t eb_av1_ac_quant_Q3(int32_t qindex, int32_t delta, AomBitDepth bit_depth);
 
+// Copies the rows [row_start, row_end) of one plane, in units of that plane
+static void copy_buffer_rows(
+    EbPictureBufferDesc  *srcBuffer,
+    EbPictureBufferDesc  *dstBuffer,
+    PictureControlSet    *pcs_ptr,
+    uint8_t               plane,
+    uint32_t              row_start,
+    uint32_t              row_end) {
+    EbBool is16bit = (EbBool)(pcs_ptr->parent_pcs_ptr->sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
+    uint16_t   luma_width = (uint16_t)(srcBuffer->width - pcs_ptr->parent_pcs_ptr->sequence_control_set_ptr->pad_right) << is16bit;
+    uint16_t   luma_height = (uint16_t)(srcBuffer->height - pcs_ptr->parent_pcs_ptr->sequence_control_set_ptr->pad_bottom);
+    const uint32_t ss = plane ? 1 : 0;
+    const uint32_t width = luma_width >> ss;
+    const uint32_t height = luma_height >> ss;
+    EbByte   src_buf;
+    EbByte   dst_buf;
+    uint32_t stride;
+
+    switch (plane) {
+    case 0: src_buf = srcBuffer->buffer_y; dst_buf = dstBuffer->buffer_y; stride = srcBuffer->stride_y; break;
+    case 1: src_buf = srcBuffer->buffer_cb; dst_buf = dstBuffer->buffer_cb; stride = srcBuffer->stride_cb; break;
+    case 2: src_buf = srcBuffer->buffer_cr; dst_buf = dstBuffer->buffer_cr; stride = srcBuffer->stride_cr; break;
+    default: return;
+    }
+    const uint32_t offset = ((srcBuffer->origin_x >> ss) + (srcBuffer->origin_y >> ss) * stride) << is16bit;
+    stride <<= is16bit;
+    row_end = AOMMIN(row_end, height);
+    for (uint32_t inputRowIndex = row_start; inputRowIndex < row_end; inputRowIndex++) {
+        EB_MEMCPY((dst_buf + offset + stride * inputRowIndex),
+            (src_buf + offset + stride * inputRowIndex),
+            width);
+    }
+}
+
 void EbCopyBuffer(
     EbPictureBufferDesc  *srcBuffer,
     EbPictureBufferDesc  *dstBuffer,
     PictureControlSet    *pcs_ptr,
     uint8_t                   plane) {
-    EbBool is16bit = (EbBool)(pcs_ptr->parent_pcs_ptr->sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
     dstBuffer->origin_x = srcBuffer->origin_x;
     dstBuffer->origin_y = srcBuffer->origin_y;
     dstBuffer->width = srcBuffer->width;
@@ -1376,51 +1409,20 @@ void EbCopyBuffer(
     dstBuffer->chroma_size = srcBuffer->chroma_size;
     dstBuffer->packedFlag = srcBuffer->packedFlag;
 
-    uint32_t   lumaBufferOffset = (srcBuffer->origin_x + srcBuffer->origin_y*srcBuffer->stride_y) << is16bit;
-    uint16_t   luma_width = (uint16_t)(srcBuffer->width - pcs_ptr->parent_pcs_ptr->sequence_control_set_ptr->pad_right) << is16bit;
-    uint16_t   luma_height = (uint16_t)(srcBuffer->height - pcs_ptr->parent_pcs_ptr->sequence_control_set_ptr->pad_bottom);
-    uint16_t   chroma_width = (luma_width >> 1);
     if (plane == 0) {
-        uint16_t stride_y = srcBuffer->stride_y << is16bit;
-
         dstBuffer->stride_y = srcBuffer->stride_y;
         dstBuffer->stride_bit_inc_y = srcBuffer->stride_bit_inc_y;
-
-        for (int32_t inputRowIndex = 0; inputRowIndex < luma_height; inputRowIndex++) {
-            EB_MEMCPY((dstBuffer->buffer_y + lumaBufferOffset + stride_y * inputRowIndex),
-                (srcBuffer->buffer_y + lumaBufferOffset + stride_y * inputRowIndex),
-                luma_width);
-        }
     }
     else if (plane == 1) {
-        uint16_t stride_cb = srcBuffer->stride_cb << is16bit;
         dstBuffer->stride_cb = srcBuffer->stride_cb;
         dstBuffer->stride_bit_inc_cb = srcBuffer->stride_bit_inc_cb;
-
-        uint32_t   chromaBufferOffset = (srcBuffer->origin_x / 2 + srcBuffer->origin_y / 2 * srcBuffer->stride_cb) << is16bit;
-
-        for (int32_t inputRowIndex = 0; inputRowIndex < luma_height >> 1; inputRowIndex++) {
-            EB_MEMCPY((dstBuffer->buffer_cb + chromaBufferOffset + stride_cb * inputRowIndex),
-                (srcBuffer->buffer_cb + chromaBufferOffset + stride_cb * inputRowIndex),
-                chroma_width);
-        }
     }
     else if (plane == 2) {
-        uint16_t stride_cr = srcBuffer->stride_cr << is16bit;
-
         dstBuffer->stride_cr = srcBuffer->stride_cr;
         dstBuffer->stride_bit_inc_cr = srcBuffer->stride_bit_inc_cr;
-
-        uint32_t   chromaBufferOffset = (srcBuffer->origin_x / 2 + srcBuffer->origin_y / 2 * srcBuffer->stride_cr) << is16bit;
-
-        for (int32_t inputRowIndex = 0; inputRowIndex < luma_height >> 1; inputRowIndex++) {
-            EB_MEMCPY((dstBuffer->buffer_cr + chromaBufferOffset + stride_cr * inputRowIndex),
-                (srcBuffer->buffer_cr + chromaBufferOffset + stride_cr * inputRowIndex),
-                chroma_width);
-        }
     }
+    copy_buffer_rows(srcBuffer, dstBuffer, pcs_ptr, plane, 0, srcBuffer->height);
 }
-
 //int32_t av1_get_max_filter_level(const Av1Comp *cpi) {
 //    if (cpi->oxcf.pass == 2) {
 //        return cpi->twopass.section_intra_rating > 8 ? MAX_LOOP_FILTER * 3 / 4
@@ -1431,157 +1433,160 @@ void EbCopyBuffer(
 //    }
 //}
 
-uint64_t PictureSseCalculations(
+// SSE of the rows [row_start, row_end) of one plane, in units of that plane
+static uint64_t picture_sse_rows(
     PictureControlSet    *picture_control_set_ptr,
     EbPictureBufferDesc *recon_ptr,
-    int32_t plane)
-
+    int32_t plane,
+    uint32_t row_start,
+    uint32_t row_end)
 {
     SequenceControlSet   *sequence_control_set_ptr = picture_control_set_ptr->parent_pcs_ptr->sequence_control_set_ptr;
     EbBool is16bit = (sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
+    EbPictureBufferDesc *input_picture_ptr = is16bit ?
+        picture_control_set_ptr->input_frame16bit :
+        (EbPictureBufferDesc*)picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr;
+    const uint32_t ss = plane ? 1 : 0;
+    const uint32_t width = plane ? sequence_control_set_ptr->chroma_width : sequence_control_set_ptr->seq_header.max_frame_width;
+    const uint32_t height = plane ? sequence_control_set_ptr->chroma_height : sequence_control_set_ptr->seq_header.max_frame_height;
+    EbByte     inputBuffer;
+    EbByte     reconCoeffBuffer;
+    uint32_t   input_stride;
+    uint32_t   recon_stride;
+    uint32_t   columnIndex;
+    uint32_t   row_index;
+    uint64_t   residualDistortion = 0;
 
-    if (!is16bit) {
-        EbPictureBufferDesc *input_picture_ptr = (EbPictureBufferDesc*)picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr;
-
-        uint32_t   columnIndex;
-        uint32_t   row_index = 0;
-        uint64_t   residualDistortion = 0;
-        EbByte  inputBuffer;
-        EbByte  reconCoeffBuffer;
-        if (plane == 0) {
-            reconCoeffBuffer = &((recon_ptr->buffer_y)[recon_ptr->origin_x + recon_ptr->origin_y * recon_ptr->stride_y]);
-            inputBuffer = &((input_picture_ptr->buffer_y)[input_picture_ptr->origin_x + input_picture_ptr->origin_y * input_picture_ptr->stride_y]);
-
-            residualDistortion = 0;
-
-            while (row_index < sequence_control_set_ptr->seq_header.max_frame_height) {
-                columnIndex = 0;
-                while (columnIndex < sequence_control_set_ptr->seq_header.max_frame_width) {
-                    residualDistortion += (int64_t)SQR((int64_t)(inputBuffer[columnIndex]) - (reconCoeffBuffer[columnIndex]));
-                    ++columnIndex;
-                }
-                inputBuffer += input_picture_ptr->stride_y;
-                reconCoeffBuffer += recon_ptr->stride_y;
-                ++row_index;
-            }
-
-            return residualDistortion;
-        }
-
-        else if (plane == 1) {
-            reconCoeffBuffer = &((recon_ptr->buffer_cb)[recon_ptr->origin_x / 2 + recon_ptr->origin_y / 2 * recon_ptr->stride_cb]);
-            inputBuffer = &((input_picture_ptr->buffer_cb)[input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_cb]);
-
-            residualDistortion = 0;
-            row_index = 0;
-            while (row_index < sequence_control_set_ptr->chroma_height) {
-                columnIndex = 0;
-                while (columnIndex < sequence_control_set_ptr->chroma_width) {
-                    residualDistortion += (int64_t)SQR((int64_t)(inputBuffer[columnIndex]) - (reconCoeffBuffer[columnIndex]));
-                    ++columnIndex;
-                }
-
-                inputBuffer += input_picture_ptr->stride_cb;
-                reconCoeffBuffer += recon_ptr->stride_cb;
-                ++row_index;
-            }
-
-            return residualDistortion;
+    switch (plane) {
+    case 0:
+        reconCoeffBuffer = recon_ptr->buffer_y; recon_stride = recon_ptr->stride_y;
+        inputBuffer = input_picture_ptr->buffer_y; input_stride = input_picture_ptr->stride_y;
+        break;
+    case 1:
+        reconCoeffBuffer = recon_ptr->buffer_cb; recon_stride = recon_ptr->stride_cb;
+        inputBuffer = input_picture_ptr->buffer_cb; input_stride = input_picture_ptr->stride_cb;
+        break;
+    case 2:
+        reconCoeffBuffer = recon_ptr->buffer_cr; recon_stride = recon_ptr->stride_cr;
+        inputBuffer = input_picture_ptr->buffer_cr; input_stride = input_picture_ptr->stride_cr;
+        break;
+    default: return 0;
+    }
+    reconCoeffBuffer += ((recon_ptr->origin_x >> ss) + ((recon_ptr->origin_y >> ss) + row_start) * recon_stride) << is16bit;
+    inputBuffer += ((input_picture_ptr->origin_x >> ss) + ((input_picture_ptr->origin_y >> ss) + row_start) * input_stride) << is16bit;
+
+    row_end = AOMMIN(row_end, height);
+    for (row_index = row_start; row_index < row_end; ++row_index) {
+        if (is16bit) {
+            const uint16_t *input16 = (const uint16_t*)inputBuffer;
+            const uint16_t *recon16 = (const uint16_t*)reconCoeffBuffer;
+            for (columnIndex = 0; columnIndex < width; ++columnIndex)
+                residualDistortion += (int64_t)SQR(((int64_t)input16[columnIndex]) - (int64_t)(recon16[columnIndex]));
         }
-        else if (plane == 2) {
-            reconCoeffBuffer = &((recon_ptr->buffer_cr)[recon_ptr->origin_x / 2 + recon_ptr->origin_y / 2 * recon_ptr->stride_cr]);
-            inputBuffer = &((input_picture_ptr->buffer_cr)[input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_cr]);
-            residualDistortion = 0;
-            row_index = 0;
-
-            while (row_index < sequence_control_set_ptr->chroma_height) {
-                columnIndex = 0;
-                while (columnIndex < sequence_control_set_ptr->chroma_width) {
-                    residualDistortion += (int64_t)SQR((int64_t)(inputBuffer[columnIndex]) - (reconCoeffBuffer[columnIndex]));
-                    ++columnIndex;
-                }
-
-                inputBuffer += input_picture_ptr->stride_cr;
-                reconCoeffBuffer += recon_ptr->stride_cr;
-                ++row_index;
-            }
-
-            return residualDistortion;
+        else {
+            for (columnIndex = 0; columnIndex < width; ++columnIndex)
+                residualDistortion += (int64_t)SQR((int64_t)(inputBuffer[columnIndex]) - (reconCoeffBuffer[columnIndex]));
         }
-        return 0;
+        inputBuffer += input_stride << is16bit;
+        reconCoeffBuffer += recon_stride << is16bit;
     }
-    else {
-        EbPictureBufferDesc *input_picture_ptr = (EbPictureBufferDesc*)picture_control_set_ptr->input_frame16bit;
-
-        uint32_t   columnIndex;
-        uint32_t   row_index = 0;
-        uint64_t   residualDistortion = 0;
-        uint16_t*  inputBuffer;
-        uint16_t*  reconCoeffBuffer;
-        if (plane == 0) {
-            reconCoeffBuffer = (uint16_t*)&((recon_ptr->buffer_y)[(recon_ptr->origin_x + recon_ptr->origin_y * recon_ptr->stride_y) << is16bit]);
-            inputBuffer = (uint16_t*)&((input_picture_ptr->buffer_y)[(input_picture_ptr->origin_x + input_picture_ptr->origin_y * input_picture_ptr->stride_y) << is16bit]);
-
-            residualDistortion = 0;
-
-            while (row_index < sequence_control_set_ptr->seq_header.max_frame_height) {
-                columnIndex = 0;
-                while (columnIndex < sequence_control_set_ptr->seq_header.max_frame_width) {
-                    residualDistortion += (int64_t)SQR(((int64_t)inputBuffer[columnIndex]) - (int64_t)(reconCoeffBuffer[columnIndex]));
-                    ++columnIndex;
-                }
-
-                inputBuffer += input_picture_ptr->stride_y;
-                reconCoeffBuffer += recon_ptr->stride_y;
-                ++row_index;
-            }
-
-            return residualDistortion;
-        }
+    return residualDistortion;
+}
 
-        else if (plane == 1) {
-            reconCoeffBuffer = (uint16_t*)&((recon_ptr->buffer_cb)[(recon_ptr->origin_x / 2 + recon_ptr->origin_y / 2 * recon_ptr->stride_cb) << is16bit]);
-            inputBuffer = (uint16_t*)&((input_picture_ptr->buffer_cb)[(input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_cb) << is16bit]);
-
-            residualDistortion = 0;
-            row_index = 0;
-            while (row_index < sequence_control_set_ptr->chroma_height) {
-                columnIndex = 0;
-                while (columnIndex < sequence_control_set_ptr->chroma_width) {
-                    residualDistortion += (int64_t)SQR(((int64_t)inputBuffer[columnIndex]) - (int64_t)(reconCoeffBuffer[columnIndex]));
-                    ++columnIndex;
-                }
+uint64_t PictureSseCalculations(
+    PictureControlSet    *picture_control_set_ptr,
+    EbPictureBufferDesc *recon_ptr,
+    int32_t plane)
+{
+    SequenceControlSet   *sequence_control_set_ptr = picture_control_set_ptr->parent_pcs_ptr->sequence_control_set_ptr;
+    return picture_sse_rows(picture_control_set_ptr, recon_ptr, plane, 0,
+        plane ? sequence_control_set_ptr->chroma_height : sequence_control_set_ptr->seq_header.max_frame_height);
+}
 
-                inputBuffer += input_picture_ptr->stride_cb;
-                reconCoeffBuffer += recon_ptr->stride_cb;
-                ++row_index;
-            }
+/**************************************
+ * Deblocking of a frame in SB rows shared by the DLF threads. SB x of row y
+ * is filtered once row y - 1 has filtered SB x + 1, which covers the pixels
+ * its horizontal edges read and write above. A trial pass measures the SSE
+ * of a row and restores it from the unfiltered copy once the row below it
+ * is done, as the row below is the last one to touch it.
+ **************************************/
+typedef struct LoopFilterRowPass {
+    EbPictureBufferDesc *frame_buffer;
+    EbPictureBufferDesc *temp_lf_recon_buffer;
+    PictureControlSet   *pcs_ptr;
+    int32_t              plane_start;
+    int32_t              plane_end;
+    uint32_t             sb_size_log2;
+    uint32_t             picture_width_in_sb;
+    uint32_t             picture_height_in_sb;
+    volatile uint64_t    sse;
+} LoopFilterRowPass;
+
+static void measure_and_restore_sb_row(LoopFilterRowPass *pass, uint32_t y_lcu_index) {
+    const int32_t plane = pass->plane_start;
+    const uint32_t ss = plane ? 1 : 0;
+    const uint32_t row_start = (y_lcu_index << pass->sb_size_log2) >> ss;
+    const uint32_t row_end = ((y_lcu_index + 1) << pass->sb_size_log2) >> ss;
+
+    eb_atomic_add_u64(&pass->sse, picture_sse_rows(pass->pcs_ptr, pass->frame_buffer, plane, row_start, row_end));
+    copy_buffer_rows(pass->temp_lf_recon_buffer, pass->frame_buffer, pass->pcs_ptr, (uint8_t)plane, row_start, row_end);
+}
 
-            return residualDistortion;
-        }
-        else if (plane == 2) {
-            reconCoeffBuffer = (uint16_t*)&((recon_ptr->buffer_cr)[(recon_ptr->origin_x / 2 + recon_ptr->origin_y / 2 * recon_ptr->stride_cr) << is16bit]);
-            inputBuffer = (uint16_t*)&((input_picture_ptr->buffer_cr)[(input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_cr) << is16bit]);
-            residualDistortion = 0;
-            row_index = 0;
-
-            while (row_index < sequence_control_set_ptr->chroma_height) {
-                columnIndex = 0;
-                while (columnIndex < sequence_control_set_ptr->chroma_width) {
-                    residualDistortion += (int64_t)SQR(((int64_t)inputBuffer[columnIndex]) - (int64_t)(reconCoeffBuffer[columnIndex]));
-                    ++columnIndex;
-                }
+static void loop_filter_sb_row(void *pass_ptr, uint32_t worker_index, uint32_t y_lcu_index) {
+    LoopFilterRowPass *pass = (LoopFilterRowPass*)pass_ptr;
+    RowSegments *segments_ptr = pass->pcs_ptr->dlf_row_segments;
+    uint32_t x_lcu_index;
+    (void)worker_index;
+
+    for (x_lcu_index = 0; x_lcu_index < pass->picture_width_in_sb; ++x_lcu_index) {
+        if (y_lcu_index)
+            row_segments_wait(segments_ptr, y_lcu_index - 1, AOMMIN(x_lcu_index + 2, pass->picture_width_in_sb));
+        loop_filter_sb(
+            pass->frame_buffer,
+            pass->pcs_ptr,
+            NULL,
+            (y_lcu_index << pass->sb_size_log2) >> 2,
+            (x_lcu_index << pass->sb_size_log2) >> 2,
+            pass->plane_start,
+            pass->plane_end,
+            x_lcu_index == pass->picture_width_in_sb - 1);
+        row_segments_set_progress(segments_ptr, y_lcu_index, x_lcu_index + 1);
+    }
 
-                inputBuffer += input_picture_ptr->stride_cr;
-                reconCoeffBuffer += recon_ptr->stride_cr;
-                ++row_index;
-            }
+    if (pass->temp_lf_recon_buffer) {
+        if (y_lcu_index)
+            measure_and_restore_sb_row(pass, y_lcu_index - 1);
+        if (y_lcu_index == pass->picture_height_in_sb - 1)
+            measure_and_restore_sb_row(pass, y_lcu_index);
+    }
+}
 
-            return residualDistortion;
-        }
+uint64_t eb_av1_loop_filter_frame_rows(
+    EbPictureBufferDesc *frame_buffer,
+    EbPictureBufferDesc *temp_lf_recon_buffer,
+    PictureControlSet *picture_control_set_ptr,
+    int32_t plane_start, int32_t plane_end) {
+    SequenceControlSet *scs_ptr = (SequenceControlSet*)picture_control_set_ptr->parent_pcs_ptr->sequence_control_set_wrapper_ptr->object_ptr;
+    LoopFilterRowPass pass;
+
+    assert(!temp_lf_recon_buffer || plane_end == plane_start + 1);
+    pass.frame_buffer = frame_buffer;
+    pass.temp_lf_recon_buffer = temp_lf_recon_buffer;
+    pass.pcs_ptr = picture_control_set_ptr;
+    pass.plane_start = plane_start;
+    pass.plane_end = plane_end;
+    pass.sb_size_log2 = (uint32_t)Log2f(scs_ptr->sb_size_pix);
+    pass.picture_width_in_sb = (scs_ptr->seq_header.max_frame_width + scs_ptr->sb_size_pix - 1) / scs_ptr->sb_size_pix;
+    pass.picture_height_in_sb = (scs_ptr->seq_header.max_frame_height + scs_ptr->sb_size_pix - 1) / scs_ptr->sb_size_pix;
+    pass.sse = 0;
 
-        return 0;
-    }
+    eb_av1_loop_filter_frame_init(picture_control_set_ptr, plane_start, plane_end);
+    row_segments_run(
+        picture_control_set_ptr->dlf_row_segments,
+        loop_filter_sb_row,
+        &pass,
+        pass.picture_height_in_sb);
+    return pass.sse;
 }
 
 static int64_t try_filter_frame(
@@ -1625,12 +1630,8 @@ static int64_t try_filter_frame(
     case 2: frm_hdr->loop_filter_params.filter_level_v = filter_level[0]; break;
     }
 
-    eb_av1_loop_filter_frame(recon_buffer, pcs_ptr, plane, plane + 1);
-
-    filt_err = PictureSseCalculations(pcs_ptr, recon_buffer, plane);
-
-    // Re-instate the unfiltered frame
-    EbCopyBuffer(tempLfReconBuffer/*cpi->last_frame_uf*/, recon_buffer /*cm->frame_to_show*/, pcs_ptr, (uint8_t)plane);
+    // Filter, measure and re-instate the unfiltered frame
+    filt_err = (int64_t)eb_av1_loop_filter_frame_rows(recon_buffer, tempLfReconBuffer, pcs_ptr, plane, plane + 1);
 
     return filt_err;
 }
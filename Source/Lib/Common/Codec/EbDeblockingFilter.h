@@ -105,6 +105,15 @@ extern "C" {
         /*MacroBlockD *xd,*/ int32_t plane_start, int32_t plane_end/*,
         int32_t partial_frame*/);
 
+    // Filters the frame in SB rows shared by the DLF threads of the picture
+    // session. With temp_lf_recon_buffer, filters one plane, restores it from
+    // temp_lf_recon_buffer and returns the SSE of the filtered plane
+    uint64_t eb_av1_loop_filter_frame_rows(
+        EbPictureBufferDesc *frame_buffer,
+        EbPictureBufferDesc *temp_lf_recon_buffer,
+        PictureControlSet *pcs_ptr,
+        int32_t plane_start, int32_t plane_end);
+
     void eb_av1_pick_filter_level(
         DlfContext            *context_ptr,
         EbPictureBufferDesc   *srcBuffer, // source input
@@ -22,6 +22,8 @@
 #include "EbReferenceObject.h"
 
 #include "EbDeblockingFilter.h"
+#include "EbRestProcess.h"
+#include "EbTrace.h"
 
 void eb_av1_loop_restoration_save_boundary_lines(const Yv12BufferConfig *frame, Av1Common *cm, int32_t after_cdef);
 
@@ -37,6 +39,7 @@ static void dlf_context_dctor(EbPtr p)
 EbErrorType dlf_context_ctor(
     DlfContext            *context_ptr,
     EbFifo                *dlf_input_fifo_ptr,
+    EbFifo                *dlf_help_fifo_ptr,
     EbFifo                *dlf_output_fifo_ptr ,
     EbBool                  is16bit,
     EbColorFormat           color_format,
@@ -49,6 +52,7 @@ EbErrorType dlf_context_ctor(
 
     // Input/Output System Resource Manager FIFOs
     context_ptr->dlf_input_fifo_ptr = dlf_input_fifo_ptr;
+    context_ptr->dlf_help_fifo_ptr = dlf_help_fifo_ptr;
     context_ptr->dlf_output_fifo_ptr = dlf_output_fifo_ptr;
 
     context_ptr->temp_lf_recon_picture16bit_ptr = (EbPictureBufferDesc *)EB_NULL;
@@ -85,9 +89,40 @@ EbErrorType dlf_context_ctor(
 }
 
 /******************************************************
- * Dlf Kernel
+ * Post Dlf Help Tasks
+ *   Asks the other DLF threads to join the row segments
+ *   of the picture. Each task holds the picture until the
+ *   thread taking it is done with it.
  ******************************************************/
-void* dlf_kernel(void *input_ptr)
+static void post_dlf_help_tasks(
+    DlfContext         *context_ptr,
+    SequenceControlSet *sequence_control_set_ptr,
+    EbObjectWrapper    *picture_control_set_wrapper_ptr)
+{
+    EbObjectWrapper *help_wrapper_ptr;
+    EncDecResults   *help_ptr;
+    uint32_t picture_height_in_sb = (sequence_control_set_ptr->seq_header.max_frame_height + sequence_control_set_ptr->sb_size_pix - 1) / sequence_control_set_ptr->sb_size_pix;
+    uint32_t help_count = MIN(sequence_control_set_ptr->dlf_process_init_count, picture_height_in_sb) - 1;
+    uint32_t help_index;
+
+    if (help_count == 0)
+        return;
+    eb_object_inc_live_count(picture_control_set_wrapper_ptr, help_count);
+    for (help_index = 0; help_index < help_count; ++help_index) {
+        eb_get_empty_object(
+            context_ptr->dlf_help_fifo_ptr,
+            &help_wrapper_ptr);
+        help_ptr = (EncDecResults*)help_wrapper_ptr->object_ptr;
+        help_ptr->picture_control_set_wrapper_ptr = picture_control_set_wrapper_ptr;
+        help_ptr->task_type = FILTER_TASK_HELP;
+        eb_post_full_object(help_wrapper_ptr);
+    }
+}
+
+/******************************************************
+ * Dlf Task
+ ******************************************************/
+void dlf_task(void *input_ptr, EbObjectWrapper *enc_dec_results_wrapper_ptr)
 {
     // Context & SCS & PCS
     DlfContext                            *context_ptr = (DlfContext*)input_ptr;
@@ -95,7 +130,6 @@ void* dlf_kernel(void *input_ptr)
     SequenceControlSet                    *sequence_control_set_ptr;
 
     //// Input
-    EbObjectWrapper                       *enc_dec_results_wrapper_ptr;
     EncDecResults                         *enc_dec_results_ptr;
 
     //// Output
@@ -103,60 +137,76 @@ void* dlf_kernel(void *input_ptr)
     struct DlfResults*                     dlf_results_ptr;
 
     // SB Loop variables
-    for (;;) {
-        // Get EncDec Results
-        eb_get_full_object(
-            context_ptr->dlf_input_fifo_ptr,
-            &enc_dec_results_wrapper_ptr);
 
-        enc_dec_results_ptr         = (EncDecResults*)enc_dec_results_wrapper_ptr->object_ptr;
-        picture_control_set_ptr     = (PictureControlSet*)enc_dec_results_ptr->picture_control_set_wrapper_ptr->object_ptr;
-        sequence_control_set_ptr    = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
+    enc_dec_results_ptr         = (EncDecResults*)enc_dec_results_wrapper_ptr->object_ptr;
+    picture_control_set_ptr     = (PictureControlSet*)enc_dec_results_ptr->picture_control_set_wrapper_ptr->object_ptr;
+    eb_trace_set_object(picture_control_set_ptr->picture_number, EB_TRACE_NO_SEGMENT);
+    sequence_control_set_ptr    = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
 
-        EbBool is16bit       = (EbBool)(sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
+    if (enc_dec_results_ptr->task_type == FILTER_TASK_HELP) {
+        row_segments_help(picture_control_set_ptr->dlf_row_segments);
+        eb_release_object(enc_dec_results_ptr->picture_control_set_wrapper_ptr);
+        eb_release_object(enc_dec_results_wrapper_ptr);
+        return;
+    }
 
-        EbBool dlfEnableFlag = (EbBool) picture_control_set_ptr->parent_pcs_ptr->loop_filter_mode;
-        if (dlfEnableFlag && picture_control_set_ptr->parent_pcs_ptr->loop_filter_mode >= 2) {
-            EbPictureBufferDesc  *recon_buffer = is16bit ? picture_control_set_ptr->recon_picture16bit_ptr : picture_control_set_ptr->recon_picture_ptr;
+    EbBool is16bit       = (EbBool)(sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
 
-            if (picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag == EB_TRUE)
-                //get the 16bit form of the input LCU
-                if (is16bit)
-                    recon_buffer = ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->reference_picture16bit;
-                else
-                    recon_buffer = ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->reference_picture;
-            else  // non ref pictures
-                recon_buffer = is16bit ? picture_control_set_ptr->recon_picture16bit_ptr : picture_control_set_ptr->recon_picture_ptr;
-
-            eb_av1_loop_filter_init(picture_control_set_ptr);
-
-            if (picture_control_set_ptr->parent_pcs_ptr->loop_filter_mode == 2) {
-                eb_av1_pick_filter_level(
-                    context_ptr,
-                    (EbPictureBufferDesc*)picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr,
-                    picture_control_set_ptr,
-                    LPF_PICK_FROM_Q);
-            }
+    EbBool dlfEnableFlag = (EbBool) picture_control_set_ptr->parent_pcs_ptr->loop_filter_mode;
+    if (dlfEnableFlag && picture_control_set_ptr->parent_pcs_ptr->loop_filter_mode >= 2) {
+        EbPictureBufferDesc  *recon_buffer = is16bit ? picture_control_set_ptr->recon_picture16bit_ptr : picture_control_set_ptr->recon_picture_ptr;
+
+        if (picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag == EB_TRUE)
+            //get the 16bit form of the input LCU
+            if (is16bit)
+                recon_buffer = ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->reference_picture16bit;
+            else
+                recon_buffer = ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->reference_picture;
+        else  // non ref pictures
+            recon_buffer = is16bit ? picture_control_set_ptr->recon_picture16bit_ptr : picture_control_set_ptr->recon_picture_ptr;
+
+        eb_av1_loop_filter_init(picture_control_set_ptr);
 
+        // The level search and the filtering run in SB rows shared with the other DLF threads
+        row_segments_open(picture_control_set_ptr->dlf_row_segments);
+        post_dlf_help_tasks(
+            context_ptr,
+            sequence_control_set_ptr,
+            enc_dec_results_ptr->picture_control_set_wrapper_ptr);
+
+        if (picture_control_set_ptr->parent_pcs_ptr->loop_filter_mode == 2) {
             eb_av1_pick_filter_level(
                 context_ptr,
                 (EbPictureBufferDesc*)picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr,
                 picture_control_set_ptr,
-                LPF_PICK_FROM_FULL_IMAGE);
+                LPF_PICK_FROM_Q);
+        }
+
+        eb_av1_pick_filter_level(
+            context_ptr,
+            (EbPictureBufferDesc*)picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr,
+            picture_control_set_ptr,
+            LPF_PICK_FROM_FULL_IMAGE);
 
 #if NO_ENCDEC
-            //NO DLF
-            picture_control_set_ptr->parent_pcs_ptr->lf.filter_level[0] = 0;
-            picture_control_set_ptr->parent_pcs_ptr->lf.filter_level[1] = 0;
-            picture_control_set_ptr->parent_pcs_ptr->lf.filter_level_u = 0;
-            picture_control_set_ptr->parent_pcs_ptr->lf.filter_level_v = 0;
+        //NO DLF
+        picture_control_set_ptr->parent_pcs_ptr->lf.filter_level[0] = 0;
+        picture_control_set_ptr->parent_pcs_ptr->lf.filter_level[1] = 0;
+        picture_control_set_ptr->parent_pcs_ptr->lf.filter_level_u = 0;
+        picture_control_set_ptr->parent_pcs_ptr->lf.filter_level_v = 0;
 #endif
-                eb_av1_loop_filter_frame(
-                    recon_buffer,
-                    picture_control_set_ptr,
-                    0,
-                    3);
-            }
+        // Only the levels are signaled when nothing reads the deblocked frame
+        if ((sequence_control_set_ptr->seq_header.enable_cdef && picture_control_set_ptr->parent_pcs_ptr->cdef_filter_mode) ||
+            sequence_control_set_ptr->seq_header.enable_restoration ||
+            filtered_recon_needed(sequence_control_set_ptr, picture_control_set_ptr))
+            eb_av1_loop_filter_frame_rows(
+                recon_buffer,
+                NULL,
+                picture_control_set_ptr,
+                0,
+                3);
+        row_segments_close(picture_control_set_ptr->dlf_row_segments);
+        }
 
         //pre-cdef prep
         {
@@ -179,8 +229,6 @@ void* dlf_kernel(void *input_ptr)
                 recon_picture_ptr,
                 cm->frame_to_show);
 
-            if (sequence_control_set_ptr->seq_header.enable_restoration)
-                eb_av1_loop_restoration_save_boundary_lines(cm->frame_to_show, cm, 0);
             if (sequence_control_set_ptr->seq_header.enable_cdef && picture_control_set_ptr->parent_pcs_ptr->cdef_filter_mode)
             {
                 if (is16bit)
@@ -232,13 +280,30 @@ void* dlf_kernel(void *input_ptr)
             dlf_results_ptr = (struct DlfResults*)dlf_results_wrapper_ptr->object_ptr;
             dlf_results_ptr->picture_control_set_wrapper_ptr = enc_dec_results_ptr->picture_control_set_wrapper_ptr;
             dlf_results_ptr->segment_index = segment_index;
+            dlf_results_ptr->task_type = FILTER_TASK_PROCESS;
             // Post DLF Results
             eb_post_full_object(dlf_results_wrapper_ptr);
         }
 
-            // Release EncDec Results
-            eb_release_object(enc_dec_results_wrapper_ptr);
-        }
+    // Release EncDec Results
+    eb_release_object(enc_dec_results_wrapper_ptr);
+}
 
+/******************************************************
+ * Dlf Kernel
+ ******************************************************/
+void* dlf_kernel(void *input_ptr)
+{
+    DlfContext                            *context_ptr = (DlfContext*)input_ptr;
+    EbObjectWrapper                       *enc_dec_results_wrapper_ptr;
+
+    for (;;) {
+        // Get EncDec Results
+        eb_get_full_object(
+            context_ptr->dlf_input_fifo_ptr,
+            &enc_dec_results_wrapper_ptr);
+
+        dlf_task(input_ptr, enc_dec_results_wrapper_ptr);
+    }
     return EB_NULL;
 }
@@ -22,6 +22,7 @@ typedef struct DlfContext
 {
     EbDctor              dctor;
     EbFifo              *dlf_input_fifo_ptr;
+    EbFifo              *dlf_help_fifo_ptr;
     EbFifo              *dlf_output_fifo_ptr;
     EbPictureBufferDesc *temp_lf_recon_picture_ptr;
     EbPictureBufferDesc *temp_lf_recon_picture16bit_ptr;
@@ -33,6 +34,7 @@ typedef struct DlfContext
 extern EbErrorType dlf_context_ctor(
     DlfContext                   *context_ptr,
     EbFifo                       *dlf_input_fifo_ptr,
+    EbFifo                       *dlf_help_fifo_ptr,
     EbFifo                       *dlf_output_fifo_ptr,
     EbBool                  is16bit,
     EbColorFormat           color_format,
@@ -41,5 +43,6 @@ extern EbErrorType dlf_context_ctor(
    );
 
 extern void* dlf_kernel(void *input_ptr);
+extern void dlf_task(void *input_ptr, EbObjectWrapper *input_wrapper_ptr);
 
 #endif // EbEntropyCodingProcess_h
@@ -23,6 +23,8 @@
 #include "EbSvtAv1ErrorCodes.h"
 #include "EbUtility.h"
 #include "grainSynthesis.h"
+#include "EbTrace.h"
+#include "EbTaskScheduler.h"
 
 void eb_av1_cdef_search(
     EncDecContext                *context_ptr,
@@ -53,7 +55,7 @@ void eb_av1_add_film_grain(EbPictureBufferDesc *src,
 
 void eb_av1_loop_restoration_save_boundary_lines(const Yv12BufferConfig *frame, Av1Common *cm, int32_t after_cdef);
 void eb_av1_pick_filter_restoration(const Yv12BufferConfig *src, Yv12BufferConfig * trial_frame_rst /*Av1Comp *cpi*/, Macroblock *x, Av1Common *const cm);
-void eb_av1_loop_restoration_filter_frame(Yv12BufferConfig *frame, Av1Common *cm, int32_t optimized_lr);
+void eb_av1_loop_restoration_filter_frame(Yv12BufferConfig *frame, Av1Common *cm, int32_t optimized_lr, RowSegments *segments_ptr);
 
 const int16_t encMinDeltaQpWeightTab[MAX_TEMPORAL_LAYERS] = { 100, 100, 100, 100, 100, 100 };
 const int16_t encMaxDeltaQpWeightTab[MAX_TEMPORAL_LAYERS] = { 100, 100, 100, 100, 100, 100 };
@@ -415,6 +417,7 @@ EbBool AssignEncDecSegments(
     int16_t feedbackRowIndex = -1;
 
     uint32_t selfAssigned = EB_FALSE;
+    const uint64_t traceStartTime = eb_trace_span_begin();
 
     //static FILE *trace = 0;
     //
@@ -528,6 +531,12 @@ EbBool AssignEncDecSegments(
         break;
     }
 
+    eb_trace_span_end(
+        "assign_enc_dec_segments",
+        traceStartTime,
+        ((PictureControlSet*)taskPtr->picture_control_set_wrapper_ptr->object_ptr)->picture_number,
+        continueProcessingFlag ? (int32_t)*segmentInOutIndex : EB_TRACE_NO_SEGMENT);
+
     return continueProcessingFlag;
 }
 void ReconOutput(
@@ -682,350 +691,421 @@ void ReconOutput(
     eb_release_mutex(encode_context_ptr->total_number_of_recon_frame_mutex);
 }
 
-void psnr_calculations(
-    PictureControlSet    *picture_control_set_ptr,
-    SequenceControlSet   *sequence_control_set_ptr){
-    EbBool is16bit = (sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
-
-    if (!is16bit) {
-        EbPictureBufferDesc *recon_ptr;
-
-        if (picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag == EB_TRUE)
-            recon_ptr = ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->reference_picture;
-        else
-            recon_ptr = picture_control_set_ptr->recon_picture_ptr;
-
-        EbPictureBufferDesc *input_picture_ptr = (EbPictureBufferDesc*)picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr;
-
-        uint64_t sseTotal[3] = { 0 };
-        uint32_t   columnIndex;
-        uint32_t   row_index = 0;
-        uint64_t   residualDistortion = 0;
-        EbByte  inputBuffer;
-        EbByte  reconCoeffBuffer;
-
-        EbByte buffer_y;
-        EbByte buffer_cb;
-        EbByte buffer_cr;
-
-        // if current source picture was temporally filtered, use an alternative buffer which stores
-        // the original source picture
-        if(picture_control_set_ptr->parent_pcs_ptr->temporal_filtering_on == EB_TRUE){
-            buffer_y = picture_control_set_ptr->parent_pcs_ptr->save_enhanced_picture_ptr[0];
-            buffer_cb = picture_control_set_ptr->parent_pcs_ptr->save_enhanced_picture_ptr[1];
-            buffer_cr = picture_control_set_ptr->parent_pcs_ptr->save_enhanced_picture_ptr[2];
-        }
-        else {
-            buffer_y = input_picture_ptr->buffer_y;
-            buffer_cb = input_picture_ptr->buffer_cb;
-            buffer_cr = input_picture_ptr->buffer_cr;
+/**************************************
+ * Psnr Pass
+ *   The SSE is computed in bands of 64 luma rows shared by the Rest
+ *   threads and summed per plane
+ **************************************/
+typedef struct PsnrPass {
+    PictureControlSet    *picture_control_set_ptr;
+    SequenceControlSet   *sequence_control_set_ptr;
+    EbPictureBufferDesc  *recon_ptr;
+    EbPictureBufferDesc  *input_picture_ptr;
+    EbByte                buffer_y;
+    EbByte                buffer_cb;
+    EbByte                buffer_cr;
+    uint64_t              sse_total[3];
+} PsnrPass;
+
+static uint64_t sse_8bit(
+    EbByte   inputBuffer,
+    uint32_t input_stride,
+    EbByte   reconCoeffBuffer,
+    uint32_t recon_stride,
+    uint32_t width,
+    uint32_t height)
+{
+    uint64_t residualDistortion = 0;
+    uint32_t columnIndex;
+    uint32_t row_index = 0;
+
+    while (row_index < height) {
+        columnIndex = 0;
+        while (columnIndex < width) {
+            residualDistortion += (int64_t)SQR((int64_t)(inputBuffer[columnIndex]) - (reconCoeffBuffer[columnIndex]));
+            ++columnIndex;
         }
 
-        reconCoeffBuffer = &((recon_ptr->buffer_y)[recon_ptr->origin_x + recon_ptr->origin_y * recon_ptr->stride_y]);
-        inputBuffer = &(buffer_y[input_picture_ptr->origin_x + input_picture_ptr->origin_y * input_picture_ptr->stride_y]);
+        inputBuffer += input_stride;
+        reconCoeffBuffer += recon_stride;
+        ++row_index;
+    }
+    return residualDistortion;
+}
 
-        residualDistortion = 0;
+static uint64_t sse_16bit(
+    EbByte    inputBuffer,
+    uint32_t  input_stride,
+    EbByte    inputBufferBitInc,
+    uint32_t  bit_inc_stride,
+    uint16_t *reconCoeffBuffer,
+    uint32_t  recon_stride,
+    uint32_t  width,
+    uint32_t  height)
+{
+    uint64_t residualDistortion = 0;
+    uint32_t columnIndex;
+    uint32_t row_index = 0;
+
+    while (row_index < height) {
+        columnIndex = 0;
+        while (columnIndex < width) {
+            residualDistortion += (int64_t)SQR((int64_t)((((inputBuffer[columnIndex]) << 2) | ((inputBufferBitInc[columnIndex] >> 6) & 3))) - (reconCoeffBuffer[columnIndex]));
+            ++columnIndex;
+        }
 
-        while (row_index < sequence_control_set_ptr->seq_header.max_frame_height) {
-            columnIndex = 0;
-            while (columnIndex < sequence_control_set_ptr->seq_header.max_frame_width) {
-                residualDistortion += (int64_t)SQR((int64_t)(inputBuffer[columnIndex]) - (reconCoeffBuffer[columnIndex]));
-                ++columnIndex;
-            }
+        inputBuffer += input_stride;
+        inputBufferBitInc += bit_inc_stride;
+        reconCoeffBuffer += recon_stride;
+        ++row_index;
+    }
+    return residualDistortion;
+}
 
-            inputBuffer += input_picture_ptr->stride_y;
-            reconCoeffBuffer += recon_ptr->stride_y;
-            ++row_index;
+// Input with the 2 lsbs of 4 samples packed in a byte, per 64x64 block
+static uint64_t sse_10bit_packed(
+    EbByte    inputBuffer,
+    uint32_t  input_stride,
+    EbByte    inputBufferBitInc,
+    uint16_t *reconCoeffBuffer,
+    uint32_t  recon_stride,
+    uint32_t  sb_width,
+    uint32_t  sb_height)
+{
+    uint64_t   residualDistortion = 0;
+    uint64_t   j, k;
+    uint16_t   outPixel;
+    uint8_t    nBitPixel;
+    uint8_t    four2bitPels;
+    uint32_t   inn_stride = sb_width / 4;
+
+    for (j = 0; j < sb_height; j++)
+    {
+        for (k = 0; k < sb_width / 4; k++)
+        {
+            four2bitPels = inputBufferBitInc[k + j * inn_stride];
+
+            nBitPixel = (four2bitPels >> 6) & 3;
+            outPixel = inputBuffer[k * 4 + 0 + j * input_stride] << 2;
+            outPixel = outPixel | nBitPixel;
+            residualDistortion += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 0 + j * recon_stride]);
+
+            nBitPixel = (four2bitPels >> 4) & 3;
+            outPixel = inputBuffer[k * 4 + 1 + j * input_stride] << 2;
+            outPixel = outPixel | nBitPixel;
+            residualDistortion += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 1 + j * recon_stride]);
+
+            nBitPixel = (four2bitPels >> 2) & 3;
+            outPixel = inputBuffer[k * 4 + 2 + j * input_stride] << 2;
+            outPixel = outPixel | nBitPixel;
+            residualDistortion += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 2 + j * recon_stride]);
+
+            nBitPixel = (four2bitPels >> 0) & 3;
+            outPixel = inputBuffer[k * 4 + 3 + j * input_stride] << 2;
+            outPixel = outPixel | nBitPixel;
+            residualDistortion += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 3 + j * recon_stride]);
         }
+    }
+    return residualDistortion;
+}
 
-        sseTotal[0] = residualDistortion;
+static void psnr_band(void *pass_ptr, uint32_t worker_index, uint32_t band_index)
+{
+    PsnrPass *pass = (PsnrPass*)pass_ptr;
+    SequenceControlSet *sequence_control_set_ptr = pass->sequence_control_set_ptr;
+    EbPictureBufferDesc *recon_ptr = pass->recon_ptr;
+    EbPictureBufferDesc *input_picture_ptr = pass->input_picture_ptr;
+    EbBool is16bit = (sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
+    const uint32_t luma_height = sequence_control_set_ptr->seq_header.max_frame_height;
+    const uint32_t chroma_height = sequence_control_set_ptr->chroma_height;
+    const uint32_t luma_row = band_index * 64;
+    const uint32_t chroma_row = band_index * 32;
+    const uint32_t luma_band_height = MIN(64, luma_height - luma_row);
+    const uint32_t chroma_band_height = chroma_row < chroma_height ? MIN(32, chroma_height - chroma_row) : 0;
+    uint64_t sse[3] = { 0 };
+    (void)worker_index;
 
-        reconCoeffBuffer = &((recon_ptr->buffer_cb)[recon_ptr->origin_x / 2 + recon_ptr->origin_y / 2 * recon_ptr->stride_cb]);
-        inputBuffer = &(buffer_cb[input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_cb]);
+    if (!is16bit) {
+        sse[0] = sse_8bit(
+            &(pass->buffer_y[input_picture_ptr->origin_x + (input_picture_ptr->origin_y + luma_row) * input_picture_ptr->stride_y]),
+            input_picture_ptr->stride_y,
+            &((recon_ptr->buffer_y)[recon_ptr->origin_x + (recon_ptr->origin_y + luma_row) * recon_ptr->stride_y]),
+            recon_ptr->stride_y,
+            sequence_control_set_ptr->seq_header.max_frame_width,
+            luma_band_height);
+        sse[1] = sse_8bit(
+            &(pass->buffer_cb[input_picture_ptr->origin_x / 2 + (input_picture_ptr->origin_y / 2 + chroma_row) * input_picture_ptr->stride_cb]),
+            input_picture_ptr->stride_cb,
+            &((recon_ptr->buffer_cb)[recon_ptr->origin_x / 2 + (recon_ptr->origin_y / 2 + chroma_row) * recon_ptr->stride_cb]),
+            recon_ptr->stride_cb,
+            sequence_control_set_ptr->chroma_width,
+            chroma_band_height);
+        sse[2] = sse_8bit(
+            &(pass->buffer_cr[input_picture_ptr->origin_x / 2 + (input_picture_ptr->origin_y / 2 + chroma_row) * input_picture_ptr->stride_cr]),
+            input_picture_ptr->stride_cr,
+            &((recon_ptr->buffer_cr)[recon_ptr->origin_x / 2 + (recon_ptr->origin_y / 2 + chroma_row) * recon_ptr->stride_cr]),
+            recon_ptr->stride_cr,
+            sequence_control_set_ptr->chroma_width,
+            chroma_band_height);
+    }
+    else if (sequence_control_set_ptr->static_config.ten_bit_format == 1) {
+        const uint32_t luma_width = sequence_control_set_ptr->seq_header.max_frame_width;
+        const uint32_t chroma_width = sequence_control_set_ptr->chroma_width;
+        const uint32_t picture_width_in_sb = (luma_width + 64 - 1) / 64;
+        const uint32_t luma2BitWidth = luma_width / 4;
+        const uint32_t chroma2BitWidth = luma_width / 8;
+        const uint32_t packed_chroma_height = luma_height / 2;
+        uint32_t lcuNumberInWidth;
+
+        EbByte  inputBufferOrg = &((input_picture_ptr->buffer_y)[input_picture_ptr->origin_x + input_picture_ptr->origin_y * input_picture_ptr->stride_y]);
+        uint16_t*  reconBufferOrg = (uint16_t*)(&((recon_ptr->buffer_y)[(recon_ptr->origin_x << is16bit) + (recon_ptr->origin_y << is16bit) * recon_ptr->stride_y]));
+        EbByte  inputBufferOrgU = &((input_picture_ptr->buffer_cb)[input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_cb]);
+        uint16_t*  reconBufferOrgU = (uint16_t*)(&((recon_ptr->buffer_cb)[(recon_ptr->origin_x << is16bit) / 2 + (recon_ptr->origin_y << is16bit) / 2 * recon_ptr->stride_cb]));
+        EbByte  inputBufferOrgV = &((input_picture_ptr->buffer_cr)[input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_cr]);
+        uint16_t*  reconBufferOrgV = (uint16_t*)(&((recon_ptr->buffer_cr)[(recon_ptr->origin_x << is16bit) / 2 + (recon_ptr->origin_y << is16bit) / 2 * recon_ptr->stride_cr]));
+
+        for (lcuNumberInWidth = 0; lcuNumberInWidth < picture_width_in_sb; ++lcuNumberInWidth)
+        {
+            uint32_t tbOriginX = lcuNumberInWidth * 64;
+            uint32_t tbOriginY = luma_row;
+            uint32_t sb_width = (luma_width - tbOriginX) < 64 ? (luma_width - tbOriginX) : 64;
+            uint32_t sb_height = luma_band_height;
+
+            sse[0] += sse_10bit_packed(
+                inputBufferOrg + tbOriginY * input_picture_ptr->stride_y + tbOriginX,
+                input_picture_ptr->stride_y,
+                input_picture_ptr->buffer_bit_inc_y + tbOriginY * luma2BitWidth + (tbOriginX / 4)*sb_height,
+                reconBufferOrg + tbOriginY * recon_ptr->stride_y + tbOriginX,
+                recon_ptr->stride_y,
+                sb_width,
+                sb_height);
 
-        residualDistortion = 0;
-        row_index = 0;
-        while (row_index < sequence_control_set_ptr->chroma_height) {
-            columnIndex = 0;
-            while (columnIndex < sequence_control_set_ptr->chroma_width) {
-                residualDistortion += (int64_t)SQR((int64_t)(inputBuffer[columnIndex]) - (reconCoeffBuffer[columnIndex]));
-                ++columnIndex;
-            }
+            //U+V
 
-            inputBuffer += input_picture_ptr->stride_cb;
-            reconCoeffBuffer += recon_ptr->stride_cb;
-            ++row_index;
-        }
+            tbOriginX = lcuNumberInWidth * 32;
+            tbOriginY = chroma_row;
+            sb_width = (chroma_width - tbOriginX) < 32 ? (chroma_width - tbOriginX) : 32;
+            sb_height = (packed_chroma_height - tbOriginY) < 32 ? (packed_chroma_height - tbOriginY) : 32;
 
-        sseTotal[1] = residualDistortion;
+            sse[1] += sse_10bit_packed(
+                inputBufferOrgU + tbOriginY * input_picture_ptr->stride_cb + tbOriginX,
+                input_picture_ptr->stride_cb,
+                input_picture_ptr->buffer_bit_inc_cb + tbOriginY * chroma2BitWidth + (tbOriginX / 4)*sb_height,
+                reconBufferOrgU + tbOriginY * recon_ptr->stride_cb + tbOriginX,
+                recon_ptr->stride_cb,
+                sb_width,
+                sb_height);
+
+            sse[2] += sse_10bit_packed(
+                inputBufferOrgV + tbOriginY * input_picture_ptr->stride_cr + tbOriginX,
+                input_picture_ptr->stride_cr,
+                input_picture_ptr->buffer_bit_inc_cr + tbOriginY * chroma2BitWidth + (tbOriginX / 4)*sb_height,
+                reconBufferOrgV + tbOriginY * recon_ptr->stride_cr + tbOriginX,
+                recon_ptr->stride_cr,
+                sb_width,
+                sb_height);
+        }
+    }
+    else {
+        sse[0] = sse_16bit(
+            &((input_picture_ptr->buffer_y)[input_picture_ptr->origin_x + (input_picture_ptr->origin_y + luma_row) * input_picture_ptr->stride_y]),
+            input_picture_ptr->stride_y,
+            &((input_picture_ptr->buffer_bit_inc_y)[input_picture_ptr->origin_x + (input_picture_ptr->origin_y + luma_row) * input_picture_ptr->stride_bit_inc_y]),
+            input_picture_ptr->stride_bit_inc_y,
+            (uint16_t*)(&((recon_ptr->buffer_y)[(recon_ptr->origin_x << is16bit) + ((recon_ptr->origin_y + luma_row) << is16bit) * recon_ptr->stride_y])),
+            recon_ptr->stride_y,
+            sequence_control_set_ptr->seq_header.max_frame_width,
+            luma_band_height);
+        sse[1] = sse_16bit(
+            &((input_picture_ptr->buffer_cb)[input_picture_ptr->origin_x / 2 + (input_picture_ptr->origin_y / 2 + chroma_row) * input_picture_ptr->stride_cb]),
+            input_picture_ptr->stride_cb,
+            &((input_picture_ptr->buffer_bit_inc_cb)[input_picture_ptr->origin_x / 2 + (input_picture_ptr->origin_y / 2 + chroma_row) * input_picture_ptr->stride_bit_inc_cb]),
+            input_picture_ptr->stride_bit_inc_cb,
+            (uint16_t*)(&((recon_ptr->buffer_cb)[(recon_ptr->origin_x << is16bit) / 2 + (((recon_ptr->origin_y << is16bit) / 2) + (chroma_row << is16bit)) * recon_ptr->stride_cb])),
+            recon_ptr->stride_cb,
+            sequence_control_set_ptr->chroma_width,
+            chroma_band_height);
+        sse[2] = sse_16bit(
+            &((input_picture_ptr->buffer_cr)[input_picture_ptr->origin_x / 2 + (input_picture_ptr->origin_y / 2 + chroma_row) * input_picture_ptr->stride_cr]),
+            input_picture_ptr->stride_cr,
+            &((input_picture_ptr->buffer_bit_inc_cr)[input_picture_ptr->origin_x / 2 + (input_picture_ptr->origin_y / 2 + chroma_row) * input_picture_ptr->stride_bit_inc_cr]),
+            input_picture_ptr->stride_bit_inc_cr,
+            (uint16_t*)(&((recon_ptr->buffer_cr)[(recon_ptr->origin_x << is16bit) / 2 + (((recon_ptr->origin_y << is16bit) / 2) + (chroma_row << is16bit)) * recon_ptr->stride_cr])),
+            recon_ptr->stride_cr,
+            sequence_control_set_ptr->chroma_width,
+            chroma_band_height);
+    }
 
-        reconCoeffBuffer = &((recon_ptr->buffer_cr)[recon_ptr->origin_x / 2 + recon_ptr->origin_y / 2 * recon_ptr->stride_cr]);
-        inputBuffer = &(buffer_cr[input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_cr]);
-        residualDistortion = 0;
-        row_index = 0;
+    eb_atomic_add_u64(&pass->sse_total[0], sse[0]);
+    eb_atomic_add_u64(&pass->sse_total[1], sse[1]);
+    eb_atomic_add_u64(&pass->sse_total[2], sse[2]);
+}
 
-        while (row_index < sequence_control_set_ptr->chroma_height) {
-            columnIndex = 0;
-            while (columnIndex < sequence_control_set_ptr->chroma_width) {
-                residualDistortion += (int64_t)SQR((int64_t)(inputBuffer[columnIndex]) - (reconCoeffBuffer[columnIndex]));
-                ++columnIndex;
-            }
+void psnr_calculations(
+    PictureControlSet    *picture_control_set_ptr,
+    SequenceControlSet   *sequence_control_set_ptr){
+    EbBool is16bit = (sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
+    EbPictureBufferDesc *input_picture_ptr = (EbPictureBufferDesc*)picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr;
+    PsnrPass pass;
 
-            inputBuffer += input_picture_ptr->stride_cr;
-            reconCoeffBuffer += recon_ptr->stride_cr;
-            ++row_index;
-        }
+    pass.picture_control_set_ptr = picture_control_set_ptr;
+    pass.sequence_control_set_ptr = sequence_control_set_ptr;
+    pass.input_picture_ptr = input_picture_ptr;
+    pass.sse_total[0] = pass.sse_total[1] = pass.sse_total[2] = 0;
 
-        sseTotal[2] = residualDistortion;
-        picture_control_set_ptr->parent_pcs_ptr->luma_sse = (uint32_t)sseTotal[0];
-        picture_control_set_ptr->parent_pcs_ptr->cb_sse = (uint32_t)sseTotal[1];
-        picture_control_set_ptr->parent_pcs_ptr->cr_sse = (uint32_t)sseTotal[2];
+    if (!is16bit) {
+        if (picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag == EB_TRUE)
+            pass.recon_ptr = ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->reference_picture;
+        else
+            pass.recon_ptr = picture_control_set_ptr->recon_picture_ptr;
 
-        if(picture_control_set_ptr->parent_pcs_ptr->temporal_filtering_on == EB_TRUE) {
-            EB_FREE_ARRAY(buffer_y);
-            EB_FREE_ARRAY(buffer_cb);
-            EB_FREE_ARRAY(buffer_cr);
+        // if current source picture was temporally filtered, use an alternative buffer which stores
+        // the original source picture
+        if(picture_control_set_ptr->parent_pcs_ptr->temporal_filtering_on == EB_TRUE){
+            pass.buffer_y = picture_control_set_ptr->parent_pcs_ptr->save_enhanced_picture_ptr[0];
+            pass.buffer_cb = picture_control_set_ptr->parent_pcs_ptr->save_enhanced_picture_ptr[1];
+            pass.buffer_cr = picture_control_set_ptr->parent_pcs_ptr->save_enhanced_picture_ptr[2];
+        }
+        else {
+            pass.buffer_y = input_picture_ptr->buffer_y;
+            pass.buffer_cb = input_picture_ptr->buffer_cb;
+            pass.buffer_cr = input_picture_ptr->buffer_cr;
         }
     }
     else {
-        EbPictureBufferDesc *recon_ptr;
-
         if (picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag == EB_TRUE)
-            recon_ptr = ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->reference_picture16bit;
+            pass.recon_ptr = ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->reference_picture16bit;
         else
-            recon_ptr = picture_control_set_ptr->recon_picture16bit_ptr;
-        EbPictureBufferDesc *input_picture_ptr = (EbPictureBufferDesc*)picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr;
-
-        uint64_t sseTotal[3] = { 0 };
-        uint32_t   columnIndex;
-        uint32_t   row_index = 0;
-        uint64_t   residualDistortion = 0;
-        EbByte  inputBuffer;
-        EbByte  inputBufferBitInc;
-        uint16_t*  reconCoeffBuffer;
-
-        if (sequence_control_set_ptr->static_config.ten_bit_format == 1) {
-            const uint32_t luma_width = sequence_control_set_ptr->seq_header.max_frame_width;
-            const uint32_t luma_height = sequence_control_set_ptr->seq_header.max_frame_height;
-            const uint32_t chroma_width = sequence_control_set_ptr->chroma_width;
-            const uint32_t picture_width_in_sb = (luma_width + 64 - 1) / 64;
-            const uint32_t pictureHeighInLcu = (luma_height + 64 - 1) / 64;
-            const uint32_t luma2BitWidth = luma_width / 4;
-            const uint32_t chroma_height = luma_height / 2;
-            const uint32_t chroma2BitWidth = luma_width / 8;
-            uint32_t lcuNumberInHeight, lcuNumberInWidth;
-
-            EbByte  inputBufferOrg = &((input_picture_ptr->buffer_y)[input_picture_ptr->origin_x + input_picture_ptr->origin_y * input_picture_ptr->stride_y]);
-            uint16_t*  reconBufferOrg = (uint16_t*)(&((recon_ptr->buffer_y)[(recon_ptr->origin_x << is16bit) + (recon_ptr->origin_y << is16bit) * recon_ptr->stride_y]));;
-
-            EbByte  inputBufferOrgU = &((input_picture_ptr->buffer_cb)[input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_cb]);;
-            uint16_t*  reconBufferOrgU = reconCoeffBuffer = (uint16_t*)(&((recon_ptr->buffer_cb)[(recon_ptr->origin_x << is16bit) / 2 + (recon_ptr->origin_y << is16bit) / 2 * recon_ptr->stride_cb]));;
-
-            EbByte  inputBufferOrgV = &((input_picture_ptr->buffer_cr)[input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_cr]);;
-            uint16_t*  reconBufferOrgV = reconCoeffBuffer = (uint16_t*)(&((recon_ptr->buffer_cr)[(recon_ptr->origin_x << is16bit) / 2 + (recon_ptr->origin_y << is16bit) / 2 * recon_ptr->stride_cr]));;
-
-            residualDistortion = 0;
-            uint64_t residualDistortionU = 0;
-            uint64_t residualDistortionV = 0;
-
-            for (lcuNumberInHeight = 0; lcuNumberInHeight < pictureHeighInLcu; ++lcuNumberInHeight)
-            {
-                for (lcuNumberInWidth = 0; lcuNumberInWidth < picture_width_in_sb; ++lcuNumberInWidth)
-                {
-                    uint32_t tbOriginX = lcuNumberInWidth * 64;
-                    uint32_t tbOriginY = lcuNumberInHeight * 64;
-                    uint32_t sb_width = (luma_width - tbOriginX) < 64 ? (luma_width - tbOriginX) : 64;
-                    uint32_t sb_height = (luma_height - tbOriginY) < 64 ? (luma_height - tbOriginY) : 64;
-
-                    inputBuffer = inputBufferOrg + tbOriginY * input_picture_ptr->stride_y + tbOriginX;
-                    inputBufferBitInc = input_picture_ptr->buffer_bit_inc_y + tbOriginY * luma2BitWidth + (tbOriginX / 4)*sb_height;
-                    reconCoeffBuffer = reconBufferOrg + tbOriginY * recon_ptr->stride_y + tbOriginX;
-
-                    uint64_t   j, k;
-                    uint16_t   outPixel;
-                    uint8_t    nBitPixel;
-                    uint8_t   four2bitPels;
-                    uint32_t     inn_stride = sb_width / 4;
-
-                    for (j = 0; j < sb_height; j++)
-                    {
-                        for (k = 0; k < sb_width / 4; k++)
-                        {
-                            four2bitPels = inputBufferBitInc[k + j * inn_stride];
-
-                            nBitPixel = (four2bitPels >> 6) & 3;
-                            outPixel = inputBuffer[k * 4 + 0 + j * input_picture_ptr->stride_y] << 2;
-                            outPixel = outPixel | nBitPixel;
-                            residualDistortion += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 0 + j * recon_ptr->stride_y]);
-
-                            nBitPixel = (four2bitPels >> 4) & 3;
-                            outPixel = inputBuffer[k * 4 + 1 + j * input_picture_ptr->stride_y] << 2;
-                            outPixel = outPixel | nBitPixel;
-                            residualDistortion += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 1 + j * recon_ptr->stride_y]);
-
-                            nBitPixel = (four2bitPels >> 2) & 3;
-                            outPixel = inputBuffer[k * 4 + 2 + j * input_picture_ptr->stride_y] << 2;
-                            outPixel = outPixel | nBitPixel;
-                            residualDistortion += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 2 + j * recon_ptr->stride_y]);
-
-                            nBitPixel = (four2bitPels >> 0) & 3;
-                            outPixel = inputBuffer[k * 4 + 3 + j * input_picture_ptr->stride_y] << 2;
-                            outPixel = outPixel | nBitPixel;
-                            residualDistortion += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 3 + j * recon_ptr->stride_y]);
-                        }
-                    }
-
-                    //U+V
-
-                    tbOriginX = lcuNumberInWidth * 32;
-                    tbOriginY = lcuNumberInHeight * 32;
-                    sb_width = (chroma_width - tbOriginX) < 32 ? (chroma_width - tbOriginX) : 32;
-                    sb_height = (chroma_height - tbOriginY) < 32 ? (chroma_height - tbOriginY) : 32;
-
-                    inn_stride = sb_width / 4;
-
-                    inputBuffer = inputBufferOrgU + tbOriginY * input_picture_ptr->stride_cb + tbOriginX;
-
-                    inputBufferBitInc = input_picture_ptr->buffer_bit_inc_cb + tbOriginY * chroma2BitWidth + (tbOriginX / 4)*sb_height;
-
-                    reconCoeffBuffer = reconBufferOrgU + tbOriginY * recon_ptr->stride_cb + tbOriginX;
+            pass.recon_ptr = picture_control_set_ptr->recon_picture16bit_ptr;
+        pass.buffer_y = input_picture_ptr->buffer_y;
+        pass.buffer_cb = input_picture_ptr->buffer_cb;
+        pass.buffer_cr = input_picture_ptr->buffer_cr;
+    }
 
-                    for (j = 0; j < sb_height; j++)
-                    {
-                        for (k = 0; k < sb_width / 4; k++)
-                        {
-                            four2bitPels = inputBufferBitInc[k + j * inn_stride];
+    row_segments_run(
+        picture_control_set_ptr->rest_row_segments,
+        psnr_band,
+        &pass,
+        (sequence_control_set_ptr->seq_header.max_frame_height + 64 - 1) / 64);
 
-                            nBitPixel = (four2bitPels >> 6) & 3;
-                            outPixel = inputBuffer[k * 4 + 0 + j * input_picture_ptr->stride_cb] << 2;
-                            outPixel = outPixel | nBitPixel;
-                            residualDistortionU += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 0 + j * recon_ptr->stride_cb]);
+    picture_control_set_ptr->parent_pcs_ptr->luma_sse = (uint32_t)pass.sse_total[0];
+    picture_control_set_ptr->parent_pcs_ptr->cb_sse = (uint32_t)pass.sse_total[1];
+    picture_control_set_ptr->parent_pcs_ptr->cr_sse = (uint32_t)pass.sse_total[2];
 
-                            nBitPixel = (four2bitPels >> 4) & 3;
-                            outPixel = inputBuffer[k * 4 + 1 + j * input_picture_ptr->stride_cb] << 2;
-                            outPixel = outPixel | nBitPixel;
-                            residualDistortionU += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 1 + j * recon_ptr->stride_cb]);
+    if (!is16bit && picture_control_set_ptr->parent_pcs_ptr->temporal_filtering_on == EB_TRUE) {
+        EB_FREE_ARRAY(pass.buffer_y);
+        EB_FREE_ARRAY(pass.buffer_cb);
+        EB_FREE_ARRAY(pass.buffer_cr);
+    }
+}
 
-                            nBitPixel = (four2bitPels >> 2) & 3;
-                            outPixel = inputBuffer[k * 4 + 2 + j * input_picture_ptr->stride_cb] << 2;
-                            outPixel = outPixel | nBitPixel;
-                            residualDistortionU += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 2 + j * recon_ptr->stride_cb]);
+/**************************************
+ * Pad Ref Pass
+ *   The planes of the reference picture are padded by the Rest threads
+ **************************************/
+typedef struct PadRefPass {
+    SequenceControlSet   *sequence_control_set_ptr;
+    EbReferenceObject    *reference_object_ptr;
+} PadRefPass;
 
-                            nBitPixel = (four2bitPels >> 0) & 3;
-                            outPixel = inputBuffer[k * 4 + 3 + j * input_picture_ptr->stride_cb] << 2;
-                            outPixel = outPixel | nBitPixel;
-                            residualDistortionU += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 3 + j * recon_ptr->stride_cb]);
-                        }
-                    }
-
-                    inputBuffer = inputBufferOrgV + tbOriginY * input_picture_ptr->stride_cr + tbOriginX;
-                    inputBufferBitInc = input_picture_ptr->buffer_bit_inc_cr + tbOriginY * chroma2BitWidth + (tbOriginX / 4)*sb_height;
-                    reconCoeffBuffer = reconBufferOrgV + tbOriginY * recon_ptr->stride_cr + tbOriginX;
-
-                    for (j = 0; j < sb_height; j++)
-                    {
-                        for (k = 0; k < sb_width / 4; k++)
-                        {
-                            four2bitPels = inputBufferBitInc[k + j * inn_stride];
-
-                            nBitPixel = (four2bitPels >> 6) & 3;
-                            outPixel = inputBuffer[k * 4 + 0 + j * input_picture_ptr->stride_cr] << 2;
-                            outPixel = outPixel | nBitPixel;
-                            residualDistortionV += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 0 + j * recon_ptr->stride_cr]);
-
-                            nBitPixel = (four2bitPels >> 4) & 3;
-                            outPixel = inputBuffer[k * 4 + 1 + j * input_picture_ptr->stride_cr] << 2;
-                            outPixel = outPixel | nBitPixel;
-                            residualDistortionV += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 1 + j * recon_ptr->stride_cr]);
-
-                            nBitPixel = (four2bitPels >> 2) & 3;
-                            outPixel = inputBuffer[k * 4 + 2 + j * input_picture_ptr->stride_cr] << 2;
-                            outPixel = outPixel | nBitPixel;
-                            residualDistortionV += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 2 + j * recon_ptr->stride_cr]);
-
-                            nBitPixel = (four2bitPels >> 0) & 3;
-                            outPixel = inputBuffer[k * 4 + 3 + j * input_picture_ptr->stride_cr] << 2;
-                            outPixel = outPixel | nBitPixel;
-                            residualDistortionV += (int64_t)SQR((int64_t)outPixel - (int64_t)reconCoeffBuffer[k * 4 + 3 + j * recon_ptr->stride_cr]);
-                        }
-                    }
-                }
-            }
+static void pad_ref_plane(void *pass_ptr, uint32_t worker_index, uint32_t plane)
+{
+    PadRefPass          *pass = (PadRefPass*)pass_ptr;
+    SequenceControlSet  *sequence_control_set_ptr = pass->sequence_control_set_ptr;
+    EbPictureBufferDesc *refPicPtr = (EbPictureBufferDesc*)pass->reference_object_ptr->reference_picture;
+    EbPictureBufferDesc *refPic16BitPtr = (EbPictureBufferDesc*)pass->reference_object_ptr->reference_picture16bit;
+    EbBool                is16bit = (sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
+    (void)worker_index;
 
-            sseTotal[0] = residualDistortion;
-            sseTotal[1] = residualDistortionU;
-            sseTotal[2] = residualDistortionV;
+    if (!is16bit) {
+        if (plane == 0) {
+            // Y samples
+            generate_padding(
+                refPicPtr->buffer_y,
+                refPicPtr->stride_y,
+                refPicPtr->width,
+                refPicPtr->height,
+                refPicPtr->origin_x,
+                refPicPtr->origin_y);
         }
         else {
-            reconCoeffBuffer = (uint16_t*)(&((recon_ptr->buffer_y)[(recon_ptr->origin_x << is16bit) + (recon_ptr->origin_y << is16bit) * recon_ptr->stride_y]));
-            inputBuffer = &((input_picture_ptr->buffer_y)[input_picture_ptr->origin_x + input_picture_ptr->origin_y * input_picture_ptr->stride_y]);
-            inputBufferBitInc = &((input_picture_ptr->buffer_bit_inc_y)[input_picture_ptr->origin_x + input_picture_ptr->origin_y * input_picture_ptr->stride_bit_inc_y]);
-
-            residualDistortion = 0;
-
-            while (row_index < sequence_control_set_ptr->seq_header.max_frame_height) {
-                columnIndex = 0;
-                while (columnIndex < sequence_control_set_ptr->seq_header.max_frame_width) {
-                    residualDistortion += (int64_t)SQR((int64_t)((((inputBuffer[columnIndex]) << 2) | ((inputBufferBitInc[columnIndex] >> 6) & 3))) - (reconCoeffBuffer[columnIndex]));
-
-                    ++columnIndex;
-                }
-
-                inputBuffer += input_picture_ptr->stride_y;
-                inputBufferBitInc += input_picture_ptr->stride_bit_inc_y;
-                reconCoeffBuffer += recon_ptr->stride_y;
-                ++row_index;
-            }
-
-            sseTotal[0] = residualDistortion;
-
-            reconCoeffBuffer = (uint16_t*)(&((recon_ptr->buffer_cb)[(recon_ptr->origin_x << is16bit) / 2 + (recon_ptr->origin_y << is16bit) / 2 * recon_ptr->stride_cb]));
-            inputBuffer = &((input_picture_ptr->buffer_cb)[input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_cb]);
-            inputBufferBitInc = &((input_picture_ptr->buffer_bit_inc_cb)[input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_bit_inc_cb]);
-
-            residualDistortion = 0;
-            row_index = 0;
-            while (row_index < sequence_control_set_ptr->chroma_height) {
-                columnIndex = 0;
-                while (columnIndex < sequence_control_set_ptr->chroma_width) {
-                    residualDistortion += (int64_t)SQR((int64_t)((((inputBuffer[columnIndex]) << 2) | ((inputBufferBitInc[columnIndex] >> 6) & 3))) - (reconCoeffBuffer[columnIndex]));
-                    ++columnIndex;
-                }
-
-                inputBuffer += input_picture_ptr->stride_cb;
-                inputBufferBitInc += input_picture_ptr->stride_bit_inc_cb;
-                reconCoeffBuffer += recon_ptr->stride_cb;
-                ++row_index;
-            }
-
-            sseTotal[1] = residualDistortion;
-
-            reconCoeffBuffer = (uint16_t*)(&((recon_ptr->buffer_cr)[(recon_ptr->origin_x << is16bit) / 2 + (recon_ptr->origin_y << is16bit) / 2 * recon_ptr->stride_cr]));
-            inputBuffer = &((input_picture_ptr->buffer_cr)[input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_cr]);
-            inputBufferBitInc = &((input_picture_ptr->buffer_bit_inc_cr)[input_picture_ptr->origin_x / 2 + input_picture_ptr->origin_y / 2 * input_picture_ptr->stride_bit_inc_cr]);
-
-            residualDistortion = 0;
-            row_index = 0;
-
-            while (row_index < sequence_control_set_ptr->chroma_height) {
-                columnIndex = 0;
-                while (columnIndex < sequence_control_set_ptr->chroma_width) {
-                    residualDistortion += (int64_t)SQR((int64_t)((((inputBuffer[columnIndex]) << 2) | ((inputBufferBitInc[columnIndex] >> 6) & 3))) - (reconCoeffBuffer[columnIndex]));
-                    ++columnIndex;
-                }
-
-                inputBuffer += input_picture_ptr->stride_cr;
-                inputBufferBitInc += input_picture_ptr->stride_bit_inc_cr;
-                reconCoeffBuffer += recon_ptr->stride_cr;
-                ++row_index;
-            }
-
-            sseTotal[2] = residualDistortion;
+            // Cb / Cr samples
+            generate_padding(
+                plane == 1 ? refPicPtr->buffer_cb : refPicPtr->buffer_cr,
+                plane == 1 ? refPicPtr->stride_cb : refPicPtr->stride_cr,
+                refPicPtr->width >> 1,
+                refPicPtr->height >> 1,
+                refPicPtr->origin_x >> 1,
+                refPicPtr->origin_y >> 1);
         }
+    }
 
-        picture_control_set_ptr->parent_pcs_ptr->luma_sse = (uint32_t)sseTotal[0];
-        picture_control_set_ptr->parent_pcs_ptr->cb_sse = (uint32_t)sseTotal[1];
-        picture_control_set_ptr->parent_pcs_ptr->cr_sse = (uint32_t)sseTotal[2];
+    //We need this for MCP
+    if (is16bit) {
+        if (plane == 0) {
+            // Y samples
+            generate_padding16_bit(
+                refPic16BitPtr->buffer_y,
+                refPic16BitPtr->stride_y << 1,
+                refPic16BitPtr->width << 1,
+                refPic16BitPtr->height,
+                refPic16BitPtr->origin_x << 1,
+                refPic16BitPtr->origin_y);
+
+            // Hsan: unpack ref samples (to be used @ MD)
+            un_pack2d(
+                (uint16_t*) refPic16BitPtr->buffer_y,
+                refPic16BitPtr->stride_y,
+                refPicPtr->buffer_y,
+                refPicPtr->stride_y,
+                refPicPtr->buffer_bit_inc_y,
+                refPicPtr->stride_bit_inc_y,
+                refPic16BitPtr->width  + (refPicPtr->origin_x << 1),
+                refPic16BitPtr->height + (refPicPtr->origin_y << 1),
+                sequence_control_set_ptr->static_config.asm_type);
+        }
+        else if (plane == 1) {
+            // Cb samples
+            generate_padding16_bit(
+                refPic16BitPtr->buffer_cb,
+                refPic16BitPtr->stride_cb << 1,
+                refPic16BitPtr->width,
+                refPic16BitPtr->height >> 1,
+                refPic16BitPtr->origin_x,
+                refPic16BitPtr->origin_y >> 1);
+
+            un_pack2d(
+                (uint16_t*)refPic16BitPtr->buffer_cb,
+                refPic16BitPtr->stride_cb,
+                refPicPtr->buffer_cb,
+                refPicPtr->stride_cb,
+                refPicPtr->buffer_bit_inc_cb,
+                refPicPtr->stride_bit_inc_cb,
+                (refPic16BitPtr->width + (refPicPtr->origin_x << 1)) >> 1,
+                (refPic16BitPtr->height + (refPicPtr->origin_y << 1)) >> 1,
+                sequence_control_set_ptr->static_config.asm_type);
+        }
+        else {
+            // Cr samples
+            generate_padding16_bit(
+                refPic16BitPtr->buffer_cr,
+                refPic16BitPtr->stride_cr << 1,
+                refPic16BitPtr->width,
+                refPic16BitPtr->height >> 1,
+                refPic16BitPtr->origin_x,
+                refPic16BitPtr->origin_y >> 1);
+
+            un_pack2d(
+                (uint16_t*)refPic16BitPtr->buffer_cr,
+                refPic16BitPtr->stride_cr,
+                refPicPtr->buffer_cr,
+                refPicPtr->stride_cr,
+                refPicPtr->buffer_bit_inc_cr,
+                refPicPtr->stride_bit_inc_cr,
+                (refPic16BitPtr->width + (refPicPtr->origin_x << 1)) >> 1,
+                (refPic16BitPtr->height + (refPicPtr->origin_y << 1)) >> 1,
+                sequence_control_set_ptr->static_config.asm_type);
+        }
     }
 }
 
@@ -1035,102 +1115,16 @@ void PadRefAndSetFlags(
 )
 {
     EbReferenceObject   *referenceObject = (EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr;
-    EbPictureBufferDesc *refPicPtr = (EbPictureBufferDesc*)referenceObject->reference_picture;
-    EbPictureBufferDesc *refPic16BitPtr = (EbPictureBufferDesc*)referenceObject->reference_picture16bit;
-    EbBool                is16bit = (sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
+    PadRefPass           pass;
 
-    if (!is16bit) {
-        // Y samples
-        generate_padding(
-            refPicPtr->buffer_y,
-            refPicPtr->stride_y,
-            refPicPtr->width,
-            refPicPtr->height,
-            refPicPtr->origin_x,
-            refPicPtr->origin_y);
-
-        // Cb samples
-        generate_padding(
-            refPicPtr->buffer_cb,
-            refPicPtr->stride_cb,
-            refPicPtr->width >> 1,
-            refPicPtr->height >> 1,
-            refPicPtr->origin_x >> 1,
-            refPicPtr->origin_y >> 1);
-
-        // Cr samples
-        generate_padding(
-            refPicPtr->buffer_cr,
-            refPicPtr->stride_cr,
-            refPicPtr->width >> 1,
-            refPicPtr->height >> 1,
-            refPicPtr->origin_x >> 1,
-            refPicPtr->origin_y >> 1);
-    }
+    pass.sequence_control_set_ptr = sequence_control_set_ptr;
+    pass.reference_object_ptr = referenceObject;
+    row_segments_run(
+        picture_control_set_ptr->rest_row_segments,
+        pad_ref_plane,
+        &pass,
+        3);
 
-    //We need this for MCP
-    if (is16bit) {
-        // Y samples
-        generate_padding16_bit(
-            refPic16BitPtr->buffer_y,
-            refPic16BitPtr->stride_y << 1,
-            refPic16BitPtr->width << 1,
-            refPic16BitPtr->height,
-            refPic16BitPtr->origin_x << 1,
-            refPic16BitPtr->origin_y);
-
-        // Cb samples
-        generate_padding16_bit(
-            refPic16BitPtr->buffer_cb,
-            refPic16BitPtr->stride_cb << 1,
-            refPic16BitPtr->width,
-            refPic16BitPtr->height >> 1,
-            refPic16BitPtr->origin_x,
-            refPic16BitPtr->origin_y >> 1);
-
-        // Cr samples
-        generate_padding16_bit(
-            refPic16BitPtr->buffer_cr,
-            refPic16BitPtr->stride_cr << 1,
-            refPic16BitPtr->width,
-            refPic16BitPtr->height >> 1,
-            refPic16BitPtr->origin_x,
-            refPic16BitPtr->origin_y >> 1);
-
-        // Hsan: unpack ref samples (to be used @ MD)
-        un_pack2d(
-            (uint16_t*) refPic16BitPtr->buffer_y,
-            refPic16BitPtr->stride_y,
-            refPicPtr->buffer_y,
-            refPicPtr->stride_y,
-            refPicPtr->buffer_bit_inc_y,
-            refPicPtr->stride_bit_inc_y,
-            refPic16BitPtr->width  + (refPicPtr->origin_x << 1),
-            refPic16BitPtr->height + (refPicPtr->origin_y << 1),
-            sequence_control_set_ptr->static_config.asm_type);
-
-        un_pack2d(
-            (uint16_t*)refPic16BitPtr->buffer_cb,
-            refPic16BitPtr->stride_cb,
-            refPicPtr->buffer_cb,
-            refPicPtr->stride_cb,
-            refPicPtr->buffer_bit_inc_cb,
-            refPicPtr->stride_bit_inc_cb,
-            (refPic16BitPtr->width + (refPicPtr->origin_x << 1)) >> 1,
-            (refPic16BitPtr->height + (refPicPtr->origin_y << 1)) >> 1,
-            sequence_control_set_ptr->static_config.asm_type);
-
-        un_pack2d(
-            (uint16_t*)refPic16BitPtr->buffer_cr,
-            refPic16BitPtr->stride_cr,
-            refPicPtr->buffer_cr,
-            refPicPtr->stride_cr,
-            refPicPtr->buffer_bit_inc_cr,
-            refPicPtr->stride_bit_inc_cr,
-            (refPic16BitPtr->width + (refPicPtr->origin_x << 1)) >> 1,
-            (refPic16BitPtr->height + (refPicPtr->origin_y << 1)) >> 1,
-            sequence_control_set_ptr->static_config.asm_type);
-    }
     // set up the ref POC
     referenceObject->ref_poc = picture_control_set_ptr->parent_pcs_ptr->picture_number;
 
@@ -1551,10 +1545,111 @@ void move_cu_data(
 void av1_estimate_syntax_rate___partial(
     MdRateEstimationContext        *md_rate_estimation_array,
     FRAME_CONTEXT                  *fc);
+
 /******************************************************
- * EncDec Kernel
+ * EncDec Row Progress
+ *   With deblocking off or done in the coding loop, the
+ *   picture is handed to the filter stages as soon as EncDec
+ *   starts it, and their segments wait for the SB rows they
+ *   read. enc_dec_row_progress counts the rows done from the
+ *   top; the last row is only published once the picture
+ *   level results of EncDec are set.
  ******************************************************/
-void* enc_dec_kernel(void *input_ptr)
+EbBool enc_dec_streams_rows(
+    PictureControlSet *picture_control_set_ptr)
+{
+    return (EbBool)(picture_control_set_ptr->parent_pcs_ptr->loop_filter_mode < 2);
+}
+
+static void enc_dec_publish_progress(
+    PictureControlSet *picture_control_set_ptr,
+    uint32_t           row_progress)
+{
+    picture_control_set_ptr->enc_dec_row_progress = row_progress;
+    for (; picture_control_set_ptr->enc_dec_progress_waiter_count > 0; picture_control_set_ptr->enc_dec_progress_waiter_count--)
+        eb_post_semaphore(picture_control_set_ptr->enc_dec_progress_semaphore);
+}
+
+static void enc_dec_reset_row_progress(
+    PictureControlSet *picture_control_set_ptr,
+    uint32_t           picture_height_in_sb)
+{
+    eb_block_on_mutex(picture_control_set_ptr->enc_dec_progress_mutex);
+    picture_control_set_ptr->enc_dec_row_progress = 0;
+    memset(picture_control_set_ptr->enc_dec_row_sb_count_array, 0, picture_height_in_sb * sizeof(*picture_control_set_ptr->enc_dec_row_sb_count_array));
+    eb_release_mutex(picture_control_set_ptr->enc_dec_progress_mutex);
+}
+
+static void enc_dec_sb_done(
+    PictureControlSet *picture_control_set_ptr,
+    uint32_t           y_sb_index,
+    uint32_t           picture_width_in_sb,
+    uint32_t           picture_height_in_sb)
+{
+    uint32_t row_progress;
+
+    eb_block_on_mutex(picture_control_set_ptr->enc_dec_progress_mutex);
+    picture_control_set_ptr->enc_dec_row_sb_count_array[y_sb_index]++;
+    row_progress = picture_control_set_ptr->enc_dec_row_progress;
+    while (row_progress + 1 < picture_height_in_sb &&
+        picture_control_set_ptr->enc_dec_row_sb_count_array[row_progress] == picture_width_in_sb)
+        row_progress++;
+    if (row_progress != picture_control_set_ptr->enc_dec_row_progress)
+        enc_dec_publish_progress(picture_control_set_ptr, row_progress);
+    eb_release_mutex(picture_control_set_ptr->enc_dec_progress_mutex);
+}
+
+static void enc_dec_picture_done(
+    PictureControlSet *picture_control_set_ptr,
+    uint32_t           picture_height_in_sb)
+{
+    eb_block_on_mutex(picture_control_set_ptr->enc_dec_progress_mutex);
+    enc_dec_publish_progress(picture_control_set_ptr, picture_height_in_sb);
+    eb_release_mutex(picture_control_set_ptr->enc_dec_progress_mutex);
+}
+
+void enc_dec_wait_rows(
+    PictureControlSet *picture_control_set_ptr,
+    uint32_t           row_count)
+{
+    eb_block_on_mutex(picture_control_set_ptr->enc_dec_progress_mutex);
+    while (picture_control_set_ptr->enc_dec_row_progress < row_count) {
+        picture_control_set_ptr->enc_dec_progress_waiter_count++;
+        eb_release_mutex(picture_control_set_ptr->enc_dec_progress_mutex);
+        eb_task_scheduler_enter_wait();
+        eb_block_on_semaphore(picture_control_set_ptr->enc_dec_progress_semaphore);
+        eb_task_scheduler_leave_wait();
+        eb_block_on_mutex(picture_control_set_ptr->enc_dec_progress_mutex);
+    }
+    eb_release_mutex(picture_control_set_ptr->enc_dec_progress_mutex);
+}
+
+static void post_enc_dec_results(
+    EncDecContext   *context_ptr,
+    EbObjectWrapper *picture_control_set_wrapper_ptr,
+    uint32_t         picture_height_in_sb)
+{
+    EbObjectWrapper *encDecResultsWrapperPtr;
+    EncDecResults   *encDecResultsPtr;
+
+    // Get Empty EncDec Results
+    eb_get_empty_object(
+        context_ptr->enc_dec_output_fifo_ptr,
+        &encDecResultsWrapperPtr);
+    encDecResultsPtr = (EncDecResults*)encDecResultsWrapperPtr->object_ptr;
+    encDecResultsPtr->picture_control_set_wrapper_ptr = picture_control_set_wrapper_ptr;
+    encDecResultsPtr->task_type = FILTER_TASK_PROCESS;
+    //CHKN these are not needed for DLF
+    encDecResultsPtr->completed_lcu_row_index_start = 0;
+    encDecResultsPtr->completed_lcu_row_count = picture_height_in_sb;
+    // Post EncDec Results
+    eb_post_full_object(encDecResultsWrapperPtr);
+}
+
+/******************************************************
+ * EncDec Task
+ ******************************************************/
+void enc_dec_task(void *input_ptr, EbObjectWrapper *encDecTasksWrapperPtr)
 {
     // Context & SCS & PCS
     EncDecContext                         *context_ptr = (EncDecContext*)input_ptr;
@@ -1562,12 +1657,8 @@ void* enc_dec_kernel(void *input_ptr)
     SequenceControlSet                    *sequence_control_set_ptr;
 
     // Input
-    EbObjectWrapper                       *encDecTasksWrapperPtr;
     EncDecTasks                           *encDecTasksPtr;
 
-    // Output
-    EbObjectWrapper                       *encDecResultsWrapperPtr;
-    EncDecResults                         *encDecResultsPtr;
     // SB Loop variables
     LargestCodingUnit                       *sb_ptr;
     uint16_t                                 sb_index;
@@ -1582,6 +1673,8 @@ void* enc_dec_kernel(void *input_ptr)
     uint32_t                                 lcuRowIndexStart;
     uint32_t                                 lcuRowIndexCount;
     uint32_t                                 picture_width_in_sb;
+    uint32_t                                 picture_height_in_sb;
+    EbBool                                   stream_rows;
     MdcLcuData                              *mdcPtr;
 
     // Variables
@@ -1599,270 +1692,303 @@ void* enc_dec_kernel(void *input_ptr)
     uint32_t                                 segmentBandIndex;
     uint32_t                                 segmentBandSize;
     EncDecSegments                          *segments_ptr;
-    for (;;) {
-        // Get Mode Decision Results
-        eb_get_full_object(
-            context_ptr->mode_decision_input_fifo_ptr,
-            &encDecTasksWrapperPtr);
-
-        encDecTasksPtr = (EncDecTasks*)encDecTasksWrapperPtr->object_ptr;
-        picture_control_set_ptr = (PictureControlSet*)encDecTasksPtr->picture_control_set_wrapper_ptr->object_ptr;
-        sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
-        segments_ptr = picture_control_set_ptr->enc_dec_segment_ctrl;
-        lastLcuFlag = EB_FALSE;
-        is16bit = (EbBool)(sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
-        (void)is16bit;
-        (void)endOfRowFlag;
 
-        // EncDec Kernel Signal(s) derivation
+    encDecTasksPtr = (EncDecTasks*)encDecTasksWrapperPtr->object_ptr;
+    picture_control_set_ptr = (PictureControlSet*)encDecTasksPtr->picture_control_set_wrapper_ptr->object_ptr;
+    eb_trace_set_object(picture_control_set_ptr->picture_number, EB_TRACE_NO_SEGMENT);
+    sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
+    segments_ptr = picture_control_set_ptr->enc_dec_segment_ctrl;
+    lastLcuFlag = EB_FALSE;
+    is16bit = (EbBool)(sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
+    (void)is16bit;
+    (void)endOfRowFlag;
+
+    // EncDec Kernel Signal(s) derivation
+
+    signal_derivation_enc_dec_kernel_oq(
+        sequence_control_set_ptr,
+        picture_control_set_ptr,
+        context_ptr->md_context);
+
+    // SB Constants
+    sb_sz = (uint8_t)sequence_control_set_ptr->sb_size_pix;
+    lcuSizeLog2 = (uint8_t)Log2f(sb_sz);
+    context_ptr->sb_sz = sb_sz;
+    picture_width_in_sb = (sequence_control_set_ptr->seq_header.max_frame_width + sb_sz - 1) >> lcuSizeLog2;
+    picture_height_in_sb = (sequence_control_set_ptr->seq_header.max_frame_height + sb_sz - 1) >> lcuSizeLog2;
+    stream_rows = enc_dec_streams_rows(picture_control_set_ptr);
+    endOfRowFlag = EB_FALSE;
+    lcuRowIndexStart = lcuRowIndexCount = 0;
+    context_ptr->tot_intra_coded_area = 0;
+
+    // The filter stages get the picture now and follow the rows
+    if (stream_rows && encDecTasksPtr->input_type == ENCDEC_TASKS_MDC_INPUT) {
+        enc_dec_reset_row_progress(
+            picture_control_set_ptr,
+            picture_height_in_sb);
+        post_enc_dec_results(
+            context_ptr,
+            encDecTasksPtr->picture_control_set_wrapper_ptr,
+            picture_height_in_sb);
+    }
 
-        signal_derivation_enc_dec_kernel_oq(
-            sequence_control_set_ptr,
+    // Segment-loop
+    while (AssignEncDecSegments(segments_ptr, &segment_index, encDecTasksPtr, context_ptr->enc_dec_feedback_fifo_ptr) == EB_TRUE)
+    {
+        const uint64_t segmentStartTime = eb_trace_span_begin();
+        xLcuStartIndex = segments_ptr->x_start_array[segment_index];
+        yLcuStartIndex = segments_ptr->y_start_array[segment_index];
+        lcuStartIndex = yLcuStartIndex * picture_width_in_sb + xLcuStartIndex;
+        lcuSegmentCount = segments_ptr->valid_lcu_count_array[segment_index];
+
+        segmentRowIndex = segment_index / segments_ptr->segment_band_count;
+        segmentBandIndex = segment_index - segmentRowIndex * segments_ptr->segment_band_count;
+        segmentBandSize = (segments_ptr->lcu_band_count * (segmentBandIndex + 1) + segments_ptr->segment_band_count - 1) / segments_ptr->segment_band_count;
+
+        // Reset Coding Loop State
+        reset_mode_decision( // HT done
+            context_ptr->md_context,
             picture_control_set_ptr,
-            context_ptr->md_context);
-
-        // SB Constants
-        sb_sz = (uint8_t)sequence_control_set_ptr->sb_size_pix;
-        lcuSizeLog2 = (uint8_t)Log2f(sb_sz);
-        context_ptr->sb_sz = sb_sz;
-        picture_width_in_sb = (sequence_control_set_ptr->seq_header.max_frame_width + sb_sz - 1) >> lcuSizeLog2;
-        endOfRowFlag = EB_FALSE;
-        lcuRowIndexStart = lcuRowIndexCount = 0;
-        context_ptr->tot_intra_coded_area = 0;
-
-        // Segment-loop
-        while (AssignEncDecSegments(segments_ptr, &segment_index, encDecTasksPtr, context_ptr->enc_dec_feedback_fifo_ptr) == EB_TRUE)
-        {
-            xLcuStartIndex = segments_ptr->x_start_array[segment_index];
-            yLcuStartIndex = segments_ptr->y_start_array[segment_index];
-            lcuStartIndex = yLcuStartIndex * picture_width_in_sb + xLcuStartIndex;
-            lcuSegmentCount = segments_ptr->valid_lcu_count_array[segment_index];
-
-            segmentRowIndex = segment_index / segments_ptr->segment_band_count;
-            segmentBandIndex = segment_index - segmentRowIndex * segments_ptr->segment_band_count;
-            segmentBandSize = (segments_ptr->lcu_band_count * (segmentBandIndex + 1) + segments_ptr->segment_band_count - 1) / segments_ptr->segment_band_count;
-
-            // Reset Coding Loop State
-            reset_mode_decision( // HT done
-                context_ptr->md_context,
-                picture_control_set_ptr,
 #if !ENABLE_CDF_UPDATE
-                sequence_control_set_ptr,
+            sequence_control_set_ptr,
 #endif
-                segment_index);
+            segment_index);
 
-            // Reset EncDec Coding State
-            ResetEncDec(    // HT done
-                context_ptr,
-                picture_control_set_ptr,
-                sequence_control_set_ptr,
-                segment_index);
-
-            if (picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr != NULL)
-                ((EbReferenceObject  *)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->average_intensity = picture_control_set_ptr->parent_pcs_ptr->average_intensity[0];
-            for (y_lcu_index = yLcuStartIndex, lcuSegmentIndex = lcuStartIndex; lcuSegmentIndex < lcuStartIndex + lcuSegmentCount; ++y_lcu_index) {
-                for (x_lcu_index = xLcuStartIndex; x_lcu_index < picture_width_in_sb && (x_lcu_index + y_lcu_index < segmentBandSize) && lcuSegmentIndex < lcuStartIndex + lcuSegmentCount; ++x_lcu_index, ++lcuSegmentIndex) {
-                    sb_index = (uint16_t)(y_lcu_index * picture_width_in_sb + x_lcu_index);
-                    sb_ptr = picture_control_set_ptr->sb_ptr_array[sb_index];
-                    sb_origin_x = x_lcu_index << lcuSizeLog2;
-                    sb_origin_y = y_lcu_index << lcuSizeLog2;
-                    lastLcuFlag = (sb_index == sequence_control_set_ptr->sb_tot_cnt - 1) ? EB_TRUE : EB_FALSE;
-                    endOfRowFlag = (x_lcu_index == picture_width_in_sb - 1) ? EB_TRUE : EB_FALSE;
-                    lcuRowIndexStart = (x_lcu_index == picture_width_in_sb - 1 && lcuRowIndexCount == 0) ? y_lcu_index : lcuRowIndexStart;
-                    lcuRowIndexCount = (x_lcu_index == picture_width_in_sb - 1) ? lcuRowIndexCount + 1 : lcuRowIndexCount;
-                    mdcPtr = &picture_control_set_ptr->mdc_sb_array[sb_index];
-                    context_ptr->sb_index = sb_index;
-                    context_ptr->md_context->cu_use_ref_src_flag = (picture_control_set_ptr->parent_pcs_ptr->use_src_ref) && (picture_control_set_ptr->parent_pcs_ptr->edge_results_ptr[sb_index].edge_block_num == EB_FALSE || picture_control_set_ptr->parent_pcs_ptr->sb_flat_noise_array[sb_index]) ? EB_TRUE : EB_FALSE;
-
-                    if (picture_control_set_ptr->update_cdf) {
+        // Reset EncDec Coding State
+        ResetEncDec(    // HT done
+            context_ptr,
+            picture_control_set_ptr,
+            sequence_control_set_ptr,
+            segment_index);
+
+        if (picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr != NULL)
+            ((EbReferenceObject  *)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->average_intensity = picture_control_set_ptr->parent_pcs_ptr->average_intensity[0];
+        for (y_lcu_index = yLcuStartIndex, lcuSegmentIndex = lcuStartIndex; lcuSegmentIndex < lcuStartIndex + lcuSegmentCount; ++y_lcu_index) {
+            for (x_lcu_index = xLcuStartIndex; x_lcu_index < picture_width_in_sb && (x_lcu_index + y_lcu_index < segmentBandSize) && lcuSegmentIndex < lcuStartIndex + lcuSegmentCount; ++x_lcu_index, ++lcuSegmentIndex) {
+                sb_index = (uint16_t)(y_lcu_index * picture_width_in_sb + x_lcu_index);
+                sb_ptr = picture_control_set_ptr->sb_ptr_array[sb_index];
+                sb_origin_x = x_lcu_index << lcuSizeLog2;
+                sb_origin_y = y_lcu_index << lcuSizeLog2;
+                lastLcuFlag = (sb_index == sequence_control_set_ptr->sb_tot_cnt - 1) ? EB_TRUE : EB_FALSE;
+                endOfRowFlag = (x_lcu_index == picture_width_in_sb - 1) ? EB_TRUE : EB_FALSE;
+                lcuRowIndexStart = (x_lcu_index == picture_width_in_sb - 1 && lcuRowIndexCount == 0) ? y_lcu_index : lcuRowIndexStart;
+                lcuRowIndexCount = (x_lcu_index == picture_width_in_sb - 1) ? lcuRowIndexCount + 1 : lcuRowIndexCount;
+                mdcPtr = &picture_control_set_ptr->mdc_sb_array[sb_index];
+                context_ptr->sb_index = sb_index;
+                context_ptr->md_context->cu_use_ref_src_flag = (picture_control_set_ptr->parent_pcs_ptr->use_src_ref) && (picture_control_set_ptr->parent_pcs_ptr->edge_results_ptr[sb_index].edge_block_num == EB_FALSE || picture_control_set_ptr->parent_pcs_ptr->sb_flat_noise_array[sb_index]) ? EB_TRUE : EB_FALSE;
+
+                if (picture_control_set_ptr->update_cdf) {
 #if ENABLE_CDF_UPDATE
-                        picture_control_set_ptr->rate_est_array[sb_index] = *picture_control_set_ptr->md_rate_estimation_array;
+                    picture_control_set_ptr->rate_est_array[sb_index] = *picture_control_set_ptr->md_rate_estimation_array;
 #else
-                        MdRateEstimationContext* md_rate_estimation_array = sequence_control_set_ptr->encode_context_ptr->md_rate_estimation_array;
-                        md_rate_estimation_array += picture_control_set_ptr->slice_type * TOTAL_NUMBER_OF_QP_VALUES + context_ptr->md_context->qp;
+                    MdRateEstimationContext* md_rate_estimation_array = sequence_control_set_ptr->encode_context_ptr->md_rate_estimation_array;
+                    md_rate_estimation_array += picture_control_set_ptr->slice_type * TOTAL_NUMBER_OF_QP_VALUES + context_ptr->md_context->qp;
 
-                        //this is temp, copy all default tables
-                        picture_control_set_ptr->rate_est_array[sb_index] = *md_rate_estimation_array;
+                    //this is temp, copy all default tables
+                    picture_control_set_ptr->rate_est_array[sb_index] = *md_rate_estimation_array;
 #endif
 #if CABAC_SERIAL
-                        if (sb_index == 0)
-                            picture_control_set_ptr->ec_ctx_array[sb_index] = *picture_control_set_ptr->coeff_est_entropy_coder_ptr->fc;
-                        else
-                            picture_control_set_ptr->ec_ctx_array[sb_index] = picture_control_set_ptr->ec_ctx_array[sb_index - 1];
+                    if (sb_index == 0)
+                        picture_control_set_ptr->ec_ctx_array[sb_index] = *picture_control_set_ptr->coeff_est_entropy_coder_ptr->fc;
+                    else
+                        picture_control_set_ptr->ec_ctx_array[sb_index] = picture_control_set_ptr->ec_ctx_array[sb_index - 1];
 #else
-                        if (sb_origin_x == 0)
-                            picture_control_set_ptr->ec_ctx_array[sb_index] = *picture_control_set_ptr->coeff_est_entropy_coder_ptr->fc;
-                        else
-                            picture_control_set_ptr->ec_ctx_array[sb_index] = picture_control_set_ptr->ec_ctx_array[sb_index - 1];
+                    if (sb_origin_x == 0)
+                        picture_control_set_ptr->ec_ctx_array[sb_index] = *picture_control_set_ptr->coeff_est_entropy_coder_ptr->fc;
+                    else
+                        picture_control_set_ptr->ec_ctx_array[sb_index] = picture_control_set_ptr->ec_ctx_array[sb_index - 1];
 #endif
 
-                        //construct the tables using the latest CDFs : Coeff Only here ---to check if I am using all the uptodate CDFs here
-                        av1_estimate_syntax_rate___partial(
-                            &picture_control_set_ptr->rate_est_array[sb_index],
-                            &picture_control_set_ptr->ec_ctx_array[sb_index]);
+                    //construct the tables using the latest CDFs : Coeff Only here ---to check if I am using all the uptodate CDFs here
+                    av1_estimate_syntax_rate___partial(
+                        &picture_control_set_ptr->rate_est_array[sb_index],
+                        &picture_control_set_ptr->ec_ctx_array[sb_index]);
 
-                        av1_estimate_coefficients_rate(
-                            &picture_control_set_ptr->rate_est_array[sb_index],
-                            &picture_control_set_ptr->ec_ctx_array[sb_index]);
+                    av1_estimate_coefficients_rate(
+                        &picture_control_set_ptr->rate_est_array[sb_index],
+                        &picture_control_set_ptr->ec_ctx_array[sb_index]);
 
-                        //let the candidate point to the new rate table.
-                        uint32_t  candidateIndex;
-                        for (candidateIndex = 0; candidateIndex < MODE_DECISION_CANDIDATE_MAX_COUNT; ++candidateIndex)
-                            context_ptr->md_context->fast_candidate_ptr_array[candidateIndex]->md_rate_estimation_ptr = &picture_control_set_ptr->rate_est_array[sb_index];
-                    }
-                    // Configure the LCU
-                    mode_decision_configure_lcu(
-                        context_ptr->md_context,
+                    //let the candidate point to the new rate table.
+                    uint32_t  candidateIndex;
+                    for (candidateIndex = 0; candidateIndex < MODE_DECISION_CANDIDATE_MAX_COUNT; ++candidateIndex)
+                        context_ptr->md_context->fast_candidate_ptr_array[candidateIndex]->md_rate_estimation_ptr = &picture_control_set_ptr->rate_est_array[sb_index];
+                }
+                // Configure the LCU
+                mode_decision_configure_lcu(
+                    context_ptr->md_context,
 #if !QPM
-                        sb_ptr,
+                    sb_ptr,
 #endif
-                        picture_control_set_ptr,
+                    picture_control_set_ptr,
 #if !QPM
-                        sequence_control_set_ptr,
-                        (uint8_t)context_ptr->qp,
+                    sequence_control_set_ptr,
+                    (uint8_t)context_ptr->qp,
 #endif
-                        (uint8_t)sb_ptr->qp);
-
-                    uint32_t lcuRow;
-                    if (picture_control_set_ptr->parent_pcs_ptr->enable_in_loop_motion_estimation_flag) {
-                        EbPictureBufferDesc       *input_picture_ptr;
-
-                        input_picture_ptr = picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr;
-
-                        // Load the SB from the input to the intermediate SB buffer
-                        uint32_t bufferIndex = (input_picture_ptr->origin_y + sb_origin_y) * input_picture_ptr->stride_y + input_picture_ptr->origin_x + sb_origin_x;
-
-                        // Copy the source superblock to the me local buffer
-                        uint32_t sb_height = (sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y) < MAX_SB_SIZE ? sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y : MAX_SB_SIZE;
-                        uint32_t sb_width = (sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x) < MAX_SB_SIZE ? sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x : MAX_SB_SIZE;
-                        uint32_t is_complete_sb = sequence_control_set_ptr->sb_geom[sb_index].is_complete_sb;
-
-                        if (!is_complete_sb)
-                            memset(context_ptr->ss_mecontext->sb_buffer, 0, MAX_SB_SIZE*MAX_SB_SIZE);
-                        for (lcuRow = 0; lcuRow < sb_height; lcuRow++) {
-                            EB_MEMCPY((&(context_ptr->ss_mecontext->sb_buffer[lcuRow * MAX_SB_SIZE])), (&(input_picture_ptr->buffer_y[bufferIndex + lcuRow * input_picture_ptr->stride_y])), sb_width * sizeof(uint8_t));
-                        }
-
-                        context_ptr->ss_mecontext->sb_src_ptr = &(context_ptr->ss_mecontext->sb_buffer[0]);
-                        context_ptr->ss_mecontext->sb_src_stride = context_ptr->ss_mecontext->sb_buffer_stride;
-                        // Set in-loop ME Search Area
-                        int16_t mv_l0_x;
-                        int16_t mv_l0_y;
-                        int16_t mv_l1_x;
-                        int16_t mv_l1_y;
-
-                        mv_l0_x = 0;
-                        mv_l0_y = 0;
-                        mv_l1_x = 0;
-                        mv_l1_y = 0;
-
-                        context_ptr->ss_mecontext->search_area_width = 64;
-                        context_ptr->ss_mecontext->search_area_height = 64;
-
-                        // perform in-loop ME
-                        in_loop_motion_estimation_sblock(
-                            picture_control_set_ptr,
-                            sb_origin_x,
-                            sb_origin_y,
-                            mv_l0_x,
-                            mv_l0_y,
-                            mv_l1_x,
-                            mv_l1_y,
-                            context_ptr->ss_mecontext);
+                    (uint8_t)sb_ptr->qp);
+
+                uint32_t lcuRow;
+                if (picture_control_set_ptr->parent_pcs_ptr->enable_in_loop_motion_estimation_flag) {
+                    EbPictureBufferDesc       *input_picture_ptr;
+
+                    input_picture_ptr = picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr;
+
+                    // Load the SB from the input to the intermediate SB buffer
+                    uint32_t bufferIndex = (input_picture_ptr->origin_y + sb_origin_y) * input_picture_ptr->stride_y + input_picture_ptr->origin_x + sb_origin_x;
+
+                    // Copy the source superblock to the me local buffer
+                    uint32_t sb_height = (sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y) < MAX_SB_SIZE ? sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y : MAX_SB_SIZE;
+                    uint32_t sb_width = (sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x) < MAX_SB_SIZE ? sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x : MAX_SB_SIZE;
+                    uint32_t is_complete_sb = sequence_control_set_ptr->sb_geom[sb_index].is_complete_sb;
+
+                    if (!is_complete_sb)
+                        memset(context_ptr->ss_mecontext->sb_buffer, 0, MAX_SB_SIZE*MAX_SB_SIZE);
+                    for (lcuRow = 0; lcuRow < sb_height; lcuRow++) {
+                        EB_MEMCPY((&(context_ptr->ss_mecontext->sb_buffer[lcuRow * MAX_SB_SIZE])), (&(input_picture_ptr->buffer_y[bufferIndex + lcuRow * input_picture_ptr->stride_y])), sb_width * sizeof(uint8_t));
                     }
 
-                    mode_decision_sb(
-                        sequence_control_set_ptr,
+                    context_ptr->ss_mecontext->sb_src_ptr = &(context_ptr->ss_mecontext->sb_buffer[0]);
+                    context_ptr->ss_mecontext->sb_src_stride = context_ptr->ss_mecontext->sb_buffer_stride;
+                    // Set in-loop ME Search Area
+                    int16_t mv_l0_x;
+                    int16_t mv_l0_y;
+                    int16_t mv_l1_x;
+                    int16_t mv_l1_y;
+
+                    mv_l0_x = 0;
+                    mv_l0_y = 0;
+                    mv_l1_x = 0;
+                    mv_l1_y = 0;
+
+                    context_ptr->ss_mecontext->search_area_width = 64;
+                    context_ptr->ss_mecontext->search_area_height = 64;
+
+                    // perform in-loop ME
+                    in_loop_motion_estimation_sblock(
                         picture_control_set_ptr,
-                        mdcPtr,
-                        sb_ptr,
                         sb_origin_x,
                         sb_origin_y,
-                        sb_index,
-                        context_ptr->ss_mecontext,
-                        context_ptr->md_context);
-
-                    // Configure the LCU
-                    EncDecConfigureLcu(
-                        context_ptr,
-                        sb_ptr,
-                        picture_control_set_ptr,
+                        mv_l0_x,
+                        mv_l0_y,
+                        mv_l1_x,
+                        mv_l1_y,
+                        context_ptr->ss_mecontext);
+                }
+
+                mode_decision_sb(
+                    sequence_control_set_ptr,
+                    picture_control_set_ptr,
+                    mdcPtr,
+                    sb_ptr,
+                    sb_origin_x,
+                    sb_origin_y,
+                    sb_index,
+                    context_ptr->ss_mecontext,
+                    context_ptr->md_context);
+
+                // Configure the LCU
+                EncDecConfigureLcu(
+                    context_ptr,
+                    sb_ptr,
+                    picture_control_set_ptr,
 #if !QPM
-                        sequence_control_set_ptr,
-                        (uint8_t)context_ptr->qp,
+                    sequence_control_set_ptr,
+                    (uint8_t)context_ptr->qp,
 #endif
-                        (uint8_t)sb_ptr->qp);
+                    (uint8_t)sb_ptr->qp);
 
 #if NO_ENCDEC
-                    no_enc_dec_pass(
-                        sequence_control_set_ptr,
-                        picture_control_set_ptr,
-                        sb_ptr,
-                        sb_index,
-                        sb_origin_x,
-                        sb_origin_y,
-                        sb_ptr->qp,
-                        context_ptr);
+                no_enc_dec_pass(
+                    sequence_control_set_ptr,
+                    picture_control_set_ptr,
+                    sb_ptr,
+                    sb_index,
+                    sb_origin_x,
+                    sb_origin_y,
+                    sb_ptr->qp,
+                    context_ptr);
 #else
-                    // Encode Pass
-                    av1_encode_pass(
-                        sequence_control_set_ptr,
-                        picture_control_set_ptr,
-                        sb_ptr,
-                        sb_index,
-                        sb_origin_x,
-                        sb_origin_y,
-                        context_ptr);
+                // Encode Pass
+                av1_encode_pass(
+                    sequence_control_set_ptr,
+                    picture_control_set_ptr,
+                    sb_ptr,
+                    sb_index,
+                    sb_origin_x,
+                    sb_origin_y,
+                    context_ptr);
 #endif
 
-                    if (picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr != NULL)
-                        ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->intra_coded_area_sb[sb_index] = (uint8_t)((100 * context_ptr->intra_coded_area_sb[sb_index]) / (64 * 64));
-                }
-                xLcuStartIndex = (xLcuStartIndex > 0) ? xLcuStartIndex - 1 : 0;
+                if (picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr != NULL)
+                    ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->intra_coded_area_sb[sb_index] = (uint8_t)((100 * context_ptr->intra_coded_area_sb[sb_index]) / (64 * 64));
+
+                if (stream_rows)
+                    enc_dec_sb_done(
+                        picture_control_set_ptr,
+                        y_lcu_index,
+                        picture_width_in_sb,
+                        picture_height_in_sb);
             }
+            xLcuStartIndex = (xLcuStartIndex > 0) ? xLcuStartIndex - 1 : 0;
         }
 
-        eb_block_on_mutex(picture_control_set_ptr->intra_mutex);
-        picture_control_set_ptr->intra_coded_area += (uint32_t)context_ptr->tot_intra_coded_area;
-        eb_release_mutex(picture_control_set_ptr->intra_mutex);
+        eb_trace_span_end("enc_dec_segment", segmentStartTime, picture_control_set_ptr->picture_number, segment_index);
+    }
+
+    eb_block_on_mutex(picture_control_set_ptr->intra_mutex);
+    picture_control_set_ptr->intra_coded_area += (uint32_t)context_ptr->tot_intra_coded_area;
+    eb_release_mutex(picture_control_set_ptr->intra_mutex);
 
-        if (lastLcuFlag) {
-            // Copy film grain data from parent picture set to the reference object for further reference
-            if (sequence_control_set_ptr->seq_header.film_grain_params_present)
-            {
-                if (picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag == EB_TRUE && picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr) {
-                    ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->film_grain_params
-                        = picture_control_set_ptr->parent_pcs_ptr->frm_hdr.film_grain_params;
-                }
+    if (lastLcuFlag) {
+        // Copy film grain data from parent picture set to the reference object for further reference
+        if (sequence_control_set_ptr->seq_header.film_grain_params_present)
+        {
+            if (picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag == EB_TRUE && picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr) {
+                ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->film_grain_params
+                    = picture_control_set_ptr->parent_pcs_ptr->frm_hdr.film_grain_params;
             }
+        }
 #if ENABLE_CDF_UPDATE
-            if (picture_control_set_ptr->parent_pcs_ptr->frame_end_cdf_update_mode && picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag == EB_TRUE && picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr)
-                for (int frame = LAST_FRAME; frame <= ALTREF_FRAME; ++frame)
-                    ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->global_motion[frame]
-                    = picture_control_set_ptr->parent_pcs_ptr->global_motion[frame];
+        if (picture_control_set_ptr->parent_pcs_ptr->frame_end_cdf_update_mode && picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag == EB_TRUE && picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr)
+            for (int frame = LAST_FRAME; frame <= ALTREF_FRAME; ++frame)
+                ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->global_motion[frame]
+                = picture_control_set_ptr->parent_pcs_ptr->global_motion[frame];
 #endif
-            EB_MEMCPY(picture_control_set_ptr->parent_pcs_ptr->av1x->sgrproj_restore_cost, context_ptr->md_rate_estimation_ptr->sgrproj_restore_fac_bits, 2 * sizeof(int32_t));
-            EB_MEMCPY(picture_control_set_ptr->parent_pcs_ptr->av1x->switchable_restore_cost, context_ptr->md_rate_estimation_ptr->switchable_restore_fac_bits, 3 * sizeof(int32_t));
-            EB_MEMCPY(picture_control_set_ptr->parent_pcs_ptr->av1x->wiener_restore_cost, context_ptr->md_rate_estimation_ptr->wiener_restore_fac_bits, 2 * sizeof(int32_t));
-            picture_control_set_ptr->parent_pcs_ptr->av1x->rdmult = context_ptr->full_lambda;
-        }
+        EB_MEMCPY(picture_control_set_ptr->parent_pcs_ptr->av1x->sgrproj_restore_cost, context_ptr->md_rate_estimation_ptr->sgrproj_restore_fac_bits, 2 * sizeof(int32_t));
+        EB_MEMCPY(picture_control_set_ptr->parent_pcs_ptr->av1x->switchable_restore_cost, context_ptr->md_rate_estimation_ptr->switchable_restore_fac_bits, 3 * sizeof(int32_t));
+        EB_MEMCPY(picture_control_set_ptr->parent_pcs_ptr->av1x->wiener_restore_cost, context_ptr->md_rate_estimation_ptr->wiener_restore_fac_bits, 2 * sizeof(int32_t));
+        picture_control_set_ptr->parent_pcs_ptr->av1x->rdmult = context_ptr->full_lambda;
+    }
 
-        if (lastLcuFlag)
-        {
-            // Get Empty EncDec Results
-            eb_get_empty_object(
-                context_ptr->enc_dec_output_fifo_ptr,
-                &encDecResultsWrapperPtr);
-            encDecResultsPtr = (EncDecResults*)encDecResultsWrapperPtr->object_ptr;
-            encDecResultsPtr->picture_control_set_wrapper_ptr = encDecTasksPtr->picture_control_set_wrapper_ptr;
-            //CHKN these are not needed for DLF
-            encDecResultsPtr->completed_lcu_row_index_start = 0;
-            encDecResultsPtr->completed_lcu_row_count = ((sequence_control_set_ptr->seq_header.max_frame_height + sequence_control_set_ptr->sb_size_pix - 1) >> lcuSizeLog2);
-            // Post EncDec Results
-            eb_post_full_object(encDecResultsWrapperPtr);
-        }
-        // Release Mode Decision Results
-        eb_release_object(encDecTasksWrapperPtr);
+    if (lastLcuFlag) {
+        if (stream_rows)
+            enc_dec_picture_done(
+                picture_control_set_ptr,
+                picture_height_in_sb);
+        else
+            post_enc_dec_results(
+                context_ptr,
+                encDecTasksPtr->picture_control_set_wrapper_ptr,
+                picture_height_in_sb);
+    }
+    // Release Mode Decision Results
+    eb_release_object(encDecTasksWrapperPtr);
+}
+
+/******************************************************
+ * EncDec Kernel
+ ******************************************************/
+void* enc_dec_kernel(void *input_ptr)
+{
+    EncDecContext                         *context_ptr = (EncDecContext*)input_ptr;
+    EbObjectWrapper                       *encDecTasksWrapperPtr;
+
+    for (;;) {
+        // Get Mode Decision Results
+        eb_get_full_object(
+            context_ptr->mode_decision_input_fifo_ptr,
+            &encDecTasksWrapperPtr);
+
+        enc_dec_task(input_ptr, encDecTasksWrapperPtr);
     }
     return EB_NULL;
 }
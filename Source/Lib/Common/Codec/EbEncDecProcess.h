@@ -147,6 +147,23 @@ extern "C" {
         uint32_t                 max_input_luma_height);
 
     extern void* enc_dec_kernel(void *input_ptr);
+    extern void enc_dec_task(void *input_ptr, EbObjectWrapper *input_wrapper_ptr);
+
+    /**************************************
+     * enc_dec_streams_rows
+     *   EB_TRUE when the filter stages start on the picture
+     *   before EncDec is done with it.
+     *
+     * enc_dec_wait_rows
+     *   Blocks until the first row_count SB rows of the picture
+     *   are done by EncDec, deblocking included.
+     **************************************/
+    extern EbBool enc_dec_streams_rows(
+        PictureControlSet     *picture_control_set_ptr);
+
+    extern void enc_dec_wait_rows(
+        PictureControlSet     *picture_control_set_ptr,
+        uint32_t               row_count);
 
 #ifdef __cplusplus
 }
@@ -12,6 +12,17 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+    /**************************************
+     * Filter Task Types
+     *   FILTER_TASK_HELP asks a thread of the filter stage to join the
+     *   row segments of a picture processed by another thread of the stage
+     **************************************/
+    typedef enum FilterTaskType
+    {
+        FILTER_TASK_PROCESS = 0,
+        FILTER_TASK_HELP
+    } FilterTaskType;
+
     /**************************************
      * Process Results
      **************************************/
@@ -21,6 +32,7 @@ extern "C" {
         EbObjectWrapper *picture_control_set_wrapper_ptr;
         uint32_t         completed_lcu_row_index_start;
         uint32_t         completed_lcu_row_count;
+        FilterTaskType   task_type;
     } EncDecResults;
 
     typedef struct DlfResults
@@ -28,6 +40,7 @@ extern "C" {
         EbDctor         dctor;
         EbObjectWrapper *picture_control_set_wrapper_ptr;
         uint32_t         segment_index;
+        FilterTaskType   task_type;
     } DlfResults;
 
     typedef struct CdefResults
@@ -35,6 +48,7 @@ extern "C" {
         EbDctor         dctor;
         EbObjectWrapper *picture_control_set_wrapper_ptr;
         uint32_t         segment_index;
+        FilterTaskType   task_type;
     } CdefResults;
 
     typedef struct RestResults
@@ -43,6 +57,7 @@ extern "C" {
         EbObjectWrapper *picture_control_set_wrapper_ptr;
         uint32_t         completed_lcu_row_index_start;
         uint32_t         completed_lcu_row_count;
+        uint16_t         tile_index; // tile to code when the picture has several
     } RestResults;
 
     typedef struct EncDecResultsInitData {
@@ -46,6 +46,9 @@ typedef struct EncodeContext
     EbDctor                                        dctor;
     // Callback Functions
     EbCallback                                    *app_callback_ptr;
+    // Packets go to the callback instead of stream_output_fifo_ptr when set
+    EbSvtPacketCallback                            packet_callback;
+    void                                          *packet_context;
 
     EbBool                                           statistics_port_active;
     EbHandle                                         total_number_of_recon_frame_mutex;
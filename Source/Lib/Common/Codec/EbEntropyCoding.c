@@ -32,6 +32,7 @@
 #define S16 16*16
 #define S8  8*8
 #define S4  4*4
+#define  AV1_MIN_TILE_SIZE_BYTES 1
 
 int32_t eb_av1_loop_restoration_corners_in_sb(Av1Common *cm, int32_t plane,
     int32_t mi_row, int32_t mi_col, BlockSize bsize,
@@ -1720,7 +1721,8 @@ EbErrorType encode_slice_finish(
 {
     EbErrorType return_error = EB_ErrorNone;
 
-    aom_stop_encode(&entropy_coder_ptr->ec_writer);
+    if (aom_stop_encode(&entropy_coder_ptr->ec_writer) < 0)
+        return_error = EB_ErrorInsufficientResources;
 
     return return_error;
 }
@@ -4744,13 +4746,23 @@ EbErrorType write_frame_header_av1(
         0, n_log2_tiles, tile_start_and_end_present_flag);
 
     if (!showExisting) {
-        // Add data from EC stream to Picture Stream.
-        int32_t frameSize = (int32_t)(parent_pcs_ptr->av1_cm->tiles_info.tile_cols*parent_pcs_ptr->av1_cm->tiles_info.tile_rows==1 ? pcs_ptr->entropy_coder_ptr->ec_writer.pos : pcs_ptr->entropy_coder_ptr->ec_frame_size);
-        OutputBitstreamUnit *ec_output_bitstream_ptr = (OutputBitstreamUnit*)pcs_ptr->entropy_coder_ptr->ec_output_bitstream_ptr;
-        //****************************************************************//
-        // Copy from EC stream to frame stream
-        memcpy(data + currDataSize, ec_output_bitstream_ptr->buffer_begin_av1, frameSize);
-        currDataSize += (frameSize);
+        // Add data from EC streams to Picture Stream, each tile but the last
+        // one preceded by its size
+        const int tile_count = parent_pcs_ptr->av1_cm->tiles_info.tile_cols * parent_pcs_ptr->av1_cm->tiles_info.tile_rows;
+        for (int tile_idx = 0; tile_idx < tile_count; tile_idx++) {
+            EntropyCoder *ec_ptr = pcs_ptr->ec_tile_ptr_array[tile_idx]->entropy_coder_ptr;
+            int32_t tileSize = (int32_t)ec_ptr->ec_writer.pos;
+            OutputBitstreamUnit *ec_output_bitstream_ptr = (OutputBitstreamUnit*)ec_ptr->ec_output_bitstream_ptr;
+            if (tile_idx < tile_count - 1) {
+                assert(tileSize >= AV1_MIN_TILE_SIZE_BYTES);
+                mem_put_le32(data + currDataSize, tileSize - AV1_MIN_TILE_SIZE_BYTES);
+                currDataSize += 4;
+            }
+            //****************************************************************//
+            // Copy from EC stream to frame stream
+            memcpy(data + currDataSize, ec_output_bitstream_ptr->buffer_begin_av1, tileSize);
+            currDataSize += (tileSize);
+        }
     }
     const uint32_t obuPayloadSize = currDataSize - obuHeaderSize;
     const size_t lengthFieldSize =
@@ -4854,6 +4866,7 @@ static void Av1writeDeltaQindex(
 static void write_cdef(
     SequenceControlSet     *seqCSetPtr,
     PictureControlSet     *p_pcs_ptr,
+    EntropyCodingTile     *tile_ptr,
     //Av1Common *cm,
     MacroBlockD *const xd,
     AomWriter *w,
@@ -4880,8 +4893,8 @@ static void write_cdef(
 // Initialise when at top left part of the superblock
     if (!(mi_row & (seqCSetPtr->seq_header.sb_mi_size - 1)) &&
         !(mi_col & (seqCSetPtr->seq_header.sb_mi_size - 1))) {  // Top left?
-        p_pcs_ptr->cdef_preset[0] = p_pcs_ptr->cdef_preset[1] = p_pcs_ptr->cdef_preset[2] =
-            p_pcs_ptr->cdef_preset[3] = -1;
+        tile_ptr->cdef_preset[0] = tile_ptr->cdef_preset[1] = tile_ptr->cdef_preset[2] =
+            tile_ptr->cdef_preset[3] = -1;
     }
 
     // Emit CDEF param at first non-skip coding block
@@ -4890,16 +4903,16 @@ static void write_cdef(
         ? !!(mi_col & mask) + 2 * !!(mi_row & mask)
         : 0;
 
-    if (p_pcs_ptr->cdef_preset[index] == -1 && !skip) {
+    if (tile_ptr->cdef_preset[index] == -1 && !skip) {
         aom_write_literal(w, mi->mbmi.cdef_strength, frm_hdr->CDEF_params.cdef_bits);
-        p_pcs_ptr->cdef_preset[index] = mi->mbmi.cdef_strength;
+        tile_ptr->cdef_preset[index] = mi->mbmi.cdef_strength;
     }
 }
 
-void eb_av1_reset_loop_restoration(PictureControlSet     *piCSetPtr) {
+void eb_av1_reset_loop_restoration(EntropyCodingTile     *tile_ptr) {
     for (int32_t p = 0; p < 3; ++p) {
-        set_default_wiener(piCSetPtr->wiener_info + p);
-        set_default_sgrproj(piCSetPtr->sgrproj_info + p);
+        set_default_wiener(tile_ptr->wiener_info + p);
+        set_default_sgrproj(tile_ptr->sgrproj_info + p);
     }
 }
 static void write_wiener_filter(int32_t wiener_win, const WienerInfo *wiener_info,
@@ -4977,7 +4990,7 @@ static void write_sgrproj_filter(const SgrprojInfo *sgrproj_info,
 
     memcpy(ref_sgrproj_info, sgrproj_info, sizeof(*sgrproj_info));
 }
-static void loop_restoration_write_sb_coeffs(PictureControlSet     *piCSetPtr, FRAME_CONTEXT           *frameContext, const Av1Common *const cm,
+static void loop_restoration_write_sb_coeffs(EntropyCodingTile     *tile_ptr, FRAME_CONTEXT           *frameContext, const Av1Common *const cm,
     //MacroBlockD *xd,
     const RestorationUnitInfo *rui,
     AomWriter *const w, int32_t plane/*,
@@ -4991,8 +5004,8 @@ static void loop_restoration_write_sb_coeffs(PictureControlSet     *piCSetPtr, F
 //    assert(!cm->all_lossless);
 
     const int32_t wiener_win = (plane > 0) ? WIENER_WIN_CHROMA : WIENER_WIN;
-    WienerInfo *wiener_info = piCSetPtr->wiener_info + plane;
-    SgrprojInfo *sgrproj_info = piCSetPtr->sgrproj_info + plane;
+    WienerInfo *wiener_info = tile_ptr->wiener_info + plane;
+    SgrprojInfo *sgrproj_info = tile_ptr->sgrproj_info + plane;
     RestorationType unit_rtype = rui->restoration_type;
 
     assert(unit_rtype < CDF_SIZE(RESTORE_SWITCHABLE_TYPES));
@@ -5053,18 +5066,19 @@ EbErrorType ec_update_neighbors(
     BlockSize                bsize,
     EbPictureBufferDesc   *coeff_ptr)
 {
+    UNUSED(picture_control_set_ptr);
     UNUSED(coeff_ptr);
     EbErrorType return_error = EB_ErrorNone;
-    NeighborArrayUnit     *mode_type_neighbor_array = picture_control_set_ptr->mode_type_neighbor_array;
-    NeighborArrayUnit     *partition_context_neighbor_array = picture_control_set_ptr->partition_context_neighbor_array;
-    NeighborArrayUnit     *skip_flag_neighbor_array = picture_control_set_ptr->skip_flag_neighbor_array;
-    NeighborArrayUnit     *skip_coeff_neighbor_array = picture_control_set_ptr->skip_coeff_neighbor_array;
-    NeighborArrayUnit     *luma_dc_sign_level_coeff_neighbor_array = picture_control_set_ptr->luma_dc_sign_level_coeff_neighbor_array;
-    NeighborArrayUnit     *cr_dc_sign_level_coeff_neighbor_array = picture_control_set_ptr->cr_dc_sign_level_coeff_neighbor_array;
-    NeighborArrayUnit     *cb_dc_sign_level_coeff_neighbor_array = picture_control_set_ptr->cb_dc_sign_level_coeff_neighbor_array;
-    NeighborArrayUnit     *inter_pred_dir_neighbor_array = picture_control_set_ptr->inter_pred_dir_neighbor_array;
-    NeighborArrayUnit     *ref_frame_type_neighbor_array = picture_control_set_ptr->ref_frame_type_neighbor_array;
-    NeighborArrayUnit32   *interpolation_type_neighbor_array = picture_control_set_ptr->interpolation_type_neighbor_array;
+    NeighborArrayUnit     *mode_type_neighbor_array = context_ptr->tile_ptr->mode_type_neighbor_array;
+    NeighborArrayUnit     *partition_context_neighbor_array = context_ptr->tile_ptr->partition_context_neighbor_array;
+    NeighborArrayUnit     *skip_flag_neighbor_array = context_ptr->tile_ptr->skip_flag_neighbor_array;
+    NeighborArrayUnit     *skip_coeff_neighbor_array = context_ptr->tile_ptr->skip_coeff_neighbor_array;
+    NeighborArrayUnit     *luma_dc_sign_level_coeff_neighbor_array = context_ptr->tile_ptr->luma_dc_sign_level_coeff_neighbor_array;
+    NeighborArrayUnit     *cr_dc_sign_level_coeff_neighbor_array = context_ptr->tile_ptr->cr_dc_sign_level_coeff_neighbor_array;
+    NeighborArrayUnit     *cb_dc_sign_level_coeff_neighbor_array = context_ptr->tile_ptr->cb_dc_sign_level_coeff_neighbor_array;
+    NeighborArrayUnit     *inter_pred_dir_neighbor_array = context_ptr->tile_ptr->inter_pred_dir_neighbor_array;
+    NeighborArrayUnit     *ref_frame_type_neighbor_array = context_ptr->tile_ptr->ref_frame_type_neighbor_array;
+    NeighborArrayUnit32   *interpolation_type_neighbor_array = context_ptr->tile_ptr->interpolation_type_neighbor_array;
     const BlockGeom         *blk_geom = get_blk_geom_mds(cu_ptr->mds_idx);
     EbBool                   skipCoeff = EB_FALSE;
     PartitionContext         partition;
@@ -5781,11 +5795,11 @@ int eb_av1_neg_interleave(int x, int ref, int max) {
 }
 
 
-int av1_get_pred_context_seg_id(PictureControlSet *picture_control_set_ptr,
+int av1_get_pred_context_seg_id(EntropyCodingTile *tile_ptr,
                                 CodingUnit *cu_ptr,
                                 uint32_t blkOriginX,
                                 uint32_t blkOriginY) {
-    NeighborArrayUnit *seg_id_pred_neighbor_array = picture_control_set_ptr->segmentation_id_pred_array;
+    NeighborArrayUnit *seg_id_pred_neighbor_array = tile_ptr->segmentation_id_pred_array;
     uint32_t top_idx = get_neighbor_array_unit_top_index(seg_id_pred_neighbor_array, blkOriginX);
     uint32_t left_idx = get_neighbor_array_unit_left_index(seg_id_pred_neighbor_array, blkOriginY);
 
@@ -5794,13 +5808,13 @@ int av1_get_pred_context_seg_id(PictureControlSet *picture_control_set_ptr,
     return above_pred + left_pred;
 }
 
-AomCdfProb *av1_get_pred_cdf_seg_id(PictureControlSet *picture_control_set_ptr,
+AomCdfProb *av1_get_pred_cdf_seg_id(EntropyCodingTile *tile_ptr,
                                       FRAME_CONTEXT *frameContext,
                                       CodingUnit *cu_ptr,
                                       uint32_t blkOriginX,
                                       uint32_t blkOriginY) {
     struct segmentation_probs *segp = &frameContext->seg;
-    return segp->spatial_pred_seg_cdf[av1_get_pred_context_seg_id(picture_control_set_ptr, cu_ptr, blkOriginX, blkOriginY)];
+    return segp->spatial_pred_seg_cdf[av1_get_pred_context_seg_id(tile_ptr, cu_ptr, blkOriginX, blkOriginY)];
 }
 
 static INLINE void update_segmentation_map(PictureControlSet *picture_control_set_ptr,
@@ -5935,16 +5949,16 @@ EbErrorType write_modes_b(
     SequenceControlSet     *sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
     FrameHeader *frm_hdr = &picture_control_set_ptr->parent_pcs_ptr->frm_hdr;
 
-    NeighborArrayUnit     *mode_type_neighbor_array = picture_control_set_ptr->mode_type_neighbor_array;
-    NeighborArrayUnit     *intra_luma_mode_neighbor_array = picture_control_set_ptr->intra_luma_mode_neighbor_array;
-    NeighborArrayUnit     *skip_flag_neighbor_array = picture_control_set_ptr->skip_flag_neighbor_array;
-    NeighborArrayUnit     *skip_coeff_neighbor_array = picture_control_set_ptr->skip_coeff_neighbor_array;
-    NeighborArrayUnit     *luma_dc_sign_level_coeff_neighbor_array = picture_control_set_ptr->luma_dc_sign_level_coeff_neighbor_array;
-    NeighborArrayUnit     *cr_dc_sign_level_coeff_neighbor_array = picture_control_set_ptr->cr_dc_sign_level_coeff_neighbor_array;
-    NeighborArrayUnit     *cb_dc_sign_level_coeff_neighbor_array = picture_control_set_ptr->cb_dc_sign_level_coeff_neighbor_array;
-    NeighborArrayUnit     *ref_frame_type_neighbor_array = picture_control_set_ptr->ref_frame_type_neighbor_array;
-    NeighborArrayUnit32   *interpolation_type_neighbor_array = picture_control_set_ptr->interpolation_type_neighbor_array;
-    NeighborArrayUnit     *txfm_context_array = picture_control_set_ptr->txfm_context_array;
+    NeighborArrayUnit     *mode_type_neighbor_array = context_ptr->tile_ptr->mode_type_neighbor_array;
+    NeighborArrayUnit     *intra_luma_mode_neighbor_array = context_ptr->tile_ptr->intra_luma_mode_neighbor_array;
+    NeighborArrayUnit     *skip_flag_neighbor_array = context_ptr->tile_ptr->skip_flag_neighbor_array;
+    NeighborArrayUnit     *skip_coeff_neighbor_array = context_ptr->tile_ptr->skip_coeff_neighbor_array;
+    NeighborArrayUnit     *luma_dc_sign_level_coeff_neighbor_array = context_ptr->tile_ptr->luma_dc_sign_level_coeff_neighbor_array;
+    NeighborArrayUnit     *cr_dc_sign_level_coeff_neighbor_array = context_ptr->tile_ptr->cr_dc_sign_level_coeff_neighbor_array;
+    NeighborArrayUnit     *cb_dc_sign_level_coeff_neighbor_array = context_ptr->tile_ptr->cb_dc_sign_level_coeff_neighbor_array;
+    NeighborArrayUnit     *ref_frame_type_neighbor_array = context_ptr->tile_ptr->ref_frame_type_neighbor_array;
+    NeighborArrayUnit32   *interpolation_type_neighbor_array = context_ptr->tile_ptr->interpolation_type_neighbor_array;
+    NeighborArrayUnit     *txfm_context_array = context_ptr->tile_ptr->txfm_context_array;
     const BlockGeom          *blk_geom = get_blk_geom_mds(cu_ptr->mds_idx);
     uint32_t blkOriginX = context_ptr->sb_origin_x + blk_geom->origin_x;
     uint32_t blkOriginY = context_ptr->sb_origin_y + blk_geom->origin_y;
@@ -5997,6 +6011,7 @@ assert(bsize < BlockSizeS_ALL);
         write_cdef(
             sequence_control_set_ptr,
             picture_control_set_ptr,
+            context_ptr->tile_ptr,
             cu_ptr->av1xd,
             ec_writer,
             skipCoeff,
@@ -6022,7 +6037,7 @@ assert(bsize < BlockSizeS_ALL);
             if ((bsize != sequence_control_set_ptr->sb_size || skipCoeff == 0) && super_block_upper_left) {
 #endif
                 assert(current_q_index > 0);
-                int32_t reduced_delta_qindex = (current_q_index - picture_control_set_ptr->parent_pcs_ptr->prev_qindex) / frm_hdr->delta_q_params.delta_q_res;
+                int32_t reduced_delta_qindex = (current_q_index - context_ptr->tile_ptr->prev_qindex) / frm_hdr->delta_q_params.delta_q_res;
 
                 //write_delta_qindex(xd, reduced_delta_qindex, w);
                 Av1writeDeltaQindex(
@@ -6034,9 +6049,9 @@ assert(bsize < BlockSizeS_ALL);
                 blkOriginX,
                 blkOriginY,
                 current_q_index,
-                picture_control_set_ptr->parent_pcs_ptr->prev_qindex);
+                context_ptr->tile_ptr->prev_qindex);
                 }*/
-                picture_control_set_ptr->parent_pcs_ptr->prev_qindex = current_q_index;
+                context_ptr->tile_ptr->prev_qindex = current_q_index;
             }
         }
 #endif
@@ -6151,6 +6166,7 @@ assert(bsize < BlockSizeS_ALL);
         write_cdef(
             sequence_control_set_ptr,
             picture_control_set_ptr, /*cm,*/
+            context_ptr->tile_ptr,
             cu_ptr->av1xd,
             ec_writer,
             cu_ptr->skip_flag ? 1 : skipCoeff,
@@ -6174,12 +6190,12 @@ assert(bsize < BlockSizeS_ALL);
             if ((bsize != sequence_control_set_ptr->sb_size || skipCoeff == 0) && super_block_upper_left) {
 #endif
                 assert(current_q_index > 0);
-                int32_t reduced_delta_qindex = (current_q_index - picture_control_set_ptr->parent_pcs_ptr->prev_qindex) / frm_hdr->delta_q_params.delta_q_res;
+                int32_t reduced_delta_qindex = (current_q_index - context_ptr->tile_ptr->prev_qindex) / frm_hdr->delta_q_params.delta_q_res;
                 Av1writeDeltaQindex(
                     frameContext,
                     reduced_delta_qindex,
                     ec_writer);
-                picture_control_set_ptr->parent_pcs_ptr->prev_qindex = current_q_index;
+                context_ptr->tile_ptr->prev_qindex = current_q_index;
             }
         }
 
@@ -6494,7 +6510,7 @@ EB_EXTERN EbErrorType write_sb(
     FRAME_CONTEXT           *frameContext = entropy_coder_ptr->fc;
     AomWriter              *ec_writer = &entropy_coder_ptr->ec_writer;
     SequenceControlSet     *sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
-    NeighborArrayUnit     *partition_context_neighbor_array = picture_control_set_ptr->partition_context_neighbor_array;
+    NeighborArrayUnit     *partition_context_neighbor_array = context_ptr->tile_ptr->partition_context_neighbor_array;
 
     // CU Varaiables
     const BlockGeom          *blk_geom;
@@ -6561,7 +6577,7 @@ EB_EXTERN EbErrorType write_sb(
                                 const int32_t runit_idx = tile_tl_idx + rcol + rrow * rstride;
                                 const RestorationUnitInfo *rui =
                                     &cm->rst_info[plane].unit_info[runit_idx];
-                                loop_restoration_write_sb_coeffs(picture_control_set_ptr, frameContext, cm, /*xd,*/ rui, ec_writer, plane);
+                                loop_restoration_write_sb_coeffs(context_ptr->tile_ptr, frameContext, cm, /*xd,*/ rui, ec_writer, plane);
                             }
                         }
                     }
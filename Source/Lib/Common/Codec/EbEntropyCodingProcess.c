@@ -20,13 +20,12 @@
 #include "EbEncDecResults.h"
 #include "EbEntropyCodingResults.h"
 #include "EbRateControlTasks.h"
+#include "EbTrace.h"
+#include "EbSvtAv1ErrorCodes.h"
 #if ENABLE_CDF_UPDATE
 #include "EbCabacContextModel.h"
 #endif
-#define  AV1_MIN_TILE_SIZE_BYTES 1
-void eb_av1_reset_loop_restoration(PictureControlSet     *piCSetPtr);
-void eb_av1_tile_set_col(TileInfo *tile, PictureParentControlSet * pcs_ptr, int col);
-void eb_av1_tile_set_row(TileInfo *tile, PictureParentControlSet * pcs_ptr, int row);
+void eb_av1_reset_loop_restoration(EntropyCodingTile     *tile_ptr);
 
 /******************************************************
  * Enc Dec Context Constructor
@@ -51,25 +50,25 @@ EbErrorType entropy_coding_context_ctor(
 /***********************************************
  * Entropy Coding Reset Neighbor Arrays
  ***********************************************/
-static void EntropyCodingResetNeighborArrays(PictureControlSet *picture_control_set_ptr)
+static void EntropyCodingResetNeighborArrays(EntropyCodingTile *tile_ptr)
 {
-    neighbor_array_unit_reset(picture_control_set_ptr->mode_type_neighbor_array);
+    neighbor_array_unit_reset(tile_ptr->mode_type_neighbor_array);
 
-    neighbor_array_unit_reset(picture_control_set_ptr->partition_context_neighbor_array);
+    neighbor_array_unit_reset(tile_ptr->partition_context_neighbor_array);
 
-    neighbor_array_unit_reset(picture_control_set_ptr->skip_flag_neighbor_array);
+    neighbor_array_unit_reset(tile_ptr->skip_flag_neighbor_array);
 
-    neighbor_array_unit_reset(picture_control_set_ptr->skip_coeff_neighbor_array);
-    neighbor_array_unit_reset(picture_control_set_ptr->luma_dc_sign_level_coeff_neighbor_array);
-    neighbor_array_unit_reset(picture_control_set_ptr->cb_dc_sign_level_coeff_neighbor_array);
-    neighbor_array_unit_reset(picture_control_set_ptr->cr_dc_sign_level_coeff_neighbor_array);
-    neighbor_array_unit_reset(picture_control_set_ptr->inter_pred_dir_neighbor_array);
-    neighbor_array_unit_reset(picture_control_set_ptr->ref_frame_type_neighbor_array);
+    neighbor_array_unit_reset(tile_ptr->skip_coeff_neighbor_array);
+    neighbor_array_unit_reset(tile_ptr->luma_dc_sign_level_coeff_neighbor_array);
+    neighbor_array_unit_reset(tile_ptr->cb_dc_sign_level_coeff_neighbor_array);
+    neighbor_array_unit_reset(tile_ptr->cr_dc_sign_level_coeff_neighbor_array);
+    neighbor_array_unit_reset(tile_ptr->inter_pred_dir_neighbor_array);
+    neighbor_array_unit_reset(tile_ptr->ref_frame_type_neighbor_array);
 
-    neighbor_array_unit_reset(picture_control_set_ptr->intra_luma_mode_neighbor_array);
-    neighbor_array_unit_reset32(picture_control_set_ptr->interpolation_type_neighbor_array);
-    neighbor_array_unit_reset(picture_control_set_ptr->txfm_context_array);
-    neighbor_array_unit_reset(picture_control_set_ptr->segmentation_id_pred_array);
+    neighbor_array_unit_reset(tile_ptr->intra_luma_mode_neighbor_array);
+    neighbor_array_unit_reset32(tile_ptr->interpolation_type_neighbor_array);
+    neighbor_array_unit_reset(tile_ptr->txfm_context_array);
+    neighbor_array_unit_reset(tile_ptr->segmentation_id_pred_array);
     return;
 }
 
@@ -199,7 +198,7 @@ static void ResetEntropyCodingPicture(
 #endif
 
 #if ADD_DELTA_QP_SUPPORT
-    picture_control_set_ptr->parent_pcs_ptr->prev_qindex = picture_control_set_ptr->parent_pcs_ptr->frm_hdr.quantization_params.base_q_idx;
+    context_ptr->tile_ptr->prev_qindex = picture_control_set_ptr->parent_pcs_ptr->frm_hdr.quantization_params.base_q_idx;
     if (picture_control_set_ptr->parent_pcs_ptr->frm_hdr.allow_intrabc)
         assert(picture_control_set_ptr->parent_pcs_ptr->frm_hdr.delta_lf_params.delta_lf_present == 0);
     if (picture_control_set_ptr->parent_pcs_ptr->frm_hdr.delta_lf_params.delta_lf_present) {
@@ -215,11 +214,10 @@ static void ResetEntropyCodingPicture(
     OutputBitstreamUnit *output_bitstream_ptr = (OutputBitstreamUnit*)(picture_control_set_ptr->entropy_coder_ptr->ec_output_bitstream_ptr);
     //****************************************************************//
 
-    uint8_t *data = output_bitstream_ptr->buffer_av1;
     picture_control_set_ptr->entropy_coder_ptr->ec_writer.allow_update_cdf = !picture_control_set_ptr->parent_pcs_ptr->large_scale_tile;
     picture_control_set_ptr->entropy_coder_ptr->ec_writer.allow_update_cdf =
         picture_control_set_ptr->entropy_coder_ptr->ec_writer.allow_update_cdf && !frm_hdr->disable_cdf_update;
-    aom_start_encode(&picture_control_set_ptr->entropy_coder_ptr->ec_writer, data);
+    aom_start_encode_bitstream(&picture_control_set_ptr->entropy_coder_ptr->ec_writer, output_bitstream_ptr);
 
     // ADD Reset here
 #if ENABLE_CDF_UPDATE
@@ -238,19 +236,24 @@ static void ResetEntropyCodingPicture(
         entropyCodingQp,
         picture_control_set_ptr->slice_type);
 #endif
-    EntropyCodingResetNeighborArrays(picture_control_set_ptr);
+    EntropyCodingResetNeighborArrays(context_ptr->tile_ptr);
 
     return;
 }
 
+/**************************************************
+ * Reset Entropy Coding Tile
+ *   Each tile is coded into the buffer of its own
+ *   entropy coder, from the picture's initial CDFs
+ **************************************************/
 static void reset_ec_tile(
-    uint32_t  total_size,
-    uint32_t  is_last_tile_in_tg,
     EntropyCodingContext  *context_ptr,
     PictureControlSet     *picture_control_set_ptr,
     SequenceControlSet    *sequence_control_set_ptr)
 {
-    reset_bitstream(entropy_coder_get_bitstream_ptr(picture_control_set_ptr->entropy_coder_ptr));
+    EntropyCodingTile *tile_ptr = context_ptr->tile_ptr;
+    EntropyCoder *entropy_coder_ptr = tile_ptr->entropy_coder_ptr;
+    reset_bitstream(entropy_coder_get_bitstream_ptr(entropy_coder_ptr));
 
     uint32_t                       entropy_coding_qp;
 
@@ -281,51 +284,39 @@ static void reset_ec_tile(
 #endif
 
 #if ADD_DELTA_QP_SUPPORT
-    picture_control_set_ptr->parent_pcs_ptr->prev_qindex = picture_control_set_ptr->parent_pcs_ptr->frm_hdr.quantization_params.base_q_idx;
-    if (picture_control_set_ptr->parent_pcs_ptr->frm_hdr.allow_intrabc)
-        assert(picture_control_set_ptr->parent_pcs_ptr->frm_hdr.delta_lf_params.delta_lf_present == 0);
-    if (picture_control_set_ptr->parent_pcs_ptr->frm_hdr.delta_lf_params.delta_lf_present) {
-        picture_control_set_ptr->parent_pcs_ptr->prev_delta_lf_from_base = 0;
-        const int32_t frame_lf_count =
-            picture_control_set_ptr->parent_pcs_ptr->monochrome == 0 ? FRAME_LF_COUNT : FRAME_LF_COUNT - 2;
-        for (int32_t lf_id = 0; lf_id < frame_lf_count; ++lf_id)
-            picture_control_set_ptr->parent_pcs_ptr->prev_delta_lf[lf_id] = 0;
-    }
+    tile_ptr->prev_qindex = picture_control_set_ptr->parent_pcs_ptr->frm_hdr.quantization_params.base_q_idx;
 #endif
 
     // pass the ent
-    OutputBitstreamUnit *output_bitstream_ptr = (OutputBitstreamUnit*)(picture_control_set_ptr->entropy_coder_ptr->ec_output_bitstream_ptr);
+    OutputBitstreamUnit *output_bitstream_ptr = (OutputBitstreamUnit*)(entropy_coder_ptr->ec_output_bitstream_ptr);
     //****************************************************************//
 
-    uint8_t *data = output_bitstream_ptr->buffer_av1 + total_size;
-    picture_control_set_ptr->entropy_coder_ptr->ec_writer.allow_update_cdf = !picture_control_set_ptr->parent_pcs_ptr->large_scale_tile;
-    picture_control_set_ptr->entropy_coder_ptr->ec_writer.allow_update_cdf =
-        picture_control_set_ptr->entropy_coder_ptr->ec_writer.allow_update_cdf && !frm_hdr->disable_cdf_update;
-
-    //if not last tile, advance buffer by 4B to leave space for tile Size
-    if (is_last_tile_in_tg == 0)
-        data += 4;
+    // The tile size fields are written by the packetization
+    entropy_coder_ptr->ec_writer.allow_update_cdf = !picture_control_set_ptr->parent_pcs_ptr->large_scale_tile;
+    entropy_coder_ptr->ec_writer.allow_update_cdf =
+        entropy_coder_ptr->ec_writer.allow_update_cdf && !frm_hdr->disable_cdf_update;
 
-    aom_start_encode(&picture_control_set_ptr->entropy_coder_ptr->ec_writer, data);
+    aom_start_encode_bitstream(&entropy_coder_ptr->ec_writer, output_bitstream_ptr);
 #if ENABLE_CDF_UPDATE
     if (picture_control_set_ptr->parent_pcs_ptr->frm_hdr.primary_ref_frame != PRIMARY_REF_NONE)
-        memcpy(picture_control_set_ptr->entropy_coder_ptr->fc, &picture_control_set_ptr->ref_frame_context[picture_control_set_ptr->parent_pcs_ptr->frm_hdr.primary_ref_frame], sizeof(FRAME_CONTEXT));
+        memcpy(entropy_coder_ptr->fc, &picture_control_set_ptr->ref_frame_context[picture_control_set_ptr->parent_pcs_ptr->frm_hdr.primary_ref_frame], sizeof(FRAME_CONTEXT));
     else
         //reset probabilities
         reset_entropy_coder(
             sequence_control_set_ptr->encode_context_ptr,
-            picture_control_set_ptr->entropy_coder_ptr,
+            entropy_coder_ptr,
             entropy_coding_qp,
             picture_control_set_ptr->slice_type);
 #else
     //reset probabilities
     reset_entropy_coder(
         sequence_control_set_ptr->encode_context_ptr,
-        picture_control_set_ptr->entropy_coder_ptr,
+        entropy_coder_ptr,
         entropy_coding_qp,
         picture_control_set_ptr->slice_type);
 #endif
-    EntropyCodingResetNeighborArrays(picture_control_set_ptr);
+    EntropyCodingResetNeighborArrays(tile_ptr);
+    eb_av1_reset_loop_restoration(tile_ptr);
 
     return;
 }
@@ -440,9 +431,9 @@ static EbBool UpdateEntropyCodingRows(
 }
 
 /******************************************************
- * Entropy Coding Kernel
+ * Entropy Coding Task
  ******************************************************/
-void* entropy_coding_kernel(void *input_ptr)
+void entropy_coding_task(void *input_ptr, EbObjectWrapper *encDecResultsWrapperPtr)
 {
     // Context & SCS & PCS
     EntropyCodingContext                  *context_ptr = (EntropyCodingContext*)input_ptr;
@@ -450,8 +441,7 @@ void* entropy_coding_kernel(void *input_ptr)
     SequenceControlSet                    *sequence_control_set_ptr;
 
     // Input
-    EbObjectWrapper                       *encDecResultsWrapperPtr;
-    EncDecResults                         *encDecResultsPtr;
+    RestResults                           *rest_results_ptr;
 
     // Output
     EbObjectWrapper                       *entropyCodingResultsWrapperPtr;
@@ -469,249 +459,241 @@ void* entropy_coding_kernel(void *input_ptr)
     uint32_t                                   picture_width_in_sb;
     // Variables
     EbBool                                  initialProcessCall;
-    for (;;) {
-        // Get Mode Decision Results
-        eb_get_full_object(
-            context_ptr->enc_dec_input_fifo_ptr,
-            &encDecResultsWrapperPtr);
-        encDecResultsPtr = (EncDecResults*)encDecResultsWrapperPtr->object_ptr;
-        picture_control_set_ptr = (PictureControlSet*)encDecResultsPtr->picture_control_set_wrapper_ptr->object_ptr;
-        sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
-        // SB Constants
 
-        sb_sz = (uint8_t)sequence_control_set_ptr->sb_size_pix;
+    rest_results_ptr = (RestResults*)encDecResultsWrapperPtr->object_ptr;
+    picture_control_set_ptr = (PictureControlSet*)rest_results_ptr->picture_control_set_wrapper_ptr->object_ptr;
+    eb_trace_set_object(picture_control_set_ptr->picture_number, EB_TRACE_NO_SEGMENT);
+    sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
+    // SB Constants
 
-        lcuSizeLog2 = (uint8_t)Log2f(sb_sz);
-        context_ptr->sb_sz = sb_sz;
-        picture_width_in_sb = (sequence_control_set_ptr->seq_header.max_frame_width + sb_sz - 1) >> lcuSizeLog2;
-        if(picture_control_set_ptr->parent_pcs_ptr->av1_cm->tiles_info.tile_cols * picture_control_set_ptr->parent_pcs_ptr->av1_cm->tiles_info.tile_rows == 1)
+    sb_sz = (uint8_t)sequence_control_set_ptr->sb_size_pix;
 
-        {
-            initialProcessCall = EB_TRUE;
-            y_lcu_index = encDecResultsPtr->completed_lcu_row_index_start;
+    lcuSizeLog2 = (uint8_t)Log2f(sb_sz);
+    context_ptr->sb_sz = sb_sz;
+    picture_width_in_sb = (sequence_control_set_ptr->seq_header.max_frame_width + sb_sz - 1) >> lcuSizeLog2;
+    if(picture_control_set_ptr->parent_pcs_ptr->av1_cm->tiles_info.tile_cols * picture_control_set_ptr->parent_pcs_ptr->av1_cm->tiles_info.tile_rows == 1)
 
-            // LCU-loops
-            while (UpdateEntropyCodingRows(picture_control_set_ptr, &y_lcu_index, encDecResultsPtr->completed_lcu_row_count, &initialProcessCall) == EB_TRUE)
-            {
-                uint32_t rowTotalBits = 0;
+    {
+        initialProcessCall = EB_TRUE;
+        y_lcu_index = rest_results_ptr->completed_lcu_row_index_start;
+        context_ptr->tile_ptr = picture_control_set_ptr->ec_tile_ptr_array[0];
 
-                if (y_lcu_index == 0) {
-                    ResetEntropyCodingPicture(
-                        context_ptr,
-                        picture_control_set_ptr,
-                        sequence_control_set_ptr);
-                    picture_control_set_ptr->entropy_coding_pic_done = EB_FALSE;
-                }
+        // LCU-loops
+        while (UpdateEntropyCodingRows(picture_control_set_ptr, &y_lcu_index, rest_results_ptr->completed_lcu_row_count, &initialProcessCall) == EB_TRUE)
+        {
+            uint32_t rowTotalBits = 0;
+
+            if (y_lcu_index == 0) {
+                ResetEntropyCodingPicture(
+                    context_ptr,
+                    picture_control_set_ptr,
+                    sequence_control_set_ptr);
+                picture_control_set_ptr->entropy_coding_pic_done = EB_FALSE;
+            }
 
-                for (x_lcu_index = 0; x_lcu_index < picture_width_in_sb; ++x_lcu_index)
-                {
-                    sb_index = (uint16_t)(x_lcu_index + y_lcu_index * picture_width_in_sb);
-                    sb_ptr = picture_control_set_ptr->sb_ptr_array[sb_index];
-
-                    sb_origin_x = x_lcu_index << lcuSizeLog2;
-                    sb_origin_y = y_lcu_index << lcuSizeLog2;
-                    context_ptr->sb_origin_x = sb_origin_x;
-                    context_ptr->sb_origin_y = sb_origin_y;
-                    if (sb_index == 0)
-                        eb_av1_reset_loop_restoration(picture_control_set_ptr);
+            for (x_lcu_index = 0; x_lcu_index < picture_width_in_sb; ++x_lcu_index)
+            {
+                sb_index = (uint16_t)(x_lcu_index + y_lcu_index * picture_width_in_sb);
+                sb_ptr = picture_control_set_ptr->sb_ptr_array[sb_index];
+
+                sb_origin_x = x_lcu_index << lcuSizeLog2;
+                sb_origin_y = y_lcu_index << lcuSizeLog2;
+                context_ptr->sb_origin_x = sb_origin_x;
+                context_ptr->sb_origin_y = sb_origin_y;
+                if (sb_index == 0)
+                    eb_av1_reset_loop_restoration(context_ptr->tile_ptr);
 #if !QPM
-                    // Configure the LCU
-                    EntropyCodingConfigureLcu(
-                        context_ptr,
-                        sb_ptr,
-                        picture_control_set_ptr);
+                // Configure the LCU
+                EntropyCodingConfigureLcu(
+                    context_ptr,
+                    sb_ptr,
+                    picture_control_set_ptr);
 #endif
-                    sb_ptr->total_bits = 0;
-                    uint32_t prev_pos = sb_index ? picture_control_set_ptr->entropy_coder_ptr->ec_writer.ec.offs : 0;//residual_bc.pos
-                    EbPictureBufferDesc *coeff_picture_ptr = sb_ptr->quantized_coeff;
-                    write_sb(
-                        context_ptr,
-                        sb_ptr,
-                        picture_control_set_ptr,
-                        picture_control_set_ptr->entropy_coder_ptr,
-                        coeff_picture_ptr);
-                    sb_ptr->total_bits = (picture_control_set_ptr->entropy_coder_ptr->ec_writer.ec.offs - prev_pos) << 3;
-                    picture_control_set_ptr->parent_pcs_ptr->quantized_coeff_num_bits += sb_ptr->total_bits;
-                    rowTotalBits += sb_ptr->total_bits;
-                }
-
-                // At the end of each LCU-row, send the updated bit-count to Entropy Coding
+                sb_ptr->total_bits = 0;
+                uint32_t prev_pos = sb_index ? picture_control_set_ptr->entropy_coder_ptr->ec_writer.ec.offs : 0;//residual_bc.pos
+                EbPictureBufferDesc *coeff_picture_ptr = sb_ptr->quantized_coeff;
+                write_sb(
+                    context_ptr,
+                    sb_ptr,
+                    picture_control_set_ptr,
+                    picture_control_set_ptr->entropy_coder_ptr,
+                    coeff_picture_ptr);
+                sb_ptr->total_bits = (picture_control_set_ptr->entropy_coder_ptr->ec_writer.ec.offs - prev_pos) << 3;
+                picture_control_set_ptr->parent_pcs_ptr->quantized_coeff_num_bits += sb_ptr->total_bits;
+                rowTotalBits += sb_ptr->total_bits;
+            }
+
+            // At the end of each LCU-row, send the updated bit-count to Entropy Coding
+            {
+                EbObjectWrapper *rateControlTaskWrapperPtr;
+                RateControlTasks *rateControlTaskPtr;
+
+                // Get Empty EncDec Results
+                eb_get_empty_object(
+                    context_ptr->rate_control_output_fifo_ptr,
+                    &rateControlTaskWrapperPtr);
+                rateControlTaskPtr = (RateControlTasks*)rateControlTaskWrapperPtr->object_ptr;
+                rateControlTaskPtr->task_type = RC_ENTROPY_CODING_ROW_FEEDBACK_RESULT;
+                rateControlTaskPtr->picture_number = picture_control_set_ptr->picture_number;
+                rateControlTaskPtr->row_number = y_lcu_index;
+                rateControlTaskPtr->bit_count = rowTotalBits;
+
+                rateControlTaskPtr->picture_control_set_wrapper_ptr = 0;
+                rateControlTaskPtr->segment_index = ~0u;
+
+                // Post EncDec Results
+                eb_post_full_object(rateControlTaskWrapperPtr);
+            }
+
+            eb_block_on_mutex(picture_control_set_ptr->entropy_coding_mutex);
+            if (picture_control_set_ptr->entropy_coding_pic_done == EB_FALSE) {
+                // If the picture is complete, terminate the slice
+                if (picture_control_set_ptr->entropy_coding_current_row == picture_control_set_ptr->entropy_coding_row_count)
                 {
-                    EbObjectWrapper *rateControlTaskWrapperPtr;
-                    RateControlTasks *rateControlTaskPtr;
+                    uint32_t ref_idx;
 
-                    // Get Empty EncDec Results
-                    eb_get_empty_object(
-                        context_ptr->rate_control_output_fifo_ptr,
-                        &rateControlTaskWrapperPtr);
-                    rateControlTaskPtr = (RateControlTasks*)rateControlTaskWrapperPtr->object_ptr;
-                    rateControlTaskPtr->task_type = RC_ENTROPY_CODING_ROW_FEEDBACK_RESULT;
-                    rateControlTaskPtr->picture_number = picture_control_set_ptr->picture_number;
-                    rateControlTaskPtr->row_number = y_lcu_index;
-                    rateControlTaskPtr->bit_count = rowTotalBits;
-
-                    rateControlTaskPtr->picture_control_set_wrapper_ptr = 0;
-                    rateControlTaskPtr->segment_index = ~0u;
-
-                    // Post EncDec Results
-                    eb_post_full_object(rateControlTaskWrapperPtr);
-                }
-
-                eb_block_on_mutex(picture_control_set_ptr->entropy_coding_mutex);
-                if (picture_control_set_ptr->entropy_coding_pic_done == EB_FALSE) {
-                    // If the picture is complete, terminate the slice
-                    if (picture_control_set_ptr->entropy_coding_current_row == picture_control_set_ptr->entropy_coding_row_count)
-                    {
-                        uint32_t ref_idx;
-
-                        picture_control_set_ptr->entropy_coding_pic_done = EB_TRUE;
-
-                        encode_slice_finish(picture_control_set_ptr->entropy_coder_ptr);
-
-                        // Release the List 0 Reference Pictures
-                        for (ref_idx = 0; ref_idx < picture_control_set_ptr->parent_pcs_ptr->ref_list0_count; ++ref_idx) {
-                            if (picture_control_set_ptr->ref_pic_ptr_array[0][ref_idx] != EB_NULL) {
-
-                                eb_release_object(picture_control_set_ptr->ref_pic_ptr_array[0][ref_idx]);
-                            }
-                        }
+                    picture_control_set_ptr->entropy_coding_pic_done = EB_TRUE;
+
+                    CHECK_REPORT_ERROR(
+                        encode_slice_finish(picture_control_set_ptr->entropy_coder_ptr) == EB_ErrorNone,
+                        sequence_control_set_ptr->encode_context_ptr->app_callback_ptr,
+                        EB_ENC_EC_ERROR3);
+
+                    // Release the List 0 Reference Pictures
+                    for (ref_idx = 0; ref_idx < picture_control_set_ptr->parent_pcs_ptr->ref_list0_count; ++ref_idx) {
+                        if (picture_control_set_ptr->ref_pic_ptr_array[0][ref_idx] != EB_NULL) {
 
-                        // Release the List 1 Reference Pictures
-                        for (ref_idx = 0; ref_idx < picture_control_set_ptr->parent_pcs_ptr->ref_list1_count; ++ref_idx) {
-                            if (picture_control_set_ptr->ref_pic_ptr_array[1][ref_idx] != EB_NULL)
-                                eb_release_object(picture_control_set_ptr->ref_pic_ptr_array[1][ref_idx]);
+                            eb_release_object(picture_control_set_ptr->ref_pic_ptr_array[0][ref_idx]);
                         }
+                    }
 
-                        // Get Empty Entropy Coding Results
-                        eb_get_empty_object(
-                            context_ptr->entropy_coding_output_fifo_ptr,
-                            &entropyCodingResultsWrapperPtr);
-                        entropyCodingResultsPtr = (EntropyCodingResults*)entropyCodingResultsWrapperPtr->object_ptr;
-                        entropyCodingResultsPtr->picture_control_set_wrapper_ptr = encDecResultsPtr->picture_control_set_wrapper_ptr;
-
-                        // Post EntropyCoding Results
-                        eb_post_full_object(entropyCodingResultsWrapperPtr);
-                    } // End if(PictureCompleteFlag)
-                }
-                eb_release_mutex(picture_control_set_ptr->entropy_coding_mutex);
+                    // Release the List 1 Reference Pictures
+                    for (ref_idx = 0; ref_idx < picture_control_set_ptr->parent_pcs_ptr->ref_list1_count; ++ref_idx) {
+                        if (picture_control_set_ptr->ref_pic_ptr_array[1][ref_idx] != EB_NULL)
+                            eb_release_object(picture_control_set_ptr->ref_pic_ptr_array[1][ref_idx]);
+                    }
+
+                    // Get Empty Entropy Coding Results
+                    eb_get_empty_object(
+                        context_ptr->entropy_coding_output_fifo_ptr,
+                        &entropyCodingResultsWrapperPtr);
+                    entropyCodingResultsPtr = (EntropyCodingResults*)entropyCodingResultsWrapperPtr->object_ptr;
+                    entropyCodingResultsPtr->picture_control_set_wrapper_ptr = rest_results_ptr->picture_control_set_wrapper_ptr;
+
+                    // Post EntropyCoding Results
+                    eb_post_full_object(entropyCodingResultsWrapperPtr);
+                } // End if(PictureCompleteFlag)
             }
+            eb_release_mutex(picture_control_set_ptr->entropy_coding_mutex);
         }
-        else
+    }
+    else
+    {
+        // Each task codes one tile, into the entropy coder of the tile
+        struct PictureParentControlSet     *ppcs_ptr = picture_control_set_ptr->parent_pcs_ptr;
+        Av1Common *const cm = ppcs_ptr->av1_cm;
+        const int tile_cols = cm->tiles_info.tile_cols;
+        const int tile_rows = cm->tiles_info.tile_rows;
+        const int tile_idx = rest_results_ptr->tile_index;
+        const int tile_row = tile_idx / tile_cols;
+        const int tile_col = tile_idx % tile_cols;
+        uint64_t tile_total_bits = 0;
+
+        assert(tile_idx < picture_control_set_ptr->ec_tile_max_count);
+        context_ptr->tile_ptr = picture_control_set_ptr->ec_tile_ptr_array[tile_idx];
+        EntropyCoder *entropy_coder_ptr = context_ptr->tile_ptr->entropy_coder_ptr;
+        reset_ec_tile(
+            context_ptr,
+            picture_control_set_ptr,
+            sequence_control_set_ptr);
+
+        for (y_lcu_index = cm->tiles_info.tile_row_start_sb[tile_row]; y_lcu_index < (uint32_t)cm->tiles_info.tile_row_start_sb[tile_row + 1]; ++y_lcu_index)
         {
-             struct PictureParentControlSet     *ppcs_ptr = picture_control_set_ptr->parent_pcs_ptr;
-             Av1Common *const cm = ppcs_ptr->av1_cm;
-             uint32_t total_size = 0;
-             int tile_row, tile_col;
-             const int tile_cols = ppcs_ptr->av1_cm->tiles_info.tile_cols;
-             const int tile_rows = ppcs_ptr->av1_cm->tiles_info.tile_rows;
-
-             //Entropy Tile Loop
-             for (tile_row = 0; tile_row < tile_rows; tile_row++)
-             {
-                 TileInfo tile_info;
-                 eb_av1_tile_set_row(&tile_info, ppcs_ptr, tile_row);
-
-                 for (tile_col = 0; tile_col < tile_cols; tile_col++)
-                 {
-                     const int tile_idx = tile_row * tile_cols + tile_col;
-                     uint32_t is_last_tile_in_tg = 0;
-
-                     if ( tile_idx == (tile_cols * tile_rows - 1))
-                         is_last_tile_in_tg = 1;
-                     else
-                         is_last_tile_in_tg = 0;
-                     reset_ec_tile(
-                         total_size,
-                         is_last_tile_in_tg,
-                         context_ptr,
-                         picture_control_set_ptr,
-                         sequence_control_set_ptr);
-
-                     eb_av1_tile_set_col(&tile_info, ppcs_ptr, tile_col);
-
-                     eb_av1_reset_loop_restoration(picture_control_set_ptr);
-
-                     for (y_lcu_index = cm->tiles_info.tile_row_start_sb[tile_row]; y_lcu_index < (uint32_t)cm->tiles_info.tile_row_start_sb[tile_row + 1]; ++y_lcu_index)
-                     {
-                         for (x_lcu_index = cm->tiles_info.tile_col_start_sb[tile_col]; x_lcu_index < (uint32_t)cm->tiles_info.tile_col_start_sb[tile_col + 1]; ++x_lcu_index)
-                         {
-                             int sb_index = (uint16_t)(x_lcu_index + y_lcu_index * picture_width_in_sb);
-                             sb_ptr = picture_control_set_ptr->sb_ptr_array[sb_index];
-                             sb_origin_x = x_lcu_index << lcuSizeLog2;
-                             sb_origin_y = y_lcu_index << lcuSizeLog2;
-                             context_ptr->sb_origin_x = sb_origin_x;
-                             context_ptr->sb_origin_y = sb_origin_y;
+            for (x_lcu_index = cm->tiles_info.tile_col_start_sb[tile_col]; x_lcu_index < (uint32_t)cm->tiles_info.tile_col_start_sb[tile_col + 1]; ++x_lcu_index)
+            {
+                int sb_index = (uint16_t)(x_lcu_index + y_lcu_index * picture_width_in_sb);
+                sb_ptr = picture_control_set_ptr->sb_ptr_array[sb_index];
+                sb_origin_x = x_lcu_index << lcuSizeLog2;
+                sb_origin_y = y_lcu_index << lcuSizeLog2;
+                context_ptr->sb_origin_x = sb_origin_x;
+                context_ptr->sb_origin_y = sb_origin_y;
 #if !QPM
-                             // Configure the LCU
-                             EntropyCodingConfigureLcu(
-                                 context_ptr,
-                                 sb_ptr,
-                                 picture_control_set_ptr);
+                // Configure the LCU
+                EntropyCodingConfigureLcu(
+                    context_ptr,
+                    sb_ptr,
+                    picture_control_set_ptr);
 #endif
-                             sb_ptr->total_bits = 0;
-                             uint32_t prev_pos = sb_index ? picture_control_set_ptr->entropy_coder_ptr->ec_writer.ec.offs : 0;//residual_bc.pos
-                             EbPictureBufferDesc *coeff_picture_ptr = sb_ptr->quantized_coeff;
-                             write_sb(
-                                 context_ptr,
-                                 sb_ptr,
-                                 picture_control_set_ptr,
-                                 picture_control_set_ptr->entropy_coder_ptr,
-                                 coeff_picture_ptr);
-                             sb_ptr->total_bits = (picture_control_set_ptr->entropy_coder_ptr->ec_writer.ec.offs - prev_pos) << 3;
-                             picture_control_set_ptr->parent_pcs_ptr->quantized_coeff_num_bits += sb_ptr->total_bits;
-                         }
-                     }
-
-                     encode_slice_finish(picture_control_set_ptr->entropy_coder_ptr);
-
-                     int tile_size = picture_control_set_ptr->entropy_coder_ptr->ec_writer.pos;
-                     assert(tile_size >= AV1_MIN_TILE_SIZE_BYTES);
-
-                     if (!is_last_tile_in_tg) {
-                         OutputBitstreamUnit *output_bitstream_ptr = (OutputBitstreamUnit*)(picture_control_set_ptr->entropy_coder_ptr->ec_output_bitstream_ptr);
-                         uint8_t *buf_data = output_bitstream_ptr->buffer_av1 + total_size;
-                         mem_put_le32(buf_data, tile_size - AV1_MIN_TILE_SIZE_BYTES);
-                     }
-
-                     if (is_last_tile_in_tg==0)
-                         total_size += 4;
-
-                     total_size += tile_size;
-                 }
-             }
-
-             //the picture is complete, terminate the slice
-             {
-                 uint32_t ref_idx;
-                 picture_control_set_ptr->entropy_coder_ptr->ec_frame_size = total_size;
-
-                 // Release the List 0 Reference Pictures
-                 for (ref_idx = 0; ref_idx < picture_control_set_ptr->parent_pcs_ptr->ref_list0_count; ++ref_idx) {
-                     if (picture_control_set_ptr->ref_pic_ptr_array[0][ref_idx] != EB_NULL)
-                         eb_release_object(picture_control_set_ptr->ref_pic_ptr_array[0][ref_idx]);
-                 }
-
-                 // Release the List 1 Reference Pictures
-                 for (ref_idx = 0; ref_idx < picture_control_set_ptr->parent_pcs_ptr->ref_list1_count; ++ref_idx) {
-                     if (picture_control_set_ptr->ref_pic_ptr_array[1][ref_idx] != EB_NULL)
-                         eb_release_object(picture_control_set_ptr->ref_pic_ptr_array[1][ref_idx]);
-                 }
-
-                 // Get Empty Entropy Coding Results
-                 eb_get_empty_object(
-                     context_ptr->entropy_coding_output_fifo_ptr,
-                     &entropyCodingResultsWrapperPtr);
-                 entropyCodingResultsPtr = (EntropyCodingResults*)entropyCodingResultsWrapperPtr->object_ptr;
-                 entropyCodingResultsPtr->picture_control_set_wrapper_ptr = encDecResultsPtr->picture_control_set_wrapper_ptr;
-
-                 // Post EntropyCoding Results
-                 eb_post_full_object(entropyCodingResultsWrapperPtr);
-             }
+                sb_ptr->total_bits = 0;
+                uint32_t prev_pos = entropy_coder_ptr->ec_writer.ec.offs;
+                EbPictureBufferDesc *coeff_picture_ptr = sb_ptr->quantized_coeff;
+                write_sb(
+                    context_ptr,
+                    sb_ptr,
+                    picture_control_set_ptr,
+                    entropy_coder_ptr,
+                    coeff_picture_ptr);
+                sb_ptr->total_bits = (entropy_coder_ptr->ec_writer.ec.offs - prev_pos) << 3;
+                tile_total_bits += sb_ptr->total_bits;
+            }
         }
 
-        // Release Mode Decision Results
-        eb_release_object(encDecResultsWrapperPtr);
+        CHECK_REPORT_ERROR(
+            encode_slice_finish(entropy_coder_ptr) == EB_ErrorNone,
+            sequence_control_set_ptr->encode_context_ptr->app_callback_ptr,
+            EB_ENC_EC_ERROR3);
+
+        eb_block_on_mutex(picture_control_set_ptr->entropy_coding_mutex);
+        ppcs_ptr->quantized_coeff_num_bits += tile_total_bits;
+        // The last tile coded completes the picture
+        if (++picture_control_set_ptr->ec_tile_coded_count == tile_cols * tile_rows)
+        {
+            uint32_t ref_idx;
+
+            // Release the List 0 Reference Pictures
+            for (ref_idx = 0; ref_idx < picture_control_set_ptr->parent_pcs_ptr->ref_list0_count; ++ref_idx) {
+                if (picture_control_set_ptr->ref_pic_ptr_array[0][ref_idx] != EB_NULL)
+                    eb_release_object(picture_control_set_ptr->ref_pic_ptr_array[0][ref_idx]);
+            }
+
+            // Release the List 1 Reference Pictures
+            for (ref_idx = 0; ref_idx < picture_control_set_ptr->parent_pcs_ptr->ref_list1_count; ++ref_idx) {
+                if (picture_control_set_ptr->ref_pic_ptr_array[1][ref_idx] != EB_NULL)
+                    eb_release_object(picture_control_set_ptr->ref_pic_ptr_array[1][ref_idx]);
+            }
+
+            // Get Empty Entropy Coding Results
+            eb_get_empty_object(
+                context_ptr->entropy_coding_output_fifo_ptr,
+                &entropyCodingResultsWrapperPtr);
+            entropyCodingResultsPtr = (EntropyCodingResults*)entropyCodingResultsWrapperPtr->object_ptr;
+            entropyCodingResultsPtr->picture_control_set_wrapper_ptr = rest_results_ptr->picture_control_set_wrapper_ptr;
+
+            // Post EntropyCoding Results
+            eb_post_full_object(entropyCodingResultsWrapperPtr);
+        }
+        eb_release_mutex(picture_control_set_ptr->entropy_coding_mutex);
     }
 
+    // Release Mode Decision Results
+    eb_release_object(encDecResultsWrapperPtr);
+}
+
+/******************************************************
+ * Entropy Coding Kernel
+ ******************************************************/
+void* entropy_coding_kernel(void *input_ptr)
+{
+    EntropyCodingContext                  *context_ptr = (EntropyCodingContext*)input_ptr;
+    EbObjectWrapper                       *encDecResultsWrapperPtr;
+
+    for (;;) {
+        // Get Mode Decision Results
+        eb_get_full_object(
+            context_ptr->enc_dec_input_fifo_ptr,
+            &encDecResultsWrapperPtr);
+
+        entropy_coding_task(input_ptr, encDecResultsWrapperPtr);
+    }
     return EB_NULL;
 }
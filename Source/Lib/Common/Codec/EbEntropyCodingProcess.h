@@ -31,6 +31,7 @@ typedef struct EntropyCodingContext
     EbFifo                       *rate_control_output_fifo_ptr; // feedback to rate control
 
     uint32_t                        sb_total_count;
+    EntropyCodingTile              *tile_ptr; // tile coded by this thread
     // Lambda
 #if ADD_DELTA_QP_SUPPORT
 #if !QPM
@@ -88,5 +89,6 @@ extern EbErrorType entropy_coding_context_ctor(
     EbBool                   is16bit);
 
 extern void* entropy_coding_kernel(void *input_ptr);
+extern void entropy_coding_task(void *input_ptr, EbObjectWrapper *input_wrapper_ptr);
 
 #endif // EbEntropyCodingProcess_h
@@ -16,6 +16,7 @@
 #include "EbMotionEstimationContext.h"
 #include "EbUtility.h"
 #include "EbReferenceObject.h"
+#include "EbTrace.h"
 
 /**************************************
 * Macros
@@ -1316,6 +1317,7 @@ void* initial_rate_control_kernel(void *input_ptr)
         picture_control_set_ptr = (PictureParentControlSet*)inputResultsPtr->picture_control_set_wrapper_ptr->object_ptr;
 
         segment_index = inputResultsPtr->segment_index;
+        eb_trace_set_object(picture_control_set_ptr->picture_number, (int32_t)segment_index);
 
         // Set the segment mask
         SEGMENT_COMPLETION_MASK_SET(picture_control_set_ptr->me_segments_completion_mask, segment_index);
@@ -320,6 +320,19 @@ static int g_component_count;
 
 #endif //DEBUG_MEMORY_USAGE
 
+static EB_THREAD_LOCAL uint64_t thread_memory_size = 0;
+
+void eb_add_thread_memory(void* ptr, size_t size)
+{
+    if (ptr)
+        thread_memory_size += size;
+}
+
+uint64_t eb_get_thread_memory(void)
+{
+    return thread_memory_size;
+}
+
 void eb_print_memory_usage()
 {
 #ifdef DEBUG_MEMORY_USAGE
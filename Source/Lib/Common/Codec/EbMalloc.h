@@ -9,6 +9,7 @@
 
 #include "EbSvtAv1Enc.h"
 #include "EbDefinitions.h"
+#include "EbNuma.h"
 
 #ifndef NDEBUG
 #define DEBUG_MEMORY_USAGE
@@ -31,6 +32,18 @@ void eb_remove_mem_entry(void* ptr, EbPtrType type);
 
 #endif //DEBUG_MEMORY_USAGE
 
+// Bytes allocated by the calling thread through the macros below, used
+// to measure the size of the objects of a system resource. Frees are not
+// subtracted.
+#ifdef __cplusplus
+extern "C" {
+#endif
+void eb_add_thread_memory(void* ptr, size_t size);
+uint64_t eb_get_thread_memory(void);
+#ifdef __cplusplus
+}
+#endif
+
 #define EB_NO_THROW_ADD_MEM(p, size, type) \
     do { \
         if (!p) { \
@@ -57,6 +70,8 @@ void eb_remove_mem_entry(void* ptr, EbPtrType type);
     do { \
         void* p = malloc(size); \
         EB_NO_THROW_ADD_MEM(p, size, EB_N_PTR); \
+        eb_add_thread_memory(p, size); \
+        eb_numa_bind_memory(p, size); \
         *(void**)&(pointer) = p; \
     } while (0)
 
@@ -70,6 +85,8 @@ void eb_remove_mem_entry(void* ptr, EbPtrType type);
     do { \
         void* p = calloc(count, size); \
         EB_NO_THROW_ADD_MEM(p, count * size, EB_C_PTR); \
+        eb_add_thread_memory(p, count * size); \
+        eb_numa_bind_memory(p, count * size); \
         *(void**)&(pointer) = p; \
     } while (0)
 
@@ -151,6 +168,8 @@ void eb_remove_mem_entry(void* ptr, EbPtrType type);
     do {\
         void* p = _aligned_malloc(size,ALVALUE); \
         EB_ADD_MEM(p, size, EB_A_PTR); \
+        eb_add_thread_memory(p, size); \
+        eb_numa_bind_memory(p, size); \
         *(void**)&(pointer) = p; \
     } while (0)
 
@@ -166,6 +185,8 @@ void eb_remove_mem_entry(void* ptr, EbPtrType type);
         if (posix_memalign((void**)(&(pointer)), ALVALUE, size) != 0) \
             return EB_ErrorInsufficientResources; \
         EB_ADD_MEM(pointer, size, EB_A_PTR); \
+        eb_add_thread_memory(pointer, size); \
+        eb_numa_bind_memory(pointer, size); \
     } while (0)
 
 #define EB_FREE_ALIGNED(pointer) \
@@ -27,6 +27,7 @@
 #include "EbReferenceObject.h"
 #include "EbModeDecisionProcess.h"
 #include "av1me.h"
+#include "EbTrace.h"
 
 #define MAX_MESH_SPEED 5  // Max speed setting for mesh motion method
 static MeshPattern
@@ -1920,9 +1921,9 @@ void av1_setup_motion_field(
 }
 #endif
 /******************************************************
- * Mode Decision Configuration Kernel
+ * Mode Decision Configuration Task
  ******************************************************/
-void* mode_decision_configuration_kernel(void *input_ptr)
+void mode_decision_configuration_task(void *input_ptr, EbObjectWrapper *rateControlResultsWrapperPtr)
 {
     // Context & SCS & PCS
     ModeDecisionConfigurationContext         *context_ptr = (ModeDecisionConfigurationContext*)input_ptr;
@@ -1930,369 +1931,379 @@ void* mode_decision_configuration_kernel(void *input_ptr)
     SequenceControlSet                       *sequence_control_set_ptr;
     FrameHeader                              *frm_hdr;
     // Input
-    EbObjectWrapper                          *rateControlResultsWrapperPtr;
     RateControlResults                       *rateControlResultsPtr;
 
     // Output
     EbObjectWrapper                          *encDecTasksWrapperPtr;
     EncDecTasks                              *encDecTasksPtr;
 
-    for (;;) {
-        // Get RateControl Results
-        eb_get_full_object(
-            context_ptr->rate_control_input_fifo_ptr,
-            &rateControlResultsWrapperPtr);
-
-        rateControlResultsPtr = (RateControlResults*)rateControlResultsWrapperPtr->object_ptr;
-        picture_control_set_ptr = (PictureControlSet*)rateControlResultsPtr->picture_control_set_wrapper_ptr->object_ptr;
-        sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
+    rateControlResultsPtr = (RateControlResults*)rateControlResultsWrapperPtr->object_ptr;
+    picture_control_set_ptr = (PictureControlSet*)rateControlResultsPtr->picture_control_set_wrapper_ptr->object_ptr;
+    eb_trace_set_object(picture_control_set_ptr->picture_number, EB_TRACE_NO_SEGMENT);
+    sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
 #if MFMV_SUPPORT
-        if (picture_control_set_ptr->parent_pcs_ptr->frm_hdr.use_ref_frame_mvs)
-            av1_setup_motion_field(picture_control_set_ptr->parent_pcs_ptr->av1_cm, picture_control_set_ptr);
+    if (picture_control_set_ptr->parent_pcs_ptr->frm_hdr.use_ref_frame_mvs)
+        av1_setup_motion_field(picture_control_set_ptr->parent_pcs_ptr->av1_cm, picture_control_set_ptr);
 #endif
 
-        frm_hdr = &picture_control_set_ptr->parent_pcs_ptr->frm_hdr;
-
-        // Mode Decision Configuration Kernel Signal(s) derivation
-        signal_derivation_mode_decision_config_kernel_oq(
-            sequence_control_set_ptr,
-            picture_control_set_ptr,
-            context_ptr);
-
-        context_ptr->qp = picture_control_set_ptr->picture_qp;
-
-        picture_control_set_ptr->parent_pcs_ptr->average_qp = 0;
-        picture_control_set_ptr->intra_coded_area = 0;
-        // Compute picture and slice level chroma QP offsets
-        SetSliceAndPictureChromaQpOffsets( // HT done
-            picture_control_set_ptr);
-
-        // Compute Tc, and Beta offsets for a given picture
-        // Set reference cdef strength
-        set_reference_cdef_strength(
-            picture_control_set_ptr);
+    frm_hdr = &picture_control_set_ptr->parent_pcs_ptr->frm_hdr;
 
-        // Set reference sg ep
-        set_reference_sg_ep(
-            picture_control_set_ptr);
-        SetGlobalMotionField(
-            picture_control_set_ptr);
+    // Mode Decision Configuration Kernel Signal(s) derivation
+    signal_derivation_mode_decision_config_kernel_oq(
+        sequence_control_set_ptr,
+        picture_control_set_ptr,
+        context_ptr);
 
-        eb_av1_qm_init(
-            picture_control_set_ptr->parent_pcs_ptr);
-
-        Quants *const quants = &picture_control_set_ptr->parent_pcs_ptr->quants;
-        Dequants *const dequants = &picture_control_set_ptr->parent_pcs_ptr->deq;
-
-        eb_av1_set_quantizer(
-            picture_control_set_ptr->parent_pcs_ptr,
-            frm_hdr->quantization_params.base_q_idx);
-        eb_av1_build_quantizer(
-            (AomBitDepth)sequence_control_set_ptr->static_config.encoder_bit_depth,
-            frm_hdr->quantization_params.delta_q_y_dc,
-            frm_hdr->quantization_params.delta_q_u_dc,
-            frm_hdr->quantization_params.delta_q_u_ac,
-            frm_hdr->quantization_params.delta_q_v_dc,
-            frm_hdr->quantization_params.delta_q_v_ac,
-            quants,
-            dequants);
-
-        Quants *const quantsMd = &picture_control_set_ptr->parent_pcs_ptr->quantsMd;
-        Dequants *const dequantsMd = &picture_control_set_ptr->parent_pcs_ptr->deqMd;
-        eb_av1_build_quantizer(
-            picture_control_set_ptr->hbd_mode_decision ? AOM_BITS_10 : AOM_BITS_8,
-            frm_hdr->quantization_params.delta_q_y_dc,
-            frm_hdr->quantization_params.delta_q_u_dc,
-            frm_hdr->quantization_params.delta_q_u_ac,
-            frm_hdr->quantization_params.delta_q_v_dc,
-            frm_hdr->quantization_params.delta_q_v_ac,
-            quantsMd,
-            dequantsMd);
-
-        // Hsan: collapse spare code
-        MdRateEstimationContext   *md_rate_estimation_array;
-        uint32_t                     entropyCodingQp;
-
-        // QP
-        context_ptr->qp = picture_control_set_ptr->picture_qp;
-
-        // QP Index
-        context_ptr->qp_index = (uint8_t)frm_hdr->quantization_params.base_q_idx;
-
-        // Lambda Assignement
-        uint32_t lambdaSse;
-        uint32_t lambdaSad;
-        (*av1_lambda_assignment_function_table[picture_control_set_ptr->parent_pcs_ptr->pred_structure])(
-            &lambdaSad,
-            &lambdaSse,
-            &lambdaSad,
-            &lambdaSse,
-            (uint8_t)picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr->bit_depth,
-            context_ptr->qp_index,
-            picture_control_set_ptr->hbd_mode_decision);
-        context_ptr->lambda = (uint64_t)lambdaSad;
+    context_ptr->qp = picture_control_set_ptr->picture_qp;
+
+    picture_control_set_ptr->parent_pcs_ptr->average_qp = 0;
+    picture_control_set_ptr->intra_coded_area = 0;
+    // Compute picture and slice level chroma QP offsets
+    SetSliceAndPictureChromaQpOffsets( // HT done
+        picture_control_set_ptr);
+
+    // Compute Tc, and Beta offsets for a given picture
+    // Set reference cdef strength
+    set_reference_cdef_strength(
+        picture_control_set_ptr);
+
+    // Set reference sg ep
+    set_reference_sg_ep(
+        picture_control_set_ptr);
+    SetGlobalMotionField(
+        picture_control_set_ptr);
+
+    eb_av1_qm_init(
+        picture_control_set_ptr->parent_pcs_ptr);
+
+    Quants *const quants = &picture_control_set_ptr->parent_pcs_ptr->quants;
+    Dequants *const dequants = &picture_control_set_ptr->parent_pcs_ptr->deq;
+
+    eb_av1_set_quantizer(
+        picture_control_set_ptr->parent_pcs_ptr,
+        frm_hdr->quantization_params.base_q_idx);
+    eb_av1_build_quantizer(
+        (AomBitDepth)sequence_control_set_ptr->static_config.encoder_bit_depth,
+        frm_hdr->quantization_params.delta_q_y_dc,
+        frm_hdr->quantization_params.delta_q_u_dc,
+        frm_hdr->quantization_params.delta_q_u_ac,
+        frm_hdr->quantization_params.delta_q_v_dc,
+        frm_hdr->quantization_params.delta_q_v_ac,
+        quants,
+        dequants);
+
+    Quants *const quantsMd = &picture_control_set_ptr->parent_pcs_ptr->quantsMd;
+    Dequants *const dequantsMd = &picture_control_set_ptr->parent_pcs_ptr->deqMd;
+    eb_av1_build_quantizer(
+        picture_control_set_ptr->hbd_mode_decision ? AOM_BITS_10 : AOM_BITS_8,
+        frm_hdr->quantization_params.delta_q_y_dc,
+        frm_hdr->quantization_params.delta_q_u_dc,
+        frm_hdr->quantization_params.delta_q_u_ac,
+        frm_hdr->quantization_params.delta_q_v_dc,
+        frm_hdr->quantization_params.delta_q_v_ac,
+        quantsMd,
+        dequantsMd);
+
+    // Hsan: collapse spare code
+    MdRateEstimationContext   *md_rate_estimation_array;
+    uint32_t                     entropyCodingQp;
+
+    // QP
+    context_ptr->qp = picture_control_set_ptr->picture_qp;
+
+    // QP Index
+    context_ptr->qp_index = (uint8_t)frm_hdr->quantization_params.base_q_idx;
+
+    // Lambda Assignement
+    uint32_t lambdaSse;
+    uint32_t lambdaSad;
+    (*av1_lambda_assignment_function_table[picture_control_set_ptr->parent_pcs_ptr->pred_structure])(
+        &lambdaSad,
+        &lambdaSse,
+        &lambdaSad,
+        &lambdaSse,
+        (uint8_t)picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr->bit_depth,
+        context_ptr->qp_index,
+        picture_control_set_ptr->hbd_mode_decision);
+    context_ptr->lambda = (uint64_t)lambdaSad;
 #if ENABLE_CDF_UPDATE
-        md_rate_estimation_array = picture_control_set_ptr->md_rate_estimation_array;
-        // Reset MD rate Estimation table to initial values by copying from md_rate_estimation_array
-        if (context_ptr->is_md_rate_estimation_ptr_owner) {
-            EB_FREE_ARRAY(context_ptr->md_rate_estimation_ptr);
-            context_ptr->is_md_rate_estimation_ptr_owner = EB_FALSE;
-        }
+    md_rate_estimation_array = picture_control_set_ptr->md_rate_estimation_array;
+    // Reset MD rate Estimation table to initial values by copying from md_rate_estimation_array
+    if (context_ptr->is_md_rate_estimation_ptr_owner) {
+        EB_FREE_ARRAY(context_ptr->md_rate_estimation_ptr);
+        context_ptr->is_md_rate_estimation_ptr_owner = EB_FALSE;
+    }
 #else
-        // Slice Type
-        EB_SLICE slice_type =
-            (picture_control_set_ptr->parent_pcs_ptr->idr_flag == EB_TRUE) ? I_SLICE :
-            picture_control_set_ptr->slice_type;
+    // Slice Type
+    EB_SLICE slice_type =
+        (picture_control_set_ptr->parent_pcs_ptr->idr_flag == EB_TRUE) ? I_SLICE :
+        picture_control_set_ptr->slice_type;
 
-        // Increment the MD Rate Estimation array pointer to point to the right address based on the QP and slice type
-        md_rate_estimation_array = (MdRateEstimationContext*)sequence_control_set_ptr->encode_context_ptr->md_rate_estimation_array;
+    // Increment the MD Rate Estimation array pointer to point to the right address based on the QP and slice type
+    md_rate_estimation_array = (MdRateEstimationContext*)sequence_control_set_ptr->encode_context_ptr->md_rate_estimation_array;
 #if ADD_DELTA_QP_SUPPORT
-        md_rate_estimation_array += slice_type * TOTAL_NUMBER_OF_QP_VALUES + picture_control_set_ptr->parent_pcs_ptr->picture_qp;
+    md_rate_estimation_array += slice_type * TOTAL_NUMBER_OF_QP_VALUES + picture_control_set_ptr->parent_pcs_ptr->picture_qp;
 #else
-        md_rate_estimation_array += slice_type * TOTAL_NUMBER_OF_QP_VALUES + context_ptr->qp;
+    md_rate_estimation_array += slice_type * TOTAL_NUMBER_OF_QP_VALUES + context_ptr->qp;
 #endif
 
-        // Reset MD rate Estimation table to initial values by copying from md_rate_estimation_array
-        if (context_ptr->is_md_rate_estimation_ptr_owner) {
-            EB_FREE_ARRAY(context_ptr->md_rate_estimation_ptr);
-            context_ptr->is_md_rate_estimation_ptr_owner = EB_FALSE;
-        }
+    // Reset MD rate Estimation table to initial values by copying from md_rate_estimation_array
+    if (context_ptr->is_md_rate_estimation_ptr_owner) {
+        EB_FREE_ARRAY(context_ptr->md_rate_estimation_ptr);
+        context_ptr->is_md_rate_estimation_ptr_owner = EB_FALSE;
+    }
 #endif
-        context_ptr->md_rate_estimation_ptr = md_rate_estimation_array;
+    context_ptr->md_rate_estimation_ptr = md_rate_estimation_array;
 
-        entropyCodingQp = frm_hdr->quantization_params.base_q_idx;
+    entropyCodingQp = frm_hdr->quantization_params.base_q_idx;
 #if ENABLE_CDF_UPDATE
-        if (picture_control_set_ptr->parent_pcs_ptr->frm_hdr.primary_ref_frame != PRIMARY_REF_NONE)
-            memcpy(picture_control_set_ptr->coeff_est_entropy_coder_ptr->fc, &picture_control_set_ptr->ref_frame_context[picture_control_set_ptr->parent_pcs_ptr->frm_hdr.primary_ref_frame], sizeof(FRAME_CONTEXT));
-        else
-            reset_entropy_coder(
-                sequence_control_set_ptr->encode_context_ptr,
-                picture_control_set_ptr->coeff_est_entropy_coder_ptr,
-                entropyCodingQp,
-                picture_control_set_ptr->slice_type);
-
-        // Initial Rate Estimatimation of the syntax elements
-        av1_estimate_syntax_rate(
-            md_rate_estimation_array,
-            picture_control_set_ptr->slice_type == I_SLICE ? EB_TRUE : EB_FALSE,
-            picture_control_set_ptr->coeff_est_entropy_coder_ptr->fc);
-#else
-        // Reset CABAC Contexts
+    if (picture_control_set_ptr->parent_pcs_ptr->frm_hdr.primary_ref_frame != PRIMARY_REF_NONE)
+        memcpy(picture_control_set_ptr->coeff_est_entropy_coder_ptr->fc, &picture_control_set_ptr->ref_frame_context[picture_control_set_ptr->parent_pcs_ptr->frm_hdr.primary_ref_frame], sizeof(FRAME_CONTEXT));
+    else
         reset_entropy_coder(
             sequence_control_set_ptr->encode_context_ptr,
             picture_control_set_ptr->coeff_est_entropy_coder_ptr,
             entropyCodingQp,
             picture_control_set_ptr->slice_type);
-#endif
-        // Initial Rate Estimatimation of the syntax elements
-        if (!md_rate_estimation_array->initialized)
-            av1_estimate_syntax_rate(
-                md_rate_estimation_array,
-                picture_control_set_ptr->slice_type == I_SLICE ? EB_TRUE : EB_FALSE,
-                picture_control_set_ptr->coeff_est_entropy_coder_ptr->fc);
-
-        // Initial Rate Estimatimation of the Motion vectors
-        av1_estimate_mv_rate(
-            picture_control_set_ptr,
-            md_rate_estimation_array,
-            &picture_control_set_ptr->coeff_est_entropy_coder_ptr->fc->nmvc);
 
-        // Initial Rate Estimatimation of the quantized coefficients
-        av1_estimate_coefficients_rate(
+    // Initial Rate Estimatimation of the syntax elements
+    av1_estimate_syntax_rate(
+        md_rate_estimation_array,
+        picture_control_set_ptr->slice_type == I_SLICE ? EB_TRUE : EB_FALSE,
+        picture_control_set_ptr->coeff_est_entropy_coder_ptr->fc);
+#else
+    // Reset CABAC Contexts
+    reset_entropy_coder(
+        sequence_control_set_ptr->encode_context_ptr,
+        picture_control_set_ptr->coeff_est_entropy_coder_ptr,
+        entropyCodingQp,
+        picture_control_set_ptr->slice_type);
+#endif
+    // Initial Rate Estimatimation of the syntax elements
+    if (!md_rate_estimation_array->initialized)
+        av1_estimate_syntax_rate(
             md_rate_estimation_array,
+            picture_control_set_ptr->slice_type == I_SLICE ? EB_TRUE : EB_FALSE,
             picture_control_set_ptr->coeff_est_entropy_coder_ptr->fc);
 
-        if (picture_control_set_ptr->parent_pcs_ptr->pic_depth_mode == PIC_SB_SWITCH_DEPTH_MODE) {
-            derive_sb_md_mode(
-                sequence_control_set_ptr,
-                picture_control_set_ptr,
-                context_ptr);
+    // Initial Rate Estimatimation of the Motion vectors
+    av1_estimate_mv_rate(
+        picture_control_set_ptr,
+        md_rate_estimation_array,
+        &picture_control_set_ptr->coeff_est_entropy_coder_ptr->fc->nmvc);
 
-            for (int sb_index = 0; sb_index < picture_control_set_ptr->sb_total_count; ++sb_index) {
-                if (picture_control_set_ptr->parent_pcs_ptr->sb_depth_mode_array[sb_index] == SB_SQ_BLOCKS_DEPTH_MODE) {
-                    sb_forward_sq_blocks_to_md(
-                        sequence_control_set_ptr,
-                        picture_control_set_ptr,
-                        sb_index);
-                }
-                else if (picture_control_set_ptr->parent_pcs_ptr->sb_depth_mode_array[sb_index] == SB_SQ_NON4_BLOCKS_DEPTH_MODE) {
-                    sb_forward_sq_non4_blocks_to_md(
-                        sequence_control_set_ptr,
-                        picture_control_set_ptr,
-                        sb_index);
-                }
-                else {
-                    PerformEarlyLcuPartitionningLcu(
-                        context_ptr,
-                        sequence_control_set_ptr,
-                        picture_control_set_ptr,
-                        sb_index);
-                }
+    // Initial Rate Estimatimation of the quantized coefficients
+    av1_estimate_coefficients_rate(
+        md_rate_estimation_array,
+        picture_control_set_ptr->coeff_est_entropy_coder_ptr->fc);
+
+    if (picture_control_set_ptr->parent_pcs_ptr->pic_depth_mode == PIC_SB_SWITCH_DEPTH_MODE) {
+        derive_sb_md_mode(
+            sequence_control_set_ptr,
+            picture_control_set_ptr,
+            context_ptr);
+
+        for (int sb_index = 0; sb_index < picture_control_set_ptr->sb_total_count; ++sb_index) {
+            if (picture_control_set_ptr->parent_pcs_ptr->sb_depth_mode_array[sb_index] == SB_SQ_BLOCKS_DEPTH_MODE) {
+                sb_forward_sq_blocks_to_md(
+                    sequence_control_set_ptr,
+                    picture_control_set_ptr,
+                    sb_index);
+            }
+            else if (picture_control_set_ptr->parent_pcs_ptr->sb_depth_mode_array[sb_index] == SB_SQ_NON4_BLOCKS_DEPTH_MODE) {
+                sb_forward_sq_non4_blocks_to_md(
+                    sequence_control_set_ptr,
+                    picture_control_set_ptr,
+                    sb_index);
+            }
+            else {
+                PerformEarlyLcuPartitionningLcu(
+                    context_ptr,
+                    sequence_control_set_ptr,
+                    picture_control_set_ptr,
+                    sb_index);
             }
         }
+    }
 
-        else  if (picture_control_set_ptr->parent_pcs_ptr->pic_depth_mode == PIC_ALL_DEPTH_MODE) {
-            forward_all_blocks_to_md(
-                sequence_control_set_ptr,
-                picture_control_set_ptr);
-        }
-        else  if (picture_control_set_ptr->parent_pcs_ptr->pic_depth_mode == PIC_ALL_C_DEPTH_MODE) {
-            forward_all_c_blocks_to_md(
-                sequence_control_set_ptr,
-                picture_control_set_ptr);
-        }
-        else  if (picture_control_set_ptr->parent_pcs_ptr->pic_depth_mode == PIC_SQ_DEPTH_MODE) {
-            forward_sq_blocks_to_md(
-                sequence_control_set_ptr,
-                picture_control_set_ptr);
-        }
-        else  if (picture_control_set_ptr->parent_pcs_ptr->pic_depth_mode == PIC_SQ_NON4_DEPTH_MODE) {
-            forward_sq_non4_blocks_to_md(
-                sequence_control_set_ptr,
-                picture_control_set_ptr);
-        }
-        else if (picture_control_set_ptr->parent_pcs_ptr->pic_depth_mode >= PIC_OPEN_LOOP_DEPTH_MODE) {
-            // Predict the SB partitionning
-            PerformEarlyLcuPartitionning( // HT done
-                context_ptr,
-                sequence_control_set_ptr,
-                picture_control_set_ptr);
-        }
-        else {   // (picture_control_set_ptr->parent_pcs_ptr->mdMode == PICT_BDP_DEPTH_MODE || picture_control_set_ptr->parent_pcs_ptr->mdMode == PICT_LIGHT_BDP_DEPTH_MODE )
-            picture_control_set_ptr->parent_pcs_ptr->average_qp = (uint8_t)picture_control_set_ptr->parent_pcs_ptr->picture_qp;
+    else  if (picture_control_set_ptr->parent_pcs_ptr->pic_depth_mode == PIC_ALL_DEPTH_MODE) {
+        forward_all_blocks_to_md(
+            sequence_control_set_ptr,
+            picture_control_set_ptr);
+    }
+    else  if (picture_control_set_ptr->parent_pcs_ptr->pic_depth_mode == PIC_ALL_C_DEPTH_MODE) {
+        forward_all_c_blocks_to_md(
+            sequence_control_set_ptr,
+            picture_control_set_ptr);
+    }
+    else  if (picture_control_set_ptr->parent_pcs_ptr->pic_depth_mode == PIC_SQ_DEPTH_MODE) {
+        forward_sq_blocks_to_md(
+            sequence_control_set_ptr,
+            picture_control_set_ptr);
+    }
+    else  if (picture_control_set_ptr->parent_pcs_ptr->pic_depth_mode == PIC_SQ_NON4_DEPTH_MODE) {
+        forward_sq_non4_blocks_to_md(
+            sequence_control_set_ptr,
+            picture_control_set_ptr);
+    }
+    else if (picture_control_set_ptr->parent_pcs_ptr->pic_depth_mode >= PIC_OPEN_LOOP_DEPTH_MODE) {
+        // Predict the SB partitionning
+        PerformEarlyLcuPartitionning( // HT done
+            context_ptr,
+            sequence_control_set_ptr,
+            picture_control_set_ptr);
+    }
+    else {   // (picture_control_set_ptr->parent_pcs_ptr->mdMode == PICT_BDP_DEPTH_MODE || picture_control_set_ptr->parent_pcs_ptr->mdMode == PICT_LIGHT_BDP_DEPTH_MODE )
+        picture_control_set_ptr->parent_pcs_ptr->average_qp = (uint8_t)picture_control_set_ptr->parent_pcs_ptr->picture_qp;
+    }
+
+    if (frm_hdr->allow_intrabc)
+    {
+        int i;
+        int speed = 1;
+        SpeedFeatures *sf = &picture_control_set_ptr->sf;
+        sf->allow_exhaustive_searches = 1;
+
+        const int mesh_speed = AOMMIN(speed, MAX_MESH_SPEED);
+        //if (cpi->twopass.fr_content_type == FC_GRAPHICS_ANIMATION)
+        //    sf->exhaustive_searches_thresh = (1 << 24);
+        //else
+        sf->exhaustive_searches_thresh = (1 << 25);
+
+        sf->max_exaustive_pct = good_quality_max_mesh_pct[mesh_speed];
+        if (mesh_speed > 0)
+            sf->exhaustive_searches_thresh = sf->exhaustive_searches_thresh << 1;
+
+        for (i = 0; i < MAX_MESH_STEP; ++i) {
+            sf->mesh_patterns[i].range =
+                good_quality_mesh_patterns[mesh_speed][i].range;
+            sf->mesh_patterns[i].interval =
+                good_quality_mesh_patterns[mesh_speed][i].interval;
         }
 
-        if (frm_hdr->allow_intrabc)
+        if (picture_control_set_ptr->slice_type == I_SLICE)
         {
-            int i;
-            int speed = 1;
-            SpeedFeatures *sf = &picture_control_set_ptr->sf;
-            sf->allow_exhaustive_searches = 1;
-
-            const int mesh_speed = AOMMIN(speed, MAX_MESH_SPEED);
-            //if (cpi->twopass.fr_content_type == FC_GRAPHICS_ANIMATION)
-            //    sf->exhaustive_searches_thresh = (1 << 24);
-            //else
-            sf->exhaustive_searches_thresh = (1 << 25);
-
-            sf->max_exaustive_pct = good_quality_max_mesh_pct[mesh_speed];
-            if (mesh_speed > 0)
-                sf->exhaustive_searches_thresh = sf->exhaustive_searches_thresh << 1;
-
             for (i = 0; i < MAX_MESH_STEP; ++i) {
-                sf->mesh_patterns[i].range =
-                    good_quality_mesh_patterns[mesh_speed][i].range;
+                sf->mesh_patterns[i].range = intrabc_mesh_patterns[mesh_speed][i].range;
                 sf->mesh_patterns[i].interval =
-                    good_quality_mesh_patterns[mesh_speed][i].interval;
+                    intrabc_mesh_patterns[mesh_speed][i].interval;
             }
+            sf->max_exaustive_pct = intrabc_max_mesh_pct[mesh_speed];
+        }
 
-            if (picture_control_set_ptr->slice_type == I_SLICE)
-            {
-                for (i = 0; i < MAX_MESH_STEP; ++i) {
-                    sf->mesh_patterns[i].range = intrabc_mesh_patterns[mesh_speed][i].range;
-                    sf->mesh_patterns[i].interval =
-                        intrabc_mesh_patterns[mesh_speed][i].interval;
-                }
-                sf->max_exaustive_pct = intrabc_max_mesh_pct[mesh_speed];
+        {
+            // add to hash table
+            const int pic_width = picture_control_set_ptr->parent_pcs_ptr->sequence_control_set_ptr->seq_header.max_frame_width;
+            const int pic_height = picture_control_set_ptr->parent_pcs_ptr->sequence_control_set_ptr->seq_header.max_frame_height;
+            uint32_t *block_hash_values[2][2];
+            int8_t *is_block_same[2][3];
+            int k, j;
+
+            for (k = 0; k < 2; k++) {
+                for (j = 0; j < 2; j++)
+                    block_hash_values[k][j] = malloc(sizeof(uint32_t) * pic_width * pic_height);
+                for (j = 0; j < 3; j++)
+                    is_block_same[k][j] = malloc(sizeof(int8_t) * pic_width * pic_height);
             }
 
-            {
-                // add to hash table
-                const int pic_width = picture_control_set_ptr->parent_pcs_ptr->sequence_control_set_ptr->seq_header.max_frame_width;
-                const int pic_height = picture_control_set_ptr->parent_pcs_ptr->sequence_control_set_ptr->seq_header.max_frame_height;
-                uint32_t *block_hash_values[2][2];
-                int8_t *is_block_same[2][3];
-                int k, j;
-
-                for (k = 0; k < 2; k++) {
-                    for (j = 0; j < 2; j++)
-                        block_hash_values[k][j] = malloc(sizeof(uint32_t) * pic_width * pic_height);
-                    for (j = 0; j < 3; j++)
-                        is_block_same[k][j] = malloc(sizeof(int8_t) * pic_width * pic_height);
-                }
-
-                //picture_control_set_ptr->hash_table.p_lookup_table = NULL;
-                //av1_hash_table_create(&picture_control_set_ptr->hash_table);
-
-                Yv12BufferConfig cpi_source;
-                link_Eb_to_aom_buffer_desc_8bit(
-                    picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr,
-                    &cpi_source);
-
-                av1_crc_calculator_init(&picture_control_set_ptr->crc_calculator1, 24, 0x5D6DCB);
-                av1_crc_calculator_init(&picture_control_set_ptr->crc_calculator2, 24, 0x864CFB);
-
-                av1_generate_block_2x2_hash_value(&cpi_source, block_hash_values[0],
-                    is_block_same[0], picture_control_set_ptr);
-                av1_generate_block_hash_value(&cpi_source, 4, block_hash_values[0],
-                    block_hash_values[1], is_block_same[0],
-                    is_block_same[1], picture_control_set_ptr);
-                av1_add_to_hash_map_by_row_with_precal_data(
-                    &picture_control_set_ptr->hash_table, block_hash_values[1], is_block_same[1][2],
-                    pic_width, pic_height, 4);
-                av1_generate_block_hash_value(&cpi_source, 8, block_hash_values[1],
-                    block_hash_values[0], is_block_same[1],
-                    is_block_same[0], picture_control_set_ptr);
-                av1_add_to_hash_map_by_row_with_precal_data(
-                    &picture_control_set_ptr->hash_table, block_hash_values[0], is_block_same[0][2],
-                    pic_width, pic_height, 8);
-                av1_generate_block_hash_value(&cpi_source, 16, block_hash_values[0],
-                    block_hash_values[1], is_block_same[0],
-                    is_block_same[1], picture_control_set_ptr);
-                av1_add_to_hash_map_by_row_with_precal_data(
-                    &picture_control_set_ptr->hash_table, block_hash_values[1], is_block_same[1][2],
-                    pic_width, pic_height, 16);
-                av1_generate_block_hash_value(&cpi_source, 32, block_hash_values[1],
-                    block_hash_values[0], is_block_same[1],
-                    is_block_same[0], picture_control_set_ptr);
-                av1_add_to_hash_map_by_row_with_precal_data(
-                    &picture_control_set_ptr->hash_table, block_hash_values[0], is_block_same[0][2],
-                    pic_width, pic_height, 32);
-                av1_generate_block_hash_value(&cpi_source, 64, block_hash_values[0],
-                    block_hash_values[1], is_block_same[0],
-                    is_block_same[1], picture_control_set_ptr);
-                av1_add_to_hash_map_by_row_with_precal_data(
-                    &picture_control_set_ptr->hash_table, block_hash_values[1], is_block_same[1][2],
-                    pic_width, pic_height, 64);
-
-                av1_generate_block_hash_value(&cpi_source, 128, block_hash_values[1],
-                    block_hash_values[0], is_block_same[1],
-                    is_block_same[0], picture_control_set_ptr);
-                av1_add_to_hash_map_by_row_with_precal_data(
-                    &picture_control_set_ptr->hash_table, block_hash_values[0], is_block_same[0][2],
-                    pic_width, pic_height, 128);
-
-                for (k = 0; k < 2; k++) {
-                    for (j = 0; j < 2; j++)
-                        free(block_hash_values[k][j]);
-                    for (j = 0; j < 3; j++)
-                        free(is_block_same[k][j]);
-                }
+            //picture_control_set_ptr->hash_table.p_lookup_table = NULL;
+            //av1_hash_table_create(&picture_control_set_ptr->hash_table);
+
+            Yv12BufferConfig cpi_source;
+            link_Eb_to_aom_buffer_desc_8bit(
+                picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr,
+                &cpi_source);
+
+            av1_crc_calculator_init(&picture_control_set_ptr->crc_calculator1, 24, 0x5D6DCB);
+            av1_crc_calculator_init(&picture_control_set_ptr->crc_calculator2, 24, 0x864CFB);
+
+            av1_generate_block_2x2_hash_value(&cpi_source, block_hash_values[0],
+                is_block_same[0], picture_control_set_ptr);
+            av1_generate_block_hash_value(&cpi_source, 4, block_hash_values[0],
+                block_hash_values[1], is_block_same[0],
+                is_block_same[1], picture_control_set_ptr);
+            av1_add_to_hash_map_by_row_with_precal_data(
+                &picture_control_set_ptr->hash_table, block_hash_values[1], is_block_same[1][2],
+                pic_width, pic_height, 4);
+            av1_generate_block_hash_value(&cpi_source, 8, block_hash_values[1],
+                block_hash_values[0], is_block_same[1],
+                is_block_same[0], picture_control_set_ptr);
+            av1_add_to_hash_map_by_row_with_precal_data(
+                &picture_control_set_ptr->hash_table, block_hash_values[0], is_block_same[0][2],
+                pic_width, pic_height, 8);
+            av1_generate_block_hash_value(&cpi_source, 16, block_hash_values[0],
+                block_hash_values[1], is_block_same[0],
+                is_block_same[1], picture_control_set_ptr);
+            av1_add_to_hash_map_by_row_with_precal_data(
+                &picture_control_set_ptr->hash_table, block_hash_values[1], is_block_same[1][2],
+                pic_width, pic_height, 16);
+            av1_generate_block_hash_value(&cpi_source, 32, block_hash_values[1],
+                block_hash_values[0], is_block_same[1],
+                is_block_same[0], picture_control_set_ptr);
+            av1_add_to_hash_map_by_row_with_precal_data(
+                &picture_control_set_ptr->hash_table, block_hash_values[0], is_block_same[0][2],
+                pic_width, pic_height, 32);
+            av1_generate_block_hash_value(&cpi_source, 64, block_hash_values[0],
+                block_hash_values[1], is_block_same[0],
+                is_block_same[1], picture_control_set_ptr);
+            av1_add_to_hash_map_by_row_with_precal_data(
+                &picture_control_set_ptr->hash_table, block_hash_values[1], is_block_same[1][2],
+                pic_width, pic_height, 64);
+
+            av1_generate_block_hash_value(&cpi_source, 128, block_hash_values[1],
+                block_hash_values[0], is_block_same[1],
+                is_block_same[0], picture_control_set_ptr);
+            av1_add_to_hash_map_by_row_with_precal_data(
+                &picture_control_set_ptr->hash_table, block_hash_values[0], is_block_same[0][2],
+                pic_width, pic_height, 128);
+
+            for (k = 0; k < 2; k++) {
+                for (j = 0; j < 2; j++)
+                    free(block_hash_values[k][j]);
+                for (j = 0; j < 3; j++)
+                    free(is_block_same[k][j]);
             }
-
-            eb_av1_init3smotion_compensation(&picture_control_set_ptr->ss_cfg, picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr->stride_y);
         }
 
-        // Derive MD parameters
-        SetMdSettings( // HT Done
-            sequence_control_set_ptr,
-            picture_control_set_ptr);
+        eb_av1_init3smotion_compensation(&picture_control_set_ptr->ss_cfg, picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr->stride_y);
+    }
 
-        // Post the results to the MD processes
-        eb_get_empty_object(
-            context_ptr->mode_decision_configuration_output_fifo_ptr,
-            &encDecTasksWrapperPtr);
+    // Derive MD parameters
+    SetMdSettings( // HT Done
+        sequence_control_set_ptr,
+        picture_control_set_ptr);
 
-        encDecTasksPtr = (EncDecTasks*)encDecTasksWrapperPtr->object_ptr;
-        encDecTasksPtr->picture_control_set_wrapper_ptr = rateControlResultsPtr->picture_control_set_wrapper_ptr;
-        encDecTasksPtr->input_type = ENCDEC_TASKS_MDC_INPUT;
+    // Post the results to the MD processes
+    eb_get_empty_object(
+        context_ptr->mode_decision_configuration_output_fifo_ptr,
+        &encDecTasksWrapperPtr);
 
-        // Post the Full Results Object
-        eb_post_full_object(encDecTasksWrapperPtr);
+    encDecTasksPtr = (EncDecTasks*)encDecTasksWrapperPtr->object_ptr;
+    encDecTasksPtr->picture_control_set_wrapper_ptr = rateControlResultsPtr->picture_control_set_wrapper_ptr;
+    encDecTasksPtr->input_type = ENCDEC_TASKS_MDC_INPUT;
 
-        // Release Rate Control Results
-        eb_release_object(rateControlResultsWrapperPtr);
-    }
+    // Post the Full Results Object
+    eb_post_full_object(encDecTasksWrapperPtr);
+
+    // Release Rate Control Results
+    eb_release_object(rateControlResultsWrapperPtr);
+}
+
+/******************************************************
+ * Mode Decision Configuration Kernel
+ ******************************************************/
+void* mode_decision_configuration_kernel(void *input_ptr)
+{
+    ModeDecisionConfigurationContext         *context_ptr = (ModeDecisionConfigurationContext*)input_ptr;
+    EbObjectWrapper                       *rateControlResultsWrapperPtr;
 
+    for (;;) {
+        // Get RateControl Results
+        eb_get_full_object(
+            context_ptr->rate_control_input_fifo_ptr,
+            &rateControlResultsWrapperPtr);
+
+        mode_decision_configuration_task(input_ptr, rateControlResultsWrapperPtr);
+    }
     return EB_NULL;
 }
@@ -93,6 +93,7 @@ extern "C" {
         uint16_t                           sb_total_count);
 
     extern void* mode_decision_configuration_kernel(void *input_ptr);
+    extern void mode_decision_configuration_task(void *input_ptr, EbObjectWrapper *input_wrapper_ptr);
 #ifdef __cplusplus
 }
 #endif
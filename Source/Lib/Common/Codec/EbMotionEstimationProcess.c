@@ -20,6 +20,7 @@
 #include "emmintrin.h"
 
 #include "EbTemporalFiltering.h"
+#include "EbTrace.h"
 
 /* --32x32-
 |00||01|
@@ -544,21 +545,20 @@ EbErrorType ComputeDecimatedZzSad(
 }
 
 /************************************************
- * Motion Analysis Kernel
+ * Motion Analysis Task
  * The Motion Analysis performs  Motion Estimation
  * This process has access to the current input picture as well as
  * the input pictures, which the current picture references according
  * to the prediction structure pattern.  The Motion Analysis process is multithreaded,
  * so pictures can be processed out of order as long as all inputs are available.
  ************************************************/
-void* motion_estimation_kernel(void *input_ptr)
+void motion_estimation_task(void *input_ptr, EbObjectWrapper *inputResultsWrapperPtr)
 {
     MotionEstimationContext_t   *context_ptr = (MotionEstimationContext_t*)input_ptr;
 
     PictureParentControlSet   *picture_control_set_ptr;
     SequenceControlSet        *sequence_control_set_ptr;
 
-    EbObjectWrapper           *inputResultsWrapperPtr;
     PictureDecisionResults    *inputResultsPtr;
 
     EbObjectWrapper           *outputResultsWrapperPtr;
@@ -599,318 +599,330 @@ void* motion_estimation_kernel(void *input_ptr)
 #if !ENABLE_CDF_UPDATE
     MdRateEstimationContext   *md_rate_estimation_array;
 #endif
-    for (;;) {
-        // Get Input Full Object
-        eb_get_full_object(
-            context_ptr->picture_decision_results_input_fifo_ptr,
-            &inputResultsWrapperPtr);
 
-        inputResultsPtr = (PictureDecisionResults*)inputResultsWrapperPtr->object_ptr;
-        picture_control_set_ptr = (PictureParentControlSet*)inputResultsPtr->picture_control_set_wrapper_ptr->object_ptr;
-        sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
+    inputResultsPtr = (PictureDecisionResults*)inputResultsWrapperPtr->object_ptr;
+    picture_control_set_ptr = (PictureParentControlSet*)inputResultsPtr->picture_control_set_wrapper_ptr->object_ptr;
+    eb_trace_set_object(picture_control_set_ptr->picture_number, (int32_t)inputResultsPtr->segment_index);
+    sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
 
-        paReferenceObject = (EbPaReferenceObject*)picture_control_set_ptr->pa_reference_picture_wrapper_ptr->object_ptr;
-        // Set 1/4 and 1/16 ME input buffer(s); filtered or decimated
-        quarter_picture_ptr = (sequence_control_set_ptr->down_sampling_method_me_search == ME_FILTERED_DOWNSAMPLED) ?
-            (EbPictureBufferDesc*)paReferenceObject->quarter_filtered_picture_ptr :
-            (EbPictureBufferDesc*)paReferenceObject->quarter_decimated_picture_ptr;
+    paReferenceObject = (EbPaReferenceObject*)picture_control_set_ptr->pa_reference_picture_wrapper_ptr->object_ptr;
+    // Set 1/4 and 1/16 ME input buffer(s); filtered or decimated
+    quarter_picture_ptr = (sequence_control_set_ptr->down_sampling_method_me_search == ME_FILTERED_DOWNSAMPLED) ?
+        (EbPictureBufferDesc*)paReferenceObject->quarter_filtered_picture_ptr :
+        (EbPictureBufferDesc*)paReferenceObject->quarter_decimated_picture_ptr;
 
-        sixteenth_picture_ptr = (sequence_control_set_ptr->down_sampling_method_me_search == ME_FILTERED_DOWNSAMPLED) ?
-            (EbPictureBufferDesc*)paReferenceObject->sixteenth_filtered_picture_ptr :
-            (EbPictureBufferDesc*)paReferenceObject->sixteenth_decimated_picture_ptr;
-        input_padded_picture_ptr = (EbPictureBufferDesc*)paReferenceObject->input_padded_picture_ptr;
+    sixteenth_picture_ptr = (sequence_control_set_ptr->down_sampling_method_me_search == ME_FILTERED_DOWNSAMPLED) ?
+        (EbPictureBufferDesc*)paReferenceObject->sixteenth_filtered_picture_ptr :
+        (EbPictureBufferDesc*)paReferenceObject->sixteenth_decimated_picture_ptr;
+    input_padded_picture_ptr = (EbPictureBufferDesc*)paReferenceObject->input_padded_picture_ptr;
 
-        input_picture_ptr = picture_control_set_ptr->enhanced_picture_ptr;
+    input_picture_ptr = picture_control_set_ptr->enhanced_picture_ptr;
 
-        asm_type = sequence_control_set_ptr->encode_context_ptr->asm_type;
+    asm_type = sequence_control_set_ptr->encode_context_ptr->asm_type;
 #if !ENABLE_CDF_UPDATE
-        // Increment the MD Rate Estimation array pointer to point to the right address based on the QP and slice type
-        md_rate_estimation_array = (MdRateEstimationContext*)sequence_control_set_ptr->encode_context_ptr->md_rate_estimation_array;
-        md_rate_estimation_array += picture_control_set_ptr->slice_type * TOTAL_NUMBER_OF_QP_VALUES + picture_control_set_ptr->picture_qp;
-        // Reset MD rate Estimation table to initial values by copying from md_rate_estimation_array
-        EB_MEMCPY(&(context_ptr->me_context_ptr->mvd_bits_array[0]), &(md_rate_estimation_array->mvd_bits[0]), sizeof(EbBitFraction)*NUMBER_OF_MVD_CASES);
-        ///context_ptr->me_context_ptr->lambda = lambda_mode_decision_ld_sad_qp_scaling[picture_control_set_ptr->picture_qp];
+    // Increment the MD Rate Estimation array pointer to point to the right address based on the QP and slice type
+    md_rate_estimation_array = (MdRateEstimationContext*)sequence_control_set_ptr->encode_context_ptr->md_rate_estimation_array;
+    md_rate_estimation_array += picture_control_set_ptr->slice_type * TOTAL_NUMBER_OF_QP_VALUES + picture_control_set_ptr->picture_qp;
+    // Reset MD rate Estimation table to initial values by copying from md_rate_estimation_array
+    EB_MEMCPY(&(context_ptr->me_context_ptr->mvd_bits_array[0]), &(md_rate_estimation_array->mvd_bits[0]), sizeof(EbBitFraction)*NUMBER_OF_MVD_CASES);
+    ///context_ptr->me_context_ptr->lambda = lambda_mode_decision_ld_sad_qp_scaling[picture_control_set_ptr->picture_qp];
 #endif
-        context_ptr->me_context_ptr->me_alt_ref = inputResultsPtr->task_type == 1 ? EB_TRUE : EB_FALSE;
-
-        // Lambda Assignement
-        if (sequence_control_set_ptr->static_config.pred_structure == EB_PRED_RANDOM_ACCESS) {
-            if (picture_control_set_ptr->temporal_layer_index == 0)
-                context_ptr->me_context_ptr->lambda = lambda_mode_decision_ra_sad[picture_control_set_ptr->picture_qp];
-            else if (picture_control_set_ptr->temporal_layer_index < 3)
-                context_ptr->me_context_ptr->lambda = lambda_mode_decision_ra_sad_qp_scaling_l1[picture_control_set_ptr->picture_qp];
-            else
-                context_ptr->me_context_ptr->lambda = lambda_mode_decision_ra_sad_qp_scaling_l3[picture_control_set_ptr->picture_qp];
-        }
-        else {
-            if (picture_control_set_ptr->temporal_layer_index == 0)
-                context_ptr->me_context_ptr->lambda = lambda_mode_decision_ld_sad[picture_control_set_ptr->picture_qp];
-            else
-                context_ptr->me_context_ptr->lambda = lambda_mode_decision_ld_sad_qp_scaling[picture_control_set_ptr->picture_qp];
-        }
-        if (inputResultsPtr->task_type == 0)
-        {
-
-            // ME Kernel Signal(s) derivation
-            signal_derivation_me_kernel_oq(
-                sequence_control_set_ptr,
-                picture_control_set_ptr,
-                context_ptr);
-
-            // Segments
-            segment_index = inputResultsPtr->segment_index;
-            picture_width_in_sb = (sequence_control_set_ptr->seq_header.max_frame_width + sequence_control_set_ptr->sb_sz - 1) / sequence_control_set_ptr->sb_sz;
-            picture_height_in_sb = (sequence_control_set_ptr->seq_header.max_frame_height + sequence_control_set_ptr->sb_sz - 1) / sequence_control_set_ptr->sb_sz;
-            SEGMENT_CONVERT_IDX_TO_XY(segment_index, xSegmentIndex, ySegmentIndex, picture_control_set_ptr->me_segments_column_count);
-            xLcuStartIndex = SEGMENT_START_IDX(xSegmentIndex, picture_width_in_sb, picture_control_set_ptr->me_segments_column_count);
-            xLcuEndIndex = SEGMENT_END_IDX(xSegmentIndex, picture_width_in_sb, picture_control_set_ptr->me_segments_column_count);
-            yLcuStartIndex = SEGMENT_START_IDX(ySegmentIndex, picture_height_in_sb, picture_control_set_ptr->me_segments_row_count);
-            yLcuEndIndex = SEGMENT_END_IDX(ySegmentIndex, picture_height_in_sb, picture_control_set_ptr->me_segments_row_count);
-            // *** MOTION ESTIMATION CODE ***
-            if (picture_control_set_ptr->slice_type != I_SLICE) {
-                // SB Loop
-                for (y_lcu_index = yLcuStartIndex; y_lcu_index < yLcuEndIndex; ++y_lcu_index) {
-                    for (x_lcu_index = xLcuStartIndex; x_lcu_index < xLcuEndIndex; ++x_lcu_index) {
-                        sb_index = (uint16_t)(x_lcu_index + y_lcu_index * picture_width_in_sb);
-                        sb_origin_x = x_lcu_index * sequence_control_set_ptr->sb_sz;
-                        sb_origin_y = y_lcu_index * sequence_control_set_ptr->sb_sz;
-
-                        sb_width = (sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x) < BLOCK_SIZE_64 ? sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x : BLOCK_SIZE_64;
-                        sb_height = (sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y) < BLOCK_SIZE_64 ? sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y : BLOCK_SIZE_64;
+    context_ptr->me_context_ptr->me_alt_ref = inputResultsPtr->task_type == 1 ? EB_TRUE : EB_FALSE;
+
+    // Lambda Assignement
+    if (sequence_control_set_ptr->static_config.pred_structure == EB_PRED_RANDOM_ACCESS) {
+        if (picture_control_set_ptr->temporal_layer_index == 0)
+            context_ptr->me_context_ptr->lambda = lambda_mode_decision_ra_sad[picture_control_set_ptr->picture_qp];
+        else if (picture_control_set_ptr->temporal_layer_index < 3)
+            context_ptr->me_context_ptr->lambda = lambda_mode_decision_ra_sad_qp_scaling_l1[picture_control_set_ptr->picture_qp];
+        else
+            context_ptr->me_context_ptr->lambda = lambda_mode_decision_ra_sad_qp_scaling_l3[picture_control_set_ptr->picture_qp];
+    }
+    else {
+        if (picture_control_set_ptr->temporal_layer_index == 0)
+            context_ptr->me_context_ptr->lambda = lambda_mode_decision_ld_sad[picture_control_set_ptr->picture_qp];
+        else
+            context_ptr->me_context_ptr->lambda = lambda_mode_decision_ld_sad_qp_scaling[picture_control_set_ptr->picture_qp];
+    }
+    if (inputResultsPtr->task_type == 0)
+    {
 
-                        // Load the SB from the input to the intermediate SB buffer
-                        bufferIndex = (input_picture_ptr->origin_y + sb_origin_y) * input_picture_ptr->stride_y + input_picture_ptr->origin_x + sb_origin_x;
+        // ME Kernel Signal(s) derivation
+        signal_derivation_me_kernel_oq(
+            sequence_control_set_ptr,
+            picture_control_set_ptr,
+            context_ptr);
 
-                        context_ptr->me_context_ptr->hme_search_type = HME_RECTANGULAR;
+        // Segments
+        segment_index = inputResultsPtr->segment_index;
+        picture_width_in_sb = (sequence_control_set_ptr->seq_header.max_frame_width + sequence_control_set_ptr->sb_sz - 1) / sequence_control_set_ptr->sb_sz;
+        picture_height_in_sb = (sequence_control_set_ptr->seq_header.max_frame_height + sequence_control_set_ptr->sb_sz - 1) / sequence_control_set_ptr->sb_sz;
+        SEGMENT_CONVERT_IDX_TO_XY(segment_index, xSegmentIndex, ySegmentIndex, picture_control_set_ptr->me_segments_column_count);
+        xLcuStartIndex = SEGMENT_START_IDX(xSegmentIndex, picture_width_in_sb, picture_control_set_ptr->me_segments_column_count);
+        xLcuEndIndex = SEGMENT_END_IDX(xSegmentIndex, picture_width_in_sb, picture_control_set_ptr->me_segments_column_count);
+        yLcuStartIndex = SEGMENT_START_IDX(ySegmentIndex, picture_height_in_sb, picture_control_set_ptr->me_segments_row_count);
+        yLcuEndIndex = SEGMENT_END_IDX(ySegmentIndex, picture_height_in_sb, picture_control_set_ptr->me_segments_row_count);
+        // *** MOTION ESTIMATION CODE ***
+        if (picture_control_set_ptr->slice_type != I_SLICE) {
+            // SB Loop
+            for (y_lcu_index = yLcuStartIndex; y_lcu_index < yLcuEndIndex; ++y_lcu_index) {
+                for (x_lcu_index = xLcuStartIndex; x_lcu_index < xLcuEndIndex; ++x_lcu_index) {
+                    sb_index = (uint16_t)(x_lcu_index + y_lcu_index * picture_width_in_sb);
+                    sb_origin_x = x_lcu_index * sequence_control_set_ptr->sb_sz;
+                    sb_origin_y = y_lcu_index * sequence_control_set_ptr->sb_sz;
+
+                    sb_width = (sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x) < BLOCK_SIZE_64 ? sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x : BLOCK_SIZE_64;
+                    sb_height = (sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y) < BLOCK_SIZE_64 ? sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y : BLOCK_SIZE_64;
+
+                    // Load the SB from the input to the intermediate SB buffer
+                    bufferIndex = (input_picture_ptr->origin_y + sb_origin_y) * input_picture_ptr->stride_y + input_picture_ptr->origin_x + sb_origin_x;
+
+                    context_ptr->me_context_ptr->hme_search_type = HME_RECTANGULAR;
+
+                    for (lcuRow = 0; lcuRow < BLOCK_SIZE_64; lcuRow++) {
+                        EB_MEMCPY((&(context_ptr->me_context_ptr->sb_buffer[lcuRow * BLOCK_SIZE_64])), (&(input_picture_ptr->buffer_y[bufferIndex + lcuRow * input_picture_ptr->stride_y])), BLOCK_SIZE_64 * sizeof(uint8_t));
+                    }
 
-                        for (lcuRow = 0; lcuRow < BLOCK_SIZE_64; lcuRow++) {
-                            EB_MEMCPY((&(context_ptr->me_context_ptr->sb_buffer[lcuRow * BLOCK_SIZE_64])), (&(input_picture_ptr->buffer_y[bufferIndex + lcuRow * input_picture_ptr->stride_y])), BLOCK_SIZE_64 * sizeof(uint8_t));
-                        }
+                    {
+                        uint8_t * src_ptr = &input_padded_picture_ptr->buffer_y[bufferIndex];
 
+                        //_MM_HINT_T0     //_MM_HINT_T1    //_MM_HINT_T2//_MM_HINT_NTA
+                        uint32_t i;
+                        for (i = 0; i < sb_height; i++)
                         {
-                            uint8_t * src_ptr = &input_padded_picture_ptr->buffer_y[bufferIndex];
-
-                            //_MM_HINT_T0     //_MM_HINT_T1    //_MM_HINT_T2//_MM_HINT_NTA
-                            uint32_t i;
-                            for (i = 0; i < sb_height; i++)
-                            {
-                                char const* p = (char const*)(src_ptr + i * input_padded_picture_ptr->stride_y);
-                                _mm_prefetch(p, _MM_HINT_T2);
-                            }
+                            char const* p = (char const*)(src_ptr + i * input_padded_picture_ptr->stride_y);
+                            _mm_prefetch(p, _MM_HINT_T2);
                         }
+                    }
 
-                        context_ptr->me_context_ptr->sb_src_ptr = &input_padded_picture_ptr->buffer_y[bufferIndex];
-                        context_ptr->me_context_ptr->sb_src_stride = input_padded_picture_ptr->stride_y;
-                        // Load the 1/4 decimated SB from the 1/4 decimated input to the 1/4 intermediate SB buffer
-                        if (context_ptr->me_context_ptr->enable_hme_level1_flag) {
-                            bufferIndex = (quarter_picture_ptr->origin_y + (sb_origin_y >> 1)) * quarter_picture_ptr->stride_y + quarter_picture_ptr->origin_x + (sb_origin_x >> 1);
+                    context_ptr->me_context_ptr->sb_src_ptr = &input_padded_picture_ptr->buffer_y[bufferIndex];
+                    context_ptr->me_context_ptr->sb_src_stride = input_padded_picture_ptr->stride_y;
+                    // Load the 1/4 decimated SB from the 1/4 decimated input to the 1/4 intermediate SB buffer
+                    if (context_ptr->me_context_ptr->enable_hme_level1_flag) {
+                        bufferIndex = (quarter_picture_ptr->origin_y + (sb_origin_y >> 1)) * quarter_picture_ptr->stride_y + quarter_picture_ptr->origin_x + (sb_origin_x >> 1);
 
-                            for (lcuRow = 0; lcuRow < (sb_height >> 1); lcuRow++) {
-                                EB_MEMCPY((&(context_ptr->me_context_ptr->quarter_sb_buffer[lcuRow * context_ptr->me_context_ptr->quarter_sb_buffer_stride])), (&(quarter_picture_ptr->buffer_y[bufferIndex + lcuRow * quarter_picture_ptr->stride_y])), (sb_width >> 1) * sizeof(uint8_t));
-                            }
+                        for (lcuRow = 0; lcuRow < (sb_height >> 1); lcuRow++) {
+                            EB_MEMCPY((&(context_ptr->me_context_ptr->quarter_sb_buffer[lcuRow * context_ptr->me_context_ptr->quarter_sb_buffer_stride])), (&(quarter_picture_ptr->buffer_y[bufferIndex + lcuRow * quarter_picture_ptr->stride_y])), (sb_width >> 1) * sizeof(uint8_t));
                         }
+                    }
 
-                        // Load the 1/16 decimated SB from the 1/16 decimated input to the 1/16 intermediate SB buffer
-                        if (context_ptr->me_context_ptr->enable_hme_level0_flag) {
-                            bufferIndex = (sixteenth_picture_ptr->origin_y + (sb_origin_y >> 2)) * sixteenth_picture_ptr->stride_y + sixteenth_picture_ptr->origin_x + (sb_origin_x >> 2);
-
-                            {
-                                uint8_t  *framePtr = &sixteenth_picture_ptr->buffer_y[bufferIndex];
-                                uint8_t  *localPtr = context_ptr->me_context_ptr->sixteenth_sb_buffer;
-                                if (context_ptr->me_context_ptr->hme_search_method == FULL_SAD_SEARCH) {
-                                    for (lcuRow = 0; lcuRow < (sb_height >> 2); lcuRow += 1) {
-                                        EB_MEMCPY(localPtr, framePtr, (sb_width >> 2) * sizeof(uint8_t));
-                                        localPtr += 16;
-                                        framePtr += sixteenth_picture_ptr->stride_y;
-                                    }
+                    // Load the 1/16 decimated SB from the 1/16 decimated input to the 1/16 intermediate SB buffer
+                    if (context_ptr->me_context_ptr->enable_hme_level0_flag) {
+                        bufferIndex = (sixteenth_picture_ptr->origin_y + (sb_origin_y >> 2)) * sixteenth_picture_ptr->stride_y + sixteenth_picture_ptr->origin_x + (sb_origin_x >> 2);
+
+                        {
+                            uint8_t  *framePtr = &sixteenth_picture_ptr->buffer_y[bufferIndex];
+                            uint8_t  *localPtr = context_ptr->me_context_ptr->sixteenth_sb_buffer;
+                            if (context_ptr->me_context_ptr->hme_search_method == FULL_SAD_SEARCH) {
+                                for (lcuRow = 0; lcuRow < (sb_height >> 2); lcuRow += 1) {
+                                    EB_MEMCPY(localPtr, framePtr, (sb_width >> 2) * sizeof(uint8_t));
+                                    localPtr += 16;
+                                    framePtr += sixteenth_picture_ptr->stride_y;
                                 }
-                                else {
-                                    for (lcuRow = 0; lcuRow < (sb_height >> 2); lcuRow += 2) {
-                                        EB_MEMCPY(localPtr, framePtr, (sb_width >> 2) * sizeof(uint8_t));
-                                        localPtr += 16;
-                                        framePtr += sixteenth_picture_ptr->stride_y << 1;
-                                    }
+                            }
+                            else {
+                                for (lcuRow = 0; lcuRow < (sb_height >> 2); lcuRow += 2) {
+                                    EB_MEMCPY(localPtr, framePtr, (sb_width >> 2) * sizeof(uint8_t));
+                                    localPtr += 16;
+                                    framePtr += sixteenth_picture_ptr->stride_y << 1;
                                 }
                             }
                         }
-                        context_ptr->me_context_ptr->me_alt_ref = EB_FALSE;
-
-                        motion_estimate_lcu(
-                            picture_control_set_ptr,
-                            sb_index,
-                            sb_origin_x,
-                            sb_origin_y,
-                            context_ptr->me_context_ptr,
-                            input_picture_ptr);
                     }
+                    context_ptr->me_context_ptr->me_alt_ref = EB_FALSE;
+
+                    motion_estimate_lcu(
+                        picture_control_set_ptr,
+                        sb_index,
+                        sb_origin_x,
+                        sb_origin_y,
+                        context_ptr->me_context_ptr,
+                        input_picture_ptr);
                 }
             }
-        if ( picture_control_set_ptr->intra_pred_mode > 4)
-                // *** OPEN LOOP INTRA CANDIDATE SEARCH CODE ***
-            {
-                // SB Loop
-                for (y_lcu_index = yLcuStartIndex; y_lcu_index < yLcuEndIndex; ++y_lcu_index) {
-                    for (x_lcu_index = xLcuStartIndex; x_lcu_index < xLcuEndIndex; ++x_lcu_index) {
-                        sb_origin_x = x_lcu_index * sequence_control_set_ptr->sb_sz;
-                        sb_origin_y = y_lcu_index * sequence_control_set_ptr->sb_sz;
-
-                        sb_index = (uint16_t)(x_lcu_index + y_lcu_index * picture_width_in_sb);
-
-                        open_loop_intra_search_sb(
-                            picture_control_set_ptr,
-                            sb_index,
-                            context_ptr,
-                            input_picture_ptr,
-                            asm_type);
-                    }
+        }
+    if ( picture_control_set_ptr->intra_pred_mode > 4)
+            // *** OPEN LOOP INTRA CANDIDATE SEARCH CODE ***
+        {
+            // SB Loop
+            for (y_lcu_index = yLcuStartIndex; y_lcu_index < yLcuEndIndex; ++y_lcu_index) {
+                for (x_lcu_index = xLcuStartIndex; x_lcu_index < xLcuEndIndex; ++x_lcu_index) {
+                    sb_origin_x = x_lcu_index * sequence_control_set_ptr->sb_sz;
+                    sb_origin_y = y_lcu_index * sequence_control_set_ptr->sb_sz;
+
+                    sb_index = (uint16_t)(x_lcu_index + y_lcu_index * picture_width_in_sb);
+
+                    open_loop_intra_search_sb(
+                        picture_control_set_ptr,
+                        sb_index,
+                        context_ptr,
+                        input_picture_ptr,
+                        asm_type);
                 }
             }
+        }
 
-            // ZZ SADs Computation
-            // 1 lookahead frame is needed to get valid (0,0) SAD
-            if (sequence_control_set_ptr->static_config.look_ahead_distance != 0) {
-                // when DG is ON, the ZZ SADs are computed @ the PD process
-                {
-                    // ZZ SADs Computation using decimated picture
-                    if (picture_control_set_ptr->picture_number > 0) {
-                        ComputeDecimatedZzSad(
-                            context_ptr,
-                            sequence_control_set_ptr,
-                            picture_control_set_ptr,
-                            (EbPictureBufferDesc*)paReferenceObject->sixteenth_decimated_picture_ptr, // Hsan: always use decimated for ZZ SAD derivation until studying the trade offs and regenerating the activity threshold
-                            xLcuStartIndex,
-                            xLcuEndIndex,
-                            yLcuStartIndex,
-                            yLcuEndIndex);
-                    }
+        // ZZ SADs Computation
+        // 1 lookahead frame is needed to get valid (0,0) SAD
+        if (sequence_control_set_ptr->static_config.look_ahead_distance != 0) {
+            // when DG is ON, the ZZ SADs are computed @ the PD process
+            {
+                // ZZ SADs Computation using decimated picture
+                if (picture_control_set_ptr->picture_number > 0) {
+                    ComputeDecimatedZzSad(
+                        context_ptr,
+                        sequence_control_set_ptr,
+                        picture_control_set_ptr,
+                        (EbPictureBufferDesc*)paReferenceObject->sixteenth_decimated_picture_ptr, // Hsan: always use decimated for ZZ SAD derivation until studying the trade offs and regenerating the activity threshold
+                        xLcuStartIndex,
+                        xLcuEndIndex,
+                        yLcuStartIndex,
+                        yLcuEndIndex);
                 }
             }
+        }
 
-            // Calculate the ME Distortion and OIS Historgrams
+        // Calculate the ME Distortion and OIS Historgrams
 
-            eb_block_on_mutex(picture_control_set_ptr->rc_distortion_histogram_mutex);
+        eb_block_on_mutex(picture_control_set_ptr->rc_distortion_histogram_mutex);
 
-            if (sequence_control_set_ptr->static_config.rate_control_mode) {
-                if (picture_control_set_ptr->slice_type != I_SLICE) {
-                    uint16_t sadIntervalIndex;
-                    for (y_lcu_index = yLcuStartIndex; y_lcu_index < yLcuEndIndex; ++y_lcu_index) {
-                        for (x_lcu_index = xLcuStartIndex; x_lcu_index < xLcuEndIndex; ++x_lcu_index) {
-                            sb_origin_x = x_lcu_index * sequence_control_set_ptr->sb_sz;
-                            sb_origin_y = y_lcu_index * sequence_control_set_ptr->sb_sz;
-                            sb_width = (sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x) < BLOCK_SIZE_64 ? sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x : BLOCK_SIZE_64;
-                            sb_height = (sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y) < BLOCK_SIZE_64 ? sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y : BLOCK_SIZE_64;
+        if (sequence_control_set_ptr->static_config.rate_control_mode) {
+            if (picture_control_set_ptr->slice_type != I_SLICE) {
+                uint16_t sadIntervalIndex;
+                for (y_lcu_index = yLcuStartIndex; y_lcu_index < yLcuEndIndex; ++y_lcu_index) {
+                    for (x_lcu_index = xLcuStartIndex; x_lcu_index < xLcuEndIndex; ++x_lcu_index) {
+                        sb_origin_x = x_lcu_index * sequence_control_set_ptr->sb_sz;
+                        sb_origin_y = y_lcu_index * sequence_control_set_ptr->sb_sz;
+                        sb_width = (sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x) < BLOCK_SIZE_64 ? sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x : BLOCK_SIZE_64;
+                        sb_height = (sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y) < BLOCK_SIZE_64 ? sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y : BLOCK_SIZE_64;
 
-                            sb_index = (uint16_t)(x_lcu_index + y_lcu_index * picture_width_in_sb);
-                            picture_control_set_ptr->inter_sad_interval_index[sb_index] = 0;
-                            picture_control_set_ptr->intra_sad_interval_index[sb_index] = 0;
+                        sb_index = (uint16_t)(x_lcu_index + y_lcu_index * picture_width_in_sb);
+                        picture_control_set_ptr->inter_sad_interval_index[sb_index] = 0;
+                        picture_control_set_ptr->intra_sad_interval_index[sb_index] = 0;
 
-                            if (sb_width == BLOCK_SIZE_64 && sb_height == BLOCK_SIZE_64) {
-                                sadIntervalIndex = (uint16_t)(picture_control_set_ptr->rc_me_distortion[sb_index] >> (12 - SAD_PRECISION_INTERVAL));//change 12 to 2*log2(64)
+                        if (sb_width == BLOCK_SIZE_64 && sb_height == BLOCK_SIZE_64) {
+                            sadIntervalIndex = (uint16_t)(picture_control_set_ptr->rc_me_distortion[sb_index] >> (12 - SAD_PRECISION_INTERVAL));//change 12 to 2*log2(64)
 
-                                // printf("%d\n", sadIntervalIndex);
+                            // printf("%d\n", sadIntervalIndex);
 
-                                sadIntervalIndex = (uint16_t)(sadIntervalIndex >> 2);
-                                if (sadIntervalIndex > (NUMBER_OF_SAD_INTERVALS >> 1) - 1) {
-                                    uint16_t sadIntervalIndexTemp = sadIntervalIndex - ((NUMBER_OF_SAD_INTERVALS >> 1) - 1);
+                            sadIntervalIndex = (uint16_t)(sadIntervalIndex >> 2);
+                            if (sadIntervalIndex > (NUMBER_OF_SAD_INTERVALS >> 1) - 1) {
+                                uint16_t sadIntervalIndexTemp = sadIntervalIndex - ((NUMBER_OF_SAD_INTERVALS >> 1) - 1);
 
-                                    sadIntervalIndex = ((NUMBER_OF_SAD_INTERVALS >> 1) - 1) + (sadIntervalIndexTemp >> 3);
-                                }
-                                if (sadIntervalIndex >= NUMBER_OF_SAD_INTERVALS - 1)
-                                    sadIntervalIndex = NUMBER_OF_SAD_INTERVALS - 1;
+                                sadIntervalIndex = ((NUMBER_OF_SAD_INTERVALS >> 1) - 1) + (sadIntervalIndexTemp >> 3);
+                            }
+                            if (sadIntervalIndex >= NUMBER_OF_SAD_INTERVALS - 1)
+                                sadIntervalIndex = NUMBER_OF_SAD_INTERVALS - 1;
 
-                                picture_control_set_ptr->inter_sad_interval_index[sb_index] = sadIntervalIndex;
+                            picture_control_set_ptr->inter_sad_interval_index[sb_index] = sadIntervalIndex;
 
-                                picture_control_set_ptr->me_distortion_histogram[sadIntervalIndex] ++;
+                            picture_control_set_ptr->me_distortion_histogram[sadIntervalIndex] ++;
 
-                                intra_sad_interval_index = picture_control_set_ptr->variance[sb_index][ME_TIER_ZERO_PU_64x64] >> 4;
-                                intra_sad_interval_index = (uint16_t)(intra_sad_interval_index >> 2);
-                                if (intra_sad_interval_index > (NUMBER_OF_SAD_INTERVALS >> 1) - 1) {
-                                    uint32_t sadIntervalIndexTemp = intra_sad_interval_index - ((NUMBER_OF_SAD_INTERVALS >> 1) - 1);
+                            intra_sad_interval_index = picture_control_set_ptr->variance[sb_index][ME_TIER_ZERO_PU_64x64] >> 4;
+                            intra_sad_interval_index = (uint16_t)(intra_sad_interval_index >> 2);
+                            if (intra_sad_interval_index > (NUMBER_OF_SAD_INTERVALS >> 1) - 1) {
+                                uint32_t sadIntervalIndexTemp = intra_sad_interval_index - ((NUMBER_OF_SAD_INTERVALS >> 1) - 1);
 
-                                    intra_sad_interval_index = ((NUMBER_OF_SAD_INTERVALS >> 1) - 1) + (sadIntervalIndexTemp >> 3);
-                                }
-                                if (intra_sad_interval_index >= NUMBER_OF_SAD_INTERVALS - 1)
-                                    intra_sad_interval_index = NUMBER_OF_SAD_INTERVALS - 1;
+                                intra_sad_interval_index = ((NUMBER_OF_SAD_INTERVALS >> 1) - 1) + (sadIntervalIndexTemp >> 3);
+                            }
+                            if (intra_sad_interval_index >= NUMBER_OF_SAD_INTERVALS - 1)
+                                intra_sad_interval_index = NUMBER_OF_SAD_INTERVALS - 1;
 
-                                picture_control_set_ptr->intra_sad_interval_index[sb_index] = intra_sad_interval_index;
+                            picture_control_set_ptr->intra_sad_interval_index[sb_index] = intra_sad_interval_index;
 
-                                picture_control_set_ptr->ois_distortion_histogram[intra_sad_interval_index] ++;
+                            picture_control_set_ptr->ois_distortion_histogram[intra_sad_interval_index] ++;
 
-                                ++picture_control_set_ptr->full_sb_count;
-                            }
+                            ++picture_control_set_ptr->full_sb_count;
                         }
                     }
                 }
-                else {
-                    for (y_lcu_index = yLcuStartIndex; y_lcu_index < yLcuEndIndex; ++y_lcu_index) {
-                        for (x_lcu_index = xLcuStartIndex; x_lcu_index < xLcuEndIndex; ++x_lcu_index) {
-                            sb_origin_x = x_lcu_index * sequence_control_set_ptr->sb_sz;
-                            sb_origin_y = y_lcu_index * sequence_control_set_ptr->sb_sz;
-                            sb_width = (sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x) < BLOCK_SIZE_64 ? sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x : BLOCK_SIZE_64;
-                            sb_height = (sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y) < BLOCK_SIZE_64 ? sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y : BLOCK_SIZE_64;
+            }
+            else {
+                for (y_lcu_index = yLcuStartIndex; y_lcu_index < yLcuEndIndex; ++y_lcu_index) {
+                    for (x_lcu_index = xLcuStartIndex; x_lcu_index < xLcuEndIndex; ++x_lcu_index) {
+                        sb_origin_x = x_lcu_index * sequence_control_set_ptr->sb_sz;
+                        sb_origin_y = y_lcu_index * sequence_control_set_ptr->sb_sz;
+                        sb_width = (sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x) < BLOCK_SIZE_64 ? sequence_control_set_ptr->seq_header.max_frame_width - sb_origin_x : BLOCK_SIZE_64;
+                        sb_height = (sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y) < BLOCK_SIZE_64 ? sequence_control_set_ptr->seq_header.max_frame_height - sb_origin_y : BLOCK_SIZE_64;
 
-                            sb_index = (uint16_t)(x_lcu_index + y_lcu_index * picture_width_in_sb);
+                        sb_index = (uint16_t)(x_lcu_index + y_lcu_index * picture_width_in_sb);
 
-                            picture_control_set_ptr->inter_sad_interval_index[sb_index] = 0;
-                            picture_control_set_ptr->intra_sad_interval_index[sb_index] = 0;
+                        picture_control_set_ptr->inter_sad_interval_index[sb_index] = 0;
+                        picture_control_set_ptr->intra_sad_interval_index[sb_index] = 0;
 
-                            if (sb_width == BLOCK_SIZE_64 && sb_height == BLOCK_SIZE_64) {
+                        if (sb_width == BLOCK_SIZE_64 && sb_height == BLOCK_SIZE_64) {
 
-                                intra_sad_interval_index = picture_control_set_ptr->variance[sb_index][ME_TIER_ZERO_PU_64x64] >> 4;
-                                intra_sad_interval_index = (uint16_t)(intra_sad_interval_index >> 2);
-                                if (intra_sad_interval_index > (NUMBER_OF_SAD_INTERVALS >> 1) - 1) {
-                                    uint32_t sadIntervalIndexTemp = intra_sad_interval_index - ((NUMBER_OF_SAD_INTERVALS >> 1) - 1);
+                            intra_sad_interval_index = picture_control_set_ptr->variance[sb_index][ME_TIER_ZERO_PU_64x64] >> 4;
+                            intra_sad_interval_index = (uint16_t)(intra_sad_interval_index >> 2);
+                            if (intra_sad_interval_index > (NUMBER_OF_SAD_INTERVALS >> 1) - 1) {
+                                uint32_t sadIntervalIndexTemp = intra_sad_interval_index - ((NUMBER_OF_SAD_INTERVALS >> 1) - 1);
 
-                                    intra_sad_interval_index = ((NUMBER_OF_SAD_INTERVALS >> 1) - 1) + (sadIntervalIndexTemp >> 3);
-                                }
-                                if (intra_sad_interval_index >= NUMBER_OF_SAD_INTERVALS - 1)
-                                    intra_sad_interval_index = NUMBER_OF_SAD_INTERVALS - 1;
+                                intra_sad_interval_index = ((NUMBER_OF_SAD_INTERVALS >> 1) - 1) + (sadIntervalIndexTemp >> 3);
+                            }
+                            if (intra_sad_interval_index >= NUMBER_OF_SAD_INTERVALS - 1)
+                                intra_sad_interval_index = NUMBER_OF_SAD_INTERVALS - 1;
 
-                                picture_control_set_ptr->intra_sad_interval_index[sb_index] = intra_sad_interval_index;
+                            picture_control_set_ptr->intra_sad_interval_index[sb_index] = intra_sad_interval_index;
 
-                                picture_control_set_ptr->ois_distortion_histogram[intra_sad_interval_index] ++;
+                            picture_control_set_ptr->ois_distortion_histogram[intra_sad_interval_index] ++;
 
-                                ++picture_control_set_ptr->full_sb_count;
-                            }
+                            ++picture_control_set_ptr->full_sb_count;
                         }
                     }
                 }
             }
+        }
 
-            eb_release_mutex(picture_control_set_ptr->rc_distortion_histogram_mutex);
+        eb_release_mutex(picture_control_set_ptr->rc_distortion_histogram_mutex);
 
-            // Get Empty Results Object
-            eb_get_empty_object(
-                context_ptr->motion_estimation_results_output_fifo_ptr,
-                &outputResultsWrapperPtr);
+        // Get Empty Results Object
+        eb_get_empty_object(
+            context_ptr->motion_estimation_results_output_fifo_ptr,
+            &outputResultsWrapperPtr);
 
-            outputResultsPtr = (MotionEstimationResults*)outputResultsWrapperPtr->object_ptr;
-            outputResultsPtr->picture_control_set_wrapper_ptr = inputResultsPtr->picture_control_set_wrapper_ptr;
-            outputResultsPtr->segment_index = segment_index;
+        outputResultsPtr = (MotionEstimationResults*)outputResultsWrapperPtr->object_ptr;
+        outputResultsPtr->picture_control_set_wrapper_ptr = inputResultsPtr->picture_control_set_wrapper_ptr;
+        outputResultsPtr->segment_index = segment_index;
 
-            // Release the Input Results
-            eb_release_object(inputResultsWrapperPtr);
+        // Release the Input Results
+        eb_release_object(inputResultsWrapperPtr);
 
-            // Post the Full Results Object
-            eb_post_full_object(outputResultsWrapperPtr);
+        // Post the Full Results Object
+        eb_post_full_object(outputResultsWrapperPtr);
 
-        }
-        else {
+    }
+    else {
 
-        // ME Kernel Signal(s) derivation
-        tf_signal_derivation_me_kernel_oq(
-            sequence_control_set_ptr,
-            picture_control_set_ptr,
-            context_ptr);
+    // ME Kernel Signal(s) derivation
+    tf_signal_derivation_me_kernel_oq(
+        sequence_control_set_ptr,
+        picture_control_set_ptr,
+        context_ptr);
 
-        // temporal filtering start
-        context_ptr->me_context_ptr->me_alt_ref = EB_TRUE;
-        init_temporal_filtering(picture_control_set_ptr->temp_filt_pcs_list, picture_control_set_ptr, context_ptr, inputResultsPtr->segment_index);
+    // temporal filtering start
+    context_ptr->me_context_ptr->me_alt_ref = EB_TRUE;
+    init_temporal_filtering(picture_control_set_ptr->temp_filt_pcs_list, picture_control_set_ptr, context_ptr, inputResultsPtr->segment_index);
 
-        // Release the Input Results
-        eb_release_object(inputResultsWrapperPtr);
-        }
+    // Release the Input Results
+    eb_release_object(inputResultsWrapperPtr);
     }
+}
 
+/******************************************************
+ * Motion Estimation Kernel
+ ******************************************************/
+void* motion_estimation_kernel(void *input_ptr)
+{
+    MotionEstimationContext_t   *context_ptr = (MotionEstimationContext_t*)input_ptr;
+    EbObjectWrapper                       *inputResultsWrapperPtr;
+
+    for (;;) {
+        // Get Input Full Object
+        eb_get_full_object(
+            context_ptr->picture_decision_results_input_fifo_ptr,
+            &inputResultsWrapperPtr);
+
+        motion_estimation_task(input_ptr, inputResultsWrapperPtr);
+    }
     return EB_NULL;
 }
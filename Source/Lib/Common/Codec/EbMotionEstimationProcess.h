@@ -40,6 +40,7 @@ extern EbErrorType motion_estimation_context_ctor(
     uint8_t                     mrp_mode);
 
 extern void* motion_estimation_kernel(void *input_ptr);
+extern void motion_estimation_task(void *input_ptr, EbObjectWrapper *input_wrapper_ptr);
 
 EbErrorType signal_derivation_me_kernel_oq(SequenceControlSet        *sequence_control_set_ptr,
                                            PictureParentControlSet   *picture_control_set_ptr,
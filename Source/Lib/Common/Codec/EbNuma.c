@@ -0,0 +1,210 @@
+/*
+* Copyright(c) 2019 Intel Corporation
+* SPDX - License - Identifier: BSD - 2 - Clause - Patent
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "EbDefinitions.h"
+#include "EbThreads.h"
+#include "EbUtility.h"
+#include "EbNuma.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__linux__) && defined(SYS_set_mempolicy) && defined(SYS_mbind)
+#define NUMA_SUPPORTED                  1
+#else
+#define NUMA_SUPPORTED                  0
+#endif
+
+// Memory policy modes, from linux/mempolicy.h
+#define NUMA_MPOL_DEFAULT               0
+#define NUMA_MPOL_PREFERRED             1
+
+#define NUMA_MASK_BITS                  (8 * sizeof(unsigned long))
+#define NUMA_MASK_WORDS                 (EB_NUMA_NODE_MAX_COUNT / NUMA_MASK_BITS)
+
+static EB_THREAD_LOCAL int32_t  current_node = EB_NUMA_NODE_ANY;
+
+#if NUMA_SUPPORTED
+static uint32_t node_count = 0;
+
+static void numa_set_mask(unsigned long *mask, int32_t node)
+{
+    memset(mask, 0, NUMA_MASK_WORDS * sizeof(unsigned long));
+    mask[node / NUMA_MASK_BITS] = 1UL << (node % NUMA_MASK_BITS);
+}
+#endif
+
+/**************************************
+ * eb_numa_node_count
+ **************************************/
+uint32_t eb_numa_node_count(void)
+{
+#if NUMA_SUPPORTED
+    if (node_count == 0) {
+        // The online list looks like "0" or "0-1,4"; the highest id bounds the count
+        FILE    *fin = fopen("/sys/devices/system/node/online", "r");
+        uint32_t count = 1;
+        if (fin) {
+            char  line[256];
+            if (fgets(line, sizeof(line), fin)) {
+                char *p = line;
+                while (*p) {
+                    if (*p >= '0' && *p <= '9') {
+                        const uint32_t node = (uint32_t)strtoul(p, &p, 10);
+                        count = MAX(count, node + 1);
+                    }
+                    else
+                        ++p;
+                }
+            }
+            fclose(fin);
+        }
+        node_count = MIN(count, EB_NUMA_NODE_MAX_COUNT);
+    }
+    return node_count;
+#elif defined(_WIN32)
+    ULONG highest_node = 0;
+    if (!GetNumaHighestNodeNumber(&highest_node))
+        return 1;
+    return MIN((uint32_t)highest_node + 1, EB_NUMA_NODE_MAX_COUNT);
+#else
+    return 1;
+#endif
+}
+
+/**************************************
+ * eb_numa_cpu_node
+ **************************************/
+int32_t eb_numa_cpu_node(uint32_t cpu)
+{
+#if NUMA_SUPPORTED
+    const uint32_t count = eb_numa_node_count();
+    uint32_t node;
+    char     path[128];
+
+    for (node = 0; node < count; ++node) {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/node%u", cpu, node);
+        if (access(path, F_OK) == 0)
+            return (int32_t)node;
+    }
+#else
+    (void)cpu;
+#endif
+    return EB_NUMA_NODE_ANY;
+}
+
+/**************************************
+ * eb_numa_set_node
+ **************************************/
+void eb_numa_set_node(int32_t node)
+{
+    if (node >= EB_NUMA_NODE_MAX_COUNT)
+        node = EB_NUMA_NODE_ANY;
+    if (node == current_node)
+        return;
+    current_node = node;
+#if NUMA_SUPPORTED
+    if (node == EB_NUMA_NODE_ANY)
+        syscall(SYS_set_mempolicy, NUMA_MPOL_DEFAULT, NULL, 0);
+    else {
+        unsigned long mask[NUMA_MASK_WORDS];
+        numa_set_mask(mask, node);
+        // A failure (e.g. no permission in a container) keeps the default policy
+        syscall(SYS_set_mempolicy, NUMA_MPOL_PREFERRED, mask, EB_NUMA_NODE_MAX_COUNT + 1);
+    }
+#endif
+}
+
+int32_t eb_numa_get_node(void)
+{
+    return current_node;
+}
+
+/**************************************
+ * eb_numa_bind_memory
+ **************************************/
+void eb_numa_bind_memory(void *ptr, size_t size)
+{
+#if NUMA_SUPPORTED
+    static size_t page_size = 0;
+    unsigned long mask[NUMA_MASK_WORDS];
+    uintptr_t     start;
+    uintptr_t     end;
+
+    if (current_node == EB_NUMA_NODE_ANY || ptr == NULL || size < EB_NUMA_BIND_MIN_SIZE)
+        return;
+    if (page_size == 0)
+        page_size = (size_t)sysconf(_SC_PAGESIZE);
+
+    // Only the pages that belong to the allocation alone are bound, the
+    // partial pages at both ends follow the thread policy.
+    start = ((uintptr_t)ptr + page_size - 1) & ~(uintptr_t)(page_size - 1);
+    end = ((uintptr_t)ptr + size) & ~(uintptr_t)(page_size - 1);
+    if (end <= start)
+        return;
+
+    numa_set_mask(mask, current_node);
+    syscall(SYS_mbind, (void*)start, (unsigned long)(end - start), NUMA_MPOL_PREFERRED,
+        mask, EB_NUMA_NODE_MAX_COUNT + 1, 0);
+#else
+    (void)ptr;
+    (void)size;
+#endif
+}
+
+/**************************************
+ * eb_numa_get_memory_usage
+ *   Sums the N<node>=<pages> fields of /proc/self/numa_maps, each line
+ *   ends with the page size of its mapping.
+ **************************************/
+uint32_t eb_numa_get_memory_usage(
+    uint64_t *node_bytes_array,
+    uint32_t  node_max_count)
+{
+#if NUMA_SUPPORTED
+    const uint32_t count = MIN(eb_numa_node_count(), node_max_count);
+    uint64_t       line_pages[EB_NUMA_NODE_MAX_COUNT];
+    char           line[4096];
+    FILE          *fin = fopen("/proc/self/numa_maps", "r");
+
+    if (fin == NULL)
+        return 0;
+    memset(node_bytes_array, 0, count * sizeof(uint64_t));
+
+    while (fgets(line, sizeof(line), fin)) {
+        uint64_t page_kb = 4;
+        char    *p = line;
+
+        memset(line_pages, 0, sizeof(line_pages));
+        while ((p = strchr(p, ' ')) != NULL) {
+            ++p;
+            if (p[0] == 'N' && p[1] >= '0' && p[1] <= '9') {
+                char          *value;
+                const uint32_t node = (uint32_t)strtoul(p + 1, &value, 10);
+                if (*value == '=' && node < count)
+                    line_pages[node] += strtoull(value + 1, NULL, 10);
+            }
+            else if (strncmp(p, "kernelpagesize_kB=", 18) == 0)
+                page_kb = strtoull(p + 18, NULL, 10);
+        }
+        for (uint32_t node = 0; node < count; ++node)
+            node_bytes_array[node] += line_pages[node] * page_kb * 1024;
+    }
+    fclose(fin);
+    return count;
+#else
+    (void)node_bytes_array;
+    (void)node_max_count;
+    return 0;
+#endif
+}
@@ -0,0 +1,62 @@
+/*
+* Copyright(c) 2019 Intel Corporation
+* SPDX - License - Identifier: BSD - 2 - Clause - Patent
+*/
+
+#ifndef EbNuma_h
+#define EbNuma_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    /*********************************
+     * Defines
+     *********************************/
+#define EB_NUMA_NODE_ANY                -1
+#define EB_NUMA_NODE_MAX_COUNT          64
+
+    // Allocations smaller than this are left to the thread memory policy,
+    // binding them would split the heap into many small mappings.
+#define EB_NUMA_BIND_MIN_SIZE           (64 * 1024)
+
+    /*********************************************************************
+     * NUMA placement
+     *   Memory placement is per thread: the node selected with
+     *   eb_numa_set_node applies to the allocations of the calling thread
+     *   only. Placement is supported on Linux; on the other platforms the
+     *   calls are no-ops and memory stays where it is first touched.
+     *********************************************************************/
+
+    // Number of configured NUMA nodes, 1 when the system is not NUMA
+    extern uint32_t eb_numa_node_count(void);
+
+    // Node of the given logical processor, EB_NUMA_NODE_ANY if unknown
+    extern int32_t eb_numa_cpu_node(uint32_t cpu);
+
+    // Selects the node the calling thread allocates from,
+    // EB_NUMA_NODE_ANY restores the default first-touch placement.
+    extern void eb_numa_set_node(int32_t node);
+
+    extern int32_t eb_numa_get_node(void);
+
+    // Binds a new allocation to the node of the calling thread so that
+    // later first touches from other threads do not move it.
+    extern void eb_numa_bind_memory(void *ptr, size_t size);
+
+    /*********************************************************************
+     * eb_numa_get_memory_usage
+     *   Fills node_bytes_array with the bytes resident on each node for
+     *   the whole process. Returns the number of nodes reported, 0 when
+     *   the information is not available.
+     *********************************************************************/
+    extern uint32_t eb_numa_get_memory_usage(
+        uint64_t *node_bytes_array,
+        uint32_t  node_max_count);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbNuma_h
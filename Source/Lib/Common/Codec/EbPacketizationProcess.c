@@ -15,6 +15,7 @@
 #include "EbRateControlTasks.h"
 #include "EbTime.h"
 #include "EbModeDecisionProcess.h"
+#include "EbTrace.h"
 #if ENABLE_CDF_UPDATE
 #include "EbPictureDemuxResults.h"
 #endif
@@ -279,6 +280,7 @@ void* packetization_kernel(void *input_ptr)
             &entropyCodingResultsWrapperPtr);
         entropyCodingResultsPtr = (EntropyCodingResults*)entropyCodingResultsWrapperPtr->object_ptr;
         picture_control_set_ptr = (PictureControlSet*)entropyCodingResultsPtr->picture_control_set_wrapper_ptr->object_ptr;
+        eb_trace_set_object(picture_control_set_ptr->picture_number, EB_TRACE_NO_SEGMENT);
         sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
         encode_context_ptr = (EncodeContext*)sequence_control_set_ptr->encode_context_ptr;
         frm_hdr = &picture_control_set_ptr->parent_pcs_ptr->frm_hdr;
@@ -329,9 +331,13 @@ void* packetization_kernel(void *input_ptr)
             picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag == EB_TRUE &&
             picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr) {
 
-            eb_av1_reset_cdf_symbol_counters(picture_control_set_ptr->entropy_coder_ptr->fc);
+            // The CDFs of the last tile are signaled as the context update tile
+            const uint16_t tile_count = (uint16_t)(picture_control_set_ptr->parent_pcs_ptr->av1_cm->tiles_info.tile_cols *
+                picture_control_set_ptr->parent_pcs_ptr->av1_cm->tiles_info.tile_rows);
+            EntropyCoder *entropy_coder_ptr = picture_control_set_ptr->ec_tile_ptr_array[tile_count - 1]->entropy_coder_ptr;
+            eb_av1_reset_cdf_symbol_counters(entropy_coder_ptr->fc);
             ((EbReferenceObject*)picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr->object_ptr)->frame_context
-                = (*picture_control_set_ptr->entropy_coder_ptr->fc);
+                = (*entropy_coder_ptr->fc);
 
             // Get Empty Results Object
             eb_get_empty_object(
@@ -621,7 +627,12 @@ void* packetization_kernel(void *input_ptr)
             if (queueEntryPtr->is_alt_ref)
                 output_stream_ptr->flags |= (uint32_t)EB_BUFFERFLAG_IS_ALT_REF;
 
-            eb_post_full_object(output_stream_wrapper_ptr);
+            if (encode_context_ptr->packet_callback) {
+                output_stream_ptr->wrapper_ptr = (void*)output_stream_wrapper_ptr;
+                encode_context_ptr->packet_callback(encode_context_ptr->packet_context, output_stream_ptr);
+            }
+            else
+                eb_post_full_object(output_stream_wrapper_ptr);
             queueEntryPtr->out_meta_data = (EbLinkedListNode *)EB_NULL;
 
             // Reset the Reorder Queue Entry
@@ -23,6 +23,7 @@
 #include "EbMeSadCalculation.h"
 #include "EbComputeMean_SSE2.h"
 #include "EbCombinedAveragingSAD_Intrinsic_AVX2.h"
+#include "EbTrace.h"
 
 #define VARIANCE_PRECISION        16
 #define  LCU_LOW_VAR_TH                5
@@ -4799,7 +4800,7 @@ void DownsampleFilteringInputPicture(
 }
 
 /************************************************
- * Picture Analysis Kernel
+ * Picture Analysis Task
  * The Picture Analysis Process pads & decimates the input pictures.
  * The Picture Analysis also includes creating an n-bin Histogram,
  * gathering picture 1st and 2nd moment statistics for each 8x8 block,
@@ -4807,13 +4808,12 @@ void DownsampleFilteringInputPicture(
  * The Picture Analysis process is multithreaded, so pictures can be
  * processed out of order as long as all inputs are available.
  ************************************************/
-void* picture_analysis_kernel(void *input_ptr)
+void picture_analysis_task(void *input_ptr, EbObjectWrapper *inputResultsWrapperPtr)
 {
     PictureAnalysisContext        *context_ptr = (PictureAnalysisContext*)input_ptr;
     PictureParentControlSet       *picture_control_set_ptr;
     SequenceControlSet            *sequence_control_set_ptr;
 
-    EbObjectWrapper               *inputResultsWrapperPtr;
     ResourceCoordinationResults   *inputResultsPtr;
     EbObjectWrapper               *outputResultsWrapperPtr;
     PictureAnalysisResults        *outputResultsPtr;
@@ -4828,113 +4828,125 @@ void* picture_analysis_kernel(void *input_ptr)
     uint32_t                        sb_total_count;
     EbAsm                           asm_type;
 
-    for (;;) {
-        // Get Input Full Object
-        eb_get_full_object(
-            context_ptr->resource_coordination_results_input_fifo_ptr,
-            &inputResultsWrapperPtr);
+    inputResultsPtr = (ResourceCoordinationResults*)inputResultsWrapperPtr->object_ptr;
+    picture_control_set_ptr = (PictureParentControlSet*)inputResultsPtr->picture_control_set_wrapper_ptr->object_ptr;
+    eb_trace_set_object(picture_control_set_ptr->picture_number, EB_TRACE_NO_SEGMENT);
 
-        inputResultsPtr = (ResourceCoordinationResults*)inputResultsWrapperPtr->object_ptr;
-        picture_control_set_ptr = (PictureParentControlSet*)inputResultsPtr->picture_control_set_wrapper_ptr->object_ptr;
+    // There is no need to do processing for overlay picture. Overlay and AltRef share the same results.
+    if (!picture_control_set_ptr->is_overlay)
+    {
+        sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
+        input_picture_ptr = picture_control_set_ptr->enhanced_picture_ptr;
 
-        // There is no need to do processing for overlay picture. Overlay and AltRef share the same results.
-        if (!picture_control_set_ptr->is_overlay)
-        {
-            sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
-            input_picture_ptr = picture_control_set_ptr->enhanced_picture_ptr;
+        paReferenceObject = (EbPaReferenceObject*)picture_control_set_ptr->pa_reference_picture_wrapper_ptr->object_ptr;
+        input_padded_picture_ptr = (EbPictureBufferDesc*)paReferenceObject->input_padded_picture_ptr;
+        // Variance
+        picture_width_in_sb = (sequence_control_set_ptr->seq_header.max_frame_width + sequence_control_set_ptr->sb_sz - 1) / sequence_control_set_ptr->sb_sz;
+        pictureHeighInLcu = (sequence_control_set_ptr->seq_header.max_frame_height + sequence_control_set_ptr->sb_sz - 1) / sequence_control_set_ptr->sb_sz;
+        sb_total_count = picture_width_in_sb * pictureHeighInLcu;
 
-            paReferenceObject = (EbPaReferenceObject*)picture_control_set_ptr->pa_reference_picture_wrapper_ptr->object_ptr;
-            input_padded_picture_ptr = (EbPictureBufferDesc*)paReferenceObject->input_padded_picture_ptr;
-            // Variance
-            picture_width_in_sb = (sequence_control_set_ptr->seq_header.max_frame_width + sequence_control_set_ptr->sb_sz - 1) / sequence_control_set_ptr->sb_sz;
-            pictureHeighInLcu = (sequence_control_set_ptr->seq_header.max_frame_height + sequence_control_set_ptr->sb_sz - 1) / sequence_control_set_ptr->sb_sz;
-            sb_total_count = picture_width_in_sb * pictureHeighInLcu;
+        asm_type = sequence_control_set_ptr->encode_context_ptr->asm_type;
 
-            asm_type = sequence_control_set_ptr->encode_context_ptr->asm_type;
+        // Set picture parameters to account for subpicture, picture scantype, and set regions by resolutions
+        SetPictureParametersForStatisticsGathering(
+            sequence_control_set_ptr);
 
-            // Set picture parameters to account for subpicture, picture scantype, and set regions by resolutions
-            SetPictureParametersForStatisticsGathering(
-                sequence_control_set_ptr);
+        // Pad pictures to multiple min cu size
+        PadPictureToMultipleOfMinCuSizeDimensions(
+            sequence_control_set_ptr,
+            input_picture_ptr);
 
-            // Pad pictures to multiple min cu size
-            PadPictureToMultipleOfMinCuSizeDimensions(
-                sequence_control_set_ptr,
-                input_picture_ptr);
+        // Pre processing operations performed on the input picture
+        PicturePreProcessingOperations(
+            picture_control_set_ptr,
+            sequence_control_set_ptr,
+            sb_total_count,
+            asm_type);
+        if (input_picture_ptr->color_format >= EB_YUV422) {
+            // Jing: Do the conversion of 422/444=>420 here since it's multi-threaded kernel
+            //       Reuse the Y, only add cb/cr in the newly created buffer desc
+            //       NOTE: since denoise may change the src, so this part is after PicturePreProcessingOperations()
+            picture_control_set_ptr->chroma_downsampled_picture_ptr->buffer_y = input_picture_ptr->buffer_y;
+            DownSampleChroma(input_picture_ptr, picture_control_set_ptr->chroma_downsampled_picture_ptr);
+        }
+        else
+            picture_control_set_ptr->chroma_downsampled_picture_ptr = input_picture_ptr;
+        // Pad input picture to complete border LCUs
+        PadPictureToMultipleOfLcuDimensions(
+            input_padded_picture_ptr);
+        // 1/4 & 1/16 input picture decimation
+        DownsampleDecimationInputPicture(
+            picture_control_set_ptr,
+            input_padded_picture_ptr,
+            (EbPictureBufferDesc*)paReferenceObject->quarter_decimated_picture_ptr,
+            (EbPictureBufferDesc*)paReferenceObject->sixteenth_decimated_picture_ptr);
 
-            // Pre processing operations performed on the input picture
-            PicturePreProcessingOperations(
-                picture_control_set_ptr,
-                sequence_control_set_ptr,
-                sb_total_count,
-                asm_type);
-            if (input_picture_ptr->color_format >= EB_YUV422) {
-                // Jing: Do the conversion of 422/444=>420 here since it's multi-threaded kernel
-                //       Reuse the Y, only add cb/cr in the newly created buffer desc
-                //       NOTE: since denoise may change the src, so this part is after PicturePreProcessingOperations()
-                picture_control_set_ptr->chroma_downsampled_picture_ptr->buffer_y = input_picture_ptr->buffer_y;
-                DownSampleChroma(input_picture_ptr, picture_control_set_ptr->chroma_downsampled_picture_ptr);
-            }
-            else
-                picture_control_set_ptr->chroma_downsampled_picture_ptr = input_picture_ptr;
-            // Pad input picture to complete border LCUs
-            PadPictureToMultipleOfLcuDimensions(
-                input_padded_picture_ptr);
-            // 1/4 & 1/16 input picture decimation
-            DownsampleDecimationInputPicture(
-                picture_control_set_ptr,
-                input_padded_picture_ptr,
-                (EbPictureBufferDesc*)paReferenceObject->quarter_decimated_picture_ptr,
-                (EbPictureBufferDesc*)paReferenceObject->sixteenth_decimated_picture_ptr);
-
-            // 1/4 & 1/16 input picture downsampling through filtering
-            if (sequence_control_set_ptr->down_sampling_method_me_search == ME_FILTERED_DOWNSAMPLED) {
-                DownsampleFilteringInputPicture(
-                    picture_control_set_ptr,
-                    input_padded_picture_ptr,
-                    (EbPictureBufferDesc*)paReferenceObject->quarter_filtered_picture_ptr,
-                    (EbPictureBufferDesc*)paReferenceObject->sixteenth_filtered_picture_ptr);
-            }
-           // Gathering statistics of input picture, including Variance Calculation, Histogram Bins
-            GatheringPictureStatistics(
-                sequence_control_set_ptr,
+        // 1/4 & 1/16 input picture downsampling through filtering
+        if (sequence_control_set_ptr->down_sampling_method_me_search == ME_FILTERED_DOWNSAMPLED) {
+            DownsampleFilteringInputPicture(
                 picture_control_set_ptr,
-                picture_control_set_ptr->chroma_downsampled_picture_ptr, //420 input_picture_ptr
                 input_padded_picture_ptr,
-                (EbPictureBufferDesc*)paReferenceObject->sixteenth_decimated_picture_ptr, // Hsan: always use decimated until studying the trade offs
-                sb_total_count,
-                asm_type);
+                (EbPictureBufferDesc*)paReferenceObject->quarter_filtered_picture_ptr,
+                (EbPictureBufferDesc*)paReferenceObject->sixteenth_filtered_picture_ptr);
+        }
+       // Gathering statistics of input picture, including Variance Calculation, Histogram Bins
+        GatheringPictureStatistics(
+            sequence_control_set_ptr,
+            picture_control_set_ptr,
+            picture_control_set_ptr->chroma_downsampled_picture_ptr, //420 input_picture_ptr
+            input_padded_picture_ptr,
+            (EbPictureBufferDesc*)paReferenceObject->sixteenth_decimated_picture_ptr, // Hsan: always use decimated until studying the trade offs
+            sb_total_count,
+            asm_type);
 
-            if (sequence_control_set_ptr->static_config.screen_content_mode == 2){ // auto detect
-                is_screen_content(
-                    picture_control_set_ptr,
-                    input_picture_ptr->buffer_y + input_picture_ptr->origin_x + input_picture_ptr->origin_y*input_picture_ptr->stride_y,
-                    0,
-                    input_picture_ptr->stride_y,
-                    sequence_control_set_ptr->seq_header.max_frame_width, sequence_control_set_ptr->seq_header.max_frame_height);
-            }
-            else // off / on
-                picture_control_set_ptr->sc_content_detected = sequence_control_set_ptr->static_config.screen_content_mode;
-
-            // Hold the 64x64 variance and mean in the reference frame
-            uint32_t sb_index;
-            for (sb_index = 0; sb_index < picture_control_set_ptr->sb_total_count; ++sb_index) {
-                paReferenceObject->variance[sb_index] = picture_control_set_ptr->variance[sb_index][ME_TIER_ZERO_PU_64x64];
-                paReferenceObject->y_mean[sb_index] = picture_control_set_ptr->y_mean[sb_index][ME_TIER_ZERO_PU_64x64];
-            }
+        if (sequence_control_set_ptr->static_config.screen_content_mode == 2){ // auto detect
+            is_screen_content(
+                picture_control_set_ptr,
+                input_picture_ptr->buffer_y + input_picture_ptr->origin_x + input_picture_ptr->origin_y*input_picture_ptr->stride_y,
+                0,
+                input_picture_ptr->stride_y,
+                sequence_control_set_ptr->seq_header.max_frame_width, sequence_control_set_ptr->seq_header.max_frame_height);
+        }
+        else // off / on
+            picture_control_set_ptr->sc_content_detected = sequence_control_set_ptr->static_config.screen_content_mode;
+
+        // Hold the 64x64 variance and mean in the reference frame
+        uint32_t sb_index;
+        for (sb_index = 0; sb_index < picture_control_set_ptr->sb_total_count; ++sb_index) {
+            paReferenceObject->variance[sb_index] = picture_control_set_ptr->variance[sb_index][ME_TIER_ZERO_PU_64x64];
+            paReferenceObject->y_mean[sb_index] = picture_control_set_ptr->y_mean[sb_index][ME_TIER_ZERO_PU_64x64];
         }
-        // Get Empty Results Object
-        eb_get_empty_object(
-            context_ptr->picture_analysis_results_output_fifo_ptr,
-            &outputResultsWrapperPtr);
+    }
+    // Get Empty Results Object
+    eb_get_empty_object(
+        context_ptr->picture_analysis_results_output_fifo_ptr,
+        &outputResultsWrapperPtr);
 
-        outputResultsPtr = (PictureAnalysisResults*)outputResultsWrapperPtr->object_ptr;
-        outputResultsPtr->picture_control_set_wrapper_ptr = inputResultsPtr->picture_control_set_wrapper_ptr;
+    outputResultsPtr = (PictureAnalysisResults*)outputResultsWrapperPtr->object_ptr;
+    outputResultsPtr->picture_control_set_wrapper_ptr = inputResultsPtr->picture_control_set_wrapper_ptr;
 
-        // Release the Input Results
-        eb_release_object(inputResultsWrapperPtr);
+    // Release the Input Results
+    eb_release_object(inputResultsWrapperPtr);
+
+    // Post the Full Results Object
+    eb_post_full_object(outputResultsWrapperPtr);
+}
+
+/******************************************************
+ * Picture Analysis Kernel
+ ******************************************************/
+void* picture_analysis_kernel(void *input_ptr)
+{
+    PictureAnalysisContext        *context_ptr = (PictureAnalysisContext*)input_ptr;
+    EbObjectWrapper                       *inputResultsWrapperPtr;
+
+    for (;;) {
+        // Get Input Full Object
+        eb_get_full_object(
+            context_ptr->resource_coordination_results_input_fifo_ptr,
+            &inputResultsWrapperPtr);
 
-        // Post the Full Results Object
-        eb_post_full_object(outputResultsWrapperPtr);
+        picture_analysis_task(input_ptr, inputResultsWrapperPtr);
     }
     return EB_NULL;
 }
@@ -35,6 +35,7 @@ extern EbErrorType picture_analysis_context_ctor(
     EbFifo                      *picture_analysis_results_output_fifo_ptr);
 
 extern void* picture_analysis_kernel(void *input_ptr);
+extern void picture_analysis_task(void *input_ptr, EbObjectWrapper *input_wrapper_ptr);
 
 void noise_extract_luma_weak(
     EbPictureBufferDesc *input_picture_ptr,
@@ -15,23 +15,56 @@
 */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "EbPictureBufferDesc.h"
+#include "EbArena.h"
+
+/*****************************************
+ * eb_picture_buffer_desc_alloc_plane
+ *****************************************/
+EbErrorType eb_picture_buffer_desc_alloc_plane(
+    EbPictureBufferDesc *pictureBufferDescPtr,
+    EbByte              *plane_ptr,
+    size_t               plane_size)
+{
+    if (pictureBufferDescPtr->arena_ptr) {
+        *plane_ptr = (EbByte)eb_arena_alloc(pictureBufferDescPtr->arena_ptr, plane_size);
+        if (*plane_ptr == NULL)
+            return EB_ErrorInsufficientResources;
+        memset(*plane_ptr, 0, plane_size);
+    }
+    else
+        EB_CALLOC_ALIGNED_ARRAY(*plane_ptr, plane_size);
+    return EB_ErrorNone;
+}
+
+void eb_picture_buffer_desc_free_plane(
+    EbPictureBufferDesc *pictureBufferDescPtr,
+    EbByte              *plane_ptr)
+{
+    if (pictureBufferDescPtr->arena_ptr) {
+        eb_arena_free(pictureBufferDescPtr->arena_ptr, *plane_ptr);
+        *plane_ptr = NULL;
+    }
+    else
+        EB_FREE_ALIGNED_ARRAY(*plane_ptr);
+}
 
 static void eb_picture_buffer_desc_dctor(EbPtr p)
 {
     EbPictureBufferDesc *obj = (EbPictureBufferDesc*)p;
     if (obj->buffer_enable_mask & PICTURE_BUFFER_DESC_Y_FLAG) {
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_y);
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_bit_inc_y);
+        eb_picture_buffer_desc_free_plane(obj, &obj->buffer_y);
+        eb_picture_buffer_desc_free_plane(obj, &obj->buffer_bit_inc_y);
     }
     if (obj->buffer_enable_mask & PICTURE_BUFFER_DESC_Cb_FLAG) {
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_cb);
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_bit_inc_cb);
+        eb_picture_buffer_desc_free_plane(obj, &obj->buffer_cb);
+        eb_picture_buffer_desc_free_plane(obj, &obj->buffer_bit_inc_cb);
     }
     if (obj->buffer_enable_mask & PICTURE_BUFFER_DESC_Cb_FLAG) {
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_cr);
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_bit_inc_cr);
+        eb_picture_buffer_desc_free_plane(obj, &obj->buffer_cr);
+        eb_picture_buffer_desc_free_plane(obj, &obj->buffer_bit_inc_cr);
     }
 }
 
@@ -51,6 +84,7 @@ EbErrorType eb_picture_buffer_desc_ctor(
     const uint16_t subsampling_x = (pictureBufferDescInitDataPtr->color_format == EB_YUV444 ? 1 : 2) - 1;
 
     pictureBufferDescPtr->dctor = eb_picture_buffer_desc_dctor;
+    pictureBufferDescPtr->arena_ptr = eb_arena_get_current();
 
     if (pictureBufferDescInitDataPtr->bit_depth > EB_8BIT && pictureBufferDescInitDataPtr->bit_depth <= EB_16BIT && pictureBufferDescInitDataPtr->split_mode == EB_TRUE)
         bytesPerPixel = 1;
@@ -81,26 +115,26 @@ EbErrorType eb_picture_buffer_desc_ctor(
 
     // Allocate the Picture Buffers (luma & chroma)
     if (pictureBufferDescInitDataPtr->buffer_enable_mask & PICTURE_BUFFER_DESC_Y_FLAG) {
-        EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_y, pictureBufferDescPtr->luma_size * bytesPerPixel);
+        EB_ALLOC_PICTURE_PLANE(pictureBufferDescPtr, buffer_y, pictureBufferDescPtr->luma_size * bytesPerPixel);
         pictureBufferDescPtr->buffer_bit_inc_y = 0;
         if (pictureBufferDescInitDataPtr->split_mode == EB_TRUE) {
-            EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_bit_inc_y, pictureBufferDescPtr->luma_size * bytesPerPixel);
+            EB_ALLOC_PICTURE_PLANE(pictureBufferDescPtr, buffer_bit_inc_y, pictureBufferDescPtr->luma_size * bytesPerPixel);
         }
     }
 
     if (pictureBufferDescInitDataPtr->buffer_enable_mask & PICTURE_BUFFER_DESC_Cb_FLAG) {
-        EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_cb, pictureBufferDescPtr->chroma_size * bytesPerPixel);
+        EB_ALLOC_PICTURE_PLANE(pictureBufferDescPtr, buffer_cb, pictureBufferDescPtr->chroma_size * bytesPerPixel);
         pictureBufferDescPtr->buffer_bit_inc_cb = 0;
         if (pictureBufferDescInitDataPtr->split_mode == EB_TRUE) {
-            EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_bit_inc_cb, pictureBufferDescPtr->chroma_size * bytesPerPixel);
+            EB_ALLOC_PICTURE_PLANE(pictureBufferDescPtr, buffer_bit_inc_cb, pictureBufferDescPtr->chroma_size * bytesPerPixel);
         }
     }
 
     if (pictureBufferDescInitDataPtr->buffer_enable_mask & PICTURE_BUFFER_DESC_Cr_FLAG) {
-        EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_cr, pictureBufferDescPtr->chroma_size * bytesPerPixel);
+        EB_ALLOC_PICTURE_PLANE(pictureBufferDescPtr, buffer_cr, pictureBufferDescPtr->chroma_size * bytesPerPixel);
         pictureBufferDescPtr->buffer_bit_inc_cr = 0;
         if (pictureBufferDescInitDataPtr->split_mode == EB_TRUE) {
-            EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_bit_inc_cr, pictureBufferDescPtr->chroma_size * bytesPerPixel);
+            EB_ALLOC_PICTURE_PLANE(pictureBufferDescPtr, buffer_bit_inc_cr, pictureBufferDescPtr->chroma_size * bytesPerPixel);
         }
     }
 
@@ -111,11 +145,11 @@ void eb_recon_picture_buffer_desc_dctor(EbPtr p)
 {
     EbPictureBufferDesc *obj = (EbPictureBufferDesc*)p;
     if (obj->buffer_enable_mask & PICTURE_BUFFER_DESC_Y_FLAG)
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_y);
+        eb_picture_buffer_desc_free_plane(obj, &obj->buffer_y);
     if (obj->buffer_enable_mask & PICTURE_BUFFER_DESC_Cb_FLAG)
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_cb);
+        eb_picture_buffer_desc_free_plane(obj, &obj->buffer_cb);
     if (obj->buffer_enable_mask & PICTURE_BUFFER_DESC_Cb_FLAG)
-        EB_FREE_ALIGNED_ARRAY(obj->buffer_cr);
+        eb_picture_buffer_desc_free_plane(obj, &obj->buffer_cr);
 }
 /*****************************************
  * eb_recon_picture_buffer_desc_ctor
@@ -133,6 +167,7 @@ EbErrorType eb_recon_picture_buffer_desc_ctor(
     uint32_t bytesPerPixel = (pictureBufferDescInitDataPtr->bit_depth == EB_8BIT) ? 1 : 2;
 
     pictureBufferDescPtr->dctor = eb_recon_picture_buffer_desc_dctor;
+    pictureBufferDescPtr->arena_ptr = eb_arena_get_current();
     // Set the Picture Buffer Static variables
     pictureBufferDescPtr->max_width = pictureBufferDescInitDataPtr->max_width;
     pictureBufferDescPtr->max_height = pictureBufferDescInitDataPtr->max_height;
@@ -153,13 +188,13 @@ EbErrorType eb_recon_picture_buffer_desc_ctor(
 
     // Allocate the Picture Buffers (luma & chroma)
     if (pictureBufferDescInitDataPtr->buffer_enable_mask & PICTURE_BUFFER_DESC_Y_FLAG) {
-        EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_y, pictureBufferDescPtr->luma_size * bytesPerPixel);
+        EB_ALLOC_PICTURE_PLANE(pictureBufferDescPtr, buffer_y, pictureBufferDescPtr->luma_size * bytesPerPixel);
     }
     if (pictureBufferDescInitDataPtr->buffer_enable_mask & PICTURE_BUFFER_DESC_Cb_FLAG) {
-        EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_cb, pictureBufferDescPtr->chroma_size * bytesPerPixel);
+        EB_ALLOC_PICTURE_PLANE(pictureBufferDescPtr, buffer_cb, pictureBufferDescPtr->chroma_size * bytesPerPixel);
    }
     if (pictureBufferDescInitDataPtr->buffer_enable_mask & PICTURE_BUFFER_DESC_Cr_FLAG) {
-        EB_CALLOC_ALIGNED_ARRAY(pictureBufferDescPtr->buffer_cr, pictureBufferDescPtr->chroma_size * bytesPerPixel);
+        EB_ALLOC_PICTURE_PLANE(pictureBufferDescPtr, buffer_cr, pictureBufferDescPtr->chroma_size * bytesPerPixel);
     }
     return EB_ErrorNone;
 }
@@ -62,6 +62,7 @@ extern "C" {
 
         EbBool            film_grain_flag;  // Indicates if film grain parameters are present for the frame
         uint32_t          buffer_enable_mask;
+        struct EbArena   *arena_ptr;        // Arena the planes are carved from, NULL for the heap
     } EbPictureBufferDesc;
 
 #define YV12_FLAG_HIGHBITDEPTH 8
@@ -315,6 +316,22 @@ extern "C" {
         EbPictureBufferDesc *object_ptr,
         EbPtr  object_init_data_ptr);
 
+    // Zeroed plane from the arena of the descriptor, or from the heap
+    extern EbErrorType eb_picture_buffer_desc_alloc_plane(
+        EbPictureBufferDesc *object_ptr,
+        EbByte              *plane_ptr,
+        size_t               plane_size);
+
+    extern void eb_picture_buffer_desc_free_plane(
+        EbPictureBufferDesc *object_ptr,
+        EbByte              *plane_ptr);
+
+#define EB_ALLOC_PICTURE_PLANE(desc, plane, size) \
+    do { \
+        if (eb_picture_buffer_desc_alloc_plane(desc, &(desc)->plane, size) != EB_ErrorNone) \
+            return EB_ErrorInsufficientResources; \
+    } while (0)
+
 #ifdef __cplusplus
 }
 #endif
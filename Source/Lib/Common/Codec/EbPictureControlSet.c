@@ -19,6 +19,7 @@
 #include "EbDefinitions.h"
 #include "EbPictureControlSet.h"
 #include "EbPictureBufferDesc.h"
+#include "EbEntropyCoding.h"
 
 void *eb_aom_memalign(size_t align, size_t size);
 void eb_aom_free(void *memblk);
@@ -129,6 +130,9 @@ void picture_control_set_dctor(EbPtr p)
     uint8_t depth;
     av1_hash_table_destroy(&obj->hash_table);
     EB_DELETE(obj->enc_dec_segment_ctrl);
+    EB_DELETE(obj->dlf_row_segments);
+    EB_DELETE(obj->cdef_row_segments);
+    EB_DELETE(obj->rest_row_segments);
     EB_DELETE(obj->ep_intra_luma_mode_neighbor_array);
     EB_DELETE(obj->ep_intra_chroma_mode_neighbor_array);
     EB_DELETE(obj->ep_mv_neighbor_array);
@@ -141,23 +145,10 @@ void picture_control_set_dctor(EbPtr p)
     EB_DELETE(obj->ep_luma_dc_sign_level_coeff_neighbor_array);
     EB_DELETE(obj->ep_cb_dc_sign_level_coeff_neighbor_array);
     EB_DELETE(obj->ep_cr_dc_sign_level_coeff_neighbor_array);
-    EB_DELETE(obj->mode_type_neighbor_array);
-    EB_DELETE(obj->partition_context_neighbor_array);
-    EB_DELETE(obj->skip_flag_neighbor_array);
-    EB_DELETE(obj->skip_coeff_neighbor_array);
-    EB_DELETE(obj->luma_dc_sign_level_coeff_neighbor_array);
-    EB_DELETE(obj->cr_dc_sign_level_coeff_neighbor_array);
-    EB_DELETE(obj->cb_dc_sign_level_coeff_neighbor_array);
-    EB_DELETE(obj->inter_pred_dir_neighbor_array);
-    EB_DELETE(obj->ref_frame_type_neighbor_array);
-    EB_DELETE(obj->intra_luma_mode_neighbor_array);
-    EB_DELETE(obj->txfm_context_array);
-    EB_DELETE(obj->segmentation_id_pred_array);
     EB_DELETE(obj->segmentation_neighbor_map);
     EB_DELETE(obj->ep_luma_recon_neighbor_array16bit);
     EB_DELETE(obj->ep_cb_recon_neighbor_array16bit);
     EB_DELETE(obj->ep_cr_recon_neighbor_array16bit);
-    EB_DELETE(obj->interpolation_type_neighbor_array);
 
     for (depth = 0; depth < NEIGHBOR_ARRAY_TOTAL_COUNT; depth++) {
         EB_DELETE(obj->md_intra_luma_mode_neighbor_array[depth]);
@@ -191,7 +182,7 @@ void picture_control_set_dctor(EbPtr p)
     EB_DELETE_PTR_ARRAY(obj->sb_ptr_array, obj->sb_total_count);
     EB_DELETE(obj->coeff_est_entropy_coder_ptr);
     EB_DELETE(obj->bitstream_ptr);
-    EB_DELETE(obj->entropy_coder_ptr);
+    EB_DELETE_PTR_ARRAY(obj->ec_tile_ptr_array, obj->ec_tile_max_count);
     EB_DELETE(obj->recon_picture32bit_ptr);
     EB_DELETE(obj->recon_picture16bit_ptr);
     EB_DELETE(obj->recon_picture_ptr);
@@ -215,6 +206,9 @@ void picture_control_set_dctor(EbPtr p)
     EB_FREE_ARRAY(obj->qp_array);
     EB_DESTROY_MUTEX(obj->entropy_coding_mutex);
     EB_DESTROY_MUTEX(obj->intra_mutex);
+    EB_DESTROY_MUTEX(obj->enc_dec_progress_mutex);
+    EB_DESTROY_SEMAPHORE(obj->enc_dec_progress_semaphore);
+    EB_FREE_ARRAY(obj->enc_dec_row_sb_count_array);
     EB_DESTROY_MUTEX(obj->cdef_search_mutex);
     EB_DESTROY_MUTEX(obj->rest_search_mutex);
 
@@ -247,6 +241,168 @@ EbErrorType create_neighbor_array_units(InitData* data, size_t count)
     return EB_ErrorNone;
 }
 
+static void entropy_coding_tile_dctor(EbPtr p)
+{
+    EntropyCodingTile *obj = (EntropyCodingTile*)p;
+    EB_DELETE(obj->entropy_coder_ptr);
+    EB_DELETE(obj->mode_type_neighbor_array);
+    EB_DELETE(obj->partition_context_neighbor_array);
+    EB_DELETE(obj->skip_flag_neighbor_array);
+    EB_DELETE(obj->skip_coeff_neighbor_array);
+    EB_DELETE(obj->luma_dc_sign_level_coeff_neighbor_array);
+    EB_DELETE(obj->cr_dc_sign_level_coeff_neighbor_array);
+    EB_DELETE(obj->cb_dc_sign_level_coeff_neighbor_array);
+    EB_DELETE(obj->inter_pred_dir_neighbor_array);
+    EB_DELETE(obj->ref_frame_type_neighbor_array);
+    EB_DELETE(obj->intra_luma_mode_neighbor_array);
+    EB_DELETE(obj->txfm_context_array);
+    EB_DELETE(obj->segmentation_id_pred_array);
+    EB_DELETE(obj->interpolation_type_neighbor_array);
+}
+
+static EbErrorType entropy_coding_tile_ctor(
+    EntropyCodingTile *object_ptr,
+    uint32_t           buffer_size)
+{
+    EbErrorType return_error;
+
+    object_ptr->dctor = entropy_coding_tile_dctor;
+
+    EB_NEW(
+        object_ptr->entropy_coder_ptr,
+        entropy_coder_ctor,
+        buffer_size);
+    {
+        InitData data[] = {
+            {
+                &object_ptr->mode_type_neighbor_array,
+                MAX_PICTURE_WIDTH_SIZE,
+                MAX_PICTURE_HEIGHT_SIZE,
+                sizeof(uint8_t),
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
+            },
+            {
+                &object_ptr->partition_context_neighbor_array,
+                MAX_PICTURE_WIDTH_SIZE,
+                MAX_PICTURE_HEIGHT_SIZE,
+                sizeof(struct PartitionContext),
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
+            },
+            {
+                &object_ptr->skip_flag_neighbor_array,
+                MAX_PICTURE_WIDTH_SIZE,
+                MAX_PICTURE_HEIGHT_SIZE,
+                sizeof(uint8_t),
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
+            },
+            {
+                &object_ptr->skip_coeff_neighbor_array,
+                MAX_PICTURE_WIDTH_SIZE,
+                MAX_PICTURE_HEIGHT_SIZE,
+                sizeof(uint8_t),
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
+            },
+            // for each 4x4
+            {
+                &object_ptr->luma_dc_sign_level_coeff_neighbor_array,
+                MAX_PICTURE_WIDTH_SIZE,
+                MAX_PICTURE_HEIGHT_SIZE,
+                sizeof(uint8_t),
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
+            },
+            // for each 4x4
+            {
+                &object_ptr->cr_dc_sign_level_coeff_neighbor_array,
+                MAX_PICTURE_WIDTH_SIZE,
+                MAX_PICTURE_HEIGHT_SIZE,
+                sizeof(uint8_t),
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
+            },
+            // for each 4x4
+            {
+                &object_ptr->cb_dc_sign_level_coeff_neighbor_array,
+                MAX_PICTURE_WIDTH_SIZE,
+                MAX_PICTURE_HEIGHT_SIZE,
+                sizeof(uint8_t),
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
+            },
+            {
+                &object_ptr->inter_pred_dir_neighbor_array,
+                MAX_PICTURE_WIDTH_SIZE,
+                MAX_PICTURE_HEIGHT_SIZE,
+                sizeof(uint8_t),
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
+            },
+            {
+                &object_ptr->ref_frame_type_neighbor_array,
+                MAX_PICTURE_WIDTH_SIZE,
+                MAX_PICTURE_HEIGHT_SIZE,
+                sizeof(uint8_t),
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
+            },
+            {
+                &object_ptr->intra_luma_mode_neighbor_array,
+                MAX_PICTURE_WIDTH_SIZE,
+                MAX_PICTURE_HEIGHT_SIZE,
+                sizeof(uint8_t),
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
+            },
+            {
+                &object_ptr->txfm_context_array,
+                MAX_PICTURE_WIDTH_SIZE,
+                MAX_PICTURE_HEIGHT_SIZE,
+                sizeof(TXFM_CONTEXT),
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
+            },
+            {
+                &object_ptr->segmentation_id_pred_array,
+                MAX_PICTURE_WIDTH_SIZE,
+                MAX_PICTURE_HEIGHT_SIZE,
+                sizeof(uint8_t),
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                PU_NEIGHBOR_ARRAY_GRANULARITY,
+                NEIGHBOR_ARRAY_UNIT_FULL_MASK,
+            },
+        };
+        return_error = create_neighbor_array_units(data, DIM(data));
+        if (return_error == EB_ErrorInsufficientResources)
+            return EB_ErrorInsufficientResources;
+    }
+    EB_NEW(
+        object_ptr->interpolation_type_neighbor_array,
+        neighbor_array_unit_ctor32,
+        MAX_PICTURE_WIDTH_SIZE,
+        MAX_PICTURE_HEIGHT_SIZE,
+        sizeof(uint32_t),
+        PU_NEIGHBOR_ARRAY_GRANULARITY,
+        PU_NEIGHBOR_ARRAY_GRANULARITY,
+        NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK);
+
+    return EB_ErrorNone;
+}
+
 EbErrorType picture_control_set_ctor(
     PictureControlSet *object_ptr,
     EbPtr object_init_data_ptr)
@@ -364,11 +520,39 @@ EbErrorType picture_control_set_ctor(
             eb_picture_buffer_desc_ctor,
             (EbPtr)&coeffBufferDescInitData);
     }
-    // Entropy Coder
-    EB_NEW(
-        object_ptr->entropy_coder_ptr,
-        entropy_coder_ctor,
-        SEGMENT_ENTROPY_BUFFER_SIZE);
+    // Entropy Coding Tiles, as many as the configured tiles and the tile size
+    // limits can give a picture. The first tile codes the untiled pictures,
+    // the others get the share of the buffer of the largest tile and grow it
+    // when they code more than that.
+    {
+        const uint32_t sb_size = initDataPtr->sb_size_pix;
+        const uint32_t sb_cols = (initDataPtr->picture_width + sb_size - 1) / sb_size;
+        const uint32_t sb_rows = (initDataPtr->picture_height + sb_size - 1) / sb_size;
+        uint32_t log2_tile_cols = initDataPtr->tile_columns;
+        uint32_t log2_tile_rows = initDataPtr->tile_rows;
+        uint32_t tile_cols, tile_rows;
+        uint32_t tile_index;
+
+        while ((MAX_TILE_WIDTH / sb_size << log2_tile_cols) < sb_cols)
+            ++log2_tile_cols;
+        while ((MAX_TILE_AREA / (sb_size * sb_size) << log2_tile_rows) < sb_cols * sb_rows)
+            ++log2_tile_rows;
+        tile_cols = MIN((uint32_t)1 << log2_tile_cols, MIN(sb_cols, MAX_TILE_COLS));
+        tile_rows = MIN((uint32_t)1 << log2_tile_rows, MIN(sb_rows, MAX_TILE_ROWS));
+
+        object_ptr->ec_tile_max_count = (uint16_t)(tile_cols * tile_rows);
+        EB_ALLOC_PTR_ARRAY(object_ptr->ec_tile_ptr_array, object_ptr->ec_tile_max_count);
+        for (tile_index = 0; tile_index < object_ptr->ec_tile_max_count; ++tile_index) {
+            const uint64_t tile_sb_count = ((sb_cols + tile_cols - 1) / tile_cols) * ((sb_rows + tile_rows - 1) / tile_rows);
+            EB_NEW(
+                object_ptr->ec_tile_ptr_array[tile_index],
+                entropy_coding_tile_ctor,
+                tile_index ?
+                    (uint32_t)(SEGMENT_ENTROPY_BUFFER_SIZE * tile_sb_count / (sb_cols * sb_rows)) :
+                    SEGMENT_ENTROPY_BUFFER_SIZE);
+        }
+        object_ptr->entropy_coder_ptr = object_ptr->ec_tile_ptr_array[0]->entropy_coder_ptr;
+    }
 
     // Packetization process Bitstream
     EB_NEW(
@@ -789,119 +973,6 @@ EbErrorType picture_control_set_ctor(
                 PU_NEIGHBOR_ARRAY_GRANULARITY,
                 NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
             },
-
-            // Entropy Coding Neighbor Arrays
-            {
-                &object_ptr->mode_type_neighbor_array,
-                MAX_PICTURE_WIDTH_SIZE,
-                MAX_PICTURE_HEIGHT_SIZE,
-                sizeof(uint8_t),
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
-            },
-            {
-                &object_ptr->partition_context_neighbor_array,
-                MAX_PICTURE_WIDTH_SIZE,
-                MAX_PICTURE_HEIGHT_SIZE,
-                sizeof(struct PartitionContext),
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
-            },
-            {
-                &object_ptr->skip_flag_neighbor_array,
-                MAX_PICTURE_WIDTH_SIZE,
-                MAX_PICTURE_HEIGHT_SIZE,
-                sizeof(uint8_t),
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
-            },
-            {
-                &object_ptr->skip_coeff_neighbor_array,
-                MAX_PICTURE_WIDTH_SIZE,
-                MAX_PICTURE_HEIGHT_SIZE,
-                sizeof(uint8_t),
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
-            },
-            // for each 4x4
-            {
-                &object_ptr->luma_dc_sign_level_coeff_neighbor_array,
-                MAX_PICTURE_WIDTH_SIZE,
-                MAX_PICTURE_HEIGHT_SIZE,
-                sizeof(uint8_t),
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
-            },
-            // for each 4x4
-            {
-                &object_ptr->cr_dc_sign_level_coeff_neighbor_array,
-                MAX_PICTURE_WIDTH_SIZE,
-                MAX_PICTURE_HEIGHT_SIZE,
-                sizeof(uint8_t),
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
-            },
-            // for each 4x4
-            {
-                &object_ptr->cb_dc_sign_level_coeff_neighbor_array,
-                MAX_PICTURE_WIDTH_SIZE,
-                MAX_PICTURE_HEIGHT_SIZE,
-                sizeof(uint8_t),
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
-            },
-            {
-                &object_ptr->inter_pred_dir_neighbor_array,
-                MAX_PICTURE_WIDTH_SIZE,
-                MAX_PICTURE_HEIGHT_SIZE,
-                sizeof(uint8_t),
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
-            },
-            {
-                &object_ptr->ref_frame_type_neighbor_array,
-                MAX_PICTURE_WIDTH_SIZE,
-                MAX_PICTURE_HEIGHT_SIZE,
-                sizeof(uint8_t),
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
-            },
-            {
-                &object_ptr->intra_luma_mode_neighbor_array,
-                MAX_PICTURE_WIDTH_SIZE,
-                MAX_PICTURE_HEIGHT_SIZE,
-                sizeof(uint8_t),
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
-            },
-            {
-                &object_ptr->txfm_context_array,
-                MAX_PICTURE_WIDTH_SIZE,
-                MAX_PICTURE_HEIGHT_SIZE,
-                sizeof(TXFM_CONTEXT),
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK,
-            },
-            {
-                &object_ptr->segmentation_id_pred_array,
-                MAX_PICTURE_WIDTH_SIZE,
-                MAX_PICTURE_HEIGHT_SIZE,
-                sizeof(uint8_t),
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                PU_NEIGHBOR_ARRAY_GRANULARITY,
-                NEIGHBOR_ARRAY_UNIT_FULL_MASK,
-            },
         };
         return_error = create_neighbor_array_units(data, DIM(data));
         if (return_error == EB_ErrorInsufficientResources)
@@ -946,16 +1017,6 @@ EbErrorType picture_control_set_ctor(
         object_ptr->ep_cb_recon_neighbor_array16bit = 0;
         object_ptr->ep_cr_recon_neighbor_array16bit = 0;
     }
-    EB_NEW(
-        object_ptr->interpolation_type_neighbor_array,
-        neighbor_array_unit_ctor32,
-        MAX_PICTURE_WIDTH_SIZE,
-        MAX_PICTURE_HEIGHT_SIZE,
-        sizeof(uint32_t),
-        PU_NEIGHBOR_ARRAY_GRANULARITY,
-        PU_NEIGHBOR_ARRAY_GRANULARITY,
-        NEIGHBOR_ARRAY_UNIT_TOP_AND_LEFT_ONLY_MASK);
-
     //Segmentation neighbor arrays
     EB_NEW(
         object_ptr->segmentation_neighbor_map,
@@ -987,8 +1048,27 @@ EbErrorType picture_control_set_ctor(
 
     EB_CREATE_MUTEX(object_ptr->intra_mutex);
 
+    // EncDec row progress, each CDEF segment has at most one waiter
+    EB_CREATE_MUTEX(object_ptr->enc_dec_progress_mutex);
+    EB_CREATE_SEMAPHORE(object_ptr->enc_dec_progress_semaphore, 0, pictureLcuWidth * pictureLcuHeight);
+    EB_CALLOC_ARRAY(object_ptr->enc_dec_row_sb_count_array, pictureLcuHeight);
+
+    // Deblocking rows shared by the DLF threads
+    EB_NEW(
+        object_ptr->dlf_row_segments,
+        row_segments_ctor,
+        pictureLcuHeight,
+        pictureLcuHeight);
+
     EB_CREATE_MUTEX(object_ptr->cdef_search_mutex);
 
+    // Rows of 64x64 filter blocks shared by the CDEF threads
+    EB_NEW(
+        object_ptr->cdef_row_segments,
+        row_segments_ctor,
+        pictureLcuHeight,
+        pictureLcuHeight);
+
     //object_ptr->mse_seg[0] = (uint64_t(*)[64])eb_aom_malloc(sizeof(**object_ptr->mse_seg) *  pictureLcuWidth * pictureLcuHeight);
    // object_ptr->mse_seg[1] = (uint64_t(*)[64])eb_aom_malloc(sizeof(**object_ptr->mse_seg) *  pictureLcuWidth * pictureLcuHeight);
 
@@ -997,6 +1077,13 @@ EbErrorType picture_control_set_ctor(
 
     EB_CREATE_MUTEX(object_ptr->rest_search_mutex);
 
+    // Restoration stripes of the 3 planes shared by the Rest threads
+    EB_NEW(
+        object_ptr->rest_row_segments,
+        row_segments_ctor,
+        3 * (pictureLcuHeight + 1),
+        pictureLcuHeight);
+
     //the granularity is 4x4
 #if INCOMPLETE_SB_FIX
     EB_MALLOC_ARRAY(object_ptr->mi_grid_base, all_sb*(initDataPtr->sb_size_pix >> MI_SIZE_LOG2)*(initDataPtr->sb_size_pix >> MI_SIZE_LOG2));
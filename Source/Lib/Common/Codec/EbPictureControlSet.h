@@ -19,6 +19,7 @@
 #include "EbNeighborArrays.h"
 #include "EbModeDecisionSegments.h"
 #include "EbEncDecSegments.h"
+#include "EbRowSegments.h"
 #include "EbRateControlTables.h"
 #include "EbRestoration.h"
 #include "EbObject.h"
@@ -13646,6 +13647,40 @@ extern "C" {
         uint32_t current_row_idx;
     } MdSegmentCtrl;
 
+    /**************************************
+     * Entropy Coding Tile
+     *   The coder, neighbor arrays and reference filter
+     *   parameters a tile is entropy coded with. Each tile
+     *   of a picture has its own so that the tiles can be
+     *   coded by several Entropy Coding threads at once.
+     **************************************/
+    typedef struct EntropyCodingTile
+    {
+        EbDctor                             dctor;
+        EntropyCoder                       *entropy_coder_ptr;
+
+        // Neighbor Arrays
+        NeighborArrayUnit                  *mode_type_neighbor_array;
+        NeighborArrayUnit                  *partition_context_neighbor_array;
+        NeighborArrayUnit                  *intra_luma_mode_neighbor_array;
+        NeighborArrayUnit                  *skip_flag_neighbor_array;
+        NeighborArrayUnit                  *skip_coeff_neighbor_array;
+        NeighborArrayUnit                  *luma_dc_sign_level_coeff_neighbor_array; // Stored per 4x4. 8 bit: lower 6 bits (COEFF_CONTEXT_BITS), shows if there is at least one Coef. Top 2 bit store the sign of DC as follow: 0->0,1->-1,2-> 1
+        NeighborArrayUnit                  *cr_dc_sign_level_coeff_neighbor_array; // Stored per 4x4. 8 bit: lower 6 bits(COEFF_CONTEXT_BITS), shows if there is at least one Coef. Top 2 bit store the sign of DC as follow: 0->0,1->-1,2-> 1
+        NeighborArrayUnit                  *cb_dc_sign_level_coeff_neighbor_array; // Stored per 4x4. 8 bit: lower 6 bits(COEFF_CONTEXT_BITS), shows if there is at least one Coef. Top 2 bit store the sign of DC as follow: 0->0,1->-1,2-> 1
+        NeighborArrayUnit                  *txfm_context_array;
+        NeighborArrayUnit                  *inter_pred_dir_neighbor_array;
+        NeighborArrayUnit                  *ref_frame_type_neighbor_array;
+        NeighborArrayUnit32                *interpolation_type_neighbor_array;
+        NeighborArrayUnit                  *segmentation_id_pred_array;
+
+        // References of the coded CDEF strengths, restoration filters and delta QP
+        int32_t                             cdef_preset[4];
+        WienerInfo                          wiener_info[MAX_MB_PLANE];
+        SgrprojInfo                         sgrproj_info[MAX_MB_PLANE];
+        int32_t                             prev_qindex;
+    } EntropyCodingTile;
+
     /**************************************
      * Picture Control Set
      **************************************/
@@ -13693,7 +13728,7 @@ extern "C" {
 
         struct PictureParentControlSet     *parent_pcs_ptr;  //The parent of this PCS.
         EbObjectWrapper                    *picture_parent_control_set_wrapper_ptr;
-        EntropyCoder                       *entropy_coder_ptr;
+        EntropyCoder                       *entropy_coder_ptr; // owned by the first entropy coding tile
         // Packetization (used to encode SPS, PPS, etc)
         Bitstream                          *bitstream_ptr;
 
@@ -13722,8 +13757,16 @@ extern "C" {
         EbBool                                entropy_coding_pic_done;
         EbHandle                              intra_mutex;
         uint32_t                              intra_coded_area;
+        // EncDec SB rows done from the top, waited on by the filter stages
+        EbHandle                              enc_dec_progress_mutex;
+        EbHandle                              enc_dec_progress_semaphore;
+        uint32_t                              enc_dec_progress_waiter_count;
+        uint32_t                              enc_dec_row_progress;
+        uint16_t                             *enc_dec_row_sb_count_array;
+        RowSegments                          *dlf_row_segments;
         uint32_t                              tot_seg_searched_cdef;
         EbHandle                              cdef_search_mutex;
+        RowSegments                          *cdef_row_segments;
 
         uint16_t                              cdef_segments_total_count;
         uint8_t                               cdef_segments_column_count;
@@ -13736,6 +13779,7 @@ extern "C" {
 
         uint32_t                              tot_seg_searched_rest;
         EbHandle                              rest_search_mutex;
+        RowSegments                          *rest_row_segments;
         uint16_t                              rest_segments_total_count;
         uint8_t                               rest_segments_column_count;
         uint8_t                               rest_segments_row_count;
@@ -13814,21 +13858,11 @@ extern "C" {
         NeighborArrayUnit                  *ep_luma_dc_sign_level_coeff_neighbor_array;
         NeighborArrayUnit                  *ep_cr_dc_sign_level_coeff_neighbor_array;
         NeighborArrayUnit                  *ep_cb_dc_sign_level_coeff_neighbor_array;
-        // Entropy Coding Neighbor Arrays
-        NeighborArrayUnit                  *mode_type_neighbor_array;
-        NeighborArrayUnit                  *partition_context_neighbor_array;
-        NeighborArrayUnit                  *intra_luma_mode_neighbor_array;
-        NeighborArrayUnit                  *skip_flag_neighbor_array;
-        NeighborArrayUnit                  *skip_coeff_neighbor_array;
-        NeighborArrayUnit                  *luma_dc_sign_level_coeff_neighbor_array; // Stored per 4x4. 8 bit: lower 6 bits (COEFF_CONTEXT_BITS), shows if there is at least one Coef. Top 2 bit store the sign of DC as follow: 0->0,1->-1,2-> 1
-        NeighborArrayUnit                  *cr_dc_sign_level_coeff_neighbor_array; // Stored per 4x4. 8 bit: lower 6 bits(COEFF_CONTEXT_BITS), shows if there is at least one Coef. Top 2 bit store the sign of DC as follow: 0->0,1->-1,2-> 1
-        NeighborArrayUnit                  *cb_dc_sign_level_coeff_neighbor_array; // Stored per 4x4. 8 bit: lower 6 bits(COEFF_CONTEXT_BITS), shows if there is at least one Coef. Top 2 bit store the sign of DC as follow: 0->0,1->-1,2-> 1
-        NeighborArrayUnit                  *txfm_context_array;
-        NeighborArrayUnit                  *inter_pred_dir_neighbor_array;
-        NeighborArrayUnit                  *ref_frame_type_neighbor_array;
-        NeighborArrayUnit32                *interpolation_type_neighbor_array;
+        // Entropy Coding Tiles, the first one also codes the untiled pictures
+        EntropyCodingTile                 **ec_tile_ptr_array;
+        uint16_t                            ec_tile_max_count;
+        uint16_t                            ec_tile_coded_count;
 
-        NeighborArrayUnit                  *segmentation_id_pred_array;
         SegmentationNeighborMap              *segmentation_neighbor_map;
 
         ModeInfo                            **mi_grid_base; //2 SB Rows of mi Data are enough
@@ -13850,9 +13884,6 @@ extern "C" {
         EbEncMode                             enc_mode;
         EbBool                                intra_md_open_loop_flag;
         EbBool                                limit_intra;
-        int32_t                               cdef_preset[4];
-        WienerInfo                            wiener_info[MAX_MB_PLANE];
-        SgrprojInfo                           sgrproj_info[MAX_MB_PLANE];
         SpeedFeatures sf;
         SearchSiteConfig ss_cfg;//CHKN this might be a seq based
         HashTable hash_table;
@@ -14290,6 +14321,8 @@ extern "C" {
         uint32_t                           compressed_ten_bit_format;
         uint16_t                           enc_dec_segment_col;
         uint16_t                           enc_dec_segment_row;
+        uint8_t                            tile_rows;    // log2 of the configured tile rows
+        uint8_t                            tile_columns; // log2 of the configured tile columns
         EbEncMode                          enc_mode;
         uint8_t                            speed_control;
         EbBool                             hbd_mode_decision;
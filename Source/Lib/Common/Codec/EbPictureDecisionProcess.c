@@ -22,6 +22,7 @@
 #include "EbReferenceObject.h"
 #include "EbSvtAv1ErrorCodes.h"
 #include "EbTemporalFiltering.h"
+#include "EbTrace.h"
 
 /************************************************
  * Defines
@@ -2730,6 +2731,7 @@ void* picture_decision_kernel(void *input_ptr)
 
         inputResultsPtr = (PictureAnalysisResults*)inputResultsWrapperPtr->object_ptr;
         picture_control_set_ptr = (PictureParentControlSet*)inputResultsPtr->picture_control_set_wrapper_ptr->object_ptr;
+        eb_trace_set_object(picture_control_set_ptr->picture_number, EB_TRACE_NO_SEGMENT);
         sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
         frm_hdr = &picture_control_set_ptr->frm_hdr;
         encode_context_ptr = (EncodeContext*)sequence_control_set_ptr->encode_context_ptr;
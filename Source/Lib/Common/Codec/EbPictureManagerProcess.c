@@ -20,6 +20,7 @@
 #include "EbPredictionStructure.h"
 #include "EbRateControlTasks.h"
 #include "EbSvtAv1ErrorCodes.h"
+#include "EbTrace.h"
 
 void eb_av1_tile_set_col(TileInfo *tile, PictureParentControlSet * pcs_ptr, int col);
 void eb_av1_tile_set_row(TileInfo *tile, PictureParentControlSet * pcs_ptr, int row);
@@ -141,6 +142,7 @@ void* picture_manager_kernel(void *input_ptr)
             &inputPictureDemuxWrapperPtr);
 
         inputPictureDemuxPtr = (PictureDemuxResults*)inputPictureDemuxWrapperPtr->object_ptr;
+        eb_trace_set_object(inputPictureDemuxPtr->picture_number, EB_TRACE_NO_SEGMENT);
 
         // *Note - This should be overhauled and/or replaced when we
         //   need hierarchical support.
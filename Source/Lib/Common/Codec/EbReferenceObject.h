@@ -62,6 +62,9 @@ typedef struct EbPaReferenceObject
     uint8_t                       y_mean[MAX_NUMBER_OF_TREEBLOCKS_PER_PICTURE];
     EB_SLICE                      slice_type;
     uint32_t                      dependent_pictures_count; //number of pic using this reference frame
+    // zero_copy_input: input holding the luma of input_padded_picture_ptr,
+    // released with the object
+    EbObjectWrapper              *input_picture_wrapper_ptr;
 
 } EbPaReferenceObject;
 
@@ -15,6 +15,7 @@
 #include "EbResourceCoordinationResults.h"
 #include "EbTransforms.h"
 #include "EbTime.h"
+#include "EbTrace.h"
 
 void resource_coordination_context_dctor(EbPtr p)
 {
@@ -830,6 +831,7 @@ void* resource_coordination_kernel(void *input_ptr)
                 picture_control_set_ptr->picture_number = context_ptr->picture_number_array[instance_index]++;
             else
                 picture_control_set_ptr->picture_number = context_ptr->picture_number_array[instance_index];
+            eb_trace_set_object(picture_control_set_ptr->picture_number, EB_TRACE_NO_SEGMENT);
             ResetPcsAv1(picture_control_set_ptr);
 
             sequence_control_set_ptr->encode_context_ptr->initial_picture = EB_FALSE;
@@ -851,6 +853,14 @@ void* resource_coordination_kernel(void *input_ptr)
                     picture_control_set_ptr->pa_reference_picture_wrapper_ptr,
                     2);
             ((EbPaReferenceObject*)picture_control_set_ptr->pa_reference_picture_wrapper_ptr->object_ptr)->input_padded_picture_ptr->buffer_y = picture_control_set_ptr->enhanced_picture_ptr->buffer_y;
+            // With zero_copy_input the luma belongs to the application, the input is given back
+            // once both the Rate Control and the PA reference are done with it
+            if (sequence_control_set_ptr->static_config.zero_copy_input && !picture_control_set_ptr->is_overlay) {
+                ((EbPaReferenceObject*)picture_control_set_ptr->pa_reference_picture_wrapper_ptr->object_ptr)->input_picture_wrapper_ptr = picture_control_set_ptr->input_picture_wrapper_ptr;
+                eb_object_inc_live_count(
+                    picture_control_set_ptr->input_picture_wrapper_ptr,
+                    2);
+            }
 
             // Get Empty Output Results Object
             if (picture_control_set_ptr->picture_number > 0 && (prevPictureControlSetWrapperPtr != NULL))
@@ -22,12 +22,13 @@
 #include "EbThreads.h"
 #include "EbPictureDemuxResults.h"
 #include "EbReferenceObject.h"
+#include "EbTrace.h"
 
 void ReconOutput(
     PictureControlSet    *picture_control_set_ptr,
     SequenceControlSet   *sequence_control_set_ptr);
 void eb_av1_loop_restoration_filter_frame(Yv12BufferConfig *frame,
-    Av1Common *cm, int32_t optimized_lr);
+    Av1Common *cm, int32_t optimized_lr, RowSegments *segments_ptr);
 void CopyStatisticsToRefObject(
     PictureControlSet    *picture_control_set_ptr,
     SequenceControlSet   *sequence_control_set_ptr);
@@ -69,6 +70,7 @@ static void rest_context_dctor(EbPtr p)
 EbErrorType rest_context_ctor(
     RestContext           *context_ptr,
     EbFifo                *rest_input_fifo_ptr,
+    EbFifo                *rest_help_fifo_ptr,
     EbFifo                *rest_output_fifo_ptr ,
     EbFifo                *picture_demux_fifo_ptr,
     EbBool                  is16bit,
@@ -82,6 +84,7 @@ EbErrorType rest_context_ctor(
 
     // Input/Output System Resource Manager FIFOs
     context_ptr->rest_input_fifo_ptr = rest_input_fifo_ptr;
+    context_ptr->rest_help_fifo_ptr = rest_help_fifo_ptr;
     context_ptr->rest_output_fifo_ptr = rest_output_fifo_ptr;
     context_ptr->picture_demux_fifo_ptr = picture_demux_fifo_ptr;
 
@@ -197,9 +200,58 @@ void   get_own_recon(
 }
 
 /******************************************************
- * Rest Kernel
+ * Filtered Recon Needed
+ *   The filtered pixels of a picture are only read when
+ *   it is a reference, is output as recon or is measured
+ *   for the stats. Otherwise only the searched filter
+ *   parameters reach the bitstream.
  ******************************************************/
-void* rest_kernel(void *input_ptr)
+EbBool filtered_recon_needed(
+    SequenceControlSet *sequence_control_set_ptr,
+    PictureControlSet  *picture_control_set_ptr)
+{
+    return (EbBool)(
+        picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag ||
+        sequence_control_set_ptr->static_config.recon_enabled ||
+        sequence_control_set_ptr->static_config.stat_report);
+}
+
+/******************************************************
+ * Post Rest Help Tasks
+ *   Asks the other Rest threads to join the restoration
+ *   stripes, PSNR bands and padded planes of the picture.
+ *   Each task holds the picture until the thread taking
+ *   it is done with it.
+ ******************************************************/
+static void post_rest_help_tasks(
+    RestContext        *context_ptr,
+    SequenceControlSet *sequence_control_set_ptr,
+    EbObjectWrapper    *picture_control_set_wrapper_ptr)
+{
+    EbObjectWrapper *help_wrapper_ptr;
+    CdefResults     *help_ptr;
+    uint32_t picture_height_in_sb = (sequence_control_set_ptr->seq_header.max_frame_height + sequence_control_set_ptr->sb_size_pix - 1) / sequence_control_set_ptr->sb_size_pix;
+    uint32_t help_count = MIN(sequence_control_set_ptr->rest_process_init_count, picture_height_in_sb) - 1;
+    uint32_t help_index;
+
+    if (help_count == 0)
+        return;
+    eb_object_inc_live_count(picture_control_set_wrapper_ptr, help_count);
+    for (help_index = 0; help_index < help_count; ++help_index) {
+        eb_get_empty_object(
+            context_ptr->rest_help_fifo_ptr,
+            &help_wrapper_ptr);
+        help_ptr = (CdefResults*)help_wrapper_ptr->object_ptr;
+        help_ptr->picture_control_set_wrapper_ptr = picture_control_set_wrapper_ptr;
+        help_ptr->task_type = FILTER_TASK_HELP;
+        eb_post_full_object(help_wrapper_ptr);
+    }
+}
+
+/******************************************************
+ * Rest Task
+ ******************************************************/
+void rest_task(void *input_ptr, EbObjectWrapper *cdef_results_wrapper_ptr)
 {
     // Context & SCS & PCS
     RestContext                            *context_ptr = (RestContext*)input_ptr;
@@ -208,7 +260,6 @@ void* rest_kernel(void *input_ptr)
     FrameHeader                           *frm_hdr;
 
     //// Input
-    EbObjectWrapper                       *cdef_results_wrapper_ptr;
     CdefResults                         *cdef_results_ptr;
 
     //// Output
@@ -218,127 +269,144 @@ void* rest_kernel(void *input_ptr)
     PictureDemuxResults                   *picture_demux_results_rtr;
     // SB Loop variables
 
-    for (;;) {
-        // Get Cdef Results
-        eb_get_full_object(
-            context_ptr->rest_input_fifo_ptr,
-            &cdef_results_wrapper_ptr);
+    cdef_results_ptr = (CdefResults*)cdef_results_wrapper_ptr->object_ptr;
+    picture_control_set_ptr = (PictureControlSet*)cdef_results_ptr->picture_control_set_wrapper_ptr->object_ptr;
+    eb_trace_set_object(picture_control_set_ptr->picture_number, (int32_t)cdef_results_ptr->segment_index);
+    sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
 
-        cdef_results_ptr = (CdefResults*)cdef_results_wrapper_ptr->object_ptr;
-        picture_control_set_ptr = (PictureControlSet*)cdef_results_ptr->picture_control_set_wrapper_ptr->object_ptr;
-        sequence_control_set_ptr = (SequenceControlSet*)picture_control_set_ptr->sequence_control_set_wrapper_ptr->object_ptr;
-        frm_hdr = &picture_control_set_ptr->parent_pcs_ptr->frm_hdr;
-        uint8_t lcuSizeLog2 = (uint8_t)Log2f(sequence_control_set_ptr->sb_size_pix);
-        EbBool  is16bit = (EbBool)(sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
-        Av1Common* cm = picture_control_set_ptr->parent_pcs_ptr->av1_cm;
+    if (cdef_results_ptr->task_type == FILTER_TASK_HELP) {
+        row_segments_help(picture_control_set_ptr->rest_row_segments);
+        eb_release_object(cdef_results_ptr->picture_control_set_wrapper_ptr);
+        eb_release_object(cdef_results_wrapper_ptr);
+        return;
+    }
 
-        if (sequence_control_set_ptr->seq_header.enable_restoration && frm_hdr->allow_intrabc == 0)
-        {
-            get_own_recon(sequence_control_set_ptr, picture_control_set_ptr, context_ptr, is16bit);
-
-            Yv12BufferConfig cpi_source;
-            link_eb_to_aom_buffer_desc(
-                is16bit ? picture_control_set_ptr->input_frame16bit : picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr,
-                &cpi_source);
-
-            Yv12BufferConfig trial_frame_rst;
-            link_eb_to_aom_buffer_desc(
-                context_ptr->trial_frame_rst,
-                &trial_frame_rst);
-
-            Yv12BufferConfig org_fts;
-            link_eb_to_aom_buffer_desc(
-                context_ptr->org_rec_frame,
-                &org_fts);
-
-            restoration_seg_search(
-                context_ptr,
-                &org_fts,
-                &cpi_source,
-                &trial_frame_rst,
-                picture_control_set_ptr,
-                cdef_results_ptr->segment_index);
-        }
+    frm_hdr = &picture_control_set_ptr->parent_pcs_ptr->frm_hdr;
+    uint8_t lcuSizeLog2 = (uint8_t)Log2f(sequence_control_set_ptr->sb_size_pix);
+    EbBool  is16bit = (EbBool)(sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
+    Av1Common* cm = picture_control_set_ptr->parent_pcs_ptr->av1_cm;
 
-        //all seg based search is done. update total processed segments. if all done, finish the search and perfrom application.
-        eb_block_on_mutex(picture_control_set_ptr->rest_search_mutex);
+    if (sequence_control_set_ptr->seq_header.enable_restoration && frm_hdr->allow_intrabc == 0)
+    {
+        get_own_recon(sequence_control_set_ptr, picture_control_set_ptr, context_ptr, is16bit);
 
-        picture_control_set_ptr->tot_seg_searched_rest++;
-        if (picture_control_set_ptr->tot_seg_searched_rest == picture_control_set_ptr->rest_segments_total_count)
-        {
-            if (sequence_control_set_ptr->seq_header.enable_restoration && frm_hdr->allow_intrabc == 0) {
-                rest_finish_search(
-                    picture_control_set_ptr->parent_pcs_ptr->av1x,
-                    picture_control_set_ptr->parent_pcs_ptr->av1_cm);
-
-                if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
-                    cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
-                    cm->rst_info[2].frame_restoration_type != RESTORE_NONE)
-                {
-                    eb_av1_loop_restoration_filter_frame(
-                        cm->frame_to_show,
-                        cm,
-                        0);
-                }
-            }
-            else {
-                cm->rst_info[0].frame_restoration_type = RESTORE_NONE;
-                cm->rst_info[1].frame_restoration_type = RESTORE_NONE;
-                cm->rst_info[2].frame_restoration_type = RESTORE_NONE;
-            }
+        Yv12BufferConfig cpi_source;
+        link_eb_to_aom_buffer_desc(
+            is16bit ? picture_control_set_ptr->input_frame16bit : picture_control_set_ptr->parent_pcs_ptr->enhanced_picture_ptr,
+            &cpi_source);
 
-            uint8_t best_ep_cnt = 0;
-            uint8_t best_ep = 0;
-            for (uint8_t i = 0; i < SGRPROJ_PARAMS; i++) {
-                if (cm->sg_frame_ep_cnt[i] > best_ep_cnt) {
-                    best_ep = i;
-                    best_ep_cnt = cm->sg_frame_ep_cnt[i];
-                }
-            }
-            cm->sg_frame_ep = best_ep;
+        Yv12BufferConfig trial_frame_rst;
+        link_eb_to_aom_buffer_desc(
+            context_ptr->trial_frame_rst,
+            &trial_frame_rst);
 
-            if (picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr != NULL) {
-                // copy stat to ref object (intra_coded_area, Luminance, Scene change detection flags)
-                CopyStatisticsToRefObject(
-                    picture_control_set_ptr,
-                    sequence_control_set_ptr);
-            }
+        Yv12BufferConfig org_fts;
+        link_eb_to_aom_buffer_desc(
+            context_ptr->org_rec_frame,
+            &org_fts);
+
+        restoration_seg_search(
+            context_ptr,
+            &org_fts,
+            &cpi_source,
+            &trial_frame_rst,
+            picture_control_set_ptr,
+            cdef_results_ptr->segment_index);
+    }
 
-            // PSNR Calculation
-            if (sequence_control_set_ptr->static_config.stat_report)
-                psnr_calculations(
-                    picture_control_set_ptr,
-                    sequence_control_set_ptr);
-
-            // Pad the reference picture and set ref POC
-            if (picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag == EB_TRUE)
-                PadRefAndSetFlags(
-                    picture_control_set_ptr,
-                    sequence_control_set_ptr);
-            if (sequence_control_set_ptr->static_config.recon_enabled) {
-                ReconOutput(
-                    picture_control_set_ptr,
-                    sequence_control_set_ptr);
-            }
+    //all seg based search is done. update total processed segments. if all done, finish the search and perfrom application.
+    eb_block_on_mutex(picture_control_set_ptr->rest_search_mutex);
 
-            if (picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag)
+    picture_control_set_ptr->tot_seg_searched_rest++;
+    if (picture_control_set_ptr->tot_seg_searched_rest == picture_control_set_ptr->rest_segments_total_count)
+    {
+        // The frame tail runs in rows shared with the other Rest threads
+        row_segments_open(picture_control_set_ptr->rest_row_segments);
+        post_rest_help_tasks(
+            context_ptr,
+            sequence_control_set_ptr,
+            cdef_results_ptr->picture_control_set_wrapper_ptr);
+
+        if (sequence_control_set_ptr->seq_header.enable_restoration && frm_hdr->allow_intrabc == 0) {
+            rest_finish_search(
+                picture_control_set_ptr->parent_pcs_ptr->av1x,
+                picture_control_set_ptr->parent_pcs_ptr->av1_cm);
+
+            if ((cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
+                cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
+                cm->rst_info[2].frame_restoration_type != RESTORE_NONE) &&
+                filtered_recon_needed(sequence_control_set_ptr, picture_control_set_ptr))
             {
-                // Get Empty PicMgr Results
-                eb_get_empty_object(
-                    context_ptr->picture_demux_fifo_ptr,
-                    &picture_demux_results_wrapper_ptr);
-
-                picture_demux_results_rtr = (PictureDemuxResults*)picture_demux_results_wrapper_ptr->object_ptr;
-                picture_demux_results_rtr->reference_picture_wrapper_ptr = picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr;
-                picture_demux_results_rtr->sequence_control_set_wrapper_ptr = picture_control_set_ptr->sequence_control_set_wrapper_ptr;
-                picture_demux_results_rtr->picture_number = picture_control_set_ptr->picture_number;
-                picture_demux_results_rtr->picture_type = EB_PIC_REFERENCE;
-
-                // Post Reference Picture
-                eb_post_full_object(picture_demux_results_wrapper_ptr);
+                eb_av1_loop_restoration_filter_frame(
+                    cm->frame_to_show,
+                    cm,
+                    0,
+                    picture_control_set_ptr->rest_row_segments);
+            }
+        }
+        else {
+            cm->rst_info[0].frame_restoration_type = RESTORE_NONE;
+            cm->rst_info[1].frame_restoration_type = RESTORE_NONE;
+            cm->rst_info[2].frame_restoration_type = RESTORE_NONE;
+        }
+
+        uint8_t best_ep_cnt = 0;
+        uint8_t best_ep = 0;
+        for (uint8_t i = 0; i < SGRPROJ_PARAMS; i++) {
+            if (cm->sg_frame_ep_cnt[i] > best_ep_cnt) {
+                best_ep = i;
+                best_ep_cnt = cm->sg_frame_ep_cnt[i];
             }
+        }
+        cm->sg_frame_ep = best_ep;
+
+        if (picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr != NULL) {
+            // copy stat to ref object (intra_coded_area, Luminance, Scene change detection flags)
+            CopyStatisticsToRefObject(
+                picture_control_set_ptr,
+                sequence_control_set_ptr);
+        }
+
+        // PSNR Calculation
+        if (sequence_control_set_ptr->static_config.stat_report)
+            psnr_calculations(
+                picture_control_set_ptr,
+                sequence_control_set_ptr);
+
+        // Pad the reference picture and set ref POC
+        if (picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag == EB_TRUE)
+            PadRefAndSetFlags(
+                picture_control_set_ptr,
+                sequence_control_set_ptr);
+        row_segments_close(picture_control_set_ptr->rest_row_segments);
+
+        if (sequence_control_set_ptr->static_config.recon_enabled) {
+            ReconOutput(
+                picture_control_set_ptr,
+                sequence_control_set_ptr);
+        }
+
+        if (picture_control_set_ptr->parent_pcs_ptr->is_used_as_reference_flag)
+        {
+            // Get Empty PicMgr Results
+            eb_get_empty_object(
+                context_ptr->picture_demux_fifo_ptr,
+                &picture_demux_results_wrapper_ptr);
+
+            picture_demux_results_rtr = (PictureDemuxResults*)picture_demux_results_wrapper_ptr->object_ptr;
+            picture_demux_results_rtr->reference_picture_wrapper_ptr = picture_control_set_ptr->parent_pcs_ptr->reference_picture_wrapper_ptr;
+            picture_demux_results_rtr->sequence_control_set_wrapper_ptr = picture_control_set_ptr->sequence_control_set_wrapper_ptr;
+            picture_demux_results_rtr->picture_number = picture_control_set_ptr->picture_number;
+            picture_demux_results_rtr->picture_type = EB_PIC_REFERENCE;
+
+            // Post Reference Picture
+            eb_post_full_object(picture_demux_results_wrapper_ptr);
+        }
 
-            // Get Empty rest Results to EC
+        // Get Empty rest Results to EC, one per tile so that the tiles are coded concurrently
+        const uint16_t tile_count = (uint16_t)(cm->tiles_info.tile_cols * cm->tiles_info.tile_rows);
+        picture_control_set_ptr->ec_tile_coded_count = 0;
+        for (uint16_t tile_index = 0; tile_index < tile_count; tile_index++) {
             eb_get_empty_object(
                 context_ptr->rest_output_fifo_ptr,
                 &rest_results_wrapper_ptr);
@@ -346,14 +414,32 @@ void* rest_kernel(void *input_ptr)
             rest_results_ptr->picture_control_set_wrapper_ptr = cdef_results_ptr->picture_control_set_wrapper_ptr;
             rest_results_ptr->completed_lcu_row_index_start = 0;
             rest_results_ptr->completed_lcu_row_count = ((sequence_control_set_ptr->seq_header.max_frame_height + sequence_control_set_ptr->sb_size_pix - 1) >> lcuSizeLog2);
+            rest_results_ptr->tile_index = tile_index;
             // Post Rest Results
             eb_post_full_object(rest_results_wrapper_ptr);
         }
-        eb_release_mutex(picture_control_set_ptr->rest_search_mutex);
-
-        // Release input Results
-        eb_release_object(cdef_results_wrapper_ptr);
     }
+    eb_release_mutex(picture_control_set_ptr->rest_search_mutex);
 
+    // Release input Results
+    eb_release_object(cdef_results_wrapper_ptr);
+}
+
+/******************************************************
+ * Rest Kernel
+ ******************************************************/
+void* rest_kernel(void *input_ptr)
+{
+    RestContext                            *context_ptr = (RestContext*)input_ptr;
+    EbObjectWrapper                       *cdef_results_wrapper_ptr;
+
+    for (;;) {
+        // Get Cdef Results
+        eb_get_full_object(
+            context_ptr->rest_input_fifo_ptr,
+            &cdef_results_wrapper_ptr);
+
+        rest_task(input_ptr, cdef_results_wrapper_ptr);
+    }
     return EB_NULL;
 }
@@ -23,6 +23,7 @@ typedef struct RestContext
 {
     EbDctor                       dctor;
     EbFifo                       *rest_input_fifo_ptr;
+    EbFifo                       *rest_help_fifo_ptr;
     EbFifo                       *rest_output_fifo_ptr;
     EbFifo                       *picture_demux_fifo_ptr;
 
@@ -44,6 +45,7 @@ typedef struct RestContext
 extern EbErrorType rest_context_ctor(
     RestContext                  *context_ptr,
     EbFifo                       *rest_input_fifo_ptr,
+    EbFifo                       *rest_help_fifo_ptr,
     EbFifo                       *rest_output_fifo_ptr,
     EbFifo                      *picture_demux_fifo_ptr,
     EbBool                  is16bit,
@@ -52,6 +54,11 @@ extern EbErrorType rest_context_ctor(
     uint32_t                max_input_luma_height
    );
 
+extern EbBool filtered_recon_needed(
+    SequenceControlSet *sequence_control_set_ptr,
+    PictureControlSet  *picture_control_set_ptr);
+
 extern void* rest_kernel(void *input_ptr);
+extern void rest_task(void *input_ptr, EbObjectWrapper *input_wrapper_ptr);
 
 #endif
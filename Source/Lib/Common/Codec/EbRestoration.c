@@ -150,6 +150,7 @@ static INLINE int32_t av1_superres_unscaled(const Av1Common *cm) {
 }
 
 void *eb_aom_memalign(size_t align, size_t size);
+void *eb_aom_malloc(size_t size);
 void eb_aom_free(void *memblk);
 
 // The 's' values are calculated based on original 'r' and 'e' values in the
@@ -1220,46 +1221,114 @@ void eb_av1_loop_restoration_filter_unit(
     }
 }
 
-typedef struct {
-    const RestorationInfo *rsi;
-    RestorationLineBuffers *rlbs;
-    const Av1Common *cm;
-    int32_t tile_stripe0;
-    int32_t ss_x, ss_y;
-    int32_t highbd, bit_depth;
-    uint8_t *data8, *dst8;
-    int32_t data_stride, dst_stride;
-    int32_t *tmpbuf;
-} FilterFrameCtxt;
-
-static void filter_frame_on_tile(int32_t tile_row, int32_t tile_col, void *priv) {
-    (void)tile_col;
-    FilterFrameCtxt *ctxt = (FilterFrameCtxt *)priv;
-    ctxt->tile_stripe0 =
-        (tile_row == 0) ? 0 : ctxt->cm->rst_end_stripe[tile_row - 1];
+/**************************************
+ * Restoration Frame Pass
+ *   A stripe temporarily overwrites the 3 lines above and below it in the
+ *   frame with the saved stripe boundaries, so two adjacent stripes cannot
+ *   be filtered at the same time. The even stripes of every plane are
+ *   filtered first, then the odd ones, and the filtered stripes are copied
+ *   back to the frame once all of them are done.
+ **************************************/
+typedef struct RestorationFramePass {
+    Yv12BufferConfig *frame;
+    Yv12BufferConfig *dst;
+    Av1Common        *cm;
+    int32_t           stripe_count;
+    int32_t           stripe_pair_count;
+    int32_t           parity;
+    int32_t         **tmpbuf_array;
+} RestorationFramePass;
+
+// Returns 0 when the plane has fewer stripes
+static int32_t get_restoration_stripe_limits(const AV1PixelRect *tile_rect, int32_t ss_y,
+    int32_t stripe_index, RestorationTileLimits *limits) {
+    const int32_t full_stripe_height = RESTORATION_PROC_UNIT_SIZE >> ss_y;
+    const int32_t runit_offset = RESTORATION_UNIT_OFFSET >> ss_y;
+
+    limits->v_start = AOMMAX(tile_rect->top, tile_rect->top + stripe_index * full_stripe_height - runit_offset);
+    limits->v_end = AOMMIN(tile_rect->bottom, tile_rect->top + (stripe_index + 1) * full_stripe_height - runit_offset);
+    return limits->v_start < limits->v_end;
 }
 
-static void filter_frame_on_unit(const RestorationTileLimits *limits,
-    const AV1PixelRect *tile_rect,
-    int32_t rest_unit_idx, void *priv) {
-    FilterFrameCtxt *ctxt = (FilterFrameCtxt *)priv;
-    const RestorationInfo *rsi = ctxt->rsi;
-
-    eb_av1_loop_restoration_filter_unit(
-        1,
-        limits, &rsi->unit_info[rest_unit_idx], &rsi->boundaries, ctxt->rlbs,
-        tile_rect, ctxt->tile_stripe0, ctxt->ss_x, ctxt->ss_y, ctxt->highbd,
-        ctxt->bit_depth, ctxt->data8, ctxt->data_stride, ctxt->dst8,
-        ctxt->dst_stride, ctxt->tmpbuf, rsi->optimized_lr);
+static void filter_restoration_stripe(void *pass_ptr, uint32_t worker_index, uint32_t row_index) {
+    RestorationFramePass *pass = (RestorationFramePass*)pass_ptr;
+    const Av1Common *cm = pass->cm;
+    const int32_t plane = row_index / pass->stripe_pair_count;
+    const int32_t stripe_index = 2 * (row_index % pass->stripe_pair_count) + pass->parity;
+    const RestorationInfo *rsi = &cm->rst_info[plane];
+    const int32_t is_uv = plane > 0;
+    const int32_t ss_x = is_uv && cm->subsampling_x;
+    const int32_t ss_y = is_uv && cm->subsampling_y;
+    const AV1PixelRect tile_rect = whole_frame_rect(cm, is_uv);
+    const int32_t unit_size = rsi->restoration_unit_size;
+    const int32_t ext_size = unit_size * 3 / 2;
+    const int32_t tile_w = tile_rect.right - tile_rect.left;
+    RestorationTileLimits limits;
+    RestorationLineBuffers rlbs;
+
+    if (rsi->frame_restoration_type == RESTORE_NONE ||
+        !get_restoration_stripe_limits(&tile_rect, ss_y, stripe_index, &limits))
+        return;
+
+    if (!pass->tmpbuf_array[worker_index])
+        pass->tmpbuf_array[worker_index] = (int32_t *)eb_aom_memalign(32, RESTORATION_TMPBUF_SIZE);
+
+    // Each stripe lies in a single row of units, the last row absorbing the remainder
+    const int32_t unit_row = AOMMIN(
+        (limits.v_start - tile_rect.top + (RESTORATION_UNIT_OFFSET >> ss_y)) / unit_size,
+        rsi->vert_units_per_tile - 1);
+    int32_t x0 = 0, j = 0;
+    while (x0 < tile_w) {
+        int32_t remaining_w = tile_w - x0;
+        int32_t w = (remaining_w < ext_size) ? remaining_w : unit_size;
+
+        limits.h_start = tile_rect.left + x0;
+        limits.h_end = tile_rect.left + x0 + w;
+
+        eb_av1_loop_restoration_filter_unit(
+            1,
+            &limits, &rsi->unit_info[unit_row * rsi->horz_units_per_tile + j], &rsi->boundaries, &rlbs,
+            &tile_rect, 0, ss_x, ss_y, cm->use_highbitdepth,
+            cm->bit_depth, pass->frame->buffers[plane], pass->frame->strides[is_uv], pass->dst->buffers[plane],
+            pass->dst->strides[is_uv], pass->tmpbuf_array[worker_index], rsi->optimized_lr);
+
+        x0 += w;
+        ++j;
+    }
+}
+
+static void copy_restoration_stripe(void *pass_ptr, uint32_t worker_index, uint32_t row_index) {
+    RestorationFramePass *pass = (RestorationFramePass*)pass_ptr;
+    const Av1Common *cm = pass->cm;
+    const int32_t plane = row_index / pass->stripe_count;
+    const int32_t stripe_index = row_index % pass->stripe_count;
+    const int32_t is_uv = plane > 0;
+    const AV1PixelRect tile_rect = whole_frame_rect(cm, is_uv);
+    const int32_t src_stride = pass->dst->strides[is_uv];
+    const int32_t dst_stride = pass->frame->strides[is_uv];
+    RestorationTileLimits limits;
+    (void)worker_index;
+
+    if (cm->rst_info[plane].frame_restoration_type == RESTORE_NONE ||
+        !get_restoration_stripe_limits(&tile_rect, is_uv && cm->subsampling_y, stripe_index, &limits))
+        return;
+
+    copy_tile(
+        tile_rect.right - tile_rect.left,
+        limits.v_end - limits.v_start,
+        pass->dst->buffers[plane] + limits.v_start * src_stride + tile_rect.left,
+        src_stride,
+        pass->frame->buffers[plane] + limits.v_start * dst_stride + tile_rect.left,
+        dst_stride,
+        cm->use_highbitdepth);
 }
 
 void eb_av1_loop_restoration_filter_frame(Yv12BufferConfig *frame,
-    Av1Common *cm, int32_t optimized_lr) {
+    Av1Common *cm, int32_t optimized_lr, RowSegments *segments_ptr) {
     // assert(!cm->all_lossless);
     const int32_t num_planes = 3;// av1_num_planes(cm);
-    typedef void(*copy_fun)(const Yv12BufferConfig *src,
-        Yv12BufferConfig *dst);
-    static const copy_fun copy_funs[3] = { eb_aom_yv12_copy_y_c, eb_aom_yv12_copy_u_c, eb_aom_yv12_copy_v_c };//CHKN SSE
+    RestorationFramePass pass;
+    uint32_t worker_index;
 
     Yv12BufferConfig *dst = &cm->rst_frame;
 
@@ -1271,10 +1340,12 @@ void eb_av1_loop_restoration_filter_frame(Yv12BufferConfig *frame,
         cm->byte_alignment, NULL, NULL, NULL) < 0)
         printf("Failed to allocate restoration dst buffer\n");
 
-    RestorationLineBuffers rlbs;
-    const int32_t bit_depth = cm->bit_depth;
     const int32_t highbd = cm->use_highbitdepth;
 
+    pass.frame = frame;
+    pass.dst = dst;
+    pass.cm = cm;
+    pass.stripe_count = 0;
     for (int32_t plane = 0; plane < num_planes; ++plane) {
         RestorationInfo *rsi = &cm->rst_info[plane];
         RestorationType rtype = rsi->frame_restoration_type;
@@ -1283,31 +1354,44 @@ void eb_av1_loop_restoration_filter_frame(Yv12BufferConfig *frame,
         if (rtype == RESTORE_NONE)
             continue;
         const int32_t is_uv = plane > 0;
+        const int32_t ss_y = is_uv && cm->subsampling_y;
         const int32_t plane_width = frame->crop_widths[is_uv];
         const int32_t plane_height = frame->crop_heights[is_uv];
+        const int32_t full_stripe_height = RESTORATION_PROC_UNIT_SIZE >> ss_y;
 
         eb_extend_frame(frame->buffers[plane], plane_width, plane_height,
             frame->strides[is_uv], RESTORATION_BORDER, RESTORATION_BORDER,
             highbd);
 
-        FilterFrameCtxt ctxt;
-        ctxt.rsi = rsi;
-        ctxt.rlbs = &rlbs;
-        ctxt.cm = cm;
-        ctxt.ss_x = is_uv && cm->subsampling_x;
-        ctxt.ss_y = is_uv && cm->subsampling_y;
-        ctxt.highbd = highbd;
-        ctxt.bit_depth = bit_depth;
-        ctxt.data8 = frame->buffers[plane];
-        ctxt.dst8 = dst->buffers[plane];
-        ctxt.data_stride = frame->strides[is_uv];
-        ctxt.dst_stride = dst->strides[is_uv];
-        ctxt.tmpbuf = cm->rst_tmpbuf;
-
-        av1_foreach_rest_unit_in_frame(cm, plane, filter_frame_on_tile, filter_frame_on_unit, &ctxt);
-
-        copy_funs[plane](dst, frame);
+        pass.stripe_count = AOMMAX(pass.stripe_count,
+            (plane_height + (RESTORATION_UNIT_OFFSET >> ss_y) + full_stripe_height - 1) / full_stripe_height);
+    }
+    if (pass.stripe_count == 0)
+        return;
+    pass.stripe_pair_count = (pass.stripe_count + 1) / 2;
+
+    // The owner of the session uses the frame scratch buffer
+    pass.tmpbuf_array = (int32_t **)eb_aom_malloc(sizeof(*pass.tmpbuf_array) * (segments_ptr->helper_max_count + 1));
+    assert(pass.tmpbuf_array != NULL);
+    memset(pass.tmpbuf_array, 0, sizeof(*pass.tmpbuf_array) * (segments_ptr->helper_max_count + 1));
+    pass.tmpbuf_array[0] = cm->rst_tmpbuf;
+
+    for (pass.parity = 0; pass.parity < 2; pass.parity++) {
+        row_segments_run(
+            segments_ptr,
+            filter_restoration_stripe,
+            &pass,
+            num_planes * pass.stripe_pair_count);
     }
+    row_segments_run(
+        segments_ptr,
+        copy_restoration_stripe,
+        &pass,
+        num_planes * pass.stripe_count);
+
+    for (worker_index = 1; worker_index <= segments_ptr->helper_max_count; worker_index++)
+        eb_aom_free(pass.tmpbuf_array[worker_index]);
+    eb_aom_free(pass.tmpbuf_array);
 }
 
 static void foreach_rest_unit_in_tile(const AV1PixelRect *tile_rect,
@@ -0,0 +1,252 @@
+/*
+* Copyright(c) 2019 Intel Corporation
+* SPDX - License - Identifier: BSD - 2 - Clause - Patent
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "EbRowSegments.h"
+#include "EbTaskScheduler.h"
+
+static void row_segments_dctor(EbPtr p)
+{
+    RowSegments *obj = (RowSegments*)p;
+    uint32_t index;
+    if (obj->row_semaphore_array) {
+        for (index = 0; index < obj->row_max_count; ++index)
+            EB_DESTROY_SEMAPHORE(obj->row_semaphore_array[index]);
+    }
+    if (obj->helper_semaphore_array) {
+        for (index = 0; index < obj->helper_max_count; ++index)
+            EB_DESTROY_SEMAPHORE(obj->helper_semaphore_array[index]);
+    }
+    EB_DESTROY_SEMAPHORE(obj->done_semaphore);
+    EB_DESTROY_MUTEX(obj->mutex);
+    EB_FREE_ARRAY(obj->row_semaphore_array);
+    EB_FREE_ARRAY(obj->helper_semaphore_array);
+    EB_FREE_ARRAY(obj->row_waiting_array);
+    EB_FREE_ARRAY(obj->helper_waiting_array);
+    EB_FREE_ARRAY(obj->row_progress_array);
+}
+
+EbErrorType row_segments_ctor(
+    RowSegments *segments_ptr,
+    uint32_t     row_max_count,
+    uint32_t     helper_max_count)
+{
+    uint32_t index;
+
+    segments_ptr->dctor = row_segments_dctor;
+    segments_ptr->row_max_count = row_max_count;
+    segments_ptr->helper_max_count = helper_max_count;
+
+    EB_CREATE_MUTEX(segments_ptr->mutex);
+    EB_CREATE_SEMAPHORE(segments_ptr->done_semaphore, 0, 1);
+
+    // Each row semaphore has a single waiter, the thread running the row below
+    EB_CALLOC_ARRAY(segments_ptr->row_semaphore_array, row_max_count);
+    EB_CALLOC_ARRAY(segments_ptr->row_waiting_array, row_max_count);
+    EB_CALLOC_ARRAY(segments_ptr->row_progress_array, row_max_count);
+    for (index = 0; index < row_max_count; ++index)
+        EB_CREATE_SEMAPHORE(segments_ptr->row_semaphore_array[index], 0, 1);
+
+    // One semaphore per helper so that a wake up cannot be taken by another helper
+    EB_CALLOC_ARRAY(segments_ptr->helper_semaphore_array, helper_max_count);
+    EB_CALLOC_ARRAY(segments_ptr->helper_waiting_array, helper_max_count);
+    for (index = 0; index < helper_max_count; ++index)
+        EB_CREATE_SEMAPHORE(segments_ptr->helper_semaphore_array[index], 0, 1);
+
+    return EB_ErrorNone;
+}
+
+/**************************************
+ * The helpers below are called with the mutex held
+ **************************************/
+static void wake_helpers(RowSegments *segments_ptr)
+{
+    uint32_t index;
+    for (index = 0; index < segments_ptr->helper_joined_count; ++index) {
+        if (segments_ptr->helper_waiting_array[index]) {
+            segments_ptr->helper_waiting_array[index] = 0;
+            eb_post_semaphore(segments_ptr->helper_semaphore_array[index]);
+        }
+    }
+}
+
+static EbBool claim_row(RowSegments *segments_ptr, uint32_t *row_index)
+{
+    if (segments_ptr->next_row_index >= segments_ptr->row_count)
+        return EB_FALSE;
+    *row_index = segments_ptr->next_row_index++;
+    segments_ptr->rows_in_progress++;
+    return EB_TRUE;
+}
+
+static void release_row(RowSegments *segments_ptr)
+{
+    segments_ptr->rows_in_progress--;
+    if (segments_ptr->rows_in_progress == 0 && segments_ptr->owner_waiting) {
+        segments_ptr->owner_waiting = 0;
+        eb_post_semaphore(segments_ptr->done_semaphore);
+    }
+}
+
+void row_segments_open(
+    RowSegments *segments_ptr)
+{
+    eb_block_on_mutex(segments_ptr->mutex);
+    segments_ptr->open = EB_TRUE;
+    segments_ptr->row_count = 0;
+    segments_ptr->next_row_index = 0;
+    segments_ptr->rows_in_progress = 0;
+    segments_ptr->helper_joined_count = 0;
+    segments_ptr->helper_active_count = 0;
+    eb_release_mutex(segments_ptr->mutex);
+}
+
+void row_segments_run(
+    RowSegments        *segments_ptr,
+    RowSegmentFunction  row_function,
+    void               *pass_ptr,
+    uint32_t            row_count)
+{
+    uint32_t row_index;
+
+    assert(row_count <= segments_ptr->row_max_count);
+    eb_block_on_mutex(segments_ptr->mutex);
+    segments_ptr->row_function = row_function;
+    segments_ptr->pass_ptr = pass_ptr;
+    memset(segments_ptr->row_progress_array, 0, row_count * sizeof(*segments_ptr->row_progress_array));
+    segments_ptr->next_row_index = 0;
+    segments_ptr->rows_in_progress = 0;
+    segments_ptr->row_count = row_count;
+    wake_helpers(segments_ptr);
+
+    while (claim_row(segments_ptr, &row_index)) {
+        eb_release_mutex(segments_ptr->mutex);
+        row_function(pass_ptr, 0, row_index);
+        eb_block_on_mutex(segments_ptr->mutex);
+        release_row(segments_ptr);
+    }
+    // Wait for the rows still run by helpers
+    while (segments_ptr->rows_in_progress) {
+        segments_ptr->owner_waiting = 1;
+        eb_release_mutex(segments_ptr->mutex);
+        eb_task_scheduler_enter_wait();
+        eb_block_on_semaphore(segments_ptr->done_semaphore);
+        eb_task_scheduler_leave_wait();
+        eb_block_on_mutex(segments_ptr->mutex);
+    }
+    segments_ptr->row_count = 0;
+    segments_ptr->next_row_index = 0;
+    eb_release_mutex(segments_ptr->mutex);
+}
+
+void row_segments_close(
+    RowSegments *segments_ptr)
+{
+    eb_block_on_mutex(segments_ptr->mutex);
+    segments_ptr->open = EB_FALSE;
+    wake_helpers(segments_ptr);
+    while (segments_ptr->helper_active_count) {
+        segments_ptr->owner_waiting = 1;
+        eb_release_mutex(segments_ptr->mutex);
+        eb_task_scheduler_enter_wait();
+        eb_block_on_semaphore(segments_ptr->done_semaphore);
+        eb_task_scheduler_leave_wait();
+        eb_block_on_mutex(segments_ptr->mutex);
+    }
+    eb_release_mutex(segments_ptr->mutex);
+}
+
+void row_segments_help(
+    RowSegments *segments_ptr)
+{
+    uint32_t helper_index;
+    uint32_t row_index;
+
+    eb_block_on_mutex(segments_ptr->mutex);
+    if (!segments_ptr->open || segments_ptr->helper_joined_count == segments_ptr->helper_max_count) {
+        eb_release_mutex(segments_ptr->mutex);
+        return;
+    }
+    helper_index = segments_ptr->helper_joined_count++;
+    segments_ptr->helper_active_count++;
+
+    for (;;) {
+        if (claim_row(segments_ptr, &row_index)) {
+            RowSegmentFunction row_function = segments_ptr->row_function;
+            void *pass_ptr = segments_ptr->pass_ptr;
+            eb_release_mutex(segments_ptr->mutex);
+            row_function(pass_ptr, helper_index + 1, row_index);
+            eb_block_on_mutex(segments_ptr->mutex);
+            release_row(segments_ptr);
+            continue;
+        }
+        if (!segments_ptr->open)
+            break;
+        // Wait for the next pass or the end of the session
+        segments_ptr->helper_waiting_array[helper_index] = 1;
+        eb_release_mutex(segments_ptr->mutex);
+        eb_task_scheduler_enter_wait();
+        eb_block_on_semaphore(segments_ptr->helper_semaphore_array[helper_index]);
+        eb_task_scheduler_leave_wait();
+        eb_block_on_mutex(segments_ptr->mutex);
+    }
+
+    segments_ptr->helper_active_count--;
+    if (segments_ptr->helper_active_count == 0 && segments_ptr->owner_waiting) {
+        segments_ptr->owner_waiting = 0;
+        eb_post_semaphore(segments_ptr->done_semaphore);
+    }
+    eb_release_mutex(segments_ptr->mutex);
+}
+
+/**************************************
+ * The row progress is published without the mutex. The waiter registers
+ * under the mutex and checks the progress again after registering, the
+ * thread running the row checks for a waiter after publishing, so at
+ * least one of them sees the other.
+ **************************************/
+void row_segments_wait(
+    RowSegments *segments_ptr,
+    uint32_t     row_index,
+    uint32_t     progress)
+{
+    if (eb_atomic_load_u32(&segments_ptr->row_progress_array[row_index]) >= progress)
+        return;
+
+    eb_block_on_mutex(segments_ptr->mutex);
+    for (;;) {
+        eb_atomic_store_u32(&segments_ptr->row_waiting_array[row_index], 1);
+        eb_atomic_fence();
+        if (eb_atomic_load_u32(&segments_ptr->row_progress_array[row_index]) >= progress)
+            break;
+        eb_release_mutex(segments_ptr->mutex);
+        eb_task_scheduler_enter_wait();
+        eb_block_on_semaphore(segments_ptr->row_semaphore_array[row_index]);
+        eb_task_scheduler_leave_wait();
+        eb_block_on_mutex(segments_ptr->mutex);
+    }
+    eb_atomic_store_u32(&segments_ptr->row_waiting_array[row_index], 0);
+    eb_release_mutex(segments_ptr->mutex);
+}
+
+void row_segments_set_progress(
+    RowSegments *segments_ptr,
+    uint32_t     row_index,
+    uint32_t     progress)
+{
+    eb_atomic_store_u32(&segments_ptr->row_progress_array[row_index], progress);
+    eb_atomic_fence();
+    if (eb_atomic_load_u32(&segments_ptr->row_waiting_array[row_index]) == 0)
+        return;
+
+    eb_block_on_mutex(segments_ptr->mutex);
+    if (eb_atomic_load_u32(&segments_ptr->row_waiting_array[row_index])) {
+        eb_atomic_store_u32(&segments_ptr->row_waiting_array[row_index], 0);
+        eb_post_semaphore(segments_ptr->row_semaphore_array[row_index]);
+    }
+    eb_release_mutex(segments_ptr->mutex);
+}
@@ -0,0 +1,100 @@
+/*
+* Copyright(c) 2019 Intel Corporation
+* SPDX - License - Identifier: BSD - 2 - Clause - Patent
+*/
+
+#ifndef EbRowSegments_h
+#define EbRowSegments_h
+
+#include "EbDefinitions.h"
+#include "EbThreads.h"
+#include "EbObject.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+    /**************************************
+     * Row Function
+     *   Processes one row of the current pass. worker_index is 0 for the
+     *   owner of the session and 1 + the join order for the helpers, so a
+     *   pass may keep scratch buffers per worker.
+     **************************************/
+    typedef void(*RowSegmentFunction)(
+        void     *pass_ptr,
+        uint32_t  worker_index,
+        uint32_t  row_index);
+
+    /**************************************
+     * Row Segments
+     *   Frame level passes split into rows and shared by the threads of a
+     *   stage. The thread owning the picture opens a session, runs one or
+     *   more passes and closes it. Threads of the same stage join the
+     *   session through row_segments_help() and take rows of every pass
+     *   until the session is closed. Rows are claimed in order, so a row
+     *   may wait on the progress of the row above it.
+     **************************************/
+    typedef struct RowSegments
+    {
+        EbDctor                 dctor;
+        EbHandle                mutex;
+        EbHandle                done_semaphore;
+        EbHandle               *row_semaphore_array;
+        EbHandle               *helper_semaphore_array;
+        uint32_t               *row_waiting_array;     // atomic, set by the waiter under the mutex
+        uint8_t                *helper_waiting_array;
+        uint32_t               *row_progress_array;    // atomic, written by the thread running the row
+        uint32_t                row_max_count;
+        uint32_t                helper_max_count;
+
+        // Current pass
+        RowSegmentFunction      row_function;
+        void                   *pass_ptr;
+        uint32_t                row_count;
+        uint32_t                next_row_index;
+        uint32_t                rows_in_progress;
+
+        // Session
+        EbBool                  open;
+        uint32_t                helper_joined_count;
+        uint32_t                helper_active_count;
+        uint8_t                 owner_waiting;
+    } RowSegments;
+
+    /**************************************
+     * Extern Function Declarations
+     **************************************/
+    extern EbErrorType row_segments_ctor(
+        RowSegments *segments_ptr,
+        uint32_t     row_max_count,
+        uint32_t     helper_max_count);
+
+    extern void row_segments_open(
+        RowSegments *segments_ptr);
+
+    // Runs row_function on rows [0, row_count) and returns once every row is done
+    extern void row_segments_run(
+        RowSegments        *segments_ptr,
+        RowSegmentFunction  row_function,
+        void               *pass_ptr,
+        uint32_t            row_count);
+
+    // Returns once every helper has left the session
+    extern void row_segments_close(
+        RowSegments *segments_ptr);
+
+    // Joins the open session, if any, until it is closed
+    extern void row_segments_help(
+        RowSegments *segments_ptr);
+
+    extern void row_segments_wait(
+        RowSegments *segments_ptr,
+        uint32_t     row_index,
+        uint32_t     progress);
+
+    extern void row_segments_set_progress(
+        RowSegments *segments_ptr,
+        uint32_t     row_index,
+        uint32_t     progress);
+#ifdef __cplusplus
+}
+#endif
+#endif // EbRowSegments_h
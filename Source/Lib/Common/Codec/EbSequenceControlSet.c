@@ -287,7 +287,11 @@ EbErrorType copy_sequence_control_set(
     dst->mode_decision_configuration_process_init_count = src->mode_decision_configuration_process_init_count; writeCount += sizeof(int32_t);
     dst->enc_dec_process_init_count = src->enc_dec_process_init_count; writeCount += sizeof(int32_t);
     dst->entropy_coding_process_init_count = src->entropy_coding_process_init_count; writeCount += sizeof(int32_t);
+    dst->dlf_process_init_count = src->dlf_process_init_count; writeCount += sizeof(int32_t);
+    dst->cdef_process_init_count = src->cdef_process_init_count; writeCount += sizeof(int32_t);
+    dst->rest_process_init_count = src->rest_process_init_count; writeCount += sizeof(int32_t);
     dst->total_process_init_count = src->total_process_init_count; writeCount += sizeof(int32_t);
+    dst->task_worker_count = src->task_worker_count; writeCount += sizeof(int32_t);
     dst->left_padding = src->left_padding; writeCount += sizeof(int16_t);
     dst->right_padding = src->right_padding; writeCount += sizeof(int16_t);
     dst->top_padding = src->top_padding; writeCount += sizeof(int16_t);
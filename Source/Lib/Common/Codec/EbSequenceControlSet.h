@@ -142,6 +142,13 @@ extern "C" {
         uint32_t                                overlay_input_picture_buffer_init_count;
         uint32_t                                output_stream_buffer_fifo_init_count;
         uint32_t                                output_recon_buffer_fifo_init_count;
+        // Smallest sizes of the picture pools, the floor of the elastic
+        // pools and of the memory budget
+        uint32_t                                picture_control_set_pool_min_count;
+        uint32_t                                pa_reference_picture_buffer_min_count;
+        uint32_t                                reference_picture_buffer_min_count;
+        uint32_t                                input_buffer_fifo_min_count;
+        uint32_t                                elastic_pool_init_count;
         uint32_t                                resource_coordination_fifo_init_count;
         uint32_t                                picture_analysis_fifo_init_count;
         uint32_t                                picture_decision_fifo_init_count;
@@ -167,6 +174,7 @@ extern "C" {
         uint32_t                                cdef_process_init_count;
         uint32_t                                rest_process_init_count;
         uint32_t                                total_process_init_count;
+        uint32_t                                task_worker_count;
 
         uint16_t                                film_grain_random_seed;
         SbParams                               *sb_params_array;
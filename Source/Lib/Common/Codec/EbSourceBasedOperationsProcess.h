@@ -62,5 +62,6 @@ extern EbErrorType source_based_operations_context_ctor(
     SequenceControlSet            *sequence_control_set_ptr);
 
 extern void* source_based_operations_kernel(void *input_ptr);
+extern void source_based_operations_task(void *input_ptr, EbObjectWrapper *input_wrapper_ptr);
 
 #endif // EbSourceBasedOperations_h
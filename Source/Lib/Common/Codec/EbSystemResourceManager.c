@@ -4,190 +4,159 @@
 */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "EbSystemResourceManager.h"
+#include "EbTaskScheduler.h"
+#include "EbTrace.h"
+#include "EbTime.h"
+#include "EbUtility.h"
+
+// Full queue of the object the calling thread is working on, and the
+// time the work started. Waits for empty objects are charged to it.
+static EB_THREAD_LOCAL EbMuxingQueue *stats_queue_ptr = NULL;
+static EB_THREAD_LOCAL uint64_t       stats_start_time = 0;
 
-void EbFifoDctor(EbPtr p)
-{
-    EbFifo *obj = (EbFifo*)p;
-    EB_DESTROY_SEMAPHORE(obj->counting_semaphore);
-    EB_DESTROY_MUTEX(obj->lockout_mutex);
-}
 /**************************************
  * EbFifoCtor
  **************************************/
 static EbErrorType EbFifoCtor(
     EbFifo           *fifoPtr,
-    uint32_t              initial_count,
-    uint32_t              max_count,
-    EbObjectWrapper  *firstWrapperPtr,
-    EbObjectWrapper  *lastWrapperPtr,
     EbMuxingQueue    *queue_ptr)
 {
-    fifoPtr->dctor = EbFifoDctor;
-    // Create Counting Semaphore
-    EB_CREATE_SEMAPHORE(fifoPtr->counting_semaphore, initial_count, max_count);
-
-    // Create Buffer Pool Mutex
-    EB_CREATE_MUTEX(fifoPtr->lockout_mutex);
-
-    // Initialize Fifo First & Last ptrs
-    fifoPtr->first_ptr = firstWrapperPtr;
-    fifoPtr->last_ptr = lastWrapperPtr;
-
     // Copy the Muxing Queue ptr this Fifo belongs to
     fifoPtr->queue_ptr = queue_ptr;
 
     return EB_ErrorNone;
 }
 
-/**************************************
- * EbFifoPushBack
- **************************************/
-static EbErrorType EbFifoPushBack(
-    EbFifo            *fifoPtr,
-    EbObjectWrapper   *wrapper_ptr)
+void EbObjectRingDctor(EbPtr p)
 {
-    EbErrorType return_error = EB_ErrorNone;
-
-    // If FIFO is empty
-    if (fifoPtr->first_ptr == (EbObjectWrapper*)EB_NULL) {
-        fifoPtr->first_ptr = wrapper_ptr;
-        fifoPtr->last_ptr = wrapper_ptr;
-    }
-    else {
-        fifoPtr->last_ptr->next_ptr = wrapper_ptr;
-        fifoPtr->last_ptr = wrapper_ptr;
-    }
-
-    fifoPtr->last_ptr->next_ptr = (EbObjectWrapper*)EB_NULL;
-
-    return return_error;
+    EbObjectRing* obj = (EbObjectRing*)p;
+    EB_FREE(obj->cell_array);
 }
 
 /**************************************
- * EbFifoPopFront
+ * EbObjectRingCtor
  **************************************/
-static EbErrorType EbFifoPopFront(
-    EbFifo            *fifoPtr,
-    EbObjectWrapper  **wrapper_ptr)
+static EbErrorType EbObjectRingCtor(
+    EbObjectRing      *ringPtr,
+    uint32_t           object_total_count)
 {
-    EbErrorType return_error = EB_ErrorNone;
+    uint32_t cellTotalCount = 1;
+    uint32_t cellIndex;
 
-    // Set wrapper_ptr to head of BufferPool
-    *wrapper_ptr = fifoPtr->first_ptr;
+    ringPtr->dctor = EbObjectRingDctor;
 
-    // Update tail of BufferPool if the BufferPool is now empty
-    fifoPtr->last_ptr = (fifoPtr->first_ptr == fifoPtr->last_ptr) ? (EbObjectWrapper*)EB_NULL : fifoPtr->last_ptr;
-
-    // Update head of BufferPool
-    fifoPtr->first_ptr = fifoPtr->first_ptr->next_ptr;
-
-    return return_error;
-}
-
-void EbCircularBufferDctor(EbPtr p)
-{
-    EbCircularBuffer* obj = (EbCircularBuffer*)p;
-    EB_FREE(obj->array_ptr);
-}
-
-/**************************************
- * EbCircularBufferCtor
- **************************************/
-static EbErrorType EbCircularBufferCtor(
-    EbCircularBuffer  *bufferPtr,
-    uint32_t                buffer_total_count)
-{
-    bufferPtr->dctor = EbCircularBufferDctor;
+    // The ring never holds more than object_total_count wrappers. Round
+    // the size up to a power of two so positions wrap with a mask.
+    while (cellTotalCount < object_total_count)
+        cellTotalCount <<= 1;
+    ringPtr->mask = cellTotalCount - 1;
 
-    bufferPtr->buffer_total_count = buffer_total_count;
-
-    EB_CALLOC(bufferPtr->array_ptr, bufferPtr->buffer_total_count, sizeof(EbPtr));
+    EB_MALLOC(ringPtr->cell_array, sizeof(EbObjectRingCell) * cellTotalCount);
+    for (cellIndex = 0; cellIndex < cellTotalCount; ++cellIndex) {
+        ringPtr->cell_array[cellIndex].sequence = cellIndex;
+        ringPtr->cell_array[cellIndex].wrapper_ptr = (EbObjectWrapper*)EB_NULL;
+    }
+    ringPtr->enqueue_pos = 0;
+    ringPtr->dequeue_pos = 0;
 
     return EB_ErrorNone;
 }
 
 /**************************************
- * EbCircularBufferEmptyCheck
- **************************************/
-static EbBool EbCircularBufferEmptyCheck(
-    EbCircularBuffer   *bufferPtr)
-{
-    return ((bufferPtr->head_index == bufferPtr->tail_index) && (bufferPtr->array_ptr[bufferPtr->head_index] == EB_NULL)) ? EB_TRUE : EB_FALSE;
-}
-
-/**************************************
- * EbCircularBufferPopFront
+ * EbObjectRingPush
+ *   Returns EB_FALSE if the ring is full.
  **************************************/
-static EbErrorType EbCircularBufferPopFront(
-    EbCircularBuffer   *bufferPtr,
-    EbPtr               *object_ptr)
+static EbBool EbObjectRingPush(
+    EbObjectRing      *ringPtr,
+    EbObjectWrapper   *wrapper_ptr)
 {
-    EbErrorType return_error = EB_ErrorNone;
-
-    // Copy the head of the buffer into the object_ptr
-    *object_ptr = bufferPtr->array_ptr[bufferPtr->head_index];
-    bufferPtr->array_ptr[bufferPtr->head_index] = EB_NULL;
-
-    // Increment the head & check for rollover
-    bufferPtr->head_index = (bufferPtr->head_index == bufferPtr->buffer_total_count - 1) ? 0 : bufferPtr->head_index + 1;
+    EbObjectRingCell *cellPtr;
+    uint32_t pos = eb_atomic_load_u32(&ringPtr->enqueue_pos);
+
+    for (;;) {
+        cellPtr = &ringPtr->cell_array[pos & ringPtr->mask];
+        const int32_t diff = (int32_t)(eb_atomic_load_u32(&cellPtr->sequence) - pos);
+        if (diff == 0) {
+            const uint32_t prev = eb_atomic_cas_u32(&ringPtr->enqueue_pos, pos, pos + 1);
+            if (prev == pos)
+                break;
+            pos = prev;
+        }
+        else if (diff < 0)
+            return EB_FALSE;
+        else
+            pos = eb_atomic_load_u32(&ringPtr->enqueue_pos);
+    }
 
-    // Decrement the Current Count
-    --bufferPtr->current_count;
+    cellPtr->wrapper_ptr = wrapper_ptr;
+    eb_atomic_store_u32(&cellPtr->sequence, pos + 1);
 
-    return return_error;
+    return EB_TRUE;
 }
 
 /**************************************
- * EbCircularBufferPushBack
+ * EbObjectRingPop
+ *   Returns EB_FALSE if no filled cell is available at the head.
  **************************************/
-static EbErrorType EbCircularBufferPushBack(
-    EbCircularBuffer   *bufferPtr,
-    EbPtr                object_ptr)
+static EbBool EbObjectRingPop(
+    EbObjectRing      *ringPtr,
+    EbObjectWrapper  **wrapper_ptr)
 {
-    EbErrorType return_error = EB_ErrorNone;
-
-    // Copy the pointer into the array
-    bufferPtr->array_ptr[bufferPtr->tail_index] = object_ptr;
-
-    // Increment the tail & check for rollover
-    bufferPtr->tail_index = (bufferPtr->tail_index == bufferPtr->buffer_total_count - 1) ? 0 : bufferPtr->tail_index + 1;
+    EbObjectRingCell *cellPtr;
+    uint32_t pos = eb_atomic_load_u32(&ringPtr->dequeue_pos);
+
+    for (;;) {
+        cellPtr = &ringPtr->cell_array[pos & ringPtr->mask];
+        const int32_t diff = (int32_t)(eb_atomic_load_u32(&cellPtr->sequence) - (pos + 1));
+        if (diff == 0) {
+            const uint32_t prev = eb_atomic_cas_u32(&ringPtr->dequeue_pos, pos, pos + 1);
+            if (prev == pos)
+                break;
+            pos = prev;
+        }
+        else if (diff < 0)
+            return EB_FALSE;
+        else
+            pos = eb_atomic_load_u32(&ringPtr->dequeue_pos);
+    }
 
-    // Increment the Current Count
-    ++bufferPtr->current_count;
+    *wrapper_ptr = cellPtr->wrapper_ptr;
+    eb_atomic_store_u32(&cellPtr->sequence, pos + ringPtr->mask + 1);
 
-    return return_error;
+    return EB_TRUE;
 }
 
 /**************************************
- * EbCircularBufferPushFront
+ * EbObjectRingPopClaimed
+ *   Pops an object claimed through ready_count. The producer that
+ *   reserved its cell may not have published it yet: pause for a short
+ *   while, then yield so that a preempted producer gets to run.
  **************************************/
-static EbErrorType EbCircularBufferPushFront(
-    EbCircularBuffer   *bufferPtr,
-    EbPtr                object_ptr)
+static void EbObjectRingPopClaimed(
+    EbObjectRing      *ringPtr,
+    EbObjectWrapper  **wrapper_ptr)
 {
-    EbErrorType return_error = EB_ErrorNone;
-
-    // Decrement the head_index
-    bufferPtr->head_index = (bufferPtr->head_index == 0) ? bufferPtr->buffer_total_count - 1 : bufferPtr->head_index - 1;
-
-    // Copy the pointer into the array
-    bufferPtr->array_ptr[bufferPtr->head_index] = object_ptr;
-
-    // Increment the Current Count
-    ++bufferPtr->current_count;
-
-    return return_error;
+    uint32_t spinIndex = 0;
+
+    while (EbObjectRingPop(ringPtr, wrapper_ptr) == EB_FALSE) {
+        if (spinIndex < EB_RING_SPIN_COUNT) {
+            ++spinIndex;
+            eb_cpu_pause();
+        }
+        else
+            eb_yield_thread();
+    }
 }
 
 void EbMuxingQueueDctor(EbPtr p)
 {
     EbMuxingQueue* obj = (EbMuxingQueue*)p;
     EB_DELETE_PTR_ARRAY(obj->process_fifo_ptr_array, obj->process_total_count);
-    EB_DELETE(obj->object_queue);
-    EB_DELETE(obj->process_queue);
-    EB_DESTROY_MUTEX(obj->lockout_mutex);
+    EB_DELETE(obj->object_ring);
+    EB_DESTROY_SEMAPHORE(obj->counting_semaphore);
 }
 
 /**************************************
@@ -205,19 +174,16 @@ static EbErrorType EbMuxingQueueCtor(
     queue_ptr->dctor = EbMuxingQueueDctor;
     queue_ptr->process_total_count = process_total_count;
 
-    // Lockout Mutex
-    EB_CREATE_MUTEX(queue_ptr->lockout_mutex);
-
-    // Construct Object Circular Buffer
+    // Construct the Object Ring
     EB_NEW(
-        queue_ptr->object_queue,
-        EbCircularBufferCtor,
+        queue_ptr->object_ring,
+        EbObjectRingCtor,
         object_total_count);
-    // Construct Process Circular Buffer
-    EB_NEW(
-        queue_ptr->process_queue,
-        EbCircularBufferCtor,
-        queue_ptr->process_total_count);
+
+    // Parking Semaphore for consumers that found the ring empty
+    queue_ptr->ready_count = 0;
+    EB_CREATE_SEMAPHORE(queue_ptr->counting_semaphore, 0, object_total_count);
+
     // Construct the Process Fifos
     EB_ALLOC_PTR_ARRAY(queue_ptr->process_fifo_ptr_array, queue_ptr->process_total_count);
 
@@ -225,10 +191,6 @@ static EbErrorType EbMuxingQueueCtor(
         EB_NEW(
             queue_ptr->process_fifo_ptr_array[processIndex],
             EbFifoCtor,
-            0,
-            object_total_count,
-            (EbObjectWrapper *)EB_NULL,
-            (EbObjectWrapper *)EB_NULL,
             queue_ptr);
     }
 
@@ -238,80 +200,120 @@ static EbErrorType EbMuxingQueueCtor(
 }
 
 /**************************************
- * EbMuxingQueueAssignation
+ * EbMuxingQueueObjectPush
  **************************************/
-static EbErrorType EbMuxingQueueAssignation(
-    EbMuxingQueue *queue_ptr)
+static EbErrorType EbMuxingQueueObjectPush(
+    EbMuxingQueue    *queue_ptr,
+    EbObjectWrapper  *object_ptr)
 {
-    EbErrorType return_error = EB_ErrorNone;
-    EbFifo *processFifoPtr;
-    EbObjectWrapper *wrapper_ptr;
-
-    // while loop
-    while ((EbCircularBufferEmptyCheck(queue_ptr->object_queue) == EB_FALSE) &&
-        (EbCircularBufferEmptyCheck(queue_ptr->process_queue) == EB_FALSE)) {
-        // Get the next process
-        EbCircularBufferPopFront(
-            queue_ptr->process_queue,
-            (void **)&processFifoPtr);
-
-        // Get the next object
-        EbCircularBufferPopFront(
-            queue_ptr->object_queue,
-            (void **)&wrapper_ptr);
-
-        // Block on the Process Fifo's Mutex
-        eb_block_on_mutex(processFifoPtr->lockout_mutex);
-
-        // Put the object on the fifo
-        EbFifoPushBack(
-            processFifoPtr,
-            wrapper_ptr);
-
-        // Release the Process Fifo's Mutex
-        eb_release_mutex(processFifoPtr->lockout_mutex);
-
-        // Post the semaphore
-        eb_post_semaphore(processFifoPtr->counting_semaphore);
-    }
+    // Each wrapper sits in at most one slot of the queue, so the ring
+    // can not overflow.
+    if (EbObjectRingPush(queue_ptr->object_ring, object_ptr) == EB_FALSE)
+        return EB_ErrorInsufficientResources;
 
-    return return_error;
+    // Wake one parked consumer if ready_count was negative
+    if ((int32_t)eb_atomic_add_u32(&queue_ptr->ready_count, 1) <= 0)
+        eb_post_semaphore(queue_ptr->counting_semaphore);
+
+    if (queue_ptr->scheduler_ptr)
+        eb_task_scheduler_notify(queue_ptr->scheduler_ptr);
+
+    return EB_ErrorNone;
 }
 
 /**************************************
- * EbMuxingQueueObjectPushBack
+ * EbMuxingQueueTryAcquire
+ *   Claims one ready object without blocking.
  **************************************/
-static EbErrorType EbMuxingQueueObjectPushBack(
-    EbMuxingQueue    *queue_ptr,
-    EbObjectWrapper  *object_ptr)
+static EbBool EbMuxingQueueTryAcquire(
+    EbMuxingQueue    *queue_ptr)
 {
-    EbErrorType return_error = EB_ErrorNone;
+    uint32_t count = eb_atomic_load_u32(&queue_ptr->ready_count);
 
-    EbCircularBufferPushBack(
-        queue_ptr->object_queue,
-        object_ptr);
+    while ((int32_t)count > 0) {
+        const uint32_t prev = eb_atomic_cas_u32(&queue_ptr->ready_count, count, count - 1);
+        if (prev == count)
+            return EB_TRUE;
+        count = prev;
+    }
+    return EB_FALSE;
+}
+
+/**************************************
+ * EbMuxingQueueObjectPop
+ *   Spins for up to EB_QUEUE_SPIN_COUNT iterations waiting for an object
+ *   and then parks on the counting semaphore.
+ **************************************/
+static void EbMuxingQueueObjectPop(
+    EbMuxingQueue     *queue_ptr,
+    EbObjectWrapper  **wrapper_dbl_ptr)
+{
+    uint32_t spinIndex;
+    EbBool   acquired = EB_FALSE;
 
-    EbMuxingQueueAssignation(queue_ptr);
+    for (spinIndex = 0; spinIndex < EB_QUEUE_SPIN_COUNT && !acquired; ++spinIndex) {
+        acquired = EbMuxingQueueTryAcquire(queue_ptr);
+        if (!acquired)
+            eb_cpu_pause();
+    }
 
-    return return_error;
+    if (!acquired) {
+        // ready_count goes negative while consumers are parked
+        if ((int32_t)eb_atomic_add_u32(&queue_ptr->ready_count, (uint32_t)-1) < 0) {
+            eb_task_scheduler_enter_wait();
+            eb_block_on_semaphore(queue_ptr->counting_semaphore);
+            eb_task_scheduler_leave_wait();
+        }
+    }
+
+    // The claimed object may still be in flight from a producer that
+    // reserved an earlier cell
+    EbObjectRingPopClaimed(queue_ptr->object_ring, wrapper_dbl_ptr);
 }
 
 /**************************************
-* EbMuxingQueueObjectPushFront
-**************************************/
-static EbErrorType EbMuxingQueueObjectPushFront(
-    EbMuxingQueue    *queue_ptr,
-    EbObjectWrapper  *object_ptr)
+ * EbMuxingQueueObjectPopTimeout
+ *   EbMuxingQueueObjectPop giving up after timeout milliseconds parked.
+ **************************************/
+static EbBool EbMuxingQueueObjectPopTimeout(
+    EbMuxingQueue     *queue_ptr,
+    EbObjectWrapper  **wrapper_dbl_ptr,
+    uint32_t           timeout)
 {
-    EbErrorType return_error = EB_ErrorNone;
+    uint32_t spinIndex;
+    EbBool   acquired = EB_FALSE;
 
-    EbCircularBufferPushFront(
-        queue_ptr->object_queue,
-        object_ptr);
+    for (spinIndex = 0; spinIndex < EB_QUEUE_SPIN_COUNT && !acquired; ++spinIndex) {
+        acquired = EbMuxingQueueTryAcquire(queue_ptr);
+        if (!acquired)
+            eb_cpu_pause();
+    }
 
-    EbMuxingQueueAssignation(queue_ptr);
+    if (!acquired) {
+        if ((int32_t)eb_atomic_add_u32(&queue_ptr->ready_count, (uint32_t)-1) < 0) {
+            eb_task_scheduler_enter_wait();
+            acquired = eb_block_on_semaphore_timeout(queue_ptr->counting_semaphore, timeout) == EB_ErrorNone;
+            eb_task_scheduler_leave_wait();
+
+            if (!acquired) {
+                // Withdraw the parked claim, unless a producer has already
+                // counted it and its post is on the way
+                uint32_t count = eb_atomic_load_u32(&queue_ptr->ready_count);
+                while ((int32_t)count < 0) {
+                    const uint32_t prev = eb_atomic_cas_u32(&queue_ptr->ready_count, count, count + 1);
+                    if (prev == count) {
+                        *wrapper_dbl_ptr = (EbObjectWrapper*)EB_NULL;
+                        return EB_FALSE;
+                    }
+                    count = prev;
+                }
+                eb_block_on_semaphore(queue_ptr->counting_semaphore);
+            }
+        }
+    }
 
-    return return_error;
+    EbObjectRingPopClaimed(queue_ptr->object_ring, wrapper_dbl_ptr);
+    return EB_TRUE;
 }
 
 /*********************************************************************
@@ -320,11 +322,6 @@ static EbErrorType EbMuxingQueueObjectPushFront(
  *   certain objects (e.g. SequenceControlSet) to control whether
  *   EbObjectWrappers are allowed to be released or not.
  *
- *   resource_ptr
- *      pointer to the SystemResource that manages the EbObjectWrapper.
- *      The emptyFifo's lockout_mutex is used to write protect the
- *      modification of the EbObjectWrapper.
- *
  *   wrapper_ptr
  *      pointer to the EbObjectWrapper to be modified.
  *********************************************************************/
@@ -333,11 +330,8 @@ EbErrorType eb_object_release_enable(
 {
     EbErrorType return_error = EB_ErrorNone;
 
-    eb_block_on_mutex(wrapper_ptr->system_resource_ptr->empty_queue->lockout_mutex);
-
     wrapper_ptr->release_enable = EB_TRUE;
-
-    eb_release_mutex(wrapper_ptr->system_resource_ptr->empty_queue->lockout_mutex);
+    eb_atomic_fence();
 
     return return_error;
 }
@@ -348,11 +342,6 @@ EbErrorType eb_object_release_enable(
  *   certain objects (e.g. SequenceControlSet) to control whether
  *   EbObjectWrappers are allowed to be released or not.
  *
- *   resource_ptr
- *      pointer to the SystemResource that manages the EbObjectWrapper.
- *      The emptyFifo's lockout_mutex is used to write protect the
- *      modification of the EbObjectWrapper.
- *
  *   wrapper_ptr
  *      pointer to the EbObjectWrapper to be modified.
  *********************************************************************/
@@ -361,11 +350,8 @@ EbErrorType eb_object_release_disable(
 {
     EbErrorType return_error = EB_ErrorNone;
 
-    eb_block_on_mutex(wrapper_ptr->system_resource_ptr->empty_queue->lockout_mutex);
-
     wrapper_ptr->release_enable = EB_FALSE;
-
-    eb_release_mutex(wrapper_ptr->system_resource_ptr->empty_queue->lockout_mutex);
+    eb_atomic_fence();
 
     return return_error;
 }
@@ -376,11 +362,6 @@ EbErrorType eb_object_release_disable(
  *   certain objects (e.g. SequenceControlSet) to count the number of active
  *   pointers of a EbObjectWrapper in pipeline at any point in time.
  *
- *   resource_ptr
- *      pointer to the SystemResource that manages the EbObjectWrapper.
- *      The emptyFifo's lockout_mutex is used to write protect the
- *      modification of the EbObjectWrapper.
- *
  *   wrapper_ptr
  *      pointer to the EbObjectWrapper to be modified.
  *********************************************************************/
@@ -390,11 +371,7 @@ EbErrorType eb_object_inc_live_count(
 {
     EbErrorType return_error = EB_ErrorNone;
 
-    eb_block_on_mutex(wrapper_ptr->system_resource_ptr->empty_queue->lockout_mutex);
-
-    wrapper_ptr->live_count += increment_number;
-
-    eb_release_mutex(wrapper_ptr->system_resource_ptr->empty_queue->lockout_mutex);
+    eb_atomic_add_u32(&wrapper_ptr->live_count, increment_number);
 
     return return_error;
 }
@@ -443,7 +420,112 @@ static void eb_system_resource_dctor(EbPtr p)
     EbSystemResource* obj = (EbSystemResource*)p;
     EB_DELETE(obj->full_queue);
     EB_DELETE(obj->empty_queue);
-    EB_DELETE_PTR_ARRAY(obj->wrapper_ptr_pool, obj->object_total_count);
+    EB_DELETE_PTR_ARRAY(obj->wrapper_ptr_pool, obj->object_max_count);
+    if (obj->object_init_data_size)
+        EB_FREE(obj->object_init_data_ptr);
+    EB_DESTROY_MUTEX(obj->pool_mutex);
+    EB_DELETE(obj->arena_ptr);
+}
+
+/**************************************
+ * eb_system_resource_add_object
+ *   Constructs the wrapper of an empty slot of the wrapper_ptr_pool, with
+ *   the picture planes carved from the arena of the resource.
+ **************************************/
+static EbErrorType eb_system_resource_add_object(
+    EbSystemResource *resource_ptr,
+    uint32_t          wrapperIndex)
+{
+    const uint64_t memorySize = eb_get_thread_memory();
+    EbArena       *arena_ptr = eb_arena_get_current();
+
+    eb_arena_set_current(resource_ptr->arena_ptr);
+    EB_NO_THROW_NEW(resource_ptr->wrapper_ptr_pool[wrapperIndex], eb_object_wrapper_ctor, resource_ptr,
+        resource_ptr->object_creator, resource_ptr->object_init_data_ptr, resource_ptr->object_destroyer);
+    eb_arena_set_current(arena_ptr);
+    if (resource_ptr->wrapper_ptr_pool[wrapperIndex] == NULL)
+        return EB_ErrorInsufficientResources;
+
+    if (resource_ptr->object_size == 0)
+        resource_ptr->object_size = eb_get_thread_memory() - memorySize;
+
+    return EB_ErrorNone;
+}
+
+/**************************************
+ * eb_system_resource_find_free_slot
+ *   The pool_mutex is held and object_total_count is below
+ *   object_max_count, so there is an empty slot.
+ **************************************/
+static uint32_t eb_system_resource_find_free_slot(
+    EbSystemResource *resource_ptr)
+{
+    uint32_t wrapperIndex = 0;
+
+    while (resource_ptr->wrapper_ptr_pool[wrapperIndex])
+        ++wrapperIndex;
+    return wrapperIndex;
+}
+
+/**************************************
+ * eb_system_resource_grow
+ *   Constructs one more object for a producer that found the empty
+ *   queue empty. Returns EB_FALSE at the limit.
+ **************************************/
+static EbBool eb_system_resource_grow(
+    EbSystemResource  *resource_ptr,
+    EbObjectWrapper  **wrapper_dbl_ptr)
+{
+    EbBool   grown = EB_FALSE;
+    uint32_t wrapperIndex;
+
+    if (eb_atomic_load_u32(&resource_ptr->object_total_count) >= resource_ptr->object_limit_count)
+        return EB_FALSE;
+
+    eb_block_on_mutex(resource_ptr->pool_mutex);
+    if (resource_ptr->object_total_count < resource_ptr->object_limit_count) {
+        wrapperIndex = eb_system_resource_find_free_slot(resource_ptr);
+        if (eb_system_resource_add_object(resource_ptr, wrapperIndex) == EB_ErrorNone) {
+            *wrapper_dbl_ptr = resource_ptr->wrapper_ptr_pool[wrapperIndex];
+            eb_atomic_add_u32(&resource_ptr->object_total_count, 1);
+            grown = EB_TRUE;
+        }
+    }
+    eb_release_mutex(resource_ptr->pool_mutex);
+
+    return grown;
+}
+
+/**************************************
+ * eb_system_resource_shrink
+ *   Destroys a released object instead of queuing it when the resource
+ *   is above its initial count and has been idle. Returns EB_TRUE if the
+ *   object was destroyed.
+ **************************************/
+static EbBool eb_system_resource_shrink(
+    EbSystemResource  *resource_ptr,
+    EbObjectWrapper   *wrapper_ptr)
+{
+    uint32_t wrapperIndex = 0;
+
+    if (eb_atomic_load_u32(&resource_ptr->object_total_count) <= resource_ptr->object_init_count ||
+        EbGetTimeUs() - resource_ptr->empty_time < EB_ELASTIC_IDLE_TIME)
+        return EB_FALSE;
+
+    eb_block_on_mutex(resource_ptr->pool_mutex);
+    if (resource_ptr->object_total_count <= resource_ptr->object_init_count) {
+        eb_release_mutex(resource_ptr->pool_mutex);
+        return EB_FALSE;
+    }
+    while (resource_ptr->wrapper_ptr_pool[wrapperIndex] != wrapper_ptr)
+        ++wrapperIndex;
+    resource_ptr->wrapper_ptr_pool[wrapperIndex] = (EbObjectWrapper*)EB_NULL;
+    eb_atomic_add_u32(&resource_ptr->object_total_count, (uint32_t)-1);
+    eb_release_mutex(resource_ptr->pool_mutex);
+
+    EB_DELETE(wrapper_ptr);
+
+    return EB_TRUE;
 }
 
 /*********************************************************************
@@ -487,42 +569,101 @@ EbErrorType eb_system_resource_ctor(
     EbCreator           object_creator,
     EbPtr               object_init_data_ptr,
     EbDctor             object_destroyer)
+{
+    return eb_system_resource_elastic_ctor(
+        resource_ptr,
+        object_total_count,
+        object_total_count,
+        producer_process_total_count,
+        consumer_process_total_count,
+        producer_fifo_ptr_array_ptr,
+        consumer_fifo_ptr_array_ptr,
+        full_fifo_enabled,
+        object_creator,
+        object_init_data_ptr,
+        0,
+        object_destroyer);
+}
+
+/*********************************************************************
+ * eb_system_resource_elastic_ctor
+ *********************************************************************/
+EbErrorType eb_system_resource_elastic_ctor(
+    EbSystemResource *resource_ptr,
+    uint32_t               object_init_count,
+    uint32_t               object_max_count,
+    uint32_t               producer_process_total_count,
+    uint32_t               consumer_process_total_count,
+    EbFifo          ***producer_fifo_ptr_array_ptr,
+    EbFifo          ***consumer_fifo_ptr_array_ptr,
+    EbBool              full_fifo_enabled,
+    EbCreator           object_creator,
+    EbPtr               object_init_data_ptr,
+    size_t              object_init_data_size,
+    EbDctor             object_destroyer)
 {
     uint32_t wrapperIndex;
     EbErrorType return_error = EB_ErrorNone;
     resource_ptr->dctor = eb_system_resource_dctor;
 
-    resource_ptr->object_total_count = object_total_count;
+    resource_ptr->object_max_count = object_max_count;
+    resource_ptr->object_init_count = MIN(object_init_count, object_max_count);
+    resource_ptr->object_limit_count = object_max_count;
+    resource_ptr->object_creator = object_creator;
+    resource_ptr->object_init_data_ptr = object_init_data_ptr;
+    resource_ptr->object_destroyer = object_destroyer;
+
+    // Objects constructed later need their own copy of the init data
+    if (resource_ptr->object_init_count < object_max_count) {
+        if (object_init_data_size) {
+            EB_MALLOC(resource_ptr->object_init_data_ptr, object_init_data_size);
+            resource_ptr->object_init_data_size = object_init_data_size;
+            memcpy(resource_ptr->object_init_data_ptr, object_init_data_ptr, object_init_data_size);
+        }
+        EB_CREATE_MUTEX(resource_ptr->pool_mutex);
+        resource_ptr->empty_time = EbGetTimeUs();
+    }
+
+    if (eb_arena_get_pool_mode() != EB_ARENA_OFF)
+        EB_NEW(resource_ptr->arena_ptr, eb_arena_ctor, eb_arena_get_pool_mode());
 
     // Allocate array for wrapper pointers
-    EB_ALLOC_PTR_ARRAY(resource_ptr->wrapper_ptr_pool, resource_ptr->object_total_count);
+    EB_ALLOC_PTR_ARRAY(resource_ptr->wrapper_ptr_pool, resource_ptr->object_max_count);
 
     // Initialize each wrapper
-    for (wrapperIndex = 0; wrapperIndex < resource_ptr->object_total_count; ++wrapperIndex) {
-        EB_NEW(resource_ptr->wrapper_ptr_pool[wrapperIndex], eb_object_wrapper_ctor, resource_ptr,
-            object_creator, object_init_data_ptr, object_destroyer);
+    for (wrapperIndex = 0; wrapperIndex < resource_ptr->object_init_count; ++wrapperIndex) {
+        return_error = eb_system_resource_add_object(resource_ptr, wrapperIndex);
+        if (return_error != EB_ErrorNone)
+            break;
     }
+    if (return_error != EB_ErrorNone)
+        return return_error;
+    resource_ptr->object_total_count = resource_ptr->object_init_count;
 
     // Initialize the Empty Queue
     EB_NEW(
         resource_ptr->empty_queue,
         EbMuxingQueueCtor,
-        resource_ptr->object_total_count,
+        resource_ptr->object_max_count,
         producer_process_total_count,
         producer_fifo_ptr_array_ptr);
     // Fill the Empty Fifo with every ObjectWrapper
     for (wrapperIndex = 0; wrapperIndex < resource_ptr->object_total_count; ++wrapperIndex) {
-        EbMuxingQueueObjectPushBack(
+        return_error = EbMuxingQueueObjectPush(
             resource_ptr->empty_queue,
             resource_ptr->wrapper_ptr_pool[wrapperIndex]);
+        if (return_error != EB_ErrorNone)
+            return return_error;
     }
+    if (resource_ptr->pool_mutex)
+        resource_ptr->empty_queue->resource_ptr = resource_ptr;
 
     // Initialize the Full Queue
     if (full_fifo_enabled == EB_TRUE) {
         EB_NEW(
             resource_ptr->full_queue,
             EbMuxingQueueCtor,
-            resource_ptr->object_total_count,
+            resource_ptr->object_max_count,
             consumer_process_total_count,
             consumer_fifo_ptr_array_ptr);
         if (return_error == EB_ErrorInsufficientResources)
@@ -537,22 +678,57 @@ EbErrorType eb_system_resource_ctor(
 }
 
 /*********************************************************************
- * EbSystemResourceReleaseProcess
+ * eb_system_resource_set_limit
  *********************************************************************/
-static EbErrorType EbReleaseProcess(
-    EbFifo   *processFifoPtr)
+void eb_system_resource_set_limit(
+    EbSystemResource *resource_ptr,
+    uint32_t          object_limit_count)
 {
-    EbErrorType return_error = EB_ErrorNone;
-
-    eb_block_on_mutex(processFifoPtr->queue_ptr->lockout_mutex);
-
-    EbCircularBufferPushFront(
-        processFifoPtr->queue_ptr->process_queue,
-        processFifoPtr);
+    resource_ptr->object_limit_count = CLIP3(resource_ptr->object_init_count,
+        resource_ptr->object_max_count, object_limit_count);
+}
 
-    EbMuxingQueueAssignation(processFifoPtr->queue_ptr);
+/*********************************************************************
+ * eb_system_resource_set_release_callback
+ *********************************************************************/
+void eb_system_resource_set_release_callback(
+    EbSystemResource       *resource_ptr,
+    EbObjectReleaseCallback release_callback,
+    EbPtr                   context_ptr)
+{
+    resource_ptr->object_release_context = context_ptr;
+    resource_ptr->object_release_callback = release_callback;
+}
 
-    eb_release_mutex(processFifoPtr->queue_ptr->lockout_mutex);
+/*********************************************************************
+ * eb_system_resource_reserve
+ *********************************************************************/
+EbErrorType eb_system_resource_reserve(
+    EbSystemResource *resource_ptr,
+    uint32_t          object_count)
+{
+    EbErrorType return_error = EB_ErrorNone;
+    uint32_t    wrapperIndex;
+
+    if (resource_ptr->pool_mutex == NULL)
+        return EB_ErrorNone;
+    object_count = MIN(object_count, resource_ptr->object_limit_count);
+
+    eb_block_on_mutex(resource_ptr->pool_mutex);
+    while (resource_ptr->object_total_count < object_count) {
+        wrapperIndex = eb_system_resource_find_free_slot(resource_ptr);
+        return_error = eb_system_resource_add_object(resource_ptr, wrapperIndex);
+        if (return_error != EB_ErrorNone)
+            break;
+        eb_atomic_add_u32(&resource_ptr->object_total_count, 1);
+        return_error = EbMuxingQueueObjectPush(
+            resource_ptr->empty_queue,
+            resource_ptr->wrapper_ptr_pool[wrapperIndex]);
+        if (return_error != EB_ErrorNone)
+            break;
+    }
+    resource_ptr->object_init_count = MAX(resource_ptr->object_init_count, resource_ptr->object_total_count);
+    eb_release_mutex(resource_ptr->pool_mutex);
 
     return return_error;
 }
@@ -560,9 +736,8 @@ static EbErrorType EbReleaseProcess(
 /*********************************************************************
  * EbSystemResourcePostObject
  *   Queues a full EbObjectWrapper to the SystemResource. This
- *   function posts the SystemResource fullFifo counting_semaphore.
- *   This function is write protected by the SystemResource fullFifo
- *   lockout_mutex.
+ *   function wakes a consumer parked on the SystemResource fullFifo
+ *   counting_semaphore.
  *
  *   resource_ptr
  *      pointer to the SystemResource that the EbObjectWrapper is
@@ -574,25 +749,16 @@ static EbErrorType EbReleaseProcess(
 EbErrorType eb_post_full_object(
     EbObjectWrapper   *object_ptr)
 {
-    EbErrorType return_error = EB_ErrorNone;
-
-    eb_block_on_mutex(object_ptr->system_resource_ptr->full_queue->lockout_mutex);
-
-    EbMuxingQueueObjectPushBack(
+    return EbMuxingQueueObjectPush(
         object_ptr->system_resource_ptr->full_queue,
         object_ptr);
-
-    eb_release_mutex(object_ptr->system_resource_ptr->full_queue->lockout_mutex);
-
-    return return_error;
 }
 
 /*********************************************************************
  * EbSystemResourceReleaseObject
  *   Queues an empty EbObjectWrapper to the SystemResource. This
- *   function posts the SystemResource emptyFifo counting_semaphore.
- *   This function is write protected by the SystemResource emptyFifo
- *   lockout_mutex.
+ *   function wakes a producer parked on the SystemResource emptyFifo
+ *   counting_semaphore.
  *
  *   object_ptr
  *      pointer to EbObjectWrapper to be released.
@@ -601,32 +767,69 @@ EbErrorType eb_release_object(
     EbObjectWrapper   *object_ptr)
 {
     EbErrorType return_error = EB_ErrorNone;
+    uint32_t    liveCount = eb_atomic_load_u32(&object_ptr->live_count);
+    uint32_t    prev;
+
+    // Decrement live_count, saturating at zero
+    for (;;) {
+        const uint32_t next = (liveCount == 0) ? 0 : liveCount - 1;
+        prev = eb_atomic_cas_u32(&object_ptr->live_count, liveCount, next);
+        if (prev == liveCount) {
+            liveCount = next;
+            break;
+        }
+        liveCount = prev;
+    }
 
-    eb_block_on_mutex(object_ptr->system_resource_ptr->empty_queue->lockout_mutex);
-
-    // Decrement live_count
-    object_ptr->live_count = (object_ptr->live_count == 0) ? object_ptr->live_count : object_ptr->live_count - 1;
-
-    if ((object_ptr->release_enable == EB_TRUE) && (object_ptr->live_count == 0)) {
-        // Set live_count to EB_ObjectWrapperReleasedValue
-        object_ptr->live_count = EB_ObjectWrapperReleasedValue;
-
-        EbMuxingQueueObjectPushFront(
+    // Only the thread that moves live_count from 0 to
+    // EB_ObjectWrapperReleasedValue hands the wrapper back
+    if ((object_ptr->release_enable == EB_TRUE) && (liveCount == 0) &&
+        eb_atomic_cas_u32(&object_ptr->live_count, 0, EB_ObjectWrapperReleasedValue) == 0) {
+        if (object_ptr->system_resource_ptr->object_release_callback)
+            object_ptr->system_resource_ptr->object_release_callback(
+                object_ptr->system_resource_ptr->object_release_context,
+                object_ptr);
+        if (object_ptr->system_resource_ptr->empty_queue->resource_ptr &&
+            eb_system_resource_shrink(object_ptr->system_resource_ptr, object_ptr) == EB_TRUE)
+            return return_error;
+        return_error = EbMuxingQueueObjectPush(
             object_ptr->system_resource_ptr->empty_queue,
             object_ptr);
     }
 
-    eb_release_mutex(object_ptr->system_resource_ptr->empty_queue->lockout_mutex);
-
     return return_error;
 }
 
+/**************************************
+ * eb_system_resource_empty_pop
+ *   An elastic resource grows rather than blocking on an empty queue.
+ **************************************/
+static void eb_system_resource_empty_pop(
+    EbMuxingQueue     *queue_ptr,
+    EbObjectWrapper  **wrapper_dbl_ptr)
+{
+    EbSystemResource *resource_ptr = queue_ptr->resource_ptr;
+
+    if (resource_ptr) {
+        if (EbMuxingQueueTryAcquire(queue_ptr) == EB_TRUE) {
+            EbObjectRingPopClaimed(queue_ptr->object_ring, wrapper_dbl_ptr);
+            return;
+        }
+        resource_ptr->empty_time = EbGetTimeUs();
+        if (eb_system_resource_grow(resource_ptr, wrapper_dbl_ptr) == EB_TRUE)
+            return;
+    }
+    EbMuxingQueueObjectPop(
+        queue_ptr,
+        wrapper_dbl_ptr);
+}
+
 /*********************************************************************
  * EbSystemResourceGetEmptyObject
  *   Dequeues an empty EbObjectWrapper from the SystemResource.  This
- *   function blocks on the SystemResource emptyFifo counting_semaphore.
- *   This function is write protected by the SystemResource emptyFifo
- *   lockout_mutex.
+ *   function spins briefly and then blocks on the SystemResource
+ *   emptyFifo counting_semaphore. An elastic SystemResource below its
+ *   limit constructs a new object instead.
  *
  *   resource_ptr
  *      pointer to the SystemResource that provides the empty
@@ -642,38 +845,43 @@ EbErrorType eb_get_empty_object(
 {
     EbErrorType return_error = EB_ErrorNone;
 
-    // Queue the Fifo requesting the empty fifo
-    EbReleaseProcess(empty_fifo_ptr);
-
-    // Block on the counting Semaphore until an empty buffer is available
-    eb_block_on_semaphore(empty_fifo_ptr->counting_semaphore);
+    // Get the empty object
+    if (stats_queue_ptr) {
+        const uint64_t start_time = EbGetTimeUs();
+        uint64_t       wait_time;
 
-    // Acquire lockout Mutex
-    eb_block_on_mutex(empty_fifo_ptr->lockout_mutex);
+        eb_system_resource_empty_pop(
+            empty_fifo_ptr->queue_ptr,
+            wrapper_dbl_ptr);
 
-    // Get the empty object
-    EbFifoPopFront(
-        empty_fifo_ptr,
-        wrapper_dbl_ptr);
+        // The wait is not part of the busy time of the stage
+        wait_time = EbGetTimeUs() - start_time;
+        if (stats_queue_ptr->stats_enabled)
+            eb_atomic_add_u64(&stats_queue_ptr->stats.output_wait_time, wait_time);
+        stats_start_time += wait_time;
+        if (stats_queue_ptr->trace_ptr && wait_time >= EB_TRACE_WAIT_MIN_TIME)
+            eb_trace_span_end("output_wait", start_time, EB_TRACE_NO_PICTURE, EB_TRACE_NO_SEGMENT);
+    }
+    else {
+        eb_system_resource_empty_pop(
+            empty_fifo_ptr->queue_ptr,
+            wrapper_dbl_ptr);
+    }
 
     // Reset the wrapper's live_count
-    (*wrapper_dbl_ptr)->live_count = 0;
+    eb_atomic_store_u32(&(*wrapper_dbl_ptr)->live_count, 0);
 
     // Object release enable
     (*wrapper_dbl_ptr)->release_enable = EB_TRUE;
 
-    // Release Mutex
-    eb_release_mutex(empty_fifo_ptr->lockout_mutex);
-
     return return_error;
 }
 
 /*********************************************************************
  * EbSystemResourceGetFullObject
  *   Dequeues an full EbObjectWrapper from the SystemResource. This
- *   function blocks on the SystemResource fullFifo counting_semaphore.
- *   This function is write protected by the SystemResource fullFifo
- *   lockout_mutex.
+ *   function spins briefly and then blocks on the SystemResource
+ *   fullFifo counting_semaphore.
  *
  *   resource_ptr
  *      pointer to the SystemResource that provides the full
@@ -688,63 +896,96 @@ EbErrorType eb_get_full_object(
     EbObjectWrapper **wrapper_dbl_ptr)
 {
     EbErrorType return_error = EB_ErrorNone;
+    EbMuxingQueue *queue_ptr = full_fifo_ptr->queue_ptr;
+    uint64_t start_time;
+
+    // Asking for the next object ends the work on the previous one
+    eb_object_stats_finish();
+    if (!queue_ptr->stats_enabled && !queue_ptr->trace_ptr) {
+        EbMuxingQueueObjectPop(
+            queue_ptr,
+            wrapper_dbl_ptr);
+        return return_error;
+    }
+    start_time = EbGetTimeUs();
 
-    // Queue the Fifo requesting the full fifo
-    EbReleaseProcess(full_fifo_ptr);
-
-    // Block on the counting Semaphore until an empty buffer is available
-    eb_block_on_semaphore(full_fifo_ptr->counting_semaphore);
-
-    // Acquire lockout Mutex
-    eb_block_on_mutex(full_fifo_ptr->lockout_mutex);
-
-    EbFifoPopFront(
-        full_fifo_ptr,
+    EbMuxingQueueObjectPop(
+        queue_ptr,
         wrapper_dbl_ptr);
 
-    // Release Mutex
-    eb_release_mutex(full_fifo_ptr->lockout_mutex);
+    eb_object_stats_start(full_fifo_ptr);
+    if (queue_ptr->stats_enabled)
+        eb_atomic_add_u64(&queue_ptr->stats.input_wait_time, stats_start_time - start_time);
 
     return return_error;
 }
 
-/**************************************
-* EbFifoPopFront
-**************************************/
-static EbBool EbFifoPeakFront(
-    EbFifo            *fifoPtr)
-{
-    // Set wrapper_ptr to head of BufferPool
-    if (fifoPtr->first_ptr == (EbObjectWrapper*)EB_NULL)
-        return EB_TRUE;
-    else
-        return EB_FALSE;
-}
-
 EbErrorType eb_get_full_object_non_blocking(
     EbFifo   *full_fifo_ptr,
     EbObjectWrapper **wrapper_dbl_ptr)
 {
     EbErrorType return_error = EB_ErrorNone;
-    EbBool      fifoEmpty;
-    // Queue the Fifo requesting the full fifo
-    EbReleaseProcess(full_fifo_ptr);
-
-    // Acquire lockout Mutex
-    eb_block_on_mutex(full_fifo_ptr->lockout_mutex);
+    EbMuxingQueue *queue_ptr = full_fifo_ptr->queue_ptr;
 
-    fifoEmpty = EbFifoPeakFront(
-        full_fifo_ptr);
-
-    // Release Mutex
-    eb_release_mutex(full_fifo_ptr->lockout_mutex);
-
-    if (fifoEmpty == EB_FALSE)
-        eb_get_full_object(
-            full_fifo_ptr,
-            wrapper_dbl_ptr);
+    if (EbMuxingQueueTryAcquire(queue_ptr) == EB_TRUE) {
+        EbObjectRingPopClaimed(queue_ptr->object_ring, wrapper_dbl_ptr);
+    }
     else
         *wrapper_dbl_ptr = (EbObjectWrapper*)EB_NULL;
 
     return return_error;
 }
+
+/*********************************************************************
+ * eb_get_full_object_timeout
+ *   Returns EB_NoErrorEmptyQueue and a NULL wrapper when no full object
+ *   arrived within timeout milliseconds.
+ *********************************************************************/
+EbErrorType eb_get_full_object_timeout(
+    EbFifo   *full_fifo_ptr,
+    EbObjectWrapper **wrapper_dbl_ptr,
+    uint32_t  timeout)
+{
+    EbMuxingQueue *queue_ptr = full_fifo_ptr->queue_ptr;
+    uint64_t start_time;
+
+    eb_object_stats_finish();
+    start_time = (queue_ptr->stats_enabled || queue_ptr->trace_ptr) ? EbGetTimeUs() : 0;
+
+    if (EbMuxingQueueObjectPopTimeout(queue_ptr, wrapper_dbl_ptr, timeout) == EB_FALSE)
+        return EB_NoErrorEmptyQueue;
+
+    eb_object_stats_start(full_fifo_ptr);
+    if (queue_ptr->stats_enabled)
+        eb_atomic_add_u64(&queue_ptr->stats.input_wait_time, stats_start_time - start_time);
+
+    return EB_ErrorNone;
+}
+
+void eb_object_stats_start(
+    EbFifo   *full_fifo_ptr)
+{
+    EbMuxingQueue *queue_ptr = full_fifo_ptr->queue_ptr;
+
+    // Nothing is timed for a stage neither measured nor traced
+    if (!queue_ptr->stats_enabled && !queue_ptr->trace_ptr)
+        return;
+    stats_queue_ptr = queue_ptr;
+    stats_start_time = EbGetTimeUs();
+    if (stats_queue_ptr->stats_enabled)
+        eb_atomic_add_u64(&stats_queue_ptr->stats.object_count, 1);
+    if (stats_queue_ptr->trace_ptr)
+        eb_trace_object_begin(stats_queue_ptr->trace_ptr, stats_queue_ptr->trace_name, stats_start_time);
+}
+
+void eb_object_stats_finish(void)
+{
+    if (stats_queue_ptr) {
+        const uint64_t end_time = EbGetTimeUs();
+        if (stats_queue_ptr->stats_enabled)
+            eb_atomic_add_u64(&stats_queue_ptr->stats.busy_time, end_time - stats_start_time);
+        if (stats_queue_ptr->trace_ptr)
+            eb_trace_object_end(end_time);
+        stats_queue_ptr = NULL;
+    }
+}
@@ -9,6 +9,7 @@
 #include "EbDefinitions.h"
 #include "EbThreads.h"
 #include "EbObject.h"
+#include "EbArena.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -17,6 +18,22 @@ extern "C" {
      *********************************/
 #define EB_ObjectWrapperReleasedValue   ~0u
 
+// Number of polling iterations a consumer performs on an empty queue
+// before parking on the OS semaphore.
+#define EB_QUEUE_SPIN_COUNT             256
+
+// Number of pause iterations a consumer waits for a claimed object still
+// being published by its producer before yielding its time slice.
+#define EB_RING_SPIN_COUNT              64
+
+// Time (in us) an elastic SystemResource has to go without running out of
+// empty objects before the objects above its initial count are destroyed.
+#define EB_ELASTIC_IDLE_TIME            2000000
+
+struct EbTaskScheduler;
+struct EbTrace;
+struct EbSystemResource;
+
      /*********************************************************************
       * Object Wrapper
       *   Provides state information for each type of object in the
@@ -33,48 +50,33 @@ extern "C" {
 
         // live_count - a count of the number of pictures actively being
         //   encoded in the pipeline at any given time.  Modification
-        //   of this value by any process must be protected by a mutex.
-        uint32_t                    live_count;
+        //   of this value by any process must be atomic.
+        volatile uint32_t           live_count;
 
         // release_enable - a flag that enables the release of
         //   EbObjectWrapper for reuse in the encoding of subsequent
         //   pictures in the encoder pipeline.
-        EbBool                   release_enable;
+        volatile EbBool          release_enable;
 
         // system_resource_ptr - a pointer to the SystemResourceManager
         //   that the object belongs to.
         struct EbSystemResource *system_resource_ptr;
-
-        // next_ptr - a pointer to a different EbObjectWrapper.  Used
-        //   only in the implemenation of a single-linked Fifo.
-        struct EbObjectWrapper *next_ptr;
     } EbObjectWrapper;
 
+    // Called on the releasing thread when a wrapper goes back to its pool
+    typedef void(*EbObjectReleaseCallback)(
+        EbPtr            context_ptr,
+        EbObjectWrapper *wrapper_ptr);
+
     /*********************************************************************
      * Fifo
-     *   Defines a static (i.e. no dynamic memory allocation) single
-     *   linked-list, constant time fifo implmentation. The fifo uses
-     *   the EbObjectWrapper member next_ptr to create the linked-list.
-     *   The Fifo also contains a counting_semaphore for OS thread-blocking
-     *   and dynamic EbObjectWrapper counting.
+     *   Per-process handle on a MuxingQueue. Every process attached to
+     *   the same MuxingQueue shares its ring and wait semaphore, so an
+     *   object is handed to whichever process asks for it first.
      *********************************************************************/
     typedef struct EbFifo
     {
         EbDctor  dctor;
-        // counting_semaphore - used for OS thread-blocking & dynamically
-        //   counting the number of EbObjectWrappers currently in the
-        //   EbFifo.
-        EbHandle counting_semaphore;
-
-        // lockout_mutex - used to prevent more than one thread from
-        //   modifying EbFifo simultaneously.
-        EbHandle lockout_mutex;
-
-        // first_ptr - pointer the the head of the Fifo
-        EbObjectWrapper *first_ptr;
-
-        // last_ptr - pointer to the tail of the Fifo
-        EbObjectWrapper *last_ptr;
 
         // queue_ptr - pointer to MuxingQueue that the EbFifo is
         //   associated with.
@@ -82,29 +84,74 @@ extern "C" {
     } EbFifo;
 
     /*********************************************************************
-     * CircularBuffer
+     * ObjectRing
+     *   Bounded multi-producer multi-consumer ring of EbObjectWrapper
+     *   pointers. Each cell carries a sequence number that tells
+     *   producers and consumers whether the cell is free or filled for
+     *   the current lap, so push and pop only need a single
+     *   compare-and-swap on the shared position.
+     *********************************************************************/
+    typedef struct EbObjectRingCell
+    {
+        volatile uint32_t  sequence;
+        EbObjectWrapper   *wrapper_ptr;
+    } EbObjectRingCell;
+
+    typedef struct EbObjectRing
+    {
+        EbDctor            dctor;
+        EbObjectRingCell  *cell_array;
+        uint32_t           mask;
+        // Producer and consumer positions live on separate cache lines
+        uint8_t            pad0[64];
+        volatile uint32_t  enqueue_pos;
+        uint8_t            pad1[64];
+        volatile uint32_t  dequeue_pos;
+        uint8_t            pad2[64];
+    } EbObjectRing;
+
+    /*********************************************************************
+     * QueueStats
+     *   Statistics of the stage consuming a full queue, in microseconds.
+     *   Accumulated by the consumer threads in eb_get_full_object and
+     *   eb_get_empty_object when the queue has stats_enabled set.
      *********************************************************************/
-    typedef struct EbCircularBuffer
+    typedef struct EbQueueStats
     {
-        EbDctor dctor;
-        EbPtr *array_ptr;
-        uint32_t  head_index;
-        uint32_t  tail_index;
-        uint32_t  buffer_total_count;
-        uint32_t  current_count;
-    } EbCircularBuffer;
+        volatile uint64_t  busy_time;
+        volatile uint64_t  input_wait_time;
+        volatile uint64_t  output_wait_time;
+        volatile uint64_t  object_count;
+    } EbQueueStats;
 
     /*********************************************************************
      * MuxingQueue
+     *   ready_count is the number of objects in the ring minus the number
+     *   of parked consumers. Consumers spin on it briefly and only fall
+     *   back to counting_semaphore when it stays empty.
      *********************************************************************/
     typedef struct EbMuxingQueue
     {
         EbDctor            dctor;
-        EbHandle           lockout_mutex;
-        EbCircularBuffer *object_queue;
-        EbCircularBuffer *process_queue;
-        uint32_t              process_total_count;
-        EbFifo          **process_fifo_ptr_array;
+        EbObjectRing      *object_ring;
+        volatile uint32_t  ready_count;
+        EbHandle           counting_semaphore;
+        uint32_t           process_total_count;
+        EbFifo           **process_fifo_ptr_array;
+
+        // scheduler_ptr - set when the queue feeds a stage served by a
+        //   task scheduler instead of dedicated threads.
+        struct EbTaskScheduler *scheduler_ptr;
+        EbQueueStats       stats;
+        EbBool             stats_enabled;
+        // Trace receiving a span per object taken from the queue, and the
+        // span name (the consuming stage)
+        struct EbTrace    *trace_ptr;
+        const char        *trace_name;
+        // resource_ptr - set on the empty queue of an elastic
+        //   SystemResource, which constructs an object instead of
+        //   blocking when the queue is empty.
+        struct EbSystemResource *resource_ptr;
     } EbMuxingQueue;
 
     /*********************************************************************
@@ -115,13 +162,34 @@ extern "C" {
      *   only used to construct and destruct the SystemResource.  The
      *   fullFifo provides downstream pipeline data flow control.  The
      *   emptyFifo provides upstream pipeline backpressure flow control.
+     *
+     *   An elastic SystemResource starts with object_init_count objects and
+     *   constructs more on demand, up to object_limit_count, when a producer
+     *   finds the empty queue empty. Once the empty queue has not run out for
+     *   EB_ELASTIC_IDLE_TIME, released objects above object_init_count are
+     *   destroyed instead of being queued.
      *********************************************************************/
     typedef struct EbSystemResource
     {
         EbDctor               dctor;
         // object_total_count - A count of the number of objects contained in the
         //   System Resoruce.
-        uint32_t              object_total_count;
+        volatile uint32_t     object_total_count;
+
+        // object_max_count - Capacity of the System Resource, the size of
+        //   wrapper_ptr_pool and of the queues.
+        uint32_t              object_max_count;
+
+        // object_init_count - Objects constructed up front and never
+        //   destroyed before the System Resource.
+        uint32_t              object_init_count;
+
+        // object_limit_count - Objects the System Resource may grow to,
+        //   at most object_max_count.
+        uint32_t              object_limit_count;
+
+        // object_size - Bytes allocated to construct one object.
+        uint64_t              object_size;
 
         // wrapper_ptr_pool - An array of pointers to the EbObjectWrappers used
         //   to construct and destruct the SystemResource.
@@ -132,6 +200,22 @@ extern "C" {
 
         // The full FIFO contains a queue of completed buffers
         EbMuxingQueue     *full_queue;
+
+        // Object construction on demand, elastic System Resources only
+        EbCreator          object_creator;
+        EbPtr              object_init_data_ptr;
+        size_t             object_init_data_size;
+        EbDctor            object_destroyer;
+        EbHandle           pool_mutex;
+        // Last time a producer found the empty queue empty
+        volatile uint64_t  empty_time;
+
+        // Arena the picture planes of the objects are carved from, NULL for the heap
+        EbArena           *arena_ptr;
+
+        // Optional, see eb_system_resource_set_release_callback
+        EbObjectReleaseCallback object_release_callback;
+        EbPtr              object_release_context;
     } EbSystemResource;
 
     /*********************************************************************
@@ -140,11 +224,6 @@ extern "C" {
      *   certain objects (e.g. SequenceControlSet) to control whether
      *   EbObjectWrappers are allowed to be released or not.
      *
-     *   resource_ptr
-     *      pointer to the SystemResource that manages the EbObjectWrapper.
-     *      The emptyFifo's lockout_mutex is used to write protect the
-     *      modification of the EbObjectWrapper.
-     *
      *   wrapper_ptr
      *      pointer to the EbObjectWrapper to be modified.
      *********************************************************************/
@@ -157,11 +236,6 @@ extern "C" {
      *   certain objects (e.g. SequenceControlSet) to control whether
      *   EbObjectWrappers are allowed to be released or not.
      *
-     *   resource_ptr
-     *      pointer to the SystemResource that manages the EbObjectWrapper.
-     *      The emptyFifo's lockout_mutex is used to write protect the
-     *      modification of the EbObjectWrapper.
-     *
      *   wrapper_ptr
      *      pointer to the EbObjectWrapper to be modified.
      *********************************************************************/
@@ -174,11 +248,6 @@ extern "C" {
      *   certain objects (e.g. SequenceControlSet) to count the number of active
      *   pointers of a EbObjectWrapper in pipeline at any point in time.
      *
-     *   resource_ptr
-     *      pointer to the SystemResource that manages the EbObjectWrapper.
-     *      The emptyFifo's lockout_mutex is used to write protect the
-     *      modification of the EbObjectWrapper.
-     *
      *   wrapper_ptr
      *      pointer to the EbObjectWrapper to be modified.
      *
@@ -228,13 +297,65 @@ extern "C" {
         EbPtr               object_init_data_ptr,
         EbDctor             object_destroyer);
 
+    /*********************************************************************
+     * eb_system_resource_elastic_ctor
+     *   Same as eb_system_resource_ctor, but only object_init_count of
+     *   the object_max_count objects are constructed up front. The
+     *   object_init_data_ptr block (object_init_data_size bytes) is
+     *   copied so that later objects are constructed with the same data;
+     *   with a size of 0 the pointer itself is kept.
+     *********************************************************************/
+    extern EbErrorType eb_system_resource_elastic_ctor(
+        EbSystemResource  *resource_ptr,
+        uint32_t            object_init_count,
+        uint32_t            object_max_count,
+        uint32_t            producer_process_total_count,
+        uint32_t            consumer_process_total_count,
+        EbFifo         ***producer_fifo_ptr_array_ptr,
+        EbFifo         ***consumer_fifo_ptr_array_ptr,
+        EbBool              full_fifo_enabled,
+        EbCreator             object_ctor,
+        EbPtr               object_init_data_ptr,
+        size_t              object_init_data_size,
+        EbDctor             object_destroyer);
+
+    /*********************************************************************
+     * eb_system_resource_set_limit
+     *   Sets the number of objects an elastic SystemResource may grow
+     *   to, clipped to [object_init_count, object_max_count].
+     *********************************************************************/
+    extern void eb_system_resource_set_limit(
+        EbSystemResource  *resource_ptr,
+        uint32_t            object_limit_count);
+
+    /*********************************************************************
+     * eb_system_resource_set_release_callback
+     *   Sets a callback run once per use of an object, when its last
+     *   holder releases it and before it can be handed out again.
+     *********************************************************************/
+    extern void eb_system_resource_set_release_callback(
+        EbSystemResource       *resource_ptr,
+        EbObjectReleaseCallback release_callback,
+        EbPtr                   context_ptr);
+
+    /*********************************************************************
+     * eb_system_resource_reserve
+     *   Constructs objects on the calling thread until the elastic
+     *   SystemResource holds object_count of them (at most its limit),
+     *   and keeps them for the lifetime of the SystemResource.
+     *********************************************************************/
+    extern EbErrorType eb_system_resource_reserve(
+        EbSystemResource  *resource_ptr,
+        uint32_t            object_count);
+
     /*********************************************************************
      * EbSystemResourceGetEmptyObject
      *   Dequeues an empty EbObjectWrapper from the SystemResource.  The
      *   new EbObjectWrapper will be populated with the contents of the
-     *   wrapperCopyPtr if wrapperCopyPtr is not NULL. This function blocks
-     *   on the SystemResource emptyFifo counting_semaphore. This function
-     *   is write protected by the SystemResource emptyFifo lockout_mutex.
+     *   wrapperCopyPtr if wrapperCopyPtr is not NULL. This function spins
+     *   briefly and then blocks on the SystemResource emptyFifo
+     *   counting_semaphore. An elastic SystemResource below its limit
+     *   constructs a new object instead.
      *
      *   resource_ptr
      *      pointer to the SystemResource that provides the empty
@@ -251,9 +372,8 @@ extern "C" {
     /*********************************************************************
      * EbSystemResourcePostObject
      *   Queues a full EbObjectWrapper to the SystemResource. This
-     *   function posts the SystemResource fullFifo counting_semaphore.
-     *   This function is write protected by the SystemResource fullFifo
-     *   lockout_mutex.
+     *   function wakes a consumer parked on the SystemResource fullFifo
+     *   counting_semaphore.
      *
      *   resource_ptr
      *      pointer to the SystemResource that the EbObjectWrapper is
@@ -268,9 +388,8 @@ extern "C" {
     /*********************************************************************
      * EbSystemResourceGetFullObject
      *   Dequeues an full EbObjectWrapper from the SystemResource. This
-     *   function blocks on the SystemResource fullFifo counting_semaphore.
-     *   This function is write protected by the SystemResource fullFifo
-     *   lockout_mutex.
+     *   function spins briefly and then blocks on the SystemResource
+     *   fullFifo counting_semaphore.
      *
      *   resource_ptr
      *      pointer to the SystemResource that provides the full
@@ -284,16 +403,42 @@ extern "C" {
         EbFifo           *full_fifo_ptr,
         EbObjectWrapper **wrapper_dbl_ptr);
 
+    /*********************************************************************
+     * eb_get_full_object_non_blocking
+     *   Same as eb_get_full_object but returns a NULL wrapper immediately
+     *   when no full object is available.
+     *********************************************************************/
     extern EbErrorType eb_get_full_object_non_blocking(
         EbFifo           *full_fifo_ptr,
         EbObjectWrapper **wrapper_dbl_ptr);
 
+    /*********************************************************************
+     * eb_get_full_object_timeout
+     *   Same as eb_get_full_object but gives up after timeout milliseconds
+     *   with EB_NoErrorEmptyQueue and a NULL wrapper.
+     *********************************************************************/
+    extern EbErrorType eb_get_full_object_timeout(
+        EbFifo           *full_fifo_ptr,
+        EbObjectWrapper **wrapper_dbl_ptr,
+        uint32_t          timeout);
+
+    /*********************************************************************
+     * eb_object_stats_start / eb_object_stats_finish
+     *   Bracket the processing of an object taken without
+     *   eb_get_full_object, so that the time is charged to the stage of
+     *   full_fifo_ptr. eb_get_full_object does this implicitly: a thread
+     *   works on an object until it asks for the next one.
+     *********************************************************************/
+    extern void eb_object_stats_start(
+        EbFifo           *full_fifo_ptr);
+
+    extern void eb_object_stats_finish(void);
+
     /*********************************************************************
      * EbSystemResourceReleaseObject
      *   Queues an empty EbObjectWrapper to the SystemResource. This
-     *   function posts the SystemResource emptyFifo counting_semaphore.
-     *   This function is write protected by the SystemResource emptyFifo
-     *   lockout_mutex.
+     *   function wakes a producer parked on the SystemResource emptyFifo
+     *   counting_semaphore.
      *
      *   object_ptr
      *      pointer to EbObjectWrapper to be released.
@@ -0,0 +1,446 @@
+/*
+* Copyright(c) 2019 Intel Corporation
+* SPDX - License - Identifier: BSD - 2 - Clause - Patent
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "EbTaskScheduler.h"
+#include "EbUtility.h"
+#include "EbTime.h"
+
+// Posts never exceed the number of parked threads
+#define SEMAPHORE_MAX_COUNT             0x7FFFFFFF
+
+// Fixed point scale of the run time charged to a channel
+#define VIRTUAL_TIME_SHIFT              8
+
+// Scheduler served by the calling thread, NULL outside worker threads
+static EB_THREAD_LOCAL EbTaskScheduler *current_scheduler_ptr = NULL;
+
+static INLINE EbTaskChannel *eb_task_scheduler_get_channel(
+    EbTaskScheduler *scheduler_ptr,
+    uint32_t         channelIndex)
+{
+    return (EbTaskChannel*)eb_atomic_load_ptr((void *volatile *)&scheduler_ptr->channel_array[channelIndex]);
+}
+
+static INLINE void eb_task_scheduler_set_channel(
+    EbTaskScheduler *scheduler_ptr,
+    uint32_t         channelIndex,
+    EbTaskChannel   *channel_ptr)
+{
+    eb_atomic_store_ptr((void *volatile *)&scheduler_ptr->channel_array[channelIndex], channel_ptr);
+}
+
+static void eb_task_scheduler_dctor(EbPtr p)
+{
+    EbTaskScheduler *obj = (EbTaskScheduler*)p;
+    uint32_t threadIndex;
+
+    // No compensation thread may be started once the teardown begins
+    if (obj->thread_mutex) {
+        eb_block_on_mutex(obj->thread_mutex);
+        obj->thread_max_count = 0;
+        eb_release_mutex(obj->thread_mutex);
+    }
+    if (obj->thread_handle_array) {
+        for (threadIndex = 0; threadIndex < obj->thread_total_count; ++threadIndex)
+            EB_DESTROY_THREAD(obj->thread_handle_array[threadIndex]);
+        EB_FREE_ARRAY(obj->thread_handle_array);
+    }
+
+    EB_DESTROY_SEMAPHORE(obj->spare_semaphore);
+    EB_DESTROY_SEMAPHORE(obj->work_semaphore);
+    EB_DESTROY_MUTEX(obj->thread_mutex);
+}
+
+/**************************************
+ * eb_task_scheduler_ctor
+ **************************************/
+EbErrorType eb_task_scheduler_ctor(
+    EbTaskScheduler *scheduler_ptr,
+    uint32_t         worker_total_count)
+{
+    scheduler_ptr->dctor = eb_task_scheduler_dctor;
+
+    scheduler_ptr->worker_total_count = worker_total_count;
+    scheduler_ptr->thread_max_count = worker_total_count;
+
+    // The first worker_total_count slots are filled in by the owner
+    EB_CALLOC_ARRAY(scheduler_ptr->thread_handle_array, scheduler_ptr->thread_max_count);
+    scheduler_ptr->thread_total_count = worker_total_count;
+    scheduler_ptr->active_count = worker_total_count;
+
+    EB_CREATE_MUTEX(scheduler_ptr->thread_mutex);
+    EB_CREATE_SEMAPHORE(scheduler_ptr->work_semaphore, 0, SEMAPHORE_MAX_COUNT);
+    EB_CREATE_SEMAPHORE(scheduler_ptr->spare_semaphore, 0, SEMAPHORE_MAX_COUNT);
+
+    return EB_ErrorNone;
+}
+
+static void eb_task_channel_dctor(EbPtr p)
+{
+    EbTaskChannel *obj = (EbTaskChannel*)p;
+    uint32_t stageIndex;
+
+    for (stageIndex = 0; stageIndex < obj->stage_total_count; ++stageIndex)
+        EB_FREE_ARRAY(obj->stage_array[stageIndex].context_busy_array);
+}
+
+/**************************************
+ * eb_task_channel_ctor
+ **************************************/
+EbErrorType eb_task_channel_ctor(
+    EbTaskChannel   *channel_ptr,
+    uint32_t         channel_id,
+    uint32_t         active_channel_count)
+{
+    channel_ptr->dctor = eb_task_channel_dctor;
+    channel_ptr->channel_id = channel_id;
+    // No more channels than that can be attached, which also keeps the
+    // scaled run time far from overflowing virtual_time
+    channel_ptr->active_channel_count = CLIP3(1, EB_TASK_CHANNEL_MAX_COUNT, active_channel_count);
+
+    return EB_ErrorNone;
+}
+
+/**************************************
+ * eb_task_channel_add_stage
+ **************************************/
+EbErrorType eb_task_channel_add_stage(
+    EbTaskChannel   *channel_ptr,
+    EbFifo          *input_fifo_ptr,
+    EbTaskFunction   task_function,
+    void           **context_ptr_array,
+    uint32_t         context_total_count)
+{
+    EbTaskStage *stage_ptr;
+
+    if (channel_ptr->stage_total_count == EB_TASK_STAGE_MAX_COUNT)
+        return EB_ErrorInsufficientResources;
+
+    stage_ptr = &channel_ptr->stage_array[channel_ptr->stage_total_count];
+    stage_ptr->input_fifo_ptr = input_fifo_ptr;
+    stage_ptr->task_function = task_function;
+    stage_ptr->context_ptr_array = context_ptr_array;
+    stage_ptr->context_total_count = context_total_count;
+    EB_CALLOC_ARRAY(stage_ptr->context_busy_array, context_total_count);
+
+    ++channel_ptr->stage_total_count;
+    channel_ptr->context_total_count += context_total_count;
+
+    return EB_ErrorNone;
+}
+
+/**************************************
+ * eb_task_scheduler_attach_channel
+ **************************************/
+EbErrorType eb_task_scheduler_attach_channel(
+    EbTaskScheduler *scheduler_ptr,
+    EbTaskChannel   *channel_ptr)
+{
+    EbErrorType return_error = EB_ErrorInsufficientResources;
+    uint32_t    channelIndex;
+    uint32_t    stageIndex;
+
+    eb_block_on_mutex(scheduler_ptr->thread_mutex);
+    for (channelIndex = 0; channelIndex < EB_TASK_CHANNEL_MAX_COUNT; ++channelIndex) {
+        if (eb_task_scheduler_get_channel(scheduler_ptr, channelIndex) == NULL)
+            break;
+    }
+    if (channelIndex < EB_TASK_CHANNEL_MAX_COUNT) {
+        // A worker blocked inside a task holds a context, so the channel
+        // contexts bound the compensation threads it can need.
+        const uint32_t thread_max_count = scheduler_ptr->thread_max_count + channel_ptr->context_total_count;
+        EbHandle      *thread_handle_array;
+
+        EB_NO_THROW_CALLOC(thread_handle_array, thread_max_count, sizeof(EbHandle));
+        if (thread_handle_array) {
+            memcpy(thread_handle_array, scheduler_ptr->thread_handle_array, scheduler_ptr->thread_total_count * sizeof(EbHandle));
+            EB_FREE_ARRAY(scheduler_ptr->thread_handle_array);
+            scheduler_ptr->thread_handle_array = thread_handle_array;
+            scheduler_ptr->thread_max_count = thread_max_count;
+
+            // Posts to the stage inputs now wake the scheduler workers
+            for (stageIndex = 0; stageIndex < channel_ptr->stage_total_count; ++stageIndex)
+                channel_ptr->stage_array[stageIndex].input_fifo_ptr->queue_ptr->scheduler_ptr = scheduler_ptr;
+
+            // The release store publishes the channel state set above
+            eb_atomic_store_u64(&channel_ptr->virtual_time, eb_atomic_load_u64(&scheduler_ptr->virtual_time_floor));
+            eb_task_scheduler_set_channel(scheduler_ptr, channelIndex, channel_ptr);
+            return_error = EB_ErrorNone;
+        }
+    }
+    eb_release_mutex(scheduler_ptr->thread_mutex);
+
+    return return_error;
+}
+
+/**************************************
+ * eb_task_scheduler_detach_channel
+ **************************************/
+void eb_task_scheduler_detach_channel(
+    EbTaskScheduler *scheduler_ptr,
+    EbTaskChannel   *channel_ptr)
+{
+    uint32_t channelIndex;
+
+    eb_block_on_mutex(scheduler_ptr->thread_mutex);
+    for (channelIndex = 0; channelIndex < EB_TASK_CHANNEL_MAX_COUNT; ++channelIndex) {
+        if (eb_task_scheduler_get_channel(scheduler_ptr, channelIndex) == channel_ptr) {
+            eb_task_scheduler_set_channel(scheduler_ptr, channelIndex, NULL);
+            // Threads already started stay in the pool
+            scheduler_ptr->thread_max_count = MAX(scheduler_ptr->thread_max_count - channel_ptr->context_total_count,
+                scheduler_ptr->thread_total_count);
+            break;
+        }
+    }
+    eb_release_mutex(scheduler_ptr->thread_mutex);
+    eb_atomic_fence();
+
+    // Workers re-check the slot after taking a reference, so only those
+    // that already hold one need to be waited for.
+    while (eb_atomic_load_u32(&channel_ptr->ref_count))
+        eb_cpu_pause();
+}
+
+/**************************************
+ * eb_task_scheduler_notify
+ **************************************/
+void eb_task_scheduler_notify(
+    EbTaskScheduler *scheduler_ptr)
+{
+    // Wake one idle worker if pending_count was negative
+    if ((int32_t)eb_atomic_add_u32(&scheduler_ptr->pending_count, 1) <= 0)
+        eb_post_semaphore(scheduler_ptr->work_semaphore);
+}
+
+/**************************************
+ * eb_task_scheduler_enter_wait
+ *   The calling worker is about to block inside a task. Hand its slot
+ *   to a parked spare, or start a new one if none is parked.
+ **************************************/
+void eb_task_scheduler_enter_wait(void)
+{
+    EbTaskScheduler *scheduler_ptr = current_scheduler_ptr;
+    uint32_t spareCount;
+
+    if (scheduler_ptr == NULL)
+        return;
+
+    if ((int32_t)eb_atomic_add_u32(&scheduler_ptr->active_count, (uint32_t)-1) >=
+        (int32_t)scheduler_ptr->worker_total_count)
+        return;
+
+    spareCount = eb_atomic_load_u32(&scheduler_ptr->spare_count);
+    while ((int32_t)spareCount > 0) {
+        const uint32_t prev = eb_atomic_cas_u32(&scheduler_ptr->spare_count, spareCount, spareCount - 1);
+        if (prev == spareCount) {
+            eb_atomic_add_u32(&scheduler_ptr->active_count, 1);
+            eb_post_semaphore(scheduler_ptr->spare_semaphore);
+            return;
+        }
+        spareCount = prev;
+    }
+
+    // Compensation threads are created from a worker so they inherit its
+    // affinity where the OS supports it.
+    eb_block_on_mutex(scheduler_ptr->thread_mutex);
+    if (scheduler_ptr->thread_total_count < scheduler_ptr->thread_max_count) {
+        EbHandle thread_handle = eb_create_thread(eb_task_scheduler_kernel, scheduler_ptr);
+        if (thread_handle) {
+            EB_NO_THROW_ADD_MEM(thread_handle, 1, EB_THREAD);
+            eb_atomic_add_u32(&scheduler_ptr->active_count, 1);
+            scheduler_ptr->thread_handle_array[scheduler_ptr->thread_total_count] = thread_handle;
+            eb_atomic_add_u32(&scheduler_ptr->thread_total_count, 1);
+        }
+    }
+    eb_release_mutex(scheduler_ptr->thread_mutex);
+}
+
+/**************************************
+ * eb_task_scheduler_leave_wait
+ **************************************/
+void eb_task_scheduler_leave_wait(void)
+{
+    EbTaskScheduler *scheduler_ptr = current_scheduler_ptr;
+
+    // A surplus worker parks itself before picking the next task
+    if (scheduler_ptr)
+        eb_atomic_add_u32(&scheduler_ptr->active_count, 1);
+}
+
+/**************************************
+ * eb_task_scheduler_retire
+ *   Parks the calling worker as a spare while more than
+ *   worker_total_count workers are active.
+ **************************************/
+static EbBool eb_task_scheduler_retire(
+    EbTaskScheduler *scheduler_ptr)
+{
+    uint32_t activeCount = eb_atomic_load_u32(&scheduler_ptr->active_count);
+
+    while ((int32_t)activeCount > (int32_t)scheduler_ptr->worker_total_count) {
+        const uint32_t prev = eb_atomic_cas_u32(&scheduler_ptr->active_count, activeCount, activeCount - 1);
+        if (prev == activeCount) {
+            // Tasks skipped while this worker held their stage context are
+            // still queued, have an active worker look at them again
+            eb_task_scheduler_notify(scheduler_ptr);
+            eb_atomic_add_u32(&scheduler_ptr->spare_count, 1);
+            eb_block_on_semaphore(scheduler_ptr->spare_semaphore);
+            return EB_TRUE;
+        }
+        activeCount = prev;
+    }
+    return EB_FALSE;
+}
+
+/**************************************
+ * eb_task_channel_is_ready
+ **************************************/
+static EbBool eb_task_channel_is_ready(
+    EbTaskChannel   *channel_ptr)
+{
+    uint32_t stageIndex;
+
+    for (stageIndex = 0; stageIndex < channel_ptr->stage_total_count; ++stageIndex) {
+        if ((int32_t)eb_atomic_load_u32(&channel_ptr->stage_array[stageIndex].input_fifo_ptr->queue_ptr->ready_count) > 0)
+            return EB_TRUE;
+    }
+    return EB_FALSE;
+}
+
+/**************************************
+ * eb_task_channel_run_task
+ *   Runs one task from the most downstream stage that has both an input
+ *   object and a free context. Finishing pictures first returns their
+ *   buffers to the upstream stages soonest.
+ **************************************/
+static EbBool eb_task_channel_run_task(
+    EbTaskChannel   *channel_ptr)
+{
+    uint32_t stageIndex = channel_ptr->stage_total_count;
+
+    while (stageIndex-- > 0) {
+        EbTaskStage     *stage_ptr = &channel_ptr->stage_array[stageIndex];
+        EbObjectWrapper *input_wrapper_ptr = NULL;
+        uint32_t         contextIndex;
+
+        if ((int32_t)eb_atomic_load_u32(&stage_ptr->input_fifo_ptr->queue_ptr->ready_count) <= 0)
+            continue;
+
+        for (contextIndex = 0; contextIndex < stage_ptr->context_total_count; ++contextIndex) {
+            if (eb_atomic_load_u32(&stage_ptr->context_busy_array[contextIndex]) == 0 &&
+                eb_atomic_cas_u32(&stage_ptr->context_busy_array[contextIndex], 0, 1) == 0)
+                break;
+        }
+        if (contextIndex == stage_ptr->context_total_count)
+            continue;
+
+        eb_get_full_object_non_blocking(stage_ptr->input_fifo_ptr, &input_wrapper_ptr);
+        if (input_wrapper_ptr) {
+            const uint64_t start_time = EbGetTimeUs();
+
+            eb_object_stats_start(stage_ptr->input_fifo_ptr);
+            stage_ptr->task_function(
+                stage_ptr->context_ptr_array[contextIndex],
+                input_wrapper_ptr);
+            eb_object_stats_finish();
+
+            eb_atomic_add_u64(&channel_ptr->virtual_time,
+                ((EbGetTimeUs() - start_time) << VIRTUAL_TIME_SHIFT) * channel_ptr->active_channel_count);
+        }
+        eb_atomic_store_u32(&stage_ptr->context_busy_array[contextIndex], 0);
+
+        if (input_wrapper_ptr)
+            return EB_TRUE;
+    }
+    return EB_FALSE;
+}
+
+/**************************************
+ * eb_task_scheduler_run_task
+ *   Collects the channels with input ready and tries them from the
+ *   lowest virtual time up.
+ **************************************/
+static EbBool eb_task_scheduler_run_task(
+    EbTaskScheduler *scheduler_ptr)
+{
+    EbTaskChannel *ready_channel_array[EB_TASK_CHANNEL_MAX_COUNT];
+    uint32_t       readyCount = 0;
+    uint32_t       channelIndex;
+    EbBool         task_done = EB_FALSE;
+
+    for (channelIndex = 0; channelIndex < EB_TASK_CHANNEL_MAX_COUNT; ++channelIndex) {
+        EbTaskChannel *channel_ptr = eb_task_scheduler_get_channel(scheduler_ptr, channelIndex);
+        if (channel_ptr == NULL)
+            continue;
+
+        // The reference keeps a detaching channel alive until released
+        eb_atomic_add_u32(&channel_ptr->ref_count, 1);
+        if (eb_task_scheduler_get_channel(scheduler_ptr, channelIndex) == channel_ptr &&
+            eb_task_channel_is_ready(channel_ptr))
+            ready_channel_array[readyCount++] = channel_ptr;
+        else
+            eb_atomic_add_u32(&channel_ptr->ref_count, (uint32_t)-1);
+    }
+
+    while (readyCount > 0) {
+        const uint64_t floor = eb_atomic_load_u64(&scheduler_ptr->virtual_time_floor);
+        uint32_t       bestIndex = 0;
+        uint64_t       bestTime = ~(uint64_t)0;
+        EbTaskChannel *channel_ptr;
+
+        for (channelIndex = 0; channelIndex < readyCount; ++channelIndex) {
+            const uint64_t virtual_time = eb_atomic_load_u64(&ready_channel_array[channelIndex]->virtual_time);
+            if (virtual_time < bestTime || (virtual_time == bestTime &&
+                ready_channel_array[channelIndex]->channel_id < ready_channel_array[bestIndex]->channel_id)) {
+                bestTime = virtual_time;
+                bestIndex = channelIndex;
+            }
+        }
+        channel_ptr = ready_channel_array[bestIndex];
+        ready_channel_array[bestIndex] = ready_channel_array[--readyCount];
+
+        // A channel coming back from idle restarts from the floor, otherwise
+        // the floor follows the lowest virtual time served
+        if (bestTime < floor)
+            eb_atomic_store_u64(&channel_ptr->virtual_time, floor);
+        else
+            eb_atomic_store_u64(&scheduler_ptr->virtual_time_floor, bestTime);
+
+        task_done = eb_task_channel_run_task(channel_ptr);
+        eb_atomic_add_u32(&channel_ptr->ref_count, (uint32_t)-1);
+
+        if (task_done) {
+            while (readyCount > 0)
+                eb_atomic_add_u32(&ready_channel_array[--readyCount]->ref_count, (uint32_t)-1);
+        }
+    }
+    return task_done;
+}
+
+/**************************************
+ * eb_task_scheduler_kernel
+ **************************************/
+void* eb_task_scheduler_kernel(void *input_ptr)
+{
+    EbTaskScheduler *scheduler_ptr = (EbTaskScheduler*)input_ptr;
+
+    current_scheduler_ptr = scheduler_ptr;
+
+    for (;;) {
+        if (eb_task_scheduler_retire(scheduler_ptr))
+            continue;
+
+        if (eb_task_scheduler_run_task(scheduler_ptr))
+            continue;
+
+        // Nothing runnable; park unless a post raced with the scan
+        if ((int32_t)eb_atomic_add_u32(&scheduler_ptr->pending_count, (uint32_t)-1) < 0)
+            eb_block_on_semaphore(scheduler_ptr->work_semaphore);
+    }
+    return EB_NULL;
+}
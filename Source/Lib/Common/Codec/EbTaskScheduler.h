@@ -0,0 +1,202 @@
+/*
+* Copyright(c) 2019 Intel Corporation
+* SPDX - License - Identifier: BSD - 2 - Clause - Patent
+*/
+
+#ifndef EbTaskScheduler_h
+#define EbTaskScheduler_h
+
+#include "EbDefinitions.h"
+#include "EbThreads.h"
+#include "EbSystemResourceManager.h"
+#include "EbObject.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+    /*********************************
+     * Defines
+     *********************************/
+#define EB_TASK_STAGE_MAX_COUNT         16
+#define EB_TASK_CHANNEL_MAX_COUNT       64
+
+    /*********************************************************************
+     * Task Function
+     *   Processes one input object of a pipeline stage using the given
+     *   stage context. The task owns input_wrapper_ptr and must release it.
+     *********************************************************************/
+    typedef void(*EbTaskFunction)(
+        void            *context_ptr,
+        EbObjectWrapper *input_wrapper_ptr);
+
+    /*********************************************************************
+     * Task Stage
+     *   A pipeline stage served by the scheduler. Each context can run
+     *   one task at a time; context_busy_array tracks which ones are
+     *   claimed by a worker.
+     *********************************************************************/
+    typedef struct EbTaskStage
+    {
+        EbFifo             *input_fifo_ptr;
+        EbTaskFunction      task_function;
+        void              **context_ptr_array;
+        uint32_t           *context_busy_array;
+        uint32_t            context_total_count;
+    } EbTaskStage;
+
+    /*********************************************************************
+     * Task Channel
+     *   The stages of one encoder instance. A channel belongs to a group
+     *   of active_channel_count channels and claims 1 / active_channel_count
+     *   of the scheduler: the run time of every task is charged to
+     *   virtual_time scaled by active_channel_count, and workers pick the
+     *   ready channel with the lowest virtual_time, the lowest channel_id
+     *   on a tie. The channels of one group share equally, and a group
+     *   shares equally with a channel running alone.
+     *********************************************************************/
+    typedef struct EbTaskChannel
+    {
+        EbDctor             dctor;
+        EbTaskStage         stage_array[EB_TASK_STAGE_MAX_COUNT];
+        uint32_t            stage_total_count;
+        uint32_t            context_total_count;
+        uint32_t            channel_id;
+        uint32_t            active_channel_count;
+
+        volatile uint64_t   virtual_time;
+
+        // ref_count - number of workers currently looking at or running
+        //   a task of the channel.
+        volatile uint32_t   ref_count;
+    } EbTaskChannel;
+
+    /*********************************************************************
+     * Task Scheduler
+     *   One pool of worker threads shared by the stages of one or more
+     *   channels. Every push to a stage input queue wakes an idle worker,
+     *   and any worker can take a task from any stage, so the whole pool
+     *   follows the stage that currently has work instead of each stage
+     *   sleeping on its own thread array.
+     *
+     *   A worker blocked inside a task (e.g. waiting for an empty output
+     *   object) gives its slot to a compensation thread so that
+     *   worker_total_count workers keep making progress.
+     *********************************************************************/
+    typedef struct EbTaskScheduler
+    {
+        EbDctor             dctor;
+
+        // worker_total_count - number of threads allowed to run tasks
+        //   at the same time, normally one per logical processor.
+        uint32_t            worker_total_count;
+
+        // thread_max_count - upper bound on workers plus compensation
+        //   threads, grows with the contexts of the attached channels.
+        uint32_t            thread_max_count;
+        volatile uint32_t   thread_total_count;
+        EbHandle           *thread_handle_array;
+        EbHandle            thread_mutex;
+
+        // channel_array - published with a release store once the channel
+        //   is fully registered, read with acquire loads by the workers.
+        EbTaskChannel      *volatile channel_array[EB_TASK_CHANNEL_MAX_COUNT];
+
+        // virtual_time_floor - lowest virtual_time of the channels served.
+        //   A channel coming back from idle is not allowed to lag behind
+        //   it, so it can not monopolize the pool to catch up.
+        volatile uint64_t   virtual_time_floor;
+
+        // pending_count - number of unclaimed wake-ups minus the number
+        //   of idle workers parked on work_semaphore.
+        volatile uint32_t   pending_count;
+        EbHandle            work_semaphore;
+
+        // active_count - threads that are neither blocked inside a task
+        //   nor parked as spare. Spares park on spare_semaphore.
+        volatile uint32_t   active_count;
+        volatile uint32_t   spare_count;
+        EbHandle            spare_semaphore;
+    } EbTaskScheduler;
+
+    /*********************************************************************
+     * eb_task_scheduler_ctor
+     *   Constructs the scheduler. No threads are started; the owner
+     *   creates the first worker_total_count threads in
+     *   thread_handle_array with eb_task_scheduler_kernel.
+     *********************************************************************/
+    extern EbErrorType eb_task_scheduler_ctor(
+        EbTaskScheduler *scheduler_ptr,
+        uint32_t         worker_total_count);
+
+    /*********************************************************************
+     * eb_task_channel_ctor
+     *   channel_id, active_channel_count
+     *      the channel hints of the encoder configuration, they set the
+     *      share of the scheduler given to the channel when several
+     *      channels have work ready.
+     *********************************************************************/
+    extern EbErrorType eb_task_channel_ctor(
+        EbTaskChannel   *channel_ptr,
+        uint32_t         channel_id,
+        uint32_t         active_channel_count);
+
+    /*********************************************************************
+     * eb_task_channel_add_stage
+     *   Registers a stage. Stages must be added in pipeline order; idle
+     *   workers look at the most downstream stage first.
+     *
+     *   input_fifo_ptr
+     *      any consumer fifo of the stage input queue.
+     *
+     *   context_ptr_array
+     *      the stage contexts, one task may run on each at a time.
+     *********************************************************************/
+    extern EbErrorType eb_task_channel_add_stage(
+        EbTaskChannel   *channel_ptr,
+        EbFifo          *input_fifo_ptr,
+        EbTaskFunction   task_function,
+        void           **context_ptr_array,
+        uint32_t         context_total_count);
+
+    /*********************************************************************
+     * eb_task_scheduler_attach_channel
+     *   Makes a fully registered channel visible to the workers.
+     *********************************************************************/
+    extern EbErrorType eb_task_scheduler_attach_channel(
+        EbTaskScheduler *scheduler_ptr,
+        EbTaskChannel   *channel_ptr);
+
+    /*********************************************************************
+     * eb_task_scheduler_detach_channel
+     *   Stops serving the channel and waits for the tasks in flight to
+     *   finish. The channel pipeline must be drained, a task blocked on
+     *   one of its queues would never return.
+     *********************************************************************/
+    extern void eb_task_scheduler_detach_channel(
+        EbTaskScheduler *scheduler_ptr,
+        EbTaskChannel   *channel_ptr);
+
+    /*********************************************************************
+     * eb_task_scheduler_notify
+     *   Called when an object is posted to a registered stage queue.
+     *********************************************************************/
+    extern void eb_task_scheduler_notify(
+        EbTaskScheduler *scheduler_ptr);
+
+    /*********************************************************************
+     * eb_task_scheduler_enter_wait / eb_task_scheduler_leave_wait
+     *   Bracket a blocking wait. No-ops unless called from a worker.
+     *********************************************************************/
+    extern void eb_task_scheduler_enter_wait(void);
+
+    extern void eb_task_scheduler_leave_wait(void);
+
+    /*********************************************************************
+     * eb_task_scheduler_kernel
+     *   Worker thread entry point, input_ptr is the EbTaskScheduler.
+     *********************************************************************/
+    extern void* eb_task_scheduler_kernel(void *input_ptr);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbTaskScheduler_h
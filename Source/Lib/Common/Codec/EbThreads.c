@@ -25,6 +25,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <pthread.h>
+#include <sched.h>
 #include <semaphore.h>
 #include <time.h>
 #include <unistd.h>
@@ -171,6 +172,18 @@ EbErrorType eb_destroy_thread(
 
     return error_return;
 }
+
+/****************************************
+ * eb_yield_thread
+ ****************************************/
+void eb_yield_thread(void)
+{
+#ifdef _WIN32
+    SwitchToThread();
+#elif defined(__linux__) || defined(__APPLE__)
+    sched_yield();
+#endif // _WIN32
+}
 #if defined(__APPLE__)
 static int32_t semaphore_id(void)
 {
@@ -258,6 +271,59 @@ EbErrorType eb_block_on_semaphore(
     return return_error;
 }
 
+/***************************************
+ * eb_block_on_semaphore_timeout
+ *   Returns EB_NoErrorEmptyQueue when the semaphore was not posted within
+ *   timeout milliseconds. Apple has no sem_timedwait, it polls instead.
+ ***************************************/
+EbErrorType eb_block_on_semaphore_timeout(
+    EbHandle semaphore_handle,
+    uint32_t timeout)
+{
+    EbErrorType return_error = EB_ErrorNone;
+
+#ifdef _WIN32
+    switch (WaitForSingleObject((HANDLE)semaphore_handle, timeout)) {
+    case WAIT_OBJECT_0: return_error = EB_ErrorNone; break;
+    case WAIT_TIMEOUT:  return_error = EB_NoErrorEmptyQueue; break;
+    default:            return_error = EB_ErrorSemaphoreUnresponsive; break;
+    }
+#elif defined(__linux__)
+    struct timespec deadline;
+    int             ret;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout / 1000;
+    deadline.tv_nsec += (long)(timeout % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    do
+        ret = sem_timedwait((sem_t*)semaphore_handle, &deadline);
+    while (ret && errno == EINTR);
+    if (ret)
+        return_error = errno == ETIMEDOUT ? EB_NoErrorEmptyQueue : EB_ErrorSemaphoreUnresponsive;
+#elif defined(__APPLE__)
+    uint32_t elapsed = 0;
+
+    while (sem_trywait((sem_t*)semaphore_handle)) {
+        if (errno != EAGAIN && errno != EINTR) {
+            return_error = EB_ErrorSemaphoreUnresponsive;
+            break;
+        }
+        if (elapsed >= timeout) {
+            return_error = EB_NoErrorEmptyQueue;
+            break;
+        }
+        usleep(1000);
+        elapsed++;
+    }
+#endif // _WIN32
+
+    return return_error;
+}
+
 /***************************************
  * eb_destroy_semaphore
  ***************************************/
@@ -10,6 +10,9 @@
 
 #ifdef _WIN32
 #include <Windows.h>
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <emmintrin.h>
 #endif
 
 #ifdef __cplusplus
@@ -35,6 +38,9 @@ extern "C" {
     extern EbErrorType eb_destroy_thread(
         EbHandle thread_handle);
 
+    // Gives the rest of the time slice of the calling thread to another one
+    extern void eb_yield_thread(void);
+
     /**************************************
      * Semaphores
      **************************************/
@@ -48,6 +54,11 @@ extern "C" {
     extern EbErrorType eb_block_on_semaphore(
         EbHandle semaphore_handle);
 
+    // EB_NoErrorEmptyQueue when not posted within timeout milliseconds
+    extern EbErrorType eb_block_on_semaphore_timeout(
+        EbHandle semaphore_handle,
+        uint32_t timeout);
+
     extern EbErrorType eb_destroy_semaphore(
         EbHandle semaphore_handle);
 
@@ -70,6 +81,96 @@ extern "C" {
     extern EbErrorType eb_destroy_mutex(
         EbHandle mutex_handle);
 
+    /**************************************
+     * Atomics
+     *   Sequentially consistent read-modify-write helpers used by the
+     *   lock-free system resource queues. Loads have acquire and stores
+     *   have release semantics.
+     **************************************/
+#ifdef _WIN32
+    static INLINE uint32_t eb_atomic_load_u32(volatile uint32_t *ptr) {
+        uint32_t value = *ptr;
+        _ReadWriteBarrier();
+        return value;
+    }
+    static INLINE void eb_atomic_store_u32(volatile uint32_t *ptr, uint32_t value) {
+        _ReadWriteBarrier();
+        *ptr = value;
+    }
+    // Returns the value of *ptr before the exchange
+    static INLINE uint32_t eb_atomic_cas_u32(volatile uint32_t *ptr, uint32_t expected, uint32_t desired) {
+        return (uint32_t)_InterlockedCompareExchange((volatile long*)ptr, (long)desired, (long)expected);
+    }
+    // Returns the value of *ptr after the addition
+    static INLINE uint32_t eb_atomic_add_u32(volatile uint32_t *ptr, uint32_t value) {
+        return (uint32_t)_InterlockedExchangeAdd((volatile long*)ptr, (long)value) + value;
+    }
+    static INLINE uint64_t eb_atomic_load_u64(volatile uint64_t *ptr) {
+        return (uint64_t)_InterlockedCompareExchange64((volatile __int64*)ptr, 0, 0);
+    }
+    static INLINE void eb_atomic_store_u64(volatile uint64_t *ptr, uint64_t value) {
+        _InterlockedExchange64((volatile __int64*)ptr, (__int64)value);
+    }
+    static INLINE uint64_t eb_atomic_add_u64(volatile uint64_t *ptr, uint64_t value) {
+        return (uint64_t)_InterlockedExchangeAdd64((volatile __int64*)ptr, (__int64)value) + value;
+    }
+    static INLINE void *eb_atomic_load_ptr(void *volatile *ptr) {
+        void *value = *ptr;
+        _ReadWriteBarrier();
+        return value;
+    }
+    static INLINE void eb_atomic_store_ptr(void *volatile *ptr, void *value) {
+        InterlockedExchangePointer(ptr, value);
+    }
+    static INLINE void eb_atomic_fence(void) { MemoryBarrier(); }
+    static INLINE void eb_cpu_pause(void) { YieldProcessor(); }
+#else
+    static INLINE uint32_t eb_atomic_load_u32(volatile uint32_t *ptr) {
+        return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+    }
+    static INLINE void eb_atomic_store_u32(volatile uint32_t *ptr, uint32_t value) {
+        __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+    }
+    // Returns the value of *ptr before the exchange
+    static INLINE uint32_t eb_atomic_cas_u32(volatile uint32_t *ptr, uint32_t expected, uint32_t desired) {
+        __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+        return expected;
+    }
+    // Returns the value of *ptr after the addition
+    static INLINE uint32_t eb_atomic_add_u32(volatile uint32_t *ptr, uint32_t value) {
+        return __atomic_add_fetch(ptr, value, __ATOMIC_SEQ_CST);
+    }
+    static INLINE uint64_t eb_atomic_load_u64(volatile uint64_t *ptr) {
+        return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+    }
+    static INLINE void eb_atomic_store_u64(volatile uint64_t *ptr, uint64_t value) {
+        __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+    }
+    static INLINE uint64_t eb_atomic_add_u64(volatile uint64_t *ptr, uint64_t value) {
+        return __atomic_add_fetch(ptr, value, __ATOMIC_SEQ_CST);
+    }
+    static INLINE void *eb_atomic_load_ptr(void *volatile *ptr) {
+        return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+    }
+    static INLINE void eb_atomic_store_ptr(void *volatile *ptr, void *value) {
+        __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+    }
+    static INLINE void eb_atomic_fence(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+#if defined(__x86_64__) || defined(__i386__)
+    static INLINE void eb_cpu_pause(void) { _mm_pause(); }
+#elif defined(__aarch64__) || defined(__arm__)
+    static INLINE void eb_cpu_pause(void) { __asm__ volatile("yield" ::: "memory"); }
+#else
+    static INLINE void eb_cpu_pause(void) { __asm__ volatile("" ::: "memory"); }
+#endif
+#endif
+
+#ifdef _WIN32
+#define EB_THREAD_LOCAL __declspec(thread)
+#else
+#define EB_THREAD_LOCAL __thread
+#endif
+
     extern    EbMemoryMapEntry *memory_map;                // library Memory table
     extern    uint32_t         *memory_map_index;          // library memory index
     extern    uint64_t         *total_lib_memory;          // library Memory malloc'd
@@ -93,8 +194,12 @@ extern "C" {
     } while (0)
 
 #elif defined(__linux__)
+#ifndef __USE_GNU
 #define __USE_GNU
+#endif
+#ifndef _GNU_SOURCE
 #define _GNU_SOURCE
+#endif
 #include <sched.h>
 #include <pthread.h>
 extern    cpu_set_t                   group_affinity;
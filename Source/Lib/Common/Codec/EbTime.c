@@ -110,6 +110,25 @@ void EbComputeOverallElapsedTimeMs(uint64_t Startseconds, uint64_t Startuseconds
 #endif
 }
 
+uint64_t EbGetTimeUs(void)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+#elif _WIN32
+    static LARGE_INTEGER    counterFreq;
+    LARGE_INTEGER           nowCount;
+    if (counterFreq.QuadPart == 0)
+        QueryPerformanceFrequency(&counterFreq);
+    QueryPerformanceCounter(&nowCount);
+    return (uint64_t)(nowCount.QuadPart / counterFreq.QuadPart) * 1000000 +
+        (uint64_t)(nowCount.QuadPart % counterFreq.QuadPart) * 1000000 / counterFreq.QuadPart;
+#else
+#error OS Not supported
+#endif
+}
+
 static void EbSleepMs(uint64_t milliSeconds)
 {
     if(milliSeconds) {
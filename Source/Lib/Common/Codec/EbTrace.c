@@ -0,0 +1,206 @@
+/*
+* Copyright(c) 2019 Intel Corporation
+* SPDX - License - Identifier: BSD - 2 - Clause - Patent
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "EbTrace.h"
+#include "EbUtility.h"
+#include "EbTime.h"
+
+// Trace thread ids are small integers, assigned on the first event of a thread
+static volatile uint32_t        trace_thread_count = 0;
+static EB_THREAD_LOCAL uint32_t trace_thread_index = 0;
+
+// Object span open on the calling thread
+static EB_THREAD_LOCAL EbTrace    *object_trace_ptr = NULL;
+static EB_THREAD_LOCAL const char *object_name = NULL;
+static EB_THREAD_LOCAL uint64_t    object_start_time = 0;
+static EB_THREAD_LOCAL uint64_t    object_picture_number = EB_TRACE_NO_PICTURE;
+static EB_THREAD_LOCAL int32_t     object_segment_index = EB_TRACE_NO_SEGMENT;
+
+static void eb_trace_dctor(EbPtr p)
+{
+    EbTrace *obj = (EbTrace*)p;
+    uint32_t blockIndex;
+
+    for (blockIndex = 0; blockIndex < EB_TRACE_BLOCK_MAX_COUNT; ++blockIndex)
+        EB_FREE_ARRAY(obj->block_array[blockIndex]);
+    EB_DESTROY_MUTEX(obj->block_mutex);
+    if (obj->file)
+        fclose(obj->file);
+}
+
+/**************************************
+ * eb_trace_ctor
+ *   The file is opened up front so that a bad path fails the encoder
+ *   initialization rather than losing the trace at the end.
+ **************************************/
+EbErrorType eb_trace_ctor(
+    EbTrace    *trace_ptr,
+    const char *file_name)
+{
+    trace_ptr->dctor = eb_trace_dctor;
+
+    FOPEN(trace_ptr->file, file_name, "w");
+    if (trace_ptr->file == NULL) {
+        SVT_LOG("Error: cannot open trace file %s\n", file_name);
+        return EB_ErrorBadParameter;
+    }
+    EB_CREATE_MUTEX(trace_ptr->block_mutex);
+    trace_ptr->start_time = EbGetTimeUs();
+
+    return EB_ErrorNone;
+}
+
+/**************************************
+ * eb_trace_add_event
+ **************************************/
+void eb_trace_add_event(
+    EbTrace    *trace_ptr,
+    const char *name,
+    uint64_t    start_time,
+    uint64_t    end_time,
+    uint64_t    picture_number,
+    int32_t     segment_index)
+{
+    const uint32_t eventIndex = eb_atomic_add_u32(&trace_ptr->event_count, 1) - 1;
+    const uint32_t blockIndex = eventIndex / EB_TRACE_BLOCK_SIZE;
+    EbTraceEvent  *block;
+    EbTraceEvent  *event_ptr;
+
+    if (blockIndex >= EB_TRACE_BLOCK_MAX_COUNT)
+        return;
+
+    block = trace_ptr->block_array[blockIndex];
+    if (block == NULL) {
+        eb_block_on_mutex(trace_ptr->block_mutex);
+        block = trace_ptr->block_array[blockIndex];
+        if (block == NULL) {
+            EB_NO_THROW_CALLOC(block, EB_TRACE_BLOCK_SIZE, sizeof(EbTraceEvent));
+            eb_atomic_fence();
+            trace_ptr->block_array[blockIndex] = block;
+        }
+        eb_release_mutex(trace_ptr->block_mutex);
+        if (block == NULL)
+            return;
+    }
+    if (trace_thread_index == 0)
+        trace_thread_index = eb_atomic_add_u32(&trace_thread_count, 1);
+
+    event_ptr = &block[eventIndex % EB_TRACE_BLOCK_SIZE];
+    event_ptr->picture_number = picture_number;
+    event_ptr->segment_index = segment_index;
+    event_ptr->thread_index = trace_thread_index;
+    event_ptr->start_time = start_time - trace_ptr->start_time;
+    event_ptr->end_time = end_time - trace_ptr->start_time;
+    // The name is set last, unfinished events are skipped by the writer
+    eb_atomic_fence();
+    event_ptr->name = name;
+}
+
+/**************************************
+ * eb_trace_write
+ **************************************/
+EbErrorType eb_trace_write(
+    EbTrace    *trace_ptr,
+    uint32_t    process_id)
+{
+    FILE          *file = trace_ptr->file;
+    const uint32_t event_count = eb_atomic_load_u32(&trace_ptr->event_count);
+    const uint32_t event_max_count = EB_TRACE_BLOCK_SIZE * EB_TRACE_BLOCK_MAX_COUNT;
+    uint32_t       eventIndex;
+
+    if (file == NULL)
+        return EB_ErrorNone;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"SVT-AV1 channel %u\"}}",
+        process_id, process_id + 1);
+
+    for (eventIndex = 0; eventIndex < MIN(event_count, event_max_count); ++eventIndex) {
+        const EbTraceEvent *block = trace_ptr->block_array[eventIndex / EB_TRACE_BLOCK_SIZE];
+        const EbTraceEvent *event_ptr;
+
+        if (block == NULL)
+            continue;
+        event_ptr = &block[eventIndex % EB_TRACE_BLOCK_SIZE];
+        if (event_ptr->name == NULL)
+            continue;
+
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%llu,\"dur\":%llu,\"args\":{",
+            event_ptr->name,
+            process_id,
+            event_ptr->thread_index,
+            (unsigned long long)event_ptr->start_time,
+            (unsigned long long)(event_ptr->end_time - event_ptr->start_time));
+        if (event_ptr->picture_number != EB_TRACE_NO_PICTURE)
+            fprintf(file, "\"picture\":%llu%s", (unsigned long long)event_ptr->picture_number,
+                event_ptr->segment_index != EB_TRACE_NO_SEGMENT ? "," : "");
+        if (event_ptr->segment_index != EB_TRACE_NO_SEGMENT)
+            fprintf(file, "\"segment\":%d", event_ptr->segment_index);
+        fprintf(file, "}}");
+    }
+    fprintf(file, "\n]}\n");
+
+    if (event_count > event_max_count)
+        SVT_LOG("SVT [WARNING]: trace full, %u events dropped\n", event_count - event_max_count);
+
+    fclose(file);
+    trace_ptr->file = NULL;
+    return EB_ErrorNone;
+}
+
+/**************************************
+ * Object spans
+ **************************************/
+void eb_trace_object_begin(
+    EbTrace    *trace_ptr,
+    const char *name,
+    uint64_t    start_time)
+{
+    object_trace_ptr = trace_ptr;
+    object_name = name;
+    object_start_time = start_time;
+    object_picture_number = EB_TRACE_NO_PICTURE;
+    object_segment_index = EB_TRACE_NO_SEGMENT;
+}
+
+void eb_trace_object_end(
+    uint64_t    end_time)
+{
+    if (object_trace_ptr) {
+        eb_trace_add_event(object_trace_ptr, object_name, object_start_time, end_time,
+            object_picture_number, object_segment_index);
+        object_trace_ptr = NULL;
+    }
+}
+
+void eb_trace_set_object(
+    uint64_t    picture_number,
+    int32_t     segment_index)
+{
+    // Only an open span is tagged
+    if (!object_trace_ptr)
+        return;
+    object_picture_number = picture_number;
+    object_segment_index = segment_index;
+}
+
+uint64_t eb_trace_span_begin(void)
+{
+    return object_trace_ptr ? EbGetTimeUs() : 0;
+}
+
+void eb_trace_span_end(
+    const char *name,
+    uint64_t    start_time,
+    uint64_t    picture_number,
+    int32_t     segment_index)
+{
+    if (object_trace_ptr)
+        eb_trace_add_event(object_trace_ptr, name, start_time, EbGetTimeUs(),
+            picture_number, segment_index);
+}
@@ -0,0 +1,109 @@
+/*
+* Copyright(c) 2019 Intel Corporation
+* SPDX - License - Identifier: BSD - 2 - Clause - Patent
+*/
+
+#ifndef EbTrace_h
+#define EbTrace_h
+
+#include <stdio.h>
+#include "EbDefinitions.h"
+#include "EbThreads.h"
+#include "EbObject.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+    /*********************************
+     * Defines
+     *********************************/
+#define EB_TRACE_BLOCK_SIZE             4096
+#define EB_TRACE_BLOCK_MAX_COUNT        1024
+#define EB_TRACE_NO_PICTURE             ((uint64_t)~0)
+#define EB_TRACE_NO_SEGMENT             -1
+
+    // Waits for an empty object shorter than this (in us) are not traced
+#define EB_TRACE_WAIT_MIN_TIME          20
+
+    /*********************************************************************
+     * Trace Event
+     *   A span of work, in microseconds since the trace was created.
+     *********************************************************************/
+    typedef struct EbTraceEvent
+    {
+        const char         *name;
+        uint64_t            start_time;
+        uint64_t            end_time;
+        uint64_t            picture_number;
+        int32_t             segment_index;
+        uint32_t            thread_index;
+    } EbTraceEvent;
+
+    /*********************************************************************
+     * Trace
+     *   Events are appended lock-free by the pipeline threads into blocks
+     *   allocated on demand; events past the last block are dropped and
+     *   counted. The trace is written as Chrome trace event JSON, which
+     *   chrome://tracing and the Perfetto UI both load.
+     *********************************************************************/
+    typedef struct EbTrace
+    {
+        EbDctor             dctor;
+        FILE               *file;
+        uint64_t            start_time;
+        EbTraceEvent       *block_array[EB_TRACE_BLOCK_MAX_COUNT];
+        EbHandle            block_mutex;
+        volatile uint32_t   event_count;
+    } EbTrace;
+
+    extern EbErrorType eb_trace_ctor(
+        EbTrace          *trace_ptr,
+        const char       *file_name);
+
+    extern void eb_trace_add_event(
+        EbTrace          *trace_ptr,
+        const char       *name,
+        uint64_t          start_time,
+        uint64_t          end_time,
+        uint64_t          picture_number,
+        int32_t           segment_index);
+
+    // Writes the recorded events once; process_id separates the channels
+    // of a multi channel encode in the viewer.
+    extern EbErrorType eb_trace_write(
+        EbTrace          *trace_ptr,
+        uint32_t          process_id);
+
+    /*********************************************************************
+     * Object spans
+     *   The system resource manager opens a span when a thread takes an
+     *   object from a traced queue and closes it when the thread asks for
+     *   the next one. The kernel tags the span with the picture and
+     *   segment it works on, and can add nested spans while it is open.
+     *   Outside a span, i.e. when the queue is not traced, the calls
+     *   return without touching any state or reading the clock.
+     *********************************************************************/
+    extern void eb_trace_object_begin(
+        EbTrace          *trace_ptr,
+        const char       *name,
+        uint64_t          start_time);
+
+    extern void eb_trace_object_end(
+        uint64_t          end_time);
+
+    extern void eb_trace_set_object(
+        uint64_t          picture_number,
+        int32_t           segment_index);
+
+    // Returns the start time of a nested span, 0 when not tracing
+    extern uint64_t eb_trace_span_begin(void);
+
+    extern void eb_trace_span_end(
+        const char       *name,
+        uint64_t          start_time,
+        uint64_t          picture_number,
+        int32_t           segment_index);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbTrace_h
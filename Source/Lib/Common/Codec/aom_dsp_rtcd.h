@@ -177,6 +177,26 @@ extern "C" {
     RTCD_EXTERN void(*eb_av1_selfguided_restoration)(const uint8_t *dgd8, int32_t width, int32_t height,
         int32_t dgd_stride, int32_t *flt0, int32_t *flt1, int32_t flt_stride,
         int32_t sgr_params_idx, int32_t bit_depth, int32_t highbd);
+
+    void eb_av1_grain_ar_sum_c(const int32_t *grain, int32_t grain_stride, const int32_t *ar_coeffs, int32_t ar_coeff_lag, int32_t width, int32_t *wsum);
+    void eb_av1_grain_ar_sum_avx2(const int32_t *grain, int32_t grain_stride, const int32_t *ar_coeffs, int32_t ar_coeff_lag, int32_t width, int32_t *wsum);
+    RTCD_EXTERN void(*eb_av1_grain_ar_sum)(const int32_t *grain, int32_t grain_stride, const int32_t *ar_coeffs, int32_t ar_coeff_lag, int32_t width, int32_t *wsum);
+
+    void eb_av1_add_noise_luma_row_c(const uint8_t *src, uint8_t *dst, const int32_t *grain, const int32_t *scaling_lut, int32_t width, int32_t scaling_shift, int32_t min_val, int32_t max_val);
+    void eb_av1_add_noise_luma_row_avx2(const uint8_t *src, uint8_t *dst, const int32_t *grain, const int32_t *scaling_lut, int32_t width, int32_t scaling_shift, int32_t min_val, int32_t max_val);
+    RTCD_EXTERN void(*eb_av1_add_noise_luma_row)(const uint8_t *src, uint8_t *dst, const int32_t *grain, const int32_t *scaling_lut, int32_t width, int32_t scaling_shift, int32_t min_val, int32_t max_val);
+
+    void eb_av1_add_noise_chroma_row_c(const uint8_t *src, uint8_t *dst, const uint8_t *luma, const int32_t *grain, const int32_t *scaling_lut, int32_t width, int32_t subsamp_x, int32_t mult, int32_t luma_mult, int32_t offset, int32_t scaling_shift, int32_t min_val, int32_t max_val);
+    void eb_av1_add_noise_chroma_row_avx2(const uint8_t *src, uint8_t *dst, const uint8_t *luma, const int32_t *grain, const int32_t *scaling_lut, int32_t width, int32_t subsamp_x, int32_t mult, int32_t luma_mult, int32_t offset, int32_t scaling_shift, int32_t min_val, int32_t max_val);
+    RTCD_EXTERN void(*eb_av1_add_noise_chroma_row)(const uint8_t *src, uint8_t *dst, const uint8_t *luma, const int32_t *grain, const int32_t *scaling_lut, int32_t width, int32_t subsamp_x, int32_t mult, int32_t luma_mult, int32_t offset, int32_t scaling_shift, int32_t min_val, int32_t max_val);
+
+    void eb_av1_highbd_add_noise_luma_row_c(const uint16_t *src, uint16_t *dst, const int32_t *grain, const int32_t *scaling_lut, int32_t width, int32_t scaling_shift, int32_t min_val, int32_t max_val, int32_t bit_depth);
+    void eb_av1_highbd_add_noise_luma_row_avx2(const uint16_t *src, uint16_t *dst, const int32_t *grain, const int32_t *scaling_lut, int32_t width, int32_t scaling_shift, int32_t min_val, int32_t max_val, int32_t bit_depth);
+    RTCD_EXTERN void(*eb_av1_highbd_add_noise_luma_row)(const uint16_t *src, uint16_t *dst, const int32_t *grain, const int32_t *scaling_lut, int32_t width, int32_t scaling_shift, int32_t min_val, int32_t max_val, int32_t bit_depth);
+
+    void eb_av1_highbd_add_noise_chroma_row_c(const uint16_t *src, uint16_t *dst, const uint16_t *luma, const int32_t *grain, const int32_t *scaling_lut, int32_t width, int32_t subsamp_x, int32_t mult, int32_t luma_mult, int32_t offset, int32_t scaling_shift, int32_t min_val, int32_t max_val, int32_t bit_depth);
+    void eb_av1_highbd_add_noise_chroma_row_avx2(const uint16_t *src, uint16_t *dst, const uint16_t *luma, const int32_t *grain, const int32_t *scaling_lut, int32_t width, int32_t subsamp_x, int32_t mult, int32_t luma_mult, int32_t offset, int32_t scaling_shift, int32_t min_val, int32_t max_val, int32_t bit_depth);
+    RTCD_EXTERN void(*eb_av1_highbd_add_noise_chroma_row)(const uint16_t *src, uint16_t *dst, const uint16_t *luma, const int32_t *grain, const int32_t *scaling_lut, int32_t width, int32_t subsamp_x, int32_t mult, int32_t luma_mult, int32_t offset, int32_t scaling_shift, int32_t min_val, int32_t max_val, int32_t bit_depth);
 #if COMP_MODE
     void av1_build_compound_diffwtd_mask_c(uint8_t *mask, DIFFWTD_MASK_TYPE mask_type, const uint8_t *src0, int src0_stride, const uint8_t *src1, int src1_stride, int h, int w);
     void av1_build_compound_diffwtd_mask_avx2(uint8_t *mask, DIFFWTD_MASK_TYPE mask_type, const uint8_t *src0, int src0_stride, const uint8_t *src1, int src1_stride, int h, int w);
@@ -2618,6 +2638,17 @@ extern "C" {
 
         eb_av1_selfguided_restoration = eb_av1_selfguided_restoration_c;
         if (flags & HAS_AVX2) eb_av1_selfguided_restoration = eb_av1_selfguided_restoration_avx2;
+
+        eb_av1_grain_ar_sum = eb_av1_grain_ar_sum_c;
+        if (flags & HAS_AVX2) eb_av1_grain_ar_sum = eb_av1_grain_ar_sum_avx2;
+        eb_av1_add_noise_luma_row = eb_av1_add_noise_luma_row_c;
+        if (flags & HAS_AVX2) eb_av1_add_noise_luma_row = eb_av1_add_noise_luma_row_avx2;
+        eb_av1_add_noise_chroma_row = eb_av1_add_noise_chroma_row_c;
+        if (flags & HAS_AVX2) eb_av1_add_noise_chroma_row = eb_av1_add_noise_chroma_row_avx2;
+        eb_av1_highbd_add_noise_luma_row = eb_av1_highbd_add_noise_luma_row_c;
+        if (flags & HAS_AVX2) eb_av1_highbd_add_noise_luma_row = eb_av1_highbd_add_noise_luma_row_avx2;
+        eb_av1_highbd_add_noise_chroma_row = eb_av1_highbd_add_noise_chroma_row_c;
+        if (flags & HAS_AVX2) eb_av1_highbd_add_noise_chroma_row = eb_av1_highbd_add_noise_chroma_row_avx2;
 #if COMP_MODE
         av1_build_compound_diffwtd_mask = av1_build_compound_diffwtd_mask_c;
         if (flags & HAS_AVX2) av1_build_compound_diffwtd_mask = av1_build_compound_diffwtd_mask_avx2;
@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include "EbDefinitions.h"
 #include "grainSynthesis.h"
+#include "aom_dsp_rtcd.h"
 
   // Samples with Gaussian distribution in the range of [-2048, 2047] (12 bits)
   // with zero mean and standard deviation of about 512.
@@ -215,11 +216,8 @@ static const int32_t gaussian_sequence[2048] = {
 
 static const int32_t gauss_bits = 11;
 
-static int32_t luma_subblock_size_y = 32;
-static int32_t luma_subblock_size_x = 32;
-
-static int32_t chroma_subblock_size_y = 16;
-static int32_t chroma_subblock_size_x = 16;
+static const int32_t luma_subblock_size_y = 32;
+static const int32_t luma_subblock_size_x = 32;
 
 static const int32_t min_luma_legal_range = 16;
 static const int32_t max_luma_legal_range = 235;
@@ -227,15 +225,39 @@ static const int32_t max_luma_legal_range = 235;
 static const int32_t min_chroma_legal_range = 16;
 static const int32_t max_chroma_legal_range = 240;
 
-static int32_t scaling_lut_y[256];
-static int32_t scaling_lut_cb[256];
-static int32_t scaling_lut_cr[256];
-
-static int32_t grain_center;
-static int32_t grain_min;
-static int32_t grain_max;
-
-static uint16_t random_register = 0;  // random number generator register
+// Widest grain template : 2 * 32 samples, AR padding and AR offsets
+#define GRAIN_MAX_BLOCK_WIDTH 82
+
+// State of one grain synthesis run. It lives on the stack of the caller, so
+// that encoders and decoders can synthesize grain in parallel
+typedef struct GrainSynthesis {
+    // One more entry than the 8 bit range, repeating the last one : the
+    // interpolation of higher bit depths reads no further
+    int32_t scaling_lut_y[257];
+    int32_t scaling_lut_cb[257];
+    int32_t scaling_lut_cr[257];
+
+    int32_t grain_min;
+    int32_t grain_max;
+
+    uint16_t random_register;  // random number generator register
+} GrainSynthesis;
+
+// Image the grain is added to : dst gets src with grain. They are the same
+// planes when grain is added in place
+typedef struct GrainPlanes {
+    const uint8_t *src_luma;
+    const uint8_t *src_cb;
+    const uint8_t *src_cr;
+    int32_t src_luma_stride;
+    int32_t src_chroma_stride;
+
+    uint8_t *luma;
+    uint8_t *cb;
+    uint8_t *cr;
+    int32_t luma_stride;
+    int32_t chroma_stride;
+} GrainPlanes;
 
 //----------------------------------------------------------------------
 // todo: aomlib memory functions (to be replaced by Eb functions)
@@ -300,7 +322,7 @@ void eb_aom_free(void *memblk) {
 */
 //--------------------------------------------------------------------
 
-static void init_arrays(aom_film_grain_t *params, int32_t luma_stride,
+static void init_arrays(GrainSynthesis *gs, aom_film_grain_t *params, int32_t luma_stride,
     int32_t chroma_stride, int32_t ***pred_pos_luma_p,
     int32_t ***pred_pos_chroma_p, int32_t **luma_grain_block,
     int32_t **cb_grain_block, int32_t **cr_grain_block,
@@ -308,9 +330,11 @@ static void init_arrays(aom_film_grain_t *params, int32_t luma_stride,
     int32_t **y_col_buf, int32_t **cb_col_buf, int32_t **cr_col_buf,
     int32_t luma_grain_samples, int32_t chroma_grain_samples,
     int32_t chroma_subsamp_y, int32_t chroma_subsamp_x) {
-    memset(scaling_lut_y, 0, sizeof(*scaling_lut_y) * 256);
-    memset(scaling_lut_cb, 0, sizeof(*scaling_lut_cb) * 256);
-    memset(scaling_lut_cr, 0, sizeof(*scaling_lut_cr) * 256);
+    int32_t chroma_subblock_size_y = luma_subblock_size_y >> chroma_subsamp_y;
+
+    memset(gs->scaling_lut_y, 0, sizeof(gs->scaling_lut_y));
+    memset(gs->scaling_lut_cb, 0, sizeof(gs->scaling_lut_cb));
+    memset(gs->scaling_lut_cr, 0, sizeof(gs->scaling_lut_cr));
 
     int32_t num_pos_luma = 2 * params->ar_coeff_lag * (params->ar_coeff_lag + 1);
     int32_t num_pos_chroma = num_pos_luma;
@@ -403,7 +427,8 @@ static void dealloc_arrays(aom_film_grain_t *params, int32_t ***pred_pos_luma,
     int32_t **cr_line_buf, int32_t **y_col_buf, int32_t **cb_col_buf,
     int32_t **cr_col_buf) {
     int32_t num_pos_luma = 2 * params->ar_coeff_lag * (params->ar_coeff_lag + 1);
-    int32_t num_pos_chroma = num_pos_luma + 1;
+    int32_t num_pos_chroma = num_pos_luma;
+    if (params->num_y_points > 0) ++num_pos_chroma;
 
     for (int32_t row = 0; row < num_pos_luma; row++)
         free((*pred_pos_luma)[row]);
@@ -433,67 +458,76 @@ static void dealloc_arrays(aom_film_grain_t *params, int32_t ***pred_pos_luma,
 }
 
 // get a number between 0 and 2^bits - 1
-static INLINE int32_t get_random_number(int32_t bits) {
+static INLINE int32_t get_random_number(GrainSynthesis *gs, int32_t bits) {
     uint16_t bit;
-    bit = ((random_register >> 0) ^ (random_register >> 1) ^
-        (random_register >> 3) ^ (random_register >> 12)) &
+    bit = ((gs->random_register >> 0) ^ (gs->random_register >> 1) ^
+        (gs->random_register >> 3) ^ (gs->random_register >> 12)) &
         1;
-    random_register = (random_register >> 1) | (bit << 15);
-    return (random_register >> (16 - bits)) & ((1 << bits) - 1);
+    gs->random_register = (gs->random_register >> 1) | (bit << 15);
+    return (gs->random_register >> (16 - bits)) & ((1 << bits) - 1);
 }
 
-static void init_random_generator(int32_t luma_line, uint16_t seed) {
+static void init_random_generator(GrainSynthesis *gs, int32_t luma_line,
+    uint16_t seed) {
     // same for the picture
 
     uint16_t msb = (seed >> 8) & 255;
     uint16_t lsb = seed & 255;
 
-    random_register = (msb << 8) + lsb;
+    gs->random_register = (msb << 8) + lsb;
 
     //  changes for each row
     int32_t luma_num = luma_line >> 5;
 
-    random_register ^= ((luma_num * 37 + 178) & 255) << 8;
-    random_register ^= ((luma_num * 173 + 105) & 255);
+    gs->random_register ^= ((luma_num * 37 + 178) & 255) << 8;
+    gs->random_register ^= ((luma_num * 173 + 105) & 255);
 }
 
 static void generate_luma_grain_block(
-    aom_film_grain_t *params, int32_t **pred_pos_luma, int32_t *luma_grain_block,
-    int32_t luma_block_size_y, int32_t luma_block_size_x, int32_t luma_grain_stride,
-    int32_t left_pad, int32_t top_pad, int32_t right_pad, int32_t bottom_pad) {
+    GrainSynthesis *gs, aom_film_grain_t *params, int32_t **pred_pos_luma,
+    int32_t *luma_grain_block, int32_t luma_block_size_y,
+    int32_t luma_block_size_x, int32_t luma_grain_stride, int32_t left_pad,
+    int32_t top_pad, int32_t right_pad, int32_t bottom_pad) {
     if (params->num_y_points == 0) return;
 
     int32_t bit_depth = params->bit_depth;
     int32_t gauss_sec_shift = 12 - bit_depth + params->grain_scale_shift;
 
     int32_t num_pos_luma = 2 * params->ar_coeff_lag * (params->ar_coeff_lag + 1);
+    // The positions in the rows above come first
+    int32_t num_pos_above = params->ar_coeff_lag * (2 * params->ar_coeff_lag + 1);
     int32_t rounding_offset = (1 << (params->ar_coeff_shift - 1));
+    int32_t ar_width = luma_block_size_x - left_pad - right_pad;
+    int32_t wsum[GRAIN_MAX_BLOCK_WIDTH];
 
     for (int32_t i = 0; i < luma_block_size_y; i++)
         for (int32_t j = 0; j < luma_block_size_x; j++)
             luma_grain_block[i * luma_grain_stride + j] =
-            (gaussian_sequence[get_random_number(gauss_bits)] +
+            (gaussian_sequence[get_random_number(gs, gauss_bits)] +
             ((1 << gauss_sec_shift) >> 1)) >>
             gauss_sec_shift;
 
-    for (int32_t i = top_pad; i < luma_block_size_y - bottom_pad; i++)
+    for (int32_t i = top_pad; i < luma_block_size_y - bottom_pad; i++) {
+        int32_t *grain_row = luma_grain_block + i * luma_grain_stride;
+
+        // The rows above are final : their part of the sums is computed for
+        // the whole row at once
+        eb_av1_grain_ar_sum(grain_row + left_pad, luma_grain_stride,
+            params->ar_coeffs_y, params->ar_coeff_lag, ar_width, wsum);
+
         for (int32_t j = left_pad; j < luma_block_size_x - right_pad; j++) {
-            int32_t wsum = 0;
-            for (int32_t pos = 0; pos < num_pos_luma; pos++) {
-                wsum = wsum + params->ar_coeffs_y[pos] *
-                    luma_grain_block[(i + pred_pos_luma[pos][0]) *
-                    luma_grain_stride +
-                    j + pred_pos_luma[pos][1]];
-            }
-            luma_grain_block[i * luma_grain_stride + j] =
-                clamp(luma_grain_block[i * luma_grain_stride + j] +
-                ((wsum + rounding_offset) >> params->ar_coeff_shift),
-                    grain_min, grain_max);
+            int32_t sum = wsum[j - left_pad];
+            for (int32_t pos = num_pos_above; pos < num_pos_luma; pos++)
+                sum += params->ar_coeffs_y[pos] * grain_row[j + pred_pos_luma[pos][1]];
+            grain_row[j] = clamp(grain_row[j] +
+                ((sum + rounding_offset) >> params->ar_coeff_shift),
+                gs->grain_min, gs->grain_max);
         }
+    }
 }
 
 static void generate_chroma_grain_blocks(
-    aom_film_grain_t *params,
+    GrainSynthesis *gs, aom_film_grain_t *params,
     //                                  int32_t** pred_pos_luma,
     int32_t **pred_pos_chroma, int32_t *luma_grain_block, int32_t *cb_grain_block,
     int32_t *cr_grain_block, int32_t luma_grain_stride, int32_t chroma_block_size_y,
@@ -504,43 +538,58 @@ static void generate_chroma_grain_blocks(
 
     int32_t num_pos_chroma = 2 * params->ar_coeff_lag * (params->ar_coeff_lag + 1);
     if (params->num_y_points > 0) ++num_pos_chroma;
+    // The positions in the rows above come first
+    int32_t num_pos_above = params->ar_coeff_lag * (2 * params->ar_coeff_lag + 1);
     int32_t rounding_offset = (1 << (params->ar_coeff_shift - 1));
+    int32_t ar_width = chroma_block_size_x - left_pad - right_pad;
+    int32_t wsum_cb[GRAIN_MAX_BLOCK_WIDTH];
+    int32_t wsum_cr[GRAIN_MAX_BLOCK_WIDTH];
 
     if (params->num_cb_points) {
-        init_random_generator(7 << 5, params->random_seed);
+        init_random_generator(gs, 7 << 5, params->random_seed);
 
         for (int32_t i = 0; i < chroma_block_size_y; i++)
             for (int32_t j = 0; j < chroma_block_size_x; j++)
                 cb_grain_block[i * chroma_grain_stride + j] =
-                (gaussian_sequence[get_random_number(gauss_bits)] +
+                (gaussian_sequence[get_random_number(gs, gauss_bits)] +
                 ((1 << gauss_sec_shift) >> 1)) >>
                 gauss_sec_shift;
     }
     if (params->num_cr_points) {
-        init_random_generator(11 << 5, params->random_seed);
+        init_random_generator(gs, 11 << 5, params->random_seed);
 
         for (int32_t i = 0; i < chroma_block_size_y; i++)
             for (int32_t j = 0; j < chroma_block_size_x; j++)
                 cr_grain_block[i * chroma_grain_stride + j] =
-                (gaussian_sequence[get_random_number(gauss_bits)] +
+                (gaussian_sequence[get_random_number(gs, gauss_bits)] +
                 ((1 << gauss_sec_shift) >> 1)) >>
                 gauss_sec_shift;
     }
 
-    for (int32_t i = top_pad; i < chroma_block_size_y - bottom_pad; i++)
+    for (int32_t i = top_pad; i < chroma_block_size_y - bottom_pad; i++) {
+        int32_t *cb_row = cb_grain_block + i * chroma_grain_stride;
+        int32_t *cr_row = cr_grain_block + i * chroma_grain_stride;
+
+        // The rows above are final : their part of the sums is computed for
+        // the whole row at once
+        if (params->num_cb_points)
+            eb_av1_grain_ar_sum(cb_row + left_pad, chroma_grain_stride,
+                params->ar_coeffs_cb, params->ar_coeff_lag, ar_width, wsum_cb);
+        if (params->num_cr_points)
+            eb_av1_grain_ar_sum(cr_row + left_pad, chroma_grain_stride,
+                params->ar_coeffs_cr, params->ar_coeff_lag, ar_width, wsum_cr);
+
         for (int32_t j = left_pad; j < chroma_block_size_x - right_pad; j++) {
-            int32_t wsum_cb = 0;
-            int32_t wsum_cr = 0;
-            for (int32_t pos = 0; pos < num_pos_chroma; pos++) {
+            int32_t sum_cb = params->num_cb_points ? wsum_cb[j - left_pad] : 0;
+            int32_t sum_cr = params->num_cr_points ? wsum_cr[j - left_pad] : 0;
+            for (int32_t pos = num_pos_above; pos < num_pos_chroma; pos++) {
                 if (pred_pos_chroma[pos][2] == 0) {
-                    wsum_cb = wsum_cb + params->ar_coeffs_cb[pos] *
-                        cb_grain_block[(i + pred_pos_chroma[pos][0]) *
-                        chroma_grain_stride +
-                        j + pred_pos_chroma[pos][1]];
-                    wsum_cr = wsum_cr + params->ar_coeffs_cr[pos] *
-                        cr_grain_block[(i + pred_pos_chroma[pos][0]) *
-                        chroma_grain_stride +
-                        j + pred_pos_chroma[pos][1]];
+                    if (params->num_cb_points)
+                        sum_cb += params->ar_coeffs_cb[pos] *
+                            cb_row[j + pred_pos_chroma[pos][1]];
+                    if (params->num_cr_points)
+                        sum_cr += params->ar_coeffs_cr[pos] *
+                            cr_row[j + pred_pos_chroma[pos][1]];
                 }
                 else if (pred_pos_chroma[pos][2] == 1) {
                     int32_t av_luma = 0;
@@ -557,8 +606,8 @@ static void generate_chroma_grain_blocks(
                         (av_luma + ((1 << (chroma_subsamp_y + chroma_subsamp_x)) >> 1)) >>
                         (chroma_subsamp_y + chroma_subsamp_x);
 
-                    wsum_cb = wsum_cb + params->ar_coeffs_cb[pos] * av_luma;
-                    wsum_cr = wsum_cr + params->ar_coeffs_cr[pos] * av_luma;
+                    sum_cb = sum_cb + params->ar_coeffs_cb[pos] * av_luma;
+                    sum_cr = sum_cr + params->ar_coeffs_cr[pos] * av_luma;
                 }
                 else {
                     printf(
@@ -568,16 +617,15 @@ static void generate_chroma_grain_blocks(
                 }
             }
             if (params->num_cb_points)
-                cb_grain_block[i * chroma_grain_stride + j] =
-                clamp(cb_grain_block[i * chroma_grain_stride + j] +
-                ((wsum_cb + rounding_offset) >> params->ar_coeff_shift),
-                    grain_min, grain_max);
+                cb_row[j] = clamp(cb_row[j] +
+                    ((sum_cb + rounding_offset) >> params->ar_coeff_shift),
+                    gs->grain_min, gs->grain_max);
             if (params->num_cr_points)
-                cr_grain_block[i * chroma_grain_stride + j] =
-                clamp(cr_grain_block[i * chroma_grain_stride + j] +
-                ((wsum_cr + rounding_offset) >> params->ar_coeff_shift),
-                    grain_min, grain_max);
+                cr_row[j] = clamp(cr_row[j] +
+                    ((sum_cr + rounding_offset) >> params->ar_coeff_shift),
+                    gs->grain_min, gs->grain_max);
         }
+    }
 }
 
 static void init_scaling_function(int32_t scaling_points[][2], int32_t num_points,
@@ -617,119 +665,84 @@ static int32_t scale_LUT(int32_t *scaling_lut, int32_t index, int32_t bit_depth)
             (bit_depth - 8));
 }
 
-static void add_noise_to_block(aom_film_grain_t *params, uint8_t *luma,
-    uint8_t *cb, uint8_t *cr, int32_t luma_stride,
-    int32_t chroma_stride, int32_t *luma_grain,
-    int32_t *cb_grain, int32_t *cr_grain,
-    int32_t luma_grain_stride, int32_t chroma_grain_stride,
-    int32_t half_luma_height, int32_t half_luma_width,
-    int32_t bit_depth, int32_t chroma_subsamp_y,
-    int32_t chroma_subsamp_x) {
-    int32_t cb_mult = params->cb_mult - 128;            // fixed scale
-    int32_t cb_luma_mult = params->cb_luma_mult - 128;  // fixed scale
-    int32_t cb_offset = params->cb_offset - 256;
-
-    int32_t cr_mult = params->cr_mult - 128;            // fixed scale
-    int32_t cr_luma_mult = params->cr_luma_mult - 128;  // fixed scale
-    int32_t cr_offset = params->cr_offset - 256;
-
-    int32_t rounding_offset = (1 << (params->scaling_shift - 1));
-
-    int32_t apply_y = params->num_y_points > 0 ? 1 : 0;
-    int32_t apply_cb = params->num_cb_points > 0 ? 1 : 0;
-    int32_t apply_cr = params->num_cr_points > 0 ? 1 : 0;
-
-    if (params->chroma_scaling_from_luma) {
-        cb_mult = 0;        // fixed scale
-        cb_luma_mult = 64;  // fixed scale
-        cb_offset = 0;
-
-        cr_mult = 0;        // fixed scale
-        cr_luma_mult = 64;  // fixed scale
-        cr_offset = 0;
+// Sums of the AR filter taps in the rows above, for width positions of a row
+void eb_av1_grain_ar_sum_c(const int32_t *grain, int32_t grain_stride,
+    const int32_t *ar_coeffs, int32_t ar_coeff_lag, int32_t width,
+    int32_t *wsum) {
+    for (int32_t j = 0; j < width; j++) {
+        int32_t sum = 0;
+        int32_t pos = 0;
+        for (int32_t row = -ar_coeff_lag; row < 0; row++)
+            for (int32_t col = -ar_coeff_lag; col <= ar_coeff_lag; col++)
+                sum += ar_coeffs[pos++] * grain[row * grain_stride + j + col];
+        wsum[j] = sum;
     }
+}
 
-    int32_t min_luma, max_luma, min_chroma, max_chroma;
+void eb_av1_add_noise_luma_row_c(const uint8_t *src, uint8_t *dst,
+    const int32_t *grain, const int32_t *scaling_lut, int32_t width,
+    int32_t scaling_shift, int32_t min_val, int32_t max_val) {
+    int32_t rounding_offset = (1 << (scaling_shift - 1));
 
-    if (params->clip_to_restricted_range) {
-        min_luma = min_luma_legal_range;
-        max_luma = max_luma_legal_range;
+    for (int32_t j = 0; j < width; j++)
+        dst[j] = clamp(src[j] + ((scaling_lut[src[j]] * grain[j] +
+            rounding_offset) >> scaling_shift), min_val, max_val);
+}
 
-        min_chroma = min_chroma_legal_range;
-        max_chroma = max_chroma_legal_range;
-    }
-    else {
-        min_luma = min_chroma = 0;
-        max_luma = max_chroma = 255;
+void eb_av1_add_noise_chroma_row_c(const uint8_t *src, uint8_t *dst,
+    const uint8_t *luma, const int32_t *grain, const int32_t *scaling_lut,
+    int32_t width, int32_t subsamp_x, int32_t mult, int32_t luma_mult,
+    int32_t offset, int32_t scaling_shift, int32_t min_val, int32_t max_val) {
+    int32_t rounding_offset = (1 << (scaling_shift - 1));
+
+    for (int32_t j = 0; j < width; j++) {
+        int32_t average_luma = subsamp_x ?
+            (luma[j << 1] + luma[(j << 1) + 1] + 1) >> 1 : luma[j];
+        int32_t index = clamp(((average_luma * luma_mult + mult * src[j]) >> 6) +
+            offset, 0, 255);
+        dst[j] = clamp(src[j] + ((scaling_lut[index] * grain[j] +
+            rounding_offset) >> scaling_shift), min_val, max_val);
     }
+}
 
-    for (int32_t i = 0; i < (half_luma_height << (1 - chroma_subsamp_y)); i++) {
-        for (int32_t j = 0; j < (half_luma_width << (1 - chroma_subsamp_x)); j++) {
-            int32_t average_luma = 0;
-            if (chroma_subsamp_x) {
-                average_luma = (luma[(i << chroma_subsamp_y) * luma_stride +
-                    (j << chroma_subsamp_x)] +
-                    luma[(i << chroma_subsamp_y) * luma_stride +
-                    (j << chroma_subsamp_x) + 1] +
-                    1) >>
-                    1;
-            }
-            else
-                average_luma = luma[(i << chroma_subsamp_y) * luma_stride + j];
-            if (apply_cb) {
-                cb[i * chroma_stride + j] = clamp(
-                    cb[i * chroma_stride + j] +
-                    ((scale_LUT(scaling_lut_cb,
-                        clamp(((average_luma * cb_luma_mult +
-                            cb_mult * cb[i * chroma_stride + j]) >>
-                            6) +
-                            cb_offset,
-                            0, (256 << (bit_depth - 8)) - 1),
-                        8) *
-                        cb_grain[i * chroma_grain_stride + j] +
-                        rounding_offset) >>
-                        params->scaling_shift),
-                    min_chroma, max_chroma);
-            }
+void eb_av1_highbd_add_noise_luma_row_c(const uint16_t *src, uint16_t *dst,
+    const int32_t *grain, const int32_t *scaling_lut, int32_t width,
+    int32_t scaling_shift, int32_t min_val, int32_t max_val,
+    int32_t bit_depth) {
+    int32_t rounding_offset = (1 << (scaling_shift - 1));
 
-            if (apply_cr) {
-                cr[i * chroma_stride + j] = clamp(
-                    cr[i * chroma_stride + j] +
-                    ((scale_LUT(scaling_lut_cr,
-                        clamp(((average_luma * cr_luma_mult +
-                            cr_mult * cr[i * chroma_stride + j]) >>
-                            6) +
-                            cr_offset,
-                            0, (256 << (bit_depth - 8)) - 1),
-                        8) *
-                        cr_grain[i * chroma_grain_stride + j] +
-                        rounding_offset) >>
-                        params->scaling_shift),
-                    min_chroma, max_chroma);
-            }
-        }
-    }
+    for (int32_t j = 0; j < width; j++)
+        dst[j] = clamp(src[j] + ((scale_LUT((int32_t *)scaling_lut, src[j],
+            bit_depth) * grain[j] + rounding_offset) >> scaling_shift),
+            min_val, max_val);
+}
 
-    if (apply_y) {
-        for (int32_t i = 0; i < (half_luma_height << 1); i++) {
-            for (int32_t j = 0; j < (half_luma_width << 1); j++) {
-                luma[i * luma_stride + j] =
-                    clamp(luma[i * luma_stride + j] +
-                    ((scale_LUT(scaling_lut_y, luma[i * luma_stride + j], 8) *
-                        luma_grain[i * luma_grain_stride + j] +
-                        rounding_offset) >>
-                        params->scaling_shift),
-                        min_luma, max_luma);
-            }
-        }
+void eb_av1_highbd_add_noise_chroma_row_c(const uint16_t *src, uint16_t *dst,
+    const uint16_t *luma, const int32_t *grain, const int32_t *scaling_lut,
+    int32_t width, int32_t subsamp_x, int32_t mult, int32_t luma_mult,
+    int32_t offset, int32_t scaling_shift, int32_t min_val, int32_t max_val,
+    int32_t bit_depth) {
+    int32_t rounding_offset = (1 << (scaling_shift - 1));
+
+    for (int32_t j = 0; j < width; j++) {
+        int32_t average_luma = subsamp_x ?
+            (luma[j << 1] + luma[(j << 1) + 1] + 1) >> 1 : luma[j];
+        int32_t index = clamp(((average_luma * luma_mult + mult * src[j]) >> 6) +
+            offset, 0, (256 << (bit_depth - 8)) - 1);
+        dst[j] = clamp(src[j] + ((scale_LUT((int32_t *)scaling_lut, index,
+            bit_depth) * grain[j] + rounding_offset) >> scaling_shift),
+            min_val, max_val);
     }
 }
 
-static void add_noise_to_block_hbd(
-    aom_film_grain_t *params, uint16_t *luma, uint16_t *cb, uint16_t *cr,
-    int32_t luma_stride, int32_t chroma_stride, int32_t *luma_grain, int32_t *cb_grain,
-    int32_t *cr_grain, int32_t luma_grain_stride, int32_t chroma_grain_stride,
-    int32_t half_luma_height, int32_t half_luma_width, int32_t bit_depth,
+// Adds the grain to half_luma_height x half_luma_width pairs of luma samples
+// starting at pair (y, x), and to the chroma samples they cover. The chroma
+// is computed from the luma without grain
+static void add_noise_to_block(GrainSynthesis *gs, aom_film_grain_t *params,
+    const GrainPlanes *planes, int32_t y, int32_t x, int32_t *luma_grain,
+    int32_t *cb_grain, int32_t *cr_grain, int32_t luma_grain_stride,
+    int32_t chroma_grain_stride, int32_t half_luma_height,
+    int32_t half_luma_width, int32_t bit_depth, int32_t use_high_bit_depth,
     int32_t chroma_subsamp_y, int32_t chroma_subsamp_x) {
     int32_t cb_mult = params->cb_mult - 128;            // fixed scale
     int32_t cb_luma_mult = params->cb_luma_mult - 128;  // fixed scale
@@ -741,8 +754,6 @@ static void add_noise_to_block_hbd(
     // offset value depends on the bit depth
     int32_t cr_offset = (params->cr_offset << (bit_depth - 8)) - (1 << bit_depth);
 
-    int32_t rounding_offset = (1 << (params->scaling_shift - 1));
-
     int32_t apply_y = params->num_y_points > 0 ? 1 : 0;
     int32_t apply_cb = params->num_cb_points > 0 ? 1 : 0;
     int32_t apply_cr = params->num_cr_points > 0 ? 1 : 0;
@@ -771,65 +782,84 @@ static void add_noise_to_block_hbd(
         max_luma = max_chroma = (256 << (bit_depth - 8)) - 1;
     }
 
-    for (int32_t i = 0; i < (half_luma_height << (1 - chroma_subsamp_y)); i++) {
-        for (int32_t j = 0; j < (half_luma_width << (1 - chroma_subsamp_x)); j++) {
-            int32_t average_luma = 0;
-            if (chroma_subsamp_x) {
-                average_luma = (luma[(i << chroma_subsamp_y) * luma_stride +
-                    (j << chroma_subsamp_x)] +
-                    luma[(i << chroma_subsamp_y) * luma_stride +
-                    (j << chroma_subsamp_x) + 1] +
-                    1) >>
-                    1;
-            }
-            else
-                average_luma = luma[(i << chroma_subsamp_y) * luma_stride + j];
-            if (apply_cb) {
-                cb[i * chroma_stride + j] = clamp(
-                    cb[i * chroma_stride + j] +
-                    ((scale_LUT(scaling_lut_cb,
-                        clamp(((average_luma * cb_luma_mult +
-                            cb_mult * cb[i * chroma_stride + j]) >>
-                            6) +
-                            cb_offset,
-                            0, (256 << (bit_depth - 8)) - 1),
-                        bit_depth) *
-                        cb_grain[i * chroma_grain_stride + j] +
-                        rounding_offset) >>
-                        params->scaling_shift),
-                    min_chroma, max_chroma);
-            }
-            if (apply_cr) {
-                cr[i * chroma_stride + j] = clamp(
-                    cr[i * chroma_stride + j] +
-                    ((scale_LUT(scaling_lut_cr,
-                        clamp(((average_luma * cr_luma_mult +
-                            cr_mult * cr[i * chroma_stride + j]) >>
-                            6) +
-                            cr_offset,
-                            0, (256 << (bit_depth - 8)) - 1),
-                        bit_depth) *
-                        cr_grain[i * chroma_grain_stride + j] +
-                        rounding_offset) >>
-                        params->scaling_shift),
-                    min_chroma, max_chroma);
-            }
-        }
+    int32_t chroma_height = half_luma_height << (1 - chroma_subsamp_y);
+    int32_t chroma_width = half_luma_width << (1 - chroma_subsamp_x);
+    int32_t bytes_per_sample = use_high_bit_depth ? 2 : 1;
+
+    // Offsets in samples, scaled to bytes
+    size_t src_luma_offset = ((size_t)(y << 1) * planes->src_luma_stride +
+        (x << 1)) * bytes_per_sample;
+    size_t luma_offset = ((size_t)(y << 1) * planes->luma_stride +
+        (x << 1)) * bytes_per_sample;
+    size_t src_chroma_offset = ((size_t)(y << (1 - chroma_subsamp_y)) *
+        planes->src_chroma_stride + (x << (1 - chroma_subsamp_x))) * bytes_per_sample;
+    size_t chroma_offset = ((size_t)(y << (1 - chroma_subsamp_y)) *
+        planes->chroma_stride + (x << (1 - chroma_subsamp_x))) * bytes_per_sample;
+
+    const uint8_t *src_luma = planes->src_luma + src_luma_offset;
+    const uint8_t *src_cb = planes->src_cb + src_chroma_offset;
+    const uint8_t *src_cr = planes->src_cr + src_chroma_offset;
+    uint8_t *luma = planes->luma + luma_offset;
+    uint8_t *cb = planes->cb + chroma_offset;
+    uint8_t *cr = planes->cr + chroma_offset;
+
+    int32_t src_luma_stride = planes->src_luma_stride * bytes_per_sample;
+    int32_t src_chroma_stride = planes->src_chroma_stride * bytes_per_sample;
+    int32_t luma_stride = planes->luma_stride * bytes_per_sample;
+    int32_t chroma_stride = planes->chroma_stride * bytes_per_sample;
+
+    for (int32_t i = 0; i < chroma_height; i++) {
+        const uint8_t *src_luma_row = src_luma + (i << chroma_subsamp_y) * src_luma_stride;
+        const uint8_t *src_cb_row = src_cb + i * src_chroma_stride;
+        const uint8_t *src_cr_row = src_cr + i * src_chroma_stride;
+        uint8_t *cb_row = cb + i * chroma_stride;
+        uint8_t *cr_row = cr + i * chroma_stride;
+
+        if (apply_cb && use_high_bit_depth)
+            eb_av1_highbd_add_noise_chroma_row((const uint16_t *)src_cb_row,
+                (uint16_t *)cb_row, (const uint16_t *)src_luma_row,
+                cb_grain + i * chroma_grain_stride, gs->scaling_lut_cb,
+                chroma_width, chroma_subsamp_x, cb_mult, cb_luma_mult, cb_offset,
+                params->scaling_shift, min_chroma, max_chroma, bit_depth);
+        else if (apply_cb)
+            eb_av1_add_noise_chroma_row(src_cb_row, cb_row, src_luma_row,
+                cb_grain + i * chroma_grain_stride, gs->scaling_lut_cb,
+                chroma_width, chroma_subsamp_x, cb_mult, cb_luma_mult, cb_offset,
+                params->scaling_shift, min_chroma, max_chroma);
+        else if (cb_row != src_cb_row)
+            memcpy(cb_row, src_cb_row, chroma_width * bytes_per_sample);
+
+        if (apply_cr && use_high_bit_depth)
+            eb_av1_highbd_add_noise_chroma_row((const uint16_t *)src_cr_row,
+                (uint16_t *)cr_row, (const uint16_t *)src_luma_row,
+                cr_grain + i * chroma_grain_stride, gs->scaling_lut_cr,
+                chroma_width, chroma_subsamp_x, cr_mult, cr_luma_mult, cr_offset,
+                params->scaling_shift, min_chroma, max_chroma, bit_depth);
+        else if (apply_cr)
+            eb_av1_add_noise_chroma_row(src_cr_row, cr_row, src_luma_row,
+                cr_grain + i * chroma_grain_stride, gs->scaling_lut_cr,
+                chroma_width, chroma_subsamp_x, cr_mult, cr_luma_mult, cr_offset,
+                params->scaling_shift, min_chroma, max_chroma);
+        else if (cr_row != src_cr_row)
+            memcpy(cr_row, src_cr_row, chroma_width * bytes_per_sample);
     }
 
-    if (apply_y) {
-        for (int32_t i = 0; i < (half_luma_height << 1); i++) {
-            for (int32_t j = 0; j < (half_luma_width << 1); j++) {
-                luma[i * luma_stride + j] =
-                    clamp(luma[i * luma_stride + j] +
-                    ((scale_LUT(scaling_lut_y, luma[i * luma_stride + j],
-                        bit_depth) *
-                        luma_grain[i * luma_grain_stride + j] +
-                        rounding_offset) >>
-                        params->scaling_shift),
-                        min_luma, max_luma);
-            }
-        }
+    // After the chroma, which reads the luma without grain when in place
+    for (int32_t i = 0; i < (half_luma_height << 1); i++) {
+        const uint8_t *src_luma_row = src_luma + i * src_luma_stride;
+        uint8_t *luma_row = luma + i * luma_stride;
+
+        if (apply_y && use_high_bit_depth)
+            eb_av1_highbd_add_noise_luma_row((const uint16_t *)src_luma_row,
+                (uint16_t *)luma_row, luma_grain + i * luma_grain_stride,
+                gs->scaling_lut_y, half_luma_width << 1, params->scaling_shift,
+                min_luma, max_luma, bit_depth);
+        else if (apply_y)
+            eb_av1_add_noise_luma_row(src_luma_row, luma_row,
+                luma_grain + i * luma_grain_stride, gs->scaling_lut_y,
+                half_luma_width << 1, params->scaling_shift, min_luma, max_luma);
+        else if (luma_row != src_luma_row)
+            memcpy(luma_row, src_luma_row, (half_luma_width << 1) * bytes_per_sample);
     }
 }
 
@@ -918,14 +948,14 @@ static void copy_area(int32_t *src, int32_t src_stride, int32_t *dst, int32_t ds
     return;
 }
 
-static void ver_boundary_overlap(int32_t *left_block, int32_t left_stride,
+static void ver_boundary_overlap(GrainSynthesis *gs, int32_t *left_block, int32_t left_stride,
     int32_t *right_block, int32_t right_stride,
     int32_t *dst_block, int32_t dst_stride, int32_t width,
     int32_t height) {
     if (width == 1) {
         while (height) {
             *dst_block = clamp((*left_block * 23 + *right_block * 22 + 16) >> 5,
-                grain_min, grain_max);
+                gs->grain_min, gs->grain_max);
             left_block += left_stride;
             right_block += right_stride;
             dst_block += dst_stride;
@@ -936,9 +966,9 @@ static void ver_boundary_overlap(int32_t *left_block, int32_t left_stride,
     else if (width == 2) {
         while (height) {
             dst_block[0] = clamp((27 * left_block[0] + 17 * right_block[0] + 16) >> 5,
-                grain_min, grain_max);
+                gs->grain_min, gs->grain_max);
             dst_block[1] = clamp((17 * left_block[1] + 27 * right_block[1] + 16) >> 5,
-                grain_min, grain_max);
+                gs->grain_min, gs->grain_max);
             left_block += left_stride;
             right_block += right_stride;
             dst_block += dst_stride;
@@ -948,14 +978,14 @@ static void ver_boundary_overlap(int32_t *left_block, int32_t left_stride,
     }
 }
 
-static void hor_boundary_overlap(int32_t *top_block, int32_t top_stride,
+static void hor_boundary_overlap(GrainSynthesis *gs, int32_t *top_block, int32_t top_stride,
     int32_t *bottom_block, int32_t bottom_stride,
     int32_t *dst_block, int32_t dst_stride, int32_t width,
     int32_t height) {
     if (height == 1) {
         while (width) {
             *dst_block = clamp((*top_block * 23 + *bottom_block * 22 + 16) >> 5,
-                grain_min, grain_max);
+                gs->grain_min, gs->grain_max);
             ++top_block;
             ++bottom_block;
             ++dst_block;
@@ -966,11 +996,11 @@ static void hor_boundary_overlap(int32_t *top_block, int32_t top_stride,
     else if (height == 2) {
         while (width) {
             dst_block[0] = clamp((27 * top_block[0] + 17 * bottom_block[0] + 16) >> 5,
-                grain_min, grain_max);
+                gs->grain_min, gs->grain_max);
             dst_block[dst_stride] = clamp((17 * top_block[top_stride] +
                 27 * bottom_block[bottom_stride] + 16) >>
                 5,
-                grain_min, grain_max);
+                gs->grain_min, gs->grain_max);
             ++top_block;
             ++bottom_block;
             ++dst_block;
@@ -980,11 +1010,12 @@ static void hor_boundary_overlap(int32_t *top_block, int32_t top_stride,
     }
 }
 
-void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
-    uint8_t *cb, uint8_t *cr, int32_t height, int32_t width,
-    int32_t luma_stride, int32_t chroma_stride,
-    int32_t use_high_bit_depth, int32_t chroma_subsamp_y,
-    int32_t chroma_subsamp_x) {
+// Adds the grain to the even part of the planes, reading the samples from the
+// source planes, which may be the destination ones
+static void film_grain_run(aom_film_grain_t *params, const GrainPlanes *planes,
+    int32_t height, int32_t width, int32_t use_high_bit_depth,
+    int32_t chroma_subsamp_y, int32_t chroma_subsamp_x) {
+    GrainSynthesis gs;
     int32_t **pred_pos_luma;
     int32_t **pred_pos_chroma;
     int32_t *luma_grain_block;
@@ -999,7 +1030,11 @@ void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
     int32_t *cb_col_buf;
     int32_t *cr_col_buf;
 
-    random_register = params->random_seed;
+    // The line buffers have the strides of the destination planes
+    int32_t luma_stride = planes->luma_stride;
+    int32_t chroma_stride = planes->chroma_stride;
+
+    gs.random_register = params->random_seed;
 
     int32_t left_pad = 3;
     int32_t right_pad = 3;  // padding to offset for AR coefficients
@@ -1008,11 +1043,8 @@ void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
 
     int32_t ar_padding = 3;  // maximum lag used for stabilization of AR coefficients
 
-    luma_subblock_size_y = 32;
-    luma_subblock_size_x = 32;
-
-    chroma_subblock_size_y = luma_subblock_size_y >> chroma_subsamp_y;
-    chroma_subblock_size_x = luma_subblock_size_x >> chroma_subsamp_x;
+    int32_t chroma_subblock_size_y = luma_subblock_size_y >> chroma_subsamp_y;
+    int32_t chroma_subblock_size_x = luma_subblock_size_x >> chroma_subsamp_x;
 
     // Initial padding is only needed for generation of
     // film grain templates (to stabilize the AR process)
@@ -1036,11 +1068,11 @@ void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
     int32_t overlap = params->overlap_flag;
     int32_t bit_depth = params->bit_depth;
 
-    grain_center = 128 << (bit_depth - 8);
-    grain_min = 0 - grain_center;
-    grain_max = (256 << (bit_depth - 8)) - 1 - grain_center;
+    int32_t grain_center = 128 << (bit_depth - 8);
+    gs.grain_min = 0 - grain_center;
+    gs.grain_max = (256 << (bit_depth - 8)) - 1 - grain_center;
 
-    init_arrays(params, luma_stride, chroma_stride, &pred_pos_luma,
+    init_arrays(&gs, params, luma_stride, chroma_stride, &pred_pos_luma,
         &pred_pos_chroma, &luma_grain_block, &cb_grain_block,
         &cr_grain_block, &y_line_buf, &cb_line_buf, &cr_line_buf,
         &y_col_buf, &cb_col_buf, &cr_col_buf,
@@ -1048,13 +1080,13 @@ void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
         chroma_block_size_y * chroma_block_size_x, chroma_subsamp_y,
         chroma_subsamp_x);
 
-    generate_luma_grain_block(params, pred_pos_luma, luma_grain_block,
+    generate_luma_grain_block(&gs, params, pred_pos_luma, luma_grain_block,
         luma_block_size_y, luma_block_size_x,
         luma_grain_stride, left_pad, top_pad, right_pad,
         bottom_pad);
 
     generate_chroma_grain_blocks(
-        params,
+        &gs, params,
         //                               pred_pos_luma,
         pred_pos_chroma, luma_grain_block, cb_grain_block, cr_grain_block,
         luma_grain_stride, chroma_block_size_y, chroma_block_size_x,
@@ -1062,23 +1094,29 @@ void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
         chroma_subsamp_y, chroma_subsamp_x);
 
     init_scaling_function(params->scaling_points_y, params->num_y_points,
-        scaling_lut_y);
+        gs.scaling_lut_y);
 
     if (params->chroma_scaling_from_luma) {
-        memcpy(scaling_lut_cb, scaling_lut_y, sizeof(*scaling_lut_y) * 256);
-        memcpy(scaling_lut_cr, scaling_lut_y, sizeof(*scaling_lut_y) * 256);
+        memcpy(gs.scaling_lut_cb, gs.scaling_lut_y, sizeof(*gs.scaling_lut_y) * 256);
+        memcpy(gs.scaling_lut_cr, gs.scaling_lut_y, sizeof(*gs.scaling_lut_y) * 256);
     }
     else {
         init_scaling_function(params->scaling_points_cb, params->num_cb_points,
-            scaling_lut_cb);
+            gs.scaling_lut_cb);
         init_scaling_function(params->scaling_points_cr, params->num_cr_points,
-            scaling_lut_cr);
+            gs.scaling_lut_cr);
     }
+    // Upper interpolation entry of the last one, so that the kernels need no
+    // special case for it
+    gs.scaling_lut_y[256] = gs.scaling_lut_y[255];
+    gs.scaling_lut_cb[256] = gs.scaling_lut_cb[255];
+    gs.scaling_lut_cr[256] = gs.scaling_lut_cr[255];
+
     for (int32_t y = 0; y < height / 2; y += (luma_subblock_size_y >> 1)) {
-        init_random_generator(y * 2, params->random_seed);
+        init_random_generator(&gs, y * 2, params->random_seed);
 
         for (int32_t x = 0; x < width / 2; x += (luma_subblock_size_x >> 1)) {
-            int32_t offset_y = get_random_number(8);
+            int32_t offset_y = get_random_number(&gs, 8);
             int32_t offset_x = (offset_y >> 4) & 15;
             offset_y &= 15;
 
@@ -1091,14 +1129,14 @@ void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
                 offset_x * (2 >> chroma_subsamp_x);
 
             if (overlap && x) {
-                ver_boundary_overlap(
+                ver_boundary_overlap(&gs,
                     y_col_buf, 2,
                     luma_grain_block + luma_offset_y * luma_grain_stride +
                     luma_offset_x,
                     luma_grain_stride, y_col_buf, 2, 2,
                     AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
 
-                ver_boundary_overlap(
+                ver_boundary_overlap(&gs,
                     cb_col_buf, 2 >> chroma_subsamp_x,
                     cb_grain_block + chroma_offset_y * chroma_grain_stride +
                     chroma_offset_x,
@@ -1107,7 +1145,7 @@ void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
                     AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
                     (height - (y << 1)) >> chroma_subsamp_y));
 
-                ver_boundary_overlap(
+                ver_boundary_overlap(&gs,
                     cr_col_buf, 2 >> chroma_subsamp_x,
                     cr_grain_block + chroma_offset_y * chroma_grain_stride +
                     chroma_offset_x,
@@ -1118,59 +1156,35 @@ void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
 
                 int32_t i = y ? 1 : 0;
 
-                if (use_high_bit_depth) {
-                    add_noise_to_block_hbd(
-                        params,
-                        (uint16_t *)luma + ((y + i) << 1) * luma_stride + (x << 1),
-                        (uint16_t *)cb +
-                        ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                        (x << (1 - chroma_subsamp_x)),
-                        (uint16_t *)cr +
-                        ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                        (x << (1 - chroma_subsamp_x)),
-                        luma_stride, chroma_stride, y_col_buf + i * 4,
-                        cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-                        cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-                        2, (2 - chroma_subsamp_x),
-                        AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1,
-                        bit_depth, chroma_subsamp_y, chroma_subsamp_x);
-                }
-                else {
-                    add_noise_to_block(
-                        params, luma + ((y + i) << 1) * luma_stride + (x << 1),
-                        cb + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                        (x << (1 - chroma_subsamp_x)),
-                        cr + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                        (x << (1 - chroma_subsamp_x)),
-                        luma_stride, chroma_stride, y_col_buf + i * 4,
-                        cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-                        cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-                        2, (2 - chroma_subsamp_x),
-                        AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1,
-                        bit_depth, chroma_subsamp_y, chroma_subsamp_x);
-                }
+                add_noise_to_block(&gs, params, planes, y + i, x, y_col_buf + i * 4,
+                    cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
+                    cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
+                    2, (2 - chroma_subsamp_x),
+                    AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1,
+                    bit_depth, use_high_bit_depth, chroma_subsamp_y,
+                    chroma_subsamp_x);
             }
 
             if (overlap && y) {
                 if (x) {
                     ASSERT(y_col_buf != NULL);
-                    hor_boundary_overlap(y_line_buf + (x << 1), luma_stride, y_col_buf, 2,
+                    hor_boundary_overlap(&gs, y_line_buf + (x << 1), luma_stride, y_col_buf, 2,
                         y_line_buf + (x << 1), luma_stride, 2, 2);
 
-                    hor_boundary_overlap(cb_line_buf + x * (2 >> chroma_subsamp_x),
+                    hor_boundary_overlap(&gs, cb_line_buf + x * (2 >> chroma_subsamp_x),
                         chroma_stride, cb_col_buf, 2 >> chroma_subsamp_x,
                         cb_line_buf + x * (2 >> chroma_subsamp_x),
                         chroma_stride, 2 >> chroma_subsamp_x,
                         2 >> chroma_subsamp_y);
 
-                    hor_boundary_overlap(cr_line_buf + x * (2 >> chroma_subsamp_x),
+                    hor_boundary_overlap(&gs, cr_line_buf + x * (2 >> chroma_subsamp_x),
                         chroma_stride, cr_col_buf, 2 >> chroma_subsamp_x,
                         cr_line_buf + x * (2 >> chroma_subsamp_x),
                         chroma_stride, 2 >> chroma_subsamp_x,
                         2 >> chroma_subsamp_y);
                 }
 
-                hor_boundary_overlap(
+                hor_boundary_overlap(&gs,
                     y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
                     luma_grain_block + luma_offset_y * luma_grain_stride +
                     luma_offset_x + (x ? 2 : 0),
@@ -1179,7 +1193,7 @@ void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
                         width - ((x ? x + 1 : 0) << 1)),
                     2);
 
-                hor_boundary_overlap(
+                hor_boundary_overlap(&gs,
                     cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
                     chroma_stride,
                     cb_grain_block + chroma_offset_y * chroma_grain_stride +
@@ -1192,7 +1206,7 @@ void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
                         (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
                     2 >> chroma_subsamp_y);
 
-                hor_boundary_overlap(
+                hor_boundary_overlap(&gs,
                     cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
                     chroma_stride,
                     cr_grain_block + chroma_offset_y * chroma_grain_stride +
@@ -1205,88 +1219,32 @@ void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
                         (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
                     2 >> chroma_subsamp_y);
 
-                if (use_high_bit_depth) {
-                    add_noise_to_block_hbd(
-                        params, (uint16_t *)luma + (y << 1) * luma_stride + (x << 1),
-                        (uint16_t *)cb + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                        (x << ((1 - chroma_subsamp_x))),
-                        (uint16_t *)cr + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                        (x << ((1 - chroma_subsamp_x))),
-                        luma_stride, chroma_stride, y_line_buf + (x << 1),
-                        cb_line_buf + (x << (1 - chroma_subsamp_x)),
-                        cr_line_buf + (x << (1 - chroma_subsamp_x)), luma_stride,
-                        chroma_stride, 1,
-                        AOMMIN(luma_subblock_size_x >> 1, width / 2 - x), bit_depth,
-                        chroma_subsamp_y, chroma_subsamp_x);
-                }
-                else {
-                    add_noise_to_block(
-                        params, luma + (y << 1) * luma_stride + (x << 1),
-                        cb + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                        (x << ((1 - chroma_subsamp_x))),
-                        cr + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                        (x << ((1 - chroma_subsamp_x))),
-                        luma_stride, chroma_stride, y_line_buf + (x << 1),
-                        cb_line_buf + (x << (1 - chroma_subsamp_x)),
-                        cr_line_buf + (x << (1 - chroma_subsamp_x)), luma_stride,
-                        chroma_stride, 1,
-                        AOMMIN(luma_subblock_size_x >> 1, width / 2 - x), bit_depth,
-                        chroma_subsamp_y, chroma_subsamp_x);
-                }
+                add_noise_to_block(&gs, params, planes, y, x, y_line_buf + (x << 1),
+                    cb_line_buf + (x << (1 - chroma_subsamp_x)),
+                    cr_line_buf + (x << (1 - chroma_subsamp_x)), luma_stride,
+                    chroma_stride, 1,
+                    AOMMIN(luma_subblock_size_x >> 1, width / 2 - x), bit_depth,
+                    use_high_bit_depth, chroma_subsamp_y, chroma_subsamp_x);
             }
 
             int32_t i = overlap && y ? 1 : 0;
             int32_t j = overlap && x ? 1 : 0;
 
-            if (use_high_bit_depth) {
-                add_noise_to_block_hbd(
-                    params,
-                    (uint16_t *)luma + ((y + i) << 1) * luma_stride + ((x + j) << 1),
-                    (uint16_t *)cb +
-                    ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                    ((x + j) << (1 - chroma_subsamp_x)),
-                    (uint16_t *)cr +
-                    ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                    ((x + j) << (1 - chroma_subsamp_x)),
-                    luma_stride, chroma_stride,
-                    luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
-                    luma_offset_x + (j << 1),
-                    cb_grain_block +
-                    (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                    chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-                    cr_grain_block +
-                    (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                    chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-                    luma_grain_stride, chroma_grain_stride,
-                    AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
-                    AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j, bit_depth,
-                    chroma_subsamp_y, chroma_subsamp_x);
-            }
-            else {
-                add_noise_to_block(
-                    params, luma + ((y + i) << 1) * luma_stride + ((x + j) << 1),
-                    cb + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                    ((x + j) << (1 - chroma_subsamp_x)),
-                    cr + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                    ((x + j) << (1 - chroma_subsamp_x)),
-                    luma_stride, chroma_stride,
-                    luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
-                    luma_offset_x + (j << 1),
-                    cb_grain_block +
-                    (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                    chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-                    cr_grain_block +
-                    (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                    chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-                    luma_grain_stride, chroma_grain_stride,
-                    AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
-                    AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j, bit_depth,
-                    chroma_subsamp_y, chroma_subsamp_x);
-            }
+            add_noise_to_block(&gs, params, planes, y + i, x + j,
+                luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
+                luma_offset_x + (j << 1),
+                cb_grain_block +
+                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
+                chroma_grain_stride +
+                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
+                cr_grain_block +
+                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
+                chroma_grain_stride +
+                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
+                luma_grain_stride, chroma_grain_stride,
+                AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
+                AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j, bit_depth,
+                use_high_bit_depth, chroma_subsamp_y, chroma_subsamp_x);
 
             if (overlap) {
                 if (x) {
@@ -1369,6 +1327,87 @@ void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
         &cr_line_buf, &y_col_buf, &cb_col_buf, &cr_col_buf);
 }
 
+void eb_av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
+    uint8_t *cb, uint8_t *cr, int32_t height, int32_t width,
+    int32_t luma_stride, int32_t chroma_stride,
+    int32_t use_high_bit_depth, int32_t chroma_subsamp_y,
+    int32_t chroma_subsamp_x) {
+    GrainPlanes planes;
+
+    planes.src_luma = planes.luma = luma;
+    planes.src_cb = planes.cb = cb;
+    planes.src_cr = planes.cr = cr;
+    planes.src_luma_stride = planes.luma_stride = luma_stride;
+    planes.src_chroma_stride = planes.chroma_stride = chroma_stride;
+
+    film_grain_run(params, &planes, height, width, use_high_bit_depth,
+        chroma_subsamp_y, chroma_subsamp_x);
+}
+
+void eb_av1_add_film_grain_copy(aom_film_grain_t *params,
+    const uint8_t *src_luma, const uint8_t *src_cb, const uint8_t *src_cr,
+    int32_t src_luma_stride, int32_t src_chroma_stride, uint8_t *luma,
+    uint8_t *cb, uint8_t *cr, int32_t luma_stride, int32_t chroma_stride,
+    int32_t height, int32_t width, int32_t use_high_bit_depth,
+    int32_t chroma_subsamp_y, int32_t chroma_subsamp_x) {
+    GrainPlanes planes;
+    int32_t bytes_per_sample = use_high_bit_depth ? 2 : 1;
+
+    planes.src_luma = src_luma;
+    planes.src_cb = src_cb;
+    planes.src_cr = src_cr;
+    planes.src_luma_stride = src_luma_stride;
+    planes.src_chroma_stride = src_chroma_stride;
+    planes.luma = luma;
+    planes.cb = cb;
+    planes.cr = cr;
+    planes.luma_stride = luma_stride;
+    planes.chroma_stride = chroma_stride;
+
+    film_grain_run(params, &planes, height, width, use_high_bit_depth,
+        chroma_subsamp_y, chroma_subsamp_x);
+
+    // The grain covers the even part of the luma, copy the last column and
+    // row of odd sizes and the chroma they cover
+    int32_t chroma_height = height >> chroma_subsamp_y;
+    int32_t chroma_width = width >> chroma_subsamp_x;
+    int32_t grain_chroma_height = (height >> 1) << (1 - chroma_subsamp_y);
+    int32_t grain_chroma_width = (width >> 1) << (1 - chroma_subsamp_x);
+
+    if (width & 1) {
+        fgn_copy_rect((uint8_t *)src_luma + (width - 1) * bytes_per_sample,
+            src_luma_stride, luma + (width - 1) * bytes_per_sample, luma_stride,
+            1, height, use_high_bit_depth);
+    }
+    if (height & 1) {
+        fgn_copy_rect((uint8_t *)src_luma + (size_t)(height - 1) * src_luma_stride *
+            bytes_per_sample, src_luma_stride, luma + (size_t)(height - 1) *
+            luma_stride * bytes_per_sample, luma_stride, width, 1,
+            use_high_bit_depth);
+    }
+    if (chroma_width > grain_chroma_width) {
+        int32_t offset = grain_chroma_width * bytes_per_sample;
+        fgn_copy_rect((uint8_t *)src_cb + offset, src_chroma_stride, cb + offset,
+            chroma_stride, chroma_width - grain_chroma_width, chroma_height,
+            use_high_bit_depth);
+        fgn_copy_rect((uint8_t *)src_cr + offset, src_chroma_stride, cr + offset,
+            chroma_stride, chroma_width - grain_chroma_width, chroma_height,
+            use_high_bit_depth);
+    }
+    if (chroma_height > grain_chroma_height) {
+        size_t src_offset = (size_t)grain_chroma_height * src_chroma_stride *
+            bytes_per_sample;
+        size_t offset = (size_t)grain_chroma_height * chroma_stride *
+            bytes_per_sample;
+        fgn_copy_rect((uint8_t *)src_cb + src_offset, src_chroma_stride,
+            cb + offset, chroma_stride, chroma_width,
+            chroma_height - grain_chroma_height, use_high_bit_depth);
+        fgn_copy_rect((uint8_t *)src_cr + src_offset, src_chroma_stride,
+            cr + offset, chroma_stride, chroma_width,
+            chroma_height - grain_chroma_height, use_high_bit_depth);
+    }
+}
+
 /*
 void av1_film_grain_write_updated(const aom_film_grain_t *pars,
                                   int32_t monochrome,
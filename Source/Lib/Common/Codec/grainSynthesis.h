@@ -101,6 +101,34 @@ extern "C" {
         int32_t use_high_bit_depth, int32_t chroma_subsamp_y,
         int32_t chroma_subsamp_x);
 
+    /*!\brief Add film grain while copying
+     *
+     * Write the planes with film grain to other planes, so that the source
+     * planes stay untouched. Gives the same samples as adding the grain in
+     * place to a copy of the source planes. The chroma planes have
+     * (width >> chroma_subsamp_x) x (height >> chroma_subsamp_y) samples
+     *
+     * \param[in]    grain_params       Grain parameters
+     * \param[in]    src_luma           source luma plane
+     * \param[in]    src_cb             source cb plane
+     * \param[in]    src_cr             source cr plane
+     * \param[in]    src_luma_stride    source luma plane stride
+     * \param[in]    src_chroma_stride  source chroma plane stride
+     * \param[out]   luma               luma plane with grain
+     * \param[out]   cb                 cb plane with grain
+     * \param[out]   cr                 cr plane with grain
+     * \param[in]    luma_stride        luma plane stride
+     * \param[in]    chroma_stride      chroma plane stride
+     * \param[in]    height             luma plane height
+     * \param[in]    width              luma plane width
+     */
+    void eb_av1_add_film_grain_copy(aom_film_grain_t *grain_params,
+        const uint8_t *src_luma, const uint8_t *src_cb, const uint8_t *src_cr,
+        int32_t src_luma_stride, int32_t src_chroma_stride, uint8_t *luma,
+        uint8_t *cb, uint8_t *cr, int32_t luma_stride, int32_t chroma_stride,
+        int32_t height, int32_t width, int32_t use_high_bit_depth,
+        int32_t chroma_subsamp_y, int32_t chroma_subsamp_x);
+
     /*!\brief Add film grain
      *
      * Add film grain to an image
@@ -63,6 +63,28 @@ void dec_get_bits_leb128(bitstrm_t *bs, size_t available, size_t *value,
     }
 }
 
+int dec_read_leb128(const uint8_t *data, size_t available, size_t *value,
+    size_t *length)
+{
+    size_t i;
+
+    *value = 0;
+    *length = 0;
+    for (i = 0; i < 8 && i < available; i++) {
+        *value |= ((size_t)(data[i] & 0x7f)) << (i * 7);
+        if (!(data[i] & 0x80)) {
+            *length = i + 1;
+            return 1;
+        }
+    }
+    /* As dec_get_bits_leb128, the value ends after 8 bytes */
+    if (i == 8) {
+        *length = 8;
+        return 1;
+    }
+    return 0;
+}
+
 /* Get variable length unsigned n-bit number appearing directly in the bitstream */
 uint32_t dec_get_bits_uvlc(bitstrm_t *bs) {
     int leading_zeros = 0;
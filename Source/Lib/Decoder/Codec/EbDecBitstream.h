@@ -77,6 +77,10 @@ uint32_t dec_get_bits_uvlc(bitstrm_t *bs);
 uint32_t dec_get_bits(bitstrm_t *bs, uint32_t numbits);
 void dec_get_bits_leb128(bitstrm_t *bs, size_t available, size_t *value,
                     size_t *length);
+/* leb128 of the first available bytes of data, before any bitstream is set
+   up. Returns 0 while the value is not complete */
+int dec_read_leb128(const uint8_t *data, size_t available, size_t *value,
+                    size_t *length);
 uint32_t dec_get_bits_ns(bitstrm_t *bs, uint32_t n);
 int32_t dec_get_bits_su(bitstrm_t *bs, uint32_t n);
 uint32_t dec_get_bits_le(bitstrm_t *bs, uint32_t n);
@@ -82,8 +82,9 @@ static INLINE int32_t dec_sb_compute_cdef_list(EbDecHandle *dec_handle,
     return count;
 }
 
-/*Frame level call, for CDEF 8 bit-depth*/
-void svt_cdef_frame(EbDecHandle *dec_handle) {
+/*CDEF of one 64x64 filter block, 8 bit-depth. The blocks of a row are
+  filtered left to right, after svt_cdef_row_start()*/
+void svt_cdef_fb(EbDecHandle *dec_handle, CdefRowCtxt *row_ctxt, int32_t fbc) {
     EbPictureBufferDesc *recon_picture_ptr =
         dec_handle->cur_pic_buf[0]->ps_pic_buf;
     uint8_t *curr_blk_recon_buf[MAX_MB_PLANE];
@@ -93,10 +94,12 @@ void svt_cdef_frame(EbDecHandle *dec_handle) {
         color_config);
 
     DECLARE_ALIGNED(16, uint16_t, src[CDEF_INBUF_SIZE]);
-    uint16_t *linebuf[3];
-    uint16_t *colbuf[3];
+    uint16_t **linebuf = row_ctxt->curr_linebuf;
+    uint16_t **prev_linebuf = row_ctxt->prev_linebuf;
+    uint16_t **colbuf = row_ctxt->colbuf;
     cdef_list dlist[MI_SIZE_64X64 * MI_SIZE_64X64];
-    uint8_t *row_cdef, *prev_row_cdef, *curr_row_cdef;
+    uint8_t *prev_row_cdef = row_ctxt->prev_row_cdef;
+    uint8_t *curr_row_cdef = row_ctxt->curr_row_cdef;
     int32_t cdef_count;
     int32_t dir[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
     int32_t var[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
@@ -105,18 +108,12 @@ void svt_cdef_frame(EbDecHandle *dec_handle) {
     int32_t xdec[3];
     int32_t ydec[3];
     int32_t coeff_shift = AOMMAX(recon_picture_ptr->bit_depth - 8, 0);
+    const int32_t fbr = row_ctxt->fbr;
     const int32_t nvfb = (frame_info->mi_rows + MI_SIZE_64X64 - 1) /
         MI_SIZE_64X64;
     const int32_t nhfb = (frame_info->mi_cols + MI_SIZE_64X64 - 1) /
         MI_SIZE_64X64;
-    row_cdef = (uint8_t *)eb_aom_malloc(sizeof(*row_cdef) * (nhfb + 2) * 2);
-    assert(row_cdef != NULL);
-    memset(row_cdef, 1, sizeof(*row_cdef) * (nhfb + 2) * 2);
-    prev_row_cdef = row_cdef + 1;
-    curr_row_cdef = prev_row_cdef + nhfb + 2;
-
-    const int32_t stride = (frame_info->mi_cols << MI_SIZE_LOG2) +
-        2 * CDEF_HBORDER;
+    const int32_t stride = row_ctxt->linebuf_stride;
 
     MasterFrameBuf *master_frame_buf = &dec_handle->master_frame_buf;
     CurFrameBuf    *frame_buf = &master_frame_buf->cur_frame_bufs[0];
@@ -134,285 +131,244 @@ void svt_cdef_frame(EbDecHandle *dec_handle) {
         derive_blk_pointers(recon_picture_ptr, pli,
             0, 0, (void *)&curr_blk_recon_buf[pli], &curr_recon_stride[pli],
             sub_x, sub_y);
-        /*Allocating memory for line buffes->to fill from src if needed*/
-        linebuf[pli] = (uint16_t *)eb_aom_malloc(sizeof(*linebuf) *
-            CDEF_VBORDER * stride);
-        /*Allocating memory for col buffes->to fill from src if needed*/
-        colbuf[pli] = (uint16_t *)eb_aom_malloc(sizeof(*colbuf)  *
-            ((CDEF_BLOCKSIZE << mi_high_l2[pli]) + 2 * CDEF_VBORDER) *
-            CDEF_HBORDER);
     }
 
-    /*Loop for 64x64 block wise, along col wise for frame size*/
-    for (int32_t fbr = 0; fbr < nvfb; fbr++) {
-        for (int32_t pli = 0; pli < num_planes; pli++) {
-            const int32_t block_height =
-                (MI_SIZE_64X64 << mi_high_l2[pli]) + 2 * CDEF_VBORDER;
-            /*Filling the colbuff's with some values.*/
-            fill_rect(colbuf[pli], CDEF_HBORDER, block_height, CDEF_HBORDER,
+    /* Logic for getting SBinfo,
+    SbInfo points to every super block.*/
+    SBInfo  *sb_info = frame_buf->sb_info +
+        ((fbr >> 1) * master_frame_buf->sb_cols) + (fbc >> 1);
+
+    /*Logic for consuming cdef values from super block,
+    Index will vary from 0 to 3 based on position of 64x64 block
+    in Superblock.*/
+    const int32_t index =
+        dec_handle->seq_header.sb_size == BLOCK_128X128 ?
+        (!!(fbc & cdef_mask) + 2 * !!(fbr & cdef_mask)) : 0;
+
+    int32_t level, sec_strength;
+    int32_t uv_level, uv_sec_strength;
+    int32_t nhb, nvb;
+    int32_t cstart = 0;
+    curr_row_cdef[fbc] = 0;
+    if (!in_dec_area(&dec_handle->dec_area, MI_SIZE_64X64 * fbr,
+        MI_SIZE_64X64 * fbc, MI_SIZE_64X64) ||
+        sb_info == NULL || sb_info->sb_cdef_strength[index] == -1) {
+        row_ctxt->cdef_left = 0;
+        return;
+    }
+    if (!row_ctxt->cdef_left) cstart = -CDEF_HBORDER;
+    nhb = AOMMIN(MI_SIZE_64X64,
+        frame_info->mi_cols - MI_SIZE_64X64 * fbc);
+    nvb = AOMMIN(MI_SIZE_64X64,
+        frame_info->mi_rows - MI_SIZE_64X64 * fbr);
+    int32_t frame_top, frame_left, frame_bottom, frame_right;
+    int32_t row_ofset = MI_SIZE_64X64 * fbr;
+    int32_t col_ofset = MI_SIZE_64X64 * fbc;
+
+    /*For the current filter block, it's top left corner mi structure (mi_tl)
+    is first accessed to check whether the top and left boundaries are
+    frame boundaries. Then bottom-left and top-right mi structures are
+    accessed to check whether the bottom and right boundaries
+    (respectively) are frame boundaries.
+
+    Note that we can't just check the bottom-right mi structure - eg. if
+    we're at the right-hand edge of the frame but not the bottom, then
+    the bottom-right mi is NULL but the bottom-left is not.  */
+
+    frame_top = (row_ofset == 0) ? 1 : 0;
+    frame_left = (col_ofset == 0) ? 1 : 0;
+
+    if (fbr != nvfb - 1) {
+        frame_bottom = ((uint32_t)row_ofset + MI_SIZE_64X64 ==
+            frame_info->mi_rows) ? 1 : 0;
+    }
+    else
+        frame_bottom = 1;
+
+    if (fbc != nhfb - 1) {
+        frame_right = ((uint32_t)col_ofset + MI_SIZE_64X64 ==
+            frame_info->mi_cols) ? 1 : 0;
+    }
+    else
+        frame_right = 1;
+
+    const int32_t cdef_strength = sb_info->sb_cdef_strength[index];
+    level = frame_info->CDEF_params.cdef_y_strength[cdef_strength] /
+        CDEF_SEC_STRENGTHS;
+    sec_strength = frame_info->CDEF_params.
+        cdef_y_strength[cdef_strength] % CDEF_SEC_STRENGTHS;
+    sec_strength += sec_strength == 3;
+    uv_level = frame_info->CDEF_params.
+        cdef_uv_strength[cdef_strength] / CDEF_SEC_STRENGTHS;
+    uv_sec_strength = frame_info->CDEF_params.
+        cdef_uv_strength[cdef_strength] % CDEF_SEC_STRENGTHS;
+    uv_sec_strength += uv_sec_strength == 3;
+
+    if ((level == 0 && sec_strength == 0 && uv_level == 0 &&
+        uv_sec_strength == 0) ||
+        (cdef_count = dec_sb_compute_cdef_list(dec_handle, sb_info,
+        frame_info, (fbr * MI_SIZE_64X64), (fbc * MI_SIZE_64X64),
+        dlist, BLOCK_64X64)) == 0)
+    {
+        row_ctxt->cdef_left = 0;
+        return;
+    }
+    curr_row_cdef[fbc] = 1;
+    /*Cdef loop for each plane*/
+    for (int32_t pli = 0; pli < num_planes; pli++) {
+        int32_t coffset;
+        int32_t rend, cend;
+        int32_t pri_damping = frame_info->CDEF_params.cdef_damping;
+        int32_t sec_damping = frame_info->CDEF_params.cdef_damping;
+        int32_t hsize = nhb << mi_wide_l2[pli];
+        int32_t vsize = nvb << mi_high_l2[pli];
+        if (pli) {
+            level = uv_level;
+            sec_strength = uv_sec_strength;
+        }
+
+        if (fbc == nhfb - 1)
+            cend = hsize;
+        else
+            cend = hsize + CDEF_HBORDER;
+
+        if (fbr == nvfb - 1)
+            rend = vsize;
+        else
+            rend = vsize + CDEF_VBORDER;
+
+        coffset = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
+        if (fbc == nhfb - 1) {
+            /* On the last superblock column, fill in the right border with
+               CDEF_VERY_LARGE to avoid filtering with the outside. */
+            fill_rect(&src[cend + CDEF_HBORDER], CDEF_BSTRIDE,
+                rend + CDEF_VBORDER, hsize + CDEF_HBORDER - cend,
+                CDEF_VERY_LARGE);
+        }
+        if (fbr == nvfb - 1) {
+            /* On the last superblock row, fill in the bottom border with
+               CDEF_VERY_LARGE to avoid filtering with the outside. */
+            fill_rect(&src[(rend + CDEF_VBORDER) * CDEF_BSTRIDE],
+                CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
+                CDEF_VERY_LARGE);
+        }
+        uint8_t* rec_buff = curr_blk_recon_buf[pli];
+        uint32_t rec_stride = curr_recon_stride[pli];
+
+        /* Copy in the pixels we need from the current superblock for
+           deringing.*/
+        copy_sb8_16(
+            &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER + cstart],
+            CDEF_BSTRIDE, rec_buff/*xd->plane[pli].dst.buf*/,
+            (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr, coffset + cstart,
+            rec_stride/*xd->plane[pli].dst.stride*/,
+            rend, cend - cstart);
+        if (!prev_row_cdef[fbc]) {
+            copy_sb8_16(//cm,
+                &src[CDEF_HBORDER], CDEF_BSTRIDE,
+                rec_buff/*xd->plane[pli].dst.buf*/,
+                (MI_SIZE_64X64 << mi_high_l2[pli])* fbr - CDEF_VBORDER,
+                coffset, rec_stride/*xd->plane[pli].dst.stride*/,
+                CDEF_VBORDER, hsize);
+        }
+        else if (fbr > 0) {
+            copy_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE,
+                &prev_linebuf[pli][coffset],
+                stride, CDEF_VBORDER, hsize);
+        }
+        else {
+            fill_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE,
+                CDEF_VBORDER, hsize,
                 CDEF_VERY_LARGE);
         }
 
-        int32_t cdef_left = 1;
-        /*Loop for 64x64 block wise, along row wise for frame size*/
-        for (int32_t fbc = 0; fbc < nhfb; fbc++) {
-            /* Logic for getting SBinfo,
-            SbInfo points to every super block.*/
-            SBInfo  *sb_info = frame_buf->sb_info +
-                ((fbr >> 1) * master_frame_buf->sb_cols) + (fbc >> 1);
-
-            /*Logic for consuming cdef values from super block,
-            Index will vary from 0 to 3 based on position of 64x64 block
-            in Superblock.*/
-            const int32_t index =
-                dec_handle->seq_header.sb_size == BLOCK_128X128 ?
-                (!!(fbc & cdef_mask) + 2 * !!(fbr & cdef_mask)) : 0;
-
-            int32_t level, sec_strength;
-            int32_t uv_level, uv_sec_strength;
-            int32_t nhb, nvb;
-            int32_t cstart = 0;
-            curr_row_cdef[fbc] = 0;
-            if (sb_info == NULL || sb_info->sb_cdef_strength[index] == -1) {
-                cdef_left = 0;
-                continue;
-            }
-            if (!cdef_left) cstart = -CDEF_HBORDER;
-            nhb = AOMMIN(MI_SIZE_64X64,
-                frame_info->mi_cols - MI_SIZE_64X64 * fbc);
-            nvb = AOMMIN(MI_SIZE_64X64,
-                frame_info->mi_rows - MI_SIZE_64X64 * fbr);
-            int32_t frame_top, frame_left, frame_bottom, frame_right;
-            int32_t row_ofset = MI_SIZE_64X64 * fbr;
-            int32_t col_ofset = MI_SIZE_64X64 * fbc;
-
-            /*For the current filter block, it's top left corner mi structure (mi_tl)
-            is first accessed to check whether the top and left boundaries are
-            frame boundaries. Then bottom-left and top-right mi structures are
-            accessed to check whether the bottom and right boundaries
-            (respectively) are frame boundaries.
-
-            Note that we can't just check the bottom-right mi structure - eg. if
-            we're at the right-hand edge of the frame but not the bottom, then
-            the bottom-right mi is NULL but the bottom-left is not.  */
-
-            frame_top = (row_ofset == 0) ? 1 : 0;
-            frame_left = (col_ofset == 0) ? 1 : 0;
-
-            if (fbr != nvfb - 1) {
-                frame_bottom = ((uint32_t)row_ofset + MI_SIZE_64X64 ==
-                    frame_info->mi_rows) ? 1 : 0;
-            }
-            else
-                frame_bottom = 1;
+        if (!prev_row_cdef[fbc - 1]) {
+            copy_sb8_16(//cm,
+                src, CDEF_BSTRIDE, rec_buff/*xd->plane[pli].dst.buf*/,
+                (MI_SIZE_64X64 << mi_high_l2[pli])*fbr - CDEF_VBORDER,
+                coffset - CDEF_HBORDER, rec_stride/*xd->plane[pli].
+                dst.stride*/, CDEF_VBORDER, CDEF_HBORDER);
+        }
+        else if (fbr > 0 && fbc > 0) {
+            copy_rect(src, CDEF_BSTRIDE,
+                &prev_linebuf[pli][coffset - CDEF_HBORDER],
+                stride, CDEF_VBORDER, CDEF_HBORDER);
+        }
+        else {
+            fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, CDEF_HBORDER,
+                CDEF_VERY_LARGE);
+        }
 
-            if (fbc != nhfb - 1) {
-                frame_right = ((uint32_t)col_ofset + MI_SIZE_64X64 ==
-                    frame_info->mi_cols) ? 1 : 0;
-            }
-            else
-                frame_right = 1;
-
-            const int32_t cdef_strength = sb_info->sb_cdef_strength[index];
-            level = frame_info->CDEF_params.cdef_y_strength[cdef_strength] /
-                CDEF_SEC_STRENGTHS;
-            sec_strength = frame_info->CDEF_params.
-                cdef_y_strength[cdef_strength] % CDEF_SEC_STRENGTHS;
-            sec_strength += sec_strength == 3;
-            uv_level = frame_info->CDEF_params.
-                cdef_uv_strength[cdef_strength] / CDEF_SEC_STRENGTHS;
-            uv_sec_strength = frame_info->CDEF_params.
-                cdef_uv_strength[cdef_strength] % CDEF_SEC_STRENGTHS;
-            uv_sec_strength += uv_sec_strength == 3;
-
-            if ((level == 0 && sec_strength == 0 && uv_level == 0 &&
-                uv_sec_strength == 0) ||
-                (cdef_count = dec_sb_compute_cdef_list(dec_handle, sb_info,
-                frame_info, (fbr * MI_SIZE_64X64), (fbc * MI_SIZE_64X64),
-                dlist, BLOCK_64X64)) == 0)
-            {
-                cdef_left = 0;
-                continue;
-            }
-            curr_row_cdef[fbc] = 1;
-            /*Cdef loop for each plane*/
-            for (int32_t pli = 0; pli < num_planes; pli++) {
-                int32_t coffset;
-                int32_t rend, cend;
-                int32_t pri_damping = frame_info->CDEF_params.cdef_damping;
-                int32_t sec_damping = frame_info->CDEF_params.cdef_damping;
-                int32_t hsize = nhb << mi_wide_l2[pli];
-                int32_t vsize = nvb << mi_high_l2[pli];
-                if (pli) {
-                    level = uv_level;
-                    sec_strength = uv_sec_strength;
-                }
-
-                if (fbc == nhfb - 1)
-                    cend = hsize;
-                else
-                    cend = hsize + CDEF_HBORDER;
-
-                if (fbr == nvfb - 1)
-                    rend = vsize;
-                else
-                    rend = vsize + CDEF_VBORDER;
-
-                coffset = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
-                if (fbc == nhfb - 1) {
-                    /* On the last superblock column, fill in the right border with
-                       CDEF_VERY_LARGE to avoid filtering with the outside. */
-                    fill_rect(&src[cend + CDEF_HBORDER], CDEF_BSTRIDE,
-                        rend + CDEF_VBORDER, hsize + CDEF_HBORDER - cend,
-                        CDEF_VERY_LARGE);
-                }
-                if (fbr == nvfb - 1) {
-                    /* On the last superblock row, fill in the bottom border with
-                       CDEF_VERY_LARGE to avoid filtering with the outside. */
-                    fill_rect(&src[(rend + CDEF_VBORDER) * CDEF_BSTRIDE],
-                        CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
-                        CDEF_VERY_LARGE);
-                }
-                uint8_t* rec_buff = 0;
-                uint32_t rec_stride = 0;
-                switch (pli) {
-                case 0:
-                    rec_buff = curr_blk_recon_buf[0];
-                    rec_stride = curr_recon_stride[0];
-                    break;
-                case 1:
-                    rec_buff = curr_blk_recon_buf[1];
-                    rec_stride = curr_recon_stride[1];
-                    break;
-                case 2:
-                    rec_buff = curr_blk_recon_buf[2];
-                    rec_stride = curr_recon_stride[2];
-                    break;
-                }
-                /* Copy in the pixels we need from the current superblock for
-                   deringing.*/
-                copy_sb8_16(
-                    &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER + cstart],
-                    CDEF_BSTRIDE, rec_buff/*xd->plane[pli].dst.buf*/,
-                    (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr, coffset + cstart,
-                    rec_stride/*xd->plane[pli].dst.stride*/,
-                    rend, cend - cstart);
-                if (!prev_row_cdef[fbc]) {
-                    copy_sb8_16(//cm,
-                        &src[CDEF_HBORDER], CDEF_BSTRIDE,
-                        rec_buff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli])* fbr - CDEF_VBORDER,
-                        coffset, rec_stride/*xd->plane[pli].dst.stride*/,
-                        CDEF_VBORDER, hsize);
-                }
-                else if (fbr > 0) {
-                    copy_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE,
-                        &linebuf[pli][coffset],
-                        stride, CDEF_VBORDER, hsize);
-                }
-                else {
-                    fill_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE,
-                        CDEF_VBORDER, hsize,
-                        CDEF_VERY_LARGE);
-                }
-
-                if (!prev_row_cdef[fbc - 1]) {
-                    copy_sb8_16(//cm,
-                        src, CDEF_BSTRIDE, rec_buff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli])*fbr - CDEF_VBORDER,
-                        coffset - CDEF_HBORDER, rec_stride/*xd->plane[pli].
-                        dst.stride*/, CDEF_VBORDER, CDEF_HBORDER);
-                }
-                else if (fbr > 0 && fbc > 0) {
-                    copy_rect(src, CDEF_BSTRIDE,
-                        &linebuf[pli][coffset - CDEF_HBORDER],
-                        stride, CDEF_VBORDER, CDEF_HBORDER);
-                }
-                else {
-                    fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, CDEF_HBORDER,
-                        CDEF_VERY_LARGE);
-                }
-
-                if (!prev_row_cdef[fbc + 1]) {
-                    copy_sb8_16(//cm,
-                        &src[CDEF_HBORDER + (nhb << mi_wide_l2[pli])],
-                        CDEF_BSTRIDE, rec_buff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli])*fbr - CDEF_VBORDER,
-                        coffset + hsize, rec_stride/*xd->plane[pli].dst.stride*/,
-                        CDEF_VBORDER, CDEF_HBORDER);
-                }
-                else if (fbr > 0 && fbc < nhfb - 1) {
-                    copy_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                        &linebuf[pli][coffset + hsize], stride, CDEF_VBORDER,
-                        CDEF_HBORDER);
-                }
-                else {
-                    fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                        CDEF_VBORDER, CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
-
-                if (cdef_left) {
-                    /* If we deringed the superblock on the left
-                       then we need to copy in saved pixels. */
-                    copy_rect(src, CDEF_BSTRIDE, colbuf[pli], CDEF_HBORDER,
-                        rend + CDEF_VBORDER, CDEF_HBORDER);
-                }
-
-                /* Saving pixels in case we need to dering the superblock
-                    on the right. */
-                if (fbc < nhfb - 1)
-                    copy_rect(colbuf[pli], CDEF_HBORDER, src + hsize,
-                        CDEF_BSTRIDE, rend + CDEF_VBORDER, CDEF_HBORDER);
-
-                if (fbr < nvfb - 1)
-                    copy_sb8_16(&linebuf[pli][coffset], stride, rec_buff,
-                        (MI_SIZE_64X64 << mi_high_l2[pli]) *
-                        (fbr + 1) - CDEF_VBORDER,
-                        coffset, rec_stride, CDEF_VBORDER, hsize);
-
-                if (frame_top) {
-                    fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER,
-                        hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
-                if (frame_left) {
-                    fill_rect(src, CDEF_BSTRIDE, vsize + 2 * CDEF_VBORDER,
-                        CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
-                if (frame_bottom) {
-                    fill_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE],
-                        CDEF_BSTRIDE, CDEF_VBORDER,
-                        hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
-                if (frame_right) {
-                    fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                        vsize + 2 * CDEF_VBORDER, CDEF_HBORDER,
-                        CDEF_VERY_LARGE);
-                }
-                /*Cdef filter calling function for 8 bit depth */
-                eb_cdef_filter_fb(&rec_buff[rec_stride *
-                    (MI_SIZE_64X64 * fbr << mi_high_l2[pli])
-                    + (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])], NULL,
-                    rec_stride,&src[CDEF_VBORDER*CDEF_BSTRIDE+CDEF_HBORDER],
-                    xdec[pli], ydec[pli], dir, NULL, var, pli, dlist,
-                    cdef_count, level, sec_strength, pri_damping,
-                    sec_damping, coeff_shift);
-            }/*cdef plane loop ending*/
-            //CHKN filtered data is written back directy to recFrame.
-            cdef_left = 1;
-        }
-        uint8_t *tmp = prev_row_cdef;
-        prev_row_cdef = curr_row_cdef;
-        curr_row_cdef = tmp;
-    }
-    eb_aom_free(row_cdef);
-    for (int32_t pli = 0; pli < num_planes; pli++) {
-        eb_aom_free(linebuf[pli]);
-        eb_aom_free(colbuf[pli]);
-    }
+        if (!prev_row_cdef[fbc + 1]) {
+            copy_sb8_16(//cm,
+                &src[CDEF_HBORDER + (nhb << mi_wide_l2[pli])],
+                CDEF_BSTRIDE, rec_buff/*xd->plane[pli].dst.buf*/,
+                (MI_SIZE_64X64 << mi_high_l2[pli])*fbr - CDEF_VBORDER,
+                coffset + hsize, rec_stride/*xd->plane[pli].dst.stride*/,
+                CDEF_VBORDER, CDEF_HBORDER);
+        }
+        else if (fbr > 0 && fbc < nhfb - 1) {
+            copy_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
+                &prev_linebuf[pli][coffset + hsize], stride, CDEF_VBORDER,
+                CDEF_HBORDER);
+        }
+        else {
+            fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
+                CDEF_VBORDER, CDEF_HBORDER, CDEF_VERY_LARGE);
+        }
+
+        if (row_ctxt->cdef_left) {
+            /* If we deringed the superblock on the left
+               then we need to copy in saved pixels. */
+            copy_rect(src, CDEF_BSTRIDE, colbuf[pli], CDEF_HBORDER,
+                rend + CDEF_VBORDER, CDEF_HBORDER);
+        }
+
+        /* Saving pixels in case we need to dering the superblock
+            on the right. */
+        if (fbc < nhfb - 1)
+            copy_rect(colbuf[pli], CDEF_HBORDER, src + hsize,
+                CDEF_BSTRIDE, rend + CDEF_VBORDER, CDEF_HBORDER);
+
+        if (fbr < nvfb - 1)
+            copy_sb8_16(&linebuf[pli][coffset], stride, rec_buff,
+                (MI_SIZE_64X64 << mi_high_l2[pli]) *
+                (fbr + 1) - CDEF_VBORDER,
+                coffset, rec_stride, CDEF_VBORDER, hsize);
+
+        if (frame_top) {
+            fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER,
+                hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
+        }
+        if (frame_left) {
+            fill_rect(src, CDEF_BSTRIDE, vsize + 2 * CDEF_VBORDER,
+                CDEF_HBORDER, CDEF_VERY_LARGE);
+        }
+        if (frame_bottom) {
+            fill_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE],
+                CDEF_BSTRIDE, CDEF_VBORDER,
+                hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
+        }
+        if (frame_right) {
+            fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
+                vsize + 2 * CDEF_VBORDER, CDEF_HBORDER,
+                CDEF_VERY_LARGE);
+        }
+        /*Cdef filter calling function for 8 bit depth */
+        eb_cdef_filter_fb(&rec_buff[rec_stride *
+            (MI_SIZE_64X64 * fbr << mi_high_l2[pli])
+            + (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])], NULL,
+            rec_stride,&src[CDEF_VBORDER*CDEF_BSTRIDE+CDEF_HBORDER],
+            xdec[pli], ydec[pli], dir, NULL, var, pli, dlist,
+            cdef_count, level, sec_strength, pri_damping,
+            sec_damping, coeff_shift);
+    }/*cdef plane loop ending*/
+    //CHKN filtered data is written back directy to recFrame.
+    row_ctxt->cdef_left = 1;
 }
 
-/*Frame level call, for CDEF High bit-depth*/
-void svt_cdef_frame_hbd(EbDecHandle *dec_handle) {
+/*CDEF of one 64x64 filter block, high bit-depth*/
+void svt_cdef_fb_hbd(EbDecHandle *dec_handle, CdefRowCtxt *row_ctxt, int32_t fbc) {
     EbPictureBufferDesc *recon_picture_ptr =
         dec_handle->cur_pic_buf[0]->ps_pic_buf;
     uint16_t *curr_blk_recon_buf[MAX_MB_PLANE];
@@ -422,10 +378,12 @@ void svt_cdef_frame_hbd(EbDecHandle *dec_handle) {
         color_config);
 
     DECLARE_ALIGNED(16, uint16_t, src[CDEF_INBUF_SIZE]);
-    uint16_t *linebuf[3];
-    uint16_t *colbuf[3];
+    uint16_t **linebuf = row_ctxt->curr_linebuf;
+    uint16_t **prev_linebuf = row_ctxt->prev_linebuf;
+    uint16_t **colbuf = row_ctxt->colbuf;
     cdef_list dlist[MI_SIZE_64X64 * MI_SIZE_64X64];
-    uint8_t *row_cdef, *prev_row_cdef, *curr_row_cdef;
+    uint8_t *prev_row_cdef = row_ctxt->prev_row_cdef;
+    uint8_t *curr_row_cdef = row_ctxt->curr_row_cdef;
     int32_t cdef_count;
     int32_t dir[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
     int32_t var[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
@@ -434,18 +392,12 @@ void svt_cdef_frame_hbd(EbDecHandle *dec_handle) {
     int32_t xdec[3];
     int32_t ydec[3];
     int32_t coeff_shift = AOMMAX(recon_picture_ptr->bit_depth - 8, 0);
+    const int32_t fbr = row_ctxt->fbr;
     const int32_t nvfb = (frame_info->mi_rows + MI_SIZE_64X64 - 1) /
         MI_SIZE_64X64;
     const int32_t nhfb = (frame_info->mi_cols + MI_SIZE_64X64 - 1) /
         MI_SIZE_64X64;
-    row_cdef = (uint8_t *)eb_aom_malloc(sizeof(*row_cdef) * (nhfb + 2) * 2);
-    assert(row_cdef != NULL);
-    memset(row_cdef, 1, sizeof(*row_cdef) * (nhfb + 2) * 2);
-    prev_row_cdef = row_cdef + 1;
-    curr_row_cdef = prev_row_cdef + nhfb + 2;
-
-    const int32_t stride = (frame_info->mi_cols << MI_SIZE_LOG2) +
-        2 * CDEF_HBORDER;
+    const int32_t stride = row_ctxt->linebuf_stride;
 
     MasterFrameBuf *master_frame_buf = &dec_handle->master_frame_buf;
     CurFrameBuf    *frame_buf = &master_frame_buf->cur_frame_bufs[0];
@@ -463,280 +415,324 @@ void svt_cdef_frame_hbd(EbDecHandle *dec_handle) {
         derive_blk_pointers(recon_picture_ptr, pli,
             0, 0, (void *)&curr_blk_recon_buf[pli], &curr_recon_stride[pli],
             sub_x, sub_y);
+    }
+
+    /* Logic for getting SBinfo,
+    SbInfo points to every super block.*/
+    SBInfo  *sb_info = frame_buf->sb_info +
+        ((fbr >> 1) * master_frame_buf->sb_cols) + (fbc >> 1);
+
+    /*Logic for consuming cdef values from super block,
+    Index will vary from 0 to 3 based on position of 64x64 block
+    in Superblock.*/
+    const int32_t index =
+        dec_handle->seq_header.sb_size == BLOCK_128X128 ?
+        (!!(fbc & cdef_mask) + 2 * !!(fbr & cdef_mask)) : 0;
+
+    int32_t level, sec_strength;
+    int32_t uv_level, uv_sec_strength;
+    int32_t nhb, nvb;
+    int32_t cstart = 0;
+    curr_row_cdef[fbc] = 0;
+    if (!in_dec_area(&dec_handle->dec_area, MI_SIZE_64X64 * fbr,
+        MI_SIZE_64X64 * fbc, MI_SIZE_64X64) ||
+        sb_info == NULL || sb_info->sb_cdef_strength[index] == -1) {
+        row_ctxt->cdef_left = 0;
+        return;
+    }
+    if (!row_ctxt->cdef_left) cstart = -CDEF_HBORDER;
+    nhb = AOMMIN(MI_SIZE_64X64,
+        frame_info->mi_cols - MI_SIZE_64X64 * fbc);
+    nvb = AOMMIN(MI_SIZE_64X64,
+        frame_info->mi_rows - MI_SIZE_64X64 * fbr);
+    int32_t frame_top, frame_left, frame_bottom, frame_right;
+    int32_t row_ofset = MI_SIZE_64X64 * fbr;
+    int32_t col_ofset = MI_SIZE_64X64 * fbc;
+
+    /*For the current filter block, it's top left corner mi structure (mi_tl)
+    is first accessed to check whether the top and left boundaries are
+    frame boundaries. Then bottom-left and top-right mi structures are
+    accessed to check whether the bottom and right boundaries
+    (respectively) are frame boundaries.
+
+    Note that we can't just check the bottom-right mi structure - eg. if
+    we're at the right-hand edge of the frame but not the bottom, then
+    the bottom-right mi is NULL but the bottom-left is not.  */
+
+    frame_top = (row_ofset == 0) ? 1 : 0;
+    frame_left = (col_ofset == 0) ? 1 : 0;
+
+    if (fbr != nvfb - 1) {
+        frame_bottom = ((uint32_t)row_ofset + MI_SIZE_64X64 ==
+            frame_info->mi_rows) ? 1 : 0;
+    }
+    else
+        frame_bottom = 1;
+
+    if (fbc != nhfb - 1) {
+        frame_right = ((uint32_t)col_ofset + MI_SIZE_64X64 ==
+            frame_info->mi_cols) ? 1 : 0;
+    }
+    else
+        frame_right = 1;
+
+    const int32_t cdef_strength = sb_info->sb_cdef_strength[index];
+    level = frame_info->CDEF_params.cdef_y_strength[cdef_strength] /
+        CDEF_SEC_STRENGTHS;
+    sec_strength = frame_info->CDEF_params.
+        cdef_y_strength[cdef_strength] % CDEF_SEC_STRENGTHS;
+    sec_strength += sec_strength == 3;
+    uv_level = frame_info->CDEF_params.
+        cdef_uv_strength[cdef_strength] / CDEF_SEC_STRENGTHS;
+    uv_sec_strength = frame_info->CDEF_params.
+        cdef_uv_strength[cdef_strength] % CDEF_SEC_STRENGTHS;
+    uv_sec_strength += uv_sec_strength == 3;
+
+    if ((level == 0 && sec_strength == 0 && uv_level == 0 &&
+        uv_sec_strength == 0) ||
+        (cdef_count = dec_sb_compute_cdef_list(dec_handle, sb_info,
+        frame_info, (fbr * MI_SIZE_64X64), (fbc * MI_SIZE_64X64),
+        dlist, BLOCK_64X64)) == 0)
+    {
+        row_ctxt->cdef_left = 0;
+        return;
+    }
+    curr_row_cdef[fbc] = 1;
+    /*Cdef loop for each plane*/
+    for (int32_t pli = 0; pli < num_planes; pli++) {
+        int32_t coffset;
+        int32_t rend, cend;
+        int32_t pri_damping = frame_info->CDEF_params.cdef_damping;
+        int32_t sec_damping = frame_info->CDEF_params.cdef_damping;
+        int32_t hsize = nhb << mi_wide_l2[pli];
+        int32_t vsize = nvb << mi_high_l2[pli];
+        if (pli) {
+            level = uv_level;
+            sec_strength = uv_sec_strength;
+        }
+
+        if (fbc == nhfb - 1)
+            cend = hsize;
+        else
+            cend = hsize + CDEF_HBORDER;
+
+        if (fbr == nvfb - 1)
+            rend = vsize;
+        else
+            rend = vsize + CDEF_VBORDER;
+
+        coffset = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
+        if (fbc == nhfb - 1) {
+            /* On the last superblock column, fill in the right border with
+               CDEF_VERY_LARGE to avoid filtering with the outside. */
+            fill_rect(&src[cend + CDEF_HBORDER], CDEF_BSTRIDE,
+                rend + CDEF_VBORDER, hsize + CDEF_HBORDER - cend,
+                CDEF_VERY_LARGE);
+        }
+        if (fbr == nvfb - 1) {
+            /* On the last superblock row, fill in the bottom border with
+               CDEF_VERY_LARGE to avoid filtering with the outside. */
+            fill_rect(&src[(rend + CDEF_VBORDER) * CDEF_BSTRIDE],
+                CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
+                CDEF_VERY_LARGE);
+        }
+        uint16_t* rec_buff = curr_blk_recon_buf[pli];
+        uint32_t rec_stride = curr_recon_stride[pli];
+
+        /* Copy in the pixels we need from the current superblock for
+           deringing.*/
+        copy_sb16_16(
+            &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER + cstart],
+            CDEF_BSTRIDE, rec_buff/*xd->plane[pli].dst.buf*/,
+            (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr, coffset + cstart,
+            rec_stride/*xd->plane[pli].dst.stride*/,
+            rend, cend - cstart);
+        if (!prev_row_cdef[fbc]) {
+            copy_sb16_16(//cm,
+                &src[CDEF_HBORDER], CDEF_BSTRIDE,
+                rec_buff/*xd->plane[pli].dst.buf*/,
+                (MI_SIZE_64X64 << mi_high_l2[pli])* fbr - CDEF_VBORDER,
+                coffset, rec_stride/*xd->plane[pli].dst.stride*/,
+                CDEF_VBORDER, hsize);
+        }
+        else if (fbr > 0) {
+            copy_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE,
+                &prev_linebuf[pli][coffset],
+                stride, CDEF_VBORDER, hsize);
+        }
+        else {
+            fill_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE,
+                CDEF_VBORDER, hsize,
+                CDEF_VERY_LARGE);
+        }
+
+        if (!prev_row_cdef[fbc - 1]) {
+            copy_sb16_16(//cm,
+                src, CDEF_BSTRIDE, rec_buff/*xd->plane[pli].dst.buf*/,
+                (MI_SIZE_64X64 << mi_high_l2[pli])*fbr - CDEF_VBORDER,
+                coffset - CDEF_HBORDER, rec_stride/*xd->plane[pli].
+                dst.stride*/, CDEF_VBORDER, CDEF_HBORDER);
+        }
+        else if (fbr > 0 && fbc > 0) {
+            copy_rect(src, CDEF_BSTRIDE,
+                &prev_linebuf[pli][coffset - CDEF_HBORDER],
+                stride, CDEF_VBORDER, CDEF_HBORDER);
+        }
+        else {
+            fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, CDEF_HBORDER,
+                CDEF_VERY_LARGE);
+        }
+
+        if (!prev_row_cdef[fbc + 1]) {
+            copy_sb16_16(//cm,
+                &src[CDEF_HBORDER + (nhb << mi_wide_l2[pli])],
+                CDEF_BSTRIDE, rec_buff/*xd->plane[pli].dst.buf*/,
+                (MI_SIZE_64X64 << mi_high_l2[pli])*fbr - CDEF_VBORDER,
+                coffset + hsize, rec_stride/*xd->plane[pli].dst.stride*/,
+                CDEF_VBORDER, CDEF_HBORDER);
+        }
+        else if (fbr > 0 && fbc < nhfb - 1) {
+            copy_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
+                &prev_linebuf[pli][coffset + hsize], stride, CDEF_VBORDER,
+                CDEF_HBORDER);
+        }
+        else {
+            fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
+                CDEF_VBORDER, CDEF_HBORDER, CDEF_VERY_LARGE);
+        }
+
+        if (row_ctxt->cdef_left) {
+            /* If we deringed the superblock on the left
+               then we need to copy in saved pixels. */
+            copy_rect(src, CDEF_BSTRIDE, colbuf[pli], CDEF_HBORDER,
+                rend + CDEF_VBORDER, CDEF_HBORDER);
+        }
+
+        /* Saving pixels in case we need to dering the superblock
+            on the right. */
+        if (fbc < nhfb - 1)
+            copy_rect(colbuf[pli], CDEF_HBORDER, src + hsize,
+                CDEF_BSTRIDE, rend + CDEF_VBORDER, CDEF_HBORDER);
+
+        if (fbr < nvfb - 1)
+            copy_sb16_16(&linebuf[pli][coffset], stride, rec_buff,
+                (MI_SIZE_64X64 << mi_high_l2[pli]) *
+                (fbr + 1) - CDEF_VBORDER,
+                coffset, rec_stride, CDEF_VBORDER, hsize);
+
+        if (frame_top) {
+            fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER,
+                hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
+        }
+        if (frame_left) {
+            fill_rect(src, CDEF_BSTRIDE, vsize + 2 * CDEF_VBORDER,
+                CDEF_HBORDER, CDEF_VERY_LARGE);
+        }
+        if (frame_bottom) {
+            fill_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE],
+                CDEF_BSTRIDE, CDEF_VBORDER,
+                hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
+        }
+        if (frame_right) {
+            fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
+                vsize + 2 * CDEF_VBORDER, CDEF_HBORDER,
+                CDEF_VERY_LARGE);
+        }
+        /*Cdef filter calling function for HBD*/
+        eb_cdef_filter_fb(NULL, &rec_buff[rec_stride *
+            (MI_SIZE_64X64 * fbr << mi_high_l2[pli])
+            + (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
+            rec_stride, &src[CDEF_VBORDER*CDEF_BSTRIDE + CDEF_HBORDER],
+            xdec[pli], ydec[pli], dir, NULL, var, pli, dlist,
+            cdef_count, level, sec_strength, pri_damping,
+            sec_damping, coeff_shift);
+    }/*cdef plane loop ending*/
+    //CHKN filtered data is written back directy to recFrame.
+    row_ctxt->cdef_left = 1;
+}
+
+/*Starts the CDEF of filter block row fbr*/
+void svt_cdef_row_start(EbDecHandle *dec_handle, CdefRowCtxt *row_ctxt,
+                        int32_t fbr)
+{
+    const int32_t num_planes = av1_num_planes(&dec_handle->seq_header.
+        color_config);
+
+    for (int32_t pli = 0; pli < num_planes; pli++) {
+        const int32_t mi_high_l2 = MI_SIZE_LOG2 - ((pli == 0) ? 0 : 1);
+        const int32_t block_height =
+            (MI_SIZE_64X64 << mi_high_l2) + 2 * CDEF_VBORDER;
+        /*Filling the colbuff's with some values.*/
+        fill_rect(row_ctxt->colbuf[pli], CDEF_HBORDER, block_height,
+            CDEF_HBORDER, CDEF_VERY_LARGE);
+    }
+    row_ctxt->linebuf_stride =
+        (dec_handle->frame_header.mi_cols << MI_SIZE_LOG2) + 2 * CDEF_HBORDER;
+    row_ctxt->fbr = fbr;
+    row_ctxt->cdef_left = 1;
+}
+
+/*Frame level CDEF, one filter block row after the other*/
+static void cdef_frame(EbDecHandle *dec_handle, int32_t is_hbd) {
+    FrameHeader *frame_info = &dec_handle->frame_header;
+    const int32_t num_planes = av1_num_planes(&dec_handle->seq_header.
+        color_config);
+    CdefRowCtxt row_ctxt;
+    uint8_t *row_cdef;
+    const int32_t nvfb = (frame_info->mi_rows + MI_SIZE_64X64 - 1) /
+        MI_SIZE_64X64;
+    const int32_t nhfb = (frame_info->mi_cols + MI_SIZE_64X64 - 1) /
+        MI_SIZE_64X64;
+    row_cdef = (uint8_t *)eb_aom_malloc(sizeof(*row_cdef) * (nhfb + 2) * 2);
+    assert(row_cdef != NULL);
+    memset(row_cdef, 1, sizeof(*row_cdef) * (nhfb + 2) * 2);
+    row_ctxt.prev_row_cdef = row_cdef + 1;
+    row_ctxt.curr_row_cdef = row_ctxt.prev_row_cdef + nhfb + 2;
+
+    const int32_t stride = (frame_info->mi_cols << MI_SIZE_LOG2) +
+        2 * CDEF_HBORDER;
+
+    for (int32_t pli = 0; pli < num_planes; pli++) {
+        int32_t mi_high_l2 = MI_SIZE_LOG2 - ((pli == 0) ? 0 : 1);
         /*Allocating memory for line buffes->to fill from src if needed*/
-        linebuf[pli] = (uint16_t *)eb_aom_malloc(sizeof(*linebuf) *
-            CDEF_VBORDER * stride);
+        row_ctxt.curr_linebuf[pli] = (uint16_t *)eb_aom_malloc(
+            sizeof(uint16_t) * CDEF_VBORDER * stride);
+        /* Rows in order : the row above is read before being overwritten */
+        row_ctxt.prev_linebuf[pli] = row_ctxt.curr_linebuf[pli];
         /*Allocating memory for col buffes->to fill from src if needed*/
-        colbuf[pli] = (uint16_t *)eb_aom_malloc(sizeof(*colbuf)  *
-            ((CDEF_BLOCKSIZE << mi_high_l2[pli]) + 2 * CDEF_VBORDER) *
+        row_ctxt.colbuf[pli] = (uint16_t *)eb_aom_malloc(sizeof(uint16_t) *
+            ((CDEF_BLOCKSIZE << mi_high_l2) + 2 * CDEF_VBORDER) *
             CDEF_HBORDER);
     }
 
     /*Loop for 64x64 block wise, along col wise for frame size*/
     for (int32_t fbr = 0; fbr < nvfb; fbr++) {
-        for (int32_t pli = 0; pli < num_planes; pli++) {
-            const int32_t block_height =
-                (MI_SIZE_64X64 << mi_high_l2[pli]) + 2 * CDEF_VBORDER;
-            /*Filling the colbuff's with some values.*/
-            fill_rect(colbuf[pli], CDEF_HBORDER, block_height, CDEF_HBORDER,
-                CDEF_VERY_LARGE);
-        }
+        svt_cdef_row_start(dec_handle, &row_ctxt, fbr);
 
-        int32_t cdef_left = 1;
         /*Loop for 64x64 block wise, along row wise for frame size*/
         for (int32_t fbc = 0; fbc < nhfb; fbc++) {
-            /* Logic for getting SBinfo,
-            SbInfo points to every super block.*/
-            SBInfo  *sb_info = frame_buf->sb_info +
-                ((fbr >> 1) * master_frame_buf->sb_cols) + (fbc >> 1);
-
-            /*Logic for consuming cdef values from super block,
-            Index will vary from 0 to 3 based on position of 64x64 block
-            in Superblock.*/
-            const int32_t index =
-                dec_handle->seq_header.sb_size == BLOCK_128X128 ?
-                (!!(fbc & cdef_mask) + 2 * !!(fbr & cdef_mask)) : 0;
-
-            int32_t level, sec_strength;
-            int32_t uv_level, uv_sec_strength;
-            int32_t nhb, nvb;
-            int32_t cstart = 0;
-            curr_row_cdef[fbc] = 0;
-            if (sb_info == NULL || sb_info->sb_cdef_strength[index] == -1) {
-                cdef_left = 0;
-                continue;
-            }
-            if (!cdef_left) cstart = -CDEF_HBORDER;
-            nhb = AOMMIN(MI_SIZE_64X64,
-                frame_info->mi_cols - MI_SIZE_64X64 * fbc);
-            nvb = AOMMIN(MI_SIZE_64X64,
-                frame_info->mi_rows - MI_SIZE_64X64 * fbr);
-            int32_t frame_top, frame_left, frame_bottom, frame_right;
-            int32_t row_ofset = MI_SIZE_64X64 * fbr;
-            int32_t col_ofset = MI_SIZE_64X64 * fbc;
-
-            /*For the current filter block, it's top left corner mi structure
-            (mi_tl) is first accessed to check whether the top and left
-            boundaries are frame boundaries. Then bottom-left and top-right
-            mi structures are accessed to check whether the bottom and right
-            boundaries (respectively) are frame boundaries.
-
-            Note that we can't just check the bottom-right mi structure - eg. if
-            we're at the right-hand edge of the frame but not the bottom, then
-            the bottom-right mi is NULL but the bottom-left is not.  */
-
-            frame_top = (row_ofset == 0) ? 1 : 0;
-            frame_left = (col_ofset == 0) ? 1 : 0;
-
-            if (fbr != nvfb - 1) {
-                frame_bottom = ((uint32_t)row_ofset + MI_SIZE_64X64 ==
-                    frame_info->mi_rows) ? 1 : 0;
-            }
+            if (is_hbd)
+                svt_cdef_fb_hbd(dec_handle, &row_ctxt, fbc);
             else
-                frame_bottom = 1;
-
-            if (fbc != nhfb - 1) {
-                frame_right = ((uint32_t)col_ofset + MI_SIZE_64X64 ==
-                    frame_info->mi_cols) ? 1 : 0;
-            }
-            else
-                frame_right = 1;
-
-            const int32_t cdef_strength = sb_info->sb_cdef_strength[index];
-            level = frame_info->CDEF_params.cdef_y_strength[cdef_strength] /
-                CDEF_SEC_STRENGTHS;
-            sec_strength = frame_info->CDEF_params.
-                cdef_y_strength[cdef_strength] % CDEF_SEC_STRENGTHS;
-            sec_strength += sec_strength == 3;
-            uv_level = frame_info->CDEF_params.
-                cdef_uv_strength[cdef_strength] / CDEF_SEC_STRENGTHS;
-            uv_sec_strength = frame_info->CDEF_params.
-                cdef_uv_strength[cdef_strength] % CDEF_SEC_STRENGTHS;
-            uv_sec_strength += uv_sec_strength == 3;
-
-            if ((level == 0 && sec_strength == 0 && uv_level == 0 &&
-                uv_sec_strength == 0) ||
-                (cdef_count = dec_sb_compute_cdef_list(dec_handle, sb_info,
-                    frame_info, (fbr * MI_SIZE_64X64), (fbc * MI_SIZE_64X64),
-                    dlist, BLOCK_64X64)) == 0)
-            {
-                cdef_left = 0;
-                continue;
-            }
-            curr_row_cdef[fbc] = 1;
-            /*Cdef loop for each plane*/
-            for (int32_t pli = 0; pli < num_planes; pli++) {
-                int32_t coffset;
-                int32_t rend, cend;
-                int32_t pri_damping = frame_info->CDEF_params.cdef_damping;
-                int32_t sec_damping = frame_info->CDEF_params.cdef_damping;
-                int32_t hsize = nhb << mi_wide_l2[pli];
-                int32_t vsize = nvb << mi_high_l2[pli];
-                if (pli) {
-                    level = uv_level;
-                    sec_strength = uv_sec_strength;
-                }
-
-                if (fbc == nhfb - 1)
-                    cend = hsize;
-                else
-                    cend = hsize + CDEF_HBORDER;
-
-                if (fbr == nvfb - 1)
-                    rend = vsize;
-                else
-                    rend = vsize + CDEF_VBORDER;
-
-                coffset = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
-                if (fbc == nhfb - 1) {
-                    /* On the last superblock column, fill in the right border
-                    with CDEF_VERY_LARGE to avoid filtering with the outside. */
-                    fill_rect(&src[cend + CDEF_HBORDER], CDEF_BSTRIDE,
-                        rend + CDEF_VBORDER, hsize + CDEF_HBORDER - cend,
-                        CDEF_VERY_LARGE);
-                }
-                if (fbr == nvfb - 1) {
-                    /* On the last superblock row, fill in the bottom border with
-                       CDEF_VERY_LARGE to avoid filtering with the outside. */
-                    fill_rect(&src[(rend + CDEF_VBORDER) * CDEF_BSTRIDE],
-                        CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
-                        CDEF_VERY_LARGE);
-                }
-                uint16_t* rec_buff = 0;
-                uint32_t rec_stride = 0;
-                switch (pli) {
-                case 0:
-                    rec_buff = curr_blk_recon_buf[0];
-                    rec_stride = curr_recon_stride[0];
-                    break;
-                case 1:
-                    rec_buff = curr_blk_recon_buf[1];
-                    rec_stride = curr_recon_stride[1];
-                    break;
-                case 2:
-                    rec_buff = curr_blk_recon_buf[2];
-                    rec_stride = curr_recon_stride[2];
-                    break;
-                }
-                /* Copy in the pixels we need from the current superblock for
-                   deringing.*/
-                copy_sb16_16(
-                    &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER + cstart],
-                    CDEF_BSTRIDE, rec_buff/*xd->plane[pli].dst.buf*/,
-                    (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr, coffset + cstart,
-                    rec_stride/*xd->plane[pli].dst.stride*/,
-                    rend, cend - cstart);
-                if (!prev_row_cdef[fbc]) {
-                    copy_sb16_16(//cm,
-                        &src[CDEF_HBORDER], CDEF_BSTRIDE,
-                        rec_buff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli])* fbr - CDEF_VBORDER,
-                        coffset, rec_stride/*xd->plane[pli].dst.stride*/,
-                        CDEF_VBORDER, hsize);
-                }
-                else if (fbr > 0) {
-                    copy_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE,
-                        &linebuf[pli][coffset],
-                        stride, CDEF_VBORDER, hsize);
-                }
-                else {
-                    fill_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE,
-                        CDEF_VBORDER, hsize,
-                        CDEF_VERY_LARGE);
-                }
-
-                if (!prev_row_cdef[fbc - 1]) {
-                    copy_sb16_16(//cm,
-                        src, CDEF_BSTRIDE, rec_buff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli])*fbr - CDEF_VBORDER,
-                        coffset - CDEF_HBORDER, rec_stride/*xd->plane[pli].
-                        dst.stride*/, CDEF_VBORDER, CDEF_HBORDER);
-                }
-                else if (fbr > 0 && fbc > 0) {
-                    copy_rect(src, CDEF_BSTRIDE,
-                        &linebuf[pli][coffset - CDEF_HBORDER],
-                        stride, CDEF_VBORDER, CDEF_HBORDER);
-                }
-                else {
-                    fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, CDEF_HBORDER,
-                        CDEF_VERY_LARGE);
-                }
-
-                if (!prev_row_cdef[fbc + 1]) {
-                    copy_sb16_16(//cm,
-                        &src[CDEF_HBORDER + (nhb << mi_wide_l2[pli])],
-                        CDEF_BSTRIDE, rec_buff/*xd->plane[pli].dst.buf*/,
-                        (MI_SIZE_64X64 << mi_high_l2[pli])*fbr - CDEF_VBORDER,
-                        coffset + hsize, rec_stride/*xd->plane[pli].dst.stride*/,
-                        CDEF_VBORDER, CDEF_HBORDER);
-                }
-                else if (fbr > 0 && fbc < nhfb - 1) {
-                    copy_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                        &linebuf[pli][coffset + hsize], stride, CDEF_VBORDER,
-                        CDEF_HBORDER);
-                }
-                else {
-                    fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                        CDEF_VBORDER, CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
-
-                if (cdef_left) {
-                    /* If we deringed the superblock on the left
-                       then we need to copy in saved pixels. */
-                    copy_rect(src, CDEF_BSTRIDE, colbuf[pli], CDEF_HBORDER,
-                        rend + CDEF_VBORDER, CDEF_HBORDER);
-                }
-
-                /* Saving pixels in case we need to dering the superblock
-                    on the right. */
-                if (fbc < nhfb - 1)
-                    copy_rect(colbuf[pli], CDEF_HBORDER, src + hsize,
-                        CDEF_BSTRIDE, rend + CDEF_VBORDER, CDEF_HBORDER);
-
-                if (fbr < nvfb - 1)
-                    copy_sb16_16(&linebuf[pli][coffset], stride, rec_buff,
-                    (MI_SIZE_64X64 << mi_high_l2[pli]) *
-                        (fbr + 1) - CDEF_VBORDER,
-                        coffset, rec_stride, CDEF_VBORDER, hsize);
-
-                if (frame_top) {
-                    fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER,
-                        hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
-                if (frame_left) {
-                    fill_rect(src, CDEF_BSTRIDE, vsize + 2 * CDEF_VBORDER,
-                        CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
-                if (frame_bottom) {
-                    fill_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE],
-                        CDEF_BSTRIDE, CDEF_VBORDER,
-                        hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-                }
-                if (frame_right) {
-                    fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                        vsize + 2 * CDEF_VBORDER, CDEF_HBORDER,
-                        CDEF_VERY_LARGE);
-                }
-                /*Cdef filter calling function for HBD*/
-                eb_cdef_filter_fb(NULL, &rec_buff[rec_stride *
-                    (MI_SIZE_64X64 * fbr << mi_high_l2[pli])
-                    + (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
-                    rec_stride, &src[CDEF_VBORDER*CDEF_BSTRIDE + CDEF_HBORDER],
-                    xdec[pli], ydec[pli], dir, NULL, var, pli, dlist,
-                    cdef_count, level, sec_strength, pri_damping,
-                    sec_damping, coeff_shift);
-
-            }/*cdef plane loop ending*/
-            //CHKN filtered data is written back directy to recFrame.
-            cdef_left = 1;
-        }
-        uint8_t *tmp = prev_row_cdef;
-        prev_row_cdef = curr_row_cdef;
-        curr_row_cdef = tmp;
+                svt_cdef_fb(dec_handle, &row_ctxt, fbc);
+        }
+        uint8_t *tmp = row_ctxt.prev_row_cdef;
+        row_ctxt.prev_row_cdef = row_ctxt.curr_row_cdef;
+        row_ctxt.curr_row_cdef = tmp;
     }
     eb_aom_free(row_cdef);
     for (int32_t pli = 0; pli < num_planes; pli++) {
-        eb_aom_free(linebuf[pli]);
-        eb_aom_free(colbuf[pli]);
+        eb_aom_free(row_ctxt.curr_linebuf[pli]);
+        eb_aom_free(row_ctxt.colbuf[pli]);
     }
 }
+
+/*Frame level call, for CDEF 8 bit-depth*/
+void svt_cdef_frame(EbDecHandle *dec_handle) {
+    cdef_frame(dec_handle, 0);
+}
+
+/*Frame level call, for CDEF High bit-depth*/
+void svt_cdef_frame_hbd(EbDecHandle *dec_handle) {
+    cdef_frame(dec_handle, 1);
+}
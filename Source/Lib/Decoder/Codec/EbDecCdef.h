@@ -23,9 +23,34 @@
 extern "C" {
 #endif
 
+/* State carried from one 64x64 filter block to the next along a row, and
+   from one row to the next through the line buffers */
+typedef struct CdefRowCtxt {
+    /* Deblocked last lines of the row above, read by this row, and of this
+       row, saved for the row below. The same buffers when the rows are
+       filtered in order */
+    uint16_t    *prev_linebuf[MAX_MB_PLANE];
+    uint16_t    *curr_linebuf[MAX_MB_PLANE];
+    /* Deblocked right columns of the previous filter block */
+    uint16_t    *colbuf[MAX_MB_PLANE];
+    /* Filtered flags of the blocks of the row above and of this row, valid
+       from index -1 to the number of blocks in a row */
+    uint8_t     *prev_row_cdef;
+    uint8_t     *curr_row_cdef;
+    int32_t     linebuf_stride;
+    int32_t     fbr;
+    int32_t     cdef_left;
+} CdefRowCtxt;
+
 void svt_cdef_frame(EbDecHandle *dec_handle);
 void svt_cdef_frame_hbd(EbDecHandle *dec_handle);
 
+void svt_cdef_row_start(EbDecHandle *dec_handle, CdefRowCtxt *row_ctxt,
+                        int32_t fbr);
+void svt_cdef_fb(EbDecHandle *dec_handle, CdefRowCtxt *row_ctxt, int32_t fbc);
+void svt_cdef_fb_hbd(EbDecHandle *dec_handle, CdefRowCtxt *row_ctxt,
+                     int32_t fbc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -18,9 +18,12 @@
 #include "EbDecHandle.h"
 #include "EbDecMemInit.h"
 #include "EbDecPicMgr.h"
+#include "grainSynthesis.h"
+#include "EbObuParse.h"
 
 #if defined(__linux__) || defined(__APPLE__)
 #include <pthread.h>
+#include <unistd.h>
 #include <errno.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -30,6 +33,10 @@
 # include <intrin.h>
 #endif
 
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
 #define RTCD_C
 #include "aom_dsp_rtcd.h"
 
@@ -52,12 +59,21 @@ uint32_t                         lib_malloc_count = 0;
 uint32_t                         lib_semaphore_count = 0;
 uint32_t                         lib_mutex_count = 0;
 
+/* Number of logical processors */
+static uint32_t get_num_processors(void) {
+#ifdef _WIN32
+    SYSTEM_INFO sysinfo;
+    GetSystemInfo(&sysinfo);
+    return sysinfo.dwNumberOfProcessors;
+#else
+    return sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
 void asmSetConvolveAsmTable(void);
 void init_intra_dc_predictors_c_internal(void);
 void asmSetConvolveHbdAsmTable(void);
 void init_intra_predictors_internal(void);
-EbErrorType decode_multiple_obu(EbDecHandle *dec_handle_ptr,
-                                uint8_t **data, size_t data_size);
 
 void SwitchToRealTime(){
 #if defined(__linux__) || defined(__APPLE__)
@@ -118,26 +134,531 @@ static EbErrorType eb_dec_handle_ctor(
     svt_dec_memory_map_index = &dec_handle_ptr->memory_map_index;
     svt_dec_lib_malloc_count = 0;
 
+    dec_handle_ptr->allocate_frame_buffer = NULL;
+    dec_handle_ptr->release_frame_buffer = NULL;
+    dec_handle_ptr->frame_buffer_priv = NULL;
+    memset(dec_handle_ptr->out_loans, 0, sizeof(dec_handle_ptr->out_loans));
+    dec_handle_ptr->mem_init_done = 0;
+    memset(&dec_handle_ptr->obu_stream, 0, sizeof(DecObuStream));
+
     return return_error;
 }
 
-/* Copy from recon buffer to out buffer! */
-int svt_dec_out_buf(
+/* Queue the picture of the last decoded frame for output. Takes over the
+   reference held on pic_buf */
+static void svt_dec_queue_out_pic(
     EbDecHandle         *dec_handle_ptr,
-    EbBufferHeaderType  *p_buffer)
+    EbDecPicBuf         *pic_buf)
 {
-    EbPictureBufferDesc *recon_picture_buf = dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf;
-    EbSvtIOFormat       *out_img = (EbSvtIOFormat*)p_buffer->p_buffer;
+    EbSvtAv1DecConfiguration *config = &dec_handle_ptr->dec_config;
+    int32_t queue_size = config->frame_threads;
+    DecOutPic *out_pic;
 
-    /* TODO: Should add logic for show_existing_frame */
     if (0 == dec_handle_ptr->show_frame) {
         assert(0 == dec_handle_ptr->show_existing_frame);
+        dec_pic_mgr_release_pic(pic_buf);
+        return;
+    }
+
+    /* Pictures the application did not fetch are dropped */
+    if (dec_handle_ptr->out_count == queue_size) {
+        out_pic = &dec_handle_ptr->out_queue[dec_handle_ptr->out_head];
+        dec_pic_mgr_release_pic(out_pic->pic_buf);
+        dec_handle_ptr->out_head = (dec_handle_ptr->out_head + 1) % queue_size;
+        dec_handle_ptr->out_count--;
+    }
+
+    out_pic = &dec_handle_ptr->out_queue[(dec_handle_ptr->out_head +
+        dec_handle_ptr->out_count) % queue_size];
+    out_pic->pic_buf = pic_buf;
+    out_pic->x = 0;
+    out_pic->y = 0;
+    out_pic->width = dec_handle_ptr->frame_header.frame_size.frame_width;
+    out_pic->height = dec_handle_ptr->frame_header.frame_size.frame_height;
+
+    /* Cropped to the region of interest, from even samples for the chroma */
+    if (config->region_width != 0 && config->region_height != 0) {
+        out_pic->x = (int32_t)AOMMIN(config->region_left,
+            (uint32_t)out_pic->width - 1) & ~1;
+        out_pic->y = (int32_t)AOMMIN(config->region_top,
+            (uint32_t)out_pic->height - 1) & ~1;
+        out_pic->width = (int32_t)AOMMIN(config->region_width,
+            (uint32_t)(out_pic->width - out_pic->x));
+        out_pic->height = (int32_t)AOMMIN(config->region_height,
+            (uint32_t)(out_pic->height - out_pic->y));
+    }
+    out_pic->film_grain_params = pic_buf->film_grain_params;
+    dec_handle_ptr->out_count++;
+}
+
+/* Ends the frame whose last OBU has just been decoded, or drops it after an
+   error, and updates the references. Returns the picture to output of a
+   decoded frame, with a reference held on it */
+static EbDecPicBuf *svt_dec_end_frame(
+    EbDecHandle         *dec_handle_ptr,
+    int32_t             frame_decoded)
+{
+    EbDecPicBuf *pic_buf = NULL;
+
+    /* Hold the picture of the frame across the reference update */
+    if (frame_decoded && dec_handle_ptr->cur_pic_buf[0] != NULL &&
+        dec_handle_ptr->cur_pic_buf[0]->ref_count > 0)
+    {
+        pic_buf = dec_handle_ptr->cur_pic_buf[0];
+        pic_buf->ref_count++;
+    }
+
+    dec_pic_mgr_update_ref_pic(dec_handle_ptr, frame_decoded,
+        dec_handle_ptr->frame_header.refresh_frame_flags);
+    return pic_buf;
+}
+
+/* Drops the frame whose tile groups stopped coming */
+static void svt_dec_drop_frame(
+    EbDecHandle         *dec_handle_ptr)
+{
+    if (dec_handle_ptr->seen_frame_header) {
+        dec_handle_ptr->seen_frame_header = 0;
+        svt_dec_end_frame(dec_handle_ptr, 0);
+    }
+}
+
+/* Size of the low overhead OBU starting data, 0 until all of it has been
+   received. Without obu_size the OBU ends with the data, once complete */
+static EbErrorType svt_dec_obu_size(
+    const uint8_t       *data,
+    size_t              data_size,
+    int32_t             complete,
+    size_t              *obu_size)
+{
+    size_t header_size, payload_size, length_size;
+
+    *obu_size = 0;
+    header_size = (data[0] & 0x04) ? 2 : 1;
+    if (!(data[0] & 0x02)) {
+        if (!complete)
+            return EB_Corrupt_Frame;
+        *obu_size = data_size;
+        return EB_ErrorNone;
+    }
+    if (data_size < header_size ||
+        !dec_read_leb128(data + header_size, data_size - header_size,
+                         &payload_size, &length_size))
+        return EB_ErrorNone;
+    if (payload_size <= data_size - header_size - length_size)
+        *obu_size = header_size + length_size + payload_size;
+    return EB_ErrorNone;
+}
+
+/* Decodes the OBUs of data received in full. *size_used is set to the bytes
+   decoded, the rest being the start of an OBU, or the OBUs after a frame
+   that filled the output queue with stall. When complete, the data ends
+   with an OBU that may have no obu_size. Frames are ended as their last OBU
+   is decoded : with out_pic_buf only the picture of the last one is kept
+   there, otherwise each one is queued for output */
+static EbErrorType svt_dec_decode_obus(
+    EbDecHandle         *dec_handle_ptr,
+    const uint8_t       *data,
+    size_t              data_size,
+    int32_t             complete,
+    int32_t             stall,
+    size_t              *size_used,
+    EbDecPicBuf         **out_pic_buf)
+{
+    DecObuStream    *stream = &dec_handle_ptr->obu_stream;
+    const uint8_t   *data_start = data;
+    const uint8_t   *data_end = data + data_size;
+    EbErrorType     status = EB_ErrorNone;
+    size_t          obu_size, unit_size, length, used;
+    int             frame_done;
+
+    while (data < data_end) {
+        size_t avail = data_end - data;
+
+        if (!dec_handle_ptr->dec_config.is_annex_b) {
+            /* Zero bytes are allowed after the last frame */
+            if (complete && data[0] == 0) {
+                data = data_end;
+                break;
+            }
+            status = svt_dec_obu_size(data, avail, complete, &obu_size);
+            if (status != EB_ErrorNone || obu_size == 0)
+                break;
+        }
+        else {
+            /* temporal_unit( temporal_unit_size ) */
+            if (stream->tu_left == 0) {
+                if (!dec_read_leb128(data, avail, &unit_size, &length))
+                    break;
+                stream->tu_left = unit_size;
+                data += length;
+                continue;
+            }
+            /* frame_unit( frame_unit_size ) */
+            if (stream->fu_left == 0) {
+                if (!dec_read_leb128(data, avail, &unit_size, &length))
+                    break;
+                if (length + unit_size > stream->tu_left) {
+                    status = EB_Corrupt_Frame;
+                    break;
+                }
+                stream->fu_left = unit_size;
+                stream->tu_left -= length;
+                data += length;
+                continue;
+            }
+            /* obu_length, then the OBU */
+            if (!dec_read_leb128(data, avail, &obu_size, &length))
+                break;
+            if (length + obu_size > stream->fu_left) {
+                status = EB_Corrupt_Frame;
+                break;
+            }
+            if (obu_size > avail - length)
+                break;
+            data += length;
+            stream->fu_left -= length + obu_size;
+            stream->tu_left -= length + obu_size;
+        }
+
+        status = decode_obu(dec_handle_ptr, data, obu_size, &used, &frame_done);
+        if (status == EB_ErrorNone && used != obu_size)
+            status = EB_Corrupt_Frame;
+        data += obu_size;
+        if (status != EB_ErrorNone)
+            break;
+
+        if (frame_done) {
+            EbDecPicBuf *pic_buf = svt_dec_end_frame(dec_handle_ptr, 1);
+            /* Neither the frames whose tiles were skipped nor the shown
+               frames before skip_frames are output */
+            if ((dec_handle_ptr->show_frame && dec_handle_ptr->shown_frame_cnt++ <
+                dec_handle_ptr->dec_config.skip_frames) ||
+                dec_handle_ptr->skip_frame)
+            {
+                dec_pic_mgr_release_pic(pic_buf);
+                pic_buf = NULL;
+            }
+            if (out_pic_buf != NULL) {
+                dec_pic_mgr_release_pic(*out_pic_buf);
+                *out_pic_buf = pic_buf;
+            }
+            else if (pic_buf != NULL) {
+                svt_dec_queue_out_pic(dec_handle_ptr, pic_buf);
+                /* Decoding more would drop pictures the application did
+                   not fetch yet */
+                if (stall && dec_handle_ptr->out_count ==
+                    (int32_t)dec_handle_ptr->dec_config.frame_threads)
+                    break;
+            }
+        }
+    }
+
+    if (status != EB_ErrorNone)
+        svt_dec_drop_frame(dec_handle_ptr);
+    *size_used = data - data_start;
+    return status;
+}
+
+/* Forgets the received data, after an error or at the end of the stream */
+static void svt_dec_reset_stream(
+    DecObuStream        *stream)
+{
+    stream->size = 0;
+    stream->tu_left = 0;
+    stream->fu_left = 0;
+}
+
+/* Whether the output queue is full, so that decoding waits for
+   eb_svt_dec_get_picture() */
+static int32_t svt_dec_out_full(
+    EbDecHandle         *dec_handle_ptr)
+{
+    return dec_handle_ptr->out_count ==
+        (int32_t)dec_handle_ptr->dec_config.frame_threads;
+}
+
+/* Decodes the OBUs completed by data, after the ones received before. The
+   rest is kept for the next call */
+static EbErrorType svt_dec_stream(
+    EbDecHandle         *dec_handle_ptr,
+    const uint8_t       *data,
+    size_t              data_size)
+{
+    DecObuStream    *stream = &dec_handle_ptr->obu_stream;
+    EbErrorType     status = EB_ErrorNone;
+    size_t          used;
+
+    /* Nothing kept : decoded in place, only the rest is copied */
+    if (stream->size == 0 && !svt_dec_out_full(dec_handle_ptr)) {
+        status = svt_dec_decode_obus(dec_handle_ptr, data, data_size, 0, 1,
+            &used, NULL);
+        if (status != EB_ErrorNone) {
+            svt_dec_reset_stream(stream);
+            return status;
+        }
+        data += used;
+        data_size -= used;
+        if (data_size == 0)
+            return status;
+    }
+
+    if (stream->size + data_size > stream->alloc) {
+        size_t alloc = MAX(2 * stream->alloc, stream->size + data_size);
+        uint8_t *stream_data = (uint8_t *)realloc(stream->data, alloc);
+        if (stream_data == NULL)
+            return EB_ErrorInsufficientResources;
+        stream->data = stream_data;
+        stream->alloc = alloc;
+    }
+    if (data_size > 0)
+        memcpy(stream->data + stream->size, data, data_size);
+    stream->size += data_size;
+
+    if (svt_dec_out_full(dec_handle_ptr))
+        return status;
+
+    status = svt_dec_decode_obus(dec_handle_ptr, stream->data, stream->size,
+        0, 1, &used, NULL);
+    if (status != EB_ErrorNone) {
+        svt_dec_reset_stream(stream);
+        return status;
+    }
+    memmove(stream->data, stream->data + used, stream->size - used);
+    stream->size -= used;
+    return status;
+}
+
+/* End of the OBUs : an incomplete OBU left is dropped once the ones before
+   it are decoded, then the frames in flight are finished */
+static EbErrorType svt_dec_end_stream(
+    EbDecHandle         *dec_handle_ptr)
+{
+    DecObuStream    *stream = &dec_handle_ptr->obu_stream;
+    EbErrorType     status = EB_ErrorNone;
+
+    status = svt_dec_stream(dec_handle_ptr, NULL, 0);
+    if (status != EB_ErrorNone || svt_dec_out_full(dec_handle_ptr))
+        return status;
+
+    if (stream->size > 0 || stream->tu_left > 0 ||
+        dec_handle_ptr->seen_frame_header)
+        status = EB_Corrupt_Frame;
+    svt_dec_reset_stream(stream);
+    svt_dec_drop_frame(dec_handle_ptr);
+
+    EbErrorType mt_status = dec_frame_mt_flush(dec_handle_ptr);
+    return status != EB_ErrorNone ? status : mt_status;
+}
+
+/* Errors of the frames decoded by frame threads */
+static EbErrorType svt_dec_frame_mt_status(
+    EbDecHandle         *dec_handle_ptr,
+    EbErrorType         return_error)
+{
+    DecFrameMtCtxt *frame_mt_ctxt = (DecFrameMtCtxt *)dec_handle_ptr->pv_frame_mt_ctxt;
+    if (frame_mt_ctxt != NULL && return_error == EB_ErrorNone) {
+        return_error = frame_mt_ctxt->status;
+        frame_mt_ctxt->status = EB_ErrorNone;
+    }
+    return return_error;
+}
+
+/* Free entry to lend a picture with, NULL when the application holds
+   DEC_MAX_OUT_LOANS of them */
+static DecOutLoan *svt_dec_free_out_loan(
+    EbDecHandle         *dec_handle_ptr)
+{
+    for (int32_t i = 0; i < DEC_MAX_OUT_LOANS; i++) {
+        if (!dec_handle_ptr->out_loans[i].busy)
+            return &dec_handle_ptr->out_loans[i];
+    }
+    return NULL;
+}
+
+/* Ends the loan of a picture returned by reference */
+static void svt_dec_end_out_loan(
+    DecOutLoan          *loan)
+{
+    if (loan->pic_buf != NULL) {
+        dec_pic_mgr_release_pic(loan->pic_buf);
+        loan->pic_buf = NULL;
+    }
+    loan->busy = 0;
+}
+
+/* Sample (x, y) of the visible area in each plane of pic, x and y even */
+static void svt_dec_pic_planes(
+    EbPictureBufferDesc *pic,
+    int32_t             x,
+    int32_t             y,
+    uint8_t             **luma,
+    uint8_t             **cb,
+    uint8_t             **cr)
+{
+    int shift = (pic->bit_depth == EB_8BIT) ? 0 : 1;
+
+    x += pic->origin_x;
+    y += pic->origin_y;
+    *luma = pic->buffer_y + ((x + y * pic->stride_y) << shift);
+    *cb = pic->buffer_cb + (((x >> 1) + (y >> 1) * pic->stride_cb) << shift);
+    *cr = pic->buffer_cr + (((x >> 1) + (y >> 1) * pic->stride_cr) << shift);
+}
+
+/* Film grain to add to the output picture, NULL when there is none */
+static aom_film_grain_t *svt_dec_out_grain(
+    EbDecHandle         *dec_handle_ptr,
+    DecOutPic           *out_pic)
+{
+    if (dec_handle_ptr->dec_config.skip_film_grain ||
+        !out_pic->film_grain_params.apply_grain)
+        return NULL;
+
+    out_pic->film_grain_params.bit_depth =
+        (int32_t)out_pic->pic_buf->ps_pic_buf->bit_depth;
+    return &out_pic->film_grain_params;
+}
+
+/* With the application's frame buffer allocator : picture of loan from the
+   allocator the grain is written to, allocated for the largest frame of
+   the sequence */
+static EbErrorType svt_dec_get_grain_pic(
+    EbDecHandle         *dec_handle_ptr,
+    DecOutLoan          *loan,
+    EbPictureBufferDesc *recon_picture_buf)
+{
+    SeqHeader   *seq_header = &dec_handle_ptr->seq_header;
+    size_t y_size = (size_t)(seq_header->max_frame_width + 2 * PAD_VALUE) *
+        (seq_header->max_frame_height + 2 * PAD_VALUE);
+    size_t pic_size = y_size + (y_size >> 1);
+
+    if (loan->grain_pic != NULL &&
+        loan->grain_pic_size >= pic_size &&
+        loan->grain_pic->bit_depth == recon_picture_buf->bit_depth)
+        return EB_ErrorNone;
+
+    EbExtFrameBuf *ext_frame_buf = &loan->grain_frame_buf;
+    if (ext_frame_buf->buffer != NULL) {
+        dec_handle_ptr->release_frame_buffer(ext_frame_buf,
+            dec_handle_ptr->frame_buffer_priv);
+        ext_frame_buf->buffer = NULL;
+    }
+    loan->grain_pic = NULL;
+    loan->grain_pic_size = 0;
+
+    EbPictureBufferDescInitData input_picture_buffer_desc_init_data;
+    input_picture_buffer_desc_init_data.max_width = seq_header->max_frame_width;
+    input_picture_buffer_desc_init_data.max_height = seq_header->max_frame_height;
+    input_picture_buffer_desc_init_data.bit_depth = recon_picture_buf->bit_depth;
+    input_picture_buffer_desc_init_data.color_format =
+        recon_picture_buf->color_format;
+    input_picture_buffer_desc_init_data.buffer_enable_mask =
+        PICTURE_BUFFER_DESC_FULL_MASK;
+    input_picture_buffer_desc_init_data.left_padding = PAD_VALUE;
+    input_picture_buffer_desc_init_data.right_padding = PAD_VALUE;
+    input_picture_buffer_desc_init_data.top_padding = PAD_VALUE;
+    input_picture_buffer_desc_init_data.bot_padding = PAD_VALUE;
+    input_picture_buffer_desc_init_data.split_mode = EB_FALSE;
+
+    EbPictureBufferDesc *grain_pic = NULL;
+    EbErrorType return_error = dec_eb_ext_picture_buffer_desc_ctor(
+        (EbPtr*)&grain_pic, (EbPtr)&input_picture_buffer_desc_init_data,
+        dec_handle_ptr->allocate_frame_buffer,
+        dec_handle_ptr->frame_buffer_priv, ext_frame_buf);
+    if (return_error != EB_ErrorNone)
+        return return_error;
+
+    loan->grain_pic = grain_pic;
+    loan->grain_pic_size = pic_size;
+    return EB_ErrorNone;
+}
+
+/* Copy from recon buffer to out buffer! Frame threads keep up to
+   frame_threads pictures queued, until the end of the stream. With the
+   application's frame buffer allocator the recon buffer is returned by
+   reference instead, lent until eb_svt_dec_release_out_buffer(). Film
+   grain is added while writing the output, the recon buffer is left as it
+   is for the frames referencing it : with the allocator the grain goes to
+   a separate picture returned by reference */
+int svt_dec_out_buf(
+    EbDecHandle         *dec_handle_ptr,
+    EbBufferHeaderType  *p_buffer)
+{
+    int32_t queue_size = dec_handle_ptr->dec_config.frame_threads;
+    DecOutLoan *loan = NULL;
+
+    if (dec_handle_ptr->out_count == 0 ||
+        (dec_handle_ptr->out_count < queue_size && !dec_handle_ptr->eos))
         return 0;
+
+    /* The pictures lent are bounded, so that the pool never runs dry */
+    if (dec_handle_ptr->allocate_frame_buffer != NULL) {
+        loan = svt_dec_free_out_loan(dec_handle_ptr);
+        if (loan == NULL)
+            return 0;
     }
+    p_buffer->wrapper_ptr = loan;
 
-    int wd = dec_handle_ptr->frame_header.frame_size.frame_width;
-    int ht = dec_handle_ptr->frame_header.frame_size.frame_height;
+    DecOutPic           *out_pic = &dec_handle_ptr->out_queue[dec_handle_ptr->out_head];
+    EbPictureBufferDesc *recon_picture_buf = out_pic->pic_buf->ps_pic_buf;
+    EbSvtIOFormat       *out_img = (EbSvtIOFormat*)p_buffer->p_buffer;
+
+    dec_pic_wait_rows(out_pic->pic_buf, -1, -1);
+
+    int x0 = out_pic->x;
+    int y0 = out_pic->y;
+    int wd = out_pic->width;
+    int ht = out_pic->height;
     int i, sx, sy;
+    aom_film_grain_t *grain_params = svt_dec_out_grain(dec_handle_ptr, out_pic);
+
+    if (loan != NULL) {
+        EbPictureBufferDesc *out_picture_buf = recon_picture_buf;
+        void *p_app_private = out_pic->pic_buf->ext_frame_buf.private_data;
+
+        /* Without a grain picture the recon is output without grain */
+        if (grain_params != NULL &&
+            svt_dec_get_grain_pic(dec_handle_ptr, loan, recon_picture_buf) ==
+            EB_ErrorNone)
+        {
+            uint8_t *src_y, *src_cb, *src_cr, *dst_y, *dst_cb, *dst_cr;
+
+            out_picture_buf = loan->grain_pic;
+            svt_dec_pic_planes(recon_picture_buf, x0, y0, &src_y, &src_cb,
+                &src_cr);
+            svt_dec_pic_planes(out_picture_buf, x0, y0, &dst_y, &dst_cb,
+                &dst_cr);
+            assert(recon_picture_buf->stride_cb == recon_picture_buf->stride_cr);
+            eb_av1_add_film_grain_copy(grain_params, src_y, src_cb, src_cr,
+                recon_picture_buf->stride_y, recon_picture_buf->stride_cb,
+                dst_y, dst_cb, dst_cr, out_picture_buf->stride_y,
+                out_picture_buf->stride_cb, ht, wd,
+                recon_picture_buf->bit_depth != EB_8BIT, 1, 1);
+            p_app_private = loan->grain_frame_buf.private_data;
+        }
+
+        svt_dec_pic_planes(out_picture_buf, x0, y0, &out_img->luma,
+            &out_img->cb, &out_img->cr);
+        out_img->y_stride = out_picture_buf->stride_y;
+        out_img->cb_stride = out_picture_buf->stride_cb;
+        out_img->cr_stride = out_picture_buf->stride_cr;
+        out_img->width = wd;
+        out_img->height = ht;
+        out_img->origin_x = 0;
+        out_img->origin_y = 0;
+        p_buffer->p_app_private = p_app_private;
+
+        /* The reference of the output queue is lent to the application,
+           unless the grain picture is lent instead */
+        if (out_picture_buf == recon_picture_buf)
+            loan->pic_buf = out_pic->pic_buf;
+        else
+            dec_pic_mgr_release_pic(out_pic->pic_buf);
+        loan->busy = 1;
+        dec_handle_ptr->out_head = (dec_handle_ptr->out_head + 1) % queue_size;
+        dec_handle_ptr->out_count--;
+        return 1;
+    }
 
     switch (recon_picture_buf->color_format) {
         case EB_YUV420 :
@@ -148,15 +669,33 @@ int svt_dec_out_buf(
             assert(0);
     }
 
-    if (recon_picture_buf->bit_depth == EB_8BIT) {
+    if (grain_params != NULL) {
+        int shift = (recon_picture_buf->bit_depth == EB_8BIT) ? 0 : 1;
+        uint8_t *src_y, *src_cb, *src_cr;
+
+        svt_dec_pic_planes(recon_picture_buf, x0, y0, &src_y, &src_cb,
+            &src_cr);
+        assert(recon_picture_buf->stride_cb == recon_picture_buf->stride_cr);
+        assert(out_img->cb_stride == out_img->cr_stride);
+        eb_av1_add_film_grain_copy(grain_params, src_y, src_cb, src_cr,
+            recon_picture_buf->stride_y, recon_picture_buf->stride_cb,
+            out_img->luma + ((out_img->origin_x +
+            out_img->origin_y * out_img->y_stride) << shift),
+            out_img->cb + (((out_img->origin_x >> sx) +
+            (out_img->origin_y >> sy) * out_img->cb_stride) << shift),
+            out_img->cr + (((out_img->origin_x >> sx) +
+            (out_img->origin_y >> sy) * out_img->cr_stride) << shift),
+            out_img->y_stride, out_img->cb_stride, ht, wd, shift, sy, sx);
+    }
+    else if (recon_picture_buf->bit_depth == EB_8BIT) {
     uint8_t *dst;
     uint8_t *src;
 
     /* Luma */
     dst = out_img->luma + out_img->origin_x +
             (out_img->origin_y * out_img->y_stride);
-    src = recon_picture_buf->buffer_y + recon_picture_buf->origin_x +
-        (recon_picture_buf->origin_y * recon_picture_buf->stride_y);
+    src = recon_picture_buf->buffer_y + recon_picture_buf->origin_x + x0 +
+        ((recon_picture_buf->origin_y + y0) * recon_picture_buf->stride_y);
 
     for (i = 0; i < ht; i++) {
         memcpy(dst, src, wd);
@@ -167,8 +706,8 @@ int svt_dec_out_buf(
     /* Cb */
         dst = out_img->cb + (out_img->origin_x >> sx) +
             ((out_img->origin_y >> sy) * out_img->cb_stride);
-        src = recon_picture_buf->buffer_cb + (recon_picture_buf->origin_x >> sx) +
-            ((recon_picture_buf->origin_y >> sy) * recon_picture_buf->stride_cb);
+        src = recon_picture_buf->buffer_cb + ((recon_picture_buf->origin_x + x0) >> sx) +
+            (((recon_picture_buf->origin_y + y0) >> sy) * recon_picture_buf->stride_cb);
 
         for (i = 0; i < ht >> sy; i++) {
             memcpy(dst, src, wd >> sx);
@@ -179,8 +718,8 @@ int svt_dec_out_buf(
     /* Cr */
         dst = out_img->cr + (out_img->origin_x >> sx) +
             ((out_img->origin_y >> sy) * out_img->cr_stride);
-        src = recon_picture_buf->buffer_cr + (recon_picture_buf->origin_x >> sx) +
-            ((recon_picture_buf->origin_y >> sy)* recon_picture_buf->stride_cr);
+        src = recon_picture_buf->buffer_cr + ((recon_picture_buf->origin_x + x0) >> sx) +
+            (((recon_picture_buf->origin_y + y0) >> sy)* recon_picture_buf->stride_cr);
 
         for (i = 0; i < ht >> sy; i++) {
             memcpy(dst, src, wd >> sx);
@@ -194,8 +733,8 @@ int svt_dec_out_buf(
         /* Luma */
         pu2_dst = (uint16_t *)out_img->luma + out_img->origin_x +
                 (out_img->origin_y * out_img->y_stride);
-        pu2_src = (uint16_t *)recon_picture_buf->buffer_y + recon_picture_buf->origin_x +
-            (recon_picture_buf->origin_y * recon_picture_buf->stride_y);
+        pu2_src = (uint16_t *)recon_picture_buf->buffer_y + recon_picture_buf->origin_x + x0 +
+            ((recon_picture_buf->origin_y + y0) * recon_picture_buf->stride_y);
 
         for (i = 0; i < ht; i++) {
             memcpy(pu2_dst, pu2_src, sizeof(uint16_t) * wd);
@@ -206,8 +745,8 @@ int svt_dec_out_buf(
         /* Cb */
         pu2_dst = (uint16_t *)out_img->cb + (out_img->origin_x >> sx) +
             ((out_img->origin_y >> sy) * out_img->cb_stride);
-        pu2_src = (uint16_t *)recon_picture_buf->buffer_cb + (recon_picture_buf->origin_x >> sx) +
-            ((recon_picture_buf->origin_y >> sy) * recon_picture_buf->stride_cb);
+        pu2_src = (uint16_t *)recon_picture_buf->buffer_cb + ((recon_picture_buf->origin_x + x0) >> sx) +
+            (((recon_picture_buf->origin_y + y0) >> sy) * recon_picture_buf->stride_cb);
 
         for (i = 0; i < ht >> sy; i++) {
             memcpy(pu2_dst, pu2_src, sizeof(uint16_t) * wd >> sx);
@@ -218,8 +757,8 @@ int svt_dec_out_buf(
         /* Cr */
         pu2_dst = (uint16_t *)out_img->cr + (out_img->origin_x >> sx) +
             ((out_img->origin_y >> sy) * out_img->cr_stride);
-        pu2_src = (uint16_t *)recon_picture_buf->buffer_cr + (recon_picture_buf->origin_x >> sx) +
-            ((recon_picture_buf->origin_y >> sy)* recon_picture_buf->stride_cr);
+        pu2_src = (uint16_t *)recon_picture_buf->buffer_cr + ((recon_picture_buf->origin_x + x0) >> sx) +
+            (((recon_picture_buf->origin_y + y0) >> sy)* recon_picture_buf->stride_cr);
 
         for (i = 0; i < ht >> sy; i++) {
             memcpy(pu2_dst, pu2_src, sizeof(uint16_t) * wd >> sx);
@@ -227,6 +766,10 @@ int svt_dec_out_buf(
             pu2_src += recon_picture_buf->stride_cr;
         }
     }
+
+    dec_pic_mgr_release_pic(out_pic->pic_buf);
+    dec_handle_ptr->out_head = (dec_handle_ptr->out_head + 1) % queue_size;
+    dec_handle_ptr->out_count--;
     return 1;
 }
 
@@ -246,6 +789,12 @@ EbErrorType eb_svt_dec_set_default_parameter(
     config_ptr->skip_film_grain = 0;
     config_ptr->skip_frames = 0;
     config_ptr->frames_to_be_decoded = 0;
+    config_ptr->skip_non_ref_frames = EB_FALSE;
+    config_ptr->skip_non_ref_filters = EB_FALSE;
+    config_ptr->region_left = 0;
+    config_ptr->region_top = 0;
+    config_ptr->region_width = 0;
+    config_ptr->region_height = 0;
     config_ptr->compressed_ten_bit_format = 0;
     config_ptr->eight_bit_output = 0;
 
@@ -256,6 +805,9 @@ EbErrorType eb_svt_dec_set_default_parameter(
     config_ptr->max_color_format = EB_YUV420;
     config_ptr->asm_type = 0;
     config_ptr->threads = 1;
+    config_ptr->frame_threads = 1;
+    config_ptr->pipeline_recon = EB_FALSE;
+    config_ptr->is_annex_b = EB_FALSE;
 
     // Application Specific parameters
     config_ptr->channel_id = 0;
@@ -382,6 +934,23 @@ EB_API EbErrorType eb_init_decoder(
     dec_handle_ptr->show_existing_frame = 0;
     dec_handle_ptr->show_frame          = 0;
     dec_handle_ptr->showable_frame      = 0;
+    dec_handle_ptr->skip_frame          = 0;
+    dec_handle_ptr->shown_frame_cnt     = 0;
+
+    /* 0 : one tile worker per logical processor */
+    if (dec_handle_ptr->dec_config.threads == 0)
+        dec_handle_ptr->dec_config.threads = get_num_processors();
+    dec_handle_ptr->pv_tile_mt_ctxt = NULL;
+
+    if (dec_handle_ptr->dec_config.frame_threads < 1)
+        dec_handle_ptr->dec_config.frame_threads = 1;
+    if (dec_handle_ptr->dec_config.frame_threads > DEC_MAX_FRAME_THREADS)
+        dec_handle_ptr->dec_config.frame_threads = DEC_MAX_FRAME_THREADS;
+    dec_handle_ptr->pv_frame_mt_ctxt = NULL;
+    dec_handle_ptr->cur_pic_buf[0] = NULL;
+    dec_handle_ptr->out_head = 0;
+    dec_handle_ptr->out_count = 0;
+    dec_handle_ptr->eos = 0;
 
     dec_handle_ptr->dec_config.asm_type = get_cpu_asm_type();
     setup_rtcd_internal(dec_handle_ptr->dec_config.asm_type);
@@ -416,34 +985,95 @@ EB_API EbErrorType eb_svt_decode_frame(
         return EB_ErrorBadParameter;
 
     EbDecHandle *dec_handle_ptr = (EbDecHandle *)svt_dec_component->p_component_private;
-    uint8_t *data_start = (uint8_t *)data;
-    uint8_t *data_end = (uint8_t *)data + data_size;
+    EbDecPicBuf *out_pic_buf = NULL;
+    size_t used;
 
-    while (data_start < data_end)
+    /* End of stream : the queued pictures are output without delay */
+    if (data == NULL || data_size == 0) {
+        dec_handle_ptr->eos = 1;
+        return dec_frame_mt_flush(dec_handle_ptr);
+    }
+    dec_handle_ptr->eos = 0;
+
+    /* The frames of data, in Annex B one temporal unit */
+    svt_dec_reset_stream(&dec_handle_ptr->obu_stream);
+    return_error = svt_dec_decode_obus(dec_handle_ptr, data, data_size, 1, 0,
+        &used, &out_pic_buf);
+    if (return_error == EB_ErrorNone && (used < data_size ||
+        dec_handle_ptr->obu_stream.tu_left > 0))
     {
-        /*TODO : Remove or move. For Test purpose only */
-        dec_handle_ptr->dec_cnt++;
-        //printf("\n SVT-AV1 Dec : Decoding Pic #%d", dec_handle_ptr->dec_cnt);
+        svt_dec_drop_frame(dec_handle_ptr);
+        return_error = EB_Corrupt_Frame;
+    }
+    svt_dec_reset_stream(&dec_handle_ptr->obu_stream);
 
-        uint64_t frame_size = 0;
-        /*if (ctx->is_annexb) {
-        }
-        else*/
-        frame_size = data_end - data_start;
-        return_error = decode_multiple_obu(dec_handle_ptr, &data_start, frame_size);
-
-        dec_pic_mgr_update_ref_pic(dec_handle_ptr, (EB_ErrorNone == return_error)
-                    ? 1 : 0, dec_handle_ptr->frame_header.refresh_frame_flags);
-
-        // Allow extra zero bytes after the frame end
-        while (data < data_end) {
-            const uint8_t marker = data[0];
-            if (marker) break;
-            ++data;
-        }
+    if (out_pic_buf != NULL)
+        svt_dec_queue_out_pic(dec_handle_ptr, out_pic_buf);
+
+    return svt_dec_frame_mt_status(dec_handle_ptr, return_error);
+}
+
+#if defined(__linux__) || defined(__APPLE__)
+__attribute__((visibility("default")))
+#endif
+EB_API EbErrorType eb_svt_decode_obu(
+    EbComponentType     *svt_dec_component,
+    const uint8_t       *data,
+    const uint32_t       data_size)
+{
+    EbErrorType return_error;
+    if (svt_dec_component == NULL)
+        return EB_ErrorBadParameter;
+
+    EbDecHandle *dec_handle_ptr = (EbDecHandle *)svt_dec_component->p_component_private;
+
+    if (data == NULL || data_size == 0) {
+        dec_handle_ptr->eos = 1;
+        return_error = svt_dec_end_stream(dec_handle_ptr);
+    }
+    else {
+        dec_handle_ptr->eos = 0;
+        return_error = svt_dec_stream(dec_handle_ptr, data, data_size);
     }
 
-    return return_error;
+    return svt_dec_frame_mt_status(dec_handle_ptr, return_error);
+}
+
+#if defined(__linux__) || defined(__APPLE__)
+__attribute__((visibility("default")))
+#endif
+EB_API EbErrorType eb_svt_decode_tu(
+    EbComponentType     *svt_dec_component,
+    const uint8_t       *data,
+    const uint32_t       data_size)
+{
+    EbErrorType return_error = EB_ErrorNone;
+    if (svt_dec_component == NULL)
+        return EB_ErrorBadParameter;
+
+    EbDecHandle *dec_handle_ptr = (EbDecHandle *)svt_dec_component->p_component_private;
+    size_t used;
+
+    if (data == NULL || data_size == 0) {
+        dec_handle_ptr->eos = 1;
+        return dec_frame_mt_flush(dec_handle_ptr);
+    }
+    dec_handle_ptr->eos = 0;
+
+    /* Each shown frame of the unit is queued for output */
+    svt_dec_reset_stream(&dec_handle_ptr->obu_stream);
+    return_error = svt_dec_decode_obus(dec_handle_ptr, data, data_size, 1, 0,
+        &used, NULL);
+    if (return_error == EB_ErrorNone && (used < data_size ||
+        dec_handle_ptr->obu_stream.tu_left > 0 ||
+        dec_handle_ptr->seen_frame_header))
+    {
+        svt_dec_drop_frame(dec_handle_ptr);
+        return_error = EB_Corrupt_Frame;
+    }
+    svt_dec_reset_stream(&dec_handle_ptr->obu_stream);
+
+    return svt_dec_frame_mt_status(dec_handle_ptr, return_error);
 }
 
 #if defined(__linux__) || defined(__APPLE__)
@@ -465,10 +1095,33 @@ EB_API EbErrorType eb_svt_dec_get_picture(
     EbDecHandle     *dec_handle_ptr = (EbDecHandle   *)svt_dec_component->p_component_private;
     /* Copy from recon pointer and return! TODO: Should remove the memcpy! */
     if (0 == svt_dec_out_buf(dec_handle_ptr, p_buffer))
-        return_error = EB_DecNoOutputPicture;
+        return EB_DecNoOutputPicture;
+
+    /* eb_svt_decode_obu() stopped at a full output queue : the OBUs it kept
+       are decoded into the free entry. Their errors were the data's own, so
+       they only drop the frame */
+    DecObuStream *stream = &dec_handle_ptr->obu_stream;
+    if (stream->size > 0) {
+        if (dec_handle_ptr->eos)
+            svt_dec_end_stream(dec_handle_ptr);
+        else
+            svt_dec_stream(dec_handle_ptr, NULL, 0);
+    }
     return return_error;
 }
 
+#if defined(__linux__) || defined(__APPLE__)
+__attribute__((visibility("default")))
+#endif
+EB_API void eb_svt_dec_release_out_buffer(
+    EbBufferHeaderType   *p_buffer)
+{
+    if (p_buffer && p_buffer->wrapper_ptr) {
+        svt_dec_end_out_loan((DecOutLoan *)p_buffer->wrapper_ptr);
+        p_buffer->wrapper_ptr = NULL;
+    }
+}
+
 #if defined(__linux__) || defined(__APPLE__)
 __attribute__((visibility("default")))
 #endif
@@ -480,6 +1133,27 @@ EB_API EbErrorType eb_deinit_decoder(
     EbDecHandle *dec_handle_ptr = (EbDecHandle*)svt_dec_component->p_component_private;
     EbErrorType return_error    = EB_ErrorNone;
 
+    /* No frame thread may run while its memory is released */
+    if (dec_handle_ptr && dec_handle_ptr->mem_init_done) {
+        dec_frame_mt_flush(dec_handle_ptr);
+        /* Also the pictures the application still holds */
+        for (int32_t i = 0; i < DEC_MAX_OUT_LOANS; i++) {
+            DecOutLoan *loan = &dec_handle_ptr->out_loans[i];
+            svt_dec_end_out_loan(loan);
+            if (loan->grain_frame_buf.buffer != NULL) {
+                dec_handle_ptr->release_frame_buffer(&loan->grain_frame_buf,
+                    dec_handle_ptr->frame_buffer_priv);
+                loan->grain_frame_buf.buffer = NULL;
+            }
+        }
+        dec_pic_mgr_release_ext_frame_bufs(
+            (EbDecPicMgr *)dec_handle_ptr->pv_pic_mgr);
+    }
+    if (dec_handle_ptr) {
+        free(dec_handle_ptr->obu_stream.data);
+        memset(&dec_handle_ptr->obu_stream, 0, sizeof(DecObuStream));
+    }
+
     if (dec_handle_ptr) {
         if (svt_dec_memory_map) {
             // Loop through the ptr table and free all malloc'd pointers per channel
@@ -562,10 +1236,20 @@ EB_API EbErrorType eb_dec_set_frame_buffer_callbacks(
   eb_release_frame_buffer     release_buffer,
   void                        *priv_data)
 {
-    (void)svt_dec_component;
-    (void)allocate_buffer;
-    (void)release_buffer;
-    (void)priv_data;
+    if (svt_dec_component == NULL)
+        return EB_ErrorBadParameter;
+
+    EbDecHandle *dec_handle_ptr = (EbDecHandle *)svt_dec_component->p_component_private;
+
+    /* Both or none, and before the pictures are allocated at the first
+       sequence header */
+    if ((allocate_buffer == NULL) != (release_buffer == NULL) ||
+        dec_handle_ptr->mem_init_done)
+        return EB_ErrorBadParameter;
+
+    dec_handle_ptr->allocate_frame_buffer = allocate_buffer;
+    dec_handle_ptr->release_frame_buffer = release_buffer;
+    dec_handle_ptr->frame_buffer_priv = priv_data;
 
     return EB_ErrorNone;
 }
@@ -21,13 +21,25 @@
 extern "C" {
 #endif
 
+#include "EbSvtAv1ExtFrameBuf.h"
 #include "EbDecStruct.h"
 #include "EbDecBlock.h"
 
 /* Maximum number of frames in parallel */
 #define DEC_MAX_NUM_FRM_PRLL    1
-/** Maximum picture buffers needed **/
-#define MAX_PIC_BUFS (REF_FRAMES + 1 + DEC_MAX_NUM_FRM_PRLL)
+/* Maximum number of frame threads (frames decoded concurrently) */
+#define DEC_MAX_FRAME_THREADS   8
+/* Maximum number of pictures lent to the application at once */
+#define DEC_MAX_OUT_LOANS       EB_DEC_MAX_OUT_BUFFERS
+/** Maximum picture buffers needed. Each frame thread holds its current
+    picture and the references it was started with, each queued output
+    picture holds one more, and so does each picture lent to the
+    application **/
+#define MAX_PIC_BUFS (REF_FRAMES + 1 + DEC_MAX_NUM_FRM_PRLL + \
+                      3 * DEC_MAX_FRAME_THREADS + DEC_MAX_OUT_LOANS)
+
+/* Row progress of a picture once all its rows and borders are final */
+#define DEC_PIC_ROWS_COMPLETE   INT32_MAX
 
 /*Optimisation of Coeff Buffer in Single Thread*/
 #define SINGLE_THRD_COEFF_BUF_OPT   1
@@ -46,6 +58,9 @@ typedef struct EbDecPicBuf {
     FrameType           frame_type;
 
     EbPictureBufferDesc *ps_pic_buf;
+    /* Size of the frame decoded in the picture, the buffer may be larger */
+    uint16_t            frame_width;
+    uint16_t            frame_height;
 
     FRAME_CONTEXT       final_frm_ctx;
 
@@ -53,9 +68,26 @@ typedef struct EbDecPicBuf {
 
     /* MV at 8x8 lvl */
     TemporalMvRef       *mvs;
+
+    /* Frame threading : number of final luma rows, published per SB row.
+       The top and bottom borders are final only with DEC_PIC_ROWS_COMPLETE */
+    volatile int32_t    row_progress;
+    /* Frame threading : all tiles parsed, final_frm_ctx and mvs available */
+    volatile int32_t    parse_done;
+    /* NULL without frame threading */
+    EbHandle            progress_mutex;
+    EbHandle            progress_semaphore;
+    int32_t             num_progress_waiters;
+
+    /* Application buffer holding the planes, buffer is NULL when they are
+       allocated by the decoder */
+    EbExtFrameBuf       ext_frame_buf;
+
     /* seg map */
     /* order hint */
-    /* film grain */
+    /* Film grain of the frame, loaded by later frames and by a shown
+       existing frame */
+    aom_film_grain_t    film_grain_params;
 
 } EbDecPicBuf;
 
@@ -131,6 +163,43 @@ typedef struct MasterFrameBuf {
 
 } MasterFrameBuf;
 
+/* Shown picture waiting for eb_svt_dec_get_picture */
+typedef struct DecOutPic {
+    EbDecPicBuf     *pic_buf;
+    /* Output area of the picture, the region of interest when there is one */
+    int32_t         x;
+    int32_t         y;
+    int32_t         width;
+    int32_t         height;
+    /* Grain added while writing the output picture */
+    aom_film_grain_t film_grain_params;
+} DecOutPic;
+
+/* With the application's frame buffer allocator : picture returned by
+   reference, held until eb_svt_dec_release_out_buffer() */
+typedef struct DecOutLoan {
+    /* Recon picture lent, NULL when the grain picture is lent instead */
+    EbDecPicBuf         *pic_buf;
+    /* Picture the film grain is written to, kept for the next loans. NULL
+       until the first frame with grain */
+    EbPictureBufferDesc *grain_pic;
+    EbExtFrameBuf       grain_frame_buf;
+    size_t              grain_pic_size;
+    uint8_t             busy;
+} DecOutLoan;
+
+/* Input of eb_svt_decode_obu() not decoded yet : the start of an OBU whose
+   end has not been received */
+typedef struct DecObuStream {
+    uint8_t     *data;
+    size_t      size;
+    size_t      alloc;
+    /* Annex B : bytes left in the temporal unit and in the frame unit being
+       received, their sizes read */
+    size_t      tu_left;
+    size_t      fu_left;
+} DecObuStream;
+
 /**************************************
  * Component Private Data
  **************************************/
@@ -158,6 +227,14 @@ typedef struct EbDecHandle {
     uint8_t show_existing_frame;
     uint8_t show_frame;
     uint8_t showable_frame;  // frame can be used as show existing frame in future
+    /* The tiles of the current frame are not decoded : nothing references
+       the frame, and it is not output */
+    uint8_t skip_frame;
+    /* Frames shown so far, the first skip_frames of them are not output */
+    uint64_t shown_frame_cnt;
+    /* Superblock aligned area of the frame that is reconstructed, the
+       region of interest and one superblock around it */
+    TileInfo dec_area;
 
     // Thread Handles
 
@@ -170,9 +247,18 @@ typedef struct EbDecHandle {
 
     void   *pv_lr_ctxt;
 
+    /** Row jobs running deblocking, CDEF and LR together **/
+    void   *pv_pf_ctxt;
+
     /** Pointer to Picture manager structure **/
     void   *pv_pic_mgr;
 
+    /** Tile worker threads, NULL for single thread decoding **/
+    void   *pv_tile_mt_ctxt;
+
+    /** Frame threads, NULL when frames are decoded one at a time **/
+    void   *pv_frame_mt_ctxt;
+
     // * 'remapped_ref_idx[i - 1]' maps reference type 'i' (range: LAST_FRAME ...
     // EXTREF_FRAME) to a remapped index 'j' (in range: 0 ... REF_FRAMES - 1)
     // * Later, 'cm->ref_frame_map[j]' maps the remapped index 'j' to a pointer to
@@ -199,7 +285,24 @@ typedef struct EbDecHandle {
     /* TODO: Move to buffer pool. */
     EbDecPicBuf *cur_pic_buf[DEC_MAX_NUM_FRM_PRLL];
 
+    /* Output queue, in decode order. Holds up to frame_threads pictures */
+    DecOutPic   out_queue[DEC_MAX_FRAME_THREADS];
+    int32_t     out_head;
+    int32_t     out_count;
+    /* Set by eb_svt_decode_frame() without data : drain the output queue */
+    uint8_t     eos;
+
+    /* Partial OBU of eb_svt_decode_obu(), and the Annex B unit sizes */
+    DecObuStream obu_stream;
+
     // Callbacks
+    /* Application frame buffer allocator, NULL when the decoder allocates
+       the pictures itself. See eb_dec_set_frame_buffer_callbacks() */
+    eb_allocate_frame_buffer    allocate_frame_buffer;
+    eb_release_frame_buffer     release_frame_buffer;
+    void                        *frame_buffer_priv;
+    /* With the allocator : pictures returned by reference */
+    DecOutLoan                  out_loans[DEC_MAX_OUT_LOANS];
 
     //DPB + MV, ... buf
 
@@ -214,6 +317,101 @@ typedef struct EbDecHandle {
     uint64_t                     total_lib_memory;
 }EbDecHandle;
 
+/* Tile of the current tile group, queued for the tile workers */
+typedef struct DecTileJob {
+    const uint8_t   *data;
+    const uint8_t   *data_end;
+    size_t          size;
+    int32_t         tile_num;
+    EbErrorType     status;
+} DecTileJob;
+
+/* Tile worker. Decodes tiles on a private view of the decoder handle :
+   the view shares all frame level state with the main handle but owns its
+   parse and decode module contexts and its SB coeff buffer */
+typedef struct DecTileWorker {
+    EbDecHandle     dec_handle;
+
+    /* Back pointer to DecTileMtCtxt */
+    void            *pv_tile_mt_ctxt;
+
+    EbHandle        start_semaphore;
+    EbHandle        thread_handle;
+} DecTileWorker;
+
+/* Tile level multi-threading context */
+typedef struct DecTileMtCtxt {
+    /* Worker threads, the calling thread decodes tiles too */
+    int32_t         num_workers;
+    DecTileWorker   *workers;
+
+    EbHandle        done_semaphore;
+
+    /* Tiles of the tile group being decoded */
+    TilesInfo       *tiles_info;
+    DecTileJob      *jobs;
+    int32_t         num_jobs;
+    volatile uint32_t next_job;
+
+    /* Post filter context of the handle, the workers run its row jobs
+       instead of tiles while post_filter is set */
+    void            *pv_pf_ctxt;
+    uint8_t         post_filter;
+
+    /* Parse / reconstruction pipeline of dec_config.pipeline_recon : while
+       recon is set, the calling thread parses the frame into the frame level
+       coeff buffers and marks the SBs parsed, the workers reconstruct SB
+       rows and publish how many SBs of each row are done */
+    uint8_t         recon;
+    int32_t         *coeff[MAX_MB_PLANE];
+    volatile uint32_t *sb_parsed;
+    volatile uint32_t *recon_progress;
+    int32_t         recon_rows;
+    volatile uint32_t next_recon_row;
+    volatile uint32_t recon_abort;
+
+    /* A semaphore per thread, the calling thread's last : a wake up posted
+       for one waiter cannot be taken by another one */
+    EbHandle        recon_mutex;
+    EbHandle        *recon_semaphores;
+    uint8_t         *recon_waiting;
+} DecTileMtCtxt;
+
+/* Frame thread. Decodes the tile group of a whole frame on a private view
+   of the handle : the view owns all frame level buffers and module contexts
+   and is refreshed from the main handle once its frame header is parsed */
+typedef struct DecFrameSlot {
+    EbDecHandle     dec_handle;
+
+    /* Copy of the tile group OBU payload */
+    uint8_t         *data;
+    size_t          data_size;
+    size_t          data_alloc;
+    ObuHeader       obu_header;
+
+    /* Pictures held until the slot is retired */
+    EbDecPicBuf     *cur_buf;
+    EbDecPicBuf     *ref_bufs[REF_FRAMES];
+
+    int32_t         busy;
+    EbErrorType     status;
+
+    EbHandle        start_semaphore;
+    EbHandle        done_semaphore;
+    EbHandle        thread_handle;
+} DecFrameSlot;
+
+/* Frame level multi-threading context. Frames are handed to the slots in
+   decode order, so the next slot is also the oldest one in flight */
+typedef struct DecFrameMtCtxt {
+    int32_t         num_slots;
+    DecFrameSlot    *slots;
+    int32_t         next_slot;
+
+    /* First error of a retired frame, reported by the next API call */
+    EbErrorType     status;
+} DecFrameMtCtxt;
+
 #ifdef __cplusplus
     }
 #endif
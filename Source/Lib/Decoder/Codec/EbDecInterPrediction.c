@@ -62,6 +62,37 @@ static INLINE MV dec_clamp_mv_to_umv_border_sb (
     return clamped_mv;
 }
 
+#define REF_SCALE_SHIFT 14
+#define SCALE_SUBPEL_BITS 10
+#define SCALE_EXTRA_BITS (SCALE_SUBPEL_BITS - SUBPEL_BITS)
+
+/* Frame threading : waits for the luma rows of the reference a block reads,
+   including the interpolation filter taps. pos_y_q4 is the position of the
+   top of the block in the reference in 1/16th of the plane rows, before
+   scaling. The reference rows are mapped through the vertical scale factor
+   of the reference, in the fixed point precision of scaled_y() */
+static void dec_wait_ref_rows(EbDecPicBuf *ref_buf, int32_t cur_height,
+                              int32_t pos_y_q4, int32_t bh, int32_t ss_y)
+{
+    const int32_t ref_height = ref_buf->frame_height;
+    const int32_t y_scale_fp = ((ref_height << REF_SCALE_SHIFT) +
+        cur_height / 2) / cur_height;
+    const int32_t y_step = ROUND_POWER_OF_TWO(y_scale_fp,
+        REF_SCALE_SHIFT - SCALE_SUBPEL_BITS);
+    const int32_t off = (y_scale_fp - (1 << REF_SCALE_SHIFT)) *
+        (1 << (SUBPEL_BITS - 1));
+    const int64_t pos_y = ROUND_POWER_OF_TWO_SIGNED_64(
+        (int64_t)pos_y_q4 * y_scale_fp + off,
+        REF_SCALE_SHIFT - SCALE_EXTRA_BITS);
+    const int32_t top_row = (int32_t)(pos_y >> SCALE_SUBPEL_BITS) -
+        (SUBPEL_TAPS >> 1) + 1;
+    const int32_t bottom_row = (int32_t)((pos_y + (int64_t)(bh - 1) * y_step)
+        >> SCALE_SUBPEL_BITS) + (SUBPEL_TAPS >> 1);
+
+    dec_pic_wait_rows(ref_buf, top_row << ss_y,
+        ((bottom_row + 1) << ss_y) - 1);
+}
+
 
 void svtav1_predict_inter_block_plane(
     EbDecHandle *dec_hdl, PartitionInfo_t *part_info, int32_t plane,
@@ -165,6 +196,16 @@ void svtav1_predict_inter_block_plane(
                     part_info->mb_to_bottom_edge,
                     &mv, bw, bh, ss_x, ss_y);
 
+            /* Frame threading : wait for the reference rows read below */
+            if (!is_intrabc) {
+                if (do_warp)
+                    dec_pic_wait_rows(ref_buf, -1, -1);
+                else
+                    dec_wait_ref_rows(ref_buf,
+                        cur_frm_hdr->frame_size.frame_height,
+                        (pre_y << SUBPEL_BITS) + mv_q4.row, bh, ss_y);
+            }
+
             subpel_params.xs = 0;
             subpel_params.ys = 0;
             subpel_params.subpel_x = mv_q4.col & SUBPEL_MASK;
@@ -784,6 +784,48 @@ void svtav1_predict_intra_block(PartitionInfo_t *xd, int32_t plane,
 
     const int32_t disable_edge_filter = !seq_header->enable_intra_edge_filter;
 
+    const int n_top_px = have_top ? AOMMIN(txwpx, xr + txwpx) : 0;
+    const int n_topright_px = have_top_right ? AOMMIN(txwpx, xr) : 0;
+    const int n_left_px = have_left ? AOMMIN(txhpx, yd + txhpx) : 0;
+    const int n_bottomleft_px = have_bottom_left ? AOMMIN(txhpx, yd) : 0;
+    int i;
+
+    /* Only the available neighbours are read: the others may belong to
+       a tile another worker is reconstructing */
+    if (bit_depth == EB_8BIT) {
+        EbByte buf = (EbByte)pv_pred_buf;
+        uint8_t *top = (uint8_t *)topNeighArray;
+        uint8_t *left = (uint8_t *)leftNeighArray;
+
+        if (n_top_px)
+            memcpy(top + 1, buf - pred_stride, n_top_px);
+        if (n_topright_px)
+            memcpy(top + 1 + txwpx, buf - pred_stride + txwpx, n_topright_px);
+        for (i = 0; i < n_left_px; i++)
+            left[i + 1] = buf[-1 + i * pred_stride];
+        for (i = 0; i < n_bottomleft_px; i++)
+            left[i + 1 + txhpx] = buf[-1 + (i + txhpx) * pred_stride];
+        if (n_top_px && n_left_px)
+            top[0] = left[0] = buf[-1 - pred_stride];
+    }
+    else {
+        uint16_t *buf = (uint16_t *)pv_pred_buf;
+        uint16_t *top = (uint16_t *)topNeighArray;
+        uint16_t *left = (uint16_t *)leftNeighArray;
+
+        if (n_top_px)
+            memcpy(top + 1, buf - pred_stride, n_top_px * sizeof(*top));
+        if (n_topright_px)
+            memcpy(top + 1 + txwpx, buf - pred_stride + txwpx,
+                n_topright_px * sizeof(*top));
+        for (i = 0; i < n_left_px; i++)
+            left[i + 1] = buf[-1 + i * pred_stride];
+        for (i = 0; i < n_bottomleft_px; i++)
+            left[i + 1 + txhpx] = buf[-1 + (i + txhpx) * pred_stride];
+        if (n_top_px && n_left_px)
+            top[0] = left[0] = buf[-1 - pred_stride];
+    }
+
   //###..Calling all other intra predictors except CFL & pallate...//
     if (bit_depth == EB_8BIT) {
         decode_build_intra_predictors(
@@ -793,10 +835,7 @@ void svtav1_predict_intra_block(PartitionInfo_t *xd, int32_t plane,
             (uint8_t*)pv_pred_buf, pred_stride, mode,
             angle_delta, filter_intra_mode, tx_size,
             disable_edge_filter,
-            have_top ? AOMMIN(txwpx, xr + txwpx) : 0,
-            have_top_right ? AOMMIN(txwpx, xr) : 0,
-            have_left ? AOMMIN(txhpx, yd + txhpx) : 0,
-            have_bottom_left ? AOMMIN(txhpx, yd) : 0, plane);
+            n_top_px, n_topright_px, n_left_px, n_bottomleft_px, plane);
     }
     else { //16bit
         decode_build_intra_predictors_high(
@@ -806,10 +845,7 @@ void svtav1_predict_intra_block(PartitionInfo_t *xd, int32_t plane,
             (uint16_t*)pv_pred_buf, pred_stride, mode,
             angle_delta, filter_intra_mode, tx_size,
             disable_edge_filter,
-            have_top ? AOMMIN(txwpx, xr + txwpx) : 0,
-            have_top_right ? AOMMIN(txwpx, xr) : 0,
-            have_left ? AOMMIN(txhpx, yd + txhpx) : 0,
-            have_bottom_left ? AOMMIN(txhpx, yd) : 0, plane,
+            n_top_px, n_topright_px, n_left_px, n_bottomleft_px, plane,
             bit_depth);
     }
 }
@@ -820,46 +856,11 @@ void svt_av1_predict_intra(DecModCtxt *dec_mod_ctxt, PartitionInfo_t *part_info,
     void *pv_blk_recon_buf, int32_t recon_stride,
     EbBitDepthEnum bit_depth, int32_t blk_mi_col_off, int32_t blk_mi_row_off )
 {
-    int32_t i, wpx, hpx;
     EbDecHandle *dec_handle = (EbDecHandle *)dec_mod_ctxt->dec_handle_ptr;
 
-    //assert(part_info->wpx[plane] <= 64);
-    //assert(part_info->hpx[plane] <= 64);
-    wpx = AOMMIN(part_info->wpx[plane], plane ?
-        (64 >> dec_handle->seq_header.color_config.subsampling_x) : 64);
-    hpx = AOMMIN(part_info->hpx[plane], plane ?
-        (64 >> dec_handle->seq_header.color_config.subsampling_y) : 64);
-
-    void *pv_topNeighArray  = (void *)dec_mod_ctxt->topNeighArray;;
+    void *pv_topNeighArray  = (void *)dec_mod_ctxt->topNeighArray;
     void *pv_leftNeighArray = (void *)dec_mod_ctxt->leftNeighArray;
 
-    if (bit_depth == EB_8BIT) {
-        EbByte  buf = (EbByte)pv_blk_recon_buf;
-        uint8_t *pu1_topNeighArray = (uint8_t *)dec_mod_ctxt->topNeighArray;
-        uint8_t *pu1_leftNeighArray = (uint8_t *)dec_mod_ctxt->leftNeighArray;
-
-        memcpy(pu1_topNeighArray + 1, (buf - recon_stride),
-            wpx * 2 * sizeof(uint8_t));
-
-        for (i = 0; i < hpx * 2; i++)
-            pu1_leftNeighArray[i + 1] = buf[-1 + i * recon_stride];
-
-        pu1_topNeighArray[0] = pu1_leftNeighArray[0] = buf[-1 - recon_stride];
-    }
-    else {//16bit
-        uint16_t *buf = (uint16_t *)pv_blk_recon_buf;
-        uint16_t *pu2_topNeighArray = (uint16_t *)dec_mod_ctxt->topNeighArray;
-        uint16_t *pu2_leftNeighArray = (uint16_t *)dec_mod_ctxt->leftNeighArray;
-
-        memcpy(pu2_topNeighArray + 1, (buf - recon_stride),
-            wpx * 2 * sizeof(uint16_t));
-
-        for (i = 0; i < hpx * 2; i++)
-            pu2_leftNeighArray[i + 1] = buf[-1 + i * recon_stride];
-
-        pu2_topNeighArray[0] = pu2_leftNeighArray[0] = buf[-1 - recon_stride];
-    }
-
     if (plane != AOM_PLANE_Y && part_info->mi->uv_mode == UV_CFL_PRED) {
         svtav1_predict_intra_block(part_info, plane,
             tx_size, td,
@@ -621,7 +621,7 @@ static void dec_update_sharpness(LoopFilterInfoN *lfi, int32_t sharpness_lvl) {
 }
 
 /*Update the loop filter for the current frame */
-static void dec_av1_loop_filter_frame_init(FrameHeader *frm_hdr,
+void dec_av1_loop_filter_frame_init(FrameHeader *frm_hdr,
     LoopFilterInfoN *lf_info, int32_t plane_start, int32_t plane_end)
 {
     int32_t filt_lvl[MAX_MB_PLANE], filt_lvl_r[MAX_MB_PLANE];
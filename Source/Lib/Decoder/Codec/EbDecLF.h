@@ -61,3 +61,13 @@ void dec_av1_loop_filter_frame(
     FrameHeader *frm_hdr, SeqHeader *seq_header,
     EbPictureBufferDesc *recon_picture_buf, LFCtxt *lf_ctxt,
     int32_t plane_start, int32_t plane_end);
+
+/*Row wise filtering : frame level init, then one call per SB*/
+void dec_av1_loop_filter_frame_init(FrameHeader *frm_hdr,
+    LoopFilterInfoN *lf_info, int32_t plane_start, int32_t plane_end);
+
+void dec_loop_filter_sb(
+    FrameHeader *frm_hdr, SeqHeader *seq_header,
+    EbPictureBufferDesc *recon_picture_buf, LFCtxt *lf_ctxt,
+    LoopFilterInfoN *lf_info, const uint32_t mi_row, const uint32_t mi_col,
+    int32_t plane_start, int32_t plane_end, uint8_t LastCol);
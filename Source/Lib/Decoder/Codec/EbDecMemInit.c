@@ -25,6 +25,37 @@
 
 #include "EbDecPicMgr.h"
 #include "EbDecLF.h"
+#include "EbDecPostFilter.h"
+#include "EbCdef.h"
+#include "EbThreads.h"
+
+/* Sets the fields of the descriptor that do not depend on where the planes
+   are allocated */
+static void init_recon_picture_buffer_desc(
+    EbPictureBufferDesc          *picture_buffer_desc_ptr,
+    EbPictureBufferDescInitData  *pictureBufferDescInitDataPtr)
+{
+    // Set the Picture Buffer Static variables
+    picture_buffer_desc_ptr->max_width = pictureBufferDescInitDataPtr->max_width;
+    picture_buffer_desc_ptr->max_height = pictureBufferDescInitDataPtr->max_height;
+    picture_buffer_desc_ptr->width = pictureBufferDescInitDataPtr->max_width;
+    picture_buffer_desc_ptr->height = pictureBufferDescInitDataPtr->max_height;
+    picture_buffer_desc_ptr->bit_depth = pictureBufferDescInitDataPtr->bit_depth;
+    picture_buffer_desc_ptr->color_format = pictureBufferDescInitDataPtr->color_format;
+    picture_buffer_desc_ptr->stride_y = pictureBufferDescInitDataPtr->max_width + pictureBufferDescInitDataPtr->left_padding + pictureBufferDescInitDataPtr->right_padding;
+    picture_buffer_desc_ptr->stride_cb = picture_buffer_desc_ptr->stride_cr = picture_buffer_desc_ptr->stride_y >> 1;
+    picture_buffer_desc_ptr->origin_x = pictureBufferDescInitDataPtr->left_padding;
+    picture_buffer_desc_ptr->origin_y = pictureBufferDescInitDataPtr->top_padding;
+
+    picture_buffer_desc_ptr->luma_size = (pictureBufferDescInitDataPtr->max_width + pictureBufferDescInitDataPtr->left_padding + pictureBufferDescInitDataPtr->right_padding) *
+        (pictureBufferDescInitDataPtr->max_height + pictureBufferDescInitDataPtr->top_padding + pictureBufferDescInitDataPtr->bot_padding);
+    picture_buffer_desc_ptr->chroma_size = picture_buffer_desc_ptr->luma_size >> 2;
+    picture_buffer_desc_ptr->packedFlag = EB_FALSE;
+
+    picture_buffer_desc_ptr->stride_bit_inc_y = 0;
+    picture_buffer_desc_ptr->stride_bit_inc_cb = 0;
+    picture_buffer_desc_ptr->stride_bit_inc_cr = 0;
+}
 
 /*TODO: Remove and harmonize with encoder. Globals prevent harmonization now! */
 /*****************************************
@@ -47,26 +78,7 @@ EbErrorType dec_eb_recon_picture_buffer_desc_ctor(
     // Allocate the PictureBufferDesc Object
     *object_dbl_ptr = (EbPtr)picture_buffer_desc_ptr;
 
-    // Set the Picture Buffer Static variables
-    picture_buffer_desc_ptr->max_width = pictureBufferDescInitDataPtr->max_width;
-    picture_buffer_desc_ptr->max_height = pictureBufferDescInitDataPtr->max_height;
-    picture_buffer_desc_ptr->width = pictureBufferDescInitDataPtr->max_width;
-    picture_buffer_desc_ptr->height = pictureBufferDescInitDataPtr->max_height;
-    picture_buffer_desc_ptr->bit_depth = pictureBufferDescInitDataPtr->bit_depth;
-    picture_buffer_desc_ptr->color_format = pictureBufferDescInitDataPtr->color_format;
-    picture_buffer_desc_ptr->stride_y = pictureBufferDescInitDataPtr->max_width + pictureBufferDescInitDataPtr->left_padding + pictureBufferDescInitDataPtr->right_padding;
-    picture_buffer_desc_ptr->stride_cb = picture_buffer_desc_ptr->stride_cr = picture_buffer_desc_ptr->stride_y >> 1;
-    picture_buffer_desc_ptr->origin_x = pictureBufferDescInitDataPtr->left_padding;
-    picture_buffer_desc_ptr->origin_y = pictureBufferDescInitDataPtr->top_padding;
-
-    picture_buffer_desc_ptr->luma_size = (pictureBufferDescInitDataPtr->max_width + pictureBufferDescInitDataPtr->left_padding + pictureBufferDescInitDataPtr->right_padding) *
-        (pictureBufferDescInitDataPtr->max_height + pictureBufferDescInitDataPtr->top_padding + pictureBufferDescInitDataPtr->bot_padding);
-    picture_buffer_desc_ptr->chroma_size = picture_buffer_desc_ptr->luma_size >> 2;
-    picture_buffer_desc_ptr->packedFlag = EB_FALSE;
-
-    picture_buffer_desc_ptr->stride_bit_inc_y = 0;
-    picture_buffer_desc_ptr->stride_bit_inc_cb = 0;
-    picture_buffer_desc_ptr->stride_bit_inc_cr = 0;
+    init_recon_picture_buffer_desc(picture_buffer_desc_ptr, pictureBufferDescInitDataPtr);
 
     // Allocate the Picture Buffers (luma & chroma)
     if (pictureBufferDescInitDataPtr->buffer_enable_mask & PICTURE_BUFFER_DESC_Y_FLAG) {
@@ -90,6 +102,72 @@ EbErrorType dec_eb_recon_picture_buffer_desc_ctor(
     return EB_ErrorNone;
 }
 
+/* Size of a plane in the application buffer, rounded so that every plane
+   starts aligned like the decoder's own allocations */
+static size_t ext_plane_size(size_t size) {
+    return (size + ALVALUE - 1) & ~((size_t)ALVALUE - 1);
+}
+
+/*****************************************
+ * dec_eb_ext_picture_buffer_desc_ctor
+ *  Same as dec_eb_recon_picture_buffer_desc_ctor,
+ *  with the planes carved out of one buffer
+ *  from the application's allocator
+ *****************************************/
+EbErrorType dec_eb_ext_picture_buffer_desc_ctor(
+    EbPtr                       *object_dbl_ptr,
+    EbPtr                       object_init_data_ptr,
+    eb_allocate_frame_buffer    allocate_buffer,
+    void                        *priv_data,
+    EbExtFrameBuf               *frame_buf)
+{
+    EbPictureBufferDesc          *picture_buffer_desc_ptr;
+    EbPictureBufferDescInitData  *pictureBufferDescInitDataPtr = (EbPictureBufferDescInitData*)object_init_data_ptr;
+
+    uint32_t bytesPerPixel = (pictureBufferDescInitDataPtr->bit_depth == EB_8BIT) ? 1 : 2;
+
+    EB_MALLOC_DEC(EbPictureBufferDesc*, picture_buffer_desc_ptr, sizeof(EbPictureBufferDesc), EB_N_PTR);
+
+    *object_dbl_ptr = (EbPtr)picture_buffer_desc_ptr;
+
+    init_recon_picture_buffer_desc(picture_buffer_desc_ptr, pictureBufferDescInitDataPtr);
+
+    size_t luma_size = 0, chroma_size = 0;
+    if (pictureBufferDescInitDataPtr->buffer_enable_mask & PICTURE_BUFFER_DESC_Y_FLAG)
+        luma_size = ext_plane_size(picture_buffer_desc_ptr->luma_size * bytesPerPixel);
+    if (pictureBufferDescInitDataPtr->buffer_enable_mask & PICTURE_BUFFER_DESC_Cb_FLAG)
+        chroma_size = ext_plane_size(picture_buffer_desc_ptr->chroma_size * bytesPerPixel);
+
+    /* The buffer may be unaligned : room to align the first plane */
+    size_t min_size = ALVALUE - 1 + luma_size + 2 * chroma_size;
+    if (min_size > UINT32_MAX)
+        return EB_ErrorInsufficientResources;
+
+    frame_buf->buffer = NULL;
+    frame_buf->buffer_size = 0;
+    frame_buf->private_data = NULL;
+    if (allocate_buffer(frame_buf, (uint32_t)min_size, priv_data) != 0 ||
+        frame_buf->buffer == NULL)
+    {
+        frame_buf->buffer = NULL;
+        return EB_ErrorInsufficientResources;
+    }
+    if (frame_buf->buffer_size < min_size)
+        return EB_ErrorInsufficientResources;
+
+    EbByte planes = (EbByte)(((uintptr_t)frame_buf->buffer + ALVALUE - 1) &
+        ~((uintptr_t)ALVALUE - 1));
+    memset(planes, 0, luma_size + 2 * chroma_size);
+
+    picture_buffer_desc_ptr->buffer_y = luma_size ? planes : 0;
+    planes += luma_size;
+    picture_buffer_desc_ptr->buffer_cb = chroma_size ? planes : 0;
+    planes += chroma_size;
+    picture_buffer_desc_ptr->buffer_cr = chroma_size ? planes : 0;
+
+    return EB_ErrorNone;
+}
+
 /**********************************
 * Master Frame Buf containing all frame level bufs like ModeInfo
 for all the frames in parallel
@@ -358,9 +436,10 @@ static EbErrorType init_lf_ctxt(EbDecHandle  *dec_handle_ptr) {
 
     SeqHeader *seq_header = &dec_handle_ptr->seq_header;
     /*Boundary checking of mi_row & mi_col are not done while populating,
-    so more memory is allocated by alligning to sb_size */
+    so more memory is allocated by alligning to sb_size. The rows are
+    frame_header.mi_stride apart, which is aligned to the largest SB */
     int32_t aligned_width   = ALIGN_POWER_OF_TWO(seq_header->max_frame_width,
-        seq_header->sb_size_log2);
+        MAX_SB_SIZE_LOG2);
     int32_t aligned_height  = ALIGN_POWER_OF_TWO(seq_header->max_frame_height,
         seq_header->sb_size_log2);
     int32_t mi_cols = aligned_width >> MI_SIZE_LOG2;
@@ -425,8 +504,239 @@ static EbErrorType init_lr_ctxt(EbDecHandle  *dec_handle_ptr)
     // expects width to be multiple of 16 for filtering.
     lr_ctxt->dst_stride = ALIGN_POWER_OF_TWO(frame_width, 4);
 
-    EB_MALLOC_DEC(uint8_t *, lr_ctxt->dst, lr_ctxt->dst_stride *
-        (frame_height) * sizeof(uint8_t) << use_highbd, EB_N_PTR);
+    for (int plane = 0; plane < num_planes; plane++) {
+        const int ss_y = plane &&
+            dec_handle_ptr->seq_header.color_config.subsampling_y;
+        const int plane_h = (frame_height + ss_y) >> ss_y;
+        EB_MALLOC_DEC(uint8_t *, lr_ctxt->dst[plane], lr_ctxt->dst_stride *
+            plane_h * sizeof(uint8_t) << use_highbd, EB_N_PTR);
+    }
+
+    return return_error;
+}
+
+/* Row jobs, CDEF line buffers and per thread scratch buffers of the post
+   filters, sized for the largest frame of the sequence */
+static EbErrorType init_pf_ctxt(EbDecHandle  *dec_handle_ptr,
+                                int32_t num_workers)
+{
+    EbErrorType return_error = EB_ErrorNone;
+    SeqHeader   *seq_header = &dec_handle_ptr->seq_header;
+    const int32_t num_threads = num_workers + 1;
+    const int32_t nvfb = (seq_header->max_frame_height + CDEF_BLOCKSIZE - 1) >>
+        CDEF_BLOCKSIZE_LOG2;
+    const int32_t nhfb = (seq_header->max_frame_width + CDEF_BLOCKSIZE - 1) >>
+        CDEF_BLOCKSIZE_LOG2;
+    /* LF, CDEF and published rows, and up to one more row of restoration
+       units than of CDEF blocks per plane */
+    const int32_t max_jobs = 3 * nvfb + MAX_MB_PLANE * (nvfb + 1);
+
+    EB_MALLOC_DEC(void *, dec_handle_ptr->pv_pf_ctxt, sizeof(DecPfCtxt), EB_N_PTR);
+
+    DecPfCtxt *pf_ctxt = (DecPfCtxt *)dec_handle_ptr->pv_pf_ctxt;
+    pf_ctxt->dec_handle_ptr = dec_handle_ptr;
+    pf_ctxt->num_jobs = 0;
+    pf_ctxt->next_job = 0;
+    pf_ctxt->num_waiters = 0;
+
+    EB_MALLOC_DEC(DecPfJob *, pf_ctxt->jobs, max_jobs * sizeof(DecPfJob),
+        EB_N_PTR);
+    EB_MALLOC_DEC(DecPfJob **, pf_ctxt->job_queue,
+        max_jobs * sizeof(DecPfJob *), EB_N_PTR);
+
+    pf_ctxt->cdef_linebuf_size = CDEF_VBORDER *
+        ((nhfb << CDEF_BLOCKSIZE_LOG2) + 2 * CDEF_HBORDER);
+    for (int32_t plane = 0; plane < MAX_MB_PLANE; plane++) {
+        EB_MALLOC_DEC(uint16_t *, pf_ctxt->cdef_linebuf[plane],
+            2 * pf_ctxt->cdef_linebuf_size * sizeof(uint16_t), EB_N_PTR);
+    }
+    EB_MALLOC_DEC(uint8_t *, pf_ctxt->cdef_row_flags,
+        (nvfb + 1) * (nhfb + 2) * sizeof(uint8_t), EB_N_PTR);
+
+    EB_MALLOC_DEC(DecPfScratch *, pf_ctxt->scratch,
+        num_threads * sizeof(DecPfScratch), EB_N_PTR);
+    for (int32_t i = 0; i < num_threads; i++) {
+        DecPfScratch *scratch = &pf_ctxt->scratch[i];
+        for (int32_t plane = 0; plane < MAX_MB_PLANE; plane++) {
+            int32_t mi_high_l2 = MI_SIZE_LOG2 - ((plane == 0) ? 0 : 1);
+            EB_MALLOC_DEC(uint16_t *, scratch->cdef_colbuf[plane],
+                ((CDEF_BLOCKSIZE << mi_high_l2) + 2 * CDEF_VBORDER) *
+                CDEF_HBORDER * sizeof(uint16_t), EB_N_PTR);
+        }
+        EB_MALLOC_DEC(RestorationLineBuffers *, scratch->rlbs,
+            sizeof(RestorationLineBuffers), EB_N_PTR);
+        EB_MALLOC_DEC(int32_t *, scratch->rst_tmpbuf,
+            RESTORATION_TMPBUF_SIZE * sizeof(int32_t), EB_N_PTR);
+    }
+
+    EB_CREATE_MUTEX_DEC(pf_ctxt->progress_mutex);
+    EB_CREATE_SEMAPHORE_DEC(pf_ctxt->progress_semaphore, 0, num_threads);
+
+    return return_error;
+}
+
+/* Tile workers for dec_config.threads > 1. Each worker gets its own view of
+   the handle with private parse / decode module contexts and coeff buffer */
+static EbErrorType init_tile_mt_ctxt(EbDecHandle  *dec_handle_ptr)
+{
+    EbErrorType return_error = EB_ErrorNone;
+    MasterFrameBuf  *master_frame_buf = &dec_handle_ptr->master_frame_buf;
+
+    dec_handle_ptr->pv_tile_mt_ctxt = NULL;
+    if (dec_handle_ptr->dec_config.threads <= 1)
+        return init_pf_ctxt(dec_handle_ptr, 0);
+
+    EB_MALLOC_DEC(void *, dec_handle_ptr->pv_tile_mt_ctxt, sizeof(DecTileMtCtxt), EB_N_PTR);
+
+    DecTileMtCtxt *tile_mt_ctxt = (DecTileMtCtxt *)dec_handle_ptr->pv_tile_mt_ctxt;
+    int32_t num_workers = dec_handle_ptr->dec_config.threads - 1;
+
+    tile_mt_ctxt->num_workers = num_workers;
+    tile_mt_ctxt->tiles_info = NULL;
+    tile_mt_ctxt->num_jobs = 0;
+    tile_mt_ctxt->next_job = 0;
+
+    /* A tile holds at least one SB */
+    EB_MALLOC_DEC(DecTileJob *, tile_mt_ctxt->jobs, master_frame_buf->sb_cols *
+        master_frame_buf->sb_rows * sizeof(DecTileJob), EB_N_PTR);
+    EB_MALLOC_DEC(DecTileWorker *, tile_mt_ctxt->workers,
+        num_workers * sizeof(DecTileWorker), EB_N_PTR);
+    EB_CREATE_SEMAPHORE_DEC(tile_mt_ctxt->done_semaphore, 0, num_workers);
+
+    for (int32_t i = 0; i < num_workers; i++) {
+        DecTileWorker *worker = &tile_mt_ctxt->workers[i];
+        EbDecHandle   *worker_handle = &worker->dec_handle;
+
+        *worker_handle = *dec_handle_ptr;
+        worker_handle->pv_tile_mt_ctxt = NULL;
+        worker->pv_tile_mt_ctxt = (void *)tile_mt_ctxt;
+
+        return_error |= init_parse_context(worker_handle);
+        return_error |= init_dec_mod_ctxt(worker_handle);
+#if SINGLE_THRD_COEFF_BUF_OPT
+        CurFrameBuf *cur_frame_buf = &worker_handle->master_frame_buf.cur_frame_bufs[0];
+        int32_t num_mis_in_sb = master_frame_buf->num_mis_in_sb;
+
+        EB_MALLOC_DEC(int32_t*, cur_frame_buf->coeff[AOM_PLANE_Y],
+            (num_mis_in_sb * sizeof(int32_t) * (16 + 1)), EB_N_PTR);
+        EB_MALLOC_DEC(int32_t*, cur_frame_buf->coeff[AOM_PLANE_U],
+            (num_mis_in_sb * sizeof(int32_t) * (16 + 1) >> 2), EB_N_PTR);
+        EB_MALLOC_DEC(int32_t*, cur_frame_buf->coeff[AOM_PLANE_V],
+            (num_mis_in_sb * sizeof(int32_t) * (16 + 1) >> 2), EB_N_PTR);
+#endif
+        EB_CREATE_SEMAPHORE_DEC(worker->start_semaphore, 0, 1);
+    }
+
+    return_error |= init_pf_ctxt(dec_handle_ptr, num_workers);
+    tile_mt_ctxt->pv_pf_ctxt = dec_handle_ptr->pv_pf_ctxt;
+    tile_mt_ctxt->post_filter = 0;
+
+    /* The pipeline keeps the coeffs of all SBs until they are reconstructed */
+    tile_mt_ctxt->recon = 0;
+    tile_mt_ctxt->recon_rows = 0;
+    tile_mt_ctxt->next_recon_row = 0;
+    tile_mt_ctxt->recon_abort = 0;
+    for (int32_t plane = 0; plane < MAX_MB_PLANE; plane++)
+        tile_mt_ctxt->coeff[plane] = NULL;
+    if (dec_handle_ptr->dec_config.pipeline_recon) {
+        int32_t num_sb = master_frame_buf->sb_cols * master_frame_buf->sb_rows;
+        int32_t num_mis_in_sb = master_frame_buf->num_mis_in_sb;
+#if SINGLE_THRD_COEFF_BUF_OPT
+        EB_MALLOC_DEC(int32_t*, tile_mt_ctxt->coeff[AOM_PLANE_Y],
+            (num_sb * num_mis_in_sb * sizeof(int32_t) * (16 + 1)), EB_N_PTR);
+        EB_MALLOC_DEC(int32_t*, tile_mt_ctxt->coeff[AOM_PLANE_U],
+            (num_sb * num_mis_in_sb * sizeof(int32_t) * (16 + 1) >> 2), EB_N_PTR);
+        EB_MALLOC_DEC(int32_t*, tile_mt_ctxt->coeff[AOM_PLANE_V],
+            (num_sb * num_mis_in_sb * sizeof(int32_t) * (16 + 1) >> 2), EB_N_PTR);
+#endif
+        EB_MALLOC_DEC(volatile uint32_t *, tile_mt_ctxt->sb_parsed,
+            num_sb * sizeof(uint32_t), EB_N_PTR);
+        EB_MALLOC_DEC(volatile uint32_t *, tile_mt_ctxt->recon_progress,
+            master_frame_buf->sb_rows * sizeof(uint32_t), EB_N_PTR);
+        EB_CREATE_MUTEX_DEC(tile_mt_ctxt->recon_mutex);
+        EB_MALLOC_DEC(EbHandle *, tile_mt_ctxt->recon_semaphores,
+            (num_workers + 1) * sizeof(EbHandle), EB_N_PTR);
+        EB_MALLOC_DEC(uint8_t *, tile_mt_ctxt->recon_waiting,
+            (num_workers + 1) * sizeof(uint8_t), EB_N_PTR);
+        for (int32_t i = 0; i <= num_workers; i++) {
+            EB_CREATE_SEMAPHORE_DEC(tile_mt_ctxt->recon_semaphores[i], 0, 1);
+            tile_mt_ctxt->recon_waiting[i] = 0;
+        }
+    }
+
+    /* Created last so that eb_deinit_decoder stops them before
+       releasing their contexts */
+    for (int32_t i = 0; i < num_workers; i++) {
+        DecTileWorker *worker = &tile_mt_ctxt->workers[i];
+        EB_CREATE_THREAD_DEC(worker->thread_handle, dec_tile_worker_kernel,
+            worker);
+    }
+
+    return return_error;
+}
+
+/* Frame threads for dec_config.frame_threads > 1. Each slot gets its own
+   view of the handle with private frame buffers, module contexts and tile
+   workers, and a buffer for the tile group payload */
+static EbErrorType init_frame_mt_ctxt(EbDecHandle  *dec_handle_ptr)
+{
+    EbErrorType return_error = EB_ErrorNone;
+    SeqHeader   *seq_header = &dec_handle_ptr->seq_header;
+
+    dec_handle_ptr->pv_frame_mt_ctxt = NULL;
+    if (dec_handle_ptr->dec_config.frame_threads <= 1)
+        return return_error;
+
+    EB_MALLOC_DEC(void *, dec_handle_ptr->pv_frame_mt_ctxt,
+        sizeof(DecFrameMtCtxt), EB_N_PTR);
+
+    DecFrameMtCtxt *frame_mt_ctxt = (DecFrameMtCtxt *)dec_handle_ptr->pv_frame_mt_ctxt;
+    int32_t num_slots = dec_handle_ptr->dec_config.frame_threads;
+
+    frame_mt_ctxt->num_slots = num_slots;
+    frame_mt_ctxt->next_slot = 0;
+    frame_mt_ctxt->status = EB_ErrorNone;
+
+    EB_MALLOC_DEC(DecFrameSlot *, frame_mt_ctxt->slots,
+        num_slots * sizeof(DecFrameSlot), EB_N_PTR);
+
+    /* Tile groups larger than an uncompressed frame are decoded in place */
+    size_t data_alloc = (size_t)seq_header->max_frame_width *
+        seq_header->max_frame_height * 3 / 2;
+    if (seq_header->color_config.bit_depth > EB_EIGHT_BIT)
+        data_alloc <<= 1;
+
+    for (int32_t i = 0; i < num_slots; i++) {
+        DecFrameSlot *slot = &frame_mt_ctxt->slots[i];
+        EbDecHandle  *slot_handle = &slot->dec_handle;
+
+        *slot_handle = *dec_handle_ptr;
+        slot_handle->pv_frame_mt_ctxt = NULL;
+
+        return_error |= init_parse_context(slot_handle);
+        return_error |= init_dec_mod_ctxt(slot_handle);
+        return_error |= init_lf_ctxt(slot_handle);
+        return_error |= init_lr_ctxt(slot_handle);
+        return_error |= init_master_frame_ctxt(slot_handle);
+        if (return_error != EB_ErrorNone)
+            return return_error;
+        return_error |= init_tile_mt_ctxt(slot_handle);
+
+        EB_MALLOC_DEC(uint8_t *, slot->data, data_alloc, EB_N_PTR);
+        slot->data_alloc = data_alloc;
+        slot->data_size = 0;
+        slot->cur_buf = NULL;
+        for (int32_t j = 0; j < REF_FRAMES; j++)
+            slot->ref_bufs[j] = NULL;
+        slot->busy = 0;
+        slot->status = EB_ErrorNone;
+
+        EB_CREATE_SEMAPHORE_DEC(slot->start_semaphore, 0, 1);
+        EB_CREATE_SEMAPHORE_DEC(slot->done_semaphore, 0, 1);
+        /* After the slot's tile workers, so that it is stopped before them */
+        EB_CREATE_THREAD_DEC(slot->thread_handle, dec_frame_worker_kernel,
+            slot);
+    }
 
     return return_error;
 }
@@ -438,7 +748,8 @@ EbErrorType dec_mem_init(EbDecHandle  *dec_handle_ptr) {
         return EB_ErrorNone;
 
     /* init module ctxts */
-    return_error |= dec_pic_mgr_init((EbDecPicMgr **)&dec_handle_ptr->pv_pic_mgr);
+    return_error |= dec_pic_mgr_init((EbDecPicMgr **)&dec_handle_ptr->pv_pic_mgr,
+        dec_handle_ptr);
 
     return_error |= init_parse_context(dec_handle_ptr);
 
@@ -451,6 +762,21 @@ EbErrorType dec_mem_init(EbDecHandle  *dec_handle_ptr) {
     /* init frame buffers */
     return_error |= init_master_frame_ctxt(dec_handle_ptr);
 
+    /* Tile workers and frame threads start from a copy of the fully set up
+       handle. With frame threads the main handle only decodes the tile
+       groups that can not be handed to a frame thread, on its own */
+    if (return_error == EB_ErrorNone) {
+        if (dec_handle_ptr->dec_config.frame_threads > 1) {
+            dec_handle_ptr->pv_tile_mt_ctxt = NULL;
+            return_error |= init_pf_ctxt(dec_handle_ptr, 0);
+            return_error |= init_frame_mt_ctxt(dec_handle_ptr);
+        }
+        else {
+            dec_handle_ptr->pv_frame_mt_ctxt = NULL;
+            return_error |= init_tile_mt_ctxt(dec_handle_ptr);
+        }
+    }
+
     /* Initialize the references to NULL */
     for (int i = 0; i < REF_FRAMES; i++) {
         dec_handle_ptr->ref_frame_map[i] = NULL;
@@ -472,6 +472,9 @@ void read_cdef(EbDecHandle *dec_handle, SvtReader *r, PartitionInfo_t *xd,
     if (cdef_strength[index] == -1) {
         cdef_strength[index] = svt_read_literal(r, dec_handle->
             frame_header.CDEF_params.cdef_bits, ACCT_STR);
+        /* A 64x64 SB holds a single strength */
+        if (dec_handle->seq_header.sb_size != BLOCK_128X128)
+            return;
         int w4 = mi_size_wide[mbmi->sb_type];
         int h4 = mi_size_high[mbmi->sb_type];
         for (int i = row; i < row + h4; i += cdf_size) {
@@ -1159,6 +1162,10 @@ void svt_setup_motion_field(EbDecHandle *dec_handle) {
             dec_handle->master_frame_buf.ref_frame_side[ref_frame] = -1;
     }
 
+    /* The projected MVs are only read with use_ref_frame_mvs. Skipping them
+       also spares frame threads waiting for the MVs of the references */
+    if (!dec_handle->frame_header.use_ref_frame_mvs) return;
+
     int ref_stamp = MFMV_STACK_SIZE - 1;
 
 
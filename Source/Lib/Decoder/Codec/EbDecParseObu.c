@@ -42,6 +42,8 @@
 #include "EbDecLF.h"
 
 #include "EbDecCdef.h"
+#include "EbDecPostFilter.h"
+#include "EbThreads.h"
 
 
 #define CONFIG_MAX_DECODE_PROFILE 2
@@ -482,8 +484,6 @@ EbErrorType read_obu_header(bitstrm_t *bs, ObuHeader   *header)
     PRINT("obu_extension_flag", header->obu_extension_flag);
     header->obu_has_size_field = dec_get_bits(bs, 1);
     PRINT("obu_has_size_field", header->obu_has_size_field);
-    if (!header->obu_has_size_field)
-        return EB_Corrupt_Frame;
 
     if (dec_get_bits(bs, 1) != 0) {
         // obu_reserved_1bit must be set to 0
@@ -524,7 +524,8 @@ EbErrorType read_obu_size(bitstrm_t *bs, size_t bytes_available,
     return EB_ErrorNone;
 }
 
-/** Reads OBU header and size */
+/** Reads OBU header and size. Without size field, the OBU spans the size
+    bytes : the last OBU of a frame, or an Annex B OBU of obu_length bytes */
 EbErrorType open_bistream_unit(bitstrm_t *bs, ObuHeader *header, size_t size,
     size_t *const length_size)
 {
@@ -534,6 +535,14 @@ EbErrorType open_bistream_unit(bitstrm_t *bs, ObuHeader *header, size_t size,
     if (status != EB_ErrorNone)
         return status;
 
+    if (!header->obu_has_size_field) {
+        if (size < header->size)
+            return EB_Corrupt_Frame;
+        header->payload_size = size - header->size;
+        *length_size = 0;
+        return EB_ErrorNone;
+    }
+
     status = read_obu_size(bs, size, &header->payload_size, length_size);
     if (status != EB_ErrorNone)
         return status;
@@ -1357,23 +1366,23 @@ void read_skip_mode_params(bitstrm_t *bs, FrameHeader *frame_info, int FrameIsIn
 }
 
 // Read film grain parameters
-void read_film_grain_params(bitstrm_t *bs, aom_film_grain_t *grain_params,
-    SeqHeader *seq_header, FrameHeader *frame_info)
+void read_film_grain_params(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
+    aom_film_grain_t *grain_params, SeqHeader *seq_header,
+    FrameHeader *frame_info)
 {
-    int /*film_grain_params_ref_idx,*/ temp_grain_seed, i, numPosLuma, numPosChroma;
+    int film_grain_params_ref_idx, temp_grain_seed, i, numPosLuma, numPosChroma;
 
     if (!seq_header->film_grain_params_present || (!frame_info->show_frame &&
         !frame_info->showable_frame)) {
-        // TODO: reset_grain_params(grain_params);
+        memset(grain_params, 0, sizeof(*grain_params));
         return;
     }
     grain_params->apply_grain = dec_get_bits(bs, 1);
     PRINT_FRAME("apply_grain", grain_params->apply_grain);
 
-    if (grain_params->apply_grain) {
-        printf("Film grain is not supported!\n");
-        assert(0);
-        // TODO: reset_grain_params(grain_params);
+    if (!grain_params->apply_grain) {
+        memset(grain_params, 0, sizeof(*grain_params));
+        return;
     }
     grain_params->random_seed = dec_get_bits(bs, 16);
     PRINT_FRAME("grain_seed", grain_params->random_seed);
@@ -1383,11 +1392,12 @@ void read_film_grain_params(bitstrm_t *bs, aom_film_grain_t *grain_params,
         grain_params->update_parameters = 1;
     PRINT_FRAME("update_parameters", grain_params->update_parameters);
     if (!grain_params->update_parameters) {
-        /*film_grain_params_ref_idx = */dec_get_bits(bs, 3);
-        /*PRINT_FRAME("film_grain_params_ref_idx", film_grain_params_ref_idx);*/
+        film_grain_params_ref_idx = dec_get_bits(bs, 3);
+        PRINT_FRAME("film_grain_params_ref_idx", film_grain_params_ref_idx);
         temp_grain_seed = grain_params->random_seed;
-        // TODO: Handle while implementing Inter
-        // load_grain_params( film_grain_params_ref_idx );
+        /* load_grain_params() */
+        *grain_params = dec_handle_ptr->
+            ref_frame_map[film_grain_params_ref_idx]->film_grain_params;
         grain_params->random_seed = temp_grain_seed;
         return;
     }
@@ -1447,9 +1457,9 @@ void read_film_grain_params(bitstrm_t *bs, aom_film_grain_t *grain_params,
         ((grain_params->num_cb_points != 0) && (grain_params->num_cr_points == 0))))
         return;// EB_DecUnsupportedBitstream;
 
-    grain_params->grain_scale_shift = dec_get_bits(bs, 2) + 8;
+    grain_params->scaling_shift = dec_get_bits(bs, 2) + 8;
     grain_params->ar_coeff_lag = dec_get_bits(bs, 2);
-    PRINT_FRAME("scaling_shift", grain_params->grain_scale_shift);
+    PRINT_FRAME("scaling_shift", grain_params->scaling_shift);
     PRINT_FRAME("ar_coeff_lag", grain_params->ar_coeff_lag);
 
     numPosLuma = 2 * grain_params->ar_coeff_lag * (grain_params->ar_coeff_lag + 1);
@@ -1577,6 +1587,59 @@ void setup_past_independence(EbDecHandle *dec_handle_ptr,
     frame_info->loop_filter_params.mode_deltas[1] = 0;
 }
 
+/* Sets the tiles that are reconstructed : the ones of the region of
+   interest and of the superblocks all around it, whose filtering reaches
+   into it. Intra prediction does not cross tiles, so these are exact.
+   Reference frames are reconstructed in full : unless the tiles are motion
+   constrained, the motion vectors of the later frames reach anywhere in
+   them, from one reference to the next. Intra block copy and
+   super-resolution frames are reconstructed in full too */
+static void setup_dec_area(EbDecHandle *dec_handle_ptr, FrameHeader *frame_info)
+{
+    EbSvtAv1DecConfiguration *config = &dec_handle_ptr->dec_config;
+    TilesInfo *tiles_info = &frame_info->tiles_info;
+    TileInfo *area = &dec_handle_ptr->dec_area;
+    int32_t sb_mi_size = dec_handle_ptr->seq_header.sb_mi_size;
+
+    area->mi_row_start = 0;
+    area->mi_col_start = 0;
+    area->mi_row_end = frame_info->mi_rows;
+    area->mi_col_end = frame_info->mi_cols;
+
+    if (config->region_width == 0 || config->region_height == 0 ||
+        frame_info->refresh_frame_flags ||
+        frame_info->allow_intrabc || frame_info->frame_size.frame_width !=
+        frame_info->frame_size.superres_upscaled_width)
+        return;
+
+    /* In 4x4s, a region outside of the frame keeps its last 4x4 */
+    int32_t row_start = AOMMIN((int32_t)(config->region_top >> MI_SIZE_LOG2),
+        (int32_t)frame_info->mi_rows - 1) - sb_mi_size;
+    int32_t col_start = AOMMIN((int32_t)(config->region_left >> MI_SIZE_LOG2),
+        (int32_t)frame_info->mi_cols - 1) - sb_mi_size;
+    int32_t row_end = (int32_t)((config->region_top + config->region_height -
+        1) >> MI_SIZE_LOG2) + sb_mi_size;
+    int32_t col_end = (int32_t)((config->region_left + config->region_width -
+        1) >> MI_SIZE_LOG2) + sb_mi_size;
+
+    for (int i = 0; i < tiles_info->tile_rows; i++) {
+        if (tiles_info->tile_row_start_sb[i + 1] <= row_start)
+            area->mi_row_start = tiles_info->tile_row_start_sb[i + 1];
+        if (tiles_info->tile_row_start_sb[i] > row_end) {
+            area->mi_row_end = tiles_info->tile_row_start_sb[i];
+            break;
+        }
+    }
+    for (int i = 0; i < tiles_info->tile_cols; i++) {
+        if (tiles_info->tile_col_start_sb[i + 1] <= col_start)
+            area->mi_col_start = tiles_info->tile_col_start_sb[i + 1];
+        if (tiles_info->tile_col_start_sb[i] > col_end) {
+            area->mi_col_end = tiles_info->tile_col_start_sb[i];
+            break;
+        }
+    }
+}
+
 void read_uncompressed_header(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
                               ObuHeader *obu_header, int num_planes)
 {
@@ -1597,6 +1660,7 @@ void read_uncompressed_header(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
         assert(id_len <= 16);
     }
     allFrames = (1 << NUM_REF_FRAMES) - 1;
+    dec_handle_ptr->skip_frame = 0;
     if (seq_header->reduced_still_picture_header) {
         frame_info->show_existing_frame = 0;
         frame_info->frame_type = KEY_FRAME;
@@ -1627,13 +1691,15 @@ void read_uncompressed_header(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
             if (frame_info->frame_type == KEY_FRAME)
                 frame_info->refresh_frame_flags = allFrames;
             if (seq_header->film_grain_params_present)
-                // TODO: Handle while implementing Inter
-                // load_grain_params(frame_to_show_map_idx);
-                assert(0);
+                /* load_grain_params() */
+                frame_info->film_grain_params = dec_handle_ptr->
+                    ref_frame_map[frame_to_show_map_idx]->film_grain_params;
 
             dec_handle_ptr->cur_pic_buf[0] = dec_handle_ptr->
                 ref_frame_map[frame_to_show_map_idx];
             generate_next_ref_frame_map(dec_handle_ptr);
+            dec_handle_ptr->show_existing_frame = 1;
+            dec_handle_ptr->show_frame = 1;
             return;
         }
 
@@ -1919,10 +1985,13 @@ void read_uncompressed_header(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
     if (frame_info->primary_ref_frame == PRIMARY_REF_NONE)
         reset_parse_ctx(&parse_ctxt->init_frm_ctx,
             frame_info->quantization_params.base_q_idx);
-    else
-        /* Load CDF */
-        parse_ctxt->init_frm_ctx = get_ref_frame_buf(dec_handle_ptr,
-            frame_info->primary_ref_frame + 1)->final_frm_ctx;
+    else {
+        EbDecPicBuf *primary_buf = get_ref_frame_buf(dec_handle_ptr,
+            frame_info->primary_ref_frame + 1);
+        /* Load CDF, once a frame thread has parsed the reference */
+        dec_pic_wait_parse_done(primary_buf);
+        parse_ctxt->init_frm_ctx = primary_buf->final_frm_ctx;
+    }
 
     frame_info->coded_lossless = 1;
     for (int i = 0; i < MAX_SEGMENTS; ++i) {
@@ -1978,14 +2047,27 @@ void read_uncompressed_header(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
     PRINT_FRAME("allow_warped_motion", frame_info->allow_warped_motion);
     PRINT_FRAME("reduced_tx_set", frame_info->reduced_tx_set);
     read_global_motion_params(bs, dec_handle_ptr, frame_info, FrameIsIntra);
-    read_film_grain_params(bs, &frame_info->film_grain_params, seq_header, frame_info);
+    read_film_grain_params(bs, dec_handle_ptr, &frame_info->film_grain_params,
+        seq_header, frame_info);
+    dec_handle_ptr->cur_pic_buf[0]->film_grain_params =
+        frame_info->film_grain_params;
 
     dec_handle_ptr->show_existing_frame = frame_info->show_existing_frame;
     dec_handle_ptr->show_frame          = frame_info->show_frame;
     dec_handle_ptr->showable_frame      = frame_info->showable_frame;
 
+    /* A frame no other frame references is only decoded to be output */
+    dec_handle_ptr->skip_frame = frame_info->refresh_frame_flags == 0 &&
+        (!frame_info->show_frame ||
+         dec_handle_ptr->dec_config.skip_non_ref_frames ||
+         dec_handle_ptr->shown_frame_cnt < dec_handle_ptr->dec_config.skip_frames);
+
+    setup_dec_area(dec_handle_ptr, frame_info);
+
     /* TODO: Should be moved to caller */
-    if(!frame_info->show_existing_frame)
+    /* Frame threads set up the motion field of their own frame */
+    if(!frame_info->show_existing_frame && !dec_handle_ptr->skip_frame &&
+        dec_handle_ptr->pv_frame_mt_ctxt == NULL)
         svt_setup_motion_field(dec_handle_ptr);
 }
 
@@ -2112,15 +2194,52 @@ void clear_loop_restoration(int num_planes, PartitionInfo_t *part_info)
     }
 }
 
-EbErrorType parse_tile(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
+/* Waits for a counter of the parse / reconstruction pipeline to reach value,
+   on the semaphore of thread thread_idx. Returns 0 if the pipeline was
+   aborted before */
+static int wait_recon(DecTileMtCtxt *tile_mt_ctxt, int32_t thread_idx,
+                      volatile uint32_t *counter, uint32_t value)
+{
+    if (eb_atomic_load_u32(counter) >= value)
+        return 1;
+
+    eb_block_on_mutex(tile_mt_ctxt->recon_mutex);
+    while (*counter < value && !tile_mt_ctxt->recon_abort) {
+        tile_mt_ctxt->recon_waiting[thread_idx] = 1;
+        eb_release_mutex(tile_mt_ctxt->recon_mutex);
+        eb_block_on_semaphore(tile_mt_ctxt->recon_semaphores[thread_idx]);
+        eb_block_on_mutex(tile_mt_ctxt->recon_mutex);
+    }
+    eb_release_mutex(tile_mt_ctxt->recon_mutex);
+    return *counter >= value;
+}
+
+static void set_recon_counter(DecTileMtCtxt *tile_mt_ctxt,
+                              volatile uint32_t *counter, uint32_t value)
+{
+    eb_block_on_mutex(tile_mt_ctxt->recon_mutex);
+    eb_atomic_store_u32(counter, value);
+    for (int32_t i = 0; i <= tile_mt_ctxt->num_workers; i++) {
+        if (tile_mt_ctxt->recon_waiting[i]) {
+            tile_mt_ctxt->recon_waiting[i] = 0;
+            eb_post_semaphore(tile_mt_ctxt->recon_semaphores[i]);
+        }
+    }
+    eb_release_mutex(tile_mt_ctxt->recon_mutex);
+}
+
+EbErrorType parse_tile(EbDecHandle *dec_handle_ptr,
                        TilesInfo *tile_info, int32_t tile_row, int32_t tile_col)
 {
-    (void)bs;
     EbErrorType status = EB_ErrorNone;
 
     EbColorConfig *color_config = &dec_handle_ptr->seq_header.color_config;
     int num_planes = av1_num_planes(color_config);
 
+    /* Reconstruction is left to the pipeline's workers */
+    DecTileMtCtxt *tile_mt_ctxt = (DecTileMtCtxt *)dec_handle_ptr->pv_tile_mt_ctxt;
+    int recon_pipeline = tile_mt_ctxt != NULL && tile_mt_ctxt->recon;
+
     clear_above_context(dec_handle_ptr, tile_info->tile_col_start_sb[tile_col],
                         tile_info->tile_col_start_sb[tile_col + 1], 0 /*TODO: For MultiThread*/);
     clear_loop_filter_delta(dec_handle_ptr);
@@ -2194,10 +2313,23 @@ EbErrorType parse_tile(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
                 (sb_row * num_mis_in_sb * master_frame_buf->sb_cols >> sy) +
                 (sb_col * num_mis_in_sb >> sx);
 #if SINGLE_THRD_COEFF_BUF_OPT
-            /*TODO : Change to macro */
-            sb_info->sb_coeff[AOM_PLANE_Y] = frame_buf->coeff[AOM_PLANE_Y];
-            sb_info->sb_coeff[AOM_PLANE_U] = frame_buf->coeff[AOM_PLANE_U];
-            sb_info->sb_coeff[AOM_PLANE_V] = frame_buf->coeff[AOM_PLANE_V];
+            if (recon_pipeline) {
+                /* Kept until the SB is reconstructed */
+                int32_t sb_coeffs = ((sb_row * master_frame_buf->sb_cols) +
+                    sb_col) * num_mis_in_sb * (16 + 1);
+                sb_info->sb_coeff[AOM_PLANE_Y] =
+                    tile_mt_ctxt->coeff[AOM_PLANE_Y] + sb_coeffs;
+                sb_info->sb_coeff[AOM_PLANE_U] =
+                    tile_mt_ctxt->coeff[AOM_PLANE_U] + (sb_coeffs >> 2);
+                sb_info->sb_coeff[AOM_PLANE_V] =
+                    tile_mt_ctxt->coeff[AOM_PLANE_V] + (sb_coeffs >> 2);
+            }
+            else {
+                /*TODO : Change to macro */
+                sb_info->sb_coeff[AOM_PLANE_Y] = frame_buf->coeff[AOM_PLANE_Y];
+                sb_info->sb_coeff[AOM_PLANE_U] = frame_buf->coeff[AOM_PLANE_U];
+                sb_info->sb_coeff[AOM_PLANE_V] = frame_buf->coeff[AOM_PLANE_V];
+            }
 #else
             /*TODO : Change to macro */
             sb_info->sb_coeff[AOM_PLANE_Y] = frame_buf->coeff[AOM_PLANE_Y] +
@@ -2271,8 +2403,13 @@ EbErrorType parse_tile(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
             parse_super_block(dec_handle_ptr, mi_row, mi_col, sb_info);
 
             /* TO DO : Will move later */
-            // decoding of the superblock
-            decode_super_block(dec_mod_ctxt, mi_row, mi_col, sb_info);
+            // decoding of the superblock, in the decoded area only
+            if (recon_pipeline)
+                set_recon_counter(tile_mt_ctxt, &tile_mt_ctxt->sb_parsed[
+                    sb_row * master_frame_buf->sb_cols + sb_col], 1);
+            else if (in_dec_area(&dec_handle_ptr->dec_area, mi_row, mi_col,
+                dec_handle_ptr->seq_header.sb_mi_size))
+                decode_super_block(dec_mod_ctxt, mi_row, mi_col, sb_info);
 #if !FRAME_MI_MAP
             /* nbr updates at SB level */
             update_nbrs_after_sb(&master_frame_buf->frame_mi_map, sb_col);
@@ -2331,6 +2468,425 @@ void svt_tile_init(TileInfo *cur_tile_info, FrameHeader *frame_header,
     assert(cur_tile_info->mi_col_end > cur_tile_info->mi_col_start);
 }
 
+/* Whether the tile has to be entropy decoded. The modes of a frame no other
+   frame references are only read by the reconstruction and the filters of
+   the decoded area : around it, one superblock for the neighbour modes, and
+   the restoration units it overlaps for their coefficients */
+static int tile_is_parsed(EbDecHandle *dec_handle_ptr, TilesInfo *tiles_info,
+                          TileInfo *tile, int tile_num)
+{
+    FrameHeader *frame_header = &dec_handle_ptr->frame_header;
+    EbColorConfig *color_config = &dec_handle_ptr->seq_header.color_config;
+    TileInfo *area = &dec_handle_ptr->dec_area;
+    int32_t border = dec_handle_ptr->seq_header.sb_mi_size;
+
+    if (frame_header->refresh_frame_flags ||
+        (!frame_header->disable_frame_end_update_cdf &&
+         tile_num == tiles_info->context_update_tile_id))
+        return 1;
+
+    for (int plane = 0; plane < av1_num_planes(color_config); plane++) {
+        LRParams *lr_params = &frame_header->lr_params[plane];
+        int32_t ss = plane ? color_config->subsampling_x : 0;
+
+        if (lr_params->frame_restoration_type != RESTORE_NONE)
+            border = AOMMAX(border, ((lr_params->loop_restoration_size * 3 / 2)
+                << ss) >> MI_SIZE_LOG2);
+    }
+
+    return tile->mi_row_start < area->mi_row_end + border &&
+        tile->mi_row_end > area->mi_row_start - border &&
+        tile->mi_col_start < area->mi_col_end + border &&
+        tile->mi_col_end > area->mi_col_start - border;
+}
+
+/* Parses and decodes one tile, on the main handle or a tile worker's view */
+static EbErrorType decode_tile(EbDecHandle *dec_handle_ptr,
+                               TilesInfo *tiles_info, DecTileJob *job)
+{
+    EbErrorType status = EB_ErrorNone;
+
+    ParseCtxt   *parse_ctxt = (ParseCtxt *)dec_handle_ptr->pv_parse_ctxt;
+
+    FrameHeader *frame_header = &dec_handle_ptr->frame_header;
+
+    int tile_row = job->tile_num / tiles_info->tile_cols;
+    int tile_col = job->tile_num % tiles_info->tile_cols;
+
+    svt_tile_init(&parse_ctxt->cur_tile_info, frame_header,
+                    tile_row, tile_col);
+
+    if (!tile_is_parsed(dec_handle_ptr, tiles_info, &parse_ctxt->cur_tile_info,
+        job->tile_num))
+        return status;
+
+    parse_ctxt->parse_nbr4x4_ctxt.cur_q_ind =
+        frame_header->quantization_params.base_q_idx;
+
+    //init_symbol(tileSize)
+
+    status = init_svt_reader(&parse_ctxt->r, job->data, job->data_end,
+        job->size, !(frame_header->disable_cdf_update));
+    if (status != EB_ErrorNone)
+        return status;
+#if 0
+    reset_parse_ctx(&parse_ctxt->frm_ctx[0],
+        frame_header->quantization_params.base_q_idx);
+#else
+    parse_ctxt->cur_tile_ctx = parse_ctxt->init_frm_ctx;
+#endif
+    status = parse_tile(dec_handle_ptr, tiles_info, tile_row, tile_col);
+
+    /* Save CDF */
+    if (!frame_header->disable_frame_end_update_cdf &&
+        (job->tile_num == tiles_info->context_update_tile_id))
+    {
+        dec_handle_ptr->cur_pic_buf[0]->final_frm_ctx =
+                                    parse_ctxt->cur_tile_ctx;
+        eb_av1_reset_cdf_symbol_counters(&dec_handle_ptr->cur_pic_buf[0]->final_frm_ctx);
+    }
+
+    return status;
+}
+
+/* Refreshes the worker's view of the handle with the current frame state */
+static void sync_tile_worker(DecTileWorker *worker, EbDecHandle *dec_handle_ptr)
+{
+    EbDecHandle *worker_handle = &worker->dec_handle;
+    ParseCtxt   *parse_ctxt = (ParseCtxt *)worker_handle->pv_parse_ctxt;
+    DecModCtxt  *dec_mod_ctxt = (DecModCtxt *)worker_handle->pv_dec_mod_ctxt;
+    CurFrameBuf *cur_frame_buf = &worker_handle->master_frame_buf.cur_frame_bufs[0];
+    int32_t     *coeff[MAX_MB_PLANE];
+
+    for (int plane = 0; plane < MAX_MB_PLANE; plane++)
+        coeff[plane] = cur_frame_buf->coeff[plane];
+
+    *worker_handle = *dec_handle_ptr;
+
+    worker_handle->pv_parse_ctxt = (void *)parse_ctxt;
+    worker_handle->pv_dec_mod_ctxt = (void *)dec_mod_ctxt;
+    worker_handle->pv_tile_mt_ctxt = NULL;
+#if SINGLE_THRD_COEFF_BUF_OPT
+    for (int plane = 0; plane < MAX_MB_PLANE; plane++)
+        cur_frame_buf->coeff[plane] = coeff[plane];
+#endif
+
+    /* Frame level state of the module contexts */
+    parse_ctxt->init_frm_ctx =
+        ((ParseCtxt *)dec_handle_ptr->pv_parse_ctxt)->init_frm_ctx;
+    dec_mod_ctxt->dequants =
+        ((DecModCtxt *)dec_handle_ptr->pv_dec_mod_ctxt)->dequants;
+}
+
+/* Decodes queued tiles until none is left */
+static void decode_tile_jobs(EbDecHandle *dec_handle_ptr,
+                             DecTileMtCtxt *tile_mt_ctxt)
+{
+    uint32_t job_idx;
+
+    while ((job_idx = eb_atomic_add_u32(&tile_mt_ctxt->next_job, 1) - 1) <
+        (uint32_t)tile_mt_ctxt->num_jobs)
+    {
+        DecTileJob *job = &tile_mt_ctxt->jobs[job_idx];
+        job->status = decode_tile(dec_handle_ptr, tile_mt_ctxt->tiles_info, job);
+    }
+}
+
+/* Reconstructs SB rows of the frame being parsed until none is left. A row
+   is done left to right, each SB once it is parsed and the row above is two
+   SBs ahead, for the above right pixels of intra prediction. Intra block
+   copy may read anywhere above, so then the row above has to be complete */
+static void recon_sb_rows(EbDecHandle *dec_handle_ptr,
+                          DecTileMtCtxt *tile_mt_ctxt, int32_t thread_idx)
+{
+    FrameHeader    *frame_header = &dec_handle_ptr->frame_header;
+    TilesInfo      *tiles_info = tile_mt_ctxt->tiles_info;
+    MasterFrameBuf *master_frame_buf = &dec_handle_ptr->master_frame_buf;
+    CurFrameBuf    *frame_buf = &master_frame_buf->cur_frame_bufs[0];
+    DecModCtxt     *dec_mod_ctxt = (DecModCtxt *)dec_handle_ptr->pv_dec_mod_ctxt;
+    int32_t  sb_mi_size = dec_handle_ptr->seq_header.sb_mi_size;
+    uint32_t sb_cols = (frame_header->mi_cols + sb_mi_size - 1) / sb_mi_size;
+    uint32_t sb_row;
+    TileInfo tile_info;
+
+    while ((sb_row = eb_atomic_add_u32(&tile_mt_ctxt->next_recon_row, 1) - 1) <
+        (uint32_t)tile_mt_ctxt->recon_rows)
+    {
+        int32_t mi_row = sb_row * sb_mi_size;
+        int32_t tile_row = 0, tile_col = -1;
+
+        while (tiles_info->tile_row_start_sb[tile_row + 1] <= mi_row)
+            tile_row++;
+        tile_info.mi_col_end = 0;
+
+        for (uint32_t sb_col = 0; sb_col < sb_cols; sb_col++) {
+            int32_t mi_col = sb_col * sb_mi_size;
+            uint32_t above_cols = frame_header->allow_intrabc ? sb_cols :
+                AOMMIN(sb_col + 2, sb_cols);
+
+            if (mi_col >= tile_info.mi_col_end) {
+                svt_tile_init(&tile_info, frame_header, tile_row, ++tile_col);
+                cfl_init(&dec_mod_ctxt->cfl_ctx,
+                    &dec_handle_ptr->seq_header.color_config);
+            }
+
+            /* The tiles left unparsed are out of the decoded area */
+            if (in_dec_area(&dec_handle_ptr->dec_area, mi_row, mi_col,
+                sb_mi_size))
+            {
+                SBInfo *sb_info = frame_buf->sb_info +
+                    (sb_row * master_frame_buf->sb_cols) + sb_col;
+
+                if (!wait_recon(tile_mt_ctxt, thread_idx, &tile_mt_ctxt->sb_parsed[
+                    sb_row * master_frame_buf->sb_cols + sb_col], 1))
+                    return;
+                if (sb_row > 0 && !wait_recon(tile_mt_ctxt, thread_idx,
+                    &tile_mt_ctxt->recon_progress[sb_row - 1], above_cols))
+                    return;
+
+                dec_mod_ctxt->cur_coeff[AOM_PLANE_Y] = sb_info->sb_coeff[AOM_PLANE_Y];
+                dec_mod_ctxt->cur_coeff[AOM_PLANE_U] = sb_info->sb_coeff[AOM_PLANE_U];
+                dec_mod_ctxt->cur_coeff[AOM_PLANE_V] = sb_info->sb_coeff[AOM_PLANE_V];
+                dec_mod_ctxt->cur_tile_info = &tile_info;
+
+                decode_super_block(dec_mod_ctxt, mi_row, mi_col, sb_info);
+            }
+            set_recon_counter(tile_mt_ctxt,
+                &tile_mt_ctxt->recon_progress[sb_row], sb_col + 1);
+        }
+    }
+}
+
+/* Starts the reconstruction workers on the frame about to be parsed */
+static void start_recon_pipeline(EbDecHandle *dec_handle_ptr,
+                                 DecTileMtCtxt *tile_mt_ctxt,
+                                 TilesInfo *tiles_info)
+{
+    MasterFrameBuf *master_frame_buf = &dec_handle_ptr->master_frame_buf;
+    int32_t sb_mi_size = dec_handle_ptr->seq_header.sb_mi_size;
+    int32_t sb_rows = (dec_handle_ptr->frame_header.mi_rows + sb_mi_size - 1) /
+        sb_mi_size;
+
+    memset((void *)tile_mt_ctxt->sb_parsed, 0,
+        sb_rows * master_frame_buf->sb_cols * sizeof(uint32_t));
+    memset((void *)tile_mt_ctxt->recon_progress, 0, sb_rows * sizeof(uint32_t));
+    tile_mt_ctxt->tiles_info = tiles_info;
+    tile_mt_ctxt->recon_rows = sb_rows;
+    tile_mt_ctxt->next_recon_row = 0;
+    tile_mt_ctxt->recon_abort = 0;
+    tile_mt_ctxt->recon = 1;
+
+    for (int i = 0; i < tile_mt_ctxt->num_workers; i++) {
+        sync_tile_worker(&tile_mt_ctxt->workers[i], dec_handle_ptr);
+        eb_post_semaphore(tile_mt_ctxt->workers[i].start_semaphore);
+    }
+}
+
+/* Once all tiles are parsed, the calling thread reconstructs rows too. After
+   a parse error the workers stop at the first SB left unparsed */
+static void finish_recon_pipeline(EbDecHandle *dec_handle_ptr,
+                                  DecTileMtCtxt *tile_mt_ctxt,
+                                  EbErrorType status)
+{
+    if (status == EB_ErrorNone)
+        recon_sb_rows(dec_handle_ptr, tile_mt_ctxt, tile_mt_ctxt->num_workers);
+    else
+        set_recon_counter(tile_mt_ctxt, &tile_mt_ctxt->recon_abort, 1);
+
+    for (int i = 0; i < tile_mt_ctxt->num_workers; i++)
+        eb_block_on_semaphore(tile_mt_ctxt->done_semaphore);
+    tile_mt_ctxt->recon = 0;
+}
+
+void *dec_tile_worker_kernel(void *input_ptr)
+{
+    DecTileWorker *worker = (DecTileWorker *)input_ptr;
+    DecTileMtCtxt *tile_mt_ctxt = (DecTileMtCtxt *)worker->pv_tile_mt_ctxt;
+
+    for (;;) {
+        eb_block_on_semaphore(worker->start_semaphore);
+
+        if (tile_mt_ctxt->post_filter) {
+            DecPfCtxt *pf_ctxt = (DecPfCtxt *)tile_mt_ctxt->pv_pf_ctxt;
+            dec_pf_run_jobs(pf_ctxt,
+                &pf_ctxt->scratch[worker - tile_mt_ctxt->workers]);
+        }
+        else if (tile_mt_ctxt->recon)
+            recon_sb_rows(&worker->dec_handle, tile_mt_ctxt,
+                (int32_t)(worker - tile_mt_ctxt->workers));
+        else
+            decode_tile_jobs(&worker->dec_handle, tile_mt_ctxt);
+
+        eb_post_semaphore(tile_mt_ctxt->done_semaphore);
+    }
+    return NULL;
+}
+
+EbErrorType read_tile_group_obu(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
+                                TilesInfo *tiles_info, ObuHeader *obu_header);
+
+/* Refreshes the slot's view of the handle with the frame whose header the
+   main handle has just parsed */
+static void sync_frame_slot(DecFrameSlot *slot, EbDecHandle *dec_handle_ptr)
+{
+    EbDecHandle *slot_handle = &slot->dec_handle;
+    ParseCtxt   *parse_ctxt = (ParseCtxt *)slot_handle->pv_parse_ctxt;
+    DecModCtxt  *dec_mod_ctxt = (DecModCtxt *)slot_handle->pv_dec_mod_ctxt;
+    void        *lf_ctxt = slot_handle->pv_lf_ctxt;
+    void        *lr_ctxt = slot_handle->pv_lr_ctxt;
+    void        *pf_ctxt = slot_handle->pv_pf_ctxt;
+    void        *tile_mt_ctxt = slot_handle->pv_tile_mt_ctxt;
+    MasterFrameBuf master_frame_buf = slot_handle->master_frame_buf;
+
+    *slot_handle = *dec_handle_ptr;
+
+    slot_handle->pv_parse_ctxt = (void *)parse_ctxt;
+    slot_handle->pv_dec_mod_ctxt = (void *)dec_mod_ctxt;
+    slot_handle->pv_lf_ctxt = lf_ctxt;
+    slot_handle->pv_lr_ctxt = lr_ctxt;
+    slot_handle->pv_pf_ctxt = pf_ctxt;
+    slot_handle->pv_tile_mt_ctxt = tile_mt_ctxt;
+    slot_handle->pv_frame_mt_ctxt = NULL;
+    slot_handle->master_frame_buf = master_frame_buf;
+
+    /* Frame level state set while parsing the frame header */
+    memcpy(slot_handle->master_frame_buf.cur_frame_bufs[0].global_motion_warp,
+        dec_handle_ptr->master_frame_buf.cur_frame_bufs[0].global_motion_warp,
+        sizeof(master_frame_buf.cur_frame_bufs[0].global_motion_warp));
+    parse_ctxt->init_frm_ctx =
+        ((ParseCtxt *)dec_handle_ptr->pv_parse_ctxt)->init_frm_ctx;
+    dec_mod_ctxt->dequants =
+        ((DecModCtxt *)dec_handle_ptr->pv_dec_mod_ctxt)->dequants;
+}
+
+/* Waits for a frame thread and drops the pictures it held */
+static void retire_frame_slot(DecFrameMtCtxt *frame_mt_ctxt, DecFrameSlot *slot)
+{
+    if (!slot->busy)
+        return;
+
+    eb_block_on_semaphore(slot->done_semaphore);
+    if (frame_mt_ctxt->status == EB_ErrorNone)
+        frame_mt_ctxt->status = slot->status;
+
+    dec_pic_mgr_release_pic(slot->cur_buf);
+    slot->cur_buf = NULL;
+    for (int i = 0; i < REF_FRAMES; i++) {
+        dec_pic_mgr_release_pic(slot->ref_bufs[i]);
+        slot->ref_bufs[i] = NULL;
+    }
+    slot->busy = 0;
+}
+
+EbErrorType dec_frame_mt_flush(EbDecHandle *dec_handle_ptr)
+{
+    DecFrameMtCtxt *frame_mt_ctxt = (DecFrameMtCtxt *)dec_handle_ptr->pv_frame_mt_ctxt;
+    EbErrorType status;
+
+    if (frame_mt_ctxt == NULL)
+        return EB_ErrorNone;
+
+    /* Oldest first */
+    for (int i = 0; i < frame_mt_ctxt->num_slots; i++) {
+        int32_t slot_idx = (frame_mt_ctxt->next_slot + i) % frame_mt_ctxt->num_slots;
+        retire_frame_slot(frame_mt_ctxt, &frame_mt_ctxt->slots[slot_idx]);
+    }
+    status = frame_mt_ctxt->status;
+    frame_mt_ctxt->status = EB_ErrorNone;
+    return status;
+}
+
+/* Hands the tile group of the current frame over to the next frame thread,
+   once the oldest frame in flight is done with it */
+static EbErrorType queue_frame(EbDecHandle *dec_handle_ptr, bitstrm_t *bs,
+                               ObuHeader *obu_header)
+{
+    DecFrameMtCtxt *frame_mt_ctxt = (DecFrameMtCtxt *)dec_handle_ptr->pv_frame_mt_ctxt;
+    DecFrameSlot   *slot = &frame_mt_ctxt->slots[frame_mt_ctxt->next_slot];
+    EbErrorType     status;
+
+    retire_frame_slot(frame_mt_ctxt, slot);
+
+    memcpy(slot->data, get_bitsteam_buf(bs), obu_header->payload_size);
+    slot->data_size = obu_header->payload_size;
+    slot->obu_header = *obu_header;
+
+    sync_frame_slot(slot, dec_handle_ptr);
+
+    /* Temporal MVs allocation, here as it updates the memory map */
+    status = check_add_tplmv_buf(&slot->dec_handle);
+    if (status != EB_ErrorNone)
+        return status;
+
+    /* The frame keeps its picture and references alive until retired */
+    slot->cur_buf = dec_handle_ptr->cur_pic_buf[0];
+    slot->cur_buf->ref_count++;
+    for (int i = 0; i < REF_FRAMES; i++) {
+        slot->ref_bufs[i] = dec_handle_ptr->ref_frame_map[i];
+        if (slot->ref_bufs[i] != NULL)
+            slot->ref_bufs[i]->ref_count++;
+    }
+    slot->status = EB_ErrorNone;
+    slot->busy = 1;
+
+    frame_mt_ctxt->next_slot = (frame_mt_ctxt->next_slot + 1) %
+        frame_mt_ctxt->num_slots;
+    eb_post_semaphore(slot->start_semaphore);
+
+    return EB_ErrorNone;
+}
+
+static EbErrorType decode_frame_slot(DecFrameSlot *slot)
+{
+    EbDecHandle *dec_handle_ptr = &slot->dec_handle;
+    FrameHeader *frame_header = &dec_handle_ptr->frame_header;
+    bitstrm_t   bs;
+
+    /* The motion field projection reads the MVs of the references */
+    if (frame_header->use_ref_frame_mvs) {
+        for (int ref_frame = LAST_FRAME; ref_frame <= ALTREF_FRAME; ref_frame++) {
+            EbDecPicBuf *buf = get_ref_frame_buf(dec_handle_ptr, ref_frame);
+            if (buf != NULL)
+                dec_pic_wait_parse_done(buf);
+        }
+    }
+    svt_setup_motion_field(dec_handle_ptr);
+
+    dec_bits_init(&bs, slot->data, slot->data_size);
+    return read_tile_group_obu(&bs, dec_handle_ptr, &frame_header->tiles_info,
+        &slot->obu_header);
+}
+
+void *dec_frame_worker_kernel(void *input_ptr)
+{
+    DecFrameSlot *slot = (DecFrameSlot *)input_ptr;
+
+    for (;;) {
+        eb_block_on_semaphore(slot->start_semaphore);
+
+        slot->status = decode_frame_slot(slot);
+
+        eb_post_semaphore(slot->done_semaphore);
+    }
+    return NULL;
+}
+
+/* Reads the tile range of a tile group without consuming the bitstream */
+static void peek_tile_group_range(bitstrm_t *bs, TilesInfo *tiles_info,
+                                  int *tg_start, int *tg_end)
+{
+    bitstrm_t peek_bs = *bs;
+    int num_tiles = tiles_info->tile_cols * tiles_info->tile_rows;
+    int tile_bits = tiles_info->tile_cols_log2 + tiles_info->tile_rows_log2;
+
+    *tg_start = 0;
+    *tg_end = num_tiles - 1;
+    if (num_tiles > 1 && dec_get_bits(&peek_bs, 1)) {
+        *tg_start = dec_get_bits(&peek_bs, tile_bits);
+        *tg_end = dec_get_bits(&peek_bs, tile_bits);
+    }
+}
+
 // Read Tile group information
 EbErrorType read_tile_group_obu(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
                                 TilesInfo *tiles_info, ObuHeader *obu_header)
@@ -2342,11 +2898,26 @@ EbErrorType read_tile_group_obu(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
     FrameHeader *frame_header = &dec_handle_ptr->frame_header;
 
     int num_tiles, tg_start, tg_end, tile_bits, tile_start_and_end_present_flag = 0;
-    int tile_row, tile_col;
     size_t tile_size;
     uint32_t start_position, end_position, header_bytes;
     num_tiles = tiles_info->tile_cols * tiles_info->tile_rows;
 
+    DecFrameMtCtxt *frame_mt_ctxt = (DecFrameMtCtxt *)dec_handle_ptr->pv_frame_mt_ctxt;
+
+    if (frame_mt_ctxt != NULL) {
+        peek_tile_group_range(bs, tiles_info, &tg_start, &tg_end);
+        if (tg_start == 0 && tg_end == num_tiles - 1 &&
+            obu_header->payload_size <= frame_mt_ctxt->slots[0].data_alloc)
+            return queue_frame(dec_handle_ptr, bs, obu_header);
+
+        /* Decoded here, once every frame in flight is done */
+        status = dec_frame_mt_flush(dec_handle_ptr);
+        if (status != EB_ErrorNone)
+            return status;
+        if (tg_start == 0)
+            svt_setup_motion_field(dec_handle_ptr);
+    }
+
     start_position = get_position(bs);
     if (num_tiles > 1) {
         tile_start_and_end_present_flag = dec_get_bits(bs, 1);
@@ -2373,68 +2944,110 @@ EbErrorType read_tile_group_obu(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
     header_bytes = (end_position - start_position) / 8;
     obu_header->payload_size -= header_bytes;
 
-    for (int tile_num = tg_start; tile_num <= tg_end; tile_num++) {
-        tile_row = tile_num / tiles_info->tile_cols;
-        tile_col = tile_num % tiles_info->tile_cols;
+    DecTileMtCtxt *tile_mt_ctxt = (DecTileMtCtxt *)dec_handle_ptr->pv_tile_mt_ctxt;
 
-        if (tile_num == tg_end)
-            tile_size = obu_header->payload_size;
-        else {
-            tile_size = dec_get_bits_le(bs, tiles_info->tile_size_bytes) + 1;
-            obu_header->payload_size -= (tiles_info->tile_size_bytes + tile_size);
+    /* Parse / reconstruction pipeline over the tiles of a whole frame */
+    const int recon_pipeline = tile_mt_ctxt != NULL &&
+        dec_handle_ptr->dec_config.pipeline_recon &&
+        tg_start == 0 && tg_end == num_tiles - 1;
+
+    if (tile_mt_ctxt != NULL && tg_end > tg_start && !recon_pipeline) {
+        /* Queue all tiles of the group, then decode them concurrently */
+        DecTileJob *job = tile_mt_ctxt->jobs;
+        for (int tile_num = tg_start; tile_num <= tg_end; tile_num++, job++) {
+            if (tile_num == tg_end)
+                tile_size = obu_header->payload_size;
+            else {
+                tile_size = dec_get_bits_le(bs, tiles_info->tile_size_bytes) + 1;
+                obu_header->payload_size -= (tiles_info->tile_size_bytes + tile_size);
+            }
+            PRINT_FRAME("tile_size", (tile_size));
+            job->data = (const uint8_t *)get_bitsteam_buf(bs);
+            job->data_end = bs->buf_max;
+            job->size = tile_size;
+            job->tile_num = tile_num;
+            job->status = EB_ErrorNone;
+            if (tile_num != tg_end)
+                dec_bits_init(bs, job->data + tile_size, obu_header->payload_size);
+        }
+        tile_mt_ctxt->tiles_info = tiles_info;
+        tile_mt_ctxt->num_jobs = tg_end - tg_start + 1;
+        tile_mt_ctxt->next_job = 0;
+
+        for (int i = 0; i < tile_mt_ctxt->num_workers; i++) {
+            sync_tile_worker(&tile_mt_ctxt->workers[i], dec_handle_ptr);
+            eb_post_semaphore(tile_mt_ctxt->workers[i].start_semaphore);
+        }
+        decode_tile_jobs(dec_handle_ptr, tile_mt_ctxt);
+        for (int i = 0; i < tile_mt_ctxt->num_workers; i++)
+            eb_block_on_semaphore(tile_mt_ctxt->done_semaphore);
+
+        for (int i = 0; i < tile_mt_ctxt->num_jobs; i++) {
+            if (tile_mt_ctxt->jobs[i].status != EB_ErrorNone) {
+                status = tile_mt_ctxt->jobs[i].status;
+                break;
+            }
         }
-        PRINT_FRAME("tile_size", (tile_size));
-        svt_tile_init(&parse_ctxt->cur_tile_info, frame_header,
-                        tile_row, tile_col);
+    }
+    else {
+        if (recon_pipeline)
+            start_recon_pipeline(dec_handle_ptr, tile_mt_ctxt, tiles_info);
 
-        parse_ctxt->parse_nbr4x4_ctxt.cur_q_ind =
-            frame_header->quantization_params.base_q_idx;
+        for (int tile_num = tg_start; tile_num <= tg_end; tile_num++) {
+            DecTileJob job;
 
-        //init_symbol(tileSize)
+            if (tile_num == tg_end)
+                tile_size = obu_header->payload_size;
+            else {
+                tile_size = dec_get_bits_le(bs, tiles_info->tile_size_bytes) + 1;
+                obu_header->payload_size -= (tiles_info->tile_size_bytes + tile_size);
+            }
+            PRINT_FRAME("tile_size", (tile_size));
+            job.data = (const uint8_t *)get_bitsteam_buf(bs);
+            job.data_end = bs->buf_max;
+            job.size = tile_size;
+            job.tile_num = tile_num;
 
-        status = init_svt_reader(&parse_ctxt->r,
-            (const uint8_t *)get_bitsteam_buf(bs), bs->buf_max, tile_size,
-            !(frame_header->disable_cdf_update));
-        if (status != EB_ErrorNone)
-            return status;
-#if 0
-        reset_parse_ctx(&parse_ctxt->frm_ctx[0],
-            frame_header->quantization_params.base_q_idx);
-#else
-        parse_ctxt->cur_tile_ctx = parse_ctxt->init_frm_ctx;
-#endif
-        /* TO DO decode_tile() */
-        status = parse_tile(bs, dec_handle_ptr, tiles_info, tile_row, tile_col);
+            status = decode_tile(dec_handle_ptr, tiles_info, &job);
 
-        /* Save CDF */
-        if (!frame_header->disable_frame_end_update_cdf &&
-            (tile_num == tiles_info->context_update_tile_id))
-        {
-            dec_handle_ptr->cur_pic_buf[0]->final_frm_ctx =
-                                        parse_ctxt->cur_tile_ctx;
-            eb_av1_reset_cdf_symbol_counters(&dec_handle_ptr->cur_pic_buf[0]->final_frm_ctx);
+            dec_bits_init(bs, (uint8_t *)job.data + tile_size, obu_header->payload_size);
+
+            if (status != EB_ErrorNone)
+                break;
         }
 
-        dec_bits_init(bs, (uint8_t *)parse_ctxt->r.ec.bptr, obu_header->payload_size);
+        if (recon_pipeline)
+            finish_recon_pipeline(dec_handle_ptr, tile_mt_ctxt, status);
+    }
+
+    /* The rest of the frame is in the next tile groups */
+    if (status == EB_ErrorNone && tg_end != num_tiles - 1)
+        return status;
 
-        if (status != EB_ErrorNone)
-            return status;
+    /* Save CDF */
+    if (frame_header->disable_frame_end_update_cdf)
+        dec_handle_ptr->cur_pic_buf[0]->final_frm_ctx = parse_ctxt->init_frm_ctx;
+
+    /* Frame threading : later frames can load the CDFs and MVs. Also after
+       an error, so that no frame waits on this one forever */
+    dec_pic_set_parse_done(dec_handle_ptr->cur_pic_buf[0]);
+    if (status != EB_ErrorNone) {
+        dec_pic_set_row_progress(dec_handle_ptr->cur_pic_buf[0],
+            DEC_PIC_ROWS_COMPLETE);
+        return status;
     }
 
+    /* Luma rows already padded and published to the frames referencing
+       the picture, which may be reading their borders by now */
+    uint32_t published_rows = 0;
+
     if (!dec_handle_ptr->frame_header.allow_intrabc) {
-        if (dec_handle_ptr->frame_header.loop_filter_params.filter_level[0] ||
-            dec_handle_ptr->frame_header.loop_filter_params.filter_level[1])
-        {
-            /*LF Trigger function for each frame*/
-            dec_av1_loop_filter_frame(&dec_handle_ptr->frame_header,
-                &dec_handle_ptr->seq_header,
-                dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf,
-                dec_handle_ptr->pv_lf_ctxt,
-                AOM_PLANE_Y, MAX_MB_PLANE
-            );
-        }
+        /* The output of a frame nothing references may be filtered less */
+        const int32_t skip_filters =
+            dec_handle_ptr->dec_config.skip_non_ref_filters &&
+            frame_header->refresh_frame_flags == 0;
 
-        const int32_t do_cdef =
+        const int32_t do_cdef = !skip_filters &&
             !frame_header->coded_lossless &&
             (frame_header->CDEF_params.cdef_bits ||
              frame_header->CDEF_params.cdef_y_strength[0] ||
@@ -2444,65 +3057,42 @@ EbErrorType read_tile_group_obu(bitstrm_t *bs, EbDecHandle *dec_handle_ptr,
             !av1_superres_scaled(&dec_handle_ptr->frame_header.frame_size);
 
         LRParams *lr_param = dec_handle_ptr->frame_header.lr_params;
-        int do_loop_restoration =
+        int do_loop_restoration = !skip_filters && (
             lr_param[AOM_PLANE_Y].frame_restoration_type != RESTORE_NONE ||
             lr_param[AOM_PLANE_U].frame_restoration_type != RESTORE_NONE ||
-            lr_param[AOM_PLANE_V].frame_restoration_type != RESTORE_NONE;
-
-        if (!opt_lr) {
-            if (do_loop_restoration)
-                dec_av1_loop_restoration_save_boundary_lines(dec_handle_ptr, 0);
-
-            /*Calling cdef frame level function*/
-            if (do_cdef) {
-                if (dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf->bit_depth == EB_8BIT)
-                    svt_cdef_frame(dec_handle_ptr);
-                else
-                    svt_cdef_frame_hbd(dec_handle_ptr);
-            }
-
-            if (do_loop_restoration) {
-                dec_av1_loop_restoration_save_boundary_lines(dec_handle_ptr, 1);
+            lr_param[AOM_PLANE_V].frame_restoration_type != RESTORE_NONE);
 
-                /* Padded bits are required for filtering pixel around frame boundary */
-                pad_pic(dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf);
-                dec_av1_loop_restoration_filter_frame(dec_handle_ptr, opt_lr);
-            }
-        }
-        else {
-            if (do_loop_restoration) {
-                /* Padded bits are required for filtering pixel around frame boundary */
-                pad_pic(dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf);
-                dec_av1_loop_restoration_filter_frame(dec_handle_ptr, opt_lr);
-            }
-        }
+        /* Deblocking, CDEF and LR one row after the other, on the tile
+           workers too if any */
+        dec_pf_frame(dec_handle_ptr, do_cdef, opt_lr, do_loop_restoration);
+        published_rows = ((DecPfCtxt *)dec_handle_ptr->pv_pf_ctxt)->
+            publish_rows << dec_handle_ptr->seq_header.sb_size_log2;
     }
 
-    /* Save CDF */
-    if (frame_header->disable_frame_end_update_cdf)
-        dec_handle_ptr->cur_pic_buf[0]->final_frm_ctx = parse_ctxt->init_frm_ctx;
+    pad_pic_rows(dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf, published_rows,
+        dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf->height);
 
-    pad_pic(dec_handle_ptr->cur_pic_buf[0]->ps_pic_buf);
+    /* The post filter jobs publish the SB rows as they are done, the last
+       one and the top and bottom borders are final here */
+    dec_pic_set_row_progress(dec_handle_ptr->cur_pic_buf[0],
+        DEC_PIC_ROWS_COMPLETE);
 
     return status;
 }
 
-EbErrorType decode_obu(EbDecHandle *dec_handle_ptr, unsigned char *data, unsigned int data_size)
-{
-    (void)dec_handle_ptr;
-    (void)data;
-    (void)data_size;
-    return 0;
-}
-
-// Decode all OBUs in a Frame
-EbErrorType decode_multiple_obu(EbDecHandle *dec_handle_ptr, uint8_t **data, size_t data_size)
+/* Decodes the OBU at the start of data, which holds data_size bytes of it at
+   least. The OBU may have no size field only if it ends at data_size */
+EbErrorType decode_obu(EbDecHandle *dec_handle_ptr, const uint8_t *data,
+                       size_t data_size, size_t *obu_size, int *frame_done)
 {
     bitstrm_t bs;
     EbErrorType status = EB_ErrorNone;
     ObuHeader obu_header;
-    int frame_decoding_finished = 0;
+    size_t length_size = 0;
+    int tg_start, tg_end;
 
+    *obu_size = 0;
+    *frame_done = 0;
 
 #if ENABLE_ENTROPY_TRACE
     enable_dump = 1;
@@ -2517,108 +3107,190 @@ EbErrorType decode_multiple_obu(EbDecHandle *dec_handle_ptr, uint8_t **data, siz
 #endif
 #endif
 
-    while (!frame_decoding_finished)
-    {
-        size_t payload_size = 0, length_size = 0;
-
-        /* Decoder memory init if not done */
-        if (0 == dec_handle_ptr->mem_init_done && 1 == dec_handle_ptr->seq_header_done)
-            status = dec_mem_init(dec_handle_ptr);
-        if (status != EB_ErrorNone) return status;
+    /* Decoder memory init if not done */
+    if (0 == dec_handle_ptr->mem_init_done && 1 == dec_handle_ptr->seq_header_done)
+        status = dec_mem_init(dec_handle_ptr);
+    if (status != EB_ErrorNone) return status;
 
-        dec_bits_init(&bs, *data, data_size);
+    dec_bits_init(&bs, data, data_size);
 
-        status = open_bistream_unit(&bs, &obu_header, data_size, &length_size);
-        if (status != EB_ErrorNone) return status;
+    status = open_bistream_unit(&bs, &obu_header, data_size, &length_size);
+    if (status != EB_ErrorNone) return status;
 
-        payload_size = obu_header.payload_size;
+    if (data_size < obu_header.size + length_size ||
+        data_size - obu_header.size - length_size < obu_header.payload_size)
+        return EB_Corrupt_Frame;
+    *obu_size = obu_header.size + length_size + obu_header.payload_size;
 
-        *data += (obu_header.size + length_size);
-        data_size -= (obu_header.size + length_size);
+    dec_bits_init(&bs, data + obu_header.size + length_size,
+        obu_header.payload_size);
 
-        if (data_size < payload_size)
-            return EB_Corrupt_Frame;
+    switch (obu_header.obu_type) {
+    case OBU_TEMPORAL_DELIMITER:
+        PRINT_NAME("**************OBU_TEMPORAL_DELIMITER*******************");
+        read_temporal_delimitor_obu(&dec_handle_ptr->seen_frame_header);
+        break;
 
-        dec_bits_init(&bs, *data, payload_size);
+    case OBU_SEQUENCE_HEADER:
+        PRINT_NAME("**************OBU_SEQUENCE_HEADER*******************")
+            status = read_sequence_header_obu(&bs, &dec_handle_ptr->seq_header);
+        if (status != EB_ErrorNone)
+            return status;
+        dec_handle_ptr->seq_header_done = 1;
+        break;
 
-        switch (obu_header.obu_type) {
-        case OBU_TEMPORAL_DELIMITER:
-            PRINT_NAME("**************OBU_TEMPORAL_DELIMITER*******************");
-            read_temporal_delimitor_obu(&dec_handle_ptr->seen_frame_header);
-            break;
+    case OBU_FRAME_HEADER:
+    case OBU_REDUNDANT_FRAME_HEADER:
+    case OBU_FRAME:
+        if (obu_header.obu_type == OBU_FRAME) {
+            PRINT_NAME("**************OBU_FRAME*******************");
+            dec_handle_ptr->show_existing_frame = 0;
+        }
+        else if (obu_header.obu_type == OBU_FRAME_HEADER) {
+            PRINT_NAME("**************OBU_FRAME_HEADER*******************");
+            assert(dec_handle_ptr->seen_frame_header == 0);
+        }
+        else {
+            PRINT_NAME("**************OBU_REDUNDANT_FRAME_HEADER*******************");
+            assert(dec_handle_ptr->seen_frame_header == 1);
+        }
 
-        case OBU_SEQUENCE_HEADER:
-            PRINT_NAME("**************OBU_SEQUENCE_HEADER*******************")
-                status = read_sequence_header_obu(&bs, &dec_handle_ptr->seq_header);
-            if (status != EB_ErrorNone)
-                return status;
-            dec_handle_ptr->seq_header_done = 1;
-            break;
+        if (!dec_handle_ptr->seen_frame_header)
+        {
+            dec_handle_ptr->seen_frame_header = 1;
+            status = read_frame_header_obu(&bs, dec_handle_ptr, &obu_header,
+                                           obu_header.obu_type != OBU_FRAME);
+            if (status != EB_ErrorNone) return status;
 
-        case OBU_FRAME_HEADER:
-        case OBU_REDUNDANT_FRAME_HEADER:
-        case OBU_FRAME:
-            if (obu_header.obu_type == OBU_FRAME) {
-                PRINT_NAME("**************OBU_FRAME*******************");
-                dec_handle_ptr->show_existing_frame = 0;
-            }
-            else if (obu_header.obu_type == OBU_FRAME_HEADER) {
-                PRINT_NAME("**************OBU_FRAME_HEADER*******************");
-                assert(dec_handle_ptr->seen_frame_header == 0);
-            }
-            else {
-                PRINT_NAME("**************OBU_REDUNDANT_FRAME_HEADER*******************");
-                assert(dec_handle_ptr->seen_frame_header == 1);
+            /* No tile group follows */
+            if (dec_handle_ptr->frame_header.show_existing_frame) {
+                dec_handle_ptr->seen_frame_header = 0;
+                *frame_done = 1;
             }
+        }
+        /*else {
+             For OBU_REDUNDANT_FRAME_HEADER, previous frame_header is taken from dec_handle_ptr->frame_header
+            //frame_header_copy(); TODO()
+        }*/
 
-            if (!dec_handle_ptr->seen_frame_header)
-            {
-                dec_handle_ptr->seen_frame_header = 1;
-                status = read_frame_header_obu(&bs, dec_handle_ptr, &obu_header,
-                                               obu_header.obu_type != OBU_FRAME);
-                frame_decoding_finished = 1;
-            }
-            /*else {
-                 For OBU_REDUNDANT_FRAME_HEADER, previous frame_header is taken from dec_handle_ptr->frame_header
-                //frame_header_copy(); TODO()
-            }*/
-
-            if (obu_header.obu_type != OBU_FRAME) break; // For OBU_TILE_GROUP comes under OBU_FRAME
-
-        case OBU_TILE_GROUP:
-            PRINT_NAME("**************OBU_TILE_GROUP*******************");
-            if (!dec_handle_ptr->seen_frame_header)
-                return EB_Corrupt_Frame;
-            status = read_tile_group_obu(&bs, dec_handle_ptr,
-                &dec_handle_ptr->frame_header.tiles_info, &obu_header);
-            if (status != EB_ErrorNone) return status;
-            if (frame_decoding_finished)
-                dec_handle_ptr->seen_frame_header = 0;
-            break;
+        if (obu_header.obu_type != OBU_FRAME) break; // For OBU_TILE_GROUP comes under OBU_FRAME
 
-        default:
-            PRINT_NAME("**************UNKNOWN OBU*******************");
-            break;
+    case OBU_TILE_GROUP:
+        PRINT_NAME("**************OBU_TILE_GROUP*******************");
+        if (!dec_handle_ptr->seen_frame_header)
+            return EB_Corrupt_Frame;
+        TilesInfo *tiles_info = &dec_handle_ptr->frame_header.tiles_info;
+        peek_tile_group_range(&bs, tiles_info, &tg_start, &tg_end);
+        if (!dec_handle_ptr->skip_frame) {
+            status = read_tile_group_obu(&bs, dec_handle_ptr, tiles_info,
+                &obu_header);
+            if (status != EB_ErrorNone) return status;
+        }
+        /* Tile groups are decoded as they arrive, the frame ends with the
+           last one */
+        if (tg_end == tiles_info->tile_cols * tiles_info->tile_rows - 1) {
+            dec_handle_ptr->seen_frame_header = 0;
+            *frame_done = 1;
         }
+        break;
 
-        *data += payload_size;
-        data_size -= payload_size;
-        if (!data_size)
-            frame_decoding_finished = 1;
+    default:
+        PRINT_NAME("**************UNKNOWN OBU*******************");
+        break;
     }
 
+    if (*frame_done) {
+        dec_handle_ptr->dec_cnt++;
 #if ENABLE_ENTROPY_TRACE
 #if FRAME_LEVEL_TRACE
-    if (enable_dump) {
-        fclose(temp_fp);
-        temp_fp = NULL;
-    }
+        if (enable_dump) {
+            fclose(temp_fp);
+            temp_fp = NULL;
+        }
 #endif
 #endif
+    }
 
     return status;
 }
 
+/* Reads the sequence header if the OBU of obu_size bytes at data is one */
+static EbErrorType read_obu_sequence_header(const uint8_t *data, size_t obu_size,
+                                            size_t *size_read, SeqHeader *seq_header)
+{
+    bitstrm_t bs;
+    ObuHeader ou;
+    size_t length_size = 0;
+    EbErrorType status;
+
+    memset(&ou, 0, sizeof(ou));
+    dec_bits_init(&bs, data, obu_size);
+    status = open_bistream_unit(&bs, &ou, obu_size, &length_size);
+    if (status != EB_ErrorNone)
+        return status;
+    if (obu_size < ou.size + length_size ||
+        obu_size - ou.size - length_size < ou.payload_size)
+        return EB_Corrupt_Frame;
+    *size_read = ou.size + length_size + ou.payload_size;
+
+    if (ou.obu_type != OBU_SEQUENCE_HEADER)
+        return EB_ErrorUndefined;
+    dec_bits_init(&bs, data + ou.size + length_size, ou.payload_size);
+    status = read_sequence_header_obu(&bs, seq_header);
+    return status != EB_ErrorNone ? EB_Corrupt_Frame : EB_ErrorNone;
+}
+
+/* Finds the first sequence header of the data, which may end anywhere.
+   EB_ErrorUndefined if there is none, EB_Corrupt_Frame if the data is not
+   in the format */
+static EbErrorType find_sequence_header(const uint8_t *data, size_t size,
+                                        int is_annex_b, SeqHeader *seq_header)
+{
+    EbErrorType status;
+    size_t obu_size = 0, length;
+
+    if (!is_annex_b) {
+        while (size > 0) {
+            status = read_obu_sequence_header(data, size, &obu_size, seq_header);
+            if (status != EB_ErrorUndefined)
+                return status;
+            data += obu_size;
+            size -= obu_size;
+        }
+        return EB_ErrorUndefined;
+    }
+
+    /* temporal_unit( temporal_unit_size ), of which only the start may have
+       been received */
+    size_t tu_size, fu_size;
+    if (!dec_read_leb128(data, size, &tu_size, &length))
+        return EB_ErrorUndefined;
+    data += length;
+    tu_size = MIN(tu_size, size - length);
+    while (tu_size > 0) {
+        /* frame_unit( frame_unit_size ) */
+        if (!dec_read_leb128(data, tu_size, &fu_size, &length))
+            return EB_ErrorUndefined;
+        data += length;
+        fu_size = MIN(fu_size, tu_size - length);
+        tu_size -= length + fu_size;
+        while (fu_size > 0) {
+            /* obu_length, then the OBU, with or without size field */
+            if (!dec_read_leb128(data, fu_size, &obu_size, &length) ||
+                obu_size > fu_size - length)
+                return EB_ErrorUndefined;
+            data += length;
+            fu_size -= length;
+            status = read_obu_sequence_header(data, obu_size, &length, seq_header);
+            if (status != EB_ErrorUndefined)
+                return status;
+            data += obu_size;
+            fu_size -= obu_size;
+        }
+    }
+    return EB_ErrorUndefined;
+}
+
 EB_API EbErrorType eb_get_sequence_info(
     const uint8_t *obu_data,
     size_t         size,
@@ -2626,32 +3298,49 @@ EB_API EbErrorType eb_get_sequence_info(
 {
     if (obu_data == NULL || size == 0 || sequence_info == NULL)
         return EB_ErrorBadParameter;
-    const uint8_t* frame_buf = obu_data;
-    size_t frame_sz = size;
-    EbErrorType status = EB_ErrorNone;
-    do {
-        bitstrm_t bs;
-        dec_bits_init(&bs, frame_buf, frame_sz);
-
-        ObuHeader ou;
-        memset(&ou, 0, sizeof(ou));
-        size_t length_size = 0;
-        status = open_bistream_unit(&bs, &ou, frame_sz, &length_size);
-        if (status != EB_ErrorNone)
-            return status;
+    if (find_sequence_header(obu_data, size, 0, sequence_info) == EB_ErrorNone)
+        return EB_ErrorNone;
+    return EB_ErrorUndefined;
+}
 
-        frame_buf += ou.size + length_size;
-        frame_sz -= (uint32_t)(ou.size + length_size);
+#if defined(__linux__) || defined(__APPLE__)
+__attribute__((visibility("default")))
+#endif
+EB_API EbErrorType eb_peek_sequence_header(
+    EbAV1StreamInfo *header,
+    const uint8_t   *data,
+    const uint32_t  data_size)
+{
+    SeqHeader   seq_header;
+    EbErrorType status;
+    EbBool      is_annex_b = EB_FALSE;
 
-        if (ou.obu_type == OBU_SEQUENCE_HEADER) {
-            // check the ou type and parse sequence header
-            status = read_sequence_header_obu(&bs, sequence_info);
-            if (status == EB_ErrorNone)
-                return status;
-        }
+    if (header == NULL || data == NULL || data_size == 0)
+        return EB_ErrorBadParameter;
 
-        frame_buf += ou.payload_size;
-        frame_sz -= ou.payload_size;
-    } while (status == EB_ErrorNone && frame_sz > 0);
-    return EB_ErrorUndefined;
+    /* Low overhead format first, as most streams, then Annex B */
+    memset(&seq_header, 0, sizeof(seq_header));
+    status = find_sequence_header(data, data_size, 0, &seq_header);
+    if (status != EB_ErrorNone) {
+        memset(&seq_header, 0, sizeof(seq_header));
+        status = find_sequence_header(data, data_size, 1, &seq_header);
+        is_annex_b = EB_TRUE;
+    }
+    if (status != EB_ErrorNone)
+        return EB_DecUnsupportedBitstream;
+
+    header->seq_profile = seq_header.seq_profile;
+    header->max_picture_width = seq_header.max_frame_width;
+    header->max_picture_height = seq_header.max_frame_height;
+    header->num_operating_points = seq_header.operating_points_cnt_minus_1 + 1;
+    if (header->num_operating_points > EB_MAX_NUM_OPERATING_POINTS)
+        header->num_operating_points = EB_MAX_NUM_OPERATING_POINTS;
+    for (uint32_t i = 0; i < header->num_operating_points; i++)
+        header->op_points[i] = seq_header.operating_point[i];
+    header->timing_info = seq_header.timing_info;
+    header->color_config = seq_header.color_config;
+    header->film_grain_params_present = seq_header.film_grain_params_present;
+    header->is_annex_b = is_annex_b;
+
+    return EB_ErrorNone;
 }
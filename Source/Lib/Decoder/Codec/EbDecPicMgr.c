@@ -31,6 +31,7 @@
 #include "EbDecUtils.h"
 
 #include "EbDecPicMgr.h"
+#include "EbThreads.h"
 
 #define NUM_REF_FRAMES 8 // TODO: remove (reuse EbObuParse.h macro)
 
@@ -46,6 +47,9 @@
 * @param[in] ps_pic_mgr
 *  Pointer to the Picture manager structure
 *
+* @param[in] dec_handle_ptr
+*  Decoder handle, for the frame threads and the frame buffer allocator
+*
 * @returns
 *
 * @remarks
@@ -53,9 +57,10 @@
 *******************************************************************************
 */
 
-EbErrorType dec_pic_mgr_init(EbDecPicMgr **pps_pic_mgr) {
+EbErrorType dec_pic_mgr_init(EbDecPicMgr **pps_pic_mgr, EbDecHandle *dec_handle_ptr) {
 
     EbErrorType return_error = EB_ErrorNone;
+    int32_t frame_threads = dec_handle_ptr->dec_config.frame_threads;
     int32_t i;
 
     EB_MALLOC_DEC(void *, *pps_pic_mgr, sizeof(EbDecPicMgr), EB_N_PTR);
@@ -68,10 +73,27 @@ EbErrorType dec_pic_mgr_init(EbDecPicMgr **pps_pic_mgr) {
         ps_pic_mgr->as_dec_pic[i].size       = 0;
         ps_pic_mgr->as_dec_pic[i].ref_count  = 0;
         ps_pic_mgr->as_dec_pic[i].mvs = NULL;
+        ps_pic_mgr->as_dec_pic[i].row_progress = DEC_PIC_ROWS_COMPLETE;
+        ps_pic_mgr->as_dec_pic[i].parse_done = 1;
+        ps_pic_mgr->as_dec_pic[i].progress_mutex = NULL;
+        ps_pic_mgr->as_dec_pic[i].progress_semaphore = NULL;
+        ps_pic_mgr->as_dec_pic[i].num_progress_waiters = 0;
+        ps_pic_mgr->as_dec_pic[i].ext_frame_buf.buffer = NULL;
+        ps_pic_mgr->as_dec_pic[i].ext_frame_buf.buffer_size = 0;
+        ps_pic_mgr->as_dec_pic[i].ext_frame_buf.private_data = NULL;
+        if (frame_threads > 1) {
+            EB_CREATE_MUTEX_DEC(ps_pic_mgr->as_dec_pic[i].progress_mutex);
+            EB_CREATE_SEMAPHORE_DEC(ps_pic_mgr->as_dec_pic[i].progress_semaphore,
+                0, INT32_MAX);
+        }
     }
 
     ps_pic_mgr->num_pic_bufs = 0;
 
+    ps_pic_mgr->allocate_frame_buffer = dec_handle_ptr->allocate_frame_buffer;
+    ps_pic_mgr->release_frame_buffer = dec_handle_ptr->release_frame_buffer;
+    ps_pic_mgr->frame_buffer_priv = dec_handle_ptr->frame_buffer_priv;
+
     return return_error;
 }
 
@@ -151,9 +173,25 @@ EbDecPicBuf * dec_pic_mgr_get_cur_pic(EbDecPicMgr *ps_pic_mgr,
 
         input_picture_buffer_desc_init_data.split_mode = EB_FALSE;
 
-        EbErrorType return_error = dec_eb_recon_picture_buffer_desc_ctor(
-            (EbPtr*) &(ps_pic_mgr->as_dec_pic[i].ps_pic_buf),
-            (EbPtr)&input_picture_buffer_desc_init_data);
+        EbErrorType return_error;
+        if (ps_pic_mgr->allocate_frame_buffer != NULL) {
+            EbExtFrameBuf *ext_frame_buf = &ps_pic_mgr->as_dec_pic[i].ext_frame_buf;
+            if (ext_frame_buf->buffer != NULL) {
+                ps_pic_mgr->release_frame_buffer(ext_frame_buf,
+                    ps_pic_mgr->frame_buffer_priv);
+                ext_frame_buf->buffer = NULL;
+            }
+            return_error = dec_eb_ext_picture_buffer_desc_ctor(
+                (EbPtr*) &(ps_pic_mgr->as_dec_pic[i].ps_pic_buf),
+                (EbPtr)&input_picture_buffer_desc_init_data,
+                ps_pic_mgr->allocate_frame_buffer,
+                ps_pic_mgr->frame_buffer_priv, ext_frame_buf);
+        }
+        else {
+            return_error = dec_eb_recon_picture_buffer_desc_ctor(
+                (EbPtr*) &(ps_pic_mgr->as_dec_pic[i].ps_pic_buf),
+                (EbPtr)&input_picture_buffer_desc_init_data);
+        }
         if (return_error != EB_ErrorNone) return NULL;
 
         ps_pic_mgr->as_dec_pic[i].size = frame_size;
@@ -170,6 +208,10 @@ EbDecPicBuf * dec_pic_mgr_get_cur_pic(EbDecPicMgr *ps_pic_mgr,
 
     ps_pic_mgr->as_dec_pic[i].is_free = 0;
     ps_pic_mgr->as_dec_pic[i].ref_count = 1;
+    ps_pic_mgr->as_dec_pic[i].frame_width = frame_width;
+    ps_pic_mgr->as_dec_pic[i].frame_height = frame_height;
+    ps_pic_mgr->as_dec_pic[i].row_progress = 0;
+    ps_pic_mgr->as_dec_pic[i].parse_done = 0;
 
     pic_buf = &ps_pic_mgr->as_dec_pic[i];
 
@@ -188,6 +230,85 @@ static INLINE void dec_ref_count_and_rel(EbDecPicBuf *ps_pic_buf) {
     }
 }
 
+/* Drops a reference taken by a frame thread or the output queue */
+void dec_pic_mgr_release_pic(EbDecPicBuf *ps_pic_buf) {
+    dec_ref_count_and_rel(ps_pic_buf);
+}
+
+void dec_pic_mgr_release_ext_frame_bufs(EbDecPicMgr *ps_pic_mgr) {
+    if (ps_pic_mgr == NULL || ps_pic_mgr->release_frame_buffer == NULL)
+        return;
+
+    for (int32_t i = 0; i < MAX_PIC_BUFS; i++) {
+        EbExtFrameBuf *ext_frame_buf = &ps_pic_mgr->as_dec_pic[i].ext_frame_buf;
+        if (ext_frame_buf->buffer != NULL) {
+            ps_pic_mgr->release_frame_buffer(ext_frame_buf,
+                ps_pic_mgr->frame_buffer_priv);
+            ext_frame_buf->buffer = NULL;
+        }
+    }
+}
+
+/* Blocks until *value reaches target. Waiters register under the progress
+   mutex and the publisher posts the semaphore once per registered waiter.
+   The progress already reached is read without the mutex */
+static void wait_pic_progress(EbDecPicBuf *ps_pic_buf,
+                              volatile int32_t *value, int32_t target)
+{
+    if (ps_pic_buf->progress_mutex == NULL ||
+        (int32_t)eb_atomic_load_u32((volatile uint32_t *)value) >= target)
+        return;
+
+    eb_block_on_mutex(ps_pic_buf->progress_mutex);
+    while (*value < target) {
+        ps_pic_buf->num_progress_waiters++;
+        eb_release_mutex(ps_pic_buf->progress_mutex);
+        eb_block_on_semaphore(ps_pic_buf->progress_semaphore);
+        eb_block_on_mutex(ps_pic_buf->progress_mutex);
+    }
+    eb_release_mutex(ps_pic_buf->progress_mutex);
+}
+
+static void set_pic_progress(EbDecPicBuf *ps_pic_buf,
+                             volatile int32_t *value, int32_t progress)
+{
+    if (ps_pic_buf->progress_mutex == NULL)
+        return;
+
+    eb_block_on_mutex(ps_pic_buf->progress_mutex);
+    if (progress > *value)
+        eb_atomic_store_u32((volatile uint32_t *)value, (uint32_t)progress);
+    for (; ps_pic_buf->num_progress_waiters > 0;
+        ps_pic_buf->num_progress_waiters--)
+        eb_post_semaphore(ps_pic_buf->progress_semaphore);
+    eb_release_mutex(ps_pic_buf->progress_mutex);
+}
+
+/* Waits until the luma rows top_row to bottom_row of the picture are final.
+   Rows outside the picture are the padded borders, which are final only
+   once the whole picture is */
+void dec_pic_wait_rows(EbDecPicBuf *ps_pic_buf, int32_t top_row,
+                       int32_t bottom_row)
+{
+    int32_t target = bottom_row + 1;
+
+    if (top_row < 0 || bottom_row >= (int32_t)ps_pic_buf->ps_pic_buf->height)
+        target = DEC_PIC_ROWS_COMPLETE;
+    wait_pic_progress(ps_pic_buf, &ps_pic_buf->row_progress, target);
+}
+
+void dec_pic_set_row_progress(EbDecPicBuf *ps_pic_buf, int32_t num_rows) {
+    set_pic_progress(ps_pic_buf, &ps_pic_buf->row_progress, num_rows);
+}
+
+void dec_pic_wait_parse_done(EbDecPicBuf *ps_pic_buf) {
+    wait_pic_progress(ps_pic_buf, &ps_pic_buf->parse_done, 1);
+}
+
+void dec_pic_set_parse_done(EbDecPicBuf *ps_pic_buf) {
+    set_pic_progress(ps_pic_buf, &ps_pic_buf->parse_done, 1);
+}
+
 /**
 *******************************************************************************
 *
@@ -19,6 +19,11 @@ typedef struct EbDecPicMgr {
     /* number of picture buffers */
     uint8_t     num_pic_bufs;
 
+    /* Application frame buffer allocator, NULL if none */
+    eb_allocate_frame_buffer    allocate_frame_buffer;
+    eb_release_frame_buffer     release_frame_buffer;
+    void                        *frame_buffer_priv;
+
 } EbDecPicMgr;
 
 typedef struct RefFrameInfo {
@@ -29,7 +34,7 @@ typedef struct RefFrameInfo {
 } RefFrameInfo;
 
 
-EbErrorType dec_pic_mgr_init(EbDecPicMgr **pps_pic_mgr);
+EbErrorType dec_pic_mgr_init(EbDecPicMgr **pps_pic_mgr, EbDecHandle *dec_handle_ptr);
 
 EbDecPicBuf * dec_pic_mgr_get_cur_pic(EbDecPicMgr *ps_pic_mgr,
                                       SeqHeader   *seq_header,
@@ -42,6 +47,18 @@ void dec_pic_mgr_update_ref_pic(EbDecHandle *dec_handle_ptr, int32_t frame_decod
 
 void generate_next_ref_frame_map(EbDecHandle *dec_handle_ptr);
 
+void dec_pic_mgr_release_pic(EbDecPicBuf *ps_pic_buf);
+
+/* Gives the application buffers of all the pictures back to its allocator */
+void dec_pic_mgr_release_ext_frame_bufs(EbDecPicMgr *ps_pic_mgr);
+
+/* Frame threading progress. No-ops without frame threading */
+void dec_pic_wait_rows(EbDecPicBuf *ps_pic_buf, int32_t top_row,
+                       int32_t bottom_row);
+void dec_pic_set_row_progress(EbDecPicBuf *ps_pic_buf, int32_t num_rows);
+void dec_pic_wait_parse_done(EbDecPicBuf *ps_pic_buf);
+void dec_pic_set_parse_done(EbDecPicBuf *ps_pic_buf);
+
 EbDecPicBuf *get_ref_frame_buf(EbDecHandle *dec_handle_ptr, const MvReferenceFrame ref_frame);
 void svt_setup_frame_buf_refs(EbDecHandle *dec_handle_ptr);
 
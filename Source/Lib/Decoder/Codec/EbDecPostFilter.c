@@ -0,0 +1,445 @@
+/*
+* Copyright(c) 2019 Netflix, Inc.
+* SPDX - License - Identifier: BSD - 2 - Clause - Patent
+*/
+
+#include <assert.h>
+#include <string.h>
+
+#include "EbDefinitions.h"
+#include "EbThreads.h"
+#include "EbCdef.h"
+
+#include "EbDecHandle.h"
+#include "EbDecInverseQuantize.h"
+#include "EbDecProcessFrame.h"
+#include "EbDecLF.h"
+#include "EbDecCdef.h"
+#include "EbDecRestoration.h"
+#include "EbDecUtils.h"
+#include "EbDecPicMgr.h"
+#include "EbDecPostFilter.h"
+
+/* Luma rows below a filter block row that its CDEF reads, with margin for
+   the deblocking that still modifies them */
+#define PF_CDEF_LF_LAG  (CDEF_VBORDER + 9)
+/* Luma rows above a deblocking row that its top edges modify, rounded up */
+#define PF_LF_REACH     8
+
+static void wait_job(DecPfCtxt *pf_ctxt, DecPfJob *job, uint32_t progress)
+{
+    if (eb_atomic_load_u32(&job->progress) >= progress)
+        return;
+
+    eb_block_on_mutex(pf_ctxt->progress_mutex);
+    while (job->progress < progress) {
+        pf_ctxt->num_waiters++;
+        eb_release_mutex(pf_ctxt->progress_mutex);
+        eb_block_on_semaphore(pf_ctxt->progress_semaphore);
+        eb_block_on_mutex(pf_ctxt->progress_mutex);
+    }
+    eb_release_mutex(pf_ctxt->progress_mutex);
+}
+
+static void set_job_progress(DecPfCtxt *pf_ctxt, DecPfJob *job,
+                             uint32_t progress)
+{
+    eb_block_on_mutex(pf_ctxt->progress_mutex);
+    eb_atomic_store_u32(&job->progress, progress);
+    for (; pf_ctxt->num_waiters > 0; pf_ctxt->num_waiters--)
+        eb_post_semaphore(pf_ctxt->progress_semaphore);
+    eb_release_mutex(pf_ctxt->progress_mutex);
+}
+
+/* Deblocking row holding luma row y */
+static int32_t lf_row_of(DecPfCtxt *pf_ctxt, int32_t y)
+{
+    int32_t row = y >> pf_ctxt->dec_handle_ptr->seq_header.sb_size_log2;
+    return AOMMIN(row, pf_ctxt->lf_rows - 1);
+}
+
+/* CDEF row that must be done before restoration unit row `row` of `plane`
+   is filtered : it reads 3 rows below the unit and the stripe boundary
+   lines saved from the 2 rows below it */
+static int32_t lr_cdef_row_of(DecPfCtxt *pf_ctxt, int32_t plane, int32_t row)
+{
+    EbDecHandle *dec_handle = pf_ctxt->dec_handle_ptr;
+    const int32_t ss_y = plane &&
+        dec_handle->seq_header.color_config.subsampling_y;
+    RestorationTileLimits limits;
+
+    dec_av1_lr_unit_row_limits(dec_handle, plane, row, &limits);
+    int32_t cdef_row = (((limits.v_end + RESTORATION_BORDER) << ss_y) >>
+        CDEF_BLOCKSIZE_LOG2) + 1;
+    return AOMMIN(cdef_row, pf_ctxt->cdef_rows - 1);
+}
+
+/* Restoration unit row of `plane` whose rows are copied back to the frame
+   once luma row y is : the copy of a row is done by the row below */
+static int32_t lr_copy_row_of(DecPfCtxt *pf_ctxt, int32_t plane, int32_t y)
+{
+    EbDecHandle *dec_handle = pf_ctxt->dec_handle_ptr;
+    const int32_t ss_y = plane &&
+        dec_handle->seq_header.color_config.subsampling_y;
+    RestorationTileLimits limits;
+    int32_t row = 0;
+
+    dec_av1_lr_unit_row_limits(dec_handle, plane, row, &limits);
+    while (limits.v_end <= (y >> ss_y) && row < pf_ctxt->lr_rows[plane] - 1)
+        dec_av1_lr_unit_row_limits(dec_handle, plane, ++row, &limits);
+    return AOMMIN(row + 1, pf_ctxt->lr_rows[plane] - 1);
+}
+
+/* Rows of every stage that must be done before the luma rows above
+   publish row `row` are final. -1 for the stages not run */
+static void publish_row_deps(DecPfCtxt *pf_ctxt, int32_t row, int32_t *lf_row,
+                             int32_t *cdef_row, int32_t *lr_row)
+{
+    const int32_t y = ((row + 1) <<
+        pf_ctxt->dec_handle_ptr->seq_header.sb_size_log2) - 1;
+
+    *lf_row = pf_ctxt->do_lf ? lf_row_of(pf_ctxt, y + PF_LF_REACH) : -1;
+    *cdef_row = pf_ctxt->cdef_rows ?
+        AOMMIN(y >> CDEF_BLOCKSIZE_LOG2, pf_ctxt->cdef_rows - 1) : -1;
+    for (int32_t plane = 0; plane < MAX_MB_PLANE; plane++) {
+        lr_row[plane] = pf_ctxt->lr_rows[plane] ?
+            lr_copy_row_of(pf_ctxt, plane, y) : -1;
+    }
+}
+
+static void pf_lf_row(DecPfCtxt *pf_ctxt, DecPfJob *job)
+{
+    EbDecHandle *dec_handle = pf_ctxt->dec_handle_ptr;
+    SeqHeader   *seq_header = &dec_handle->seq_header;
+    LFCtxt      *lf_ctxt = (LFCtxt *)dec_handle->pv_lf_ctxt;
+    const int32_t sb_log2 = seq_header->sb_size_log2;
+
+    const TileInfo *dec_area = &dec_handle->dec_area;
+    const int32_t mi_row = (job->row << sb_log2) >> MI_SIZE_LOG2;
+
+    for (int32_t col = 0; col < job->num_cols; col++) {
+        const int32_t mi_col = (col << sb_log2) >> MI_SIZE_LOG2;
+
+        /* The top edges of this row modify the row above */
+        if (job->row > 0)
+            wait_job(pf_ctxt, &pf_ctxt->lf_jobs[job->row - 1],
+                AOMMIN(col + 2, job->num_cols));
+
+        /* Only the decoded area, its last column being the last one */
+        if (in_dec_area(dec_area, mi_row, mi_col, seq_header->sb_mi_size))
+            dec_loop_filter_sb(&dec_handle->frame_header, seq_header,
+                dec_handle->cur_pic_buf[0]->ps_pic_buf, lf_ctxt,
+                &lf_ctxt->lf_info, mi_row, mi_col, AOM_PLANE_Y, MAX_MB_PLANE,
+                col == job->num_cols - 1 ||
+                mi_col + seq_header->sb_mi_size >= dec_area->mi_col_end);
+
+        if (col + 1 < job->num_cols)
+            set_job_progress(pf_ctxt, job, col + 1);
+    }
+}
+
+static void pf_cdef_row(DecPfCtxt *pf_ctxt, DecPfJob *job,
+                        DecPfScratch *scratch)
+{
+    EbDecHandle *dec_handle = pf_ctxt->dec_handle_ptr;
+    EbPictureBufferDesc *recon = dec_handle->cur_pic_buf[0]->ps_pic_buf;
+    const int32_t row = job->row;
+    const int32_t last_row = row == pf_ctxt->cdef_rows - 1;
+    const int32_t save_boundaries = pf_ctxt->do_lr && !pf_ctxt->opt_lr;
+    DecPfJob *lf_job = pf_ctxt->do_lf ? &pf_ctxt->lf_jobs[
+        lf_row_of(pf_ctxt, ((row + 1) << CDEF_BLOCKSIZE_LOG2) + PF_CDEF_LF_LAG)] :
+        NULL;
+
+    if (save_boundaries) {
+        if (pf_ctxt->do_lf)
+            wait_job(pf_ctxt, &pf_ctxt->lf_jobs[lf_row_of(pf_ctxt,
+                ((row + 1) << CDEF_BLOCKSIZE_LOG2) - 1)],
+                pf_ctxt->lf_jobs[0].num_cols);
+        dec_av1_loop_restoration_save_row_boundary_lines(dec_handle, row, 0);
+    }
+
+    if (pf_ctxt->do_cdef) {
+        const int32_t is_hbd = recon->bit_depth != EB_8BIT;
+        const int32_t flags_stride = job->num_cols + 2;
+        const int32_t sb_size_w =
+            block_size_wide[dec_handle->seq_header.sb_size];
+        CdefRowCtxt row_ctxt;
+
+        for (int32_t pli = 0; pli < MAX_MB_PLANE; pli++) {
+            row_ctxt.prev_linebuf[pli] = pf_ctxt->cdef_linebuf[pli] +
+                ((row + 1) & 1) * pf_ctxt->cdef_linebuf_size;
+            row_ctxt.curr_linebuf[pli] = pf_ctxt->cdef_linebuf[pli] +
+                (row & 1) * pf_ctxt->cdef_linebuf_size;
+            row_ctxt.colbuf[pli] = scratch->cdef_colbuf[pli];
+        }
+        row_ctxt.prev_row_cdef = pf_ctxt->cdef_row_flags +
+            row * flags_stride + 1;
+        row_ctxt.curr_row_cdef = row_ctxt.prev_row_cdef + flags_stride;
+        svt_cdef_row_start(dec_handle, &row_ctxt, row);
+
+        for (int32_t col = 0; col < job->num_cols; col++) {
+            /* Deblocked up to 8 columns right of the block, and the row
+               above done up to the block on the right */
+            if (lf_job != NULL)
+                wait_job(pf_ctxt, lf_job, AOMMIN(((((col + 1) <<
+                    CDEF_BLOCKSIZE_LOG2) + 2 * CDEF_HBORDER - 1) / sb_size_w) + 2,
+                    lf_job->num_cols));
+            if (row > 0)
+                wait_job(pf_ctxt, &pf_ctxt->cdef_jobs[row - 1],
+                    AOMMIN(col + 2, job->num_cols));
+
+            if (is_hbd)
+                svt_cdef_fb_hbd(dec_handle, &row_ctxt, col);
+            else
+                svt_cdef_fb(dec_handle, &row_ctxt, col);
+
+            if (col + 1 < job->num_cols)
+                set_job_progress(pf_ctxt, job, col + 1);
+        }
+    }
+    else {
+        if (lf_job != NULL)
+            wait_job(pf_ctxt, lf_job, lf_job->num_cols);
+        if (row > 0)
+            wait_job(pf_ctxt, &pf_ctxt->cdef_jobs[row - 1], job->num_cols);
+    }
+
+    if (save_boundaries)
+        dec_av1_loop_restoration_save_row_boundary_lines(dec_handle, row, 1);
+
+    /* Padded bits are required for filtering pixel around frame boundary */
+    if (pf_ctxt->do_lr) {
+        pad_pic_rows(recon, row << CDEF_BLOCKSIZE_LOG2,
+            last_row ? recon->height : (uint32_t)(row + 1) << CDEF_BLOCKSIZE_LOG2);
+    }
+}
+
+static void pf_lr_row(DecPfCtxt *pf_ctxt, DecPfJob *job,
+                      DecPfScratch *scratch)
+{
+    EbDecHandle *dec_handle = pf_ctxt->dec_handle_ptr;
+    const int32_t plane = job->plane;
+    const int32_t row = job->row;
+
+    wait_job(pf_ctxt, &pf_ctxt->cdef_jobs[lr_cdef_row_of(pf_ctxt, plane, row)],
+        pf_ctxt->cdef_jobs[0].num_cols);
+
+    for (int32_t col = 0; col < job->num_cols; col++) {
+        /* Units sharing a stripe boundary can not be filtered together */
+        if (row > 0)
+            wait_job(pf_ctxt, &pf_ctxt->lr_jobs[plane][row - 1],
+                AOMMIN(col + 2, job->num_cols));
+
+        dec_av1_loop_restoration_filter_unit(dec_handle, plane, row, col,
+            scratch->rlbs, scratch->rst_tmpbuf, pf_ctxt->opt_lr);
+
+        if (col + 1 < job->num_cols)
+            set_job_progress(pf_ctxt, job, col + 1);
+    }
+
+    /* The row above is not read any more, this one is by the row below */
+    if (row > 0)
+        dec_av1_loop_restoration_copy_unit_row(dec_handle, plane, row - 1);
+    if (row == pf_ctxt->lr_rows[plane] - 1)
+        dec_av1_loop_restoration_copy_unit_row(dec_handle, plane, row);
+}
+
+/* Frame threading : publishes the rows of a SB row to the frames that
+   reference the picture, once all the stages are done with them. Their
+   left and right borders are padded first, the top and bottom ones are
+   padded with the whole picture */
+static void pf_publish_row(DecPfCtxt *pf_ctxt, DecPfJob *job)
+{
+    EbDecHandle *dec_handle = pf_ctxt->dec_handle_ptr;
+    EbDecPicBuf *cur_pic_buf = dec_handle->cur_pic_buf[0];
+    const int32_t sb_log2 = dec_handle->seq_header.sb_size_log2;
+    const int32_t row = job->row;
+    int32_t lf_row, cdef_row, lr_row[MAX_MB_PLANE];
+
+    publish_row_deps(pf_ctxt, row, &lf_row, &cdef_row, lr_row);
+    if (lf_row >= 0)
+        wait_job(pf_ctxt, &pf_ctxt->lf_jobs[lf_row],
+            pf_ctxt->lf_jobs[lf_row].num_cols);
+    if (cdef_row >= 0)
+        wait_job(pf_ctxt, &pf_ctxt->cdef_jobs[cdef_row],
+            pf_ctxt->cdef_jobs[cdef_row].num_cols);
+    for (int32_t plane = 0; plane < MAX_MB_PLANE; plane++) {
+        if (lr_row[plane] >= 0)
+            wait_job(pf_ctxt, &pf_ctxt->lr_jobs[plane][lr_row[plane]],
+                pf_ctxt->lr_jobs[plane][lr_row[plane]].num_cols);
+    }
+    /* The rows are published in order */
+    if (row > 0)
+        wait_job(pf_ctxt, &pf_ctxt->publish_jobs[row - 1], 1);
+
+    pad_pic_rows(cur_pic_buf->ps_pic_buf, row << sb_log2,
+        (row + 1) << sb_log2);
+    dec_pic_set_row_progress(cur_pic_buf, (row + 1) << sb_log2);
+}
+
+void dec_pf_run_jobs(DecPfCtxt *pf_ctxt, DecPfScratch *scratch)
+{
+    uint32_t job_idx;
+
+    while ((job_idx = eb_atomic_add_u32(&pf_ctxt->next_job, 1) - 1) <
+        (uint32_t)pf_ctxt->num_jobs)
+    {
+        DecPfJob *job = pf_ctxt->job_queue[job_idx];
+
+        switch (job->stage) {
+        case DEC_PF_LF: pf_lf_row(pf_ctxt, job); break;
+        case DEC_PF_CDEF: pf_cdef_row(pf_ctxt, job, scratch); break;
+        case DEC_PF_LR: pf_lr_row(pf_ctxt, job, scratch); break;
+        case DEC_PF_PUBLISH: pf_publish_row(pf_ctxt, job); break;
+        }
+        set_job_progress(pf_ctxt, job, job->num_cols);
+    }
+}
+
+static DecPfJob *add_jobs(DecPfJob *job, DecPfStage stage, int32_t plane,
+                          int32_t rows, int32_t cols)
+{
+    for (int32_t row = 0; row < rows; row++, job++) {
+        job->stage = stage;
+        job->plane = plane;
+        job->row = row;
+        job->num_cols = cols;
+        job->progress = 0;
+    }
+    return job;
+}
+
+/* Queues the rows of all stages so that every row follows the rows it
+   waits on. Later stages go first, to keep the rows being filtered close
+   together in the cache */
+static void queue_jobs(DecPfCtxt *pf_ctxt)
+{
+    const int32_t num_planes = av1_num_planes(
+        &pf_ctxt->dec_handle_ptr->seq_header.color_config);
+    int32_t lf_next = 0, cdef_next = 0, lr_next[MAX_MB_PLANE] = { 0 };
+    int32_t publish_next = 0;
+    DecPfJob **queue = pf_ctxt->job_queue;
+
+    while (queue - pf_ctxt->job_queue < pf_ctxt->num_jobs) {
+        int32_t queued = 0;
+
+        if (publish_next < pf_ctxt->publish_rows) {
+            int32_t lf_row, cdef_row, lr_row[MAX_MB_PLANE];
+            publish_row_deps(pf_ctxt, publish_next, &lf_row, &cdef_row,
+                lr_row);
+            queued = lf_row < lf_next && cdef_row < cdef_next;
+            for (int32_t plane = 0; plane < MAX_MB_PLANE; plane++)
+                queued = queued && lr_row[plane] < lr_next[plane];
+            if (queued) {
+                *queue++ = &pf_ctxt->publish_jobs[publish_next++];
+                continue;
+            }
+        }
+
+        for (int32_t plane = 0; plane < num_planes && !queued; plane++) {
+            if (lr_next[plane] < pf_ctxt->lr_rows[plane] &&
+                lr_cdef_row_of(pf_ctxt, plane, lr_next[plane]) < cdef_next)
+            {
+                *queue++ = &pf_ctxt->lr_jobs[plane][lr_next[plane]++];
+                queued = 1;
+            }
+        }
+        if (queued)
+            continue;
+
+        if (cdef_next < pf_ctxt->cdef_rows && (!pf_ctxt->do_lf ||
+            lf_row_of(pf_ctxt, ((cdef_next + 1) << CDEF_BLOCKSIZE_LOG2) +
+            PF_CDEF_LF_LAG) < lf_next))
+        {
+            *queue++ = &pf_ctxt->cdef_jobs[cdef_next++];
+        }
+        else {
+            assert(lf_next < pf_ctxt->lf_rows);
+            *queue++ = &pf_ctxt->lf_jobs[lf_next++];
+        }
+    }
+}
+
+void dec_pf_frame(EbDecHandle *dec_handle_ptr, int32_t do_cdef,
+                  int32_t opt_lr, int32_t do_lr)
+{
+    DecTileMtCtxt *tile_mt_ctxt = (DecTileMtCtxt *)dec_handle_ptr->pv_tile_mt_ctxt;
+    DecPfCtxt     *pf_ctxt = (DecPfCtxt *)dec_handle_ptr->pv_pf_ctxt;
+    FrameHeader   *frame_header = &dec_handle_ptr->frame_header;
+    SeqHeader     *seq_header = &dec_handle_ptr->seq_header;
+    LFCtxt        *lf_ctxt = (LFCtxt *)dec_handle_ptr->pv_lf_ctxt;
+    const int32_t num_planes = av1_num_planes(&seq_header->color_config);
+    const int32_t sb_size_w = block_size_wide[seq_header->sb_size];
+    const int32_t sb_size_h = block_size_high[seq_header->sb_size];
+    const int32_t nhfb = (frame_header->mi_cols + MI_SIZE_64X64 - 1) /
+        MI_SIZE_64X64;
+    DecPfJob *job = pf_ctxt->jobs;
+
+    pf_ctxt->dec_handle_ptr = dec_handle_ptr;
+    pf_ctxt->do_lf = frame_header->loop_filter_params.filter_level[0] ||
+        frame_header->loop_filter_params.filter_level[1];
+    pf_ctxt->do_cdef = do_cdef;
+    pf_ctxt->do_lr = do_lr;
+    pf_ctxt->opt_lr = opt_lr;
+    pf_ctxt->publish_rows = 0;
+
+    /* Same SB grid as dec_av1_loop_filter_frame() */
+    pf_ctxt->lf_rows = pf_ctxt->do_lf ?
+        (seq_header->max_frame_height + sb_size_h - 1) / sb_size_h : 0;
+    pf_ctxt->cdef_rows = (do_cdef || do_lr) ?
+        (frame_header->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64 : 0;
+
+    pf_ctxt->lf_jobs = job;
+    job = add_jobs(job, DEC_PF_LF, 0, pf_ctxt->lf_rows,
+        (seq_header->max_frame_width + sb_size_w - 1) / sb_size_w);
+    pf_ctxt->cdef_jobs = job;
+    job = add_jobs(job, DEC_PF_CDEF, 0, pf_ctxt->cdef_rows, nhfb);
+    for (int32_t plane = 0; plane < MAX_MB_PLANE; plane++) {
+        int32_t unit_rows = 0, unit_cols = 0;
+        if (do_lr && plane < num_planes &&
+            frame_header->lr_params[plane].frame_restoration_type != RESTORE_NONE)
+        {
+            dec_av1_lr_unit_grid(dec_handle_ptr, plane, &unit_rows, &unit_cols);
+        }
+        pf_ctxt->lr_rows[plane] = unit_rows;
+        pf_ctxt->lr_jobs[plane] = job;
+        job = add_jobs(job, DEC_PF_LR, plane, unit_rows, unit_cols);
+    }
+    if (job == pf_ctxt->jobs)
+        return;
+
+    /* Frame threading : all the SB rows but the last one, which is
+       published with the borders of the whole picture */
+    pf_ctxt->publish_rows = dec_handle_ptr->cur_pic_buf[0]->progress_mutex ?
+        (frame_header->mi_rows + seq_header->sb_mi_size - 1) /
+        seq_header->sb_mi_size - 1 : 0;
+    pf_ctxt->publish_jobs = job;
+    job = add_jobs(job, DEC_PF_PUBLISH, 0, pf_ctxt->publish_rows, 1);
+    pf_ctxt->num_jobs = (int32_t)(job - pf_ctxt->jobs);
+
+    if (pf_ctxt->do_lf) {
+        dec_av1_loop_filter_frame_init(frame_header, &lf_ctxt->lf_info,
+            AOM_PLANE_Y, MAX_MB_PLANE);
+    }
+    if (do_cdef) {
+        memset(pf_ctxt->cdef_row_flags, 1,
+            (pf_ctxt->cdef_rows + 1) * (nhfb + 2) * sizeof(uint8_t));
+    }
+    queue_jobs(pf_ctxt);
+    pf_ctxt->next_job = 0;
+    pf_ctxt->num_waiters = 0;
+
+    /* On a single thread the queue order already satisfies every wait */
+    if (tile_mt_ctxt == NULL) {
+        dec_pf_run_jobs(pf_ctxt, &pf_ctxt->scratch[0]);
+        return;
+    }
+
+    tile_mt_ctxt->post_filter = 1;
+    for (int32_t i = 0; i < tile_mt_ctxt->num_workers; i++)
+        eb_post_semaphore(tile_mt_ctxt->workers[i].start_semaphore);
+    dec_pf_run_jobs(pf_ctxt, &pf_ctxt->scratch[tile_mt_ctxt->num_workers]);
+    for (int32_t i = 0; i < tile_mt_ctxt->num_workers; i++)
+        eb_block_on_semaphore(tile_mt_ctxt->done_semaphore);
+    tile_mt_ctxt->post_filter = 0;
+}
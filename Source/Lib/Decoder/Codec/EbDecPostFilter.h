@@ -0,0 +1,101 @@
+/*
+* Copyright(c) 2019 Netflix, Inc.
+* SPDX - License - Identifier: BSD - 2 - Clause - Patent
+*/
+
+#ifndef EbDecPostFilter_h
+#define EbDecPostFilter_h
+
+#include "EbDecHandle.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum DecPfStage {
+    DEC_PF_LF,
+    DEC_PF_CDEF,
+    DEC_PF_LR,
+    DEC_PF_PUBLISH
+} DecPfStage;
+
+/* One row of a post filter stage : a SB row of deblocking, a 64x64 filter
+   block row of CDEF, a row of restoration units of a plane, or a SB row
+   published to the frames referencing the picture once all the stages are
+   done with it */
+typedef struct DecPfJob {
+    DecPfStage          stage;
+    int32_t             plane;
+    int32_t             row;
+    int32_t             num_cols;
+    /* Number of columns done, num_cols once the whole row is done */
+    volatile uint32_t   progress;
+} DecPfJob;
+
+/* Scratch buffers of a thread running post filter jobs */
+typedef struct DecPfScratch {
+    uint16_t                *cdef_colbuf[MAX_MB_PLANE];
+    RestorationLineBuffers  *rlbs;
+    int32_t                 *rst_tmpbuf;
+} DecPfScratch;
+
+/* Post filters of a frame as row jobs. The rows of all stages are queued
+   interleaved, so that a single thread runs deblocking, CDEF and LR over a
+   window of a few SB rows that stays in the cache. With tile workers the
+   rows form a wavefront : each row starts as soon as the rows it reads
+   from, in its own stage and in the previous one, are far enough ahead */
+typedef struct DecPfCtxt {
+    EbDecHandle     *dec_handle_ptr;
+
+    /* Frame level decisions */
+    int32_t         do_lf;
+    int32_t         do_cdef;
+    int32_t         do_lr;
+    int32_t         opt_lr;
+
+    int32_t         lf_rows;
+    int32_t         cdef_rows;
+    int32_t         lr_rows[MAX_MB_PLANE];
+    int32_t         publish_rows;
+
+    /* Jobs of each stage, in row order */
+    DecPfJob        *lf_jobs;
+    DecPfJob        *cdef_jobs;
+    DecPfJob        *lr_jobs[MAX_MB_PLANE];
+    DecPfJob        *publish_jobs;
+
+    /* Jobs in the order the threads pick them : a job is only queued after
+       all the jobs it waits on, so the wavefront can not deadlock */
+    DecPfJob        *jobs;
+    DecPfJob        **job_queue;
+    int32_t         num_jobs;
+    volatile uint32_t next_job;
+
+    /* Deblocked last lines of the filter block rows, alternating between
+       two buffers : a row overwrites the lines of the row two above only
+       left of where the row in between reads them. Then the filtered flags
+       of the blocks of each row, after a row of sentinels */
+    uint16_t        *cdef_linebuf[MAX_MB_PLANE];
+    int32_t         cdef_linebuf_size;
+    uint8_t         *cdef_row_flags;
+
+    /* One per tile worker, then the calling thread */
+    DecPfScratch    *scratch;
+
+    EbHandle        progress_mutex;
+    EbHandle        progress_semaphore;
+    int32_t         num_waiters;
+} DecPfCtxt;
+
+/* Deblocking, CDEF and loop restoration of the current frame, on the
+   calling thread and the tile workers if any */
+void dec_pf_frame(EbDecHandle *dec_handle_ptr, int32_t do_cdef,
+                  int32_t opt_lr, int32_t do_lr);
+
+/* Runs queued post filter jobs until none is left */
+void dec_pf_run_jobs(DecPfCtxt *pf_ctxt, DecPfScratch *scratch);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // EbDecPostFilter_h
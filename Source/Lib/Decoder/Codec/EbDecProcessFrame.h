@@ -62,17 +62,14 @@ typedef struct LRCtxt {
     /** Decoder Handle */
     void *dec_handle_ptr;
 
-    /* Wiener and SGR Filter holder */
-    RestorationUnitInfo    *lr_unit[MAX_MB_PLANE];
-
     /* Buffer to store deblocked line buffer around stripe boundary */
     RestorationStripeBoundaries boundaries[MAX_MB_PLANE];
 
     /* Used to store CDEF line buffer around stripe boundary */
     RestorationLineBuffers *rlbs;
 
-    /* Scratch buffer to hold LR output */
-    uint8_t *dst;
+    /* Scratch buffers to hold LR output, one per plane */
+    uint8_t *dst[MAX_MB_PLANE];
     uint16_t dst_stride;
 
     /* Pointer to a scratch buffer used by self-guided restoration */
@@ -40,10 +40,67 @@ int av1_superres_scaled(FrameSize *frame_size) {
     return !(frame_size->frame_width == frame_size->superres_upscaled_width);
 }
 
-void dec_av1_loop_restoration_filter_frame(EbDecHandle *dec_handle, int optimized_lr)
+/* Restoration units of a plane : the last row and column of units absorb
+   the remainder of the plane when it is less than half a unit */
+static int lr_num_units(int size, int unit_size)
 {
-    assert(!dec_handle->frame_header.all_lossless);
+    const int ext_size = unit_size * 3 / 2;
+    int n = 0;
+    for (int pos = 0; pos < size; n++)
+        pos += (size - pos < ext_size) ? size - pos : unit_size;
+    return n;
+}
+
+static int lr_unit_length(int size, int unit_size, int idx)
+{
+    const int ext_size = unit_size * 3 / 2;
+    const int remaining = size - idx * unit_size;
+    return (remaining < ext_size) ? remaining : unit_size;
+}
 
+void dec_av1_lr_unit_grid(EbDecHandle *dec_handle, int plane,
+                          int *unit_rows, int *unit_cols)
+{
+    LRParams *lr_params = &dec_handle->frame_header.lr_params[plane];
+    AV1PixelRect tile_rect = av1_whole_frame_rect(&dec_handle->seq_header,
+                                                  plane > 0);
+
+    *unit_rows = lr_num_units(tile_rect.bottom - tile_rect.top,
+                              lr_params->loop_restoration_size);
+    *unit_cols = lr_num_units(tile_rect.right - tile_rect.left,
+                              lr_params->loop_restoration_size);
+}
+
+/* Rows of the plane covered by a row of restoration units, offset upwards
+   to align with the restoration processing stripes */
+void dec_av1_lr_unit_row_limits(EbDecHandle *dec_handle, int plane,
+                                int unit_row, RestorationTileLimits *limits)
+{
+    LRParams *lr_params = &dec_handle->frame_header.lr_params[plane];
+    AV1PixelRect tile_rect = av1_whole_frame_rect(&dec_handle->seq_header,
+                                                  plane > 0);
+    int sy = plane ? dec_handle->seq_header.color_config.subsampling_y : 0;
+    int tile_h = tile_rect.bottom - tile_rect.top;
+    int y = unit_row * lr_params->loop_restoration_size;
+    int h = lr_unit_length(tile_h, lr_params->loop_restoration_size, unit_row);
+
+    limits->v_start = tile_rect.top + y;
+    limits->v_end   = tile_rect.top + y + h;
+    assert(limits->v_end <= tile_rect.bottom);
+
+    // Offset the tile upwards to align with the restoration processing stripe
+    const int voffset = RESTORATION_UNIT_OFFSET >> sy;
+    limits->v_start = AOMMAX(tile_rect.top, limits->v_start - voffset);
+    if (limits->v_end < tile_rect.bottom) limits->v_end -= voffset;
+}
+
+/* Filters one restoration unit of the plane into LRCtxt.dst. Units sharing
+   a stripe boundary must not be filtered at the same time : the rows around
+   the stripe are patched with the saved boundary lines while filtering */
+void dec_av1_loop_restoration_filter_unit(EbDecHandle *dec_handle, int plane,
+    int unit_row, int unit_col, RestorationLineBuffers *rlbs,
+    int32_t *rst_tmpbuf, int optimized_lr)
+{
     LRCtxt *lr_ctxt = (LRCtxt *)dec_handle->pv_lr_ctxt;
     MasterFrameBuf *master_frame_buf = &dec_handle->master_frame_buf;
     CurFrameBuf    *frame_buf = &master_frame_buf->cur_frame_bufs[0];
@@ -51,88 +108,122 @@ void dec_av1_loop_restoration_filter_frame(EbDecHandle *dec_handle, int optimize
     AV1PixelRect tile_rect;
     EbPictureBufferDesc *cur_pic_buf = dec_handle->cur_pic_buf[0]->ps_pic_buf;
     RestorationUnitInfo *lr_unit;
+    LRParams *lr_params = &dec_handle->frame_header.lr_params[plane];
 
-    lr_ctxt->lr_unit[AOM_PLANE_Y] = frame_buf->lr_unit[AOM_PLANE_Y];
-    lr_ctxt->lr_unit[AOM_PLANE_U] = frame_buf->lr_unit[AOM_PLANE_U];
-    lr_ctxt->lr_unit[AOM_PLANE_V] = frame_buf->lr_unit[AOM_PLANE_V];
-
-    int num_plane = av1_num_planes(&dec_handle->seq_header.color_config);
     int use_highbd = (dec_handle->seq_header.color_config.bit_depth > 8);
     int bit_depth = dec_handle->seq_header.color_config.bit_depth;
     int sb_log2 = dec_handle->seq_header.sb_size_log2;
-    int h = 0, w = 0, x, y, src_stride, dst_stride, tile_stripe0 = 0;
+    int src_stride, dst_stride, tile_stripe0 = 0;
     uint8_t *src, *dst;
+    int is_uv = plane > 0;
+    int sx = 0, sy = 0;
+    int master_col = dec_handle->master_frame_buf.sb_cols;
 
-    for (int plane = 0; plane < num_plane; plane++)
-    {
-        LRParams *lr_params = &dec_handle->frame_header.lr_params[plane];
-        int ext_size = lr_params->loop_restoration_size * 3 / 2;
-        int is_uv = plane > 0;
-        int sx = 0, sy = 0;
-        int master_col = dec_handle->master_frame_buf.sb_cols;
-
-        if (plane) {
-            sx = dec_handle->seq_header.color_config.subsampling_x;
-            sy = dec_handle->seq_header.color_config.subsampling_y;
-        }
+    if (plane) {
+        sx = dec_handle->seq_header.color_config.subsampling_x;
+        sy = dec_handle->seq_header.color_config.subsampling_y;
+    }
+
+    // src points to frame start
+    derive_blk_pointers(cur_pic_buf, plane, 0, 0, (void *)&src,
+                        &src_stride, sx, sy);
+
+    dst = lr_ctxt->dst[plane];
+    dst_stride = lr_ctxt->dst_stride;
+
+    tile_rect = av1_whole_frame_rect(&dec_handle->seq_header, is_uv);
+    int tile_w = tile_rect.right - tile_rect.left;
+    int y = unit_row * lr_params->loop_restoration_size;
+    int x = unit_col * lr_params->loop_restoration_size;
+    int w = lr_unit_length(tile_w, lr_params->loop_restoration_size, unit_col);
+
+    dec_av1_lr_unit_row_limits(dec_handle, plane, unit_row, &tile_limit);
+    tile_limit.h_start = tile_rect.left + x;
+    tile_limit.h_end   = tile_rect.left + x + w;
+
+    /* The units away from the decoded area are not filtered */
+    if (!in_dec_area(&dec_handle->dec_area,
+        (tile_limit.v_start << sy) >> MI_SIZE_LOG2,
+        (tile_limit.h_start << sx) >> MI_SIZE_LOG2,
+        AOMMAX((tile_limit.v_end - tile_limit.v_start) << sy, w << sx) >>
+        MI_SIZE_LOG2))
+        return;
+
+    lr_unit = frame_buf->lr_unit[plane] +
+        ((y >> sb_log2) * master_col) + ((x >> sb_log2));
+
+    if (!use_highbd)
+        eb_av1_loop_restoration_filter_unit(1, &tile_limit, lr_unit,
+            &lr_ctxt->boundaries[plane], rlbs, &tile_rect,
+            tile_stripe0, sx, sy, use_highbd, bit_depth, src,
+            src_stride, dst, dst_stride, rst_tmpbuf, optimized_lr);
+    else
+        eb_av1_loop_restoration_filter_unit(1, &tile_limit, lr_unit,
+            &lr_ctxt->boundaries[plane], rlbs, &tile_rect,
+            tile_stripe0, sx, sy, use_highbd, bit_depth,
+            CONVERT_TO_BYTEPTR(src), src_stride, CONVERT_TO_BYTEPTR(dst),
+            dst_stride, rst_tmpbuf, optimized_lr);
+}
+
+/* Copies the filtered rows of a row of restoration units back to the frame.
+   The units of the rows above and below must be done with them */
+void dec_av1_loop_restoration_copy_unit_row(EbDecHandle *dec_handle,
+                                            int plane, int unit_row)
+{
+    LRCtxt *lr_ctxt = (LRCtxt *)dec_handle->pv_lr_ctxt;
+    EbPictureBufferDesc *cur_pic_buf = dec_handle->cur_pic_buf[0]->ps_pic_buf;
+    RestorationTileLimits tile_limit;
+    int use_highbd = (dec_handle->seq_header.color_config.bit_depth > 8);
+    int src_stride, dst_stride = lr_ctxt->dst_stride;
+    uint8_t *src, *dst;
+    int sx = 0, sy = 0;
 
-        // src points to frame start
-        derive_blk_pointers(cur_pic_buf, plane, 0, 0, (void *)&src,
-                            &src_stride, sx, sy);
+    if (plane) {
+        sx = dec_handle->seq_header.color_config.subsampling_x;
+        sy = dec_handle->seq_header.color_config.subsampling_y;
+    }
+
+    AV1PixelRect tile_rect = av1_whole_frame_rect(&dec_handle->seq_header,
+                                                  plane > 0);
+    int tile_w = tile_rect.right - tile_rect.left;
 
-        dst = lr_ctxt->dst;
-        dst_stride = lr_ctxt->dst_stride;
+    dec_av1_lr_unit_row_limits(dec_handle, plane, unit_row, &tile_limit);
 
-        tile_rect = av1_whole_frame_rect(&dec_handle->seq_header, is_uv);
-        int tile_h = tile_rect.bottom - tile_rect.top;
-        int tile_w = tile_rect.right - tile_rect.left;
+    derive_blk_pointers(cur_pic_buf, plane, 0, tile_limit.v_start,
+                        (void *)&src, &src_stride, sx, sy);
+    dst = lr_ctxt->dst[plane] +
+        ((tile_limit.v_start * dst_stride) << use_highbd);
 
-        if (lr_params->frame_restoration_type == RESTORE_NONE)
+    for (int y = tile_limit.v_start; y < tile_limit.v_end; y++) {
+        memcpy(src, dst, tile_w * sizeof(*dst) << use_highbd);
+        src += src_stride << use_highbd;
+        dst += dst_stride << use_highbd;
+    }
+}
+
+void dec_av1_loop_restoration_filter_frame(EbDecHandle *dec_handle, int optimized_lr)
+{
+    assert(!dec_handle->frame_header.all_lossless);
+
+    LRCtxt *lr_ctxt = (LRCtxt *)dec_handle->pv_lr_ctxt;
+    int num_plane = av1_num_planes(&dec_handle->seq_header.color_config);
+    int unit_rows, unit_cols;
+
+    for (int plane = 0; plane < num_plane; plane++)
+    {
+        if (dec_handle->frame_header.lr_params[plane].frame_restoration_type ==
+            RESTORE_NONE)
             continue;
 
-        for (y = 0; y < tile_h; y += h)
-        {
-            int remaining_h = tile_h - y;
-            h = (remaining_h < ext_size) ? remaining_h :
-                                           lr_params->loop_restoration_size;
-            tile_limit.v_start = tile_rect.top + y;
-            tile_limit.v_end   = tile_rect.top + y + h;
-            assert(tile_limit.v_end <= tile_rect.bottom);
-
-            // Offset the tile upwards to align with the restoration processing stripe
-            const int voffset = RESTORATION_UNIT_OFFSET >> sy;
-            tile_limit.v_start = AOMMAX(tile_rect.top, tile_limit.v_start - voffset);
-            if (tile_limit.v_end < tile_rect.bottom) tile_limit.v_end -= voffset;
-
-            for (x = 0; x < tile_w; x += w)
-            {
-                int remaining_w = tile_w - x;
-                w = (remaining_w < ext_size) ? remaining_w :
-                                               lr_params->loop_restoration_size;
-                tile_limit.h_start = tile_rect.left + x;
-                tile_limit.h_end   = tile_rect.left + x + w;
-
-                lr_unit = lr_ctxt->lr_unit[plane] +
-                    ((y >> sb_log2) * master_col) + ((x >> sb_log2));
-
-                if (!use_highbd)
-                    eb_av1_loop_restoration_filter_unit(1, &tile_limit, lr_unit,
-                        &lr_ctxt->boundaries[plane], lr_ctxt->rlbs, &tile_rect,
-                        tile_stripe0, sx, sy, use_highbd, bit_depth, src,
-                        src_stride, dst, dst_stride, lr_ctxt->rst_tmpbuf, optimized_lr);
-                else
-                    eb_av1_loop_restoration_filter_unit(1, &tile_limit, lr_unit,
-                        &lr_ctxt->boundaries[plane], lr_ctxt->rlbs, &tile_rect,
-                        tile_stripe0, sx, sy, use_highbd, bit_depth,
-                        CONVERT_TO_BYTEPTR(src), src_stride, CONVERT_TO_BYTEPTR(dst),
-                        dst_stride, lr_ctxt->rst_tmpbuf, optimized_lr);
+        dec_av1_lr_unit_grid(dec_handle, plane, &unit_rows, &unit_cols);
+        for (int row = 0; row < unit_rows; row++) {
+            for (int col = 0; col < unit_cols; col++) {
+                dec_av1_loop_restoration_filter_unit(dec_handle, plane, row,
+                    col, lr_ctxt->rlbs, lr_ctxt->rst_tmpbuf, optimized_lr);
             }
         }
-        for (y = 0; y < tile_h; y++) {
-            memcpy(src, dst, dst_stride * sizeof(*dst) << use_highbd);
-            src += src_stride << use_highbd;
-            dst += dst_stride << use_highbd;
-        }
+        for (int row = 0; row < unit_rows; row++)
+            dec_av1_loop_restoration_copy_unit_row(dec_handle, plane, row);
     }
 }
 
@@ -248,8 +339,11 @@ void dec_save_cdef_boundary_lines(EbDecHandle *dec_handle,
         RESTORATION_EXTRA_HORZ, use_highbd);
 }
 
+/* Saves the boundary lines of the stripes of a plane that start in rows
+   row_start to row_end - 1 */
 void dec_save_tile_row_boundary_lines(EbDecHandle *dec_handle, int use_highbd,
-                                      int plane, int after_cdef)
+                                      int plane, int after_cdef,
+                                      int row_start, int row_end)
 {
     const int is_uv = plane > 0;
     const int ss_y = is_uv && dec_handle->seq_header.color_config.subsampling_y;
@@ -288,11 +382,12 @@ void dec_save_tile_row_boundary_lines(EbDecHandle *dec_handle, int use_highbd,
 
         if (!after_cdef) {
             // Save deblocked context where needed.
-            if (use_deblock_above) {
+            if (use_deblock_above && y0 - RESTORATION_CTX_VERT >= row_start &&
+                y0 - RESTORATION_CTX_VERT < row_end) {
                 dec_save_deblock_boundary_lines(dec_handle, plane,
                     y0 - RESTORATION_CTX_VERT, frame_stripe, use_highbd, 1, boundaries);
             }
-            if (use_deblock_below) {
+            if (use_deblock_below && y1 >= row_start && y1 < row_end) {
                 dec_save_deblock_boundary_lines(dec_handle, plane, y1, frame_stripe,
                     use_highbd, 0, boundaries);
             }
@@ -304,11 +399,11 @@ void dec_save_tile_row_boundary_lines(EbDecHandle *dec_handle, int use_highbd,
             //
             // In addition, we need to save copies of the outermost line within
             // the tile, rather than using data from outside the tile.
-            if (!use_deblock_above) {
+            if (!use_deblock_above && y0 >= row_start && y0 < row_end) {
                 dec_save_cdef_boundary_lines(dec_handle, plane, y0,
                     frame_stripe, use_highbd, 1, boundaries);
             }
-            if (!use_deblock_below) {
+            if (!use_deblock_below && y1 - 1 >= row_start && y1 - 1 < row_end) {
                 dec_save_cdef_boundary_lines(dec_handle, plane, y1 - 1,
                     frame_stripe, use_highbd, 0, boundaries);
             }
@@ -322,5 +417,26 @@ void dec_av1_loop_restoration_save_boundary_lines(EbDecHandle *dec_handle,
     const int num_planes = av1_num_planes(&dec_handle->seq_header.color_config);
     const int use_highbd = (dec_handle->seq_header.color_config.bit_depth > 8);
     for (int p = 0; p < num_planes; ++p)
-        dec_save_tile_row_boundary_lines(dec_handle, use_highbd, p, after_cdef);
+        dec_save_tile_row_boundary_lines(dec_handle, use_highbd, p, after_cdef,
+                                         0, INT32_MAX);
+}
+
+/* Saves the boundary lines that lie in the 64 luma rows of CDEF filter block
+   row fb_row : the deblocked ones before its CDEF, the others after */
+void dec_av1_loop_restoration_save_row_boundary_lines(EbDecHandle *dec_handle,
+                                                      int fb_row, int after_cdef)
+{
+    const int num_planes = av1_num_planes(&dec_handle->seq_header.color_config);
+    const int use_highbd = (dec_handle->seq_header.color_config.bit_depth > 8);
+    const int last_row = (fb_row + 1) * MI_SIZE_64X64 >=
+        (int)dec_handle->frame_header.mi_rows;
+
+    for (int p = 0; p < num_planes; ++p) {
+        const int ss_y = p && dec_handle->seq_header.color_config.subsampling_y;
+        const int row_start = (fb_row * MI_SIZE_64X64 * MI_SIZE) >> ss_y;
+        const int row_end = last_row ? INT32_MAX :
+            ((fb_row + 1) * MI_SIZE_64X64 * MI_SIZE) >> ss_y;
+        dec_save_tile_row_boundary_lines(dec_handle, use_highbd, p, after_cdef,
+                                         row_start, row_end);
+    }
 }
@@ -19,6 +19,19 @@ void dec_av1_loop_restoration_filter_frame(EbDecHandle *dec_handle,
 void dec_av1_loop_restoration_save_boundary_lines(EbDecHandle *dec_handle,
                                                   int after_cdef);
 
+/* Row wise restoration, see dec_av1_loop_restoration_filter_frame() */
+void dec_av1_lr_unit_grid(EbDecHandle *dec_handle, int plane,
+                          int *unit_rows, int *unit_cols);
+void dec_av1_lr_unit_row_limits(EbDecHandle *dec_handle, int plane,
+                                int unit_row, RestorationTileLimits *limits);
+void dec_av1_loop_restoration_filter_unit(EbDecHandle *dec_handle, int plane,
+    int unit_row, int unit_col, RestorationLineBuffers *rlbs,
+    int32_t *rst_tmpbuf, int optimized_lr);
+void dec_av1_loop_restoration_copy_unit_row(EbDecHandle *dec_handle,
+                                            int plane, int unit_row);
+void dec_av1_loop_restoration_save_row_boundary_lines(EbDecHandle *dec_handle,
+                                                      int fb_row, int after_cdef);
+
 #ifdef __cplusplus
 }
 #endif
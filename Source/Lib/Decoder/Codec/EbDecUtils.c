@@ -91,9 +91,41 @@ void derive_blk_pointers(EbPictureBufferDesc *recon_picture_buf, int32_t plane,
     }
 }
 
-void pad_pic(EbPictureBufferDesc *recon_picture_buf) {
+/* Pads rows y0 to y1 - 1 of a plane on the left and right, then the border
+   above the plane with its first row and below with its last one.
+   stride, width and origin_x are in bytes */
+static void pad_plane_rows(EbByte buf, uint32_t stride, uint32_t width,
+                           uint32_t height, uint32_t origin_x,
+                           uint32_t origin_y, uint32_t y0, uint32_t y1,
+                           EbBool is16bit)
+{
+    EbByte first_row = buf + origin_y * stride;
+    EbByte last_row = buf + (origin_y + height - 1) * stride;
+
+    if (is16bit)
+        generate_padding16_bit(first_row + y0 * stride, stride, width,
+            y1 - y0, origin_x, 0);
+    else
+        generate_padding(first_row + y0 * stride, stride, width,
+            y1 - y0, origin_x, 0);
+
+    for (uint32_t i = 1; i <= origin_y; i++) {
+        if (y0 == 0)
+            memcpy(first_row - i * stride, first_row, stride);
+        if (y1 == height)
+            memcpy(last_row + i * stride, last_row, stride);
+    }
+}
+
+/* Pads the luma rows y0 to y1 - 1 of the picture and the matching chroma
+   rows. Rows are padded as they become final, the borders above and below
+   along with the first and last rows */
+void pad_pic_rows(EbPictureBufferDesc *recon_picture_buf, uint32_t y0,
+                  uint32_t y1) {
 
     int32_t sx, sy;
+    EbBool is16bit = recon_picture_buf->bit_depth != EB_8BIT;
+    uint32_t height = recon_picture_buf->height;
 
     switch (recon_picture_buf->color_format) {
         case EB_YUV420:
@@ -104,62 +136,46 @@ void pad_pic(EbPictureBufferDesc *recon_picture_buf) {
             assert(0);
     }
 
-    if (recon_picture_buf->bit_depth == EB_8BIT) {
-        // Y samples
-        generate_padding(
-            recon_picture_buf->buffer_y,
-            recon_picture_buf->stride_y,
-            recon_picture_buf->width,
-            recon_picture_buf->height,
-            recon_picture_buf->origin_x,
-            recon_picture_buf->origin_y);
-
-        // Cb samples
-        generate_padding(
-            recon_picture_buf->buffer_cb,
-            recon_picture_buf->stride_cb,
-            recon_picture_buf->width >> sx,
-            recon_picture_buf->height >> sy,
-            recon_picture_buf->origin_x >> sx,
-            recon_picture_buf->origin_y >> sy);
-
-        // Cr samples
-        generate_padding(
-            recon_picture_buf->buffer_cr,
-            recon_picture_buf->stride_cr,
-            recon_picture_buf->width >> sx,
-            recon_picture_buf->height >> sy,
-            recon_picture_buf->origin_x >> sx,
-            recon_picture_buf->origin_y >> sy);
-    }
-    else {
-        // Y samples
-        generate_padding16_bit(
-            recon_picture_buf->buffer_y,
-            recon_picture_buf->stride_y << 1,
-            recon_picture_buf->width << 1,
-            recon_picture_buf->height,
-            recon_picture_buf->origin_x << 1,
-            recon_picture_buf->origin_y);
-
-        // Cb samples
-        generate_padding16_bit(
-            recon_picture_buf->buffer_cb,
-            recon_picture_buf->stride_cb << 1,
-            recon_picture_buf->width >> sx << 1,
-            recon_picture_buf->height >> sy,
-            recon_picture_buf->origin_x >> sx << 1,
-            recon_picture_buf->origin_y >> sy);
-
-        // Cr samples
-        generate_padding16_bit(
-            recon_picture_buf->buffer_cr,
-            recon_picture_buf->stride_cr << 1,
-            recon_picture_buf->width >> sx << 1,
-            recon_picture_buf->height >> sy,
-            recon_picture_buf->origin_x >> sx << 1,
-            recon_picture_buf->origin_y >> sy);
-    }
+    y1 = AOMMIN(y1, height);
+    if (y0 >= y1)
+        return;
+
+    uint32_t uv_y0 = y0 >> sy;
+    uint32_t uv_y1 = (y1 == height) ? (height >> sy) : (y1 >> sy);
+
+    // Y samples
+    pad_plane_rows(
+        recon_picture_buf->buffer_y,
+        recon_picture_buf->stride_y << is16bit,
+        recon_picture_buf->width << is16bit,
+        height,
+        recon_picture_buf->origin_x << is16bit,
+        recon_picture_buf->origin_y,
+        y0, y1, is16bit);
+
+    // Cb samples
+    pad_plane_rows(
+        recon_picture_buf->buffer_cb,
+        recon_picture_buf->stride_cb << is16bit,
+        recon_picture_buf->width >> sx << is16bit,
+        height >> sy,
+        recon_picture_buf->origin_x >> sx << is16bit,
+        recon_picture_buf->origin_y >> sy,
+        uv_y0, uv_y1, is16bit);
+
+    // Cr samples
+    pad_plane_rows(
+        recon_picture_buf->buffer_cr,
+        recon_picture_buf->stride_cr << is16bit,
+        recon_picture_buf->width >> sx << is16bit,
+        height >> sy,
+        recon_picture_buf->origin_x >> sx << is16bit,
+        recon_picture_buf->origin_y >> sy,
+        uv_y0, uv_y1, is16bit);
+}
+
+void pad_pic(EbPictureBufferDesc *recon_picture_buf) {
+    pad_pic_rows(recon_picture_buf, 0, recon_picture_buf->height);
 }
 
 int inverse_recenter(int r, int v)
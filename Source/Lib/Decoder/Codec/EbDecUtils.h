@@ -24,6 +24,17 @@ static INLINE int get_relative_dist(OrderHintInfo *ps_order_hint_info,
     return diff;
 }
 
+/* Whether the block at (mi_row, mi_col), of mi_size 4x4s, overlaps the
+   reconstructed area of the frame */
+static INLINE int in_dec_area(const TileInfo *dec_area, int32_t mi_row,
+                              int32_t mi_col, int32_t mi_size)
+{
+    return mi_row < dec_area->mi_row_end &&
+        mi_row + mi_size > dec_area->mi_row_start &&
+        mi_col < dec_area->mi_col_end &&
+        mi_col + mi_size > dec_area->mi_col_start;
+}
+
 EbErrorType check_add_tplmv_buf(EbDecHandle *dec_handle_ptr);
 
 void derive_blk_pointers(EbPictureBufferDesc *recon_picture_buf, int32_t plane,
@@ -32,6 +43,8 @@ void derive_blk_pointers(EbPictureBufferDesc *recon_picture_buf, int32_t plane,
                          int32_t sub_x, int32_t sub_y);
 
 void pad_pic(EbPictureBufferDesc *recon_picture_buf);
+void pad_pic_rows(EbPictureBufferDesc *recon_picture_buf, uint32_t y0,
+                  uint32_t y1);
 
 int inverse_recenter(int r, int v);
 
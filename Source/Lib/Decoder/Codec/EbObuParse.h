@@ -190,7 +190,19 @@ void parse_super_block(EbDecHandle *dec_handle, uint32_t blk_row,
 
 void svt_setup_motion_field(EbDecHandle *dec_handle);
 
-EbErrorType decode_obu(EbDecHandle *dec_handle_ptr, uint8_t *data, uint32_t data_size);
-EbErrorType decode_multiple_obu(EbDecHandle *dec_handle_ptr, uint8_t **data, size_t data_size);
+/* Tile worker thread, decodes the tiles queued by read_tile_group_obu */
+void *dec_tile_worker_kernel(void *input_ptr);
+
+/* Frame thread, decodes the frames handed over by read_tile_group_obu */
+void *dec_frame_worker_kernel(void *input_ptr);
+
+/* Waits for all frames in flight, returns the first decode error */
+EbErrorType dec_frame_mt_flush(EbDecHandle *dec_handle_ptr);
+
+/* Decodes one OBU. *obu_size is set to its size, size field included, and
+   *frame_done once the last tile group of a frame is decoded, or a frame
+   header showing an existing frame */
+EbErrorType decode_obu(EbDecHandle *dec_handle_ptr, const uint8_t *data,
+                       size_t data_size, size_t *obu_size, int *frame_done);
 
 #endif  // EbDecObuParser_h
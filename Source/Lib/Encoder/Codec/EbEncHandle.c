@@ -51,6 +51,7 @@
 #include "EbCdefProcess.h"
 #include "EbRestProcess.h"
 #include "EbObject.h"
+#include "EbTime.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -96,6 +97,9 @@
 
 #define SCD_LAD                                              6
 
+#define NUMA_MODE_OFF                                        0
+#define NUMA_MODE_LOCAL                                      1
+
 /**************************************
  * Globals
  **************************************/
@@ -113,6 +117,47 @@ typedef struct logicalProcessorGroup {
 #define MAX_PROCESSOR_GROUP 16
 processorGroup                   lp_group[MAX_PROCESSOR_GROUP];
 #endif
+
+// Task scheduler shared by the handles created with share_task_scheduler,
+// it lives until the last of them is deinitialized.
+static EbTaskScheduler          *shared_task_scheduler_ptr = NULL;
+static uint32_t                  shared_task_scheduler_ref_count = 0;
+static EbHandle                  shared_task_scheduler_mutex;
+
+#ifdef _WIN32
+static INIT_ONCE shared_task_scheduler_once = INIT_ONCE_STATIC_INIT;
+
+BOOL CALLBACK create_shared_task_scheduler_mutex(
+    PINIT_ONCE InitOnce,
+    PVOID Parameter,
+    PVOID *lpContext)
+{
+    (void)InitOnce;
+    (void)Parameter;
+    (void)lpContext;
+    shared_task_scheduler_mutex = eb_create_mutex();
+    return TRUE;
+}
+
+static EbHandle get_shared_task_scheduler_mutex()
+{
+    InitOnceExecuteOnce(&shared_task_scheduler_once, create_shared_task_scheduler_mutex, NULL, NULL);
+    return shared_task_scheduler_mutex;
+}
+#else
+static void create_shared_task_scheduler_mutex()
+{
+    shared_task_scheduler_mutex = eb_create_mutex();
+}
+
+static pthread_once_t shared_task_scheduler_once = PTHREAD_ONCE_INIT;
+
+static EbHandle get_shared_task_scheduler_mutex()
+{
+    pthread_once(&shared_task_scheduler_once, create_shared_task_scheduler_mutex);
+    return shared_task_scheduler_mutex;
+}
+#endif
 static int32_t CanUseIntelCore4thGenFeatures()
 {
     static int32_t the_4th_gen_features_available = -1;
@@ -278,6 +323,49 @@ void EbSetThreadManagementParameters(EbSvtAv1EncConfiguration *config_ptr)
 #endif
 }
 
+/**********************************
+* NUMA node of the encoder threads
+*   Node shared by every logical processor the threads are pinned to,
+*   EB_NUMA_NODE_ANY when they may run on several nodes.
+**********************************/
+static int32_t GetThreadNumaNode(void)
+{
+#if defined(__linux__)
+    int32_t  node = EB_NUMA_NODE_ANY;
+    uint32_t cpu;
+
+    // An empty set leaves the threads unpinned
+    if (CPU_COUNT(&group_affinity) == 0)
+        return eb_numa_node_count() == 1 ? 0 : EB_NUMA_NODE_ANY;
+
+    for (cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &group_affinity)) {
+            const int32_t cpu_node = eb_numa_cpu_node(cpu);
+            if (cpu_node == EB_NUMA_NODE_ANY || (node != EB_NUMA_NODE_ANY && cpu_node != node))
+                return EB_NUMA_NODE_ANY;
+            node = cpu_node;
+        }
+    }
+    return node;
+#else
+    return EB_NUMA_NODE_ANY;
+#endif
+}
+
+static void PrintNumaMemoryUsage(void)
+{
+    uint64_t node_bytes_array[EB_NUMA_NODE_MAX_COUNT];
+    uint32_t node_count = eb_numa_get_memory_usage(node_bytes_array, EB_NUMA_NODE_MAX_COUNT);
+    uint32_t node;
+
+    if (node_count == 0) {
+        SVT_LOG("SVT [numa]: memory usage per node is not available\n");
+        return;
+    }
+    for (node = 0; node < node_count; ++node)
+        SVT_LOG("SVT [numa]: node %u resident memory: %.2lf MB\n", node, (double)node_bytes_array[node] / (1024 * 1024));
+}
+
 void asmSetConvolveAsmTable(void);
 void asmSetConvolveHbdAsmTable(void);
 void init_intra_dc_predictors_c_internal(void);
@@ -461,6 +549,19 @@ EbErrorType load_default_buffer_configuration_settings(
                                                                           (uint32_t)((1 << sequence_control_set_ptr->static_config.hierarchical_levels) + 2)) +
                                                                           sequence_control_set_ptr->static_config.look_ahead_distance + SCD_LAD;
     sequence_control_set_ptr->output_recon_buffer_fifo_init_count       = sequence_control_set_ptr->reference_picture_buffer_init_count;
+
+    // Same sizing with the picture count of a single core encode
+    const uint32_t min_input_pic = (2 << sequence_control_set_ptr->static_config.hierarchical_levels) + 1;
+    sequence_control_set_ptr->input_buffer_fifo_min_count               = min_input_pic + SCD_LAD + sequence_control_set_ptr->static_config.look_ahead_distance;
+    sequence_control_set_ptr->picture_control_set_pool_min_count        = sequence_control_set_ptr->static_config.enable_overlays ?
+                                                                          sequence_control_set_ptr->picture_control_set_pool_init_count : // not tied to the core count
+                                                                          sequence_control_set_ptr->input_buffer_fifo_min_count;
+    sequence_control_set_ptr->reference_picture_buffer_min_count        = MAX((uint32_t)(min_input_pic >> 1),
+                                                                          (uint32_t)((1 << sequence_control_set_ptr->static_config.hierarchical_levels) + 2)) +
+                                                                          sequence_control_set_ptr->static_config.look_ahead_distance + SCD_LAD;
+    sequence_control_set_ptr->pa_reference_picture_buffer_min_count     = sequence_control_set_ptr->reference_picture_buffer_min_count;
+    // Elastic pools start with one mini-GOP
+    sequence_control_set_ptr->elastic_pool_init_count                   = (1 << sequence_control_set_ptr->static_config.hierarchical_levels) + 2;
     sequence_control_set_ptr->overlay_input_picture_buffer_init_count   = sequence_control_set_ptr->static_config.enable_overlays ?
                                                                           (2 << sequence_control_set_ptr->static_config.hierarchical_levels) + SCD_LAD : 1;
 
@@ -504,6 +605,7 @@ EbErrorType load_default_buffer_configuration_settings(
     }
 
     sequence_control_set_ptr->total_process_init_count += 6; // single processes count
+    sequence_control_set_ptr->task_worker_count = core_count;
     printf("Number of logical cores available: %u\nNumber of PPCS %u\n", core_count, sequence_control_set_ptr->picture_control_set_pool_init_count);
 
     return return_error;
@@ -582,6 +684,11 @@ void lib_svt_encoder_send_error_exit(
 static void eb_enc_handle_stop_threads(EbEncHandle *enc_handle_ptr)
 {
     SequenceControlSet*  control_set_ptr = enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr;
+    // Task Scheduler Channel, detached while the dedicated threads can
+    // still release the objects its tasks may be waiting for
+    if (enc_handle_ptr->task_channel_ptr && enc_handle_ptr->task_scheduler_ptr)
+        eb_task_scheduler_detach_channel(enc_handle_ptr->task_scheduler_ptr, enc_handle_ptr->task_channel_ptr);
+
     // Resource Coordination
     EB_DESTROY_THREAD(enc_handle_ptr->resource_coordination_thread_handle);
     EB_DESTROY_THREAD_ARRAY(enc_handle_ptr->picture_analysis_thread_handle_array,control_set_ptr->picture_analysis_process_init_count);
@@ -624,7 +731,332 @@ static void eb_enc_handle_stop_threads(EbEncHandle *enc_handle_ptr)
 
     // Packetization
     EB_DESTROY_THREAD(enc_handle_ptr->packetization_thread_handle);
+
+    // Task Scheduler Workers
+    if (control_set_ptr->static_config.share_task_scheduler) {
+        if (enc_handle_ptr->task_scheduler_ptr) {
+            EbHandle mutex = get_shared_task_scheduler_mutex();
+            eb_block_on_mutex(mutex);
+            if (--shared_task_scheduler_ref_count == 0)
+                EB_DELETE(shared_task_scheduler_ptr);
+            eb_release_mutex(mutex);
+            enc_handle_ptr->task_scheduler_ptr = NULL;
+        }
+    }
+    else
+        EB_DELETE(enc_handle_ptr->task_scheduler_ptr);
+    EB_DELETE(enc_handle_ptr->task_channel_ptr);
+}
+/**********************************
+* Task Scheduler
+*   Registers the parallel stages in pipeline order as a channel and
+*   attaches it to a scheduler with one worker per logical processor,
+*   in place of the per-stage thread arrays. With share_task_scheduler
+*   the first handle creates the process-wide scheduler and the others
+*   attach to it.
+**********************************/
+static EbErrorType eb_enc_handle_create_task_scheduler(
+    EbTaskScheduler **scheduler_dbl_ptr,
+    uint32_t          worker_total_count)
+{
+    EbTaskScheduler *scheduler_ptr;
+    uint32_t         workerIndex;
+
+    EB_NEW(
+        *scheduler_dbl_ptr,
+        eb_task_scheduler_ctor,
+        worker_total_count);
+    scheduler_ptr = *scheduler_dbl_ptr;
+
+    for (workerIndex = 0; workerIndex < scheduler_ptr->worker_total_count; ++workerIndex)
+        EB_CREATE_THREAD(scheduler_ptr->thread_handle_array[workerIndex], eb_task_scheduler_kernel, scheduler_ptr);
+
+    return EB_ErrorNone;
+}
+
+/**********************************
+* Pipeline Stages
+*   Every stage is identified by the
+*   queue feeding it, in pipeline order.
+**********************************/
+typedef struct EbPipelineStage
+{
+    const char      *name;
+    EbMuxingQueue   *queue_ptr;
+    uint32_t         thread_count;
+} EbPipelineStage;
+
+static uint32_t eb_enc_handle_get_pipeline_stages(
+    EbEncHandle      *enc_handle_ptr,
+    EbPipelineStage  *stage_array)
+{
+    SequenceControlSet*  control_set_ptr = enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr;
+    uint32_t             stageCount = 0;
+
+#define ADD_STAGE(stage_name, fifo_array, count) \
+    do { \
+        stage_array[stageCount].name = stage_name; \
+        stage_array[stageCount].queue_ptr = (fifo_array)[0]->queue_ptr; \
+        stage_array[stageCount].thread_count = count; \
+        ++stageCount; \
+    } while (0)
+
+    ADD_STAGE("resource_coordination", enc_handle_ptr->input_buffer_consumer_fifo_ptr_array, 1);
+    ADD_STAGE("picture_analysis", enc_handle_ptr->resource_coordination_results_consumer_fifo_ptr_array,
+        control_set_ptr->picture_analysis_process_init_count);
+    ADD_STAGE("picture_decision", enc_handle_ptr->picture_analysis_results_consumer_fifo_ptr_array, 1);
+    ADD_STAGE("motion_estimation", enc_handle_ptr->picture_decision_results_consumer_fifo_ptr_array,
+        control_set_ptr->motion_estimation_process_init_count);
+    ADD_STAGE("initial_rate_control", enc_handle_ptr->motion_estimation_results_consumer_fifo_ptr_array, 1);
+    ADD_STAGE("source_based_operations", enc_handle_ptr->initial_rate_control_results_consumer_fifo_ptr_array,
+        control_set_ptr->source_based_operations_process_init_count);
+    ADD_STAGE("picture_manager", enc_handle_ptr->picture_demux_results_consumer_fifo_ptr_array, 1);
+    ADD_STAGE("rate_control", enc_handle_ptr->rate_control_tasks_consumer_fifo_ptr_array, 1);
+    ADD_STAGE("mode_decision_configuration", enc_handle_ptr->rate_control_results_consumer_fifo_ptr_array,
+        control_set_ptr->mode_decision_configuration_process_init_count);
+    ADD_STAGE("enc_dec", enc_handle_ptr->enc_dec_tasks_consumer_fifo_ptr_array,
+        control_set_ptr->enc_dec_process_init_count);
+    ADD_STAGE("dlf", enc_handle_ptr->enc_dec_results_consumer_fifo_ptr_array,
+        control_set_ptr->dlf_process_init_count);
+    ADD_STAGE("cdef", enc_handle_ptr->dlf_results_consumer_fifo_ptr_array,
+        control_set_ptr->cdef_process_init_count);
+    ADD_STAGE("rest", enc_handle_ptr->cdef_results_consumer_fifo_ptr_array,
+        control_set_ptr->rest_process_init_count);
+    ADD_STAGE("entropy_coding", enc_handle_ptr->rest_results_consumer_fifo_ptr_array,
+        control_set_ptr->entropy_coding_process_init_count);
+    ADD_STAGE("packetization", enc_handle_ptr->entropy_coding_results_consumer_fifo_ptr_array, 1);
+#undef ADD_STAGE
+
+    return stageCount;
+}
+
+/**********************************
+* Picture pools
+*   The pools holding full pictures, the ones sized by elastic_pools and
+*   max_memory_mb.
+**********************************/
+typedef struct EbPicturePool
+{
+    EbSystemResource *resource_ptr;
+    uint32_t          min_count;
+    const char       *name;
+} EbPicturePool;
+
+#define EB_PICTURE_POOL_MAX_COUNT       (1 + 3 * EB_EncodeInstancesTotalCount)
+
+/* Objects constructed up front: one mini-GOP for an elastic pool, the floor
+ * for a pool sized by the memory budget once the object sizes are known. */
+static uint32_t get_picture_pool_init_count(
+    SequenceControlSet *sequence_control_set_ptr,
+    uint32_t            min_count,
+    uint32_t            max_count)
+{
+    if (sequence_control_set_ptr->static_config.elastic_pools)
+        return MIN(sequence_control_set_ptr->elastic_pool_init_count, min_count);
+    if (sequence_control_set_ptr->static_config.max_memory_mb)
+        return min_count;
+    return max_count;
+}
+
+static uint32_t eb_enc_handle_get_picture_pools(
+    EbEncHandle   *enc_handle_ptr,
+    EbPicturePool *pool_array)
+{
+    uint32_t poolCount = 0;
+    uint32_t instance_index;
+
+    pool_array[poolCount].name = "input";
+    pool_array[poolCount].resource_ptr = enc_handle_ptr->input_buffer_resource_ptr;
+    pool_array[poolCount++].min_count = enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->input_buffer_fifo_min_count;
+    for (instance_index = 0; instance_index < enc_handle_ptr->encode_instance_total_count; ++instance_index) {
+        SequenceControlSet *sequence_control_set_ptr = enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr;
+
+        pool_array[poolCount].name = "picture control set";
+        pool_array[poolCount].resource_ptr = enc_handle_ptr->picture_parent_control_set_pool_ptr_array[instance_index];
+        pool_array[poolCount++].min_count = sequence_control_set_ptr->picture_control_set_pool_min_count;
+        pool_array[poolCount].name = "reference";
+        pool_array[poolCount].resource_ptr = enc_handle_ptr->reference_picture_pool_ptr_array[instance_index];
+        pool_array[poolCount++].min_count = sequence_control_set_ptr->reference_picture_buffer_min_count;
+        pool_array[poolCount].name = "pa reference";
+        pool_array[poolCount].resource_ptr = enc_handle_ptr->pa_reference_picture_pool_ptr_array[instance_index];
+        pool_array[poolCount++].min_count = sequence_control_set_ptr->pa_reference_picture_buffer_min_count;
+    }
+
+    return poolCount;
+}
+
+static void PrintArenaPoolUsage(
+    const char       *name,
+    EbSystemResource *resource_ptr)
+{
+    EbArenaStats stats;
+
+    if (resource_ptr == NULL || resource_ptr->arena_ptr == NULL)
+        return;
+    eb_arena_get_stats(resource_ptr->arena_ptr, &stats);
+    if (stats.region_count == 0)
+        return;
+    SVT_LOG("SVT [arena]: %s pool: %u regions, %.2lf MB reserved (%.2lf MB huge pages), %.2lf MB in use (peak %.2lf MB) by %u planes\n",
+        name,
+        stats.region_count,
+        (double)stats.reserved_size / (1024 * 1024),
+        (double)stats.hugetlb_size / (1024 * 1024),
+        (double)stats.used_size / (1024 * 1024),
+        (double)stats.peak_size / (1024 * 1024),
+        stats.block_count);
 }
+
+/**********************************
+* Arena memory report
+*   Every pool constructed with a picture arena, the picture pools and the
+*   child picture control set and overlay pools.
+**********************************/
+static void PrintArenaMemoryUsage(EbEncHandle *enc_handle_ptr)
+{
+    EbPicturePool  pool_array[EB_PICTURE_POOL_MAX_COUNT];
+    const uint32_t poolCount = eb_enc_handle_get_picture_pools(enc_handle_ptr, pool_array);
+    uint32_t       poolIndex;
+    uint32_t       instance_index;
+
+    for (poolIndex = 0; poolIndex < poolCount; ++poolIndex)
+        PrintArenaPoolUsage(pool_array[poolIndex].name, pool_array[poolIndex].resource_ptr);
+    for (instance_index = 0; instance_index < enc_handle_ptr->encode_instance_total_count; ++instance_index) {
+        PrintArenaPoolUsage("child picture control set", enc_handle_ptr->picture_control_set_pool_ptr_array[instance_index]);
+        if (enc_handle_ptr->overlay_input_picture_pool_ptr_array)
+            PrintArenaPoolUsage("overlay input", enc_handle_ptr->overlay_input_picture_pool_ptr_array[instance_index]);
+    }
+}
+
+/**********************************
+* eb_enc_handle_fit_memory_budget
+*   used_memory is what the initialization allocated so far, including the
+*   objects the picture pools start with. What is left of the budget
+*   raises the limit of every picture pool from its floor by the same
+*   fraction of the way to its full size.
+**********************************/
+static EbErrorType eb_enc_handle_fit_memory_budget(
+    EbEncHandle *enc_handle_ptr,
+    uint64_t     used_memory)
+{
+    EbSvtAv1EncConfiguration *config_ptr = &enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->static_config;
+    const uint64_t budget = (uint64_t)config_ptr->max_memory_mb << 20;
+    EbPicturePool  pool_array[EB_PICTURE_POOL_MAX_COUNT];
+    const uint32_t poolCount = eb_enc_handle_get_picture_pools(enc_handle_ptr, pool_array);
+    uint64_t       required = used_memory;
+    uint64_t       span = 0;
+    double         fraction = 1.0;
+    uint32_t       limitCount = 0;
+    uint32_t       maxCount = 0;
+    uint32_t       poolIndex;
+    EbErrorType    return_error;
+
+    for (poolIndex = 0; poolIndex < poolCount; ++poolIndex) {
+        EbSystemResource *resource_ptr = pool_array[poolIndex].resource_ptr;
+        const uint32_t    floorCount = MAX(pool_array[poolIndex].min_count, resource_ptr->object_total_count);
+
+        required += (uint64_t)(floorCount - resource_ptr->object_total_count) * resource_ptr->object_size;
+        span += (uint64_t)(resource_ptr->object_max_count - floorCount) * resource_ptr->object_size;
+    }
+    if (budget < required) {
+        SVT_LOG("SVT [WARNING]: max_memory_mb %u is below the %u MB the encoder needs, the picture pools are kept at their minimum\n",
+            config_ptr->max_memory_mb, (uint32_t)((required + (1 << 20) - 1) >> 20));
+        fraction = 0.0;
+    }
+    else if (span > budget - required)
+        fraction = (double)(budget - required) / span;
+
+    for (poolIndex = 0; poolIndex < poolCount; ++poolIndex) {
+        EbSystemResource *resource_ptr = pool_array[poolIndex].resource_ptr;
+        const uint32_t    floorCount = MAX(pool_array[poolIndex].min_count, resource_ptr->object_total_count);
+
+        eb_system_resource_set_limit(resource_ptr,
+            floorCount + (uint32_t)((resource_ptr->object_max_count - floorCount) * fraction));
+        // Without elastic pools the pictures are all constructed now
+        if (!config_ptr->elastic_pools) {
+            return_error = eb_system_resource_reserve(resource_ptr, resource_ptr->object_limit_count);
+            if (return_error != EB_ErrorNone)
+                return return_error;
+        }
+        limitCount += resource_ptr->object_limit_count;
+        maxCount += resource_ptr->object_max_count;
+    }
+    SVT_LOG("SVT [memory]: budget %u MB, picture pools sized to %u of %u pictures\n",
+        config_ptr->max_memory_mb, limitCount, maxCount);
+
+    return EB_ErrorNone;
+}
+
+static EbErrorType eb_enc_handle_start_task_scheduler(EbEncHandle *enc_handle_ptr)
+{
+    SequenceControlSet*  control_set_ptr = enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr;
+    EbTaskChannel       *channel_ptr;
+    EbErrorType          return_error;
+
+    EB_NEW(
+        enc_handle_ptr->task_channel_ptr,
+        eb_task_channel_ctor,
+        control_set_ptr->static_config.channel_id,
+        control_set_ptr->static_config.active_channel_count);
+    channel_ptr = enc_handle_ptr->task_channel_ptr;
+
+#define ADD_STAGE(fifo_array, task, context_array, count) \
+    do { \
+        return_error = eb_task_channel_add_stage(channel_ptr, (fifo_array)[0], task, (void**)(context_array), count); \
+        if (return_error != EB_ErrorNone) \
+            return return_error; \
+    } while (0)
+
+    ADD_STAGE(enc_handle_ptr->resource_coordination_results_consumer_fifo_ptr_array, picture_analysis_task,
+        enc_handle_ptr->picture_analysis_context_ptr_array, control_set_ptr->picture_analysis_process_init_count);
+    ADD_STAGE(enc_handle_ptr->picture_decision_results_consumer_fifo_ptr_array, motion_estimation_task,
+        enc_handle_ptr->motion_estimation_context_ptr_array, control_set_ptr->motion_estimation_process_init_count);
+    ADD_STAGE(enc_handle_ptr->initial_rate_control_results_consumer_fifo_ptr_array, source_based_operations_task,
+        enc_handle_ptr->source_based_operations_context_ptr_array, control_set_ptr->source_based_operations_process_init_count);
+    ADD_STAGE(enc_handle_ptr->rate_control_results_consumer_fifo_ptr_array, mode_decision_configuration_task,
+        enc_handle_ptr->mode_decision_configuration_context_ptr_array, control_set_ptr->mode_decision_configuration_process_init_count);
+    ADD_STAGE(enc_handle_ptr->enc_dec_tasks_consumer_fifo_ptr_array, enc_dec_task,
+        enc_handle_ptr->enc_dec_context_ptr_array, control_set_ptr->enc_dec_process_init_count);
+    ADD_STAGE(enc_handle_ptr->enc_dec_results_consumer_fifo_ptr_array, dlf_task,
+        enc_handle_ptr->dlf_context_ptr_array, control_set_ptr->dlf_process_init_count);
+    ADD_STAGE(enc_handle_ptr->dlf_results_consumer_fifo_ptr_array, cdef_task,
+        enc_handle_ptr->cdef_context_ptr_array, control_set_ptr->cdef_process_init_count);
+    ADD_STAGE(enc_handle_ptr->cdef_results_consumer_fifo_ptr_array, rest_task,
+        enc_handle_ptr->rest_context_ptr_array, control_set_ptr->rest_process_init_count);
+    ADD_STAGE(enc_handle_ptr->rest_results_consumer_fifo_ptr_array, entropy_coding_task,
+        enc_handle_ptr->entropy_coding_context_ptr_array, control_set_ptr->entropy_coding_process_init_count);
+#undef ADD_STAGE
+
+    if (control_set_ptr->static_config.share_task_scheduler) {
+        EbHandle mutex = get_shared_task_scheduler_mutex();
+
+        eb_block_on_mutex(mutex);
+        return_error = EB_ErrorNone;
+        if (shared_task_scheduler_ptr == NULL)
+            return_error = eb_enc_handle_create_task_scheduler(&shared_task_scheduler_ptr, control_set_ptr->task_worker_count);
+        if (return_error == EB_ErrorNone) {
+            ++shared_task_scheduler_ref_count;
+            enc_handle_ptr->task_scheduler_ptr = shared_task_scheduler_ptr;
+        }
+        eb_release_mutex(mutex);
+        if (return_error != EB_ErrorNone)
+            return return_error;
+    }
+    else {
+        return_error = eb_enc_handle_create_task_scheduler(&enc_handle_ptr->task_scheduler_ptr, control_set_ptr->task_worker_count);
+        if (return_error != EB_ErrorNone)
+            return return_error;
+    }
+
+    return_error = eb_task_scheduler_attach_channel(enc_handle_ptr->task_scheduler_ptr, channel_ptr);
+    if (return_error != EB_ErrorNone) {
+        // Nothing to detach in stop_threads
+        EB_DELETE(enc_handle_ptr->task_channel_ptr);
+    }
+    return return_error;
+}
+
+void EbInputBufferHeaderDestoryer(    EbPtr p);
+
 /**********************************
 * Encoder Library Handle Deonstructor
 **********************************/
@@ -633,6 +1065,7 @@ static void eb_enc_handle_dctor(EbPtr p)
     EbEncHandle *enc_handle_ptr = (EbEncHandle *)p;
 
     eb_enc_handle_stop_threads(enc_handle_ptr);
+    EB_DELETE(enc_handle_ptr->trace_ptr);
     EB_FREE_PTR_ARRAY(enc_handle_ptr->app_callback_ptr_array, enc_handle_ptr->encode_instance_total_count);
     EB_DELETE(enc_handle_ptr->sequence_control_set_pool_ptr);
     EB_DELETE_PTR_ARRAY(enc_handle_ptr->picture_parent_control_set_pool_ptr_array, enc_handle_ptr->encode_instance_total_count);
@@ -641,6 +1074,8 @@ static void eb_enc_handle_dctor(EbPtr p)
     EB_DELETE_PTR_ARRAY(enc_handle_ptr->pa_reference_picture_pool_ptr_array, enc_handle_ptr->encode_instance_total_count);
     EB_DELETE_PTR_ARRAY(enc_handle_ptr->overlay_input_picture_pool_ptr_array, enc_handle_ptr->encode_instance_total_count);
     EB_DELETE(enc_handle_ptr->input_buffer_resource_ptr);
+    if (enc_handle_ptr->zero_copy_eos_buffer_ptr)
+        EbInputBufferHeaderDestoryer(enc_handle_ptr->zero_copy_eos_buffer_ptr);
     EB_DELETE_PTR_ARRAY(enc_handle_ptr->output_stream_buffer_resource_ptr_array, enc_handle_ptr->encode_instance_total_count);
     EB_DELETE_PTR_ARRAY(enc_handle_ptr->output_recon_buffer_resource_ptr_array, enc_handle_ptr->encode_instance_total_count);
     EB_DELETE(enc_handle_ptr->resource_coordination_results_resource_ptr);
@@ -724,6 +1159,10 @@ EbErrorType EbInputBufferHeaderCreator(
     EbPtr *objectDblPtr,
     EbPtr  objectInitDataPtr);
 
+EbErrorType EbZeroCopyInputBufferHeaderCreator(
+    EbPtr *objectDblPtr,
+    EbPtr  objectInitDataPtr);
+
 EbErrorType EbOutputReconBufferHeaderCreator(
     EbPtr *objectDblPtr,
     EbPtr  objectInitDataPtr);
@@ -736,6 +1175,49 @@ void EbInputBufferHeaderDestoryer(    EbPtr p);
 void EbOutputReconBufferHeaderDestoryer(    EbPtr p);
 void EbOutputBufferHeaderDestoryer(    EbPtr p);
 
+/**************************************
+* zero_copy_input release callbacks
+*   The input goes back to the application when its last holder, the
+*   Rate Control or the PA reference sharing its luma, releases it.
+**************************************/
+static void PaReferenceZeroCopyRelease(
+    EbPtr            context_ptr,
+    EbObjectWrapper *wrapper_ptr)
+{
+    EbPaReferenceObject *pa_reference_object = (EbPaReferenceObject*)wrapper_ptr->object_ptr;
+    EbObjectWrapper     *input_picture_wrapper_ptr = pa_reference_object->input_picture_wrapper_ptr;
+    (void)context_ptr;
+
+    if (input_picture_wrapper_ptr) {
+        pa_reference_object->input_picture_wrapper_ptr = NULL;
+        eb_release_object(input_picture_wrapper_ptr);
+    }
+}
+
+static void InputZeroCopyRelease(
+    EbPtr            context_ptr,
+    EbObjectWrapper *wrapper_ptr)
+{
+    EbEncHandle         *enc_handle_ptr = (EbEncHandle*)context_ptr;
+    EbBufferHeaderType  *input_ptr = (EbBufferHeaderType*)wrapper_ptr->object_ptr;
+    EbPictureBufferDesc *input_picture_ptr = (EbPictureBufferDesc*)input_ptr->p_buffer;
+    EbPictureBufferDesc *eos_picture_ptr = (EbPictureBufferDesc*)enc_handle_ptr->zero_copy_eos_buffer_ptr->p_buffer;
+    EbBufferHeaderType   releasedBuffer;
+
+    // Nothing to give back for an end of sequence sent without a picture
+    if (input_picture_ptr->buffer_y == NULL || input_picture_ptr->buffer_y == eos_picture_ptr->buffer_y)
+        return;
+    input_picture_ptr->buffer_y = NULL;
+    input_picture_ptr->buffer_cb = NULL;
+    input_picture_ptr->buffer_cr = NULL;
+
+    if (enc_handle_ptr->input_release_callback) {
+        releasedBuffer = *input_ptr;
+        releasedBuffer.p_buffer = NULL;
+        enc_handle_ptr->input_release_callback(enc_handle_ptr->input_release_context, &releasedBuffer);
+    }
+}
+
 
 EbErrorType DlfResultsCtor(
     DlfResults *context_ptr,
@@ -811,16 +1293,12 @@ void init_fn_ptr(void);
 extern void av1_init_wedge_masks(void);
 #endif
 /**********************************
-* Initialize Encoder Library
+* Initialize Encoder Handle
+*   Selects the NUMA node and the arena pool mode of the calling thread for
+*   the allocations, eb_init_encoder restores them.
 **********************************/
-#if defined(__linux__) || defined(__APPLE__)
-__attribute__((visibility("default")))
-#endif
-EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
+static EbErrorType eb_enc_handle_init(EbEncHandle *enc_handle_ptr)
 {
-    if(svt_enc_component == NULL)
-        return EB_ErrorBadParameter;
-    EbEncHandle *enc_handle_ptr = (EbEncHandle*)svt_enc_component->p_component_private;
     EbErrorType return_error = EB_ErrorNone;
     uint32_t instance_index;
     uint32_t processIndex;
@@ -828,6 +1306,7 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
     EbBool is16bit = (EbBool)(enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->static_config.encoder_bit_depth > EB_8BIT);
     EbColorFormat color_format = enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->static_config.encoder_color_format;
     SequenceControlSet* control_set_ptr;
+    const uint64_t init_memory_size = eb_get_thread_memory();
 
     /************************************
     * Plateform detection
@@ -854,6 +1333,22 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
 #if COMP_MODE
     av1_init_wedge_masks();
 #endif
+    /************************************
+    * NUMA Placement
+    ************************************/
+    EbSvtAv1EncConfiguration   *config_ptr = &enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->static_config;
+
+    EbSetThreadManagementParameters(config_ptr);
+
+    if (config_ptr->numa_mode == NUMA_MODE_LOCAL) {
+        // Everything allocated from here on, including by the encoder
+        // threads which inherit the policy, goes to the node of the threads
+        const int32_t numa_node = GetThreadNumaNode();
+        if (numa_node == EB_NUMA_NODE_ANY)
+            SVT_LOG("SVT [WARNING]: NUMA mode 1 needs the threads pinned to one node (-ss / -lp), memory placement left to the OS\n");
+        eb_numa_set_node(numa_node);
+    }
+
     /************************************
     * Sequence Control Set
     ************************************/
@@ -869,6 +1364,9 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
         &scs_init,
         NULL);
 
+    // Each picture pool carves its planes from an arena of its own
+    eb_arena_set_pool_mode(config_ptr->picture_arena);
+
     /************************************
     * Picture Control Set: Parent
     ************************************/
@@ -905,7 +1403,11 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
         inputData.nsq_present = enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->nsq_present;
         EB_NEW(
             enc_handle_ptr->picture_parent_control_set_pool_ptr_array[instance_index],
-            eb_system_resource_ctor,
+            eb_system_resource_elastic_ctor,
+            get_picture_pool_init_count(
+                enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr,
+                enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->picture_control_set_pool_min_count,
+                enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->picture_control_set_pool_init_count),
             enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->picture_control_set_pool_init_count,//enc_handle_ptr->picture_control_set_pool_total_count,
             1,
             0,
@@ -914,6 +1416,7 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
             EB_FALSE,
             picture_parent_control_set_creator,
             &inputData,
+            sizeof(inputData),
             NULL);
     }
 
@@ -954,6 +1457,8 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
         inputData.max_depth = enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->max_sb_depth;
         inputData.hbd_mode_decision = enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->static_config.enable_hbd_mode_decision;
         inputData.cdf_mode = enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->cdf_mode;
+        inputData.tile_rows = (uint8_t)enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->static_config.tile_rows;
+        inputData.tile_columns = (uint8_t)enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->static_config.tile_columns;
 #if MFMV_SUPPORT
         inputData.mfmv = enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->mfmv_enabled;
 #endif
@@ -1024,7 +1529,11 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
         // Reference Picture Buffers
         EB_NEW(
             enc_handle_ptr->reference_picture_pool_ptr_array[instance_index],
-            eb_system_resource_ctor,
+            eb_system_resource_elastic_ctor,
+            get_picture_pool_init_count(
+                enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr,
+                enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->reference_picture_buffer_min_count,
+                enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->reference_picture_buffer_init_count),
             enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->reference_picture_buffer_init_count,//enc_handle_ptr->reference_picture_pool_total_count,
             EB_PictureManagerProcessInitCount,
             0,
@@ -1033,6 +1542,7 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
             EB_FALSE,
             eb_reference_object_creator,
             &(EbReferenceObjectDescInitDataStructure),
+            sizeof(EbReferenceObjectDescInitDataStructure),
             NULL);
 
         // PA Reference Picture Buffers
@@ -1076,7 +1586,11 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
         EbPaReferenceObjectDescInitDataStructure.sixteenth_picture_desc_init_data = sixteenthPictureBufferDescInitData;
         // Reference Picture Buffers
         EB_NEW(enc_handle_ptr->pa_reference_picture_pool_ptr_array[instance_index],
-            eb_system_resource_ctor,
+            eb_system_resource_elastic_ctor,
+            get_picture_pool_init_count(
+                enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr,
+                enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->pa_reference_picture_buffer_min_count,
+                enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->pa_reference_picture_buffer_init_count),
             enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->pa_reference_picture_buffer_init_count,
             EB_PictureDecisionProcessInitCount,
             0,
@@ -1085,7 +1599,13 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
             EB_FALSE,
             eb_pa_reference_object_creator,
             &(EbPaReferenceObjectDescInitDataStructure),
+            sizeof(EbPaReferenceObjectDescInitDataStructure),
             NULL);
+        if (enc_handle_ptr->sequence_control_set_instance_array[instance_index]->sequence_control_set_ptr->static_config.zero_copy_input)
+            eb_system_resource_set_release_callback(
+                enc_handle_ptr->pa_reference_picture_pool_ptr_array[instance_index],
+                PaReferenceZeroCopyRelease,
+                NULL);
         // Set the SequenceControlSet Picture Pool Fifo Ptrs
         enc_handle_ptr->sequence_control_set_instance_array[instance_index]->encode_context_ptr->reference_picture_pool_fifo_ptr = (enc_handle_ptr->reference_picture_pool_producer_fifo_ptr_dbl_array[instance_index])[0];
         enc_handle_ptr->sequence_control_set_instance_array[instance_index]->encode_context_ptr->pa_reference_picture_pool_fifo_ptr = (enc_handle_ptr->pa_reference_picture_pool_producer_fifo_ptr_dbl_array[instance_index])[0];
@@ -1116,16 +1636,36 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
     // EbBufferHeaderType Input
     EB_NEW(
         enc_handle_ptr->input_buffer_resource_ptr,
-        eb_system_resource_ctor,
+        eb_system_resource_elastic_ctor,
+        get_picture_pool_init_count(
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr,
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->input_buffer_fifo_min_count,
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->input_buffer_fifo_init_count),
         enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->input_buffer_fifo_init_count,
         1,
         EB_ResourceCoordinationProcessInitCount,
         &enc_handle_ptr->input_buffer_producer_fifo_ptr_array,
         &enc_handle_ptr->input_buffer_consumer_fifo_ptr_array,
         EB_TRUE,
-        EbInputBufferHeaderCreator,
+        enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->static_config.zero_copy_input ?
+            EbZeroCopyInputBufferHeaderCreator : EbInputBufferHeaderCreator,
         enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr,
+        0,
         EbInputBufferHeaderDestoryer);
+    eb_arena_set_pool_mode(EB_ARENA_OFF);
+    if (enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->static_config.zero_copy_input) {
+        EbPtr eosBufferPtr;
+        return_error = EbInputBufferHeaderCreator(
+            &eosBufferPtr,
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr);
+        enc_handle_ptr->zero_copy_eos_buffer_ptr = (EbBufferHeaderType*)eosBufferPtr;
+        if (return_error != EB_ErrorNone)
+            return return_error;
+        eb_system_resource_set_release_callback(
+            enc_handle_ptr->input_buffer_resource_ptr,
+            InputZeroCopyRelease,
+            enc_handle_ptr);
+    }
 
     // EbBufferHeaderType Output Stream
     EB_ALLOC_PTR_ARRAY(enc_handle_ptr->output_stream_buffer_resource_ptr_array, enc_handle_ptr->encode_instance_total_count);
@@ -1360,8 +1900,12 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
         EB_NEW(
             enc_handle_ptr->enc_dec_results_resource_ptr,
             eb_system_resource_ctor,
-            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->enc_dec_fifo_init_count,
-            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->enc_dec_process_init_count,
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->enc_dec_fifo_init_count +
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->dlf_process_init_count *
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->dlf_process_init_count,
+            // DLF threads post help tasks to the other DLF threads
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->enc_dec_process_init_count +
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->dlf_process_init_count,
             enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->dlf_process_init_count,
             &enc_handle_ptr->enc_dec_results_producer_fifo_ptr_array,
             &enc_handle_ptr->enc_dec_results_consumer_fifo_ptr_array,
@@ -1378,8 +1922,12 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
         EB_NEW(
             enc_handle_ptr->dlf_results_resource_ptr,
             eb_system_resource_ctor,
-            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->dlf_fifo_init_count,
-            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->dlf_process_init_count,
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->dlf_fifo_init_count +
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->cdef_process_init_count *
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->cdef_process_init_count,
+            // CDEF threads post help tasks to the other CDEF threads
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->dlf_process_init_count +
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->cdef_process_init_count,
             enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->cdef_process_init_count,
             &enc_handle_ptr->dlf_results_producer_fifo_ptr_array,
             &enc_handle_ptr->dlf_results_consumer_fifo_ptr_array,
@@ -1395,8 +1943,12 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
         EB_NEW(
             enc_handle_ptr->cdef_results_resource_ptr,
             eb_system_resource_ctor,
-            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->cdef_fifo_init_count,
-            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->cdef_process_init_count,
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->cdef_fifo_init_count +
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->rest_process_init_count *
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->rest_process_init_count,
+            // Rest threads post help tasks to the other Rest threads
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->cdef_process_init_count +
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->rest_process_init_count,
             enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->rest_process_init_count,
             &enc_handle_ptr->cdef_results_producer_fifo_ptr_array,
             &enc_handle_ptr->cdef_results_consumer_fifo_ptr_array,
@@ -1444,8 +1996,12 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
     /************************************
     * App Callbacks
     ************************************/
-    for (instance_index = 0; instance_index < enc_handle_ptr->encode_instance_total_count; ++instance_index)
-        enc_handle_ptr->sequence_control_set_instance_array[instance_index]->encode_context_ptr->app_callback_ptr = enc_handle_ptr->app_callback_ptr_array[instance_index];
+    for (instance_index = 0; instance_index < enc_handle_ptr->encode_instance_total_count; ++instance_index) {
+        EncodeContext *encode_context_ptr = enc_handle_ptr->sequence_control_set_instance_array[instance_index]->encode_context_ptr;
+        encode_context_ptr->app_callback_ptr = enc_handle_ptr->app_callback_ptr_array[instance_index];
+        encode_context_ptr->packet_callback = enc_handle_ptr->packet_callback;
+        encode_context_ptr->packet_context = enc_handle_ptr->packet_context;
+    }
     // svt Output Buffer Fifo Ptrs
     for (instance_index = 0; instance_index < enc_handle_ptr->encode_instance_total_count; ++instance_index) {
         enc_handle_ptr->sequence_control_set_instance_array[instance_index]->encode_context_ptr->stream_output_fifo_ptr     = (enc_handle_ptr->output_stream_buffer_producer_fifo_ptr_dbl_array[instance_index])[0];
@@ -1606,6 +2162,7 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
             enc_handle_ptr->dlf_context_ptr_array[processIndex],
             dlf_context_ctor,
             enc_handle_ptr->enc_dec_results_consumer_fifo_ptr_array[processIndex],
+            enc_handle_ptr->enc_dec_results_producer_fifo_ptr_array[enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->enc_dec_process_init_count + processIndex],
             enc_handle_ptr->dlf_results_producer_fifo_ptr_array[processIndex],             //output to EC
             is16bit,
             color_format,
@@ -1622,6 +2179,7 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
             enc_handle_ptr->cdef_context_ptr_array[processIndex],
             cdef_context_ctor,
             enc_handle_ptr->dlf_results_consumer_fifo_ptr_array[processIndex],
+            enc_handle_ptr->dlf_results_producer_fifo_ptr_array[enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->dlf_process_init_count + processIndex],
             enc_handle_ptr->cdef_results_producer_fifo_ptr_array[processIndex],
             is16bit,
             enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->max_input_luma_width,
@@ -1636,6 +2194,7 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
             enc_handle_ptr->rest_context_ptr_array[processIndex],
             rest_context_ctor,
             enc_handle_ptr->cdef_results_consumer_fifo_ptr_array[processIndex],
+            enc_handle_ptr->cdef_results_producer_fifo_ptr_array[enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->cdef_process_init_count + processIndex],
             enc_handle_ptr->rest_results_producer_fifo_ptr_array[processIndex],
             enc_handle_ptr->picture_demux_results_producer_fifo_ptr_array[
                 /*enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->source_based_operations_process_init_count*/ 1+ processIndex],
@@ -1681,71 +2240,107 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
     /************************************
     * Thread Handles
     ************************************/
-    EbSvtAv1EncConfiguration   *config_ptr = &enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->static_config;
+    control_set_ptr = enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr;
+    if (config_ptr->max_memory_mb) {
+        return_error = eb_enc_handle_fit_memory_budget(enc_handle_ptr, eb_get_thread_memory() - init_memory_size);
+        if (return_error != EB_ErrorNone)
+            return return_error;
+    }
+    enc_handle_ptr->stats_start_time = EbGetTimeUs();
+    if (config_ptr->enable_pipeline_stats) {
+        EbPipelineStage stage_array[EB_PIPELINE_STAGE_MAX_COUNT];
+        uint32_t        stageCount;
+        uint32_t        stageIndex;
+
+        stageCount = eb_enc_handle_get_pipeline_stages(enc_handle_ptr, stage_array);
+        for (stageIndex = 0; stageIndex < stageCount; ++stageIndex)
+            stage_array[stageIndex].queue_ptr->stats_enabled = EB_TRUE;
+    }
 
-    EbSetThreadManagementParameters(config_ptr);
+    // Trace, spans are recorded by the consumers of the stage input queues
+    if (config_ptr->trace_file_name) {
+        EbPipelineStage stage_array[EB_PIPELINE_STAGE_MAX_COUNT];
+        uint32_t        stageCount;
+        uint32_t        stageIndex;
 
-    control_set_ptr = enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr;
+        EB_NEW(
+            enc_handle_ptr->trace_ptr,
+            eb_trace_ctor,
+            config_ptr->trace_file_name);
+        stageCount = eb_enc_handle_get_pipeline_stages(enc_handle_ptr, stage_array);
+        for (stageIndex = 0; stageIndex < stageCount; ++stageIndex) {
+            stage_array[stageIndex].queue_ptr->trace_ptr = enc_handle_ptr->trace_ptr;
+            stage_array[stageIndex].queue_ptr->trace_name = stage_array[stageIndex].name;
+        }
+    }
+
+    if (config_ptr->enable_task_scheduler) {
+        return_error = eb_enc_handle_start_task_scheduler(enc_handle_ptr);
+        if (return_error != EB_ErrorNone)
+            return return_error;
+    }
+    else {
+        // Picture Analysis
+        EB_CREATE_THREAD_ARRAY(enc_handle_ptr->picture_analysis_thread_handle_array, control_set_ptr->picture_analysis_process_init_count,
+            picture_analysis_kernel,
+            enc_handle_ptr->picture_analysis_context_ptr_array);
+
+        // Motion Estimation
+        EB_CREATE_THREAD_ARRAY(enc_handle_ptr->motion_estimation_thread_handle_array, control_set_ptr->motion_estimation_process_init_count,
+            motion_estimation_kernel,
+            enc_handle_ptr->motion_estimation_context_ptr_array);
+
+        // Source Based Oprations
+        EB_CREATE_THREAD_ARRAY(enc_handle_ptr->source_based_operations_thread_handle_array, control_set_ptr->source_based_operations_process_init_count,
+            source_based_operations_kernel,
+            enc_handle_ptr->source_based_operations_context_ptr_array);
+
+        // Mode Decision Configuration Process
+        EB_CREATE_THREAD_ARRAY(enc_handle_ptr->mode_decision_configuration_thread_handle_array, control_set_ptr->mode_decision_configuration_process_init_count,
+            mode_decision_configuration_kernel,
+            enc_handle_ptr->mode_decision_configuration_context_ptr_array);
+
+        // EncDec Process
+        EB_CREATE_THREAD_ARRAY(enc_handle_ptr->enc_dec_thread_handle_array, control_set_ptr->enc_dec_process_init_count,
+            enc_dec_kernel,
+            enc_handle_ptr->enc_dec_context_ptr_array);
+
+        // Dlf Process
+        EB_CREATE_THREAD_ARRAY(enc_handle_ptr->dlf_thread_handle_array, control_set_ptr->dlf_process_init_count,
+            dlf_kernel,
+            enc_handle_ptr->dlf_context_ptr_array);
+
+        // Cdef Process
+        EB_CREATE_THREAD_ARRAY(enc_handle_ptr->cdef_thread_handle_array, control_set_ptr->cdef_process_init_count,
+            cdef_kernel,
+            enc_handle_ptr->cdef_context_ptr_array);
+
+        // Rest Process
+        EB_CREATE_THREAD_ARRAY(enc_handle_ptr->rest_thread_handle_array, control_set_ptr->rest_process_init_count,
+            rest_kernel,
+            enc_handle_ptr->rest_context_ptr_array);
+
+        // Entropy Coding Process
+        EB_CREATE_THREAD_ARRAY(enc_handle_ptr->entropy_coding_thread_handle_array, control_set_ptr->entropy_coding_process_init_count,
+            entropy_coding_kernel,
+            enc_handle_ptr->entropy_coding_context_ptr_array);
+    }
 
     // Resource Coordination
     EB_CREATE_THREAD(enc_handle_ptr->resource_coordination_thread_handle, resource_coordination_kernel, enc_handle_ptr->resource_coordination_context_ptr);
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->picture_analysis_thread_handle_array,control_set_ptr->picture_analysis_process_init_count,
-        picture_analysis_kernel,
-        enc_handle_ptr->picture_analysis_context_ptr_array);
 
     // Picture Decision
     EB_CREATE_THREAD(enc_handle_ptr->picture_decision_thread_handle, picture_decision_kernel, enc_handle_ptr->picture_decision_context_ptr);
 
-    // Motion Estimation
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->motion_estimation_thread_handle_array, control_set_ptr->motion_estimation_process_init_count,
-        motion_estimation_kernel,
-        enc_handle_ptr->motion_estimation_context_ptr_array);
-
     // Initial Rate Control
     EB_CREATE_THREAD(enc_handle_ptr->initial_rate_control_thread_handle, initial_rate_control_kernel, enc_handle_ptr->initial_rate_control_context_ptr);
 
-    // Source Based Oprations
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->source_based_operations_thread_handle_array, control_set_ptr->source_based_operations_process_init_count,
-        source_based_operations_kernel,
-        enc_handle_ptr->source_based_operations_context_ptr_array);
-
     // Picture Manager
     EB_CREATE_THREAD(enc_handle_ptr->picture_manager_thread_handle, picture_manager_kernel, enc_handle_ptr->picture_manager_context_ptr);
 
     // Rate Control
     EB_CREATE_THREAD(enc_handle_ptr->rate_control_thread_handle, rate_control_kernel, enc_handle_ptr->rate_control_context_ptr);
 
-    // Mode Decision Configuration Process
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->mode_decision_configuration_thread_handle_array, control_set_ptr->mode_decision_configuration_process_init_count,
-        mode_decision_configuration_kernel,
-        enc_handle_ptr->mode_decision_configuration_context_ptr_array);
-
-
-    // EncDec Process
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->enc_dec_thread_handle_array, control_set_ptr->enc_dec_process_init_count,
-        enc_dec_kernel,
-        enc_handle_ptr->enc_dec_context_ptr_array);
-
-    // Dlf Process
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->dlf_thread_handle_array, control_set_ptr->dlf_process_init_count,
-        dlf_kernel,
-        enc_handle_ptr->dlf_context_ptr_array);
-
-    // Cdef Process
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->cdef_thread_handle_array, control_set_ptr->cdef_process_init_count,
-        cdef_kernel,
-        enc_handle_ptr->cdef_context_ptr_array);
-
-    // Rest Process
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->rest_thread_handle_array, control_set_ptr->rest_process_init_count,
-        rest_kernel,
-        enc_handle_ptr->rest_context_ptr_array);
-
-    // Entropy Coding Process
-    EB_CREATE_THREAD_ARRAY(enc_handle_ptr->entropy_coding_thread_handle_array, control_set_ptr->entropy_coding_process_init_count,
-        entropy_coding_kernel,
-        enc_handle_ptr->entropy_coding_context_ptr_array);
-
     // Packetization
     EB_CREATE_THREAD(enc_handle_ptr->packetization_thread_handle, packetization_kernel, enc_handle_ptr->packetization_context_ptr);
 
@@ -1754,6 +2349,33 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
 #endif
     eb_print_memory_usage();
 
+    if (config_ptr->numa_mode != NUMA_MODE_OFF)
+        PrintNumaMemoryUsage();
+    if (config_ptr->picture_arena != EB_ARENA_OFF)
+        PrintArenaMemoryUsage(enc_handle_ptr);
+
+    return return_error;
+}
+
+/**********************************
+* Initialize Encoder Library
+**********************************/
+#if defined(__linux__) || defined(__APPLE__)
+__attribute__((visibility("default")))
+#endif
+EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
+{
+    if(svt_enc_component == NULL)
+        return EB_ErrorBadParameter;
+    EbEncHandle *enc_handle_ptr = (EbEncHandle*)svt_enc_component->p_component_private;
+    const int32_t numa_node = eb_numa_get_node();
+    const uint32_t arena_pool_mode = eb_arena_get_pool_mode();
+
+    // The init thread state is restored on the error exits too
+    const EbErrorType return_error = eb_enc_handle_init(enc_handle_ptr);
+    eb_numa_set_node(numa_node);
+    eb_arena_set_pool_mode(arena_pool_mode);
+
     return return_error;
 }
 
@@ -1764,8 +2386,19 @@ EB_API EbErrorType eb_init_encoder(EbComponentType *svt_enc_component)
 __attribute__((visibility("default")))
 #endif
 EB_API EbErrorType eb_deinit_encoder(EbComponentType *svt_enc_component){
+    EbEncHandle *enc_handle_ptr;
     if(svt_enc_component == NULL)
         return EB_ErrorBadParameter;
+    enc_handle_ptr = (EbEncHandle*)svt_enc_component->p_component_private;
+    // The input pool is the last picture pool constructed
+    if (enc_handle_ptr && enc_handle_ptr->input_buffer_resource_ptr &&
+        enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->static_config.picture_arena != EB_ARENA_OFF)
+        PrintArenaMemoryUsage(enc_handle_ptr);
+    if (enc_handle_ptr && enc_handle_ptr->trace_ptr) {
+        return eb_trace_write(
+            enc_handle_ptr->trace_ptr,
+            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr->static_config.channel_id);
+    }
     return EB_ErrorNone;
 }
 
@@ -2197,8 +2830,18 @@ void CopyApiFromApp(
     sequence_control_set_ptr->static_config.active_channel_count = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->active_channel_count;
     sequence_control_set_ptr->static_config.logical_processors = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->logical_processors;
     sequence_control_set_ptr->static_config.target_socket = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->target_socket;
+    sequence_control_set_ptr->static_config.numa_mode = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->numa_mode;
+    sequence_control_set_ptr->static_config.share_task_scheduler = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->share_task_scheduler;
+    sequence_control_set_ptr->static_config.enable_task_scheduler = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->enable_task_scheduler ||
+        sequence_control_set_ptr->static_config.share_task_scheduler;
+    sequence_control_set_ptr->static_config.elastic_pools = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->elastic_pools;
+    sequence_control_set_ptr->static_config.max_memory_mb = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->max_memory_mb;
+    sequence_control_set_ptr->static_config.picture_arena = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->picture_arena;
+    sequence_control_set_ptr->static_config.zero_copy_input = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->zero_copy_input;
     sequence_control_set_ptr->qp = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->qp;
     sequence_control_set_ptr->static_config.recon_enabled = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->recon_enabled;
+    sequence_control_set_ptr->static_config.trace_file_name = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->trace_file_name;
+    sequence_control_set_ptr->static_config.enable_pipeline_stats = ((EbSvtAv1EncConfiguration*)pComponentParameterStructure)->enable_pipeline_stats;
 
     // Extract frame rate from Numerator and Denominator if not 0
     if (sequence_control_set_ptr->static_config.frame_rate_numerator != 0 && sequence_control_set_ptr->static_config.frame_rate_denominator != 0)
@@ -2560,6 +3203,41 @@ static EbErrorType VerifySettings(
         return_error = EB_ErrorBadParameter;
     }
 
+    if (config->numa_mode > NUMA_MODE_LOCAL) {
+        SVT_LOG("Error instance %u: Invalid numa_mode [0 - 1] \n", channelNumber + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->enable_task_scheduler != 0 && config->enable_task_scheduler != 1) {
+        SVT_LOG("Error instance %u: Invalid enable_task_scheduler flag [0 - 1] \n", channelNumber + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->share_task_scheduler != 0 && config->share_task_scheduler != 1) {
+        SVT_LOG("Error instance %u: Invalid share_task_scheduler flag [0 - 1] \n", channelNumber + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->elastic_pools != 0 && config->elastic_pools != 1) {
+        SVT_LOG("Error instance %u: Invalid elastic_pools flag [0 - 1] \n", channelNumber + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->picture_arena > EB_ARENA_HUGETLB) {
+        SVT_LOG("Error instance %u: Invalid picture_arena [0 - 2] \n", channelNumber + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->zero_copy_input != 0 && config->zero_copy_input != 1) {
+        SVT_LOG("Error instance %u: Invalid zero_copy_input flag [0 - 1] \n", channelNumber + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
+    if (config->zero_copy_input && (config->encoder_bit_depth != EB_8BIT || config->encoder_color_format != EB_YUV420)) {
+        SVT_LOG("Error instance %u: zero_copy_input is only supported for 8 bit 4:2:0 input \n", channelNumber + 1);
+        return_error = EB_ErrorBadParameter;
+    }
+
     // alt-ref frames related
     if (config->altref_strength > ALTREF_MAX_STRENGTH ) {
         SVT_LOG("Error instance %u: invalid altref-strength, should be in the range [0 - %d] \n", channelNumber + 1, ALTREF_MAX_STRENGTH);
@@ -2673,11 +3351,20 @@ EbErrorType eb_svt_enc_init_parameter(
     // Channel info
     config_ptr->logical_processors = 0;
     config_ptr->target_socket = -1;
+    config_ptr->numa_mode = NUMA_MODE_OFF;
+    config_ptr->enable_task_scheduler = EB_FALSE;
+    config_ptr->share_task_scheduler = EB_FALSE;
+    config_ptr->elastic_pools = EB_FALSE;
+    config_ptr->max_memory_mb = 0;
+    config_ptr->picture_arena = EB_ARENA_OFF;
+    config_ptr->zero_copy_input = EB_FALSE;
     config_ptr->channel_id = 0;
     config_ptr->active_channel_count = 1;
 
     // Debug info
     config_ptr->recon_enabled = 0;
+    config_ptr->trace_file_name = NULL;
+    config_ptr->enable_pipeline_stats = EB_FALSE;
 
     // Alt-Ref default values
     config_ptr->enable_altrefs = EB_TRUE;
@@ -2734,6 +3421,16 @@ static void print_lib_params(
         SVT_LOG("\nSVT [config]: RCMode / TargetBitrate / LookaheadDistance / SceneChange\t\t: Constraint VBR / %d / %d / %d ", config->target_bit_rate, config->look_ahead_distance, config->scene_change_detection);
     else
         SVT_LOG("\nSVT [config]: BRC Mode / QP  / LookaheadDistance / SceneChange\t\t\t: CQP / %d / %d / %d ", scs->qp, config->look_ahead_distance, config->scene_change_detection);
+    if (config->share_task_scheduler)
+        SVT_LOG("\nSVT [config]: Shared Task Scheduler Channel / Channels \t\t\t\t: %d / %d ", config->channel_id, config->active_channel_count);
+    else if (config->enable_task_scheduler)
+        SVT_LOG("\nSVT [config]: Task Scheduler Workers \t\t\t\t\t\t: %d ", scs->task_worker_count);
+    if (config->elastic_pools || config->max_memory_mb)
+        SVT_LOG("\nSVT [config]: Elastic Pools / Memory Budget (MB) \t\t\t\t\t: %d / %d ", config->elastic_pools, config->max_memory_mb);
+    if (config->picture_arena)
+        SVT_LOG("\nSVT [config]: Picture Arena \t\t\t\t\t\t\t: %d ", config->picture_arena);
+    if (config->zero_copy_input)
+        SVT_LOG("\nSVT [config]: Zero Copy Input \t\t\t\t\t\t\t: %d ", config->zero_copy_input);
 #ifdef DEBUG_BUFFERS
     SVT_LOG("\nSVT [config]: INPUT / OUTPUT \t\t\t\t\t\t\t: %d / %d", scs->input_buffer_fifo_init_count, scs->output_stream_buffer_fifo_init_count);
     SVT_LOG("\nSVT [config]: CPCS / PAREF / REF \t\t\t\t\t\t: %d / %d / %d", scs->picture_control_set_pool_init_count_child, scs->pa_reference_picture_buffer_init_count, scs->reference_picture_buffer_init_count);
@@ -3077,6 +3774,46 @@ static EbErrorType CopyFrameBuffer(
     }
     return return_error;
 }
+/***********************************************
+**** Reference the planes of the sample
+**** application, zero_copy_input
+************************************************/
+static void ReferenceInputBuffer(
+    SequenceControlSet*     sequence_control_set_ptr,
+    EbBufferHeaderType*     dst,
+    EbBufferHeaderType*     src,
+    EbBufferHeaderType*     eos_buffer)
+{
+    EbPictureBufferDesc *input_picture_ptr = (EbPictureBufferDesc*)dst->p_buffer;
+
+    dst->n_alloc_len = src->n_alloc_len;
+    dst->n_filled_len = src->n_filled_len;
+    dst->flags = src->flags;
+    dst->pts = src->pts;
+    dst->n_tick_count = src->n_tick_count;
+    dst->size = src->size;
+    dst->qp = src->qp;
+    dst->pic_type = src->pic_type;
+    dst->p_app_private = src->p_app_private;
+
+    if (src->p_buffer != NULL) {
+        EbSvtIOFormat *inputPtr = (EbSvtIOFormat*)src->p_buffer;
+        uint32_t       lumaBufferOffset = input_picture_ptr->stride_y*sequence_control_set_ptr->top_padding + sequence_control_set_ptr->left_padding;
+        uint32_t       chromaBufferOffset = input_picture_ptr->stride_cr*(sequence_control_set_ptr->top_padding >> 1) + (sequence_control_set_ptr->left_padding >> 1);
+
+        input_picture_ptr->buffer_y = inputPtr->luma - lumaBufferOffset;
+        input_picture_ptr->buffer_cb = inputPtr->cb - chromaBufferOffset;
+        input_picture_ptr->buffer_cr = inputPtr->cr - chromaBufferOffset;
+    }
+    else {
+        EbPictureBufferDesc *eos_picture_ptr = (EbPictureBufferDesc*)eos_buffer->p_buffer;
+
+        input_picture_ptr->buffer_y = eos_picture_ptr->buffer_y;
+        input_picture_ptr->buffer_cb = eos_picture_ptr->buffer_cb;
+        input_picture_ptr->buffer_cr = eos_picture_ptr->buffer_cr;
+    }
+}
+
 static void CopyInputBuffer(
     SequenceControlSet*    sequenceControlSet,
     EbBufferHeaderType*     dst,
@@ -3109,18 +3846,35 @@ EB_API EbErrorType eb_svt_enc_send_picture(
     EbBufferHeaderType   *p_buffer)
 {
     EbEncHandle          *enc_handle_ptr = (EbEncHandle*)svt_enc_component->p_component_private;
+    SequenceControlSet   *sequence_control_set_ptr = enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr;
     EbObjectWrapper      *ebWrapperPtr;
 
+    // Referenced planes must have the strides of the library pictures
+    if (sequence_control_set_ptr->static_config.zero_copy_input && p_buffer != NULL && p_buffer->p_buffer != NULL) {
+        EbSvtIOFormat *inputPtr = (EbSvtIOFormat*)p_buffer->p_buffer;
+        const uint32_t lumaStride = sequence_control_set_ptr->max_input_luma_width + sequence_control_set_ptr->left_padding + sequence_control_set_ptr->right_padding;
+
+        if (inputPtr->y_stride != lumaStride || inputPtr->cb_stride != (lumaStride >> 1) || inputPtr->cr_stride != (lumaStride >> 1))
+            return EB_ErrorBadParameter;
+    }
+
     // Take the buffer and put it into our internal queue structure
     eb_get_empty_object(
         enc_handle_ptr->input_buffer_producer_fifo_ptr_array[0],
         &ebWrapperPtr);
 
     if (p_buffer != NULL) {
-        CopyInputBuffer(
-            enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr,
-            (EbBufferHeaderType*)ebWrapperPtr->object_ptr,
-            p_buffer);
+        if (sequence_control_set_ptr->static_config.zero_copy_input)
+            ReferenceInputBuffer(
+                sequence_control_set_ptr,
+                (EbBufferHeaderType*)ebWrapperPtr->object_ptr,
+                p_buffer,
+                enc_handle_ptr->zero_copy_eos_buffer_ptr);
+        else
+            CopyInputBuffer(
+                sequence_control_set_ptr,
+                (EbBufferHeaderType*)ebWrapperPtr->object_ptr,
+                p_buffer);
     }
 
     eb_post_full_object(ebWrapperPtr);
@@ -3163,6 +3917,9 @@ EB_API EbErrorType eb_svt_get_packet(
     EbEncHandle          *pEncCompData = (EbEncHandle*)svt_enc_component->p_component_private;
     EbObjectWrapper      *ebWrapperPtr = NULL;
     EbBufferHeaderType    *packet;
+    // The packets go to the packet callback, none is ever queued
+    if (pEncCompData->packet_callback)
+        return EB_NoErrorEmptyQueue;
     if (pic_send_done)
         eb_get_full_object(
         (pEncCompData->output_stream_buffer_consumer_fifo_ptr_dbl_array[0])[0],
@@ -3187,6 +3944,40 @@ EB_API EbErrorType eb_svt_get_packet(
     return return_error;
 }
 
+/**********************************
+* eb_svt_get_packet_timeout waits up to timeout_ms for a packet
+**********************************/
+#if defined(__linux__) || defined(__APPLE__)
+__attribute__((visibility("default")))
+#endif
+EB_API EbErrorType eb_svt_get_packet_timeout(
+    EbComponentType      *svt_enc_component,
+    EbBufferHeaderType  **p_buffer,
+    uint32_t               timeout_ms)
+{
+    EbErrorType             return_error = EB_ErrorNone;
+    EbEncHandle          *pEncCompData = (EbEncHandle*)svt_enc_component->p_component_private;
+    EbObjectWrapper      *ebWrapperPtr = NULL;
+    EbBufferHeaderType    *packet;
+    if (pEncCompData->packet_callback)
+        return EB_NoErrorEmptyQueue;
+    eb_get_full_object_timeout(
+        (pEncCompData->output_stream_buffer_consumer_fifo_ptr_dbl_array[0])[0],
+        &ebWrapperPtr,
+        timeout_ms);
+
+    if (ebWrapperPtr) {
+        packet = (EbBufferHeaderType*)ebWrapperPtr->object_ptr;
+        if (packet->flags & 0xfffffff0)
+            return_error = EB_ErrorMax;
+        *p_buffer = packet;
+        (*p_buffer)->wrapper_ptr = (void*)ebWrapperPtr;
+    }
+    else
+        return_error = EB_NoErrorEmptyQueue;
+    return return_error;
+}
+
 #if defined(__linux__) || defined(__APPLE__)
 __attribute__((visibility("default")))
 #endif
@@ -3239,6 +4030,123 @@ EB_API EbErrorType eb_svt_get_recon(
     return return_error;
 }
 
+/**********************************
+* Pipeline Statistics
+**********************************/
+#if defined(__linux__) || defined(__APPLE__)
+__attribute__((visibility("default")))
+#endif
+EB_API EbErrorType eb_svt_get_pipeline_stats(
+    EbComponentType      *svt_enc_component,
+    EbSvtPipelineStats   *stats)
+{
+    EbEncHandle          *enc_handle_ptr;
+    EbPipelineStage       stage_array[EB_PIPELINE_STAGE_MAX_COUNT];
+    uint32_t              stageIndex;
+
+    if (svt_enc_component == NULL || stats == NULL)
+        return EB_ErrorBadParameter;
+    enc_handle_ptr = (EbEncHandle*)svt_enc_component->p_component_private;
+
+    stats->elapsed_time = EbGetTimeUs() - enc_handle_ptr->stats_start_time;
+    stats->stage_count = eb_enc_handle_get_pipeline_stages(enc_handle_ptr, stage_array);
+
+    for (stageIndex = 0; stageIndex < stats->stage_count; ++stageIndex) {
+        EbSvtStageStats *stage_ptr = &stats->stage_array[stageIndex];
+        EbMuxingQueue   *queue_ptr = stage_array[stageIndex].queue_ptr;
+        const int32_t    depth = (int32_t)eb_atomic_load_u32(&queue_ptr->ready_count);
+
+        stage_ptr->name = stage_array[stageIndex].name;
+        stage_ptr->thread_count = stage_array[stageIndex].thread_count;
+        stage_ptr->busy_time = eb_atomic_load_u64(&queue_ptr->stats.busy_time);
+        stage_ptr->input_wait_time = eb_atomic_load_u64(&queue_ptr->stats.input_wait_time);
+        stage_ptr->output_wait_time = eb_atomic_load_u64(&queue_ptr->stats.output_wait_time);
+        stage_ptr->processed_object_count = eb_atomic_load_u64(&queue_ptr->stats.object_count);
+        // Waiting consumers take the count below zero
+        stage_ptr->input_queue_depth = (uint32_t)MAX(depth, 0);
+    }
+
+    return EB_ErrorNone;
+}
+
+/**********************************
+* eb_svt_enc_get_input_layout
+**********************************/
+#if defined(__linux__) || defined(__APPLE__)
+__attribute__((visibility("default")))
+#endif
+EB_API EbErrorType eb_svt_enc_get_input_layout(
+    EbComponentType      *svt_enc_component,
+    EbSvtInputLayout     *layout)
+{
+    EbEncHandle          *enc_handle_ptr;
+    SequenceControlSet   *sequence_control_set_ptr;
+
+    if (svt_enc_component == NULL || layout == NULL)
+        return EB_ErrorBadParameter;
+    enc_handle_ptr = (EbEncHandle*)svt_enc_component->p_component_private;
+    sequence_control_set_ptr = enc_handle_ptr->sequence_control_set_instance_array[0]->sequence_control_set_ptr;
+
+    layout->width = sequence_control_set_ptr->max_input_luma_width;
+    layout->height = sequence_control_set_ptr->max_input_luma_height;
+    layout->left_padding = sequence_control_set_ptr->left_padding;
+    layout->right_padding = sequence_control_set_ptr->right_padding;
+    layout->top_padding = sequence_control_set_ptr->top_padding;
+    layout->bottom_padding = sequence_control_set_ptr->bot_padding;
+    layout->y_stride = layout->width + layout->left_padding + layout->right_padding;
+    layout->cb_stride = layout->y_stride >> 1;
+    layout->cr_stride = layout->y_stride >> 1;
+    layout->buffer_count = sequence_control_set_ptr->input_buffer_fifo_init_count;
+
+    return EB_ErrorNone;
+}
+
+/**********************************
+* eb_svt_enc_set_input_release_callback
+**********************************/
+#if defined(__linux__) || defined(__APPLE__)
+__attribute__((visibility("default")))
+#endif
+EB_API EbErrorType eb_svt_enc_set_input_release_callback(
+    EbComponentType          *svt_enc_component,
+    EbSvtInputReleaseCallback release_callback,
+    void                     *context)
+{
+    EbEncHandle          *enc_handle_ptr;
+
+    if (svt_enc_component == NULL)
+        return EB_ErrorBadParameter;
+    enc_handle_ptr = (EbEncHandle*)svt_enc_component->p_component_private;
+
+    enc_handle_ptr->input_release_callback = release_callback;
+    enc_handle_ptr->input_release_context = context;
+
+    return EB_ErrorNone;
+}
+
+/**********************************
+* eb_svt_enc_set_packet_callback
+**********************************/
+#if defined(__linux__) || defined(__APPLE__)
+__attribute__((visibility("default")))
+#endif
+EB_API EbErrorType eb_svt_enc_set_packet_callback(
+    EbComponentType          *svt_enc_component,
+    EbSvtPacketCallback       packet_callback,
+    void                     *context)
+{
+    EbEncHandle          *enc_handle_ptr;
+
+    if (svt_enc_component == NULL)
+        return EB_ErrorBadParameter;
+    enc_handle_ptr = (EbEncHandle*)svt_enc_component->p_component_private;
+
+    enc_handle_ptr->packet_callback = packet_callback;
+    enc_handle_ptr->packet_context = context;
+
+    return EB_ErrorNone;
+}
+
 /**********************************
 * Encoder Error Handling
 **********************************/
@@ -3261,7 +4169,12 @@ void lib_svt_encoder_send_error_exit(
     outputPacket->flags    = error_code;
     outputPacket->p_buffer   = NULL;
 
-    eb_post_full_object(ebWrapperPtr);
+    if (pEncCompData->packet_callback) {
+        outputPacket->wrapper_ptr = (void*)ebWrapperPtr;
+        pEncCompData->packet_callback(pEncCompData->packet_context, outputPacket);
+    }
+    else
+        eb_post_full_object(ebWrapperPtr);
 }
 /**********************************
 * Encoder Handle Initialization
@@ -3336,9 +4249,9 @@ static EbErrorType allocate_frame_buffer(
         inputBuffer->p_buffer = (uint8_t*)buf;
         if (is16bit && config->compressed_ten_bit_format == 1) {
             //pack 4 2bit pixels into 1Byte
-            EB_MALLOC_ALIGNED_ARRAY(buf->buffer_bit_inc_y, (input_picture_buffer_desc_init_data.max_width / 4)*(input_picture_buffer_desc_init_data.max_height));
-            EB_MALLOC_ALIGNED_ARRAY(buf->buffer_bit_inc_cb, (input_picture_buffer_desc_init_data.max_width / 8)*(input_picture_buffer_desc_init_data.max_height / 2));
-            EB_MALLOC_ALIGNED_ARRAY(buf->buffer_bit_inc_cr, (input_picture_buffer_desc_init_data.max_width / 8)*(input_picture_buffer_desc_init_data.max_height / 2));
+            EB_ALLOC_PICTURE_PLANE(buf, buffer_bit_inc_y, (input_picture_buffer_desc_init_data.max_width / 4)*(input_picture_buffer_desc_init_data.max_height));
+            EB_ALLOC_PICTURE_PLANE(buf, buffer_bit_inc_cb, (input_picture_buffer_desc_init_data.max_width / 8)*(input_picture_buffer_desc_init_data.max_height / 2));
+            EB_ALLOC_PICTURE_PLANE(buf, buffer_bit_inc_cr, (input_picture_buffer_desc_init_data.max_width / 8)*(input_picture_buffer_desc_init_data.max_height / 2));
         }
     }
 
@@ -3369,13 +4282,53 @@ EbErrorType EbInputBufferHeaderCreator(
     return EB_ErrorNone;
 }
 
+/**************************************
+* EbBufferHeaderType Constructor, zero_copy_input
+*   The planes are set to the ones of the application by
+*   eb_svt_enc_send_picture.
+**************************************/
+EbErrorType EbZeroCopyInputBufferHeaderCreator(
+    EbPtr *objectDblPtr,
+    EbPtr  objectInitDataPtr)
+{
+    EbBufferHeaderType          *inputBuffer;
+    EbPictureBufferDesc         *buf;
+    EbPictureBufferDescInitData  input_picture_buffer_desc_init_data;
+    SequenceControlSet          *sequence_control_set_ptr = (SequenceControlSet*)objectInitDataPtr;
+
+    *objectDblPtr = NULL;
+    EB_CALLOC(inputBuffer, 1, sizeof(EbBufferHeaderType));
+    *objectDblPtr = (EbPtr)inputBuffer;
+    // Initialize Header
+    inputBuffer->size = sizeof(EbBufferHeaderType);
+
+    input_picture_buffer_desc_init_data.max_width = (uint16_t)sequence_control_set_ptr->max_input_luma_width;
+    input_picture_buffer_desc_init_data.max_height = (uint16_t)sequence_control_set_ptr->max_input_luma_height;
+    input_picture_buffer_desc_init_data.bit_depth = EB_8BIT;
+    input_picture_buffer_desc_init_data.color_format = EB_YUV420;
+    input_picture_buffer_desc_init_data.buffer_enable_mask = 0;
+    input_picture_buffer_desc_init_data.left_padding = sequence_control_set_ptr->left_padding;
+    input_picture_buffer_desc_init_data.right_padding = sequence_control_set_ptr->right_padding;
+    input_picture_buffer_desc_init_data.top_padding = sequence_control_set_ptr->top_padding;
+    input_picture_buffer_desc_init_data.bot_padding = sequence_control_set_ptr->bot_padding;
+    input_picture_buffer_desc_init_data.split_mode = EB_FALSE;
+
+    EB_NEW(
+        buf,
+        eb_picture_buffer_desc_ctor,
+        (EbPtr)&input_picture_buffer_desc_init_data);
+    inputBuffer->p_buffer = (uint8_t*)buf;
+
+    return EB_ErrorNone;
+}
+
 void EbInputBufferHeaderDestoryer(    EbPtr p)
 {
     EbBufferHeaderType *obj = (EbBufferHeaderType*)p;
     EbPictureBufferDesc* buf = (EbPictureBufferDesc*)obj->p_buffer;
-    EB_FREE_ALIGNED_ARRAY(buf->buffer_bit_inc_y);
-    EB_FREE_ALIGNED_ARRAY(buf->buffer_bit_inc_cb);
-    EB_FREE_ALIGNED_ARRAY(buf->buffer_bit_inc_cr);
+    eb_picture_buffer_desc_free_plane(buf, &buf->buffer_bit_inc_y);
+    eb_picture_buffer_desc_free_plane(buf, &buf->buffer_bit_inc_cb);
+    eb_picture_buffer_desc_free_plane(buf, &buf->buffer_bit_inc_cr);
 
     EB_DELETE(buf);
     EB_FREE(obj);
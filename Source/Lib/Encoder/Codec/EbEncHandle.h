@@ -28,6 +28,8 @@
 #include "EbCdefProcess.h"
 #include "EbRestProcess.h"
 #include "EbEntropyCodingProcess.h"
+#include "EbTaskScheduler.h"
+#include "EbTrace.h"
 #include "EbPacketizationProcess.h"
 #include "EbObject.h"
 
@@ -92,6 +94,16 @@ typedef struct EbEncHandle
 
     EbHandle                               packetization_thread_handle;
 
+    // Task scheduler serving the parallel stages when enable_task_scheduler is set,
+    // owned by the handle unless share_task_scheduler is set
+    EbTaskScheduler                       *task_scheduler_ptr;
+    EbTaskChannel                         *task_channel_ptr;
+
+    // Start of the pipeline statistics, in microseconds
+    uint64_t                               stats_start_time;
+    // Trace written at eb_deinit_encoder when trace_file_name is set
+    EbTrace                               *trace_ptr;
+
     // Contexts
     ResourceCoordinationContext            *resource_coordination_context_ptr;
     PictureAnalysisContext                 **picture_analysis_context_ptr_array;
@@ -173,6 +185,16 @@ typedef struct EbEncHandle
     // Callbacks
     EbCallback                          **app_callback_ptr_array;
 
+    // zero_copy_input: gives the pictures back to the application
+    EbSvtInputReleaseCallback              input_release_callback;
+    void                                  *input_release_context;
+    // Planes referenced by an end of sequence sent without a picture
+    EbBufferHeaderType                    *zero_copy_eos_buffer_ptr;
+
+    // Packets handed to the application from the packetization thread
+    EbSvtPacketCallback                    packet_callback;
+    void                                  *packet_context;
+
 } EbEncHandle;
 
 #endif // EbEncHandle_h
@@ -0,0 +1,160 @@
+/*
+ * Copyright(c) 2019 Netflix, Inc.
+ * SPDX - License - Identifier: BSD - 2 - Clause - Patent
+ */
+
+/******************************************************************************
+ * @file ArenaTest.cc
+ *
+ * @brief Unit test for the picture arena:
+ * - eb_arena_ctor / eb_arena_alloc / eb_arena_free / eb_arena_get_stats
+ * - eb_arena_set_current with eb_picture_buffer_desc_ctor
+ *
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include "gtest/gtest.h"
+#include "EbDefinitions.h"
+#include "EbArena.h"
+#include "EbPictureBufferDesc.h"
+
+/**
+ * @brief Unit test for the picture arena
+ *
+ * Test strategy:
+ * Allocate blocks of a few sizes, free and allocate them again, then
+ * construct a split mode picture buffer with the arena current.
+ *
+ * Expected result:
+ * Blocks are ALVALUE aligned and carved from EB_ARENA_REGION_ALIGN
+ * aligned regions, a freed block is reused by the next block of the same
+ * size, the statistics follow the live blocks, and every plane of the
+ * picture, bit increment planes included, comes from the arena and goes
+ * back to it with the picture.
+ */
+namespace {
+
+static EbErrorType create_arena(EbArena **arena, uint32_t mode) {
+    EB_NEW(*arena, eb_arena_ctor, mode);
+    return EB_ErrorNone;
+}
+
+TEST(ArenaTest, AllocReuseAndStats) {
+    EbArena *arena = NULL;
+    EbArenaStats stats;
+
+    ASSERT_EQ(create_arena(&arena, EB_ARENA_ON), EB_ErrorNone);
+    eb_arena_get_stats(arena, &stats);
+    EXPECT_EQ(stats.region_count, 0u);
+
+    uint8_t *first = (uint8_t *)eb_arena_alloc(arena, 1000);
+    uint8_t *second = (uint8_t *)eb_arena_alloc(arena, 3000);
+    ASSERT_TRUE(first != NULL);
+    ASSERT_TRUE(second != NULL);
+    EXPECT_EQ((uintptr_t)first % ALVALUE, 0u);
+    EXPECT_EQ((uintptr_t)second % ALVALUE, 0u);
+    EXPECT_EQ((uintptr_t)(first - EB_ARENA_BLOCK_HEADER_SIZE) % EB_ARENA_REGION_ALIGN, 0u);
+    memset(first, 0xab, 1000);
+    memset(second, 0xcd, 3000);
+
+    eb_arena_get_stats(arena, &stats);
+    EXPECT_EQ(stats.region_count, 1u);
+    EXPECT_EQ(stats.reserved_size, (uint64_t)EB_ARENA_REGION_ALIGN);
+    EXPECT_EQ(stats.block_count, 2u);
+    EXPECT_EQ(stats.used_size, 1024u + 3008u);
+
+    // Same size reuses the freed block, another size does not
+    eb_arena_free(arena, first);
+    EXPECT_EQ(eb_arena_alloc(arena, 1000), (void *)first);
+    eb_arena_free(arena, first);
+    uint8_t *third = (uint8_t *)eb_arena_alloc(arena, 2000);
+    EXPECT_NE(third, first);
+
+    // Larger than a region, a new region is mapped for it
+    uint8_t *large = (uint8_t *)eb_arena_alloc(arena, 3 * EB_ARENA_REGION_ALIGN);
+    ASSERT_TRUE(large != NULL);
+    memset(large, 0, 3 * EB_ARENA_REGION_ALIGN);
+
+    eb_arena_get_stats(arena, &stats);
+    EXPECT_EQ(stats.region_count, 2u);
+    EXPECT_EQ(stats.reserved_size % EB_ARENA_REGION_ALIGN, 0u);
+    EXPECT_EQ(stats.block_count, 3u);
+    EXPECT_EQ(stats.peak_size, stats.used_size);
+
+    eb_arena_free(arena, second);
+    eb_arena_free(arena, third);
+    eb_arena_free(arena, large);
+    eb_arena_get_stats(arena, &stats);
+    EXPECT_EQ(stats.block_count, 0u);
+    EXPECT_EQ(stats.used_size, 0u);
+    EXPECT_GT(stats.peak_size, 0u);
+    EB_DELETE(arena);
+}
+
+TEST(ArenaTest, HugeTlbFallsBack) {
+    EbArena *arena = NULL;
+    EbArenaStats stats;
+
+    // Works whether or not the system has a huge page pool
+    ASSERT_EQ(create_arena(&arena, EB_ARENA_HUGETLB), EB_ErrorNone);
+    uint8_t *block = (uint8_t *)eb_arena_alloc(arena, 4096);
+    ASSERT_TRUE(block != NULL);
+    memset(block, 1, 4096);
+    eb_arena_get_stats(arena, &stats);
+    EXPECT_EQ(stats.region_count, 1u);
+    EXPECT_LE(stats.hugetlb_size, stats.reserved_size);
+    eb_arena_free(arena, block);
+    EB_DELETE(arena);
+}
+
+static EbErrorType create_picture(EbPictureBufferDesc **picture,
+                                  EbPictureBufferDescInitData *init_data) {
+    EB_NEW(*picture, eb_picture_buffer_desc_ctor, init_data);
+    return EB_ErrorNone;
+}
+
+TEST(ArenaTest, PicturePlanesFromCurrentArena) {
+    EbArena *arena = NULL;
+    EbPictureBufferDesc *picture = NULL;
+    EbPictureBufferDescInitData init_data;
+    EbArenaStats stats;
+
+    memset(&init_data, 0, sizeof(init_data));
+    init_data.max_width = 64;
+    init_data.max_height = 64;
+    init_data.bit_depth = EB_10BIT;
+    init_data.color_format = EB_YUV420;
+    init_data.buffer_enable_mask = PICTURE_BUFFER_DESC_FULL_MASK;
+    init_data.left_padding = 16;
+    init_data.right_padding = 16;
+    init_data.top_padding = 16;
+    init_data.bot_padding = 16;
+    init_data.split_mode = EB_TRUE;
+
+    ASSERT_EQ(create_arena(&arena, EB_ARENA_ON), EB_ErrorNone);
+    eb_arena_set_current(arena);
+    ASSERT_EQ(create_picture(&picture, &init_data), EB_ErrorNone);
+    eb_arena_set_current(NULL);
+
+    EXPECT_EQ(picture->arena_ptr, arena);
+    ASSERT_TRUE(picture->buffer_bit_inc_cr != NULL);
+    EXPECT_EQ(picture->buffer_y[0], 0);
+    EXPECT_EQ(picture->buffer_bit_inc_cr[picture->chroma_size - 1], 0);
+    eb_arena_get_stats(arena, &stats);
+    EXPECT_EQ(stats.block_count, 6u);
+    EXPECT_GE(stats.used_size, 2u * (picture->luma_size + 2 * picture->chroma_size));
+
+    EB_DELETE(picture);
+    eb_arena_get_stats(arena, &stats);
+    EXPECT_EQ(stats.block_count, 0u);
+    EXPECT_EQ(stats.used_size, 0u);
+
+    // Not current any more, the next picture comes from the heap
+    ASSERT_EQ(create_picture(&picture, &init_data), EB_ErrorNone);
+    EXPECT_TRUE(picture->arena_ptr == NULL);
+    EB_DELETE(picture);
+    EB_DELETE(arena);
+}
+
+}  // namespace
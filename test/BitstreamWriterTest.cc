@@ -83,7 +83,7 @@ class BitstreamWriterTest : public ::testing::Test {
                 generate_random_bits(test_bits, total_bits, bit_gen_method);
 
                 // encode the bits
-                aom_start_encode(&bw, bw_buffer);
+                aom_start_encode(&bw, bw_buffer, buffer_size);
                 for (int i = 0; i < total_bits; ++i) {
                     aom_write(&bw, test_bits[i], static_cast<int>(probas[i]));
                 }
@@ -184,7 +184,7 @@ TEST(Entropy_BitstreamWriter, write_literal_extreme_int) {
     uint8_t stream_buffer[buffer_size];
     AomWriter bw;
 
-    aom_start_encode(&bw, stream_buffer);
+    aom_start_encode(&bw, stream_buffer, buffer_size);
     aom_write_literal(&bw, max_int, 32);
     aom_write_literal(&bw, min_int, 32);
     aom_stop_encode(&bw);
@@ -215,7 +215,7 @@ TEST(Entropy_BitstreamWriter, write_symbol_no_update) {
     std::bernoulli_distribution rnd(0.5);
     std::mt19937 gen(deterministic_seeds);
 
-    aom_start_encode(&bw, stream_buffer);
+    aom_start_encode(&bw, stream_buffer, buffer_size);
     for (int i = 0; i < 500; ++i) {
         aom_write_symbol(&bw, rnd(gen), fc.txb_skip_cdf[0][0], 2);
         aom_write_symbol(&bw, rnd(gen), fc.txb_skip_cdf[0][0], 2);
@@ -256,7 +256,7 @@ TEST(Entropy_BitstreamWriter, write_symbol_with_update) {
     std::bernoulli_distribution rnd(0.5);
     std::mt19937 gen(deterministic_seeds);
 
-    aom_start_encode(&bw, stream_buffer);
+    aom_start_encode(&bw, stream_buffer, buffer_size);
     for (int i = 0; i < 500; ++i) {
         aom_write_symbol(&bw, rnd(gen), fc.txb_skip_cdf[0][0], 2);
         aom_write_symbol(&bw, rnd(gen), fc.txb_skip_cdf[0][0], 2);
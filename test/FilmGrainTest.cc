@@ -14,9 +14,14 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <string.h>
 #include "EbDefinitions.h"
+#include "aom_dsp_rtcd.h"
 #include "grainSynthesis.h"
 #include "gtest/gtest.h"
+#include "random.h"
+
+using svt_av1_test_tool::SVTRandom;
 
 static aom_film_grain_t film_grain_test_vectors[3] = {
     /* Test 1 */
@@ -186,3 +191,204 @@ TEST(FilmGrain, parameters_equality) {
                                       film_grain_test_vectors + 2),
               0);
 }
+
+/* Grain block kernels : the AVX2 versions must match the C ones for all the
+ * widths of a grain block row, including the tails shorter than a vector */
+static const int grain_test_widths[] = {1, 7, 8, 15, 16, 31, 32, 33, 64, 82};
+
+TEST(FilmGrain, ar_sum_avx2_match) {
+    const int stride = 96;
+    SVTRandom grain_rnd(-512, 511);
+    SVTRandom coeff_rnd(-128, 127);
+    int32_t grain[4 * stride];
+    int32_t coeffs[24];
+    int32_t wsum_ref[stride], wsum_tst[stride];
+
+    for (int lag = 0; lag <= 3; lag++) {
+        for (int w : grain_test_widths) {
+            for (int i = 0; i < 4 * stride; i++)
+                grain[i] = grain_rnd.random();
+            for (int i = 0; i < 24; i++)
+                coeffs[i] = coeff_rnd.random();
+            memset(wsum_ref, 0, sizeof(wsum_ref));
+            memset(wsum_tst, 0, sizeof(wsum_tst));
+            // Current row at row 3, the taps reach 3 columns on each side
+            const int32_t *row = grain + 3 * stride + 3;
+            eb_av1_grain_ar_sum_c(row, stride, coeffs, lag, w, wsum_ref);
+            eb_av1_grain_ar_sum_avx2(row, stride, coeffs, lag, w, wsum_tst);
+            ASSERT_EQ(memcmp(wsum_ref, wsum_tst, sizeof(wsum_ref)), 0)
+                << "lag " << lag << " width " << w;
+        }
+    }
+}
+
+/* Scaling LUT of the grain synthesis, with the extra interpolation entry */
+static void fill_scaling_lut(SVTRandom &rnd, int32_t lut[257]) {
+    for (int i = 0; i < 256; i++)
+        lut[i] = rnd.random();
+    lut[256] = lut[255];
+}
+
+TEST(FilmGrain, add_noise_luma_avx2_match) {
+    SVTRandom rnd8(0, 255);
+    SVTRandom rnd10(0, 1023);
+    SVTRandom grain_rnd(-512, 511);
+    int32_t lut[257];
+    int32_t grain[82];
+    uint8_t src[82], dst_ref[82], dst_tst[82];
+    uint16_t src16[82], dst16_ref[82], dst16_tst[82];
+
+    for (int shift = 8; shift <= 11; shift++) {
+        for (int w : grain_test_widths) {
+            fill_scaling_lut(rnd8, lut);
+            for (int i = 0; i < 82; i++) {
+                grain[i] = grain_rnd.random();
+                src[i] = rnd8.random();
+                src16[i] = rnd10.random();
+            }
+            memset(dst_ref, 0, sizeof(dst_ref));
+            memset(dst_tst, 0, sizeof(dst_tst));
+            eb_av1_add_noise_luma_row_c(src, dst_ref, grain, lut, w, shift, 16, 235);
+            eb_av1_add_noise_luma_row_avx2(src, dst_tst, grain, lut, w, shift, 16, 235);
+            ASSERT_EQ(memcmp(dst_ref, dst_tst, sizeof(dst_ref)), 0)
+                << "shift " << shift << " width " << w;
+
+            memset(dst16_ref, 0, sizeof(dst16_ref));
+            memset(dst16_tst, 0, sizeof(dst16_tst));
+            eb_av1_highbd_add_noise_luma_row_c(
+                src16, dst16_ref, grain, lut, w, shift, 0, 1023, 10);
+            eb_av1_highbd_add_noise_luma_row_avx2(
+                src16, dst16_tst, grain, lut, w, shift, 0, 1023, 10);
+            ASSERT_EQ(memcmp(dst16_ref, dst16_tst, sizeof(dst16_ref)), 0)
+                << "shift " << shift << " width " << w;
+        }
+    }
+}
+
+TEST(FilmGrain, add_noise_chroma_avx2_match) {
+    SVTRandom rnd8(0, 255);
+    SVTRandom rnd10(0, 1023);
+    SVTRandom grain_rnd(-512, 511);
+    SVTRandom mult_rnd(-128, 127);
+    SVTRandom offset_rnd(0, 511);
+    int32_t lut[257];
+    int32_t grain[82];
+    uint8_t src[82], luma[2 * 82], dst_ref[82], dst_tst[82];
+    uint16_t src16[82], luma16[2 * 82], dst16_ref[82], dst16_tst[82];
+
+    for (int subsamp_x = 0; subsamp_x <= 1; subsamp_x++) {
+        for (int w : grain_test_widths) {
+            const int mult = mult_rnd.random();
+            const int luma_mult = mult_rnd.random();
+            const int offset = offset_rnd.random();
+            fill_scaling_lut(rnd8, lut);
+            for (int i = 0; i < 82; i++) {
+                grain[i] = grain_rnd.random();
+                src[i] = rnd8.random();
+                src16[i] = rnd10.random();
+            }
+            for (int i = 0; i < 2 * 82; i++) {
+                luma[i] = rnd8.random();
+                luma16[i] = rnd10.random();
+            }
+
+            memset(dst_ref, 0, sizeof(dst_ref));
+            memset(dst_tst, 0, sizeof(dst_tst));
+            eb_av1_add_noise_chroma_row_c(src, dst_ref, luma, grain, lut, w,
+                subsamp_x, mult, luma_mult, offset - 256, 10, 0, 255);
+            eb_av1_add_noise_chroma_row_avx2(src, dst_tst, luma, grain, lut, w,
+                subsamp_x, mult, luma_mult, offset - 256, 10, 0, 255);
+            ASSERT_EQ(memcmp(dst_ref, dst_tst, sizeof(dst_ref)), 0)
+                << "subsamp_x " << subsamp_x << " width " << w;
+
+            memset(dst16_ref, 0, sizeof(dst16_ref));
+            memset(dst16_tst, 0, sizeof(dst16_tst));
+            eb_av1_highbd_add_noise_chroma_row_c(src16, dst16_ref, luma16,
+                grain, lut, w, subsamp_x, mult, luma_mult, (offset << 2) - 1024,
+                10, 64, 960, 10);
+            eb_av1_highbd_add_noise_chroma_row_avx2(src16, dst16_tst, luma16,
+                grain, lut, w, subsamp_x, mult, luma_mult, (offset << 2) - 1024,
+                10, 64, 960, 10);
+            ASSERT_EQ(memcmp(dst16_ref, dst16_tst, sizeof(dst16_ref)), 0)
+                << "subsamp_x " << subsamp_x << " width " << w;
+        }
+    }
+}
+
+/* The grain synthesis calls the kernels through the rtcd pointers, which the
+ * unit tests do not set up */
+static void setup_grain_kernels(bool use_avx2) {
+    eb_av1_grain_ar_sum =
+        use_avx2 ? eb_av1_grain_ar_sum_avx2 : eb_av1_grain_ar_sum_c;
+    eb_av1_add_noise_luma_row = use_avx2 ? eb_av1_add_noise_luma_row_avx2
+                                         : eb_av1_add_noise_luma_row_c;
+    eb_av1_add_noise_chroma_row = use_avx2 ? eb_av1_add_noise_chroma_row_avx2
+                                           : eb_av1_add_noise_chroma_row_c;
+    eb_av1_highbd_add_noise_luma_row =
+        use_avx2 ? eb_av1_highbd_add_noise_luma_row_avx2
+                 : eb_av1_highbd_add_noise_luma_row_c;
+    eb_av1_highbd_add_noise_chroma_row =
+        use_avx2 ? eb_av1_highbd_add_noise_chroma_row_avx2
+                 : eb_av1_highbd_add_noise_chroma_row_c;
+}
+
+/* Adding the grain while copying gives the samples of adding it in place,
+ * and leaves the source untouched */
+TEST(FilmGrain, copy_matches_in_place) {
+    const int width = 99, height = 67;
+    const int luma_stride = 112, chroma_stride = 64;
+    const int luma_size = luma_stride * height;
+    const int chroma_size = chroma_stride * (height >> 1);
+    SVTRandom rnd(0, 255);
+
+    for (int test = 0; test < 4; test++) {
+        const int hbd = test & 1;
+        setup_grain_kernels(test >> 1);
+        const int bytes = hbd ? 2 : 1;
+        aom_film_grain_t params = film_grain_test_vectors[0];
+        params.bit_depth = hbd ? 10 : 8;
+
+        uint8_t *src = new uint8_t[(luma_size + 2 * chroma_size) * bytes];
+        uint8_t *in_place = new uint8_t[(luma_size + 2 * chroma_size) * bytes];
+        uint8_t *copy = new uint8_t[(luma_size + 2 * chroma_size) * bytes];
+        for (int i = 0; i < luma_size + 2 * chroma_size; i++) {
+            if (hbd)
+                ((uint16_t *)src)[i] = (uint16_t)(rnd.random() << 2);
+            else
+                src[i] = (uint8_t)rnd.random();
+        }
+        memcpy(in_place, src, (luma_size + 2 * chroma_size) * bytes);
+        memset(copy, 0, (luma_size + 2 * chroma_size) * bytes);
+
+        aom_film_grain_t run_params = params;
+        eb_av1_add_film_grain_run(&run_params,
+            in_place, in_place + luma_size * bytes,
+            in_place + (luma_size + chroma_size) * bytes, height, width,
+            luma_stride, chroma_stride, hbd, 1, 1);
+        eb_av1_add_film_grain_copy(&params,
+            src, src + luma_size * bytes,
+            src + (luma_size + chroma_size) * bytes, luma_stride,
+            chroma_stride, copy, copy + luma_size * bytes,
+            copy + (luma_size + chroma_size) * bytes, luma_stride,
+            chroma_stride, height, width, hbd, 1, 1);
+
+        for (int y = 0; y < height; y++) {
+            ASSERT_EQ(memcmp(in_place + y * luma_stride * bytes,
+                             copy + y * luma_stride * bytes, width * bytes),
+                      0)
+                << "luma row " << y << " test " << test;
+        }
+        for (int y = 0; y < 2 * (height >> 1); y++) {
+            const int offset = luma_size * bytes + y * chroma_stride * bytes;
+            ASSERT_EQ(memcmp(in_place + offset, copy + offset,
+                             (width >> 1) * bytes),
+                      0)
+                << "chroma row " << y << " test " << test;
+        }
+        EXPECT_NE(memcmp(src, in_place, luma_size * bytes), 0);
+
+        delete[] src;
+        delete[] in_place;
+        delete[] copy;
+    }
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright(c) 2019 Netflix, Inc.
+ * SPDX - License - Identifier: BSD - 2 - Clause - Patent
+ */
+
+/******************************************************************************
+ * @file RowSegmentsTest.cc
+ *
+ * @brief Unit test for the row segments shared by the threads of a stage:
+ * - row_segments_open / row_segments_run / row_segments_close
+ * - row_segments_help
+ * - row_segments_wait / row_segments_set_progress
+ *
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "EbRowSegments.h"
+
+/**
+ * @brief Unit test for the row segments
+ *
+ * Test strategy:
+ * Helper threads join a session in which several passes are run. Each
+ * row of a pass walks its columns and waits for the row above to be two
+ * columns ahead, the same wavefront as the deblocking rows.
+ *
+ * Expected result:
+ * Every cell of every pass is processed exactly once, after the cells of
+ * the row above it that it depends on, by a worker with a valid index, and
+ * the helpers leave the session when it is closed.
+ */
+namespace {
+
+static const uint32_t row_count = 12;
+static const uint32_t col_count = 10;
+
+typedef struct TestPass {
+    RowSegments *segments_ptr;
+    uint32_t worker_count;
+    std::atomic<uint32_t> done[row_count][col_count];
+    std::atomic<uint32_t> order_error_count;
+} TestPass;
+
+static void test_row(void *pass_ptr, uint32_t worker_index,
+                     uint32_t row_index) {
+    TestPass *pass = (TestPass *)pass_ptr;
+    if (worker_index >= pass->worker_count)
+        pass->order_error_count++;
+    for (uint32_t col = 0; col < col_count; col++) {
+        if (row_index) {
+            const uint32_t needed = col + 2 < col_count ? col + 2 : col_count;
+            row_segments_wait(pass->segments_ptr, row_index - 1, needed);
+            if (!pass->done[row_index - 1][needed - 1])
+                pass->order_error_count++;
+        }
+        // Widen the window in which a missing dependency would show
+        std::this_thread::yield();
+        pass->done[row_index][col]++;
+        row_segments_set_progress(pass->segments_ptr, row_index, col + 1);
+    }
+}
+
+static EbErrorType create_segments(RowSegments **segments_ptr,
+                                   uint32_t helper_count) {
+    EB_NEW(*segments_ptr, row_segments_ctor, row_count, helper_count);
+    return EB_ErrorNone;
+}
+
+static void reset_pass(TestPass *pass, RowSegments *segments_ptr,
+                       uint32_t helper_count) {
+    pass->segments_ptr = segments_ptr;
+    pass->worker_count = helper_count + 1;
+    pass->order_error_count = 0;
+    for (uint32_t row = 0; row < row_count; row++)
+        for (uint32_t col = 0; col < col_count; col++)
+            pass->done[row][col] = 0;
+}
+
+TEST(RowSegmentsTest, PassesSharedWithHelpers) {
+    const uint32_t helper_count = 3;
+    const uint32_t pass_count = 20;
+    RowSegments *segments_ptr = NULL;
+    ASSERT_EQ(create_segments(&segments_ptr, helper_count), EB_ErrorNone);
+
+    row_segments_open(segments_ptr);
+    std::vector<std::thread> helpers;
+    for (uint32_t i = 0; i < helper_count; i++)
+        helpers.emplace_back(row_segments_help, segments_ptr);
+
+    TestPass *pass = new TestPass;
+    for (uint32_t pass_index = 0; pass_index < pass_count; pass_index++) {
+        reset_pass(pass, segments_ptr, helper_count);
+        row_segments_run(segments_ptr, test_row, pass, row_count);
+        EXPECT_EQ(pass->order_error_count, 0u);
+        for (uint32_t row = 0; row < row_count; row++)
+            for (uint32_t col = 0; col < col_count; col++)
+                EXPECT_EQ(pass->done[row][col], 1u);
+    }
+    row_segments_close(segments_ptr);
+    for (std::thread &helper : helpers)
+        helper.join();
+
+    delete pass;
+    EB_DELETE(segments_ptr);
+}
+
+TEST(RowSegmentsTest, HelpOutsideSessionReturns) {
+    RowSegments *segments_ptr = NULL;
+    ASSERT_EQ(create_segments(&segments_ptr, 1), EB_ErrorNone);
+
+    // No session open yet, then a closed one
+    row_segments_help(segments_ptr);
+    row_segments_open(segments_ptr);
+    row_segments_close(segments_ptr);
+    row_segments_help(segments_ptr);
+
+    // Without helpers the owner runs every row
+    TestPass *pass = new TestPass;
+    reset_pass(pass, segments_ptr, 0);
+    row_segments_open(segments_ptr);
+    row_segments_run(segments_ptr, test_row, pass, row_count);
+    row_segments_close(segments_ptr);
+    EXPECT_EQ(pass->order_error_count, 0u);
+    for (uint32_t row = 0; row < row_count; row++)
+        for (uint32_t col = 0; col < col_count; col++)
+            EXPECT_EQ(pass->done[row][col], 1u);
+
+    delete pass;
+    EB_DELETE(segments_ptr);
+}
+
+}  // namespace
@@ -0,0 +1,407 @@
+/*
+ * Copyright(c) 2019 Netflix, Inc.
+ * SPDX - License - Identifier: BSD - 2 - Clause - Patent
+ */
+
+/******************************************************************************
+ * @file SystemResourceTest.cc
+ *
+ * @brief Unit test for the system resource manager:
+ * - eb_system_resource_ctor
+ * - eb_get_empty_object / eb_post_full_object
+ * - eb_get_full_object / eb_get_full_object_non_blocking
+ *   / eb_get_full_object_timeout
+ * - eb_release_object / eb_object_inc_live_count
+ * - eb_object_stats_start / eb_object_stats_finish
+ * - eb_system_resource_elastic_ctor / eb_system_resource_set_limit
+ *   / eb_system_resource_reserve
+ * - eb_system_resource_set_release_callback
+ *
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "EbSystemResourceManager.h"
+
+/**
+ * @brief Unit test for the lock-free object queues
+ *
+ * Test strategy:
+ * Several producer threads take empty objects, stamp them with a unique
+ * sequence number and post them to the full queue. Several consumer threads
+ * drain the full queue and release the objects back to the empty queue.
+ *
+ * Expected result:
+ * Every stamped object is consumed exactly once and all objects are back in
+ * the empty queue at the end, regardless of thread interleaving.
+ */
+namespace {
+
+typedef struct TestObject {
+    EbDctor dctor;
+    uint32_t value;
+} TestObject;
+
+static EbErrorType test_object_creator(EbPtr *object_dbl_ptr,
+                                       EbPtr object_init_data_ptr) {
+    TestObject *obj;
+    (void)object_init_data_ptr;
+    EB_CALLOC(obj, 1, sizeof(TestObject));
+    *object_dbl_ptr = obj;
+    return EB_ErrorNone;
+}
+
+static EbErrorType test_value_object_creator(EbPtr *object_dbl_ptr,
+                                             EbPtr object_init_data_ptr) {
+    TestObject *obj;
+    EB_CALLOC(obj, 1, sizeof(TestObject));
+    obj->value = *(uint32_t *)object_init_data_ptr;
+    *object_dbl_ptr = obj;
+    return EB_ErrorNone;
+}
+
+static EbErrorType create_elastic_resource(EbSystemResource **resource,
+                                           uint32_t init_count,
+                                           uint32_t max_count,
+                                           uint32_t *init_value,
+                                           EbFifo ***producer_fifos,
+                                           EbFifo ***consumer_fifos) {
+    EB_NEW(*resource,
+           eb_system_resource_elastic_ctor,
+           init_count,
+           max_count,
+           1,
+           1,
+           producer_fifos,
+           consumer_fifos,
+           EB_TRUE,
+           test_value_object_creator,
+           init_value,
+           sizeof(*init_value),
+           NULL);
+    return EB_ErrorNone;
+}
+
+static EbErrorType create_resource(EbSystemResource **resource,
+                                   uint32_t object_count,
+                                   uint32_t producer_count,
+                                   uint32_t consumer_count,
+                                   EbFifo ***producer_fifos,
+                                   EbFifo ***consumer_fifos) {
+    EB_NEW(*resource,
+           eb_system_resource_ctor,
+           object_count,
+           producer_count,
+           consumer_count,
+           producer_fifos,
+           consumer_fifos,
+           EB_TRUE,
+           test_object_creator,
+           NULL,
+           NULL);
+    return EB_ErrorNone;
+}
+
+class SystemResourceTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        resource_ = NULL;
+        producer_fifos_ = NULL;
+        consumer_fifos_ = NULL;
+    }
+
+    void TearDown() override {
+        EB_DELETE(resource_);
+    }
+
+    void create(uint32_t object_count, uint32_t producer_count,
+                uint32_t consumer_count) {
+        ASSERT_EQ(create_resource(&resource_,
+                                  object_count,
+                                  producer_count,
+                                  consumer_count,
+                                  &producer_fifos_,
+                                  &consumer_fifos_),
+                  EB_ErrorNone);
+    }
+
+    EbSystemResource *resource_;
+    EbFifo **producer_fifos_;
+    EbFifo **consumer_fifos_;
+};
+
+TEST_F(SystemResourceTest, NonBlockingGetOnEmptyQueue) {
+    create(4, 1, 1);
+
+    EbObjectWrapper *wrapper = NULL;
+    eb_get_full_object_non_blocking(consumer_fifos_[0], &wrapper);
+    EXPECT_TRUE(wrapper == NULL);
+
+    eb_get_empty_object(producer_fifos_[0], &wrapper);
+    ASSERT_TRUE(wrapper != NULL);
+    eb_post_full_object(wrapper);
+
+    EbObjectWrapper *full = NULL;
+    eb_get_full_object_non_blocking(consumer_fifos_[0], &full);
+    EXPECT_EQ(full, wrapper);
+    eb_release_object(full);
+}
+
+TEST_F(SystemResourceTest, TimedGetTimesOutAndWakes) {
+    create(4, 1, 1);
+
+    // Nothing posted, gives up after the timeout
+    EbObjectWrapper *wrapper = NULL;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(eb_get_full_object_timeout(consumer_fifos_[0], &wrapper, 20),
+              EB_NoErrorEmptyQueue);
+    EXPECT_TRUE(wrapper == NULL);
+    EXPECT_GE(std::chrono::steady_clock::now() - start,
+              std::chrono::milliseconds(15));
+
+    // The withdrawn wait does not swallow the next post
+    EbObjectWrapper *posted = NULL;
+    eb_get_empty_object(producer_fifos_[0], &posted);
+    eb_post_full_object(posted);
+    EbObjectWrapper *full = NULL;
+    eb_get_full_object_non_blocking(consumer_fifos_[0], &full);
+    EXPECT_EQ(full, posted);
+    eb_release_object(full);
+
+    // A post while parked wakes the waiter before the timeout
+    std::thread producer([this]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        EbObjectWrapper *late = NULL;
+        eb_get_empty_object(producer_fifos_[0], &late);
+        eb_post_full_object(late);
+    });
+    full = NULL;
+    EXPECT_EQ(eb_get_full_object_timeout(consumer_fifos_[0], &full, 10000),
+              EB_ErrorNone);
+    producer.join();
+    ASSERT_TRUE(full != NULL);
+    eb_object_stats_finish();
+    eb_release_object(full);
+}
+
+TEST_F(SystemResourceTest, ReleaseHonorsLiveCount) {
+    const uint32_t object_count = 2;
+    create(object_count, 1, 1);
+
+    EbObjectWrapper *held = NULL;
+    eb_get_empty_object(producer_fifos_[0], &held);
+    eb_object_inc_live_count(held, 2);
+
+    // One outstanding reference keeps the object out of the empty queue
+    eb_release_object(held);
+    EXPECT_EQ(held->live_count, 1u);
+
+    // Drain the remaining empty object to prove held was not recycled
+    EbObjectWrapper *other = NULL;
+    eb_get_empty_object(producer_fifos_[0], &other);
+    EXPECT_NE(other, held);
+
+    eb_release_object(held);
+    EXPECT_EQ(held->live_count, EB_ObjectWrapperReleasedValue);
+
+    EbObjectWrapper *recycled = NULL;
+    eb_get_empty_object(producer_fifos_[0], &recycled);
+    EXPECT_EQ(recycled, held);
+    EXPECT_EQ(recycled->live_count, 0u);
+
+    eb_release_object(recycled);
+    eb_release_object(other);
+}
+
+static void count_release(EbPtr context_ptr, EbObjectWrapper *wrapper_ptr) {
+    std::vector<EbObjectWrapper *> *released =
+        (std::vector<EbObjectWrapper *> *)context_ptr;
+    // Still out of the empty queue while the callback runs
+    EXPECT_EQ(wrapper_ptr->live_count, EB_ObjectWrapperReleasedValue);
+    released->push_back(wrapper_ptr);
+}
+
+TEST_F(SystemResourceTest, ReleaseCallbackOnLastRelease) {
+    std::vector<EbObjectWrapper *> released;
+    create(2, 1, 1);
+    eb_system_resource_set_release_callback(resource_, count_release,
+                                            &released);
+
+    // Two holders, the callback runs once, with the last release
+    EbObjectWrapper *held = NULL;
+    eb_get_empty_object(producer_fifos_[0], &held);
+    eb_object_inc_live_count(held, 2);
+    eb_release_object(held);
+    EXPECT_TRUE(released.empty());
+    eb_release_object(held);
+    ASSERT_EQ(released.size(), 1u);
+    EXPECT_EQ(released[0], held);
+
+    // Once per use of the object
+    EbObjectWrapper *other = NULL;
+    eb_get_empty_object(producer_fifos_[0], &other);
+    eb_release_object(other);
+    EXPECT_EQ(released.size(), 2u);
+}
+
+TEST_F(SystemResourceTest, ConcurrentProducersConsumers) {
+    const uint32_t object_count = 8;
+    const uint32_t producer_count = 4;
+    const uint32_t consumer_count = 4;
+    const uint32_t items_per_producer = 20000;
+    const uint32_t total_items = producer_count * items_per_producer;
+    create(object_count, producer_count, consumer_count);
+
+    std::vector<uint8_t> seen(total_items, 0);
+    std::vector<std::thread> threads;
+
+    for (uint32_t p = 0; p < producer_count; p++) {
+        threads.push_back(std::thread([&, p]() {
+            for (uint32_t i = 0; i < items_per_producer; i++) {
+                EbObjectWrapper *wrapper;
+                eb_get_empty_object(producer_fifos_[p], &wrapper);
+                ((TestObject *)wrapper->object_ptr)->value =
+                    p * items_per_producer + i;
+                eb_post_full_object(wrapper);
+            }
+        }));
+    }
+    for (uint32_t c = 0; c < consumer_count; c++) {
+        threads.push_back(std::thread([&, c]() {
+            for (uint32_t i = 0; i < total_items / consumer_count; i++) {
+                EbObjectWrapper *wrapper;
+                eb_get_full_object(consumer_fifos_[c], &wrapper);
+                seen[((TestObject *)wrapper->object_ptr)->value]++;
+                eb_release_object(wrapper);
+            }
+        }));
+    }
+    for (auto &t : threads)
+        t.join();
+
+    for (uint32_t i = 0; i < total_items; i++)
+        ASSERT_EQ(seen[i], 1) << "item " << i;
+
+    // All objects must be back in the empty queue
+    std::vector<EbObjectWrapper *> drained(object_count);
+    for (uint32_t i = 0; i < object_count; i++)
+        eb_get_empty_object(producer_fifos_[0], &drained[i]);
+    EbObjectWrapper *extra = NULL;
+    eb_get_full_object_non_blocking(consumer_fifos_[0], &extra);
+    EXPECT_TRUE(extra == NULL);
+    for (uint32_t i = 0; i < object_count; i++)
+        eb_release_object(drained[i]);
+}
+
+TEST_F(SystemResourceTest, QueueStatsAccounting) {
+    const std::chrono::milliseconds delay(20);
+    const uint64_t delay_us = 20 * 1000;
+    create(4, 1, 1);
+    EbQueueStats *stats = &consumer_fifos_[0]->queue_ptr->stats;
+    consumer_fifos_[0]->queue_ptr->stats_enabled = EB_TRUE;
+
+    // The consumer waits for the first object, then holds each object
+    // for the delay before asking for the next one
+    std::thread consumer([&]() {
+        for (uint32_t i = 0; i < 3; i++) {
+            EbObjectWrapper *wrapper;
+            eb_get_full_object(consumer_fifos_[0], &wrapper);
+            std::this_thread::sleep_for(delay);
+            eb_release_object(wrapper);
+        }
+        eb_object_stats_finish();
+    });
+    std::this_thread::sleep_for(delay);
+    for (uint32_t i = 0; i < 3; i++) {
+        EbObjectWrapper *wrapper;
+        eb_get_empty_object(producer_fifos_[0], &wrapper);
+        eb_post_full_object(wrapper);
+    }
+    consumer.join();
+
+    EXPECT_EQ(stats->object_count, 3u);
+    EXPECT_GE(stats->busy_time, 3 * delay_us - 3000);
+    EXPECT_GE(stats->input_wait_time, delay_us / 2);
+    EXPECT_EQ(stats->output_wait_time, 0u);
+
+    // The main thread never took a full object, nothing is charged to it
+    EbObjectWrapper *wrapper;
+    eb_get_empty_object(producer_fifos_[0], &wrapper);
+    eb_release_object(wrapper);
+    EXPECT_EQ(stats->output_wait_time, 0u);
+}
+
+TEST_F(SystemResourceTest, QueueStatsDisabled) {
+    create(4, 1, 1);
+    EbQueueStats *stats = &consumer_fifos_[0]->queue_ptr->stats;
+
+    // Without stats_enabled the stage is not timed nor counted
+    for (uint32_t i = 0; i < 3; i++) {
+        EbObjectWrapper *wrapper;
+        eb_get_empty_object(producer_fifos_[0], &wrapper);
+        eb_post_full_object(wrapper);
+        eb_get_full_object(consumer_fifos_[0], &wrapper);
+        eb_release_object(wrapper);
+    }
+    eb_object_stats_finish();
+
+    EXPECT_EQ(stats->object_count, 0u);
+    EXPECT_EQ(stats->busy_time, 0u);
+    EXPECT_EQ(stats->input_wait_time, 0u);
+    EXPECT_EQ(stats->output_wait_time, 0u);
+}
+
+TEST_F(SystemResourceTest, ElasticGrowShrinkAndLimit) {
+    uint32_t init_value = 7;
+    ASSERT_EQ(create_elastic_resource(&resource_, 2, 8, &init_value,
+                                      &producer_fifos_, &consumer_fifos_),
+              EB_ErrorNone);
+    // The objects constructed later use a copy of the init data
+    init_value = 0;
+    EXPECT_EQ(resource_->object_total_count, 2u);
+    EXPECT_GT(resource_->object_size, 0u);
+
+    // The pool grows instead of blocking once the initial objects are taken
+    std::vector<EbObjectWrapper *> taken(5);
+    for (uint32_t i = 0; i < 5; i++) {
+        eb_get_empty_object(producer_fifos_[0], &taken[i]);
+        EXPECT_EQ(((TestObject *)taken[i]->object_ptr)->value, 7u);
+    }
+    EXPECT_EQ(resource_->object_total_count, 5u);
+
+    // A busy pool keeps its objects
+    eb_release_object(taken[4]);
+    EXPECT_EQ(resource_->object_total_count, 5u);
+    eb_get_empty_object(producer_fifos_[0], &taken[4]);
+    EXPECT_EQ(resource_->object_total_count, 5u);
+
+    // After an idle period the released objects above the initial count
+    // are destroyed
+    resource_->empty_time = 0;
+    for (uint32_t i = 0; i < 5; i++)
+        eb_release_object(taken[i]);
+    EXPECT_EQ(resource_->object_total_count, 2u);
+
+    // The limit is clipped to [init, max] and bounds the reservation
+    eb_system_resource_set_limit(resource_, 1);
+    EXPECT_EQ(resource_->object_limit_count, 2u);
+    eb_system_resource_set_limit(resource_, 6);
+    ASSERT_EQ(eb_system_resource_reserve(resource_, 8), EB_ErrorNone);
+    EXPECT_EQ(resource_->object_total_count, 6u);
+    EXPECT_EQ(resource_->object_init_count, 6u);
+
+    // Reserved objects stay in the pool
+    taken.resize(6);
+    for (uint32_t i = 0; i < 6; i++)
+        eb_get_empty_object(producer_fifos_[0], &taken[i]);
+    resource_->empty_time = 0;
+    for (uint32_t i = 0; i < 6; i++)
+        eb_release_object(taken[i]);
+    EXPECT_EQ(resource_->object_total_count, 6u);
+}
+
+}  // namespace
@@ -0,0 +1,420 @@
+/*
+ * Copyright(c) 2019 Netflix, Inc.
+ * SPDX - License - Identifier: BSD - 2 - Clause - Patent
+ */
+
+/******************************************************************************
+ * @file TaskSchedulerTest.cc
+ *
+ * @brief Unit test for the shared task scheduler:
+ * - eb_task_scheduler_ctor / eb_task_channel_add_stage
+ * - eb_task_scheduler_attach_channel / eb_task_scheduler_detach_channel
+ * - eb_task_scheduler_kernel
+ * - compensation of workers blocked inside a task
+ * - tasks left queued while a compensated worker held their context
+ * - sharing between channels weighted by their channel count
+ *
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "gtest/gtest.h"
+#include "EbTaskScheduler.h"
+
+/**
+ * @brief Unit test for the task scheduler
+ *
+ * Test strategy:
+ * Two chained stages are registered on a scheduler. The first stage
+ * forwards each object to the second through a resource with fewer
+ * objects than workers, so first stage tasks block on the empty queue
+ * and must be compensated. The second stage sums the received values.
+ *
+ * Expected result:
+ * Every posted value reaches the second stage exactly once and no stage
+ * context is used by two tasks at the same time.
+ */
+namespace {
+
+typedef struct TestObject {
+    EbDctor dctor;
+    uint32_t value;
+} TestObject;
+
+typedef struct TestContext {
+    std::atomic<uint32_t> in_use;
+    std::atomic<uint32_t> overlap_count;
+    EbFifo *output_fifo_ptr;
+    std::atomic<uint64_t> *sum_ptr;
+    std::atomic<uint32_t> *done_count_ptr;
+} TestContext;
+
+static EbErrorType test_object_creator(EbPtr *object_dbl_ptr,
+                                       EbPtr object_init_data_ptr) {
+    TestObject *obj;
+    (void)object_init_data_ptr;
+    EB_CALLOC(obj, 1, sizeof(TestObject));
+    *object_dbl_ptr = obj;
+    return EB_ErrorNone;
+}
+
+static EbErrorType create_resource(EbSystemResource **resource,
+                                   uint32_t object_count,
+                                   EbFifo ***producer_fifos,
+                                   EbFifo ***consumer_fifos) {
+    EB_NEW(*resource,
+           eb_system_resource_ctor,
+           object_count,
+           1,
+           1,
+           producer_fifos,
+           consumer_fifos,
+           EB_TRUE,
+           test_object_creator,
+           NULL,
+           NULL);
+    return EB_ErrorNone;
+}
+
+static EbErrorType create_scheduler(EbTaskScheduler **scheduler,
+                                    uint32_t worker_count) {
+    EB_NEW(*scheduler, eb_task_scheduler_ctor, worker_count);
+    for (uint32_t i = 0; i < worker_count; i++) {
+        (*scheduler)->thread_handle_array[i] =
+            eb_create_thread(eb_task_scheduler_kernel, *scheduler);
+        if ((*scheduler)->thread_handle_array[i] == NULL)
+            return EB_ErrorInsufficientResources;
+    }
+    return EB_ErrorNone;
+}
+
+static EbErrorType create_channel(EbTaskChannel **channel, uint32_t channel_id,
+                                  uint32_t active_channel_count) {
+    EB_NEW(*channel, eb_task_channel_ctor, channel_id, active_channel_count);
+    return EB_ErrorNone;
+}
+
+static void enter_context(TestContext *context_ptr) {
+    if (context_ptr->in_use.exchange(1) != 0)
+        context_ptr->overlap_count++;
+    // Widen the window in which a second task could use the context
+    std::this_thread::yield();
+}
+
+static void forward_task(void *input_ptr, EbObjectWrapper *input_wrapper_ptr) {
+    TestContext *context_ptr = (TestContext *)input_ptr;
+    EbObjectWrapper *output_wrapper_ptr;
+
+    enter_context(context_ptr);
+    eb_get_empty_object(context_ptr->output_fifo_ptr, &output_wrapper_ptr);
+    ((TestObject *)output_wrapper_ptr->object_ptr)->value =
+        ((TestObject *)input_wrapper_ptr->object_ptr)->value;
+    context_ptr->in_use = 0;
+
+    eb_release_object(input_wrapper_ptr);
+    eb_post_full_object(output_wrapper_ptr);
+}
+
+static void sum_task(void *input_ptr, EbObjectWrapper *input_wrapper_ptr) {
+    TestContext *context_ptr = (TestContext *)input_ptr;
+
+    enter_context(context_ptr);
+    *context_ptr->sum_ptr += ((TestObject *)input_wrapper_ptr->object_ptr)->value;
+    context_ptr->in_use = 0;
+
+    eb_release_object(input_wrapper_ptr);
+    (*context_ptr->done_count_ptr)++;
+}
+
+TEST(TaskSchedulerTest, ChainedStagesWithBackpressure) {
+    const uint32_t worker_count = 4;
+    const uint32_t context_count = 3;
+    const uint32_t item_count = 20000;
+
+    EbSystemResource *input_resource = NULL;
+    EbSystemResource *middle_resource = NULL;
+    EbFifo **input_producer_fifos, **input_consumer_fifos;
+    EbFifo **middle_producer_fifos, **middle_consumer_fifos;
+    ASSERT_EQ(create_resource(&input_resource, 8, &input_producer_fifos,
+                              &input_consumer_fifos),
+              EB_ErrorNone);
+    ASSERT_EQ(create_resource(&middle_resource, 2, &middle_producer_fifos,
+                              &middle_consumer_fifos),
+              EB_ErrorNone);
+
+    std::atomic<uint64_t> sum(0);
+    std::atomic<uint32_t> done_count(0);
+    TestContext forward_contexts[context_count];
+    TestContext sum_contexts[context_count];
+    void *forward_context_ptrs[context_count];
+    void *sum_context_ptrs[context_count];
+    for (uint32_t i = 0; i < context_count; i++) {
+        TestContext *contexts[2] = {&forward_contexts[i], &sum_contexts[i]};
+        for (TestContext *context_ptr : contexts) {
+            context_ptr->in_use = 0;
+            context_ptr->overlap_count = 0;
+            context_ptr->output_fifo_ptr = middle_producer_fifos[0];
+            context_ptr->sum_ptr = &sum;
+            context_ptr->done_count_ptr = &done_count;
+        }
+        forward_context_ptrs[i] = &forward_contexts[i];
+        sum_context_ptrs[i] = &sum_contexts[i];
+    }
+
+    EbTaskChannel *channel = NULL;
+    ASSERT_EQ(create_channel(&channel, 0, 1), EB_ErrorNone);
+    ASSERT_EQ(eb_task_channel_add_stage(channel,
+                                        input_consumer_fifos[0],
+                                        forward_task,
+                                        forward_context_ptrs,
+                                        context_count),
+              EB_ErrorNone);
+    ASSERT_EQ(eb_task_channel_add_stage(channel,
+                                        middle_consumer_fifos[0],
+                                        sum_task,
+                                        sum_context_ptrs,
+                                        context_count),
+              EB_ErrorNone);
+
+    EbTaskScheduler *scheduler = NULL;
+    ASSERT_EQ(create_scheduler(&scheduler, worker_count), EB_ErrorNone);
+    ASSERT_EQ(eb_task_scheduler_attach_channel(scheduler, channel),
+              EB_ErrorNone);
+    EXPECT_EQ(scheduler->thread_max_count, worker_count + 2 * context_count);
+
+    uint64_t expected_sum = 0;
+    for (uint32_t i = 0; i < item_count; i++) {
+        EbObjectWrapper *wrapper;
+        eb_get_empty_object(input_producer_fifos[0], &wrapper);
+        ((TestObject *)wrapper->object_ptr)->value = i;
+        expected_sum += i;
+        eb_post_full_object(wrapper);
+    }
+
+    for (uint32_t wait_ms = 0; done_count < item_count && wait_ms < 60000;
+         wait_ms++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    EXPECT_EQ(done_count, item_count);
+    EXPECT_EQ(sum, expected_sum);
+    for (uint32_t i = 0; i < context_count; i++) {
+        EXPECT_EQ(forward_contexts[i].overlap_count, 0u);
+        EXPECT_EQ(sum_contexts[i].overlap_count, 0u);
+    }
+    EXPECT_LE(scheduler->thread_total_count, scheduler->thread_max_count);
+
+    eb_task_scheduler_detach_channel(scheduler, channel);
+    EB_DELETE(scheduler);
+    EB_DELETE(channel);
+    EB_DELETE(middle_resource);
+    EB_DELETE(input_resource);
+}
+
+/**
+ * @brief Unit test for tasks left behind by a compensated worker
+ *
+ * Test strategy:
+ * A single worker takes the first task of a stage with one context,
+ * which blocks until a task of the upstream stage has run. The worker
+ * started in compensation runs the upstream task and finds the stage
+ * context still busy, so it parks. The blocked worker is then surplus
+ * and retires as soon as its task is done.
+ *
+ * Expected result:
+ * The remaining tasks of the stage are still run.
+ */
+typedef struct GateContext {
+    EbHandle gate_semaphore;
+    std::atomic<uint32_t> gate_open;
+    std::atomic<uint32_t> *done_count_ptr;
+} GateContext;
+
+static void open_gate_task(void *input_ptr,
+                           EbObjectWrapper *input_wrapper_ptr) {
+    GateContext *context_ptr = (GateContext *)input_ptr;
+    eb_release_object(input_wrapper_ptr);
+    context_ptr->gate_open = 1;
+    eb_post_semaphore(context_ptr->gate_semaphore);
+}
+
+static void gated_task(void *input_ptr, EbObjectWrapper *input_wrapper_ptr) {
+    GateContext *context_ptr = (GateContext *)input_ptr;
+    if (!context_ptr->gate_open) {
+        eb_task_scheduler_enter_wait();
+        eb_block_on_semaphore(context_ptr->gate_semaphore);
+        // Let the compensation worker look for work while the context is
+        // still held
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        eb_task_scheduler_leave_wait();
+    }
+    eb_release_object(input_wrapper_ptr);
+    (*context_ptr->done_count_ptr)++;
+}
+
+TEST(TaskSchedulerTest, TasksSkippedWhileContextBusy) {
+    const uint32_t gated_count = 3;
+
+    EbSystemResource *gate_resource = NULL;
+    EbSystemResource *gated_resource = NULL;
+    EbFifo **gate_producer_fifos, **gate_consumer_fifos;
+    EbFifo **gated_producer_fifos, **gated_consumer_fifos;
+    ASSERT_EQ(create_resource(&gate_resource, 1, &gate_producer_fifos,
+                              &gate_consumer_fifos),
+              EB_ErrorNone);
+    ASSERT_EQ(create_resource(&gated_resource, gated_count,
+                              &gated_producer_fifos, &gated_consumer_fifos),
+              EB_ErrorNone);
+
+    std::atomic<uint32_t> done_count(0);
+    GateContext context;
+    context.gate_semaphore = eb_create_semaphore(0, 1);
+    context.gate_open = 0;
+    context.done_count_ptr = &done_count;
+    void *context_ptr = &context;
+
+    // Idle workers look at the downstream gated stage first
+    EbTaskChannel *channel = NULL;
+    ASSERT_EQ(create_channel(&channel, 0, 1), EB_ErrorNone);
+    ASSERT_EQ(eb_task_channel_add_stage(channel, gate_consumer_fifos[0],
+                                        open_gate_task, &context_ptr, 1),
+              EB_ErrorNone);
+    ASSERT_EQ(eb_task_channel_add_stage(channel, gated_consumer_fifos[0],
+                                        gated_task, &context_ptr, 1),
+              EB_ErrorNone);
+
+    EbObjectWrapper *wrapper;
+    eb_get_empty_object(gate_producer_fifos[0], &wrapper);
+    eb_post_full_object(wrapper);
+    for (uint32_t i = 0; i < gated_count; i++) {
+        eb_get_empty_object(gated_producer_fifos[0], &wrapper);
+        eb_post_full_object(wrapper);
+    }
+
+    EbTaskScheduler *scheduler = NULL;
+    ASSERT_EQ(create_scheduler(&scheduler, 1), EB_ErrorNone);
+    ASSERT_EQ(eb_task_scheduler_attach_channel(scheduler, channel),
+              EB_ErrorNone);
+    eb_task_scheduler_notify(scheduler);
+
+    for (uint32_t wait_ms = 0; done_count < gated_count && wait_ms < 10000;
+         wait_ms++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_EQ(done_count, gated_count);
+
+    eb_task_scheduler_detach_channel(scheduler, channel);
+    EB_DELETE(scheduler);
+    EB_DELETE(channel);
+    EB_DESTROY_SEMAPHORE(context.gate_semaphore);
+    EB_DELETE(gated_resource);
+    EB_DELETE(gate_resource);
+}
+
+/**
+ * @brief Unit test for sharing between channels weighted by their channel
+ * count
+ *
+ * Test strategy:
+ * A channel running alone (active_channel_count 1) and one channel of a
+ * group of 3 share a single worker. Both input queues are kept full and
+ * every task spins for a fixed time, so the worker always has to choose
+ * between the channels.
+ *
+ * Expected result:
+ * The channel running alone completes about three times as many tasks.
+ */
+typedef struct SpinContext {
+    std::atomic<uint32_t> *done_count_ptr;
+    std::atomic<uint32_t> *stop_ptr;
+    EbFifo *input_producer_fifo_ptr;
+} SpinContext;
+
+static void spin_task(void *input_ptr, EbObjectWrapper *input_wrapper_ptr) {
+    SpinContext *context_ptr = (SpinContext *)input_ptr;
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start <
+           std::chrono::microseconds(200))
+        ;
+    eb_release_object(input_wrapper_ptr);
+    if (*context_ptr->stop_ptr)
+        return;
+    (*context_ptr->done_count_ptr)++;
+
+    // Keep the channel input queue non empty
+    EbObjectWrapper *wrapper;
+    eb_get_empty_object(context_ptr->input_producer_fifo_ptr, &wrapper);
+    eb_post_full_object(wrapper);
+}
+
+TEST(TaskSchedulerTest, WeightedChannels) {
+    const uint32_t channel_count = 2;
+    const uint32_t active_channel_counts[channel_count] = {1, 3};
+    const uint32_t total_done_count = 2000;
+
+    std::atomic<uint32_t> stop(0);
+    std::atomic<uint32_t> done_counts[channel_count];
+    EbSystemResource *resources[channel_count];
+    EbFifo **producer_fifos[channel_count], **consumer_fifos[channel_count];
+    SpinContext contexts[channel_count];
+    void *context_ptrs[channel_count];
+    EbTaskChannel *channels[channel_count];
+
+    EbTaskScheduler *scheduler = NULL;
+    ASSERT_EQ(create_scheduler(&scheduler, 1), EB_ErrorNone);
+
+    for (uint32_t c = 0; c < channel_count; c++) {
+        done_counts[c] = 0;
+        ASSERT_EQ(create_resource(&resources[c], 4, &producer_fifos[c],
+                                  &consumer_fifos[c]),
+                  EB_ErrorNone);
+        contexts[c].done_count_ptr = &done_counts[c];
+        contexts[c].stop_ptr = &stop;
+        contexts[c].input_producer_fifo_ptr = producer_fifos[c][0];
+        context_ptrs[c] = &contexts[c];
+        ASSERT_EQ(create_channel(&channels[c], c, active_channel_counts[c]), EB_ErrorNone);
+        ASSERT_EQ(eb_task_channel_add_stage(channels[c],
+                                            consumer_fifos[c][0],
+                                            spin_task,
+                                            &context_ptrs[c],
+                                            1),
+                  EB_ErrorNone);
+    }
+
+    // Fill the queues before attaching so both channels start together
+    for (uint32_t c = 0; c < channel_count; c++) {
+        for (uint32_t i = 0; i < 2; i++) {
+            EbObjectWrapper *wrapper;
+            eb_get_empty_object(producer_fifos[c][0], &wrapper);
+            eb_post_full_object(wrapper);
+        }
+    }
+    for (uint32_t c = 0; c < channel_count; c++)
+        ASSERT_EQ(eb_task_scheduler_attach_channel(scheduler, channels[c]),
+                  EB_ErrorNone);
+    for (uint32_t c = 0; c < channel_count; c++)
+        eb_task_scheduler_notify(scheduler);
+
+    for (uint32_t wait_ms = 0;
+         done_counts[0] + done_counts[1] < total_done_count && wait_ms < 60000;
+         wait_ms++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    stop = 1;
+
+    const double ratio = (double)done_counts[0] / std::max(done_counts[1].load(), 1u);
+    EXPECT_GT(done_counts[0] + done_counts[1], total_done_count - 1);
+    EXPECT_GT(ratio, 2.0);
+    EXPECT_LT(ratio, 4.5);
+
+    for (uint32_t c = 0; c < channel_count; c++)
+        eb_task_scheduler_detach_channel(scheduler, channels[c]);
+    EB_DELETE(scheduler);
+    for (uint32_t c = 0; c < channel_count; c++) {
+        EB_DELETE(channels[c]);
+        EB_DELETE(resources[c]);
+    }
+}
+
+}  // namespace
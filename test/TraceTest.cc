@@ -0,0 +1,113 @@
+/*
+ * Copyright(c) 2019 Netflix, Inc.
+ * SPDX - License - Identifier: BSD - 2 - Clause - Patent
+ */
+
+/******************************************************************************
+ * @file TraceTest.cc
+ *
+ * @brief Unit test for the pipeline trace:
+ * - eb_trace_ctor / eb_trace_write
+ * - eb_trace_object_begin / eb_trace_set_object / eb_trace_object_end
+ * - eb_trace_span_begin / eb_trace_span_end
+ *
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "EbTrace.h"
+#include "EbTime.h"
+
+/**
+ * @brief Unit test for the pipeline trace
+ *
+ * Test strategy:
+ * Several threads open object spans, tag them with a picture number and
+ * add a nested span to each, then the trace is written to a file.
+ *
+ * Expected result:
+ * The file holds one complete event per span with the picture and
+ * segment arguments, and spans outside an object are not recorded.
+ */
+namespace {
+
+static std::string read_file(const char *file_name) {
+    std::string content;
+    FILE *file = fopen(file_name, "r");
+    if (file) {
+        char buffer[4096];
+        size_t size;
+        while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            content.append(buffer, size);
+        fclose(file);
+    }
+    return content;
+}
+
+static size_t count_of(const std::string &content, const std::string &pattern) {
+    size_t count = 0;
+    for (size_t pos = content.find(pattern); pos != std::string::npos;
+         pos = content.find(pattern, pos + 1))
+        count++;
+    return count;
+}
+
+TEST(TraceTest, ObjectAndNestedSpans) {
+    const char *file_name = "svt_trace_test.json";
+    const uint32_t thread_count = 4;
+    const uint32_t picture_count = 100;
+    EbTrace *trace = NULL;
+
+    auto create = [&]() -> EbErrorType {
+        EB_NEW(trace, eb_trace_ctor, file_name);
+        return EB_ErrorNone;
+    };
+    ASSERT_EQ(create(), EB_ErrorNone);
+
+    // Not inside an object span, nothing is recorded
+    eb_trace_span_end("orphan", eb_trace_span_begin(), 0, 0);
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < thread_count; t++) {
+        threads.push_back(std::thread([&, t]() {
+            for (uint32_t i = 0; i < picture_count; i++) {
+                eb_trace_object_begin(trace, "stage", EbGetTimeUs());
+                eb_trace_set_object(t * picture_count + i, EB_TRACE_NO_SEGMENT);
+                const uint64_t start = eb_trace_span_begin();
+                EXPECT_NE(start, 0u);
+                eb_trace_span_end("nested", start, t * picture_count + i, (int32_t)i);
+                eb_trace_object_end(EbGetTimeUs());
+            }
+        }));
+    }
+    for (auto &t : threads)
+        t.join();
+
+    ASSERT_EQ(eb_trace_write(trace, 0), EB_ErrorNone);
+    EB_DELETE(trace);
+
+    const std::string content = read_file(file_name);
+    remove(file_name);
+    EXPECT_EQ(count_of(content, "\"name\":\"stage\""), thread_count * picture_count);
+    EXPECT_EQ(count_of(content, "\"name\":\"nested\""), thread_count * picture_count);
+    EXPECT_EQ(count_of(content, "\"name\":\"orphan\""), 0u);
+    EXPECT_EQ(count_of(content, "\"segment\":"), thread_count * picture_count);
+    EXPECT_EQ(count_of(content, "\"picture\":399"), 2u);
+    EXPECT_EQ(content.substr(content.size() - 4), "\n]}\n");
+}
+
+TEST(TraceTest, BadPathFails) {
+    EbTrace *trace = NULL;
+    auto create = [&]() -> EbErrorType {
+        EB_NEW(trace, eb_trace_ctor, "/nonexistent_dir/trace.json");
+        return EB_ErrorNone;
+    };
+    EXPECT_EQ(create(), EB_ErrorBadParameter);
+    EXPECT_TRUE(trace == NULL);
+}
+
+}  // namespace
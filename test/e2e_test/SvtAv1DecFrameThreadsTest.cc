@@ -0,0 +1,165 @@
+/*
+ * Copyright(c) 2019 Netflix, Inc.
+ * SPDX - License - Identifier: BSD - 2 - Clause - Patent
+ */
+
+/******************************************************************************
+ * @file SvtAv1DecFrameThreadsTest.cc
+ *
+ * @brief Bit-exactness test of the frame threads and tile threads of the
+ * SVT-AV1 decoder
+ *
+ ******************************************************************************/
+
+#include <vector>
+#include "gtest/gtest.h"
+#include "EbSvtAv1Dec.h"
+#include "SvtAv1E2EFramework.h"
+
+/**
+ * @brief SVT-AV1 decoder E2E test comparing the pictures decoded with frame
+ * threads and tile threads against the single-threaded decode.
+ *
+ * Test strategy:
+ * Setup SVT-AV1 encoder with several tiles and save the bitstream. Decode it
+ * with SVT-AV1 decoder single-threaded, then with frame threads combined with
+ * tile threads, with and without the recon pipeline.
+ *
+ * Expected result:
+ * Every configuration outputs the same pictures, in the same order, as the
+ * single-threaded decode.
+ *
+ * Test coverage:
+ * All test vectors of 640*480, with 2x2 tiles
+ */
+
+using namespace svt_av1_e2e_test;
+using namespace svt_av1_e2e_test_vector;
+
+/** threads of the decoder */
+typedef struct {
+    uint32_t threads;
+    uint32_t frame_threads;
+    EbBool pipeline_recon;
+} DecThreading;
+
+typedef std::vector<uint8_t> Buffer;
+
+static const DecThreading single_thread = {1, 1, EB_FALSE};
+
+static const DecThreading frame_tile_threads[] = {
+    {4, 4, EB_FALSE},
+    {2, 2, EB_FALSE},
+    {2, 4, EB_FALSE},
+    {4, 4, EB_TRUE},
+    {2, 4, EB_TRUE},
+};
+
+/** decode the frames, the pictures are returned in output order */
+static void decode_frames(const std::vector<Buffer> &frames,
+                          const uint32_t width, const uint32_t height,
+                          const DecThreading &threading,
+                          std::vector<Buffer> &pictures) {
+    EbComponentType *handle = nullptr;
+    EbSvtAv1DecConfiguration config;
+    ASSERT_EQ(eb_dec_init_handle(&handle, nullptr, &config), EB_ErrorNone);
+    config.max_picture_width = width;
+    config.max_picture_height = height;
+    config.max_bit_depth = EB_EIGHT_BIT;
+    config.max_color_format = EB_YUV420;
+    config.threads = threading.threads;
+    config.frame_threads = threading.frame_threads;
+    config.pipeline_recon = threading.pipeline_recon;
+    ASSERT_EQ(eb_svt_dec_set_parameter(handle, &config), EB_ErrorNone);
+    ASSERT_EQ(eb_init_decoder(handle), EB_ErrorNone);
+
+    /* the 3 planes packed, as compared */
+    const uint32_t luma_size = width * height;
+    Buffer picture(luma_size * 3 / 2);
+    EbSvtIOFormat img;
+    memset(&img, 0, sizeof(img));
+    img.luma = picture.data();
+    img.cb = img.luma + luma_size;
+    img.cr = img.cb + luma_size / 4;
+    img.y_stride = width;
+    img.cb_stride = width / 2;
+    img.cr_stride = width / 2;
+    img.width = width;
+    img.height = height;
+
+    EbBufferHeaderType out_buf;
+    memset(&out_buf, 0, sizeof(out_buf));
+    out_buf.p_buffer = (uint8_t *)&img;
+    EbAV1StreamInfo stream_info;
+    EbAV1FrameInfo frame_info;
+
+    for (const Buffer &frame : frames) {
+        ASSERT_EQ(eb_svt_decode_frame(handle, frame.data(), frame.size()),
+                  EB_ErrorNone);
+        while (eb_svt_dec_get_picture(
+                   handle, &out_buf, &stream_info, &frame_info) !=
+               EB_DecNoOutputPicture)
+            pictures.push_back(picture);
+    }
+    /* drain the pictures still being decoded by the frame threads */
+    ASSERT_EQ(eb_svt_decode_frame(handle, nullptr, 0), EB_ErrorNone);
+    while (eb_svt_dec_get_picture(
+               handle, &out_buf, &stream_info, &frame_info) !=
+           EB_DecNoOutputPicture)
+        pictures.push_back(picture);
+
+    ASSERT_EQ(eb_deinit_decoder(handle), EB_ErrorNone);
+    ASSERT_EQ(eb_dec_deinit_handle(handle), EB_ErrorNone);
+}
+
+class DecFrameThreadsTest : public SvtAv1E2ETestFramework {
+  protected:
+    void config_test() override {
+        enable_save_bitstream = true;
+        enable_config = true;
+        SvtAv1E2ETestFramework::config_test();
+    }
+
+    void post_process() override {
+        ASSERT_NE(output_file_, nullptr);
+        const uint32_t width = av1enc_ctx_.enc_params.source_width;
+        const uint32_t height = av1enc_ctx_.enc_params.source_height;
+
+        std::vector<Buffer> frames;
+        ASSERT_NO_FATAL_FAILURE(read_ivf_frames(output_file_->path, frames));
+
+        std::vector<Buffer> ref_pictures;
+        ASSERT_NO_FATAL_FAILURE(
+            decode_frames(frames, width, height, single_thread, ref_pictures));
+        ASSERT_FALSE(ref_pictures.empty());
+
+        for (const DecThreading &threading : frame_tile_threads) {
+            std::vector<Buffer> pictures;
+            ASSERT_NO_FATAL_FAILURE(
+                decode_frames(frames, width, height, threading, pictures));
+            ASSERT_EQ(pictures.size(), ref_pictures.size())
+                << "threads " << threading.threads << " frame threads "
+                << threading.frame_threads;
+            for (size_t i = 0; i < pictures.size(); i++) {
+                ASSERT_TRUE(pictures[i] == ref_pictures[i])
+                    << "picture " << i << " differs with threads "
+                    << threading.threads << " frame threads "
+                    << threading.frame_threads << " pipeline recon "
+                    << threading.pipeline_recon;
+            }
+        }
+    }
+};
+
+TEST_P(DecFrameThreadsTest, BitExactTest) {
+    run_death_test();
+}
+
+static const std::vector<EncTestSetting> frame_threads_settings = {
+    {"FrameThreadsTest1",
+     {{"TileCol", "1"}, {"TileRow", "1"}},
+     default_test_vectors}};
+
+INSTANTIATE_TEST_CASE_P(SvtAv1, DecFrameThreadsTest,
+                        ::testing::ValuesIn(frame_threads_settings),
+                        EncTestSetting::GetSettingName);
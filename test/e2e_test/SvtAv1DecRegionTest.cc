@@ -0,0 +1,201 @@
+/*
+ * Copyright(c) 2019 Netflix, Inc.
+ * SPDX - License - Identifier: BSD - 2 - Clause - Patent
+ */
+
+/******************************************************************************
+ * @file SvtAv1DecRegionTest.cc
+ *
+ * @brief Bit-exactness test of the region of interest decoding of the
+ * SVT-AV1 decoder
+ *
+ ******************************************************************************/
+
+#include <vector>
+#include "gtest/gtest.h"
+#include "EbSvtAv1Dec.h"
+#include "SvtAv1E2EFramework.h"
+
+/**
+ * @brief SVT-AV1 decoder E2E test comparing the pictures decoded with a
+ * region of interest against the same area of the full pictures.
+ *
+ * Test strategy:
+ * Setup SVT-AV1 encoder with several tiles and save the bitstream. Its tiles
+ * are not motion constrained: the motion vectors cross the tile edges. Decode
+ * it in full, then with regions inside a tile, across the tile edges and at
+ * the frame edges, single-threaded and with frame threads.
+ *
+ * Expected result:
+ * Every region decode outputs the same pictures, in the same order, as the
+ * region of the full decode.
+ *
+ * Test coverage:
+ * All test vectors of 640*480, with 2x2 tiles
+ */
+
+using namespace svt_av1_e2e_test;
+using namespace svt_av1_e2e_test_vector;
+
+/** region of interest, in luma samples, with even offsets */
+typedef struct {
+    uint32_t left;
+    uint32_t top;
+    uint32_t width;
+    uint32_t height;
+} DecRegion;
+
+typedef std::vector<uint8_t> Buffer;
+
+static const DecRegion full_frame = {0, 0, 0, 0};
+
+static const DecRegion regions[] = {
+    {64, 48, 128, 96},
+    {256, 176, 160, 128},
+    {0, 0, 96, 64},
+    {480, 400, 160, 80},
+};
+
+/** threads of the region decodes, as many frame threads as tile threads */
+static const uint32_t region_threads[] = {1, 4};
+
+/** decode the frames, the pictures of the region are returned in output
+ * order, with the 3 planes packed */
+static void decode_region(const std::vector<Buffer> &frames,
+                          const uint32_t width, const uint32_t height,
+                          const DecRegion &region, const uint32_t threads,
+                          const uint32_t frame_threads,
+                          std::vector<Buffer> &pictures) {
+    EbComponentType *handle = nullptr;
+    EbSvtAv1DecConfiguration config;
+    ASSERT_EQ(eb_dec_init_handle(&handle, nullptr, &config), EB_ErrorNone);
+    config.max_picture_width = width;
+    config.max_picture_height = height;
+    config.max_bit_depth = EB_EIGHT_BIT;
+    config.max_color_format = EB_YUV420;
+    config.threads = threads;
+    config.frame_threads = frame_threads;
+    config.region_left = region.left;
+    config.region_top = region.top;
+    config.region_width = region.width;
+    config.region_height = region.height;
+    ASSERT_EQ(eb_svt_dec_set_parameter(handle, &config), EB_ErrorNone);
+    ASSERT_EQ(eb_init_decoder(handle), EB_ErrorNone);
+
+    const uint32_t out_width = region.width ? region.width : width;
+    const uint32_t out_height = region.height ? region.height : height;
+    const uint32_t luma_size = out_width * out_height;
+    Buffer picture(luma_size * 3 / 2);
+    EbSvtIOFormat img;
+    memset(&img, 0, sizeof(img));
+    img.luma = picture.data();
+    img.cb = img.luma + luma_size;
+    img.cr = img.cb + luma_size / 4;
+    img.y_stride = out_width;
+    img.cb_stride = out_width / 2;
+    img.cr_stride = out_width / 2;
+    img.width = out_width;
+    img.height = out_height;
+
+    EbBufferHeaderType out_buf;
+    memset(&out_buf, 0, sizeof(out_buf));
+    out_buf.p_buffer = (uint8_t *)&img;
+    EbAV1StreamInfo stream_info;
+    EbAV1FrameInfo frame_info;
+
+    for (const Buffer &frame : frames) {
+        ASSERT_EQ(eb_svt_decode_frame(handle, frame.data(), frame.size()),
+                  EB_ErrorNone);
+        while (eb_svt_dec_get_picture(
+                   handle, &out_buf, &stream_info, &frame_info) !=
+               EB_DecNoOutputPicture)
+            pictures.push_back(picture);
+    }
+    ASSERT_EQ(eb_svt_decode_frame(handle, nullptr, 0), EB_ErrorNone);
+    while (eb_svt_dec_get_picture(
+               handle, &out_buf, &stream_info, &frame_info) !=
+           EB_DecNoOutputPicture)
+        pictures.push_back(picture);
+
+    ASSERT_EQ(eb_deinit_decoder(handle), EB_ErrorNone);
+    ASSERT_EQ(eb_dec_deinit_handle(handle), EB_ErrorNone);
+}
+
+/** crop the packed 4:2:0 picture to the region */
+static Buffer crop_picture(const Buffer &picture, const uint32_t width,
+                           const uint32_t height, const DecRegion &region) {
+    Buffer crop;
+    const uint8_t *plane = picture.data();
+    for (int i = 0; i < 3; i++) {
+        const uint32_t ss = i ? 1 : 0;
+        const uint32_t stride = width >> ss;
+        for (uint32_t y = 0; y < region.height >> ss; y++) {
+            const uint8_t *row =
+                plane + ((region.top >> ss) + y) * stride + (region.left >> ss);
+            crop.insert(crop.end(), row, row + (region.width >> ss));
+        }
+        plane += stride * (height >> ss);
+    }
+    return crop;
+}
+
+class DecRegionTest : public SvtAv1E2ETestFramework {
+  protected:
+    void config_test() override {
+        enable_save_bitstream = true;
+        enable_config = true;
+        SvtAv1E2ETestFramework::config_test();
+    }
+
+    void post_process() override {
+        ASSERT_NE(output_file_, nullptr);
+        const uint32_t width = av1enc_ctx_.enc_params.source_width;
+        const uint32_t height = av1enc_ctx_.enc_params.source_height;
+
+        std::vector<Buffer> frames;
+        ASSERT_NO_FATAL_FAILURE(read_ivf_frames(output_file_->path, frames));
+
+        std::vector<Buffer> ref_pictures;
+        ASSERT_NO_FATAL_FAILURE(decode_region(
+            frames, width, height, full_frame, 1, 1, ref_pictures));
+        ASSERT_FALSE(ref_pictures.empty());
+
+        for (const DecRegion &region : regions) {
+            if (region.left + region.width > width ||
+                region.top + region.height > height)
+                continue;
+            for (const uint32_t threads : region_threads) {
+                std::vector<Buffer> pictures;
+                ASSERT_NO_FATAL_FAILURE(decode_region(frames,
+                                                      width,
+                                                      height,
+                                                      region,
+                                                      threads,
+                                                      threads,
+                                                      pictures));
+                ASSERT_EQ(pictures.size(), ref_pictures.size());
+                for (size_t i = 0; i < pictures.size(); i++) {
+                    ASSERT_TRUE(pictures[i] == crop_picture(ref_pictures[i],
+                                                            width,
+                                                            height,
+                                                            region))
+                        << "picture " << i << " differs in region "
+                        << region.left << "," << region.top << ","
+                        << region.width << "," << region.height
+                        << " with threads " << threads;
+                }
+            }
+        }
+    }
+};
+
+TEST_P(DecRegionTest, BitExactTest) {
+    run_death_test();
+}
+
+static const std::vector<EncTestSetting> region_settings = {
+    {"RegionTest1", {{"TileCol", "1"}, {"TileRow", "1"}}, default_test_vectors}};
+
+INSTANTIATE_TEST_CASE_P(SvtAv1, DecRegionTest,
+                        ::testing::ValuesIn(region_settings),
+                        EncTestSetting::GetSettingName);
@@ -34,6 +34,9 @@
 using namespace svt_av1_e2e_test;
 using namespace svt_av1_e2e_tools;
 
+static void update_prev_ivf_header(
+    svt_av1_e2e_test::SvtAv1E2ETestFramework::IvfFile *ivf);
+
 VideoSource *SvtAv1E2ETestFramework::prepare_video_src(
     const TestVideoVector &vector) {
     VideoSource *video_src = nullptr;
@@ -486,6 +489,12 @@ void SvtAv1E2ETestFramework::run_encode_process() {
         }  // if (!enc_file_eos)
     } while (!rec_file_eos || !src_file_eos || !enc_file_eos);
 
+    /** terminate the last ivf packet, the saved bitstream is then complete */
+    if (output_file_ && output_file_->file) {
+        update_prev_ivf_header(output_file_);
+        fflush(output_file_->file);
+    }
+
     /** complete the reference buffers in list comparison with recon */
     if (ref_compare_) {
         TimeAutoCount counter(CONFORMANCE, collect_);
@@ -601,6 +610,28 @@ static void write_ivf_frame_header(
         fwrite(header, 1, IVF_FRAME_HEADER_SIZE, ivf->file);
 }
 
+void SvtAv1E2ETestFramework::read_ivf_frames(
+    const std::string &path, std::vector<std::vector<uint8_t>> &frames) {
+    FILE *file = nullptr;
+    FOPEN(file, path.c_str(), "rb");
+    ASSERT_NE(file, nullptr) << "can not open " << path;
+
+    uint8_t header[IVF_STREAM_HEADER_SIZE];
+    ASSERT_EQ(fread(header, 1, IVF_STREAM_HEADER_SIZE, file),
+              (size_t)IVF_STREAM_HEADER_SIZE);
+    while (fread(header, 1, IVF_FRAME_HEADER_SIZE, file) ==
+           IVF_FRAME_HEADER_SIZE) {
+        const uint32_t size = header[0] | (header[1] << 8) |
+                              (header[2] << 16) | ((uint32_t)header[3] << 24);
+        std::vector<uint8_t> frame(size);
+        if (fread(frame.data(), 1, size, file) != size)
+            break;
+        frames.push_back(frame);
+    }
+    fclose(file);
+    ASSERT_FALSE(frames.empty()) << "no frame in " << path;
+}
+
 void SvtAv1E2ETestFramework::write_compress_data(
     const EbBufferHeaderType *output) {
     // Check for the flags EB_BUFFERFLAG_HAS_TD and
@@ -809,7 +840,7 @@ void SvtAv1E2ETestFramework::get_recon_frame(const SvtAv1Context &ctxt,
     } while (true);
 }
 
-SvtAv1E2ETestFramework::IvfFile::IvfFile(std::string path) {
+SvtAv1E2ETestFramework::IvfFile::IvfFile(std::string path) : path(path) {
     FOPEN(file, path.c_str(), "wb");
     byte_count_since_ivf = 0;
     ivf_count = 0;
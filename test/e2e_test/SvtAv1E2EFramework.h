@@ -71,6 +71,7 @@ class SvtAv1E2ETestFramework : public ::testing::TestWithParam<EncTestSetting> {
   public:
     typedef struct IvfFile {
         FILE *file;
+        std::string path;
         uint64_t byte_count_since_ivf;
         uint64_t ivf_count;
         IvfFile(std::string path);
@@ -138,6 +139,11 @@ class SvtAv1E2ETestFramework : public ::testing::TestWithParam<EncTestSetting> {
      * into decoder */
     static void get_recon_frame(const SvtAv1Context &ctxt, FrameQueue *recon,
                                 bool &is_eos);
+    /** read the frames of an ivf file, like the one saved by the test
+     * @param path  path of the ivf file
+     * @param frames  data of each frame, in the file order */
+    static void read_ivf_frames(const std::string &path,
+                                std::vector<std::vector<uint8_t>> &frames);
 
   private:
     /** write ivf header to output file */